@@ -0,0 +1,196 @@
+#!/usr/bin/env bash
+
+set -euo pipefail
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_ROOT="$(cd "$SCRIPT_DIR/../.." && pwd)"
+
+if [[ -z "${TLANG_LAMBDA_BENCH_IN_NIX:-}" && -z "${IN_NIX_SHELL:-}" && -x "$(command -v nix || true)" ]]; then
+  exec nix develop "$PROJECT_ROOT" -c env TLANG_LAMBDA_BENCH_IN_NIX=1 bash "$0" "$@"
+fi
+
+usage() {
+  cat <<EOF
+Usage: $(basename "$0") [options]
+
+Runs each lambda-heavy script with the lambda compiler off
+(TLANG_COMPILE_LAMBDAS=0) and on, checks that both give the same result,
+and reports the median time of each.
+
+Options:
+  --n N                Number of elements / rows per script (default: 200000)
+  --scripts LIST       Comma-separated script ids (default: l1,l2,l3,l4,l5)
+  --iterations N       Runs per script and mode (default: 3)
+  --results PATH       Output CSV path (default: results/results.csv)
+  --help               Show this message
+EOF
+}
+
+N=200000
+SCRIPTS="l1,l2,l3,l4,l5"
+ITERATIONS=3
+RESULTS_PATH="$SCRIPT_DIR/results/results.csv"
+
+while [[ $# -gt 0 ]]; do
+  case "$1" in
+    --n)
+      N="${2:?missing value for --n}"
+      shift 2
+      ;;
+    --scripts)
+      SCRIPTS="${2:?missing value for --scripts}"
+      shift 2
+      ;;
+    --iterations)
+      ITERATIONS="${2:?missing value for --iterations}"
+      shift 2
+      ;;
+    --results)
+      RESULTS_PATH="${2:?missing value for --results}"
+      shift 2
+      ;;
+    --help)
+      usage
+      exit 0
+      ;;
+    *)
+      echo "Unknown option: $1" >&2
+      usage >&2
+      exit 1
+      ;;
+  esac
+done
+
+# Find the actual binary path, ignoring shell functions/aliases
+T_BIN="$(type -p t || true)"
+if [[ -z "$T_BIN" || ! -x "$T_BIN" ]]; then
+  if [[ -f "$PROJECT_ROOT/_build/default/src/repl.exe" ]]; then
+    T_BIN="$PROJECT_ROOT/_build/default/src/repl.exe"
+  elif [[ -L "$PROJECT_ROOT/result" && -f "$PROJECT_ROOT/result/bin/t" ]]; then
+    T_BIN="$PROJECT_ROOT/result/bin/t"
+  fi
+fi
+
+if [[ -z "$T_BIN" ]]; then
+  echo "Error: 't' command not found in PATH and no compiled binary found in _build or result." >&2
+  echo "Please run 'dune build' or 'nix build' to compile the T language before running benchmarks." >&2
+  exit 1
+fi
+
+TIME_BIN=""
+for candidate in time gtime; do
+  if ! command -v "$candidate" >/dev/null 2>&1; then
+    continue
+  fi
+  if "$candidate" -f 'TIME_SEC=%e' bash -lc 'exit 0' >/dev/null 2>/dev/null; then
+    TIME_BIN="$(command -v "$candidate")"
+    break
+  fi
+done
+
+if [[ -z "$TIME_BIN" ]]; then
+  echo "GNU time with -f support is required to record memory usage." >&2
+  exit 1
+fi
+
+mkdir -p "$(dirname "$RESULTS_PATH")"
+printf 'script,mode,iteration,time_sec,memory_mb,checksum,status\n' > "$RESULTS_PATH"
+
+metric_value() {
+  local key="$1"
+  local file="$2"
+  awk -F= -v key="$key" '$1 == key { value = $2 } END { print (value == "" ? "NA" : value) }' "$file"
+}
+
+run_script() {
+  local script_id="$1"
+  local script_path="$2"
+  local mode="$3"
+  local iteration="$4"
+  local compile_flag=1
+  if [[ "$mode" == "walk" ]]; then
+    compile_flag=0
+  fi
+
+  local stdout_file
+  local stderr_file
+  local status
+  stdout_file="$(mktemp)"
+  stderr_file="$(mktemp)"
+
+  echo "=== ${script_id} / ${mode} / iteration ${iteration} ==="
+
+  if "$TIME_BIN" -f 'TIME_SEC=%e\nMEMORY_KB=%M' \
+       env TLANG_COMPILE_LAMBDAS="$compile_flag" LAMBDA_BENCH_N="$N" "$T_BIN" run --unsafe "$script_path" \
+       >"$stdout_file" 2>"$stderr_file"; then
+    status="ok"
+  else
+    status="fail"
+    cat "$stderr_file" >&2
+  fi
+
+  local time_sec
+  local memory_kb
+  local memory_mb="NA"
+  time_sec="$(metric_value "TIME_SEC" "$stderr_file")"
+  memory_kb="$(metric_value "MEMORY_KB" "$stderr_file")"
+  if [[ "$memory_kb" != "NA" ]]; then
+    memory_mb="$(awk -v kb="$memory_kb" 'BEGIN { printf "%.2f", kb / 1024.0 }')"
+  fi
+
+  printf '%s,%s,%s,%s,%s,%s,%s\n' \
+    "$script_id" "$mode" "$iteration" "$time_sec" "$memory_mb" \
+    "$(metric_value "CHECKSUM" "$stdout_file")" "$status" >> "$RESULTS_PATH"
+
+  rm -f "$stdout_file" "$stderr_file"
+}
+
+IFS=',' read -r -a SCRIPT_LIST <<< "$SCRIPTS"
+
+for script_id in "${SCRIPT_LIST[@]}"; do
+  matches=("$SCRIPT_DIR"/scripts/"${script_id}"_*.t)
+  if [[ ! -f "${matches[0]}" ]]; then
+    echo "Unknown script id: $script_id" >&2
+    exit 1
+  fi
+  for iteration in $(seq 1 "$ITERATIONS"); do
+    run_script "$script_id" "${matches[0]}" walk "$iteration"
+    run_script "$script_id" "${matches[0]}" compiled "$iteration"
+  done
+done
+
+echo
+echo "Results written to $RESULTS_PATH"
+echo
+
+# Median time per script and mode, the speedup of the compiled bodies, and a
+# check that both modes printed the same checksum.
+awk -F, '
+  NR == 1 { next }
+  $7 != "ok" { failed[$1] = 1; next }
+  {
+    key = $1 SUBSEP $2
+    times[key] = times[key] " " $4
+    sums[$1, $2] = $6
+    seen[$1] = 1
+  }
+  function median(list,    arr, n, i, j, tmp) {
+    n = split(list, arr, " ")
+    for (i = 1; i <= n; i++)
+      for (j = i + 1; j <= n; j++)
+        if (arr[j] + 0 < arr[i] + 0) { tmp = arr[i]; arr[i] = arr[j]; arr[j] = tmp }
+    return (n % 2) ? arr[(n + 1) / 2] : (arr[n / 2] + arr[n / 2 + 1]) / 2
+  }
+  END {
+    bad = 0
+    printf "%-8s %10s %10s %8s  %s\n", "script", "walk_s", "compiled_s", "speedup", "checksum"
+    for (s in seen) {
+      w = median(times[s, "walk"]); c = median(times[s, "compiled"])
+      same = (sums[s, "walk"] == sums[s, "compiled"]) ? "match" : "MISMATCH"
+      if (same != "match") bad = 1
+      printf "%-8s %10.2f %10.2f %7.2fx  %s\n", s, w, c, (c > 0 ? w / c : 0), same
+    }
+    for (s in failed) { printf "%-8s failed\n", s; bad = 1 }
+    exit bad
+  }
+' "$RESULTS_PATH"
@@ -0,0 +1,10 @@
+-- Scalar arithmetic over a parameter and a captured variable.
+n_env = env("LAMBDA_BENCH_N")
+n = if (type(n_env) == "String") to_integer(n_env) else 200000
+xs = seq(1, n)
+
+k = 3
+ys = map(xs, \(x) (x * k + 1) % 7)
+
+print(str_join(["ROWS=", to_string(n)]))
+print(str_join(["CHECKSUM=", to_string(sum(ys))]))
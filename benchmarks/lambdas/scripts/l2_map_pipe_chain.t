@@ -0,0 +1,9 @@
+-- A pipe chain into builtins inside the lambda body.
+n_env = env("LAMBDA_BENCH_N")
+n = if (type(n_env) == "String") to_integer(n_env) else 200000
+xs = seq(1, n)
+
+ys = map(xs, \(x) (x - 1000) |> abs |> sqrt |> floor)
+
+print(str_join(["ROWS=", to_string(n)]))
+print(str_join(["CHECKSUM=", to_string(sum(ys))]))
@@ -0,0 +1,11 @@
+-- Lambdas calling other user-defined functions.
+n_env = env("LAMBDA_BENCH_N")
+n = if (type(n_env) == "String") to_integer(n_env) else 200000
+xs = seq(1, n)
+
+clamp = \(v, lo, hi) if (v < lo) lo else if (v > hi) hi else v
+score = \(x) clamp(x % 100 - 50, 0 - 20, 20) * 2
+ys = map(xs, \(x) score(x) + 1)
+
+print(str_join(["ROWS=", to_string(n)]))
+print(str_join(["CHECKSUM=", to_string(sum(ys))]))
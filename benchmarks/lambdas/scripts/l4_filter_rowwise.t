@@ -0,0 +1,10 @@
+-- A filter predicate the vectorised path cannot take, run row by row.
+n_env = env("LAMBDA_BENCH_N")
+n = if (type(n_env) == "String") to_integer(n_env) else 200000
+xs = seq(1, n)
+
+df = to_dataframe([a: xs, b: map(xs, \(i) i % 13)])
+kept = df |> filter(if ($b > 6) $a % 2 == 0 else $a % 3 == 0)
+
+print(str_join(["ROWS=", to_string(n)]))
+print(str_join(["CHECKSUM=", to_string(nrow(kept))]))
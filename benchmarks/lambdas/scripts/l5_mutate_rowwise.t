@@ -0,0 +1,11 @@
+-- A mutate calling a scalar user function, run row by row.
+n_env = env("LAMBDA_BENCH_N")
+n = if (type(n_env) == "String") to_integer(n_env) else 200000
+xs = seq(1, n)
+
+band = \(v) if (v > 8) "high" else if (v > 3) "mid" else "low"
+df = to_dataframe([a: xs, b: map(xs, \(i) i % 13)])
+out = df |> mutate($band = band($b))
+
+print(str_join(["ROWS=", to_string(n)]))
+print(str_join(["CHECKSUM=", to_string(nrow(filter(out, $band == "high")))]))
@@ -19,7 +19,16 @@ Options:
   --months LIST        Comma-separated YYYY-MM list used if auto-preparing data
   --results PATH       Output CSV path
   --queries LIST       Comma-separated query ids (default: q1,q2,q3,q4,q5,q6,q7,q8,q9,q10,q11,q12,q13,q14,q15,q16,q17,q18,q19,q20)
-  --iterations N       Number of runs per engine/query (default: 1)
+  --iterations N       Number of runs per engine/query/scale (default: 3). The
+                       first run is recorded as cold, the others as warm.
+  --engines LIST       Comma-separated engines to run (default: t,python,r)
+  --scales LIST        Comma-separated input sizes: 100k, 1m, full (default: each
+                       query's own size; q17-q19 always run at 1m)
+  --drop-caches        Drop the page cache before each cold run (needs root)
+  --summary PATH       JSON summary path (default: results/summary.json)
+  --baseline PATH      Baseline summary to compare against (default: results/baseline.json)
+  --threshold PCT      Fail when a median time or peak memory grows by more than PCT (default: 10)
+  --update-baseline    Store this run's summary as the baseline instead of comparing
   --help               Show this message
 EOF
 }
@@ -30,7 +39,14 @@ PARQUET_PATH="$SCRIPT_DIR/data/nyc_taxi_materialized.parquet"
 MONTHS="2023-01,2023-02,2023-03"
 RESULTS_PATH="$SCRIPT_DIR/results/results.csv"
 QUERIES="q1,q2,q3,q4,q5,q6,q7,q8,q9,q10,q11,q12,q13,q14,q15,q16,q17,q18,q19,q20"
-ITERATIONS=1
+ITERATIONS=3
+ENGINES="t,python,r"
+SCALES=""
+DROP_CACHES=0
+SUMMARY_PATH="$SCRIPT_DIR/results/summary.json"
+BASELINE_PATH="$SCRIPT_DIR/results/baseline.json"
+THRESHOLD=10
+UPDATE_BASELINE=0
 CORE_100K_CSV="$SCRIPT_DIR/data/nyc_taxi_core_100k.csv"
 CORE_100K_PARQUET="$SCRIPT_DIR/data/nyc_taxi_core_100k.parquet"
 CORE_1M_CSV="$SCRIPT_DIR/data/nyc_taxi_core_1m.csv"
@@ -66,6 +82,34 @@ while [[ $# -gt 0 ]]; do
       ITERATIONS="${2:?missing value for --iterations}"
       shift 2
       ;;
+    --engines)
+      ENGINES="${2:?missing value for --engines}"
+      shift 2
+      ;;
+    --scales)
+      SCALES="${2:?missing value for --scales}"
+      shift 2
+      ;;
+    --drop-caches)
+      DROP_CACHES=1
+      shift
+      ;;
+    --summary)
+      SUMMARY_PATH="${2:?missing value for --summary}"
+      shift 2
+      ;;
+    --baseline)
+      BASELINE_PATH="${2:?missing value for --baseline}"
+      shift 2
+      ;;
+    --threshold)
+      THRESHOLD="${2:?missing value for --threshold}"
+      shift 2
+      ;;
+    --update-baseline)
+      UPDATE_BASELINE=1
+      shift
+      ;;
     --help|-h)
       usage
       exit 0
@@ -146,8 +190,8 @@ PY
 ensure_benchmark_inputs
 
 core_benchmark_query_requested() {
-  case ",$QUERIES," in
-    *,q14,*|*,q15,*|*,q16,*|*,q17,*|*,q18,*|*,q19,*)
+  case ",$QUERIES,$SCALES," in
+    *,q14,*|*,q15,*|*,q16,*|*,q17,*|*,q18,*|*,q19,*|*,100k,*|*,1m,*)
       return 0
       ;;
     *)
@@ -215,7 +259,7 @@ if core_benchmark_query_requested; then
   ensure_core_subset "$PARQUET_PATH" 1000000 "$CORE_1M_CSV" "$CORE_1M_PARQUET"
 fi
 
-if ! command -v Rscript >/dev/null 2>&1; then
+if [[ ",$ENGINES," == *,r,* ]] && ! command -v Rscript >/dev/null 2>&1; then
   echo "Rscript is required" >&2
   exit 1
 fi
@@ -258,7 +302,18 @@ if [[ -z "$TIME_BIN" ]]; then
 fi
 
 mkdir -p "$(dirname "$RESULTS_PATH")"
-printf 'engine,query,iteration,time_sec,memory_mb,rows_scanned,rows_returned,status\n' > "$RESULTS_PATH"
+printf 'engine,query,scale,phase,iteration,time_sec,memory_mb,rows_scanned,rows_returned,status\n' > "$RESULTS_PATH"
+
+drop_page_cache() {
+  if [[ "$DROP_CACHES" -ne 1 ]]; then
+    return
+  fi
+  sync
+  if ! echo 3 > /proc/sys/vm/drop_caches 2>/dev/null; then
+    echo "warning: could not drop the page cache (needs root); cold runs may hit a warm cache" >&2
+    DROP_CACHES=0
+  fi
+}
 
 metric_value() {
   local key="$1"
@@ -281,8 +336,15 @@ metric_value() {
 run_query() {
   local engine="$1"
   local query="$2"
-  local iteration="$3"
-  shift 3
+  local scale="$3"
+  local iteration="$4"
+  shift 4
+
+  local phase="warm"
+  if [[ "$iteration" -eq 1 ]]; then
+    phase="cold"
+    drop_page_cache
+  fi
 
   local stdout_file
   local stderr_file
@@ -295,7 +357,7 @@ run_query() {
   stdout_file="$(mktemp)"
   stderr_file="$(mktemp)"
 
-  echo "=== ${engine} / ${query} / iteration ${iteration} ==="
+  echo "=== ${engine} / ${query} / ${scale} / iteration ${iteration} (${phase}) ==="
 
   if "$TIME_BIN" -f 'TIME_SEC=%e\nMEMORY_KB=%M' "$@" >"$stdout_file" 2>"$stderr_file"; then
     status="ok"
@@ -324,8 +386,8 @@ PY
   rows_scanned="$(metric_value "ROWS_SCANNED" "$stdout_file")"
   rows_returned="$(metric_value "ROWS_RETURNED" "$stdout_file")"
 
-  printf '%s,%s,%s,%s,%s,%s,%s,%s\n' \
-    "$engine" "$query" "$iteration" "$time_sec" "$memory_mb" "$rows_scanned" "$rows_returned" "$status" \
+  printf '%s,%s,%s,%s,%s,%s,%s,%s,%s,%s\n' \
+    "$engine" "$query" "$scale" "$phase" "$iteration" "$time_sec" "$memory_mb" "$rows_scanned" "$rows_returned" "$status" \
     >> "$RESULTS_PATH"
 
   rm -f "$stdout_file" "$stderr_file"
@@ -333,11 +395,38 @@ PY
 
 IFS=',' read -r -a QUERY_LIST <<< "$QUERIES"
 
+engine_requested() {
+  case ",$ENGINES," in
+    *,"$1",*) return 0 ;;
+    *) return 1 ;;
+  esac
+}
+
+# Sets scale_csv, scale_parquet and scale_dataset for a scale label.
+resolve_scale_inputs() {
+  case "$1" in
+    100k)
+      scale_csv="$CORE_100K_CSV"; scale_parquet="$CORE_100K_PARQUET"; scale_dataset="$CORE_100K_PARQUET"
+      ;;
+    1m)
+      scale_csv="$CORE_1M_CSV"; scale_parquet="$CORE_1M_PARQUET"; scale_dataset="$CORE_1M_PARQUET"
+      ;;
+    full)
+      scale_csv="$CSV_PATH"; scale_parquet="$PARQUET_PATH"; scale_dataset="$PARQUET_DIR"
+      ;;
+    *)
+      echo "Unknown scale: $1 (expected 100k, 1m or full)" >&2
+      exit 1
+      ;;
+  esac
+}
+
 for query in "${QUERY_LIST[@]}"; do
-  python_args=(--dataset "$PARQUET_DIR")
-  r_args=("$PARQUET_DIR")
-  t_csv="$CSV_PATH"
-  t_parquet="$PARQUET_PATH"
+  # Queries read the partitioned dataset at full scale unless they set a
+  # default scale; q17-q19 are the 1M-row runs of q14-q16 and keep it.
+  input_style="dataset"
+  default_scale="full"
+  pinned_scale=0
 
   case "$query" in
     q1)
@@ -409,55 +498,46 @@ for query in "${QUERY_LIST[@]}"; do
       python_script="$SCRIPT_DIR/python/q14_core_select.py"
       r_script="$SCRIPT_DIR/r/q14_core_select.R"
       t_script="$SCRIPT_DIR/queries/q14_core_select.t"
-      python_args=(--input-parquet "$CORE_100K_PARQUET")
-      r_args=("$CORE_100K_PARQUET")
-      t_csv="$CORE_100K_CSV"
-      t_parquet="$CORE_100K_PARQUET"
+      input_style="parquet"
+      default_scale="100k"
       ;;
     q15)
       python_script="$SCRIPT_DIR/python/q15_core_filter.py"
       r_script="$SCRIPT_DIR/r/q15_core_filter.R"
       t_script="$SCRIPT_DIR/queries/q15_core_filter.t"
-      python_args=(--input-parquet "$CORE_100K_PARQUET")
-      r_args=("$CORE_100K_PARQUET")
-      t_csv="$CORE_100K_CSV"
-      t_parquet="$CORE_100K_PARQUET"
+      input_style="parquet"
+      default_scale="100k"
       ;;
     q16)
       python_script="$SCRIPT_DIR/python/q16_core_mutate.py"
       r_script="$SCRIPT_DIR/r/q16_core_mutate.R"
       t_script="$SCRIPT_DIR/queries/q16_core_mutate.t"
-      python_args=(--input-parquet "$CORE_100K_PARQUET")
-      r_args=("$CORE_100K_PARQUET")
-      t_csv="$CORE_100K_CSV"
-      t_parquet="$CORE_100K_PARQUET"
+      input_style="parquet"
+      default_scale="100k"
       ;;
     q17)
       python_script="$SCRIPT_DIR/python/q14_core_select.py"
       r_script="$SCRIPT_DIR/r/q14_core_select.R"
       t_script="$SCRIPT_DIR/queries/q14_core_select.t"
-      python_args=(--input-parquet "$CORE_1M_PARQUET")
-      r_args=("$CORE_1M_PARQUET")
-      t_csv="$CORE_1M_CSV"
-      t_parquet="$CORE_1M_PARQUET"
+      input_style="parquet"
+      default_scale="1m"
+      pinned_scale=1
       ;;
     q18)
       python_script="$SCRIPT_DIR/python/q15_core_filter.py"
       r_script="$SCRIPT_DIR/r/q15_core_filter.R"
       t_script="$SCRIPT_DIR/queries/q15_core_filter.t"
-      python_args=(--input-parquet "$CORE_1M_PARQUET")
-      r_args=("$CORE_1M_PARQUET")
-      t_csv="$CORE_1M_CSV"
-      t_parquet="$CORE_1M_PARQUET"
+      input_style="parquet"
+      default_scale="1m"
+      pinned_scale=1
       ;;
     q19)
       python_script="$SCRIPT_DIR/python/q16_core_mutate.py"
       r_script="$SCRIPT_DIR/r/q16_core_mutate.R"
       t_script="$SCRIPT_DIR/queries/q16_core_mutate.t"
-      python_args=(--input-parquet "$CORE_1M_PARQUET")
-      r_args=("$CORE_1M_PARQUET")
-      t_csv="$CORE_1M_CSV"
-      t_parquet="$CORE_1M_PARQUET"
+      input_style="parquet"
+      default_scale="1m"
+      pinned_scale=1
       ;;
     q20)
       python_script="$SCRIPT_DIR/python/q20_nested_op.py"
@@ -470,11 +550,41 @@ for query in "${QUERY_LIST[@]}"; do
       ;;
   esac
 
-  for iteration in $(seq 1 "$ITERATIONS"); do
-    run_query python "$query" "$iteration" python "$python_script" "${python_args[@]}"
-    run_query r "$query" "$iteration" Rscript "$r_script" "${r_args[@]}"
-    run_query t "$query" "$iteration" env NYC_TAXI_CSV="$t_csv" NYC_TAXI_PARQUET="$t_parquet" "$T_BIN" run --unsafe "$t_script"
+  if [[ -n "$SCALES" && "$pinned_scale" -eq 0 ]]; then
+    IFS=',' read -r -a scale_list <<< "$SCALES"
+  else
+    scale_list=("$default_scale")
+  fi
+
+  for scale in "${scale_list[@]}"; do
+    resolve_scale_inputs "$scale"
+    if [[ "$input_style" == "parquet" ]]; then
+      python_args=(--input-parquet "$scale_parquet")
+      r_args=("$scale_parquet")
+    else
+      python_args=(--dataset "$scale_dataset")
+      r_args=("$scale_dataset")
+    fi
+
+    for iteration in $(seq 1 "$ITERATIONS"); do
+      if engine_requested python; then
+        run_query python "$query" "$scale" "$iteration" python "$python_script" "${python_args[@]}"
+      fi
+      if engine_requested r; then
+        run_query r "$query" "$scale" "$iteration" Rscript "$r_script" "${r_args[@]}"
+      fi
+      if engine_requested t; then
+        run_query t "$query" "$scale" "$iteration" env NYC_TAXI_CSV="$scale_csv" NYC_TAXI_PARQUET="$scale_parquet" "$T_BIN" run --unsafe "$t_script"
+      fi
+    done
   done
 done
 
 echo "Benchmark results written to $RESULTS_PATH"
+
+summary_args=(--results "$RESULTS_PATH" --summary-json "$SUMMARY_PATH"
+  --summary-csv "${SUMMARY_PATH%.json}.csv" --baseline "$BASELINE_PATH" --threshold "$THRESHOLD")
+if [[ "$UPDATE_BASELINE" -eq 1 ]]; then
+  summary_args+=(--update-baseline)
+fi
+python "$SCRIPT_DIR/summarize_results.py" "${summary_args[@]}"
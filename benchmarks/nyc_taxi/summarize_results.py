@@ -0,0 +1,188 @@
+"""Summarise raw NYC taxi benchmark runs and check them against a baseline.
+
+Reads the per-run CSV written by run_benchmark.sh and reduces it to one
+record per (engine, query, scale): the cold first run, the median and p95
+of the warm runs, peak RSS and rows/sec. With --baseline, any query whose
+warm median time or peak memory grew by more than --threshold percent
+(and by more than the noise floors) is reported and the script exits 1.
+"""
+
+import argparse
+import csv
+import json
+import math
+import pathlib
+import platform
+import subprocess
+import sys
+import time
+
+
+def parse_float(value: str):
+    try:
+        number = float(value)
+    except (TypeError, ValueError):
+        return None
+    return number if math.isfinite(number) else None
+
+
+def percentile(values, fraction: float):
+    """Nearest-rank percentile of a non-empty list."""
+    ordered = sorted(values)
+    rank = max(1, math.ceil(fraction * len(ordered)))
+    return ordered[rank - 1]
+
+
+def median(values):
+    ordered = sorted(values)
+    mid = len(ordered) // 2
+    if len(ordered) % 2:
+        return ordered[mid]
+    return (ordered[mid - 1] + ordered[mid]) / 2.0
+
+
+def summarise(rows):
+    groups = {}
+    for row in rows:
+        key = (row["engine"], row["query"], row.get("scale", "default"))
+        groups.setdefault(key, []).append(row)
+
+    records = []
+    for (engine, query, scale), runs in sorted(groups.items()):
+        ok_runs = [r for r in runs if r["status"] == "ok" and parse_float(r["time_sec"]) is not None]
+        cold = [r for r in ok_runs if r.get("phase", "cold") == "cold"]
+        # A single run is only a cold run: its warm statistics are NA.
+        warm = [r for r in ok_runs if r.get("phase") == "warm"]
+        times = [parse_float(r["time_sec"]) for r in warm]
+        memory = [m for m in (parse_float(r["memory_mb"]) for r in ok_runs) if m is not None]
+        scanned = [s for s in (parse_float(r["rows_scanned"]) for r in ok_runs) if s is not None]
+
+        record = {
+            "engine": engine,
+            "query": query,
+            "scale": scale,
+            "runs": len(runs),
+            "failed_runs": len(runs) - len(ok_runs),
+            "status": "ok" if ok_runs and len(ok_runs) == len(runs) else "fail",
+            "cold_sec": parse_float(cold[0]["time_sec"]) if cold else None,
+            "median_sec": median(times) if times else None,
+            "p95_sec": percentile(times, 0.95) if times else None,
+            "peak_memory_mb": max(memory) if memory else None,
+            "rows_scanned": int(max(scanned)) if scanned else None,
+        }
+        if record["rows_scanned"] is not None and record["median_sec"]:
+            record["rows_per_sec"] = record["rows_scanned"] / record["median_sec"]
+        else:
+            record["rows_per_sec"] = None
+        records.append(record)
+    return records
+
+
+def git_commit(root: pathlib.Path):
+    try:
+        return subprocess.run(
+            ["git", "-C", str(root), "rev-parse", "--short", "HEAD"],
+            check=True, capture_output=True, text=True,
+        ).stdout.strip()
+    except (OSError, subprocess.CalledProcessError):
+        return None
+
+
+def compare(records, baseline, threshold: float, min_delta_sec: float, min_delta_mb: float):
+    """Return human-readable regressions of records against baseline records."""
+    previous = {(b["engine"], b["query"], b["scale"]): b for b in baseline}
+    regressions = []
+    for record in records:
+        key = (record["engine"], record["query"], record["scale"])
+        base = previous.get(key)
+        if base is None:
+            continue
+        label = "/".join(key)
+        if base["status"] == "ok" and record["status"] != "ok":
+            regressions.append(f"{label}: failed ({record['failed_runs']} of {record['runs']} runs)")
+            continue
+        checks = [
+            ("median time", "median_sec", "s", min_delta_sec),
+            ("peak memory", "peak_memory_mb", " MB", min_delta_mb),
+        ]
+        for name, field, unit, floor in checks:
+            old, new = base.get(field), record.get(field)
+            if old is None or new is None or old <= 0:
+                continue
+            growth = (new - old) / old * 100.0
+            if growth > threshold and new - old > floor:
+                regressions.append(
+                    f"{label}: {name} {old:.3f}{unit} -> {new:.3f}{unit} (+{growth:.1f}%)"
+                )
+    return regressions
+
+
+def write_summary_csv(path: pathlib.Path, records) -> None:
+    fields = [
+        "engine", "query", "scale", "runs", "failed_runs", "status", "cold_sec",
+        "median_sec", "p95_sec", "peak_memory_mb", "rows_scanned", "rows_per_sec",
+    ]
+    with path.open("w", encoding="utf-8", newline="") as handle:
+        writer = csv.DictWriter(handle, fieldnames=fields)
+        writer.writeheader()
+        for record in records:
+            writer.writerow({k: ("NA" if record[k] is None else record[k]) for k in fields})
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--results", required=True, help="Raw per-run CSV from run_benchmark.sh")
+    parser.add_argument("--summary-json", required=True, help="Where to write the JSON summary")
+    parser.add_argument("--summary-csv", help="Optional CSV copy of the summary")
+    parser.add_argument("--baseline", help="Baseline JSON summary to compare against")
+    parser.add_argument("--threshold", type=float, default=10.0,
+                        help="Allowed growth in percent before a query counts as regressed")
+    parser.add_argument("--min-delta-sec", type=float, default=0.05,
+                        help="Ignore time growth smaller than this many seconds")
+    parser.add_argument("--min-delta-mb", type=float, default=16.0,
+                        help="Ignore memory growth smaller than this many MB")
+    parser.add_argument("--update-baseline", action="store_true",
+                        help="Write the new summary to --baseline instead of comparing")
+    args = parser.parse_args()
+
+    results_path = pathlib.Path(args.results)
+    with results_path.open(encoding="utf-8", newline="") as handle:
+        rows = list(csv.DictReader(handle))
+    records = summarise(rows)
+
+    summary = {
+        "generated_at": time.strftime("%Y-%m-%dT%H:%M:%SZ", time.gmtime()),
+        "git_commit": git_commit(results_path.resolve().parent),
+        "host": {"machine": platform.machine(), "system": platform.system(), "node": platform.node()},
+        "results": records,
+    }
+    summary_path = pathlib.Path(args.summary_json)
+    summary_path.parent.mkdir(parents=True, exist_ok=True)
+    summary_path.write_text(json.dumps(summary, indent=2) + "\n", encoding="utf-8")
+    if args.summary_csv:
+        write_summary_csv(pathlib.Path(args.summary_csv), records)
+    print(f"Benchmark summary written to {summary_path}")
+
+    if not args.baseline:
+        return
+    baseline_path = pathlib.Path(args.baseline)
+    if args.update_baseline:
+        baseline_path.write_text(json.dumps(summary, indent=2) + "\n", encoding="utf-8")
+        print(f"Baseline updated at {baseline_path}")
+        return
+    if not baseline_path.exists():
+        print(f"No baseline at {baseline_path}; skipping regression check.")
+        return
+
+    baseline = json.loads(baseline_path.read_text(encoding="utf-8"))["results"]
+    regressions = compare(records, baseline, args.threshold, args.min_delta_sec, args.min_delta_mb)
+    if regressions:
+        print(f"Regressions beyond {args.threshold:.1f}% against {baseline_path}:", file=sys.stderr)
+        for line in regressions:
+            print(f"  {line}", file=sys.stderr)
+        sys.exit(1)
+    print(f"No regressions beyond {args.threshold:.1f}% against {baseline_path}.")
+
+
+if __name__ == "__main__":
+    main()
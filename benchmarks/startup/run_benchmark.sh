@@ -0,0 +1,172 @@
+#!/usr/bin/env bash
+
+set -euo pipefail
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_ROOT="$(cd "$SCRIPT_DIR/../.." && pwd)"
+
+if [[ -z "${TLANG_STARTUP_BENCH_IN_NIX:-}" && -z "${IN_NIX_SHELL:-}" && -x "$(command -v nix || true)" ]]; then
+  exec nix develop "$PROJECT_ROOT" -c env TLANG_STARTUP_BENCH_IN_NIX=1 bash "$0" "$@"
+fi
+
+usage() {
+  cat <<EOF
+Usage: $(basename "$0") [options]
+
+Times \`t run\` on a trivial pipeline node script under each script cache
+setting and reports the median wall time of each.
+
+Modes:
+  off       TLANG_SCRIPT_CACHE=0: parse and check every run
+  cold      an empty TLANG_CACHE_DIR per run: parse, check and write the entry
+  warm      a primed TLANG_CACHE_DIR: load the entry
+  builder   as inside a Nix build (NIX_BUILD_TOP set, HOME in the build
+            directory, no TLANG_CACHE_DIR): parse and check, nothing written
+
+Before the cache skipped Nix builds, a node ran as "cold" on every build;
+it now runs as "builder".
+
+Options:
+  --script PATH        Script to run (default: scripts/trivial_node.t)
+  --iterations N       Runs per mode (default: 20)
+  --results PATH       Output CSV path (default: results/results.csv)
+  --help               Show this message
+EOF
+}
+
+SCRIPT_PATH="$SCRIPT_DIR/scripts/trivial_node.t"
+ITERATIONS=20
+RESULTS_PATH="$SCRIPT_DIR/results/results.csv"
+
+while [[ $# -gt 0 ]]; do
+  case "$1" in
+    --script)
+      SCRIPT_PATH="${2:?missing value for --script}"
+      shift 2
+      ;;
+    --iterations)
+      ITERATIONS="${2:?missing value for --iterations}"
+      shift 2
+      ;;
+    --results)
+      RESULTS_PATH="${2:?missing value for --results}"
+      shift 2
+      ;;
+    --help)
+      usage
+      exit 0
+      ;;
+    *)
+      echo "Unknown option: $1" >&2
+      usage >&2
+      exit 1
+      ;;
+  esac
+done
+
+# Find the actual binary path, ignoring shell functions/aliases
+T_BIN="$(type -p t || true)"
+if [[ -z "$T_BIN" || ! -x "$T_BIN" ]]; then
+  if [[ -f "$PROJECT_ROOT/_build/default/src/repl.exe" ]]; then
+    T_BIN="$PROJECT_ROOT/_build/default/src/repl.exe"
+  elif [[ -L "$PROJECT_ROOT/result" && -f "$PROJECT_ROOT/result/bin/t" ]]; then
+    T_BIN="$PROJECT_ROOT/result/bin/t"
+  fi
+fi
+
+if [[ -z "$T_BIN" ]]; then
+  echo "Error: 't' command not found in PATH and no compiled binary found in _build or result." >&2
+  echo "Please run 'dune build' or 'nix build' to compile the T language before running benchmarks." >&2
+  exit 1
+fi
+
+WORK_DIR="$(mktemp -d)"
+trap 'rm -rf "$WORK_DIR"' EXIT
+WARM_CACHE="$WORK_DIR/warm-cache"
+
+mkdir -p "$(dirname "$RESULTS_PATH")"
+printf 'mode,iteration,time_sec,checksum,status\n' > "$RESULTS_PATH"
+
+# Wall time of one run in seconds, from the shell's own clock so that
+# differences of a few milliseconds are not rounded away.
+now() {
+  date +%s.%N
+}
+
+run_node() {
+  local mode="$1"
+  local iteration="$2"
+  local build_dir="$WORK_DIR/build-$mode-$iteration"
+  local stdout_file="$WORK_DIR/stdout"
+  mkdir -p "$build_dir/out"
+
+  local -a env_args=(env -u TLANG_CACHE_DIR -u XDG_CACHE_HOME -u NIX_BUILD_TOP
+                     HOME="$build_dir" STARTUP_BENCH_OUT="$build_dir/out")
+  case "$mode" in
+    off) env_args+=(TLANG_SCRIPT_CACHE=0) ;;
+    cold) env_args+=(TLANG_CACHE_DIR="$build_dir/cache") ;;
+    warm) env_args+=(TLANG_CACHE_DIR="$WARM_CACHE") ;;
+    builder) env_args+=(NIX_BUILD_TOP="$build_dir") ;;
+  esac
+
+  local status="ok"
+  local start end
+  start="$(now)"
+  if ! (cd "$build_dir" && "${env_args[@]}" "$T_BIN" run --unsafe --mode repl "$SCRIPT_PATH") \
+       >"$stdout_file" 2>"$WORK_DIR/stderr"; then
+    status="fail"
+    cat "$WORK_DIR/stderr" >&2
+  fi
+  end="$(now)"
+
+  local checksum
+  checksum="$(awk -F= '$1 == "CHECKSUM" { value = $2 } END { print (value == "" ? "NA" : value) }' "$stdout_file")"
+  printf '%s,%s,%s,%s,%s\n' "$mode" "$iteration" \
+    "$(awk -v s="$start" -v e="$end" 'BEGIN { printf "%.4f", e - s }')" \
+    "$checksum" "$status" >> "$RESULTS_PATH"
+  rm -rf "$build_dir"
+}
+
+# Prime the warm cache once; this run is not recorded.
+mkdir -p "$WORK_DIR/prime/out"
+(cd "$WORK_DIR/prime" && env TLANG_CACHE_DIR="$WARM_CACHE" STARTUP_BENCH_OUT="$WORK_DIR/prime/out" \
+   "$T_BIN" run --unsafe --mode repl "$SCRIPT_PATH") >/dev/null
+
+# Interleave the modes so that drift in machine load hits all of them alike.
+for iteration in $(seq 1 "$ITERATIONS"); do
+  for mode in off cold warm builder; do
+    run_node "$mode" "$iteration"
+  done
+done
+
+echo "Results written to $RESULTS_PATH"
+echo
+
+awk -F, '
+  NR == 1 { next }
+  $5 != "ok" { failed[$1] = 1; next }
+  { times[$1] = times[$1] " " $3; sums[$1] = $4 }
+  function median(list,    arr, n, i, j, tmp) {
+    n = split(list, arr, " ")
+    for (i = 1; i <= n; i++)
+      for (j = i + 1; j <= n; j++)
+        if (arr[j] + 0 < arr[i] + 0) { tmp = arr[i]; arr[i] = arr[j]; arr[j] = tmp }
+    return (n % 2) ? arr[(n + 1) / 2] : (arr[n / 2] + arr[n / 2 + 1]) / 2
+  }
+  END {
+    bad = 0
+    split("off cold warm builder", modes, " ")
+    printf "%-8s %10s  %s\n", "mode", "median_ms", "checksum"
+    for (i = 1; i <= 4; i++) {
+      m = modes[i]
+      if (m in failed) { printf "%-8s failed\n", m; bad = 1; continue }
+      med[m] = median(times[m])
+      printf "%-8s %10.1f  %s\n", m, 1000 * med[m], sums[m]
+      if (sums[m] != sums["off"]) bad = 1
+    }
+    if (med["builder"] > 0)
+      printf "\nnode in a Nix build: %.1f ms before (cold), %.1f ms now (builder), %.2fx\n",
+        1000 * med["cold"], 1000 * med["builder"], med["cold"] / med["builder"]
+    exit bad
+  }
+' "$RESULTS_PATH"
@@ -0,0 +1,10 @@
+-- The shape of a small pipeline node: a few bindings, one result, and the
+-- artifact and class writes an emitted node_script.t ends with.
+out_dir = env("STARTUP_BENCH_OUT")
+rows = [a: 1, b: 2, c: 3]
+__node_result = rows.a + rows.b * rows.c
+res1 = write_text(str_join([out_dir, "/artifact"]), to_string(__node_result))
+if (is_error(res1)) { print("Serialization failed:"); print(res1); exit(1) } else { 0 }
+res2 = write_text(str_join([out_dir, "/class"]), type(__node_result))
+if (is_error(res2)) { print("Class write failed:"); print(res2); exit(1) } else { 0 }
+print(str_join(["CHECKSUM=", to_string(__node_result)]))
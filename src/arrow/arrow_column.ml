@@ -5,17 +5,266 @@
 
 open Bigarray
 
-(** A column view — references the backing table to prevent GC collection *)
+(** A zero-copy numeric view backed by a Bigarray over Arrow memory *)
+type numeric_view =
+  | FloatView of (float, float64_elt, c_layout) Array1.t
+  | IntView of (int64, int64_elt, c_layout) Array1.t
+
+(** The value and validity buffers of a native numeric column.
+    [owner] holds a reference to the Arrow array both Bigarrays point into,
+    so the memory stays valid for as long as the record is reachable.
+    [validity] is the Arrow null bitmap (None when there are no nulls);
+    row [i] is valid when bit [bit_offset + i] is set. *)
+type buffer_view = {
+  owner : Arrow_ffi.array_owner;
+  values : numeric_view;
+  validity : Arrow_ffi.validity_bitmap option;
+  bit_offset : int;
+  null_count : int;
+}
+
+(** A column view — references the backing table to prevent GC collection.
+    Native Float64/Int64 columns are served from [buffers]; [data] is then
+    only materialised into an option array when a caller asks for it. *)
 type column_view = {
   backing : Arrow_table.t;
   column_name : string;
-  data : Arrow_table.column_data;
+  buffers : buffer_view option;
+  data : Arrow_table.column_data Lazy.t;
 }
 
-(** A zero-copy numeric view backed by a Bigarray over Arrow memory *)
-type numeric_view =
-  | FloatView of (float, float64_elt, c_layout) Array1.t
-  | IntView of (int64, int64_elt, c_layout) Array1.t
+(* The Bigarrays of a buffer view point into memory owned by the Arrow
+   array behind [owner]; when the owner is collected that memory is
+   released. The value Bigarray therefore carries one finaliser, attached
+   when the view is made, whose closure holds the owner: a Bigarray handed
+   out on its own keeps the owner reachable for as long as it is. *)
+let make_view owner values validity bit_offset null_count : buffer_view =
+  let keep ba = Gc.finalise (fun _ -> ignore (Sys.opaque_identity owner)) ba in
+  (match values with
+   | FloatView ba -> keep ba
+   | IntView ba -> keep ba);
+  { owner; values; validity; bit_offset; null_count }
+
+(** Map the native buffers of a Float64 or Int64 column without copying.
+    
+    @param table The input Arrow table.
+    @param name The column name.
+    @return [Some view] for native numeric columns, otherwise [None]. *)
+let buffer_view (table : Arrow_table.t) (name : string) : buffer_view option =
+  match table.native_handle with
+  | Some handle when not handle.Arrow_table.freed ->
+    (match Arrow_table.column_type table name with
+     | Some Arrow_table.ArrowFloat64 ->
+       (match Arrow_ffi.arrow_float64_column_buffers handle.ptr name with
+        | Some (owner, ba, validity, bit_offset, null_count) ->
+          Some (make_view owner (FloatView ba) validity bit_offset null_count)
+        | None -> None)
+     | Some Arrow_table.ArrowInt64 ->
+       (match Arrow_ffi.arrow_int64_column_buffers handle.ptr name with
+        | Some (owner, ba, validity, bit_offset, null_count) ->
+          Some (make_view owner (IntView ba) validity bit_offset null_count)
+        | None -> None)
+     | _ -> None)
+  | _ -> None
+
+(** Number of rows covered by a buffer view. *)
+let buffer_length (view : buffer_view) : int =
+  match view.values with
+  | FloatView ba -> Array1.dim ba
+  | IntView ba -> Array1.dim ba
+
+(** The zero-copy value Bigarray of a buffer view. The Bigarray keeps the
+    Arrow buffer alive, but slices taken from it with [Array1.sub] do not:
+    keep the returned Bigarray (or the view) reachable while using them. *)
+let buffer_values (view : buffer_view) : numeric_view = view.values
+
+(** Number of null rows in a buffer view. *)
+let buffer_null_count (view : buffer_view) : int = view.null_count
+
+(** The Arrow validity bitmap and its bit offset; [None] when the column
+    has no nulls. *)
+let buffer_validity (view : buffer_view) : (Arrow_ffi.validity_bitmap * int) option =
+  Option.map (fun bitmap -> (bitmap, view.bit_offset)) view.validity
+
+(** Whether row [i] holds a value, read straight from the validity bitmap. *)
+let is_valid (view : buffer_view) (i : int) : bool =
+  match view.validity with
+  | None -> true
+  | Some bitmap ->
+    let bit = view.bit_offset + i in
+    (Array1.get bitmap (bit lsr 3)) land (1 lsl (bit land 7)) <> 0
+
+(** Read row [i] as a float, ignoring validity. *)
+let float_at (view : buffer_view) (i : int) : float =
+  match view.values with
+  | FloatView ba -> ba.{i}
+  | IntView ba -> Int64.to_float ba.{i}
+
+(** Copy a buffer view into an unboxed float array.
+    
+    @param view The buffer view.
+    @return [Some arr] when the column has no nulls, otherwise [None]. *)
+let to_float_array (view : buffer_view) : float array option =
+  if view.null_count > 0 then None
+  else begin
+    let n = buffer_length view in
+    let out =
+      match view.values with
+      | FloatView ba -> Array.init n (fun i -> Array1.unsafe_get ba i)
+      | IntView ba -> Array.init n (fun i -> Int64.to_float (Array1.unsafe_get ba i))
+    in
+    ignore (Sys.opaque_identity view.owner);
+    Some out
+  end
+
+(** Null mask of a buffer view, true where the row is NA. *)
+let null_mask (view : buffer_view) : bool array =
+  let n = buffer_length view in
+  let mask =
+    if view.null_count = 0 then Array.make n false
+    else Array.init n (fun i -> not (is_valid view i))
+  in
+  ignore (Sys.opaque_identity view.owner);
+  mask
+
+(** Materialise a buffer view into the boxed [column_data] representation. *)
+let buffer_to_column_data (view : buffer_view) : Arrow_table.column_data =
+  let n = buffer_length view in
+  let col =
+    match view.values with
+    | FloatView ba ->
+      Arrow_table.FloatColumn (Array.init n (fun i ->
+        if is_valid view i then Some ba.{i} else None))
+    | IntView ba ->
+      Arrow_table.IntColumn (Array.init n (fun i ->
+        if is_valid view i then Some (Int64.to_int ba.{i}) else None))
+  in
+  ignore (Sys.opaque_identity view.owner);
+  col
+
+(** Add or replace column [name] of [table] from a numeric Bigarray and an
+    optional validity bitmap (bit [i] set when row [i] is valid). Native
+    tables receive the buffers with one copy each and keep their other
+    columns as they are; OCaml tables get a boxed column.
+
+    @return [None] when the length does not match the table. *)
+let add_numeric_column (table : Arrow_table.t) (name : string) (values : numeric_view)
+    (validity : Arrow_ffi.validity_bitmap option) : Arrow_table.t option =
+  let n = match values with FloatView ba -> Array1.dim ba | IntView ba -> Array1.dim ba in
+  if n <> Arrow_table.num_rows table then None
+  else
+    let native =
+      match table.native_handle with
+      | Some handle when not handle.Arrow_table.freed ->
+        let buffers =
+          match values with
+          | FloatView ba -> Arrow_ffi.Float64_buffer (ba, validity)
+          | IntView ba -> Arrow_ffi.Int64_buffer (ba, validity)
+        in
+        Option.map (fun ptr ->
+          Arrow_table.create_from_native ptr (Arrow_table.schema_from_native_ptr ptr) n)
+          (Arrow_ffi.arrow_table_set_buffer_column handle.ptr name buffers)
+      | _ -> None
+    in
+    match native with
+    | Some t -> Some t
+    | None ->
+      let valid i =
+        match validity with
+        | None -> true
+        | Some bitmap -> (Array1.get bitmap (i lsr 3)) land (1 lsl (i land 7)) <> 0
+      in
+      let col =
+        match values with
+        | FloatView ba ->
+          Arrow_table.FloatColumn (Array.init n (fun i -> if valid i then Some ba.{i} else None))
+        | IntView ba ->
+          Arrow_table.IntColumn (Array.init n (fun i -> if valid i then Some (Int64.to_int ba.{i}) else None))
+      in
+      Some (Arrow_table.add_column table name col)
+
+(** Pack runtime values straight into a numeric Bigarray and validity bitmap
+    for [add_numeric_column], skipping the boxed option column.
+
+    @return [None] unless every value is an Int or every value is a Float,
+            NAs aside, with at least one value present. *)
+let numeric_of_values (values : Ast.value array)
+    : (numeric_view * Arrow_ffi.validity_bitmap option) option =
+  let n = Array.length values in
+  let kind =
+    Array.fold_left (fun acc v ->
+      match acc, v with
+      | _, Ast.VNA Ast.NAGeneric -> acc
+      | Some `Empty, (Ast.VInt _ | Ast.VNA Ast.NAInt) -> Some `Int
+      | Some `Empty, (Ast.VFloat _ | Ast.VNA Ast.NAFloat) -> Some `Float
+      | Some `Int, (Ast.VInt _ | Ast.VNA Ast.NAInt) -> acc
+      | Some `Float, (Ast.VFloat _ | Ast.VNA Ast.NAFloat) -> acc
+      | _ -> None) (Some `Empty) values
+  in
+  let present = Array.exists (function Ast.VInt _ | Ast.VFloat _ -> true | _ -> false) values in
+  (* Store each present value and set its validity bit; the bitmap is
+     dropped when no value is missing. *)
+  let pack store =
+    let validity = Array1.create int8_unsigned c_layout ((n + 7) / 8) in
+    Array1.fill validity 0;
+    let nulls = ref 0 in
+    Array.iteri (fun i v ->
+      if store i v then validity.{i lsr 3} <- validity.{i lsr 3} lor (1 lsl (i land 7))
+      else incr nulls) values;
+    if !nulls = 0 then None else Some validity
+  in
+  match kind with
+  | Some `Int when present ->
+    let ba = Array1.create int64 c_layout n in
+    let validity = pack (fun i v ->
+      match v with
+      | Ast.VInt x -> ba.{i} <- Int64.of_int x; true
+      | _ -> ba.{i} <- 0L; false) in
+    Some (IntView ba, validity)
+  | Some `Float when present ->
+    let ba = Array1.create float64 c_layout n in
+    let validity = pack (fun i v ->
+      match v with
+      | Ast.VFloat x -> ba.{i} <- x; true
+      | _ -> ba.{i} <- 0.0; false) in
+    Some (FloatView ba, validity)
+  | _ -> None
+
+(** Convert a buffer view to T-Lang runtime values without the intermediate
+    option array. *)
+let buffer_to_values (view : buffer_view) : Ast.value array =
+  let n = buffer_length view in
+  let values =
+    match view.values with
+    | FloatView ba ->
+      Array.init n (fun i ->
+        if is_valid view i then Ast.VFloat ba.{i} else Ast.VNA Ast.NAFloat)
+    | IntView ba ->
+      Array.init n (fun i ->
+        if is_valid view i then Ast.VInt (Int64.to_int ba.{i}) else Ast.VNA Ast.NAInt)
+  in
+  ignore (Sys.opaque_identity view.owner);
+  values
+
+(** Restrict a buffer view to [len] rows starting at [start] (already clamped). *)
+let sub_buffer_view (view : buffer_view) (start : int) (len : int) : buffer_view =
+  let values =
+    match view.values with
+    | FloatView ba -> FloatView (Array1.sub ba start len)
+    | IntView ba -> IntView (Array1.sub ba start len)
+  in
+  let shifted = { view with values; bit_offset = view.bit_offset + start } in
+  let null_count =
+    if view.null_count = 0 then 0
+    else begin
+      let c = ref 0 in
+      for i = 0 to len - 1 do
+        if not (is_valid shifted i) then incr c
+      done;
+      !c
+    end
+  in
+  make_view view.owner values view.validity shifted.bit_offset null_count
 
 (** Get a column view from an Arrow table.
     
@@ -23,60 +272,60 @@ type numeric_view =
     @param name The name of the column to extract.
     @return [Some view] if found, otherwise [None]. *)
 let get_column (table : Arrow_table.t) (name : string) : column_view option =
-  match Arrow_table.get_column table name with
-  | Some data -> Some { backing = table; column_name = name; data }
-  | None -> None
+  match buffer_view table name with
+  | Some buffers ->
+    Some { backing = table; column_name = name; buffers = Some buffers;
+           data = lazy (buffer_to_column_data buffers) }
+  | None ->
+    match Arrow_table.get_column table name with
+    | Some data ->
+      Some { backing = table; column_name = name; buffers = None;
+             data = Lazy.from_val data }
+    | None -> None
+
+(** Retrieve the native buffers backing a column view, if any.
+    
+    @param view The column view.
+    @return [Some buffers] for native Float64/Int64 columns. *)
+let buffers (view : column_view) : buffer_view option =
+  view.buffers
 
 (** Retrieve the Arrow data type of a column view.
     
     @param view The column view.
     @return The associated Arrow data type representation. *)
 let column_type (view : column_view) : Arrow_table.arrow_type =
-  Arrow_table.column_type_of view.data
+  match view.buffers with
+  | Some { values = FloatView _; _ } -> Arrow_table.ArrowFloat64
+  | Some { values = IntView _; _ } -> Arrow_table.ArrowInt64
+  | None -> Arrow_table.column_type_of (Lazy.force view.data)
 
 (** Retrieve the total row length of a column view.
     
     @param view The column view.
     @return The integer length. *)
 let column_length (view : column_view) : int =
-  Arrow_table.column_length view.data
+  match view.buffers with
+  | Some buffers -> buffer_length buffers
+  | None -> Arrow_table.column_length (Lazy.force view.data)
 
 (** Retrieve the raw internal column data variant structure.
     
     @param view The column view.
     @return The internal [column_data] structure. *)
 let column_data (view : column_view) : Arrow_table.column_data =
-  view.data
+  Lazy.force view.data
 
 (** Create a zero-copy Bigarray view over an Arrow column's binary buffer.
+    The Bigarray keeps the Arrow buffer alive on its own (see
+    [buffer_values]); prefer [buffers] when the validity bitmap is needed.
     
     @param col The column view.
     @return [Some numeric_view] if successful and supported, otherwise [None]. *)
 let zero_copy_view (col : column_view) : numeric_view option =
-  match col.backing.native_handle with
-  | Some handle when not handle.Arrow_table.freed ->
-    (match Arrow_table.column_type_of col.data with
-     | Arrow_table.ArrowFloat64 ->
-       (match Arrow_ffi.arrow_table_get_column_data handle.ptr col.column_name with
-        | Some array_ptr ->
-          (match Arrow_ffi.arrow_float64_array_to_bigarray array_ptr with
-           | Some ba ->
-             (* Keep the backing table alive as long as this view is reachable *)
-             ignore (Sys.opaque_identity col.backing);
-             Some (FloatView ba)
-           | None -> None)
-        | None -> None)
-     | Arrow_table.ArrowInt64 ->
-       (match Arrow_ffi.arrow_table_get_column_data handle.ptr col.column_name with
-        | Some array_ptr ->
-          (match Arrow_ffi.arrow_int64_array_to_bigarray array_ptr with
-           | Some ba ->
-             ignore (Sys.opaque_identity col.backing);
-             Some (IntView ba)
-           | None -> None)
-        | None -> None)
-     | _ -> None)
-  | _ -> None
+  match col.buffers with
+  | Some buffers -> Some buffers.values
+  | None -> None
 
 (** Access a single element from a column view.
     
@@ -87,7 +336,13 @@ let get_value_at (view : column_view) (idx : int) : Ast.value =
   let len = column_length view in
   if idx < 0 || idx >= len then Ast.(VNA NAGeneric)
   else
-    match view.data with
+    match view.buffers with
+    | Some ({ values = FloatView ba; _ } as buffers) ->
+      if is_valid buffers idx then Ast.VFloat ba.{idx} else Ast.VNA Ast.NAFloat
+    | Some ({ values = IntView ba; _ } as buffers) ->
+      if is_valid buffers idx then Ast.VInt (Int64.to_int ba.{idx}) else Ast.VNA Ast.NAInt
+    | None ->
+    match Lazy.force view.data with
     | Arrow_table.IntColumn a ->
       (match a.(idx) with Some i -> Ast.VInt i | None -> Ast.VNA Ast.NAInt)
     | Arrow_table.FloatColumn a ->
@@ -116,7 +371,13 @@ let get_slice (view : column_view) (start : int) (len : int) : column_view =
   let total = column_length view in
   let actual_start = max 0 (min start total) in
   let actual_len = max 0 (min len (total - actual_start)) in
-  let slice_data = match view.data with
+  match view.buffers with
+  | Some buffers ->
+    let sub = sub_buffer_view buffers actual_start actual_len in
+    { backing = view.backing; column_name = view.column_name; buffers = Some sub;
+      data = lazy (buffer_to_column_data sub) }
+  | None ->
+  let slice_data = match Lazy.force view.data with
     | Arrow_table.IntColumn a ->
       Arrow_table.IntColumn (Array.sub a actual_start actual_len)
     | Arrow_table.FloatColumn a ->
@@ -136,11 +397,22 @@ let get_slice (view : column_view) (start : int) (len : int) : column_view =
     | Arrow_table.ListColumn a ->
       Arrow_table.ListColumn (Array.sub a actual_start actual_len)
   in
-  { backing = view.backing; column_name = view.column_name; data = slice_data }
+  { backing = view.backing; column_name = view.column_name; buffers = None;
+    data = Lazy.from_val slice_data }
+
+(** Convert a column view to an array of T-Lang runtime values.
+    Native numeric columns are read straight from their buffers.
+    
+    @param view The column view.
+    @return An array of T-Lang [value] elements. *)
+let column_view_to_values (view : column_view) : Ast.value array =
+  match view.buffers with
+  | Some buffers -> buffer_to_values buffers
+  | None -> Arrow_bridge.column_to_values (Lazy.force view.data)
 
 (** Convert a column view to a list of T-Lang runtime values.
     
     @param view The column view.
     @return A list of T-Lang [value] elements. *)
 let column_view_to_list (view : column_view) : Ast.value list =
-  Array.to_list (Arrow_bridge.column_to_values view.data)
+  Array.to_list (column_view_to_values view)
@@ -9,14 +9,71 @@ type numeric_view =
   | FloatView of (float, float64_elt, c_layout) Array1.t
   | IntView of (int64, int64_elt, c_layout) Array1.t
 
+(** The value and validity buffers of a native Float64/Int64 column, mapped
+    without copying. Keeps the underlying Arrow array alive while reachable. *)
+type buffer_view
+
+(** Map the native buffers of a Float64 or Int64 column.
+    Returns [None] for pure OCaml tables and other column types. *)
+val buffer_view : Arrow_table.t -> string -> buffer_view option
+
+val buffer_length : buffer_view -> int
+
+(** The value Bigarray. It keeps the Arrow buffer alive while it is
+    reachable; slices taken with [Array1.sub] do not, so keep the returned
+    Bigarray or the [buffer_view] reachable while using them. *)
+val buffer_values : buffer_view -> numeric_view
+
+val buffer_null_count : buffer_view -> int
+
+(** The validity bitmap and bit offset of row 0; [None] when there are no nulls.
+    Only valid while the [buffer_view] is reachable. *)
+val buffer_validity : buffer_view -> (Arrow_ffi.validity_bitmap * int) option
+
+(** [is_valid view i] reads row [i]'s bit from the Arrow validity bitmap. *)
+val is_valid : buffer_view -> int -> bool
+
+(** Read row [i] as a float (Int64 values are converted), ignoring validity. *)
+val float_at : buffer_view -> int -> float
+
+(** Copy into an unboxed float array; [None] when the column has nulls. *)
+val to_float_array : buffer_view -> float array option
+
+(** Bool mask where [true] marks an NA row. *)
+val null_mask : buffer_view -> bool array
+
+(** Materialise a buffer view into boxed [column_data]. *)
+val buffer_to_column_data : buffer_view -> Arrow_table.column_data
+
+(** Convert a buffer view straight to runtime values. *)
+val buffer_to_values : buffer_view -> Ast.value array
+
+(** Add or replace a column from a numeric Bigarray and optional validity
+    bitmap. Native tables take the buffers with one copy and share their
+    other columns. [None] when the length does not match the table. *)
+val add_numeric_column :
+  Arrow_table.t -> string -> numeric_view -> Arrow_ffi.validity_bitmap option -> Arrow_table.t option
+
+(** Pack an all-Int or all-Float runtime vector (NAs allowed) into the
+    arguments of [add_numeric_column]; [None] for any other vector. *)
+val numeric_of_values :
+  Ast.value array -> (numeric_view * Arrow_ffi.validity_bitmap option) option
+
+(** Get a column view. Native numeric columns are backed by their buffers and
+    only materialised into [column_data] on demand. *)
 val get_column : Arrow_table.t -> string -> column_view option
 
+(** Native buffers backing a column view, if any. *)
+val buffers : column_view -> buffer_view option
+
 val column_type : column_view -> Arrow_table.arrow_type
 
 val column_length : column_view -> int
 
 val column_data : column_view -> Arrow_table.column_data
 
+(** The value Bigarray of a native numeric column, which keeps the Arrow
+    buffer alive on the same terms as [buffer_values]. *)
 val zero_copy_view : column_view -> numeric_view option
 
 (** Access a single element from a column view.
@@ -27,6 +84,10 @@ val get_value_at : column_view -> int -> Ast.value
     This function is bounds-safe and clamps start/len indices to prevent out-of-bounds exceptions. *)
 val get_slice : column_view -> int -> int -> column_view
 
+(** Convert a column view to an array of T-Lang runtime values, reading native
+    numeric buffers directly. *)
+val column_view_to_values : column_view -> Ast.value array
+
 (** Convert a column view to a list of T-Lang runtime values.
     @deprecated This function has O(n) heap allocation cost and loses SIMD layout benefits. Avoid in hot paths. *)
 val column_view_to_list : column_view -> Ast.value list
@@ -6,6 +6,10 @@
 
 type comparison_op = Eq | Lt | Gt | Le | Ge
 
+(** Op codes shared by the native comparison kernels. *)
+let comparison_op_code = function
+  | Eq -> 0 | Lt -> 1 | Gt -> 2 | Le -> 3 | Ge -> 4
+
 (** Project (select) columns by name.
     Uses native Arrow projection (zero-copy) when available. *)
 let project (t : Arrow_table.t) (names : string list) : Arrow_table.t =
@@ -52,15 +56,75 @@ let sort_by_indices = Arrow_table.sort_by_indices
 (** Rename columns — delegates to Arrow_table.rename_columns *)
 let rename_columns = Arrow_table.rename_columns
 
-(** Sort table by column name using native Arrow sort when available.
-    Returns a new table sorted by the given column.
+(** Stable sort order of a native table by [(column, ascending)] keys,
+    NAs last. Returns None for non-native tables or unsupported key types. *)
+let sort_indices (t : Arrow_table.t) (keys : (string * bool) list) : int array option =
+  match t.native_handle with
+  | Some handle when not handle.Arrow_table.freed && keys <> [] ->
+      Arrow_ffi.arrow_compute_sort_indices handle.ptr (List.map fst keys) (List.map snd keys)
+  | _ -> None
+
+(** Sort a native table by [(column, ascending)] keys with the typed sort
+    kernel, or with an external merge sort through spill files when the
+    table is over the memory limit (see {!Spill}). Returns None when
+    {!sort_indices} does. *)
+let sort_by_keys (t : Arrow_table.t) (keys : (string * bool) list) : Arrow_table.t option =
+  match Spill.sort t keys with
+  | Some sorted -> Some sorted
+  | None ->
+      (match sort_indices t keys with
+       | Some indices -> Some (sort_by_indices t indices)
+       | None -> None)
+
+(** Sort table by column name using native sort when available.
+    Returns a new table sorted by the given column. Uses the typed sort
+    kernel, then Arrow's sort for key types it does not handle.
     Falls back to None when no native handle is present. *)
 let sort_by_column (t : Arrow_table.t) (col_name : string) (ascending : bool) : Arrow_table.t option =
+  match sort_by_keys t [(col_name, ascending)] with
+  | Some sorted -> Some sorted
+  | None ->
+      (match t.native_handle with
+       | Some handle when not handle.Arrow_table.freed ->
+           (match Arrow_ffi.arrow_table_sort handle.ptr col_name ascending with
+            | Some new_ptr ->
+                Some (Arrow_table.create_from_native new_ptr t.schema t.nrows)
+            | None -> None)
+       | _ -> None)
+
+(* ===================================================================== *)
+(* Hash Join                                                             *)
+(* ===================================================================== *)
+
+type join_kind = Inner_join | Left_join | Full_join | Semi_join | Anti_join
+
+let join_kind_code = function
+  | Inner_join -> 0
+  | Left_join -> 1
+  | Full_join -> 2
+  | Semi_join -> 3
+  | Anti_join -> 4
+
+(** Match rows of two native tables on identically typed key columns.
+    Returns [(left_indices, right_indices)] in output order, where [-1]
+    marks the missing side of an unmatched row; semi and anti joins return
+    an empty right array. [None] when either table is not native or a key
+    type is unsupported, so callers can fall back to the OCaml join. *)
+let hash_join_indices (left : Arrow_table.t) (right : Arrow_table.t)
+    (keys : string list) (kind : join_kind) : (int array * int array) option =
+  match left.native_handle, right.native_handle with
+  | Some hl, Some hr when not hl.Arrow_table.freed && not hr.Arrow_table.freed && keys <> [] ->
+      Arrow_ffi.arrow_hash_join hl.ptr hr.ptr keys (join_kind_code kind)
+  | _ -> None
+
+(** Gather rows by index where a negative index produces an all-null row.
+    Native tables only; [None] otherwise. *)
+let take_with_nulls (t : Arrow_table.t) (indices : int array) : Arrow_table.t option =
   match t.native_handle with
   | Some handle when not handle.Arrow_table.freed ->
-      (match Arrow_ffi.arrow_table_sort handle.ptr col_name ascending with
+      (match Arrow_ffi.arrow_table_take handle.ptr indices with
        | Some new_ptr ->
-           Some (Arrow_table.create_from_native new_ptr t.schema t.nrows)
+           Some (Arrow_table.create_from_native new_ptr t.schema (Array.length indices))
        | None -> None)
   | _ -> None
 
@@ -514,7 +578,8 @@ and group_aggregate_ocaml (grouped : grouped_table) (agg_name : string) (col_nam
   let n_groups = List.length ocaml_groups in
   let t = grouped.base_table in
   let is_valid = match agg_name with
-    | "sum" | "mean" | "count" | "min" | "max" | "count_distinct" -> true
+    | "sum" | "mean" | "count" | "min" | "max" | "count_distinct"
+    | "approx_count_distinct" -> true
     | _ -> false
   in
   if not is_valid then None
@@ -584,6 +649,8 @@ and group_aggregate_ocaml (grouped : grouped_table) (agg_name : string) (col_nam
             let seen = Value_hash.ValueHash.create (max 1 (min 64 (List.length indices))) in
             List.iter (fun i -> Value_hash.ValueHash.replace seen target_vals.(i) ()) indices;
             Ast.VInt (Value_hash.ValueHash.length seen)
+        | "approx_count_distinct" ->
+            Ast.VInt (Sketch.count_distinct (Array.of_list (List.map (fun i -> target_vals.(i)) indices)))
         | "min" ->
             let m = ref None in
             List.iter (fun i ->
@@ -631,7 +698,10 @@ let group_multi_aggregate (grouped : grouped_table)
     let agg_types = List.map (fun (a, _, _) -> a) specs in
     let col_names = List.map (fun (_, c, _) -> c) specs in
     let result_names = List.map (fun (_, _, r) -> r) specs in
-    (match Arrow_ffi.arrow_group_multi_aggregate gh.ptr agg_types col_names result_names with
+    let result = Arrow_ffi.arrow_group_multi_aggregate gh.ptr agg_types col_names result_names in
+    (* The grouped handle's row indices are read outside the runtime lock. *)
+    ignore (Sys.opaque_identity grouped);
+    (match result with
      | Some ptr ->
        let schema = schema_from_native_ptr ptr in
        let nrows = Arrow_ffi.arrow_table_num_rows ptr in
@@ -714,6 +784,20 @@ let pow_column (t : Arrow_table.t) (col_name : string) (exponent : float) : Arro
       let new_col = Arrow_bridge.values_to_column new_values in
       Some (Arrow_table.add_column t col_name new_col)
 
+(** Evaluate a fused expression natively; there is no OCaml fallback, the
+    caller keeps its operator-by-operator path for that. *)
+let eval_expression (t : Arrow_table.t) (columns : string array)
+    (program : Arrow_ffi.expr_op array) (result_name : string) : Arrow_table.t option =
+  match t.native_handle with
+  | Some handle when not handle.Arrow_table.freed ->
+    (match Arrow_ffi.arrow_eval_expression handle.ptr columns program result_name with
+     | Some new_ptr ->
+       let schema = schema_from_native_ptr new_ptr in
+       let nrows = Arrow_ffi.arrow_table_num_rows new_ptr in
+       Some (Arrow_table.create_from_native new_ptr schema nrows)
+     | None -> None)
+  | _ -> None
+
 (* ===================================================================== *)
 (* Column-Level Aggregations (Phase 5 — Week 1)                          *)
 (* ===================================================================== *)
@@ -788,6 +872,20 @@ let count_distinct_column (t : Arrow_table.t) (col_name : string) : int option =
       Array.iter (fun value -> Value_hash.ValueHash.replace seen value ()) values;
       Some (Value_hash.ValueHash.length seen)
 
+(** Approximate the number of distinct values in a named column with a
+    HyperLogLog sketch, natively when the table is native-backed. *)
+let approx_count_distinct_column (t : Arrow_table.t) (col_name : string) : int option =
+  let ocaml () =
+    Option.map (fun col -> Sketch.count_distinct (Arrow_bridge.column_to_values col))
+      (Arrow_table.get_column t col_name)
+  in
+  match t.native_handle with
+  | Some handle when not handle.Arrow_table.freed ->
+    (match Arrow_ffi.arrow_approx_count_distinct handle.ptr col_name with
+     | Some _ as result -> result
+     | None -> ocaml ())
+  | _ -> ocaml ()
+
 (* ===================================================================== *)
 (* Comparison Operations (Phase 5 — Week 1)                              *)
 (* ===================================================================== *)
@@ -797,9 +895,7 @@ let count_distinct_column (t : Arrow_table.t) (col_name : string) : int option =
     op: "eq", "lt", "gt", "le", "ge" *)
 let compare_column_scalar (t : Arrow_table.t) (col_name : string)
     (scalar : float) (op : comparison_op) : bool array option =
-  let op_code = match op with
-    | Eq -> 0 | Lt -> 1 | Gt -> 2 | Le -> 3 | Ge -> 4
-  in
+  let op_code = comparison_op_code op in
   (* Try native Arrow path first *)
   match t.native_handle with
   | Some handle when not handle.Arrow_table.freed ->
@@ -851,11 +947,98 @@ let column_null_mask (t : Arrow_table.t) (col_name : string) : bool array option
   in
   match t.native_handle with
   | Some handle when not handle.Arrow_table.freed ->
-      (match Arrow_ffi.arrow_column_null_mask handle.ptr col_name with
-       | Some _ as result -> result
-       | None -> ocaml_fallback ())
+      (match Arrow_column.buffer_view t col_name with
+       | Some buffers -> Some (Arrow_column.null_mask buffers)
+       | None ->
+           match Arrow_ffi.arrow_column_null_mask handle.ptr col_name with
+           | Some _ as result -> result
+           | None -> ocaml_fallback ())
   | _ -> ocaml_fallback ()
 
+(* ===================================================================== *)
+(* Native Predicate Masks                                                *)
+(* ===================================================================== *)
+
+(** A filter predicate evaluated into native keep/NA bitmaps, so compound
+    predicates combine and filter without materialising OCaml bool arrays.
+    The bitmaps are released by a GC finaliser. *)
+type native_mask = {
+  mask_ptr : nativeint;
+  mutable mask_freed : bool;
+}
+
+let wrap_mask (ptr : nativeint) : native_mask =
+  let m = { mask_ptr = ptr; mask_freed = false } in
+  Gc.finalise (fun m ->
+    if not m.mask_freed then begin
+      Arrow_ffi.arrow_mask_free m.mask_ptr;
+      m.mask_freed <- true
+    end
+  ) m;
+  m
+
+(** [col op scalar] over a numeric column of a native table; NULL rows are
+    NA. None for non-native tables or missing/non-numeric columns. *)
+let mask_compare_scalar (t : Arrow_table.t) (col_name : string)
+    (scalar : float) (op : comparison_op) : native_mask option =
+  match t.native_handle with
+  | Some handle when not handle.Arrow_table.freed ->
+      Option.map wrap_mask
+        (Arrow_ffi.arrow_mask_compare_scalar handle.ptr col_name scalar (comparison_op_code op))
+  | _ -> None
+
+(** [col == s] over a string or dictionary-encoded column of a native
+    table; dictionary chunks compare indices against the code of [s]. *)
+let mask_equal_string (t : Arrow_table.t) (col_name : string) (s : string) : native_mask option =
+  match t.native_handle with
+  | Some handle when not handle.Arrow_table.freed ->
+      Option.map wrap_mask (Arrow_ffi.arrow_mask_equal_string handle.ptr col_name s)
+  | _ -> None
+
+(** [is_na(col)] over a column of a native table. *)
+let mask_is_na (t : Arrow_table.t) (col_name : string) : native_mask option =
+  match t.native_handle with
+  | Some handle when not handle.Arrow_table.freed ->
+      Option.map wrap_mask (Arrow_ffi.arrow_mask_is_na handle.ptr col_name)
+  | _ -> None
+
+(* Keep the operands alive until the C call has returned. *)
+let mask_unary f (a : native_mask) =
+  let r = f a.mask_ptr in
+  ignore (Sys.opaque_identity a);
+  Option.map wrap_mask r
+
+let mask_binary f (a : native_mask) (b : native_mask) =
+  let r = f a.mask_ptr b.mask_ptr in
+  ignore (Sys.opaque_identity a);
+  ignore (Sys.opaque_identity b);
+  Option.map wrap_mask r
+
+(** Predicate combinators with the interpreter's short-circuit NA rules. *)
+let mask_not = mask_unary Arrow_ffi.arrow_mask_not
+let mask_and = mask_binary Arrow_ffi.arrow_mask_and
+let mask_or = mask_binary Arrow_ffi.arrow_mask_or
+
+(** Number of rows where the predicate is NA and the 1-based positions of the
+    first [limit] of them. *)
+let mask_na_rows (m : native_mask) (limit : int) : int * int list =
+  let count, rows = Arrow_ffi.arrow_mask_na_rows m.mask_ptr limit in
+  ignore (Sys.opaque_identity m);
+  (count, Array.to_list rows)
+
+(** Keep the rows of a native table where the predicate is true. *)
+let filter_by_mask (t : Arrow_table.t) (m : native_mask) : Arrow_table.t option =
+  match t.native_handle with
+  | Some handle when not handle.Arrow_table.freed ->
+      let result = Arrow_ffi.arrow_table_filter_native_mask handle.ptr m.mask_ptr in
+      ignore (Sys.opaque_identity m);
+      (match result with
+       | Some new_ptr ->
+           let nrows = Arrow_ffi.arrow_table_num_rows new_ptr in
+           Some (Arrow_table.create_from_native new_ptr t.schema nrows)
+       | None -> None)
+  | _ -> None
+
 (* ===================================================================== *)
 (* Window Operations (Phase 6 — v0.51.1)                                  *)
 (* ===================================================================== *)
@@ -911,9 +1094,88 @@ let lead_column (t : Arrow_table.t) (col_name : string) (offset : int) : Arrow_t
        | None -> None)
   | _ -> None
 
+(** Window functions computed by the chunk-aware native kernel. *)
+type window_op =
+  | Lag of int
+  | Lead of int
+  | Cumsum
+  | Cummin
+  | Cummax
+  | Row_number
+  | Min_rank
+  | Dense_rank
+
+let window_op_code = function
+  | Lag n -> (0, n)
+  | Lead n -> (1, n)
+  | Cumsum -> (2, 0)
+  | Cummin -> (3, 0)
+  | Cummax -> (4, 0)
+  | Row_number -> (5, 0)
+  | Min_rank -> (6, 0)
+  | Dense_rank -> (7, 0)
+
+let window_result (result : nativeint option) : Arrow_table.t option =
+  match result with
+  | Some new_ptr ->
+      let schema = schema_from_native_ptr new_ptr in
+      let nrows = Arrow_ffi.arrow_table_num_rows new_ptr in
+      Some (Arrow_table.create_from_native new_ptr schema nrows)
+  | None -> None
+
+(** [window_column t col op name] applies [op] to the Int64/Float64 column
+    [col] and stores the result as [name]. The input chunks are read in
+    place and the result keeps their boundaries. None without a native
+    handle or for other column types. *)
+let window_column (t : Arrow_table.t) (col_name : string) (op : window_op)
+    (result_name : string) : Arrow_table.t option =
+  match t.native_handle with
+  | Some handle when not handle.Arrow_table.freed ->
+      let code, offset = window_op_code op in
+      if offset < 0 then None
+      else window_result (Arrow_ffi.arrow_window_column handle.ptr col_name code offset result_name)
+  | _ -> None
+
+(** [grouped_window grouped col op name] applies [op] within each group,
+    in parallel across groups, and returns the base table with the result
+    stored as [name] in its original row order. None when the grouping is
+    not native or the column is not Int64/Float64. *)
+let grouped_window (grouped : grouped_table) (col_name : string) (op : window_op)
+    (result_name : string) : Arrow_table.t option =
+  match grouped.native_group, grouped.base_table.native_handle with
+  | Some gh, Some handle when not gh.freed && not handle.Arrow_table.freed ->
+      let code, offset = window_op_code op in
+      if offset < 0 then None
+      else begin
+        let result = Arrow_ffi.arrow_grouped_window gh.ptr col_name code offset result_name in
+        ignore (Sys.opaque_identity grouped);
+        window_result result
+      end
+  | _ -> None
+
+(** Run the grouped operation [f] on each hash partition of [t] by [keys]
+    when [t] is over the memory limit (see {!Spill.map_partitions}).
+    Partitions hold disjoint groups, so the concatenated results sorted by
+    the keys, NAs last as in the native group-by, are what [f t] returns.
+    None when [t] fits or cannot be partitioned; the first error from [f]
+    is returned as is. *)
+let group_partitioned (t : Arrow_table.t) (keys : string list)
+    (f : Arrow_table.t -> (Arrow_table.t, 'e) result) : (Arrow_table.t, 'e) result option =
+  match Spill.map_partitions t keys f with
+  | None -> None
+  | Some results ->
+      (match List.find_opt Result.is_error results with
+       | Some (Error e) -> Some (Error e)
+       | _ ->
+           let tables = List.filter_map Result.to_option results in
+           let combined = Arrow_table.materialize (Arrow_table.concatenate tables) in
+           let sorted = sort_by_keys combined (List.map (fun k -> (k, true)) keys) in
+           Some (Ok (Option.value sorted ~default:combined)))
+
 (** Optimized group-by for high-cardinality keys.
-    Uses pre-sized hash table and numeric fast path when >10k rows with
-    all-numeric key columns. Falls back to standard group_by when:
+    Hashes typed key columns (ints, floats, bools, strings, factor codes) morsel-by-morsel
+    on worker threads and merges the local tables. Falls back to standard
+    group_by when:
     - The table has no native Arrow handle (pure OCaml storage)
     - The native optimized grouping kernel returns None (e.g., unsupported column types)
     Callers can check Arrow_table.is_native_backed to predict which path will be taken. *)
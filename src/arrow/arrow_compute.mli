@@ -11,6 +11,9 @@ type grouped_table
 
 type comparison_op = Eq | Lt | Gt | Le | Ge
 
+(** The code the native comparison stubs use for [op]. *)
+val comparison_op_code : comparison_op -> int
+
 val project : Arrow_table.t -> string list -> Arrow_table.t
 
 val filter : Arrow_table.t -> bool array -> Arrow_table.t
@@ -23,10 +26,32 @@ val sort_by_indices : Arrow_table.t -> int array -> Arrow_table.t
 
 val rename_columns : Arrow_table.t -> (string * string) list -> Arrow_table.t
 
+(** Stable row order of a native table sorted by [(column, ascending)] keys,
+    NAs last. Returns [None] for non-native tables or unsupported key types. *)
+val sort_indices : Arrow_table.t -> (string * bool) list -> int array option
+
+(** Sort a native table by [(column, ascending)] keys, spilling sorted runs
+    to disk when the table is over the memory limit (see {!Spill}).
+    Returns [None] when {!sort_indices} does. *)
+val sort_by_keys : Arrow_table.t -> (string * bool) list -> Arrow_table.t option
+
 (** Sort a table by the values of a column.
     Returns [None] if the column does not exist or sorting is unsupported for its type. *)
 val sort_by_column : Arrow_table.t -> string -> bool -> Arrow_table.t option
 
+type join_kind = Inner_join | Left_join | Full_join | Semi_join | Anti_join
+
+(** Native hash join on identically typed key columns (numeric, boolean,
+    string, date or factor). Returns output-ordered [(left, right)] row indices with
+    [-1] for the unmatched side, or [None] when the tables are not native or
+    a key type is unsupported. *)
+val hash_join_indices :
+  Arrow_table.t -> Arrow_table.t -> string list -> join_kind -> (int array * int array) option
+
+(** Gather rows of a native table; negative indices yield null rows.
+    Returns [None] for non-native tables. *)
+val take_with_nulls : Arrow_table.t -> int array -> Arrow_table.t option
+
 val add_computed_column : Arrow_table.t -> string -> Arrow_table.column_data -> Arrow_table.t
 
 (** Add a float scalar to every element of a numeric column.
@@ -80,6 +105,13 @@ val divide_columns_to_table : Arrow_table.t -> string -> string -> string -> Arr
     Uses optimized native hash grouping when possible. *)
 val group_by : Arrow_table.t -> string list -> grouped_table
 
+(** Run a grouped operation per hash partition of the table when it is
+    over the memory limit, returning the combined result sorted by the keys.
+    [None] when the table fits the limit or cannot be partitioned. *)
+val group_partitioned :
+  Arrow_table.t -> string list -> (Arrow_table.t -> (Arrow_table.t, 'e) result) ->
+  (Arrow_table.t, 'e) result option
+
 (** Get groups of a grouped table.
     Each group is represented as a tuple of the string key representation and the list of row indices. *)
 val get_groups : grouped_table -> (string * int list) list
@@ -87,7 +119,8 @@ val get_groups : grouped_table -> (string * int list) list
 val nest : grouped_table -> string list -> (string * Arrow_table.t) list
 
 (** Apply an aggregation to a grouped table.
-    agg_name: "sum", "mean", "count", "min", "max", or "count_distinct"
+    agg_name: "sum", "mean", "count", "min", "max", "count_distinct" or
+    "approx_count_distinct"
     col_name: target column for aggregation (ignored for count)
     Returns [Some table] with key columns + aggregated value column, or [None] if inputs are invalid. *)
 val group_aggregate : grouped_table -> string -> string -> Arrow_table.t option
@@ -104,6 +137,12 @@ val exp_column : Arrow_table.t -> string -> Arrow_table.t option
 
 val pow_column : Arrow_table.t -> string -> float -> Arrow_table.t option
 
+(** Evaluate a postfix program over the named columns in a single native
+    pass and store the result as a column ({!Arrow_ffi.arrow_eval_expression}).
+    [None] for tables without a native handle or when the kernel declines. *)
+val eval_expression :
+  Arrow_table.t -> string array -> Arrow_ffi.expr_op array -> string -> Arrow_table.t option
+
 val sum_column : Arrow_table.t -> string -> float option
 
 val mean_column : Arrow_table.t -> string -> float option
@@ -116,12 +155,44 @@ val max_column : Arrow_table.t -> string -> float option
     Returns [None] if the column doesn't exist. *)
 val count_distinct_column : Arrow_table.t -> string -> int option
 
+(** Approximate number of distinct values in a named column (HyperLogLog,
+    exact for up to 4096 rows). Returns [None] if the column doesn't exist. *)
+val approx_count_distinct_column : Arrow_table.t -> string -> int option
+
 (** Compare each element of a named numeric column to a scalar.
     Returns a bool array suitable for use with filter, or [None] if the column is missing/incompatible. *)
 val compare_column_scalar : Arrow_table.t -> string -> float -> comparison_op -> bool array option
 
 val column_null_mask : Arrow_table.t -> string -> bool array option
 
+(** A filter predicate held as native keep/NA bitmaps. *)
+type native_mask
+
+(** [col op scalar] over a numeric column of a native table; NULL rows are NA.
+    Returns [None] for non-native tables or missing/non-numeric columns. *)
+val mask_compare_scalar : Arrow_table.t -> string -> float -> comparison_op -> native_mask option
+
+(** [col == s] over a string or factor column of a native table; NULL rows
+    are NA. Factor columns compare dictionary indices, not strings. *)
+val mask_equal_string : Arrow_table.t -> string -> string -> native_mask option
+
+(** [is_na(col)] over any column of a native table. *)
+val mask_is_na : Arrow_table.t -> string -> native_mask option
+
+(** Combinators following the interpreter's short-circuit NA rules:
+    an NA left side is NA, and an NA right side only counts when the right
+    side would have been evaluated. *)
+val mask_not : native_mask -> native_mask option
+val mask_and : native_mask -> native_mask -> native_mask option
+val mask_or : native_mask -> native_mask -> native_mask option
+
+(** [mask_na_rows m limit] is the number of NA rows and the 1-based
+    positions of the first [limit] of them. *)
+val mask_na_rows : native_mask -> int -> int * int list
+
+(** Keep the rows of a native table where the mask is true. *)
+val filter_by_mask : Arrow_table.t -> native_mask -> Arrow_table.t option
+
 val dense_rank_column : Arrow_table.t -> string -> int option array option
 
 val row_number_column : Arrow_table.t -> string -> int option array option
@@ -131,3 +202,25 @@ val min_rank_column : Arrow_table.t -> string -> int option array option
 val lag_column : Arrow_table.t -> string -> int -> Arrow_table.t option
 
 val lead_column : Arrow_table.t -> string -> int -> Arrow_table.t option
+
+(** Window functions computed by the chunk-aware native kernel. *)
+type window_op =
+  | Lag of int
+  | Lead of int
+  | Cumsum
+  | Cummin
+  | Cummax
+  | Row_number
+  | Min_rank
+  | Dense_rank
+
+(** [window_column t col op name] applies [op] to an Int64/Float64 column
+    chunk by chunk and stores the result as [name], keeping the input's
+    chunk boundaries. *)
+val window_column : Arrow_table.t -> string -> window_op -> string -> Arrow_table.t option
+
+(** [grouped_window grouped col op name] applies [op] within each group,
+    in parallel across groups, and returns the base table with the result
+    stored as [name] in its original row order. None when the grouping is
+    not native or the column is not Int64/Float64. *)
+val grouped_window : grouped_table -> string -> window_op -> string -> Arrow_table.t option
@@ -83,6 +83,9 @@ external arrow_read_struct_field : nativeint -> int -> nativeint option
 external arrow_unref : nativeint -> unit
   = "caml_arrow_unref"
 
+external arrow_memory_pool_stats : unit -> string * int * int
+  = "caml_arrow_memory_pool_stats"
+
 (* ===================================================================== *)
 (* CSV Reading                                                           *)
 (* ===================================================================== *)
@@ -90,9 +93,35 @@ external arrow_unref : nativeint -> unit
 external arrow_read_csv : string -> nativeint option
   = "caml_arrow_read_csv"
 
+type csv_read_options = {
+  cr_use_threads : bool;
+  cr_block_size : int;
+  cr_skip_rows : int;
+  cr_delimiter : char;
+  cr_column_types : (string * int) array;
+}
+
+external arrow_read_csv_with_options : string -> csv_read_options -> (nativeint, string) result
+  = "caml_arrow_read_csv_with_options"
+
 external arrow_read_parquet : string -> nativeint option
   = "caml_arrow_read_parquet"
 
+(** Read a Parquet file row group by row group, decoding only [columns]
+    (empty = all) plus the predicate columns, skipping row groups whose
+    statistics rule out the predicate and filtering each group as it is
+    read. Predicates are (column, op_code, scalar) conjuncts with
+    op_code 0=eq, 1=lt, 2=gt, 3=le, 4=ge. *)
+external arrow_read_parquet_scan :
+  string -> string list -> (string * int * float * int option) list -> (nativeint, string) result
+  = "caml_arrow_read_parquet_scan"
+
+(** Filter a native table by the same conjunctive predicates as
+    [arrow_read_parquet_scan]. Null predicate values drop the row. *)
+external arrow_table_filter_predicates :
+  nativeint -> (string * int * float * int option) list -> (nativeint, string) result
+  = "caml_arrow_table_filter_predicates"
+
 (* ===================================================================== *)
 (* IPC Read/Write                                                       *)
 (* ===================================================================== *)
@@ -106,6 +135,19 @@ external arrow_write_ipc : nativeint -> string -> bool
 external arrow_write_parquet : nativeint -> string -> bool
   = "caml_arrow_write_parquet"
 
+external arrow_write_ipc_compressed : nativeint -> string -> int -> (unit, string) result
+  = "caml_arrow_write_ipc_compressed"
+
+type parquet_write_options = {
+  pw_codec : int;
+  pw_row_group_size : int;
+  pw_dictionary : bool;
+  pw_data_page_size : int;
+}
+
+external arrow_write_parquet_with_options : nativeint -> string -> parquet_write_options -> bool
+  = "caml_arrow_write_parquet_with_options"
+
 (* ===================================================================== *)
 (* Column Projection (Select)                                            *)
 (* ===================================================================== *)
@@ -120,6 +162,38 @@ external arrow_table_project : nativeint -> string list -> nativeint option
 external arrow_table_filter_mask : nativeint -> bool array -> nativeint option
   = "caml_arrow_table_filter_mask"
 
+(** Native predicate masks: keep/NA bitmaps for vectorised filter predicates,
+    combined in C and applied without an OCaml bool array. Op codes are those
+    of arrow_compute_compare_scalar. Masks must be released with
+    arrow_mask_free. *)
+external arrow_mask_compare_scalar : nativeint -> string -> float -> int -> nativeint option
+  = "caml_arrow_mask_compare_scalar"
+
+external arrow_mask_is_na : nativeint -> string -> nativeint option
+  = "caml_arrow_mask_is_na"
+
+external arrow_mask_equal_string : nativeint -> string -> string -> nativeint option
+  = "caml_arrow_mask_equal_string"
+
+external arrow_mask_not : nativeint -> nativeint option
+  = "caml_arrow_mask_not"
+
+external arrow_mask_and : nativeint -> nativeint -> nativeint option
+  = "caml_arrow_mask_and"
+
+external arrow_mask_or : nativeint -> nativeint -> nativeint option
+  = "caml_arrow_mask_or"
+
+(** Number of NA rows and the 1-based positions of the first [limit] of them. *)
+external arrow_mask_na_rows : nativeint -> int -> int * int array
+  = "caml_arrow_mask_na_rows"
+
+external arrow_mask_free : nativeint -> unit
+  = "caml_arrow_mask_free"
+
+external arrow_table_filter_native_mask : nativeint -> nativeint -> nativeint option
+  = "caml_arrow_table_filter_native_mask"
+
 external arrow_table_remove_column : nativeint -> string -> nativeint option
   = "caml_arrow_table_remove_column"
 
@@ -241,7 +315,8 @@ external arrow_group_count_distinct : nativeint -> string -> nativeint option
 
 (** Compute multiple aggregations in a single call, building key columns once.
     Args: grouped_table_ptr, agg_types list, col_names list, result_names list.
-    agg_types: "sum", "mean", "count", "min", "max", "count_distinct".
+    agg_types: "sum", "mean", "count", "min", "max", "count_distinct",
+    "approx_count_distinct" (HyperLogLog, exact for groups of up to 4096 rows).
     Returns Some(result_table_ptr) with key columns + all agg columns, or None. *)
 external arrow_group_multi_aggregate :
   nativeint -> string list -> string list -> string list -> nativeint option
@@ -273,6 +348,83 @@ external arrow_int64_array_to_bigarray :
   nativeint -> (int64, Bigarray.int64_elt, Bigarray.c_layout) Bigarray.Array1.t option
   = "caml_arrow_int64_array_to_bigarray"
 
+(** Owner of one reference to a native GArrowArray, released by a custom-block
+    finalizer. Column buffer views carry it so the Bigarrays they expose stay
+    backed by live Arrow memory. *)
+type array_owner
+
+type validity_bitmap =
+  (int, Bigarray.int8_unsigned_elt, Bigarray.c_layout) Bigarray.Array1.t
+
+(** Expose a named Float64 column as (owner, values, validity, bit_offset,
+    null_count) without copying. [values.{i}] is row [i]; [validity] is the
+    Arrow null bitmap (None when the column has no nulls) and row [i] is
+    valid when bit [bit_offset + i] is set. Returns None for other physical
+    types, empty columns or missing columns. *)
+external arrow_float64_column_buffers :
+  nativeint -> string ->
+  (array_owner
+   * (float, Bigarray.float64_elt, Bigarray.c_layout) Bigarray.Array1.t
+   * validity_bitmap option * int * int) option
+  = "caml_arrow_float64_column_buffers"
+
+(** Int64 counterpart of [arrow_float64_column_buffers]. *)
+external arrow_int64_column_buffers :
+  nativeint -> string ->
+  (array_owner
+   * (int64, Bigarray.int64_elt, Bigarray.c_layout) Bigarray.Array1.t
+   * validity_bitmap option * int * int) option
+  = "caml_arrow_int64_column_buffers"
+
+(** A column as flat buffers, for building native tables without boxing
+    each cell. Validity bitmaps are LSB-first with bit [i] set when row [i]
+    holds a value ([None] = no nulls); [Boolean_buffer] values are packed
+    the same way. [Utf8_buffer] offsets have one entry per row plus one,
+    starting at 0, into the UTF-8 bytes. Date32 values are days since the
+    epoch and timestamps microseconds. Each buffer is copied once into an
+    Arrow buffer, so the Bigarrays may be reused afterwards. *)
+type buffer_column =
+  | Int64_buffer of (int64, Bigarray.int64_elt, Bigarray.c_layout) Bigarray.Array1.t * validity_bitmap option
+  | Float64_buffer of (float, Bigarray.float64_elt, Bigarray.c_layout) Bigarray.Array1.t * validity_bitmap option
+  | Boolean_buffer of int * validity_bitmap * validity_bitmap option
+  | Utf8_buffer of (int32, Bigarray.int32_elt, Bigarray.c_layout) Bigarray.Array1.t
+                   * (int, Bigarray.int8_unsigned_elt, Bigarray.c_layout) Bigarray.Array1.t
+                   * validity_bitmap option
+  | Date32_buffer of (int32, Bigarray.int32_elt, Bigarray.c_layout) Bigarray.Array1.t * validity_bitmap option
+  | Timestamp_buffer of (int64, Bigarray.int64_elt, Bigarray.c_layout) Bigarray.Array1.t
+                        * string option * validity_bitmap option
+
+(** Build a native table from buffer columns of equal length. [None] when
+    the list is empty or the buffers are inconsistent. *)
+external arrow_table_from_buffers : (string * buffer_column) list -> nativeint option
+  = "caml_arrow_table_from_buffers"
+
+(** Add a buffer column to a native table, or replace the column of that
+    name; the other columns are shared with the input table. *)
+external arrow_table_set_buffer_column : nativeint -> string -> buffer_column -> nativeint option
+  = "caml_arrow_table_set_buffer_column"
+
+(** One instruction of a fused column expression, in postfix order.
+    [Expr_column i] pushes the [i]-th named column, [Expr_const] a
+    constant; the others pop their operands and push the result. The
+    constant constructors are numbered by the C [EXPR_*] enum, so their
+    order must not change. *)
+type expr_op =
+  | Expr_column of int
+  | Expr_const of float
+  | Expr_add | Expr_sub | Expr_mul | Expr_div | Expr_pow
+  | Expr_sqrt | Expr_log | Expr_exp | Expr_abs
+  | Expr_lt | Expr_le | Expr_gt | Expr_ge | Expr_eq | Expr_ne
+
+(** Evaluate a fused expression over Float64/Int64 columns in one pass and
+    store it as the named column (Float64, or Boolean when the program ends
+    in a comparison; replaced in place if it exists). A row is null when
+    any input is null. [None] when a column is missing or not numeric, the
+    program is malformed, or a non-null row divides by zero or takes
+    sqrt/log outside their domain. *)
+external arrow_eval_expression : nativeint -> string array -> expr_op array -> string -> nativeint option
+  = "caml_arrow_eval_expression"
+
 (* ===================================================================== *)
 (* Unary Math Operations (Phase 5 — Week 1)                              *)
 (* ===================================================================== *)
@@ -319,6 +471,12 @@ external arrow_compute_min_column : nativeint -> string -> float option
 external arrow_compute_max_column : nativeint -> string -> float option
   = "caml_arrow_compute_max_column"
 
+(** Approximate number of distinct values (NA counted once) in a named
+    column, from per-worker HyperLogLog sketches merged at the end.
+    Returns None for missing columns or types without typed keys. *)
+external arrow_approx_count_distinct : nativeint -> string -> int option
+  = "caml_arrow_approx_count_distinct"
+
 (* ===================================================================== *)
 (* Comparison Operations (Phase 5 — Week 1)                              *)
 (* ===================================================================== *)
@@ -339,9 +497,11 @@ external arrow_column_null_mask : nativeint -> string -> bool array option
 (* Window Operations (Phase 6 — v0.51.1)                                  *)
 (* ===================================================================== *)
 
-(** Return sorted 0-based row indices for a named numeric column.
-    NA values are placed last. ascending=true for ascending sort. *)
-external arrow_compute_sort_indices : nativeint -> string -> bool -> int array option
+(** Return sorted 0-based row indices for one or more key columns (numeric,
+    boolean, string or date), the first being the primary key. The bool
+    list gives each key's direction (true = ascending). The sort is stable
+    and places NA values last. *)
+external arrow_compute_sort_indices : nativeint -> string list -> bool list -> int array option
   = "caml_arrow_compute_sort_indices"
 
 (** Compute dense ranks for a named numeric column.
@@ -366,7 +526,234 @@ external arrow_compute_lag_column : nativeint -> string -> int -> nativeint opti
 external arrow_compute_lead_column : nativeint -> string -> int -> nativeint option
   = "caml_arrow_compute_lead_column"
 
-(** Optimized group-by with pre-sized hash table and numeric hashing fast path
-    for high-cardinality keys (>10k groups). Same interface as arrow_table_group_by. *)
+(** Window op over a numeric column, read chunk by chunk without combining
+    chunks. op: 0=lag, 1=lead, 2=cumsum, 3=cummin, 4=cummax, 5=row_number,
+    6=min_rank, 7=dense_rank; the int after it is the lag/lead offset.
+    Returns Some(new_table_ptr) with the result stored under the last
+    argument, or None for columns that are not Int64/Float64. *)
+external arrow_window_column : nativeint -> string -> int -> int -> string -> nativeint option
+  = "caml_arrow_window_column"
+
+(** Same as arrow_window_column, computed within each group of a grouped
+    table (groups run in parallel) and returned in the base table's row order. *)
+external arrow_grouped_window : nativeint -> string -> int -> int -> string -> nativeint option
+  = "caml_arrow_grouped_window"
+
+(** Parallel group-by over typed key columns: per-morsel hash tables merged in
+    first-seen order. Returns None for key types it does not handle (e.g. dates).
+    Same interface as arrow_table_group_by. *)
 external arrow_group_by_optimized : nativeint -> string list -> nativeint option
   = "caml_arrow_group_by_optimized"
+
+(** Radix-partitioned hash join on identically typed key columns.
+    Kind: 0=inner, 1=left, 2=full, 3=semi, 4=anti. Returns Some (left_indices,
+    right_indices) with -1 for a missing side, or None for unsupported keys. *)
+external arrow_hash_join : nativeint -> nativeint -> string list -> int -> (int array * int array) option
+  = "caml_arrow_hash_join"
+
+(* ===================================================================== *)
+(* Spilling                                                              *)
+(* ===================================================================== *)
+
+(** External merge sort: sorts runs of [run_rows] rows, writes them as IPC
+    files under the directory and merges them into a memory-mapped table.
+    Same order as arrow_compute_sort_indices. None for dictionary or
+    unsupported keys, or when a file cannot be written. *)
+external arrow_spill_sort : nativeint -> string list -> bool list -> int -> string -> nativeint option
+  = "caml_arrow_spill_sort"
+
+(** Hash-partition a table by key columns into at most [n] IPC files under
+    the directory, keeping row order within each file; with the flag set
+    each file gains an int64 [__spill_row] column of input row numbers.
+    Returns the paths of the non-empty files, which the caller removes. *)
+external arrow_spill_partition : nativeint -> string list -> int -> string -> bool -> string list option
+  = "caml_arrow_spill_partition"
+
+(** Estimated bytes held by a table's buffers. *)
+external arrow_table_nbytes : nativeint -> int
+  = "caml_arrow_table_nbytes"
+
+(* ===================================================================== *)
+(* Profiled entry points                                                 *)
+(* ===================================================================== *)
+
+(* Every binding above is rebound once through Profiler.wrapN, which     *)
+(* tests the flag and otherwise calls the external directly, so an        *)
+(* unprofiled call allocates no closure. Row counts are read back from    *)
+(* table handles only while profiling. The release functions stay         *)
+(* externals: they run from GC finalisers, where recording is unsafe.     *)
+
+let () =
+  if arrow_available then
+    Profiler.pool_bytes := (fun () ->
+      let (_, allocated, _) = arrow_memory_pool_stats () in allocated)
+
+let table_rows = arrow_table_num_rows
+let produced = function Some t -> table_rows t | None -> -1
+let produced_ok = function Ok t -> table_rows t | Error _ -> -1
+
+let arrow_table_num_rows = Profiler.wrap1 "arrow_table_num_rows" arrow_table_num_rows
+let arrow_table_num_columns =
+  Profiler.wrap1 ~rows_in:table_rows "arrow_table_num_columns" arrow_table_num_columns
+let arrow_table_get_schema =
+  Profiler.wrap1 ~rows_in:table_rows "arrow_table_get_schema" arrow_table_get_schema
+let arrow_table_get_list_field_schema =
+  Profiler.wrap2 ~rows_in:table_rows "arrow_table_get_list_field_schema" arrow_table_get_list_field_schema
+let arrow_table_get_column_data =
+  Profiler.wrap2 ~rows_in:table_rows "arrow_table_get_column_data" arrow_table_get_column_data
+let arrow_read_int64_column =
+  Profiler.wrap1 ~rows_out:Array.length "arrow_read_int64_column" arrow_read_int64_column
+let arrow_read_float64_column =
+  Profiler.wrap1 ~rows_out:Array.length "arrow_read_float64_column" arrow_read_float64_column
+let arrow_read_boolean_column =
+  Profiler.wrap1 ~rows_out:Array.length "arrow_read_boolean_column" arrow_read_boolean_column
+let arrow_read_string_column =
+  Profiler.wrap1 ~rows_out:Array.length "arrow_read_string_column" arrow_read_string_column
+let arrow_read_date32_column =
+  Profiler.wrap1 ~rows_out:Array.length "arrow_read_date32_column" arrow_read_date32_column
+let arrow_read_timestamp_column =
+  Profiler.wrap1 ~rows_out:Array.length "arrow_read_timestamp_column" arrow_read_timestamp_column
+let arrow_read_dictionary_column =
+  Profiler.wrap1 "arrow_read_dictionary_column" arrow_read_dictionary_column
+let arrow_read_list_column = Profiler.wrap1 "arrow_read_list_column" arrow_read_list_column
+let arrow_read_struct_fields = Profiler.wrap1 "arrow_read_struct_fields" arrow_read_struct_fields
+let arrow_read_struct_field = Profiler.wrap2 "arrow_read_struct_field" arrow_read_struct_field
+let arrow_read_csv = Profiler.wrap1 ~rows_out:produced "arrow_read_csv" arrow_read_csv
+let arrow_read_csv_with_options =
+  Profiler.wrap2 ~rows_out:produced_ok "arrow_read_csv_with_options" arrow_read_csv_with_options
+let arrow_read_parquet = Profiler.wrap1 ~rows_out:produced "arrow_read_parquet" arrow_read_parquet
+let arrow_read_parquet_scan =
+  Profiler.wrap3 ~rows_out:produced_ok "arrow_read_parquet_scan" arrow_read_parquet_scan
+let arrow_table_filter_predicates =
+  Profiler.wrap2 ~rows_in:table_rows ~rows_out:produced_ok "arrow_table_filter_predicates" arrow_table_filter_predicates
+let arrow_read_ipc = Profiler.wrap1 ~rows_out:produced "arrow_read_ipc" arrow_read_ipc
+let arrow_write_ipc = Profiler.wrap2 ~rows_in:table_rows "arrow_write_ipc" arrow_write_ipc
+let arrow_write_parquet =
+  Profiler.wrap2 ~rows_in:table_rows "arrow_write_parquet" arrow_write_parquet
+let arrow_write_ipc_compressed =
+  Profiler.wrap3 ~rows_in:table_rows "arrow_write_ipc_compressed" arrow_write_ipc_compressed
+let arrow_write_parquet_with_options =
+  Profiler.wrap3 ~rows_in:table_rows "arrow_write_parquet_with_options" arrow_write_parquet_with_options
+let arrow_table_project =
+  Profiler.wrap2 ~rows_in:table_rows ~rows_out:produced "arrow_table_project" arrow_table_project
+let arrow_table_filter_mask =
+  Profiler.wrap2 ~rows_in:table_rows ~rows_out:produced "arrow_table_filter_mask" arrow_table_filter_mask
+let arrow_mask_compare_scalar =
+  Profiler.wrap4 ~rows_in:table_rows "arrow_mask_compare_scalar" arrow_mask_compare_scalar
+let arrow_mask_is_na = Profiler.wrap2 ~rows_in:table_rows "arrow_mask_is_na" arrow_mask_is_na
+let arrow_mask_equal_string =
+  Profiler.wrap3 ~rows_in:table_rows "arrow_mask_equal_string" arrow_mask_equal_string
+let arrow_mask_not = Profiler.wrap1 "arrow_mask_not" arrow_mask_not
+let arrow_mask_and = Profiler.wrap2 "arrow_mask_and" arrow_mask_and
+let arrow_mask_or = Profiler.wrap2 "arrow_mask_or" arrow_mask_or
+let arrow_mask_na_rows = Profiler.wrap2 "arrow_mask_na_rows" arrow_mask_na_rows
+let arrow_table_filter_native_mask =
+  Profiler.wrap2 ~rows_in:table_rows ~rows_out:produced "arrow_table_filter_native_mask" arrow_table_filter_native_mask
+let arrow_table_remove_column =
+  Profiler.wrap2 ~rows_in:table_rows ~rows_out:produced "arrow_table_remove_column" arrow_table_remove_column
+let arrow_table_rename_column =
+  Profiler.wrap3 ~rows_in:table_rows ~rows_out:produced "arrow_table_rename_column" arrow_table_rename_column
+let arrow_table_add_column_from_table =
+  Profiler.wrap4 ~rows_in:table_rows ~rows_out:produced "arrow_table_add_column_from_table" arrow_table_add_column_from_table
+let arrow_table_slice =
+  Profiler.wrap3 ~rows_in:table_rows ~rows_out:produced "arrow_table_slice" arrow_table_slice
+let arrow_table_take =
+  Profiler.wrap2 ~rows_in:table_rows ~rows_out:produced "arrow_table_take" arrow_table_take
+let arrow_table_sort =
+  Profiler.wrap3 ~rows_in:table_rows ~rows_out:produced "arrow_table_sort" arrow_table_sort
+let arrow_table_new = Profiler.wrap1 ~rows_out:produced "arrow_table_new" arrow_table_new
+let arrow_table_concatenate =
+  Profiler.wrap1 ~rows_out:produced "arrow_table_concatenate" arrow_table_concatenate
+let arrow_compute_add_scalar =
+  Profiler.wrap3 ~rows_in:table_rows ~rows_out:produced "arrow_compute_add_scalar" arrow_compute_add_scalar
+let arrow_compute_multiply_scalar =
+  Profiler.wrap3 ~rows_in:table_rows ~rows_out:produced "arrow_compute_multiply_scalar" arrow_compute_multiply_scalar
+let arrow_compute_subtract_scalar =
+  Profiler.wrap3 ~rows_in:table_rows ~rows_out:produced "arrow_compute_subtract_scalar" arrow_compute_subtract_scalar
+let arrow_compute_divide_scalar =
+  Profiler.wrap3 ~rows_in:table_rows ~rows_out:produced "arrow_compute_divide_scalar" arrow_compute_divide_scalar
+let arrow_compute_add_columns =
+  Profiler.wrap4 ~rows_in:table_rows ~rows_out:produced "arrow_compute_add_columns" arrow_compute_add_columns
+let arrow_compute_multiply_columns =
+  Profiler.wrap4 ~rows_in:table_rows ~rows_out:produced "arrow_compute_multiply_columns" arrow_compute_multiply_columns
+let arrow_compute_subtract_columns =
+  Profiler.wrap4 ~rows_in:table_rows ~rows_out:produced "arrow_compute_subtract_columns" arrow_compute_subtract_columns
+let arrow_compute_divide_columns =
+  Profiler.wrap4 ~rows_in:table_rows ~rows_out:produced "arrow_compute_divide_columns" arrow_compute_divide_columns
+let arrow_table_group_by =
+  Profiler.wrap2 ~rows_in:table_rows "arrow_table_group_by" arrow_table_group_by
+let arrow_table_merge_horizontal =
+  Profiler.wrap2 ~rows_in:table_rows ~rows_out:produced "arrow_table_merge_horizontal" arrow_table_merge_horizontal
+let arrow_grouped_table_get_indices =
+  Profiler.wrap1 "arrow_grouped_table_get_indices" arrow_grouped_table_get_indices
+let arrow_grouped_table_nest = Profiler.wrap1 "arrow_grouped_table_nest" arrow_grouped_table_nest
+let arrow_group_sum = Profiler.wrap2 ~rows_out:produced "arrow_group_sum" arrow_group_sum
+let arrow_group_mean = Profiler.wrap2 ~rows_out:produced "arrow_group_mean" arrow_group_mean
+let arrow_group_count = Profiler.wrap1 ~rows_out:produced "arrow_group_count" arrow_group_count
+let arrow_group_min = Profiler.wrap2 ~rows_out:produced "arrow_group_min" arrow_group_min
+let arrow_group_max = Profiler.wrap2 ~rows_out:produced "arrow_group_max" arrow_group_max
+let arrow_group_count_distinct =
+  Profiler.wrap2 ~rows_out:produced "arrow_group_count_distinct" arrow_group_count_distinct
+let arrow_group_multi_aggregate =
+  Profiler.wrap4 ~rows_out:produced "arrow_group_multi_aggregate" arrow_group_multi_aggregate
+let arrow_array_get_buffer_ptr =
+  Profiler.wrap1 "arrow_array_get_buffer_ptr" arrow_array_get_buffer_ptr
+let arrow_float64_array_to_bigarray =
+  Profiler.wrap1 "arrow_float64_array_to_bigarray" arrow_float64_array_to_bigarray
+let arrow_int64_array_to_bigarray =
+  Profiler.wrap1 "arrow_int64_array_to_bigarray" arrow_int64_array_to_bigarray
+let arrow_float64_column_buffers =
+  Profiler.wrap2 ~rows_in:table_rows "arrow_float64_column_buffers" arrow_float64_column_buffers
+let arrow_int64_column_buffers =
+  Profiler.wrap2 ~rows_in:table_rows "arrow_int64_column_buffers" arrow_int64_column_buffers
+let arrow_table_from_buffers =
+  Profiler.wrap1 ~rows_out:produced "arrow_table_from_buffers" arrow_table_from_buffers
+let arrow_table_set_buffer_column =
+  Profiler.wrap3 ~rows_in:table_rows ~rows_out:produced "arrow_table_set_buffer_column" arrow_table_set_buffer_column
+let arrow_eval_expression =
+  Profiler.wrap4 ~rows_in:table_rows ~rows_out:produced "arrow_eval_expression" arrow_eval_expression
+let arrow_compute_sqrt_column =
+  Profiler.wrap2 ~rows_in:table_rows ~rows_out:produced "arrow_compute_sqrt_column" arrow_compute_sqrt_column
+let arrow_compute_abs_column =
+  Profiler.wrap2 ~rows_in:table_rows ~rows_out:produced "arrow_compute_abs_column" arrow_compute_abs_column
+let arrow_compute_log_column =
+  Profiler.wrap2 ~rows_in:table_rows ~rows_out:produced "arrow_compute_log_column" arrow_compute_log_column
+let arrow_compute_exp_column =
+  Profiler.wrap2 ~rows_in:table_rows ~rows_out:produced "arrow_compute_exp_column" arrow_compute_exp_column
+let arrow_compute_pow_column =
+  Profiler.wrap3 ~rows_in:table_rows ~rows_out:produced "arrow_compute_pow_column" arrow_compute_pow_column
+let arrow_compute_sum_column =
+  Profiler.wrap2 ~rows_in:table_rows "arrow_compute_sum_column" arrow_compute_sum_column
+let arrow_compute_mean_column =
+  Profiler.wrap2 ~rows_in:table_rows "arrow_compute_mean_column" arrow_compute_mean_column
+let arrow_compute_min_column =
+  Profiler.wrap2 ~rows_in:table_rows "arrow_compute_min_column" arrow_compute_min_column
+let arrow_compute_max_column =
+  Profiler.wrap2 ~rows_in:table_rows "arrow_compute_max_column" arrow_compute_max_column
+let arrow_approx_count_distinct =
+  Profiler.wrap2 ~rows_in:table_rows "arrow_approx_count_distinct" arrow_approx_count_distinct
+let arrow_compute_compare_scalar =
+  Profiler.wrap4 ~rows_in:table_rows "arrow_compute_compare_scalar" arrow_compute_compare_scalar
+let arrow_column_null_mask =
+  Profiler.wrap2 ~rows_in:table_rows "arrow_column_null_mask" arrow_column_null_mask
+let arrow_compute_sort_indices =
+  Profiler.wrap3 ~rows_in:table_rows "arrow_compute_sort_indices" arrow_compute_sort_indices
+let arrow_compute_dense_rank =
+  Profiler.wrap2 ~rows_in:table_rows "arrow_compute_dense_rank" arrow_compute_dense_rank
+let arrow_compute_rank = Profiler.wrap3 ~rows_in:table_rows "arrow_compute_rank" arrow_compute_rank
+let arrow_compute_lag_column =
+  Profiler.wrap3 ~rows_in:table_rows ~rows_out:produced "arrow_compute_lag_column" arrow_compute_lag_column
+let arrow_compute_lead_column =
+  Profiler.wrap3 ~rows_in:table_rows ~rows_out:produced "arrow_compute_lead_column" arrow_compute_lead_column
+let arrow_window_column =
+  Profiler.wrap5 ~rows_in:table_rows ~rows_out:produced "arrow_window_column" arrow_window_column
+let arrow_grouped_window =
+  Profiler.wrap5 ~rows_out:produced "arrow_grouped_window" arrow_grouped_window
+let arrow_group_by_optimized =
+  Profiler.wrap2 ~rows_in:table_rows "arrow_group_by_optimized" arrow_group_by_optimized
+let arrow_hash_join = Profiler.wrap4 ~rows_in:table_rows "arrow_hash_join" arrow_hash_join
+let arrow_spill_sort =
+  Profiler.wrap5 ~rows_in:table_rows ~rows_out:produced "arrow_spill_sort" arrow_spill_sort
+let arrow_spill_partition =
+  Profiler.wrap5 ~rows_in:table_rows "arrow_spill_partition" arrow_spill_partition
+let arrow_table_nbytes = Profiler.wrap1 ~rows_in:table_rows "arrow_table_nbytes" arrow_table_nbytes
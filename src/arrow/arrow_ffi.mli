@@ -8,99 +8,131 @@
     will result in a native crash or undefined behavior that OCaml cannot catch.
 
     This module is exposed so that [Arrow_compute] and [Arrow_io] can depend on it
-    as a library boundary. It is not part of the stable public API. *)
+    as a library boundary. It is not part of the stable public API.
+
+    Most bindings are values rather than externals so that each call can be
+    timed by {!Profiler} when [TLANG_PROFILE] is set; with profiling off they
+    call the external directly without allocating. The release functions
+    and the pool statistics stay externals. *)
 
 val arrow_available : bool
 
 external arrow_table_free : nativeint -> unit
   = "caml_arrow_table_free"
 
-external arrow_table_num_rows : nativeint -> int
-  = "caml_arrow_table_num_rows"
+val arrow_table_num_rows : nativeint -> int
 
-external arrow_table_num_columns : nativeint -> int
-  = "caml_arrow_table_num_columns"
+val arrow_table_num_columns : nativeint -> int
 
-external arrow_table_get_schema : nativeint -> (string * int * string option) list
-  = "caml_arrow_table_get_schema"
+val arrow_table_get_schema : nativeint -> (string * int * string option) list
 
-external arrow_table_get_list_field_schema : nativeint -> string -> (string * int * string option) list option
-  = "caml_arrow_table_get_list_field_schema"
+val arrow_table_get_list_field_schema : nativeint -> string -> (string * int * string option) list option
 
-external arrow_table_get_column_data : nativeint -> string -> nativeint option
-  = "caml_arrow_table_get_column_data_by_name"
+val arrow_table_get_column_data : nativeint -> string -> nativeint option
 
-external arrow_read_int64_column : nativeint -> int option array
-  = "caml_arrow_read_int64_column"
+val arrow_read_int64_column : nativeint -> int option array
 
-external arrow_read_float64_column : nativeint -> float option array
-  = "caml_arrow_read_float64_column"
+val arrow_read_float64_column : nativeint -> float option array
 
-external arrow_read_boolean_column : nativeint -> bool option array
-  = "caml_arrow_read_boolean_column"
+val arrow_read_boolean_column : nativeint -> bool option array
 
-external arrow_read_string_column : nativeint -> string option array
-  = "caml_arrow_read_string_column"
+val arrow_read_string_column : nativeint -> string option array
 
-external arrow_read_date32_column : nativeint -> int option array
-  = "caml_arrow_read_date32_column"
+val arrow_read_date32_column : nativeint -> int option array
 
-external arrow_read_timestamp_column : nativeint -> int64 option array
-  = "caml_arrow_read_timestamp_column"
+val arrow_read_timestamp_column : nativeint -> int64 option array
 
-external arrow_read_dictionary_column : nativeint -> (int option array * string list * bool)
-  = "caml_arrow_read_dictionary_column"
+val arrow_read_dictionary_column : nativeint -> (int option array * string list * bool)
 
-external arrow_read_list_column : nativeint -> (nativeint option * (int * int) option array)
-  = "caml_arrow_read_list_column"
+val arrow_read_list_column : nativeint -> (nativeint option * (int * int) option array)
 
-external arrow_read_struct_fields : nativeint -> (string * int * string option) list
-  = "caml_arrow_read_struct_fields"
+val arrow_read_struct_fields : nativeint -> (string * int * string option) list
 
-external arrow_read_struct_field : nativeint -> int -> nativeint option
-  = "caml_arrow_read_struct_field"
+val arrow_read_struct_field : nativeint -> int -> nativeint option
 
 external arrow_unref : nativeint -> unit
   = "caml_arrow_unref"
 
-external arrow_read_csv : string -> nativeint option
-  = "caml_arrow_read_csv"
+external arrow_memory_pool_stats : unit -> string * int * int
+  = "caml_arrow_memory_pool_stats"
+
+val arrow_read_csv : string -> nativeint option
+
+(** CSV reader settings; the field order is read by the C stub.
+    [cr_block_size <= 0] keeps Arrow's default. Column type codes: 0 Int64,
+    1 Float64, 2 Boolean, 3 String, 4 Date, 5 Datetime (UTC). *)
+type csv_read_options = {
+  cr_use_threads : bool;
+  cr_block_size : int;
+  cr_skip_rows : int;
+  cr_delimiter : char;
+  cr_column_types : (string * int) array;
+}
+
+val arrow_read_csv_with_options : string -> csv_read_options -> (nativeint, string) result
+
+val arrow_read_parquet : string -> nativeint option
+
+val arrow_read_parquet_scan :
+  string -> string list -> (string * int * float * int option) list -> (nativeint, string) result
+
+val arrow_table_filter_predicates :
+  nativeint -> (string * int * float * int option) list -> (nativeint, string) result
+
+val arrow_read_ipc : string -> nativeint option
+
+val arrow_write_ipc : nativeint -> string -> bool
+
+val arrow_write_parquet : nativeint -> string -> bool
+
+(** Codec codes: 0 uncompressed, 1 snappy, 2 gzip, 3 brotli, 4 zstd, 5 lz4. *)
+val arrow_write_ipc_compressed : nativeint -> string -> int -> (unit, string) result
+
+(** Parquet writer settings; the field order is read by the C stub.
+    [pw_data_page_size <= 0] keeps Arrow's default. *)
+type parquet_write_options = {
+  pw_codec : int;
+  pw_row_group_size : int;
+  pw_dictionary : bool;
+  pw_data_page_size : int;
+}
+
+val arrow_write_parquet_with_options : nativeint -> string -> parquet_write_options -> bool
+
+val arrow_table_project : nativeint -> string list -> nativeint option
+
+val arrow_table_filter_mask : nativeint -> bool array -> nativeint option
+
+val arrow_mask_compare_scalar : nativeint -> string -> float -> int -> nativeint option
+
+val arrow_mask_is_na : nativeint -> string -> nativeint option
 
-external arrow_read_parquet : string -> nativeint option
-  = "caml_arrow_read_parquet"
+val arrow_mask_equal_string : nativeint -> string -> string -> nativeint option
 
-external arrow_read_ipc : string -> nativeint option
-  = "caml_arrow_read_ipc"
+val arrow_mask_not : nativeint -> nativeint option
 
-external arrow_write_ipc : nativeint -> string -> bool
-  = "caml_arrow_write_ipc"
+val arrow_mask_and : nativeint -> nativeint -> nativeint option
 
-external arrow_write_parquet : nativeint -> string -> bool
-  = "caml_arrow_write_parquet"
+val arrow_mask_or : nativeint -> nativeint -> nativeint option
 
-external arrow_table_project : nativeint -> string list -> nativeint option
-  = "caml_arrow_table_project"
+val arrow_mask_na_rows : nativeint -> int -> int * int array
 
-external arrow_table_filter_mask : nativeint -> bool array -> nativeint option
-  = "caml_arrow_table_filter_mask"
+external arrow_mask_free : nativeint -> unit
+  = "caml_arrow_mask_free"
 
-external arrow_table_remove_column : nativeint -> string -> nativeint option
-  = "caml_arrow_table_remove_column"
+val arrow_table_filter_native_mask : nativeint -> nativeint -> nativeint option
 
-external arrow_table_rename_column : nativeint -> string -> string -> nativeint option
-  = "caml_arrow_table_rename_column"
+val arrow_table_remove_column : nativeint -> string -> nativeint option
 
-external arrow_table_add_column_from_table : nativeint -> string -> nativeint -> string -> nativeint option
-  = "caml_arrow_table_add_column_from_table"
+val arrow_table_rename_column : nativeint -> string -> string -> nativeint option
 
-external arrow_table_slice : nativeint -> int64 -> int64 -> nativeint option
-  = "caml_arrow_table_slice"
+val arrow_table_add_column_from_table : nativeint -> string -> nativeint -> string -> nativeint option
 
-external arrow_table_take : nativeint -> int array -> nativeint option
-  = "caml_arrow_table_take"
+val arrow_table_slice : nativeint -> int64 -> int64 -> nativeint option
 
-external arrow_table_sort : nativeint -> string -> bool -> nativeint option
-  = "caml_arrow_table_sort"
+val arrow_table_take : nativeint -> int array -> nativeint option
+
+val arrow_table_sort : nativeint -> string -> bool -> nativeint option
 
 (** Construct a new Arrow table from OCaml column data.
 
@@ -110,131 +142,167 @@ external arrow_table_sort : nativeint -> string -> bool -> nativeint option
     Callers must ensure the array element type is consistent with the [int] type tag
     in the tuple [(name, type_tag, nullable, data)]. Use {!Arrow_compute.add_computed_column}
     instead of calling this directly. *)
-external arrow_table_new : (string * int * string option * 'a array) list -> nativeint option
-  = "caml_arrow_table_new"
+val arrow_table_new : (string * int * string option * 'a array) list -> nativeint option
 
-external arrow_table_concatenate : nativeint list -> nativeint option
-  = "caml_arrow_table_concatenate"
+val arrow_table_concatenate : nativeint list -> nativeint option
 
-external arrow_compute_add_scalar : nativeint -> string -> float -> nativeint option
-  = "caml_arrow_compute_add_scalar"
+val arrow_compute_add_scalar : nativeint -> string -> float -> nativeint option
 
-external arrow_compute_multiply_scalar : nativeint -> string -> float -> nativeint option
-  = "caml_arrow_compute_multiply_scalar"
+val arrow_compute_multiply_scalar : nativeint -> string -> float -> nativeint option
 
-external arrow_compute_subtract_scalar : nativeint -> string -> float -> nativeint option
-  = "caml_arrow_compute_subtract_scalar"
+val arrow_compute_subtract_scalar : nativeint -> string -> float -> nativeint option
 
-external arrow_compute_divide_scalar : nativeint -> string -> float -> nativeint option
-  = "caml_arrow_compute_divide_scalar"
+val arrow_compute_divide_scalar : nativeint -> string -> float -> nativeint option
 
-external arrow_compute_add_columns : nativeint -> string -> string -> string -> nativeint option
-  = "caml_arrow_compute_add_columns"
+val arrow_compute_add_columns : nativeint -> string -> string -> string -> nativeint option
 
-external arrow_compute_multiply_columns : nativeint -> string -> string -> string -> nativeint option
-  = "caml_arrow_compute_multiply_columns"
+val arrow_compute_multiply_columns : nativeint -> string -> string -> string -> nativeint option
 
-external arrow_compute_subtract_columns : nativeint -> string -> string -> string -> nativeint option
-  = "caml_arrow_compute_subtract_columns"
+val arrow_compute_subtract_columns : nativeint -> string -> string -> string -> nativeint option
 
-external arrow_compute_divide_columns : nativeint -> string -> string -> string -> nativeint option
-  = "caml_arrow_compute_divide_columns"
+val arrow_compute_divide_columns : nativeint -> string -> string -> string -> nativeint option
 
-external arrow_table_group_by : nativeint -> string list -> nativeint option
-  = "caml_arrow_table_group_by"
+val arrow_table_group_by : nativeint -> string list -> nativeint option
 
 external arrow_grouped_table_free : nativeint -> unit
   = "caml_arrow_grouped_table_free"
 
-external arrow_table_merge_horizontal : nativeint -> nativeint -> nativeint option
-  = "caml_arrow_table_merge_horizontal"
+val arrow_table_merge_horizontal : nativeint -> nativeint -> nativeint option
 
-external arrow_grouped_table_get_indices : nativeint -> (string * int list) list
-  = "caml_arrow_grouped_table_get_indices"
+val arrow_grouped_table_get_indices : nativeint -> (string * int list) list
 
-external arrow_grouped_table_nest : nativeint -> (string * nativeint) list
-  = "caml_arrow_grouped_table_nest"
+val arrow_grouped_table_nest : nativeint -> (string * nativeint) list
 
-external arrow_group_sum : nativeint -> string -> nativeint option
-  = "caml_arrow_group_sum"
+val arrow_group_sum : nativeint -> string -> nativeint option
 
-external arrow_group_mean : nativeint -> string -> nativeint option
-  = "caml_arrow_group_mean"
+val arrow_group_mean : nativeint -> string -> nativeint option
 
-external arrow_group_count : nativeint -> nativeint option
-  = "caml_arrow_group_count"
+val arrow_group_count : nativeint -> nativeint option
 
-external arrow_group_min : nativeint -> string -> nativeint option
-  = "caml_arrow_group_min"
+val arrow_group_min : nativeint -> string -> nativeint option
 
-external arrow_group_max : nativeint -> string -> nativeint option
-  = "caml_arrow_group_max"
+val arrow_group_max : nativeint -> string -> nativeint option
 
-external arrow_group_count_distinct : nativeint -> string -> nativeint option
-  = "caml_arrow_group_count_distinct"
+val arrow_group_count_distinct : nativeint -> string -> nativeint option
 
-external arrow_group_multi_aggregate :
+val arrow_group_multi_aggregate :
   nativeint -> string list -> string list -> string list -> nativeint option
-  = "caml_arrow_group_multi_aggregate"
 
-external arrow_array_get_buffer_ptr : nativeint -> (nativeint * int) option
-  = "caml_arrow_array_get_buffer_ptr"
+val arrow_array_get_buffer_ptr : nativeint -> (nativeint * int) option
 
-external arrow_float64_array_to_bigarray :
+val arrow_float64_array_to_bigarray :
   nativeint -> (float, Bigarray.float64_elt, Bigarray.c_layout) Bigarray.Array1.t option
-  = "caml_arrow_float64_array_to_bigarray"
 
-external arrow_int64_array_to_bigarray :
+val arrow_int64_array_to_bigarray :
   nativeint -> (int64, Bigarray.int64_elt, Bigarray.c_layout) Bigarray.Array1.t option
-  = "caml_arrow_int64_array_to_bigarray"
 
-external arrow_compute_sqrt_column : nativeint -> string -> nativeint option
-  = "caml_arrow_compute_sqrt_column"
+type array_owner
+
+type validity_bitmap =
+  (int, Bigarray.int8_unsigned_elt, Bigarray.c_layout) Bigarray.Array1.t
+
+val arrow_float64_column_buffers :
+  nativeint -> string ->
+  (array_owner
+   * (float, Bigarray.float64_elt, Bigarray.c_layout) Bigarray.Array1.t
+   * validity_bitmap option * int * int) option
+
+val arrow_int64_column_buffers :
+  nativeint -> string ->
+  (array_owner
+   * (int64, Bigarray.int64_elt, Bigarray.c_layout) Bigarray.Array1.t
+   * validity_bitmap option * int * int) option
+
+(** A column as flat buffers, for building native tables without boxing
+    each cell. Validity bitmaps are LSB-first with bit [i] set when row [i]
+    holds a value ([None] = no nulls); [Boolean_buffer] values are packed
+    the same way. [Utf8_buffer] offsets have one entry per row plus one,
+    starting at 0, into the UTF-8 bytes. Date32 values are days since the
+    epoch and timestamps microseconds. Each buffer is copied once into an
+    Arrow buffer, so the Bigarrays may be reused afterwards. *)
+type buffer_column =
+  | Int64_buffer of (int64, Bigarray.int64_elt, Bigarray.c_layout) Bigarray.Array1.t * validity_bitmap option
+  | Float64_buffer of (float, Bigarray.float64_elt, Bigarray.c_layout) Bigarray.Array1.t * validity_bitmap option
+  | Boolean_buffer of int * validity_bitmap * validity_bitmap option
+  | Utf8_buffer of (int32, Bigarray.int32_elt, Bigarray.c_layout) Bigarray.Array1.t
+                   * (int, Bigarray.int8_unsigned_elt, Bigarray.c_layout) Bigarray.Array1.t
+                   * validity_bitmap option
+  | Date32_buffer of (int32, Bigarray.int32_elt, Bigarray.c_layout) Bigarray.Array1.t * validity_bitmap option
+  | Timestamp_buffer of (int64, Bigarray.int64_elt, Bigarray.c_layout) Bigarray.Array1.t
+                        * string option * validity_bitmap option
+
+(** Build a native table from buffer columns of equal length. [None] when
+    the list is empty or the buffers are inconsistent. *)
+val arrow_table_from_buffers : (string * buffer_column) list -> nativeint option
+
+(** Add a buffer column to a native table, or replace the column of that
+    name; the other columns are shared with the input table. *)
+val arrow_table_set_buffer_column : nativeint -> string -> buffer_column -> nativeint option
+
+(** One instruction of a fused column expression, in postfix order.
+    [Expr_column i] pushes the [i]-th named column, [Expr_const] a
+    constant; the others pop their operands and push the result. The
+    constant constructors are numbered by the C [EXPR_*] enum, so their
+    order must not change. *)
+type expr_op =
+  | Expr_column of int
+  | Expr_const of float
+  | Expr_add | Expr_sub | Expr_mul | Expr_div | Expr_pow
+  | Expr_sqrt | Expr_log | Expr_exp | Expr_abs
+  | Expr_lt | Expr_le | Expr_gt | Expr_ge | Expr_eq | Expr_ne
+
+(** Evaluate a fused expression over Float64 columns in one pass and
+    store it as the named column (Float64, or Boolean when the program ends
+    in a comparison; replaced in place if it exists). A row is null when
+    any input is null. [None] when a column is missing or not numeric, the
+    program is malformed, or a non-null row divides by zero or takes
+    sqrt/log outside their domain. *)
+val arrow_eval_expression : nativeint -> string array -> expr_op array -> string -> nativeint option
+
+val arrow_compute_sqrt_column : nativeint -> string -> nativeint option
+
+val arrow_compute_abs_column : nativeint -> string -> nativeint option
+
+val arrow_compute_log_column : nativeint -> string -> nativeint option
+
+val arrow_compute_exp_column : nativeint -> string -> nativeint option
+
+val arrow_compute_pow_column : nativeint -> string -> float -> nativeint option
+
+val arrow_compute_sum_column : nativeint -> string -> float option
+
+val arrow_compute_mean_column : nativeint -> string -> float option
+
+val arrow_compute_min_column : nativeint -> string -> float option
 
-external arrow_compute_abs_column : nativeint -> string -> nativeint option
-  = "caml_arrow_compute_abs_column"
+val arrow_compute_max_column : nativeint -> string -> float option
 
-external arrow_compute_log_column : nativeint -> string -> nativeint option
-  = "caml_arrow_compute_log_column"
+val arrow_approx_count_distinct : nativeint -> string -> int option
 
-external arrow_compute_exp_column : nativeint -> string -> nativeint option
-  = "caml_arrow_compute_exp_column"
+val arrow_compute_compare_scalar : nativeint -> string -> float -> int -> bool array option
 
-external arrow_compute_pow_column : nativeint -> string -> float -> nativeint option
-  = "caml_arrow_compute_pow_column"
+val arrow_column_null_mask : nativeint -> string -> bool array option
 
-external arrow_compute_sum_column : nativeint -> string -> float option
-  = "caml_arrow_compute_sum_column"
+val arrow_compute_sort_indices : nativeint -> string list -> bool list -> int array option
 
-external arrow_compute_mean_column : nativeint -> string -> float option
-  = "caml_arrow_compute_mean_column"
+val arrow_compute_dense_rank : nativeint -> string -> int option array option
 
-external arrow_compute_min_column : nativeint -> string -> float option
-  = "caml_arrow_compute_min_column"
+val arrow_compute_rank : nativeint -> string -> int -> int option array option
 
-external arrow_compute_max_column : nativeint -> string -> float option
-  = "caml_arrow_compute_max_column"
+val arrow_compute_lag_column : nativeint -> string -> int -> nativeint option
 
-external arrow_compute_compare_scalar : nativeint -> string -> float -> int -> bool array option
-  = "caml_arrow_compute_compare_scalar"
+val arrow_compute_lead_column : nativeint -> string -> int -> nativeint option
 
-external arrow_column_null_mask : nativeint -> string -> bool array option
-  = "caml_arrow_column_null_mask"
+val arrow_window_column : nativeint -> string -> int -> int -> string -> nativeint option
 
-external arrow_compute_sort_indices : nativeint -> string -> bool -> int array option
-  = "caml_arrow_compute_sort_indices"
+val arrow_grouped_window : nativeint -> string -> int -> int -> string -> nativeint option
 
-external arrow_compute_dense_rank : nativeint -> string -> int option array option
-  = "caml_arrow_compute_dense_rank"
+val arrow_group_by_optimized : nativeint -> string list -> nativeint option
 
-external arrow_compute_rank : nativeint -> string -> int -> int option array option
-  = "caml_arrow_compute_rank"
+val arrow_hash_join : nativeint -> nativeint -> string list -> int -> (int array * int array) option
 
-external arrow_compute_lag_column : nativeint -> string -> int -> nativeint option
-  = "caml_arrow_compute_lag_column"
+val arrow_spill_sort : nativeint -> string list -> bool list -> int -> string -> nativeint option
 
-external arrow_compute_lead_column : nativeint -> string -> int -> nativeint option
-  = "caml_arrow_compute_lead_column"
+val arrow_spill_partition : nativeint -> string list -> int -> string -> bool -> string list option
 
-external arrow_group_by_optimized : nativeint -> string list -> nativeint option
-  = "caml_arrow_group_by_optimized"
+val arrow_table_nbytes : nativeint -> int
@@ -201,16 +201,125 @@ let parse_csv_string (content : string) : (Arrow_table.t, string) result =
 (* Native Arrow CSV Reading (via FFI)                                    *)
 (* ===================================================================== *)
 
+(** CSV reader settings for the native reader. *)
+type csv_options = {
+  threads : bool;
+  block_size : int option;
+  skip_rows : int;
+  delimiter : char;
+  column_types : (string * Arrow_table.arrow_type) list;
+}
+
+let default_csv_options =
+  { threads = true; block_size = None; skip_rows = 0; delimiter = ','; column_types = [] }
+
+let csv_type_code = function
+  | Arrow_table.ArrowInt64 -> Some 0
+  | Arrow_table.ArrowFloat64 -> Some 1
+  | Arrow_table.ArrowBoolean -> Some 2
+  | Arrow_table.ArrowString -> Some 3
+  | Arrow_table.ArrowDate -> Some 4
+  | Arrow_table.ArrowTimestamp _ -> Some 5
+  | _ -> None
+
 (** Read a CSV file using the native Arrow C GLib CSV reader.
     Returns Ok(Arrow_table.t) with a native_handle, or Error if reading fails. *)
-let read_csv_native (path : string) : (Arrow_table.t, string) result =
-  match Arrow_ffi.arrow_read_csv path with
-  | None -> Error ("Arrow CSV read failed: " ^ path)
-  | Some ptr ->
+let read_csv_native ?options (path : string) : (Arrow_table.t, string) result =
+  let table =
+    match options with
+    | None ->
+        (match Arrow_ffi.arrow_read_csv path with
+         | Some ptr -> Ok ptr
+         | None -> Error ("Arrow CSV read failed: " ^ path))
+    | Some o ->
+        (match
+           Arrow_ffi.arrow_read_csv_with_options path
+             { Arrow_ffi.cr_use_threads = o.threads;
+               cr_block_size = Option.value ~default:0 o.block_size;
+               cr_skip_rows = o.skip_rows;
+               cr_delimiter = o.delimiter;
+               cr_column_types =
+                 Array.of_list
+                   (List.filter_map (fun (name, ty) ->
+                      Option.map (fun code -> (name, code)) (csv_type_code ty)) o.column_types) }
+         with
+         | Ok ptr -> Ok ptr
+         | Error msg -> Error (Printf.sprintf "Arrow CSV read failed: %s: %s" path msg))
+  in
+  match table with
+  | Error msg -> Error msg
+  | Ok ptr ->
       let nrows = Arrow_ffi.arrow_table_num_rows ptr in
       let schema = Arrow_table.schema_from_native_ptr ptr in
       Ok (Arrow_table.create_from_native ptr schema nrows)
 
+(* ===================================================================== *)
+(* Scan Options (projection + predicate pushdown)                        *)
+(* ===================================================================== *)
+
+(** One conjunct of a pushed-down row predicate: [column op scalar]. *)
+type scan_predicate = {
+  column : string;
+  op : Arrow_compute.comparison_op;
+  scalar : float;
+  int_scalar : int option;
+}
+
+let ffi_predicates (predicates : scan_predicate list) =
+  List.map (fun p ->
+    (p.column, Arrow_compute.comparison_op_code p.op, p.scalar, p.int_scalar)) predicates
+
+(** Project [table] to [columns], in the order given or, with [file_order],
+    in the order the columns appear in [table]. *)
+let project_columns ~file_order (table : Arrow_table.t) (columns : string list) =
+  if file_order then
+    Arrow_compute.project table
+      (List.filter (fun c -> List.mem c columns) (Arrow_table.column_names table))
+  else Arrow_compute.project table columns
+
+(** Keep only the rows of [table] satisfying every predicate (NA drops the
+    row) and then only the requested [columns]. Native tables are filtered
+    in C; pure OCaml tables combine per-predicate comparison masks. *)
+let apply_scan ?(columns = []) ?(predicates = []) ?(file_order = false) (table : Arrow_table.t)
+    : (Arrow_table.t, string) result =
+  let referenced = columns @ List.map (fun p -> p.column) predicates in
+  match List.find_opt (fun c -> not (Arrow_table.has_column table c)) referenced with
+  | Some c -> Error (Printf.sprintf "Column `%s` not found." c)
+  | None ->
+      let filtered =
+        if predicates = [] then Ok table
+        else
+          match table.native_handle with
+          | Some handle when not handle.Arrow_table.freed ->
+              (match Arrow_ffi.arrow_table_filter_predicates handle.ptr (ffi_predicates predicates) with
+               | Ok ptr ->
+                   Ok (Arrow_table.create_from_native ptr table.schema
+                         (Arrow_ffi.arrow_table_num_rows ptr))
+               | Error msg -> Error msg)
+          | _ ->
+              let keep = Array.make (Arrow_table.num_rows table) true in
+              let rec loop = function
+                | [] -> Ok (Arrow_compute.filter table keep)
+                | p :: rest ->
+                    match Arrow_table.column_type table p.column with
+                    | Some (Arrow_table.ArrowInt64 | Arrow_table.ArrowFloat64) ->
+                        (match Arrow_compute.compare_column_scalar table p.column p.scalar p.op with
+                         | Some mask ->
+                             Array.iteri (fun i b ->
+                               if i < Array.length keep && not b then keep.(i) <- false
+                             ) mask;
+                             loop rest
+                         | None -> Error (Printf.sprintf "Column `%s` not found." p.column))
+                    | _ ->
+                        Error (Printf.sprintf
+                          "Filter column `%s` must be numeric to be pushed down." p.column)
+              in
+              loop predicates
+      in
+      match filtered with
+      | Ok t when columns <> [] -> Ok (project_columns ~file_order t columns)
+      | result -> result
+
 (* ===================================================================== *)
 (* Public API                                                            *)
 (* ===================================================================== *)
@@ -255,31 +364,95 @@ let read_ipc (path : string) : (Arrow_table.t, string) result =
       Ok (Arrow_table.create_from_native ptr schema nrows)
   | None -> Error ("Arrow IPC read failed: " ^ path)
 
-(** Read a Parquet file into an Arrow table. *)
-let read_parquet_local (path : string) : (Arrow_table.t, string) result =
-  match Arrow_ffi.arrow_read_parquet path with
-  | Some ptr ->
-      let nrows = Arrow_ffi.arrow_table_num_rows ptr in
-      let schema = Arrow_table.schema_from_native_ptr ptr in
-      Ok (Arrow_table.create_from_native ptr schema nrows)
-  | None -> Error ("Parquet read failed: " ^ path)
+(** Read a Parquet file into an Arrow table.
+    With [columns] or [predicates], only the needed columns are decoded and
+    the file is scanned row group by row group (see [arrow_read_parquet_scan]),
+    which returns the columns in file order. *)
+let read_parquet_local ?(columns = []) ?(predicates = []) ?(file_order = false) (path : string)
+    : (Arrow_table.t, string) result =
+  if columns = [] && predicates = [] then
+    match Arrow_ffi.arrow_read_parquet path with
+    | Some ptr ->
+        let nrows = Arrow_ffi.arrow_table_num_rows ptr in
+        let schema = Arrow_table.schema_from_native_ptr ptr in
+        Ok (Arrow_table.create_from_native ptr schema nrows)
+    | None -> Error ("Parquet read failed: " ^ path)
+  else
+    match Arrow_ffi.arrow_read_parquet_scan path columns (ffi_predicates predicates) with
+    | Ok ptr ->
+        let nrows = Arrow_ffi.arrow_table_num_rows ptr in
+        let schema = Arrow_table.schema_from_native_ptr ptr in
+        let table = Arrow_table.create_from_native ptr schema nrows in
+        (* The scan may carry predicate-only columns; drop them. *)
+        if columns = [] then Ok table
+        else Ok (project_columns ~file_order table columns)
+    | Error msg -> Error (Printf.sprintf "Parquet read failed: %s: %s" path msg)
+
+type compression = Uncompressed | Snappy | Gzip | Brotli | Zstd | Lz4
+
+let compression_of_name = function
+  | "uncompressed" | "none" -> Some Uncompressed
+  | "snappy" -> Some Snappy
+  | "gzip" -> Some Gzip
+  | "brotli" -> Some Brotli
+  | "zstd" -> Some Zstd
+  | "lz4" -> Some Lz4
+  | _ -> None
+
+let compression_name = function
+  | Uncompressed -> "uncompressed"
+  | Snappy -> "snappy"
+  | Gzip -> "gzip"
+  | Brotli -> "brotli"
+  | Zstd -> "zstd"
+  | Lz4 -> "lz4"
+
+(* Codes understood by compression_of_code in arrow_stubs.c. *)
+let compression_code = function
+  | Uncompressed -> 0
+  | Snappy -> 1
+  | Gzip -> 2
+  | Brotli -> 3
+  | Zstd -> 4
+  | Lz4 -> 5
+
+type parquet_options = {
+  compression : compression;
+  row_group_size : int;
+  dictionary : bool;
+  data_page_size : int option;
+}
+
+let default_parquet_options =
+  { compression = Uncompressed; row_group_size = 65536; dictionary = true; data_page_size = None }
 
 (** Write an Arrow table to an IPC file *)
-let write_ipc (table : Arrow_table.t) (path : string) : (unit, string) result =
+let write_ipc ?(compression = Uncompressed) (table : Arrow_table.t) (path : string) : (unit, string) result =
   let table = Arrow_table.materialize table in
   match table.native_handle with
   | Some handle when not handle.freed ->
-      if Arrow_ffi.arrow_write_ipc handle.ptr path then Ok ()
-      else Error ("Arrow IPC write failed: " ^ path)
+      (match Arrow_ffi.arrow_write_ipc_compressed handle.ptr path (compression_code compression) with
+       | Ok () -> Ok ()
+       | Error msg -> Error (Printf.sprintf "Arrow IPC write failed: %s: %s" path msg))
   | _ -> 
       Error "Arrow IPC write failed: could not materialize table to native Arrow format"
 
 (** Write an Arrow table to a Parquet file *)
-let write_parquet (table : Arrow_table.t) (path : string) : (unit, string) result =
+let write_parquet ?options (table : Arrow_table.t) (path : string) : (unit, string) result =
   let table = Arrow_table.materialize table in
   match table.native_handle with
   | Some handle when not handle.freed ->
-      if Arrow_ffi.arrow_write_parquet handle.ptr path then Ok ()
+      let ok =
+        match options with
+        | None -> Arrow_ffi.arrow_write_parquet handle.ptr path
+        | Some o ->
+            Arrow_ffi.arrow_write_parquet_with_options handle.ptr path
+              { Arrow_ffi.pw_codec = compression_code o.compression;
+                pw_row_group_size = o.row_group_size;
+                pw_dictionary = o.dictionary;
+                pw_data_page_size = Option.value ~default:0 o.data_page_size }
+      in
+      if ok then Ok ()
       else Error ("Parquet write failed: " ^ path)
   | _ ->
       Error "Parquet write failed: could not materialize table to native Arrow format"
@@ -303,13 +476,17 @@ let read_csv_fallback (path : string) : (Arrow_table.t, string) result =
 
 (** Read a CSV file into an Arrow table.
     Uses native Arrow CSV reader when available, falls back to pure OCaml. *)
-let read_csv_local (path : string) : (Arrow_table.t, string) result =
+let read_csv_local ?options (path : string) : (Arrow_table.t, string) result =
   if not (Sys.file_exists path) then
     Error (Printf.sprintf "File Error: %s: No such file or directory." path)
   else if Arrow_ffi.arrow_available then (
     (* Try native Arrow CSV reader first *)
-    match read_csv_native path with
+    match read_csv_native ?options path with
     | Ok _ as result -> result
+    | Error _ as result when options <> None ->
+        (* The OCaml parser cannot honour the reader settings; retrying with
+           it would silently return a differently parsed table. *)
+        result
     | Error native_err ->
         (* Native Arrow reader failed — fall back to pure OCaml parser.
            This can happen if the file format is not supported by Arrow's
@@ -318,7 +495,9 @@ let read_csv_local (path : string) : (Arrow_table.t, string) result =
           "Warning: Native Arrow CSV reader failed (%s). Falling back to the OCaml CSV parser.\n%!"
           native_err;
         read_csv_fallback path
-  ) else
+  ) else if options <> None && options <> Some default_csv_options then
+    Error "CSV read failed: reader options require the native Arrow CSV reader."
+  else
     read_csv_fallback path
 
 (*
@@ -333,28 +512,38 @@ let read_csv_local (path : string) : (Arrow_table.t, string) result =
 --# @family arrow_io
 --# @export
 *)
-let read_csv (path : string) : (Arrow_table.t, string) result =
+let read_csv ?options ?(columns = []) ?(predicates = []) ?(file_order = false) (path : string)
+    : (Arrow_table.t, string) result =
+  let read_and_scan p =
+    match read_csv_local ?options p with
+    | Ok table when columns <> [] || predicates <> [] ->
+        (match apply_scan ~columns ~predicates ~file_order table with
+         | Ok _ as result -> result
+         | Error msg -> Error (Printf.sprintf "CSV read failed: %s: %s" path msg))
+    | result -> result
+  in
   if is_url path then
     match download_url path with
     | Ok temp_path ->
-        let result = read_csv_local temp_path in
+        let result = read_and_scan temp_path in
         (try Sys.remove temp_path with Sys_error _ -> ());
         result
     | Error msg -> Error msg
   else
-    read_csv_local path
+    read_and_scan path
 
 (** Read a Parquet file from a local path or URL into an Arrow table. *)
-let read_parquet (path : string) : (Arrow_table.t, string) result =
+let read_parquet ?(columns = []) ?(predicates = []) ?(file_order = false) (path : string)
+    : (Arrow_table.t, string) result =
   if is_url path then
     match download_url ~suffix:".parquet" path with
     | Ok temp_path ->
-        let result = read_parquet_local temp_path in
+        let result = read_parquet_local ~columns ~predicates ~file_order temp_path in
         (try Sys.remove temp_path with Sys_error _ -> ());
         result
     | Error msg -> Error msg
   else
-    read_parquet_local path
+    read_parquet_local ~columns ~predicates ~file_order path
 
 (* ===================================================================== *)
 (* CSV Writing                                                           *)
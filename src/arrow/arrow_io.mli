@@ -9,26 +9,95 @@
     @return [Ok local_path] if successful, [Error msg] otherwise. *)
 val download_url : ?suffix:string -> string -> (string, string) result
 
+(** One conjunct of a pushed-down row predicate: [column op scalar].
+    [int_scalar] is the literal itself when it is an integer; native
+    scans compare it exactly against integer columns. *)
+type scan_predicate = {
+  column : string;
+  op : Arrow_compute.comparison_op;
+  scalar : float;
+  int_scalar : int option;
+}
+
+(** Keep the rows satisfying every predicate (rows where a predicate column is
+    NA are dropped), then project to [columns] when non-empty. The result
+    lists [columns] in the order given, or in the table's own order when
+    [file_order] is set. *)
+val apply_scan :
+  ?columns:string list -> ?predicates:scan_predicate list -> ?file_order:bool ->
+  Arrow_table.t -> (Arrow_table.t, string) result
+
+(** Native CSV reader settings. [column_types] fixes the type of the named
+    columns for every block instead of inferring it from the first one
+    (Int64, Float64, Boolean, String, Date and Timestamp are supported). *)
+type csv_options = {
+  threads : bool;                (** parse blocks on Arrow's thread pool *)
+  block_size : int option;       (** bytes per parsed block *)
+  skip_rows : int;               (** rows skipped before the header *)
+  delimiter : char;
+  column_types : (string * Arrow_table.arrow_type) list;
+}
+
+(** Arrow's defaults: threaded, comma-separated, inferred types. *)
+val default_csv_options : csv_options
+
 (** Read a CSV file or URL into an Arrow table.
-    Uses native Arrow CSV reader when available, falls back to pure OCaml. *)
-val read_csv : string -> (Arrow_table.t, string) result
+    Uses native Arrow CSV reader when available, falls back to pure OCaml.
+    With [options] only the native reader is used, since the fallback
+    cannot honour them. [columns] and [predicates] are applied to the
+    decoded table before any column is materialised in OCaml; with
+    [file_order] the projected columns keep their order in the file. *)
+val read_csv :
+  ?options:csv_options -> ?columns:string list -> ?predicates:scan_predicate list ->
+  ?file_order:bool ->
+  string -> (Arrow_table.t, string) result
 
 (** Write an Arrow table to a CSV file.
     
     @param sep The column separator (defaults to ","). *)
 val write_csv : ?sep:string -> Arrow_table.t -> string -> (unit, string) result
 
-(** Read a Parquet file from a local path or URL into an Arrow table. *)
-val read_parquet : string -> (Arrow_table.t, string) result
+(** Read a Parquet file from a local path or URL into an Arrow table.
+    With [columns] and/or [predicates] the file is scanned row group by row
+    group: only the needed columns are decoded, row groups whose statistics
+    exclude the predicate are skipped, and each group is filtered as read.
+    With [file_order] the projected columns keep their order in the file
+    instead of the order of [columns]. *)
+val read_parquet :
+  ?columns:string list -> ?predicates:scan_predicate list -> ?file_order:bool ->
+  string -> (Arrow_table.t, string) result
 
 (** Read an Arrow IPC file *)
 val read_ipc : string -> (Arrow_table.t, string) result
 
-(** Write an Arrow table to an IPC file *)
-val write_ipc : Arrow_table.t -> string -> (unit, string) result
+(** Buffer compression codecs for Parquet and IPC writers. *)
+type compression = Uncompressed | Snappy | Gzip | Brotli | Zstd | Lz4
+
+(** Parse a codec name ("uncompressed"/"none", "snappy", "gzip", "brotli",
+    "zstd", "lz4"). *)
+val compression_of_name : string -> compression option
+
+val compression_name : compression -> string
+
+(** Parquet writer settings. Column statistics are always written. *)
+type parquet_options = {
+  compression : compression;
+  row_group_size : int;          (** rows per row group *)
+  dictionary : bool;             (** dictionary-encode columns *)
+  data_page_size : int option;   (** target data page size in bytes *)
+}
+
+(** Arrow's defaults: uncompressed, 65536-row groups, dictionary encoding. *)
+val default_parquet_options : parquet_options
+
+(** Write an Arrow table to an IPC file. [compression] (uncompressed by
+    default) other than [Uncompressed] gives smaller files that readers
+    must decompress instead of mapping in place; IPC supports [Zstd] and
+    [Lz4]. *)
+val write_ipc : ?compression:compression -> Arrow_table.t -> string -> (unit, string) result
 
 (** Write an Arrow table to a Parquet file *)
-val write_parquet : Arrow_table.t -> string -> (unit, string) result
+val write_parquet : ?options:parquet_options -> Arrow_table.t -> string -> (unit, string) result
 
 (** Return true if the given string looks like an HTTP/HTTPS URL. *)
 val is_url : string -> bool
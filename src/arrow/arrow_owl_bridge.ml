@@ -22,6 +22,13 @@ type owl_view = {
     NA values in the column cause the extraction to fail (returns None)
     because numeric computation requires complete data. *)
 let numeric_column_to_owl (table : Arrow_table.t) (col_name : string) : owl_view option =
+  match Arrow_column.buffer_view table col_name with
+  | Some buffers ->
+    (* Native numeric column: copy straight out of the Arrow buffer *)
+    (match Arrow_column.to_float_array buffers with
+     | Some arr -> Some { backing = table; column = col_name; arr }
+     | None -> None)
+  | None ->
   match Arrow_table.get_column table col_name with
   | None -> None
   | Some col ->
@@ -154,15 +161,76 @@ let array_has_zero_variance (xs : float array) : bool =
      in
      loop 1
 
+(** An unboxed float column. Design-matrix columns use this type so that
+    Arrow Float64 buffers reach the least-squares kernels without a copy. *)
+type float_buffer = (float, Bigarray.float64_elt, Bigarray.c_layout) Bigarray.Array1.t
+
+(** Copy a float array into a [float_buffer]. *)
+let float_buffer_of_array (xs : float array) : float_buffer =
+  Bigarray.Array1.of_array Bigarray.float64 Bigarray.c_layout xs
+
+(** A numeric column without NAs as a [float_buffer]. Native Float64
+    columns share their Arrow buffer, which stays alive while the returned
+    Bigarray is reachable; Int64 columns are converted once.
+    
+    @return [None] for other columns or when the column has NA values. *)
+let numeric_column_buffer (table : Arrow_table.t) (col_name : string) : float_buffer option =
+  match Arrow_column.buffer_view table col_name with
+  | Some view when Arrow_column.buffer_null_count view = 0 ->
+    (match Arrow_column.buffer_values view with
+     | Arrow_column.FloatView ba -> Some ba
+     | Arrow_column.IntView ba ->
+       let n = Bigarray.Array1.dim ba in
+       let out = Bigarray.Array1.create Bigarray.float64 Bigarray.c_layout n in
+       for i = 0 to n - 1 do out.{i} <- Int64.to_float ba.{i} done;
+       ignore (Sys.opaque_identity view);
+       Some out)
+  | _ -> None
+
+(** [array_has_zero_variance] over a [float_buffer]. *)
+let buffer_has_zero_variance (xs : float_buffer) : bool =
+  let n = Bigarray.Array1.dim xs in
+  n = 0
+  || let first = xs.{0} in
+     let rec loop idx =
+       idx >= n || (Float.abs (xs.{idx} -. first) < 1e-12 && loop (idx + 1))
+     in
+     loop 1
+
+(** [pearson_cor] over two [float_buffer]s. *)
+let buffer_pearson_cor (xs : float_buffer) (ys : float_buffer) : float option =
+  let n = Bigarray.Array1.dim xs in
+  if n <> Bigarray.Array1.dim ys || n < 2 then None
+  else
+    let nf = float_of_int n in
+    let mean_x = ref 0.0 and mean_y = ref 0.0 in
+    for i = 0 to n - 1 do
+      mean_x := !mean_x +. xs.{i};
+      mean_y := !mean_y +. ys.{i}
+    done;
+    let mean_x = !mean_x /. nf and mean_y = !mean_y /. nf in
+    let sum_xy = ref 0.0 in
+    let sum_xx = ref 0.0 in
+    let sum_yy = ref 0.0 in
+    for i = 0 to n - 1 do
+      let dx = xs.{i} -. mean_x in
+      let dy = ys.{i} -. mean_y in
+      sum_xy := !sum_xy +. dx *. dy;
+      sum_xx := !sum_xx +. dx *. dx;
+      sum_yy := !sum_yy +. dy *. dy
+    done;
+    if Float.equal !sum_xx 0.0 || Float.equal !sum_yy 0.0 then None
+    else Some (!sum_xy /. Float.sqrt (!sum_xx *. !sum_yy))
+
 (* Treat correlations within floating-point epsilon of ±1 as perfect collinearity. *)
 let collinearity_threshold = 1e-10
 
 (** Scan predictor lists to detect collinearity or zero-variance predictor columns.
     
-    @param predictors List of (name, value_array) pairs.
+    @param predictors List of (name, column) pairs.
     @return [Some error_msg] detailing collinearity, or [None] if predictors are linearly independent. *)
-let detect_collinearity (predictors : (string * float array) list) : string option =
-  match List.find_opt (fun (_, xs) -> array_has_zero_variance xs) predictors with
+let detect_collinearity (predictors : (string * float_buffer) list) : string option =
+  match List.find_opt (fun (_, xs) -> buffer_has_zero_variance xs) predictors with
   | Some (name, _) ->
       Some (Printf.sprintf "predictor `%s` has zero variance" name)
   | None ->
@@ -175,7 +243,7 @@ let detect_collinearity (predictors : (string * float array) list) : string opti
             if j >= Array.length items then outer (i + 1)
             else
               let name_j, xs_j = items.(j) in
-              match pearson_cor xs_i xs_j with
+              match buffer_pearson_cor xs_i xs_j with
               | Some corr when Float.abs corr > 1.0 -. collinearity_threshold ->
                   Some
                     (Printf.sprintf
@@ -188,7 +256,7 @@ let detect_collinearity (predictors : (string * float array) list) : string opti
       outer 0
 
 (* ================================================================== *)
-(* Multi-predictor OLS via Normal Equations                            *)
+(* Multi-predictor OLS via QR or streamed normal equations             *)
 (* ================================================================== *)
 
 (** Result type for multi-predictor linear regression *)
@@ -218,80 +286,67 @@ type lm_result = {
   term_names : string list;       (* "(Intercept)" :: predictor names *)
 }
 
-(* --- Matrix utilities (pure OCaml, no Owl dependency) --- *)
+(* --- Native least-squares kernels (stats_stubs.c) --- *)
 
-(** Solve a symmetric positive-definite system A x = b via Gaussian elimination
-    with partial pivoting. Returns the solution x and the inverse of A.
-    A is p×p, b is p-vector. Returns None if singular. *)
-let solve_and_invert (a : float array array) (b : float array)
-    : (float array * float array array) option =
-  let p = Array.length a in
-  (* Augmented matrix [A | I | b] of size p × (2p+1) *)
-  let aug = Array.init p (fun i ->
-    Array.init (2 * p + 1) (fun j ->
-      if j < p then a.(i).(j)
-      else if j < 2 * p then (if j - p = i then 1.0 else 0.0)
-      else b.(i)
-    )
-  ) in
-  (* Forward elimination with partial pivoting *)
-  for col = 0 to p - 1 do
-    (* Find pivot *)
-    let max_row = ref col in
-    let max_val = ref (Float.abs aug.(col).(col)) in
-    for row = col + 1 to p - 1 do
-      let v = Float.abs aug.(row).(col) in
-      if v > !max_val then begin
-        max_val := v;
-        max_row := row
-      end
-    done;
-    if !max_val < 1e-14 then begin
-      (* Matrix is (nearly) singular — set diagonal to large value to signal *)
-      aug.(col).(col) <- 0.0
-    end else begin
-      (* Swap rows *)
-      if !max_row <> col then begin
-        let tmp = aug.(col) in
-        aug.(col) <- aug.(!max_row);
-        aug.(!max_row) <- tmp
-      end;
-      (* Eliminate below *)
-      let pivot = aug.(col).(col) in
-      for row = col + 1 to p - 1 do
-        let to_factor = aug.(row).(col) /. pivot in
-        for j = col to 2 * p do
-          aug.(row).(j) <- aug.(row).(j) -. to_factor *. aug.(col).(j)
-        done
-      done
+(** [lm_qr a beta inv hat]: Householder QR of the column-major
+    [sqrt(w) X | sqrt(w) y] in [a] (destroyed). Fills the coefficients,
+    (X'WX)^-1 (row-major) and the leverages; [false] if singular. *)
+external lm_qr : float_buffer -> float_buffer -> float_buffer -> float_buffer -> bool = "caml_stats_lm_qr"
+
+(** [lm_cross cols w out]: augmented cross product [1 X y]' W [1 X y] of
+    the predictor columns followed by the response, read in row blocks
+    straight from the buffers, with an empty [w] for unit weights. *)
+external lm_cross : float_buffer array -> float_buffer -> float array -> unit = "caml_stats_lm_cross"
+
+(** [lm_cholesky g beta inv] solves the normal equations held in [g]. *)
+external lm_cholesky : float array -> float array -> float array -> bool = "caml_stats_lm_cholesky"
+
+(** [lm_leverage cols w inv hat] fills [hat] with w_i x_i' inv x_i. *)
+external lm_leverage : float_buffer array -> float_buffer -> float array -> float_buffer -> unit
+  = "caml_stats_lm_leverage"
+
+(** Largest design matrix, in bytes, factored in memory by QR. Bigger fits
+    accumulate X'WX over row blocks and solve the normal equations. *)
+let qr_max_bytes = ref (1 lsl 30)
+
+(** Solve the weighted least-squares problem once for [linreg_multi].
+    Returns the coefficients, (X'WX)^-1 and the leverages. *)
+let solve_least_squares (xs_arr : float_buffer array) (ys : float array)
+    (obs_weights : float array) ~unit_weights =
+  let n = Array.length ys in
+  let k = Array.length xs_arr in
+  let p = k + 1 in
+  if n * (p + 1) * 8 <= !qr_max_bytes then begin
+    (* Column-major [1 X y], each row scaled by sqrt(w) *)
+    let a = Bigarray.Array1.create Bigarray.float64 Bigarray.c_layout (n * (p + 1)) in
+    let sqrt_w = Array.map sqrt obs_weights in
+    for i = 0 to n - 1 do a.{i} <- sqrt_w.(i) done;
+    Array.iteri (fun j (xs : float_buffer) ->
+      let base = (j + 1) * n in
+      for i = 0 to n - 1 do a.{base + i} <- sqrt_w.(i) *. xs.{i} done) xs_arr;
+    for i = 0 to n - 1 do a.{p * n + i} <- sqrt_w.(i) *. ys.(i) done;
+    let beta = Bigarray.Array1.create Bigarray.float64 Bigarray.c_layout p in
+    let inv = Bigarray.Array1.create Bigarray.float64 Bigarray.c_layout (p * p) in
+    let hat = Bigarray.Array1.create Bigarray.float64 Bigarray.c_layout n in
+    if not (lm_qr a beta inv hat) then None
+    else
+      Some (Array.init p (fun j -> beta.{j}),
+            Array.init p (fun i -> Array.init p (fun j -> inv.{i * p + j})),
+            Array.init n (fun i -> hat.{i}))
+  end else begin
+    (* The predictor buffers (Arrow memory for plain numeric columns) are
+       read a row block at a time; only X'WX is held in memory. *)
+    let w = float_buffer_of_array (if unit_weights then [||] else obs_weights) in
+    let g = Array.make ((p + 1) * (p + 1)) 0.0 in
+    lm_cross (Array.append xs_arr [| float_buffer_of_array ys |]) w g;
+    let beta = Array.make p 0.0 in
+    let inv = Array.make (p * p) 0.0 in
+    if not (lm_cholesky g beta inv) then None
+    else begin
+      let hat = Bigarray.Array1.create Bigarray.float64 Bigarray.c_layout n in
+      lm_leverage xs_arr w inv hat;
+      Some (beta, Array.init p (fun i -> Array.sub inv (i * p) p), Array.init n (fun i -> hat.{i}))
     end
-  done;
-  (* Check for singularity *)
-  let singular = ref false in
-  for i = 0 to p - 1 do
-    if Float.abs aug.(i).(i) < 1e-14 then singular := true
-  done;
-  if !singular then None
-  else begin
-    (* Back substitution for both inverse and solution *)
-    for col = p - 1 downto 0 do
-      let pivot = aug.(col).(col) in
-      for j = col to 2 * p do
-        aug.(col).(j) <- aug.(col).(j) /. pivot
-      done;
-      for row = 0 to col - 1 do
-        let to_factor = aug.(row).(col) in
-        for j = col to 2 * p do
-          aug.(row).(j) <- aug.(row).(j) -. to_factor *. aug.(col).(j)
-        done
-      done
-    done;
-    (* Extract inverse and solution *)
-    let inv = Array.init p (fun i ->
-      Array.init p (fun j -> aug.(i).(j + p))
-    ) in
-    let x = Array.init p (fun i -> aug.(i).(2 * p)) in
-    Some (x, inv)
   end
 
 (* --- t-distribution p-value approximation --- *)
@@ -388,13 +443,13 @@ let f_pvalue f_stat df1 df2 =
      weights: optional observation weights
      predictor_names: names of predictor columns
      Returns None if system is singular or inputs invalid. *)
-let linreg_multi ?weights (xs_list : float array list) (ys : float array)
+let linreg_multi ?weights (xs_list : float_buffer list) (ys : float array)
     (predictor_names : string list) : lm_result option =
   let n = Array.length ys in
   let k = List.length xs_list in  (* number of predictors *)
   let p = k + 1 in  (* total parameters including intercept *)
   if n < p || n < 2 then None
-  else if List.exists (fun xs -> Array.length xs <> n) xs_list then None
+  else if List.exists (fun xs -> Bigarray.Array1.dim xs <> n) xs_list then None
   else if List.length predictor_names <> k then None
   else begin
     let obs_weights =
@@ -409,43 +464,17 @@ let linreg_multi ?weights (xs_list : float array list) (ys : float array)
     in
     if Array.length obs_weights <> n then None
     else begin
-      (* Build design matrix X (n × p): column 0 = intercept (all 1s) *)
       let xs_arr = Array.of_list xs_list in
-      let x_matrix = Array.init n (fun i ->
-        Array.init p (fun j ->
-          if j = 0 then 1.0 else xs_arr.(j - 1).(i)
-        )
-      ) in
-      (* Compute X'X (p × p) *)
-      let xtx = Array.init p (fun i ->
-        Array.init p (fun j ->
-          let s = ref 0.0 in
-          for row = 0 to n - 1 do
-            s := !s +. obs_weights.(row) *. x_matrix.(row).(i) *. x_matrix.(row).(j)
-          done;
-          !s
-        )
-      ) in
-      (* Compute X'y (p-vector) *)
-      let xty = Array.init p (fun j ->
-        let s = ref 0.0 in
-        for row = 0 to n - 1 do
-          s := !s +. obs_weights.(row) *. x_matrix.(row).(j) *. ys.(row)
-        done;
-        !s
-      ) in
-      (* Solve (X'X) β = X'y and get (X'X)^{-1} *)
-      match solve_and_invert xtx xty with
+      match solve_least_squares xs_arr ys obs_weights ~unit_weights:(weights = None) with
       | None -> None
-      | Some (beta, xtx_inv) ->
-        (* Fitted values and residuals *)
-        let fitted = Array.init n (fun i ->
-          let s = ref 0.0 in
-          for j = 0 to p - 1 do
-            s := !s +. x_matrix.(i).(j) *. beta.(j)
-          done;
-          !s
-        ) in
+      | Some (beta, xtx_inv, hat_vals) ->
+        (* Fitted values and residuals, accumulated a column at a time *)
+        let fitted = Array.make n beta.(0) in
+        Array.iteri (fun j (xs : float_buffer) ->
+          let b = beta.(j + 1) in
+          for i = 0 to n - 1 do
+            fitted.(i) <- fitted.(i) +. b *. xs.{i}
+          done) xs_arr;
         let resid = Array.init n (fun i -> ys.(i) -. fitted.(i)) in
         (* SS_res, SS_tot *)
         let nf = float_of_int n in
@@ -494,16 +523,6 @@ let linreg_multi ?weights (xs_list : float array list) (ys : float array)
         let f_pval = if k > 0 && df_resid > 0
                      then f_pvalue f_stat k (float_of_int df_resid)
                      else 1.0 in
-        (* Hat matrix diagonal: h_ii = x_i' (X'X)^{-1} x_i *)
-        let hat_vals = Array.init n (fun i ->
-          let h = ref 0.0 in
-          for j1 = 0 to p - 1 do
-            for j2 = 0 to p - 1 do
-              h := !h +. obs_weights.(i) *. x_matrix.(i).(j1) *. xtx_inv.(j1).(j2) *. x_matrix.(i).(j2)
-            done
-          done;
-          !h
-        ) in
         (* Cook's distance and standardised residuals *)
        let pf = float_of_int p in
        let cooks_d = Array.init n (fun i ->
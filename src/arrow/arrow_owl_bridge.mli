@@ -62,19 +62,36 @@ val pearson_cor : float array -> float array -> float option
 (** Check if a float array has zero variance. *)
 val array_has_zero_variance : float array -> bool
 
+(** An unboxed float column, used for design-matrix columns. *)
+type float_buffer = (float, Bigarray.float64_elt, Bigarray.c_layout) Bigarray.Array1.t
+
+(** Copy a float array into a [float_buffer]. *)
+val float_buffer_of_array : float array -> float_buffer
+
+(** A numeric column without NAs as a [float_buffer]. Native Float64
+    columns share their Arrow buffer; Int64 columns are converted once.
+    Returns [None] for other columns, pure OCaml tables, or NA values. *)
+val numeric_column_buffer : Arrow_table.t -> string -> float_buffer option
+
 (** Scan predictor lists to detect collinearity or zero-variance predictor columns.
     Returns [Some error_msg] detailing collinearity, or [None] if predictors are linearly independent. *)
-val detect_collinearity : (string * float array) list -> string option
+val detect_collinearity : (string * float_buffer) list -> string option
+
+(** Largest design matrix, in bytes, that [linreg_multi] factors in memory
+    with QR (default 1 GiB). Larger fits accumulate X'WX over row blocks
+    read straight from the predictor buffers and solve the normal
+    equations instead. *)
+val qr_max_bytes : int ref
 
 (** Multi-predictor OLS/WLS regression.
     @param weights optional observation weights
-    @param xs_list predictor arrays (each length n)
+    @param xs_list predictor columns (each length n)
     @param ys response array (length n)
     @param predictor_names names of predictor columns
     @return [Some lm_result] or [None] if singular or inputs are invalid (e.g. mismatched lengths). *)
 val linreg_multi :
   ?weights:float array ->
-  float array list ->
+  float_buffer list ->
   float array ->
   string list ->
   lm_result option
@@ -42,6 +42,7 @@ let max_zero_copy_events = 1000
 let zero_copy_cap_warned : bool ref = ref false
 
 let record_zero_copy_event op reason =
+  Profiler.note_fallback ();
   if env_flag "TLANG_ZERO_COPY_DEBUG" then begin
     if !zero_copy_event_count < max_zero_copy_events then begin
       zero_copy_events := { op; reason } :: !zero_copy_events;
@@ -174,6 +175,130 @@ let register_finalizer (handle : native_handle) : unit =
     end
   ) handle
 
+(* --- Handle arenas --- *)
+
+(** Native tables only own off-heap memory, so the GC sees a few words per
+    table and may leave gigabytes of dead intermediates to their
+    finalisers for a long time. An arena is opened around each top-level
+    statement (a REPL input, or a line of a pipeline node's script) and
+    weakly tracks every native table created inside it. When it closes
+    after Arrow's memory pool grew by at least [arena_collect_bytes], a
+    minor collection shows which tracked tables died young; only if some
+    did does a major collection run, so that the finalisers of unreachable
+    tables release their buffers before the next statement. A statement
+    whose tables all stay reachable costs no major collection. *)
+type arena_report = {
+  arena_label : string;
+  handles_created : int;
+  handles_released : int;
+  start_bytes : int;
+  peak_bytes : int;  (* pool high-water mark, when it rose inside the arena *)
+  end_bytes : int;
+}
+
+type arena = {
+  arena_name : string;
+  mutable arena_handles : native_handle Weak.t;
+  mutable arena_count : int;
+  arena_start : int;
+  arena_start_max : int;
+  mutable arena_peak : int;
+}
+
+let current_arena : arena option ref = ref None
+let arena_collect_bytes = ref (64 lsl 20)
+let arena_reports : arena_report list ref = ref []
+let arena_report_count = ref 0
+let max_arena_reports = 1000
+
+(** Major collections run by [close_arena]. *)
+let arena_collections = ref 0
+
+let pool_bytes_allocated () =
+  let (_, allocated, _) = Arrow_ffi.arrow_memory_pool_stats () in
+  allocated
+
+let pool_max_memory () =
+  let (_, _, max_memory) = Arrow_ffi.arrow_memory_pool_stats () in
+  max_memory
+
+let track_native_handle (handle : native_handle) : unit =
+  match !current_arena with
+  | None -> ()
+  | Some a ->
+      if a.arena_count = Weak.length a.arena_handles then begin
+        let grown = Weak.create (2 * a.arena_count) in
+        Weak.blit a.arena_handles 0 grown 0 a.arena_count;
+        a.arena_handles <- grown
+      end;
+      Weak.set a.arena_handles a.arena_count (Some handle);
+      a.arena_count <- a.arena_count + 1;
+      a.arena_peak <- max a.arena_peak (pool_bytes_allocated ())
+
+(** Tracked handles that are unreachable or already freed. *)
+let dead_handles (a : arena) : int =
+  let dead = ref 0 in
+  for i = 0 to a.arena_count - 1 do
+    match Weak.get a.arena_handles i with
+    | None -> incr dead
+    | Some h -> if h.freed then incr dead
+  done;
+  !dead
+
+let close_arena (a : arena) : unit =
+  if a.arena_count > 0 then begin
+    (* The pool's own high-water mark is exact whenever it rose during the
+       statement; otherwise the peak stays the largest value sampled at
+       table creation. *)
+    let max_memory = pool_max_memory () in
+    if max_memory > a.arena_start_max then a.arena_peak <- max a.arena_peak max_memory;
+    if a.arena_peak - a.arena_start >= !arena_collect_bytes then begin
+      (* Handles made by this statement are mostly still young: a minor
+         collection runs the finalisers of the dead ones, and the major
+         one is only worth it when there were any. *)
+      Gc.minor ();
+      if dead_handles a > 0 then begin
+        Gc.full_major ();
+        incr arena_collections
+      end
+    end;
+    let report = {
+      arena_label = a.arena_name;
+      handles_created = a.arena_count;
+      handles_released = dead_handles a;
+      start_bytes = a.arena_start;
+      peak_bytes = a.arena_peak;
+      end_bytes = pool_bytes_allocated ();
+    } in
+    if !arena_report_count >= max_arena_reports then begin
+      arena_reports := List.filteri (fun i _ -> i < max_arena_reports - 1) !arena_reports;
+      decr arena_report_count
+    end;
+    arena_reports := report :: !arena_reports;
+    incr arena_report_count;
+    if env_flag "TLANG_ARENA_REPORT" then
+      Printf.eprintf
+        "[TLANG_ARENA_REPORT] %s: %d table(s), %d released, pool %d -> peak %d -> %d bytes\n%!"
+        report.arena_label report.handles_created report.handles_released
+        report.start_bytes report.peak_bytes report.end_bytes
+  end
+
+(** Run [f] inside an arena labelled [label]. Nested calls join the open
+    arena, so only the outermost scope collects. *)
+let with_arena (label : string) (f : unit -> 'a) : 'a =
+  match !current_arena with
+  | Some _ -> f ()
+  | None when not Arrow_ffi.arrow_available -> f ()
+  | None ->
+      let (_, start, start_max) = Arrow_ffi.arrow_memory_pool_stats () in
+      let a = { arena_name = label; arena_handles = Weak.create 16; arena_count = 0;
+                arena_start = start; arena_start_max = start_max; arena_peak = start } in
+      current_arena := Some a;
+      Fun.protect ~finally:(fun () -> current_arena := None; close_arena a) f
+
+(** Arena reports, oldest first. *)
+let arena_history () = List.rev !arena_reports
+
 (* --- Table constructors --- *)
 
 (** Create a pure OCaml table (no native Arrow backing) *)
@@ -186,6 +311,7 @@ let create (columns : (string * column_data) list) (nrows : int) : t =
 let create_from_native (ptr : nativeint) (schema : arrow_schema) (nrows : int) : t =
   let handle = { ptr; freed = false } in
   register_finalizer handle;
+  track_native_handle handle;
   { schema; columns = []; nrows; native_handle = Some handle }
 
 let empty : t =
@@ -622,6 +748,110 @@ let rec flatten_list_column ?schema_hint (nested : t option array)
   ) sub_schema in
   (offsets, present, sub_cols)
 
+(** Pack a primitive column into flat buffers for
+    [Arrow_ffi.arrow_table_from_buffers], in one pass over the option array.
+    [None] for null-only, dictionary and list columns, and for string
+    columns whose bytes do not fit int32 offsets. *)
+let buffers_of_column (col : column_data) : Arrow_ffi.buffer_column option =
+  let open Bigarray in
+  let n = column_length col in
+  let bitmap () =
+    let b = Array1.create int8_unsigned c_layout ((n + 7) / 8) in
+    Array1.fill b 0;
+    b
+  in
+  let set_bit b i = b.{i lsr 3} <- b.{i lsr 3} lor (1 lsl (i land 7)) in
+  (* Fill [values] from the present cells and build the validity bitmap,
+     dropped again when no cell is missing. *)
+  let pack a values store =
+    let validity = bitmap () in
+    let nulls = ref 0 in
+    Array.iteri (fun i cell ->
+      match cell with
+      | Some x -> store values i x; set_bit validity i
+      | None -> incr nulls
+    ) a;
+    if !nulls = 0 then None else Some validity
+  in
+  match col with
+  | IntColumn a ->
+      let values = Array1.create int64 c_layout n in
+      Array1.fill values 0L;
+      let validity = pack a values (fun v i x -> v.{i} <- Int64.of_int x) in
+      Some (Arrow_ffi.Int64_buffer (values, validity))
+  | FloatColumn a ->
+      let values = Array1.create float64 c_layout n in
+      Array1.fill values 0.0;
+      let validity = pack a values (fun v i x -> v.{i} <- x) in
+      Some (Arrow_ffi.Float64_buffer (values, validity))
+  | BoolColumn a ->
+      let values = bitmap () in
+      let validity = pack a values (fun v i x -> if x then set_bit v i) in
+      Some (Arrow_ffi.Boolean_buffer (n, values, validity))
+  | DateColumn a ->
+      let values = Array1.create int32 c_layout n in
+      Array1.fill values 0l;
+      let validity = pack a values (fun v i x -> v.{i} <- Int32.of_int x) in
+      Some (Arrow_ffi.Date32_buffer (values, validity))
+  | DatetimeColumn (a, tz) ->
+      let values = Array1.create int64 c_layout n in
+      Array1.fill values 0L;
+      let validity = pack a values (fun v i x -> v.{i} <- x) in
+      Some (Arrow_ffi.Timestamp_buffer (values, tz, validity))
+  | StringColumn a ->
+      let total = Array.fold_left (fun acc -> function Some s -> acc + String.length s | None -> acc) 0 a in
+      if total > Int32.to_int Int32.max_int then None
+      else begin
+        let offsets = Array1.create int32 c_layout (n + 1) in
+        let data = Array1.create int8_unsigned c_layout total in
+        let validity = bitmap () in
+        let nulls = ref 0 in
+        let pos = ref 0 in
+        offsets.{0} <- 0l;
+        (* Rows without a value repeat the previous offset. *)
+        Array.iteri (fun i cell ->
+          (match cell with
+           | Some s ->
+               String.iteri (fun j c -> data.{!pos + j} <- Char.code c) s;
+               pos := !pos + String.length s;
+               set_bit validity i
+           | None -> incr nulls);
+          offsets.{i + 1} <- Int32.of_int !pos
+        ) a;
+        let validity = if !nulls = 0 then None else Some validity in
+        Some (Arrow_ffi.Utf8_buffer (offsets, data, validity))
+      end
+  | NAColumn _ | DictionaryColumn _ | ListColumn _ -> None
+
+(** Build a native table straight from flat buffers when every column is
+    primitive and matches its declared type. *)
+let materialize_from_buffers (t : t) : t option =
+  let same_type declared col =
+    match declared, column_type_of col with
+    | ArrowTimestamp _, ArrowTimestamp _ -> true
+    | d, c -> d = c
+  in
+  let rec collect acc = function
+    | [] -> Some (List.rev acc)
+    | (name, declared) :: rest ->
+        (match List.assoc_opt name t.columns with
+         | Some col when column_length col = t.nrows && same_type declared col ->
+             let col =
+               match declared, col with
+               | ArrowTimestamp tz, DatetimeColumn (a, _) -> DatetimeColumn (a, tz)
+               | _ -> col
+             in
+             (match buffers_of_column col with
+              | Some buffers -> collect ((name, buffers) :: acc) rest
+              | None -> None)
+         | _ -> None)
+  in
+  match collect [] t.schema with
+  | None | Some [] -> None
+  | Some cols ->
+      Option.map (fun ptr -> create_from_native ptr t.schema t.nrows)
+        (Arrow_ffi.arrow_table_from_buffers cols)
+
 (** Materialize a pure OCaml table into a native Arrow-backed one.
     Returns the table itself if it already has a native_handle.
     Tables containing unsupported column builders remain in pure OCaml form. *)
@@ -641,6 +871,9 @@ let materialize (t : t) : t =
         ) t.columns in
       if has_unsupported then t
       else
+        match materialize_from_buffers t with
+        | Some native -> native
+        | None ->
         try
           let arrow_int64_tag = 0 in
           let arrow_float64_tag = 1 in
@@ -781,6 +1014,19 @@ let project (t : t) (names : string list) : t =
     Keeps the result on the native Arrow path when all columns are supported
     by the Arrow table builder; otherwise falls back to pure OCaml storage. *)
 let add_column (t : t) (name : string) (col : column_data) : t =
+  (* A primitive column joins a native table as fresh buffers; the other
+     columns are shared instead of being read back into OCaml. *)
+  let native =
+    match t.native_handle with
+    | Some handle when not handle.freed && column_length col = t.nrows ->
+        Option.bind (buffers_of_column col) (fun buffers ->
+          Option.map (fun ptr -> create_from_native ptr (schema_from_native_ptr ptr) t.nrows)
+            (Arrow_ffi.arrow_table_set_buffer_column handle.ptr name buffers))
+    | _ -> None
+  in
+  match native with
+  | Some table -> table
+  | None ->
   (* Materialize native columns if needed *)
   let base_columns =
     match t.native_handle with
@@ -0,0 +1,233 @@
+(* src/arrow/profiler.ml *)
+(* Hot-path profiler for Arrow FFI calls and DataFrame verbs.             *)
+(* Off by default. TLANG_PROFILE=1 records events in memory (see the T   *)
+(* profile() function); TLANG_PROFILE_OUT=<path> also writes them as a   *)
+(* Chrome trace (chrome://tracing, Perfetto) when the process exits.     *)
+
+(** One timed call. Row counts are -1 when the call has no table on that
+    side. [ev_path] is "native", "fallback" or "ocaml" for verbs (see
+    {!verb}) and "native" for FFI calls. *)
+type event = {
+  ev_name : string;
+  ev_cat : string;
+  ev_path : string;
+  ev_start_us : float;
+  ev_dur_us : float;
+  ev_rows_in : int;
+  ev_rows_out : int;
+  ev_native_bytes : int;
+  ev_ocaml_bytes : int;
+}
+
+let output_path =
+  match Sys.getenv_opt "TLANG_PROFILE_OUT" with
+  | Some p when String.trim p <> "" -> Some p
+  | _ -> None
+
+let enabled =
+  ref (output_path <> None
+       || match Sys.getenv_opt "TLANG_PROFILE" with
+          | Some ("1" | "true" | "yes" | "on") -> true
+          | _ -> false)
+
+(** Bytes currently held by the Arrow memory pool; set by Arrow_ffi when
+    the native backend is linked. *)
+let pool_bytes : (unit -> int) ref = ref (fun () -> 0)
+
+let origin = Unix.gettimeofday ()
+let now_us () = (Unix.gettimeofday () -. origin) *. 1e6
+
+let max_events = 200_000
+let events : event list ref = ref []
+let event_count = ref 0
+let dropped = ref 0
+
+let record ev =
+  if !event_count < max_events then begin
+    events := ev :: !events;
+    incr event_count
+  end else
+    incr dropped
+
+(* One flag per open verb span, innermost first, set when a native path
+   reports that it fell back to OCaml while the span was open. *)
+let fallback_flags : bool ref list ref = ref []
+
+let note_fallback () =
+  match !fallback_flags with
+  | flag :: _ -> flag := true
+  | [] -> ()
+
+let measure ~cat ~rows_in ~rows_out ~path name f =
+  let start = now_us () in
+  let pool_start = !pool_bytes () in
+  let heap_start = Gc.allocated_bytes () in
+  let finish rows path =
+    record {
+      ev_name = name; ev_cat = cat; ev_path = path;
+      ev_start_us = start; ev_dur_us = now_us () -. start;
+      ev_rows_in = rows_in; ev_rows_out = rows;
+      ev_native_bytes = !pool_bytes () - pool_start;
+      ev_ocaml_bytes = int_of_float (Gc.allocated_bytes () -. heap_start);
+    }
+  in
+  match f () with
+  | result -> finish (rows_out result) (path result); result
+  | exception e -> finish (-1) "error"; raise e
+
+let native _ = "native"
+
+(** [wrapN name f] is the N-argument FFI call [f], timed as [name] when
+    profiling is on and called directly otherwise. [rows_in] reads the row
+    count of the first argument and [rows_out] that of the result; both run
+    only while profiling. The optional arguments are resolved before the
+    returned function is built, so an unprofiled call allocates nothing. *)
+let wrap1 ?(rows_in = fun _ -> -1) ?(rows_out = fun _ -> -1) name f =
+  let timed a = measure ~cat:"ffi" ~rows_in:(rows_in a) ~rows_out ~path:native name in
+  fun a -> if not !enabled then f a else timed a (fun () -> f a)
+
+let wrap2 ?(rows_in = fun _ -> -1) ?(rows_out = fun _ -> -1) name f =
+  let timed a = measure ~cat:"ffi" ~rows_in:(rows_in a) ~rows_out ~path:native name in
+  fun a b -> if not !enabled then f a b else timed a (fun () -> f a b)
+
+let wrap3 ?(rows_in = fun _ -> -1) ?(rows_out = fun _ -> -1) name f =
+  let timed a = measure ~cat:"ffi" ~rows_in:(rows_in a) ~rows_out ~path:native name in
+  fun a b c -> if not !enabled then f a b c else timed a (fun () -> f a b c)
+
+let wrap4 ?(rows_in = fun _ -> -1) ?(rows_out = fun _ -> -1) name f =
+  let timed a = measure ~cat:"ffi" ~rows_in:(rows_in a) ~rows_out ~path:native name in
+  fun a b c d -> if not !enabled then f a b c d else timed a (fun () -> f a b c d)
+
+let wrap5 ?(rows_in = fun _ -> -1) ?(rows_out = fun _ -> -1) name f =
+  let timed a = measure ~cat:"ffi" ~rows_in:(rows_in a) ~rows_out ~path:native name in
+  fun a b c d e -> if not !enabled then f a b c d e else timed a (fun () -> f a b c d e)
+
+(** [verb name ~rows_in ~in_native ~rows_out ~out_native f] times a
+    DataFrame verb. Its path is "fallback" when a native kernel reported a
+    fallback during the call or a native input produced an OCaml-only
+    output, "native" when the input or output is native, else "ocaml".
+    [out_native] is [None] for results that are not tables. *)
+let verb name ~rows_in ~in_native ~rows_out ~out_native f =
+  let flag = ref false in
+  fallback_flags := flag :: !fallback_flags;
+  let close () =
+    (match !fallback_flags with _ :: rest -> fallback_flags := rest | [] -> ());
+    if !flag then note_fallback ()
+  in
+  let path result =
+    match out_native result with
+    | _ when !flag -> "fallback"
+    | Some false when in_native -> "fallback"
+    | Some true -> "native"
+    | _ -> if in_native then "native" else "ocaml"
+  in
+  Fun.protect ~finally:close (fun () ->
+    measure ~cat:"verb" ~rows_in ~rows_out ~path name f)
+
+(** Recorded events, oldest first. *)
+let take_events () = List.rev !events
+
+let reset () =
+  events := [];
+  event_count := 0;
+  dropped := 0
+
+(** Per-call totals grouped by (category, name, path), slowest first. *)
+type summary = {
+  s_cat : string;
+  s_name : string;
+  s_path : string;
+  s_calls : int;
+  s_total_us : float;
+  s_rows_in : int;
+  s_rows_out : int;
+  s_native_bytes : int;
+  s_ocaml_bytes : int;
+}
+
+let summarize (evs : event list) : summary list =
+  let tbl = Hashtbl.create 64 in
+  let add_rows acc n = if n < 0 then acc else acc + n in
+  List.iter (fun e ->
+    let key = (e.ev_cat, e.ev_name, e.ev_path) in
+    let s = match Hashtbl.find_opt tbl key with
+      | Some s -> s
+      | None ->
+          { s_cat = e.ev_cat; s_name = e.ev_name; s_path = e.ev_path; s_calls = 0;
+            s_total_us = 0.0; s_rows_in = 0; s_rows_out = 0;
+            s_native_bytes = 0; s_ocaml_bytes = 0 }
+    in
+    Hashtbl.replace tbl key
+      { s with s_calls = s.s_calls + 1;
+               s_total_us = s.s_total_us +. e.ev_dur_us;
+               s_rows_in = add_rows s.s_rows_in e.ev_rows_in;
+               s_rows_out = add_rows s.s_rows_out e.ev_rows_out;
+               s_native_bytes = s.s_native_bytes + e.ev_native_bytes;
+               s_ocaml_bytes = s.s_ocaml_bytes + e.ev_ocaml_bytes }
+  ) evs;
+  Hashtbl.fold (fun _ s acc -> s :: acc) tbl []
+  |> List.sort (fun a b -> compare b.s_total_us a.s_total_us)
+
+(* --- Chrome trace format --- *)
+
+let event_to_json (e : event) : Yojson.Safe.t =
+  `Assoc [
+    ("name", `String e.ev_name);
+    ("cat", `String e.ev_cat);
+    ("ph", `String "X");
+    ("ts", `Float e.ev_start_us);
+    ("dur", `Float e.ev_dur_us);
+    ("pid", `Int (Unix.getpid ()));
+    ("tid", `Int 0);
+    ("args", `Assoc [
+      ("path", `String e.ev_path);
+      ("rows_in", `Int e.ev_rows_in);
+      ("rows_out", `Int e.ev_rows_out);
+      ("native_bytes", `Int e.ev_native_bytes);
+      ("ocaml_bytes", `Int e.ev_ocaml_bytes);
+    ]);
+  ]
+
+let write_chrome_trace (path : string) (evs : event list) : unit =
+  let json = `Assoc [
+    ("traceEvents", `List (List.map event_to_json evs));
+    ("displayTimeUnit", `String "ms");
+    ("otherData", `Assoc [("dropped_events", `Int !dropped)]);
+  ] in
+  Yojson.Safe.to_file path json
+
+(** Read events back from a trace written by {!write_chrome_trace}. *)
+let read_chrome_trace (path : string) : (event list, string) result =
+  try
+    let open Yojson.Safe.Util in
+    let json = Yojson.Safe.from_file path in
+    let num j = match j with `Int i -> float_of_int i | `Float f -> f | _ -> 0.0 in
+    let int_field ?(default = -1) args k =
+      match args |> member k with `Int i -> i | _ -> default in
+    let evs = json |> member "traceEvents" |> to_list |> List.map (fun j ->
+      let args = j |> member "args" in
+      {
+        ev_name = j |> member "name" |> to_string;
+        ev_cat = j |> member "cat" |> to_string;
+        ev_path = (match args |> member "path" with `String s -> s | _ -> "");
+        ev_start_us = num (j |> member "ts");
+        ev_dur_us = num (j |> member "dur");
+        ev_rows_in = int_field args "rows_in";
+        ev_rows_out = int_field args "rows_out";
+        ev_native_bytes = int_field ~default:0 args "native_bytes";
+        ev_ocaml_bytes = int_field ~default:0 args "ocaml_bytes";
+      })
+    in
+    Ok evs
+  with
+  | Sys_error msg | Yojson.Json_error msg -> Error msg
+  | Yojson.Safe.Util.Type_error (msg, _) -> Error msg
+
+let () =
+  match output_path with
+  | Some path ->
+      at_exit (fun () ->
+        try write_chrome_trace path (take_events ())
+        with Sys_error msg ->
+          Printf.eprintf "[TLANG_PROFILE] could not write %s: %s\n%!" path msg)
+  | None -> ()
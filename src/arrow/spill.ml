@@ -0,0 +1,125 @@
+(* src/arrow/spill.ml *)
+(* Memory-budgeted execution for sorts and grouped operations.           *)
+(* TLANG_MEMORY_LIMIT=<bytes>[K|M|G|T] sets a budget. When the Arrow     *)
+(* memory pool plus the working set of a native sort, grouped summarize, *)
+(* count or pivot_wider would go over it, the operation writes sorted    *)
+(* runs or hash partitions as Arrow IPC files to TLANG_SPILL_DIR (by     *)
+(* default the temp directory, i.e. TMPDIR, which is the build's scratch *)
+(* directory inside a Nix sandbox) and merges them from memory-mapped    *)
+(* files. Without a limit nothing changes.                               *)
+
+(** Parse a byte count such as "64G", "512MiB" or "1048576". Units are
+    powers of 1024. *)
+let parse_bytes (s : string) : int option =
+  let s = String.lowercase_ascii (String.trim s) in
+  let strip suffix s =
+    let n = String.length s and k = String.length suffix in
+    if n > k && String.sub s (n - k) k = suffix then String.sub s 0 (n - k) else s
+  in
+  let s = strip "b" (strip "ib" s) in
+  let n = String.length s in
+  if n = 0 then None
+  else
+    let (digits, shift) =
+      match s.[n - 1] with
+      | 'k' -> (String.sub s 0 (n - 1), 10)
+      | 'm' -> (String.sub s 0 (n - 1), 20)
+      | 'g' -> (String.sub s 0 (n - 1), 30)
+      | 't' -> (String.sub s 0 (n - 1), 40)
+      | _ -> (s, 0)
+    in
+    match int_of_string_opt (String.trim digits) with
+    | Some v when v > 0 -> Some (v lsl shift)
+    | _ -> None
+
+(** Memory budget in bytes, None for unlimited. *)
+let memory_limit : int option ref =
+  ref (Option.bind (Sys.getenv_opt "TLANG_MEMORY_LIMIT") parse_bytes)
+
+let spill_dir () =
+  match Sys.getenv_opt "TLANG_SPILL_DIR" with
+  | Some d when String.trim d <> "" -> d
+  | _ -> Filename.get_temp_dir_name ()
+
+(** Smallest sort run. A ref so tests can exercise the merge on small
+    tables. *)
+let min_run_rows = ref 65536
+
+(** Upper bound on partition files open at once. *)
+let max_partitions = 256
+
+(** Operations that spilled since startup, reported by memory_pool(). *)
+let spill_count = ref 0
+
+(* Set while a partition is being processed: the partition's rows share
+   their hash bucket, so partitioning it again would not split it. *)
+let in_partition = ref false
+
+(** [Some (ptr, bytes, limit)] when [t] is native and the pool plus twice
+    its estimated size (the input's keys and a copy of the output) would
+    exceed the limit. *)
+let over_budget (t : Arrow_table.t) : (nativeint * int * int) option =
+  match !memory_limit, t.native_handle with
+  | Some limit, Some h when Arrow_ffi.arrow_available && not h.Arrow_table.freed && t.nrows > 1 ->
+      let bytes = Arrow_ffi.arrow_table_nbytes h.ptr in
+      if Arrow_table.pool_bytes_allocated () + 2 * bytes > limit then Some (h.ptr, bytes, limit)
+      else None
+  | _ -> None
+
+(* A quarter of the room left under the limit, for one run or partition. *)
+let share limit = max ((limit - Arrow_table.pool_bytes_allocated ()) / 4) 1
+
+let table_of_ptr (ptr : nativeint) : Arrow_table.t =
+  Arrow_table.create_from_native ptr (Arrow_table.schema_from_native_ptr ptr)
+    (Arrow_ffi.arrow_table_num_rows ptr)
+
+(** External merge sort of [t] by [(column, ascending)] keys when it is over
+    budget. None when it fits, or for keys the spill kernel refuses. *)
+let sort (t : Arrow_table.t) (keys : (string * bool) list) : Arrow_table.t option =
+  match over_budget t with
+  | None -> None
+  | Some (ptr, bytes, limit) ->
+      let rows = int_of_float (float_of_int t.nrows *. float_of_int (share limit)
+                               /. float_of_int (max bytes 1)) in
+      let run_rows = max !min_run_rows rows in
+      if run_rows >= t.nrows then None
+      else
+        match Arrow_ffi.arrow_spill_sort ptr (List.map fst keys) (List.map snd keys)
+                run_rows (spill_dir ()) with
+        | Some sorted ->
+            incr spill_count;
+            Some (Arrow_table.create_from_native sorted t.schema t.nrows)
+        | None -> None
+
+(** Apply [f] to each hash partition of [t] by [keys] when [t] is over
+    budget, one mapped partition at a time. Rows keep their input order
+    within a partition; with [row_ids] each partition carries the input
+    row numbers in an int64 column [__spill_row]. None when [t] fits, a
+    partition is being processed already, or the keys cannot be
+    partitioned. *)
+let map_partitions ?(row_ids = false) (t : Arrow_table.t) (keys : string list)
+    (f : Arrow_table.t -> 'a) : 'a list option =
+  if !in_partition || keys = [] then None
+  else
+    match over_budget t with
+    | None -> None
+    | Some (ptr, bytes, limit) ->
+        let n_parts = min max_partitions (max 2 ((2 * bytes + share limit - 1) / share limit)) in
+        (match Arrow_ffi.arrow_spill_partition ptr keys n_parts (spill_dir ()) row_ids with
+         | None -> None
+         | Some paths ->
+             incr spill_count;
+             let remove path = try Sys.remove path with Sys_error _ -> () in
+             let rec go acc = function
+               | [] -> Some (List.rev acc)
+               | path :: rest ->
+                   (* The mapping outlives the file, so it can go at once. *)
+                   let part = Arrow_ffi.arrow_read_ipc path in
+                   remove path;
+                   (match part with
+                    | Some p -> go (f (table_of_ptr p) :: acc) rest
+                    | None -> List.iter remove rest; None)
+             in
+             in_partition := true;
+             Fun.protect ~finally:(fun () -> in_partition := false; List.iter remove paths)
+               (fun () -> go [] paths))
@@ -77,6 +77,26 @@ and dataframe = {
   group_keys : string list;
 }
 
+(** A deferred dataframe query: a source plus the verbs applied to it, in
+    order. Steps keep the evaluated builtin and arguments so the plan can be
+    optimised and replayed at [collect()] time. *)
+and lazy_frame = {
+  lf_source : lazy_source;
+  lf_steps : lazy_step list;
+}
+
+and lazy_source =
+  | LazyTable of dataframe
+  | LazyParquet of string
+  | LazyCsv of string
+
+and lazy_step = {
+  ls_verb : string;
+  ls_fn : builtin;
+  ls_args : (string option * value) list;
+  ls_env : value Env.t;
+}
+
 and ndarray = {
   shape : int array;
   data : float array;
@@ -255,6 +275,7 @@ and value =
   | VVector of value array
   | VNDArray of ndarray
   | VDataFrame of dataframe
+  | VLazyFrame of lazy_frame
   | VPipeline of pipeline_result
   | VMetaPipeline of meta_pipeline
 
@@ -404,6 +425,12 @@ let computed_node_resolver : (computed_node -> computed_node) ref = ref (fun cn
 (** Global hook for automatically flattening meta-pipelines in built-in argument projections *)
 let meta_pipeline_flatten_resolver : (value -> value) ref = ref (fun v -> v)
 
+(** Global hook for materialising lazy frames at serialization boundaries *)
+let lazy_frame_collect_resolver : (lazy_frame -> value) ref = ref (fun _ -> VNA NAGeneric)
+
+(** Global hook for printing a lazy frame's plan without running it *)
+let lazy_frame_plan_resolver : (lazy_frame -> string) ref = ref (fun _ -> "LazyFrame")
+
 (** Pipeline-scoped in-memory node value cache.
     Keyed by (pipeline_exprs, node_name) to avoid cross-pipeline contamination.
 
@@ -776,6 +803,7 @@ module Utils = struct
     | VSymbol _ -> "Symbol" | VDate _ -> "Date" | VDatetime _ -> "Datetime"
     | VList _ -> "List" | VDict _ -> "Dict"
     | VVector _ -> "Vector" | VNDArray _ -> "NDArray" | VDataFrame _ -> "DataFrame"
+    | VLazyFrame _ -> "LazyFrame"
     | VPipeline _ -> "Pipeline" | VMetaPipeline _ -> "MetaPipeline" | VLens _ -> "Lens"
     | VLambda _ -> "Function" | VBuiltin _ -> "BuiltinFunction"
     | VNA _ -> "NA" | VError _ -> "Error"
@@ -1093,6 +1121,7 @@ module Utils = struct
           cn.cn_runtime cn.cn_serializer cn.cn_class
     | VSerializer s ->
         Printf.sprintf "serializer<^%s>" s.s_format
+    | VLazyFrame lf -> !lazy_frame_plan_resolver lf
     | VNode un ->
         Printf.sprintf "node<%s>(...)" un.un_runtime
     | VNullNode -> "<null>"
@@ -962,6 +962,251 @@ let rec match_pattern (pattern : Ast.match_pattern) (value : Ast.value)
       match_list patterns items []
   | _ -> None
 
+(** Run a builtin whose data argument is a DataFrame as a profiler verb
+    span, recording rows in/out and whether it stayed on the native path. *)
+let profile_verb name (df : dataframe) f =
+  let out_frame = function VDataFrame d -> Some d | _ -> None in
+  Profiler.verb (Option.value name ~default:"<builtin>")
+    ~rows_in:(Arrow_table.num_rows df.arrow_table)
+    ~in_native:(Arrow_table.is_native_backed df.arrow_table)
+    ~rows_out:(fun v -> match out_frame v with
+      | Some d -> Arrow_table.num_rows d.arrow_table
+      | None -> -1)
+    ~out_native:(fun v ->
+      Option.map (fun d -> Arrow_table.is_native_backed d.arrow_table) (out_frame v))
+    f
+
+(* --- Compiled lambda bodies --- *)
+
+(* Row-wise verbs (mutate/filter fallbacks, map) call one closure once per
+   element. Its body is compiled once into OCaml closures: parameters are
+   read from slots by position and free variables are resolved against the
+   captured environment up front, instead of looking names up in the
+   environment map on every call. Forms the compiler does not handle are
+   evaluated by the tree-walker in the environment it would have built,
+   which is only built when such a form is reached. TLANG_COMPILE_LAMBDAS=0
+   turns this off. *)
+
+(** Per-call state of a compiled body: argument values by parameter
+    position, the closure's captured environment (where free names are
+    looked up), that environment with the parameters bound (what a builtin
+    called from the body sees), and the tree-walker's full call
+    environment. The last two are built on demand. *)
+type frame = {
+  slots : value array;
+  closure_env : environment;
+  params_env : environment ref Lazy.t;
+  call_env : environment ref Lazy.t;
+}
+
+type compiled = frame -> value
+
+let compile_lambdas =
+  ref (match Sys.getenv_opt "TLANG_COMPILE_LAMBDAS" with
+       | Some ("0" | "false" | "off") -> false
+       | _ -> true)
+
+(* Keyed on the body and parameter list by identity: compiled code reads
+   free names from the frame's closure environment, so every closure made
+   from one `\(...)` expression shares it. The hash is of the body's and
+   parameters' structure, which stays put when the GC moves them and tells
+   apart bodies synthesised without a location. The keys are weak, so an
+   entry goes with its lambda expression. *)
+module Compiled_lambdas = Ephemeron.K2.Make (struct
+  type t = Ast.expr
+  let equal = ( == )
+  let hash (b : Ast.expr) = Hashtbl.hash b.node
+end) (struct
+  type t = Ast.symbol list
+  let equal = ( == )
+  let hash (params : Ast.symbol list) = Hashtbl.hash params
+end)
+
+let compiled_lambdas : compiled option Compiled_lambdas.t = Compiled_lambdas.create 64
+let max_compiled_lambdas = 256
+
+(** Bodies compiled, and calls served by an already compiled body, since
+    startup. *)
+let lambdas_compiled = ref 0
+let compiled_lambda_hits = ref 0
+
+(** Builtins whose arguments eval_call rewrites (NSE) or inspects
+    unevaluated. *)
+let uses_nse_builtin = function
+  | Some ("mutate" | "mutate_node"
+          | "summarize" | "summarize_node"
+          | "filter" | "filter_node"
+          | "which_nodes"
+          | "select" | "select_node"
+          | "arrange" | "arrange_node"
+          | "group_by" | "group_by_node"
+          | "count" | "count_node"
+          | "rename" | "rename_node"
+          | "pivot_longer" | "pivot_longer_node"
+          | "pivot_wider" | "pivot_wider_node"
+          | "read_csv" | "read_parquet"
+          | "node" | "pyn" | "rn" | "jln" | "qn" | "shn" | "inspect") -> true
+  | _ -> false
+
+(* Call forms eval_expr handles syntactically, before evaluating the callee. *)
+let special_call_names =
+  ["to_expr"; "to_exprs"; "quo"; "quos"; "eval"; "enquo"; "enquos";
+   "node"; "pyn"; "rn"; "jln"; "qn"; "shn"]
+
+(* Bodies that can rebind names (blocks, rm) must keep reading parameters
+   from the environment, so they are never compiled. *)
+let rec rebinds_names (e : Ast.expr) =
+  match e.node with
+  | Block _ -> true
+  | Call { fn = { node = Var "rm"; _ }; _ } -> true
+  | Value _ | Var _ | ColumnRef _ | RawCode _ | ShellExpr _ -> false
+  | Call { fn; args } -> rebinds_names fn || List.exists (fun (_, a) -> rebinds_names a) args
+  | Lambda _ -> false  (* a nested closure rebinds in its own call environment *)
+  | IfElse { cond; then_; else_ } -> rebinds_names cond || rebinds_names then_ || rebinds_names else_
+  | Match { scrutinee; cases } ->
+      rebinds_names scrutinee || List.exists (fun (_, b) -> rebinds_names b) cases
+  | ListLit items -> List.exists (fun (_, a) -> rebinds_names a) items
+  | ListComp { expr; clauses } ->
+      rebinds_names expr
+      || List.exists (function CFor { iter; _ } -> rebinds_names iter | CFilter c -> rebinds_names c) clauses
+  | DictLit pairs | PipelineDef pairs | PipelineOfDef pairs | IntentDef pairs ->
+      List.exists (fun (_, a) -> rebinds_names a) pairs
+  | BinOp { left; right; _ } | BroadcastOp { left; right; _ } -> rebinds_names left || rebinds_names right
+  | UnOp { operand; _ } -> rebinds_names operand
+  | DotAccess { target; _ } -> rebinds_names target
+  | Unquote inner | UnquoteSplice inner -> rebinds_names inner
+
+(* The last binding of a repeated parameter name wins, as with Env.add. *)
+let slot_index name params =
+  let rec go i found = function
+    | [] -> found
+    | p :: rest -> go (i + 1) (if p = name then Some i else found) rest
+  in
+  go 0 None params
+
+(** Name the argument behind a TypeError raised by a builtin, from the
+    variable or column it was passed as. *)
+let enrich_type_error err enriched_args =
+  match err with
+  | VError info when info.code = TypeError ->
+      let arg_idx = 
+        match List.assoc_opt "arg_index" info.context with
+        | Some (VString s) -> (try Some (int_of_string s) with _ -> None)
+        | _ -> None
+      in
+      (match arg_idx with
+       | Some idx when idx > 0 && idx <= List.length enriched_args ->
+           let (_, source, v) = 
+             let (n, (src, val_)) = List.nth enriched_args (idx - 1) in
+             (n, src, val_)
+           in
+           let source_name =
+             match source with
+             | Some s -> Some s
+             | None -> (match Utils.unwrap_value v with VNodeResult { node_name; _ } -> Some node_name | _ -> None)
+           in
+           let base_msg = 
+             if String.length info.message > 0 && info.message.[String.length info.message - 1] = '.' 
+             then String.sub info.message 0 (String.length info.message - 1)
+             else info.message
+           in
+           (match source_name with
+            | Some name -> VError { info with message = base_msg ^ " (" ^ name ^ ")" }
+            | None -> VError info)
+       | _ -> VError info)
+  | _ -> err
+
+(** The variable or column an argument expression names, for error messages. *)
+let arg_source (e : Ast.expr) =
+  match e.node with Var s -> Some s | ColumnRef s -> Some ("$" ^ s) | _ -> None
+
+(** Expand one evaluated call argument: `!!x` passes its value, `!!!xs`
+    splices a collection into several arguments, and `!!name := v` names it. *)
+let spliced_arg_units name source v =
+  match v with
+  | VUnquote inner -> [(name, (source, inner))]
+  | VUnquoteSplice sv ->
+      (match sv with
+       | VList items -> items |> List.map (fun (n, v) -> (n, (None, v)))
+       | VVector vx -> Array.to_list vx |> List.map (fun x -> (None, (None, x)))
+       | VDict d -> List.map (fun (k, v) -> (Some k, (None, v))) d
+       | _ -> [(name, (None, sv))])
+  | VDynamicArg (n, v) -> [(Some n, (None, v))]
+  | _ -> [(name, (source, v))]
+
+let if_condition cond_val =
+  match cond_val with
+  | VError _ as e -> Error e
+  | VNA _ -> Error (Error.na_predicate_error "Cannot use NA as a condition")
+  | VBool b -> Ok b
+  | _ -> Error (make_error TypeError ("If condition must be Bool, got " ^ Utils.type_name cond_val))
+
+(** `&&` / `||` given the left operand and a thunk for the right one. *)
+let short_circuit op lval rval =
+  let sym = match op with And -> "&&" | _ -> "||" in
+  let check_right () =
+    match rval () with
+    | VError _ as e -> e
+    | VBool b -> VBool b
+    | VNA _ -> Error.na_predicate_error ("Cannot use NA as a condition in " ^ sym)
+    | r -> make_error TypeError ("Right operand of " ^ sym ^ " must be Bool, got " ^ Utils.type_name r)
+  in
+  match op, lval with
+  | _, (VError _ as e) -> e
+  | And, VBool false -> VBool false
+  | Or, VBool true -> VBool true
+  | _, VBool _ -> check_right ()
+  | _, VNA _ -> Error.na_predicate_error ("Cannot use NA as a condition in " ^ sym)
+  | _ -> make_error TypeError ("Left operand of " ^ sym ^ " must be Bool, got " ^ Utils.type_name lval)
+
+(** Arithmetic, comparison and bitwise operators on evaluated operands. *)
+let binop_values op lval_raw rval_raw =
+  let lval = Utils.unwrap_value lval_raw in
+  let rval = Utils.unwrap_value rval_raw in
+  match (op, lval, rval) with
+  | _, VError _, _ -> lval
+  | _, _, VError _ -> rval
+  | (Plus | Minus | Mul | Div | Mod | Lt | Gt | LtEq | GtEq | Eq | NEq | BitAnd | BitOr), _, _ -> 
+      (match lval, rval with
+       | VNDArray _, _ | _, VNDArray _
+       | Ast.VVector _, _ | _, Ast.VVector _
+       | Ast.VList _, _ | _, Ast.VList _ -> 
+          let op_str = match op with
+            | Plus -> "+" | Minus -> "-" | Mul -> "*" | Div -> "/" | Mod -> "%"
+            | Lt -> "<" | Gt -> ">" | LtEq -> "<=" | GtEq -> ">="
+            | Eq -> "==" | NEq -> "!="
+            | BitAnd -> "&" | BitOr -> "|"
+            | _ -> "??"
+          in
+          let dot_op = "." ^ op_str in
+          let msg = Printf.sprintf "Operator '%s' is defined for scalars only.\nUse '%s' for element-wise (broadcast) operations." op_str dot_op in
+          Error.type_error msg
+       | _ -> eval_scalar_binop op lval rval)
+  | _ -> eval_scalar_binop op lval rval
+
+let unop_value op v =
+  let v = Utils.unwrap_value v in
+  match v with VError _ as e -> e | _ ->
+  match v with
+  | VNA _ -> Error.na_predicate_error "Operation on NA: NA values do not propagate implicitly. Handle missingness explicitly."
+  | _ ->
+  match (op, v) with
+  | (Not, VBool b) -> VBool (not b)
+  | (Not, other) -> make_error TypeError (Printf.sprintf "Operand of 'not' must be Bool, got %s" (Utils.type_name other))
+  | (Neg, VInt i) -> VInt (-i)
+  | (Neg, VFloat f) -> VFloat (-.f)
+  | (Neg, other) -> make_error TypeError (Printf.sprintf "Cannot negate %s" (Utils.type_name other))
+
+(** A piped value that `|>` refuses to forward. *)
+let pipe_error lval_raw e =
+  (match lval_raw with
+   | VNodeResult _ ->
+       Printf.eprintf "\n\
+         \027[1m\u{1F4A1} Tip:\027[0m `read_node()` returned a first-class error value, but `|>` short-circuits on errors.\n\
+         \027[1m   Use `?|>` instead:\027[0m  read_node(p.node) ?|> my_function()\n%!"
+   | _ -> ());
+  e
+
 let rec eval_match (env_ref : environment ref) scrutinee cases =
   let scrutinee_value = eval_expr env_ref scrutinee in
   let rec eval_cases = function
@@ -1020,13 +1265,10 @@ and eval_expr (env_ref : environment ref) (expr : Ast.expr) : value =
     | UnOp { op; operand } -> eval_unop env_ref op operand
 
     | IfElse { cond; then_; else_ } ->
-        let cond_val = eval_expr env_ref cond in
-        (match cond_val with
-         | VError _ as e -> e
-         | VNA _ -> Error.na_predicate_error "Cannot use NA as a condition"
-         | VBool true -> eval_expr env_ref then_
-         | VBool false -> eval_expr env_ref else_
-         | _ -> make_error TypeError ("If condition must be Bool, got " ^ Utils.type_name cond_val))
+        (match if_condition (eval_expr env_ref cond) with
+         | Ok true -> eval_expr env_ref then_
+         | Ok false -> eval_expr env_ref else_
+         | Error e -> e)
     | Match { scrutinee; cases } ->
         eval_match env_ref scrutinee cases
 
@@ -2431,7 +2673,9 @@ and eval_dict_lit env_ref items =
 
 
 and eval_dot_access env_ref target_expr field =
-  let target_val = eval_expr env_ref target_expr in
+  dot_access_value env_ref (eval_expr env_ref target_expr) field
+
+and dot_access_value env_ref target_val field =
   match target_val with
   | VNodeResult { diagnostics; _ } ->
       (match field with
@@ -3063,23 +3307,6 @@ and eval_call env_ref fn_val raw_args =
   (* NSE auto-transformation: if an argument is a complex expression containing
      ColumnRef nodes (not a bare ColumnRef), wrap it in a lambda \(row) <desugared>
      before evaluation. Bare ColumnRef stays as-is (evaluates to VSymbol). *)
-  let uses_nse_builtin name =
-    match name with
-    | Some ("mutate" | "mutate_node"
-            | "summarize" | "summarize_node"
-            | "filter" | "filter_node"
-            | "which_nodes"
-            | "select" | "select_node"
-            | "arrange" | "arrange_node"
-            | "group_by" | "group_by_node"
-            | "count" | "count_node"
-            | "rename" | "rename_node"
-           | "pivot_longer" | "pivot_longer_node"
-           | "pivot_wider" | "pivot_wider_node"
-           | "node" | "pyn" | "rn" | "jln" | "qn" | "shn" | "inspect") -> true
-    | _ -> false
-  in
-
   let transform_nse_args args =
     if not (uses_nse_builtin current_builtin_name) then args
     else
@@ -3183,62 +3410,16 @@ and eval_call env_ref fn_val raw_args =
                | Some n -> VDynamicArg (n, eval_expr env_ref value_expr))
           | _ -> eval_expr env_ref e
         in
-        match v with
-        | VUnquote inner -> 
-            let source = match e.node with Var s -> Some s | ColumnRef s -> Some ("$" ^ s) | _ -> None in
-            process_args_spliced (acc @ [(name, (source, inner))]) (param_index + 1) rest
-        | VUnquoteSplice sv ->
-            let units = match sv with
-              | VList items -> items |> List.map (fun (n, v) -> (n, (None, v)))
-              | VVector vx -> Array.to_list vx |> List.map (fun x -> (None, (None, x)))
-              | VDict d -> List.map (fun (k, v) -> (Some k, (None, v))) d
-              | _ -> [(name, (None, sv))]
-            in
-            process_args_spliced (acc @ units) (param_index + List.length units) rest
-        | VDynamicArg (n, v) ->
-            process_args_spliced (acc @ [(Some n, (None, v))]) (param_index + 1) rest
-        | _ -> 
-            let source = match e.node with Var s -> Some s | ColumnRef s -> Some ("$" ^ s) | _ -> None in
-            process_args_spliced (acc @ [(name, (source, v))]) (param_index + 1) rest
+        let units = spliced_arg_units name (arg_source e) v in
+        process_args_spliced (acc @ units) (param_index + List.length units) rest
   in
 
   let named_args_enriched = process_args_spliced [] 0 raw_args in
   let named_args = List.map (fun (n, (_, v)) -> (n, v)) named_args_enriched in
 
-  let enrich_type_error err enriched_args =
-    match err with
-    | VError info when info.code = TypeError ->
-        let arg_idx = 
-          match List.assoc_opt "arg_index" info.context with
-          | Some (VString s) -> (try Some (int_of_string s) with _ -> None)
-          | _ -> None
-        in
-        (match arg_idx with
-         | Some idx when idx > 0 && idx <= List.length enriched_args ->
-             let (_, source, v) = 
-               let (n, (src, val_)) = List.nth enriched_args (idx - 1) in
-               (n, src, val_)
-             in
-             let source_name =
-               match source with
-               | Some s -> Some s
-               | None -> (match Utils.unwrap_value v with VNodeResult { node_name; _ } -> Some node_name | _ -> None)
-             in
-             let base_msg = 
-               if String.length info.message > 0 && info.message.[String.length info.message - 1] = '.' 
-               then String.sub info.message 0 (String.length info.message - 1)
-               else info.message
-             in
-             (match source_name with
-              | Some name -> VError { info with message = base_msg ^ " (" ^ name ^ ")" }
-              | None -> VError info)
-         | _ -> VError info)
-    | _ -> err
-  in
-
   (* Apply a user lambda, including the autoquote-specific `__aq_<name>` bindings
      used to re-expand `!!param` inside NSE-aware builtins. *)
-  let apply_lambda base_env params autoquote_params param_types return_type variadic body =
+  let apply_lambda ?code base_env params autoquote_params param_types return_type variadic body =
     let args_vals = List.map snd named_args in
     let n_params = List.length params in
     let n_args = List.length args_vals in
@@ -3270,33 +3451,44 @@ and eval_call env_ref fn_val raw_args =
           if type_errors <> [] then
             Error.type_error (String.concat "; " type_errors)
           else
-            let call_env =
+            let caller_env = !env_ref in
+            let bind_params () =
               List.fold_left2
                 (fun current_env name value -> Env.add name value current_env)
                 base_env params fixed_args
             in
-            let caller_env = !env_ref in
-            let call_raw_args = List.map snd raw_args in
-            let fixed_raw_args = take_prefix n_params call_raw_args in
-            let call_env = List.fold_left2 (fun acc name e ->
-              Env.add ("__q_" ^ name) (VExpr e) acc
-            ) call_env params fixed_raw_args in
-            let call_env =
-              List.fold_left (fun acc (index, captured_expr) ->
-                match List.nth_opt params index with
-                | Some name -> Env.add ("__aq_" ^ name) (VExpr captured_expr) acc
-                | None -> acc
-              ) call_env !autoquote_captured_exprs
+            let build_call_env () =
+              let call_env = bind_params () in
+              let call_raw_args = List.map snd raw_args in
+              let fixed_raw_args = take_prefix n_params call_raw_args in
+              let call_env = List.fold_left2 (fun acc name e ->
+                Env.add ("__q_" ^ name) (VExpr e) acc
+              ) call_env params fixed_raw_args in
+              let call_env =
+                List.fold_left (fun acc (index, captured_expr) ->
+                  match List.nth_opt params index with
+                  | Some name -> Env.add ("__aq_" ^ name) (VExpr captured_expr) acc
+                  | None -> acc
+                ) call_env !autoquote_captured_exprs
+              in
+              let call_env = Env.add "__q_caller_env__" (VEnv caller_env) call_env in
+              let call_env = if variadic then
+                 let dots_vals = if n_args > n_params then drop_prefix n_params args_vals |> List.map (fun v -> (None, v)) else [] in
+                 let dots_exprs = if n_args > n_params then drop_prefix n_params raw_args |> List.map (fun (n, e) -> (n, VExpr e)) else [] in
+                 let env = Env.add "..." (VList dots_vals) call_env in
+                 Env.add "__q_dots" (VList dots_exprs) env
+              else call_env in
+              call_env
+            in
+            let result =
+              match code with
+              | Some run ->
+                  run { slots = Array.of_list fixed_args;
+                        closure_env = base_env;
+                        params_env = lazy (ref (bind_params ()));
+                        call_env = lazy (ref (build_call_env ())) }
+              | None -> eval_expr (ref (build_call_env ())) body
             in
-            let call_env = Env.add "__q_caller_env__" (VEnv caller_env) call_env in
-            let call_env = if variadic then
-               let dots_vals = if n_args > n_params then drop_prefix n_params args_vals |> List.map (fun v -> (None, v)) else [] in
-               let dots_exprs = if n_args > n_params then drop_prefix n_params raw_args |> List.map (fun (n, e) -> (n, VExpr e)) else [] in
-               let env = Env.add "..." (VList dots_vals) call_env in
-               Env.add "__q_dots" (VList dots_exprs) env
-            else call_env in
-            let call_env_ref = ref call_env in
-            let result = eval_expr call_env_ref body in
             (match return_type with
              | Some t when not (Error.is_error_value result) && not (Ast.is_compatible result t) ->
                  let expected = Ast.Utils.typ_to_string t in
@@ -3306,18 +3498,11 @@ and eval_call env_ref fn_val raw_args =
   in
 
   match fn_val with
-  | VBuiltin { b_name; b_arity; b_variadic; b_func } ->
-      let arg_count = List.length named_args in
-      if not b_variadic && arg_count <> b_arity then
-        match b_name with
-        | Some name -> Error.arity_error_named name b_arity arg_count
-        | None -> Error.arity_error b_arity arg_count
-      else
-        let res = b_func named_args env_ref in
-        enrich_type_error res named_args_enriched
+  | VBuiltin builtin -> apply_builtin env_ref builtin named_args_enriched
 
   | VLambda { params; autoquote_params; param_types; return_type; variadic; body; env = Some closure_env; _ } ->
-      apply_lambda closure_env params autoquote_params param_types return_type variadic body
+      let code = compiled_lambda params autoquote_params variadic body in
+      apply_lambda ?code closure_env params autoquote_params param_types return_type variadic body
 
   | VLambda { params; autoquote_params; param_types; return_type; variadic; body; env = None; _ } ->
       apply_lambda !env_ref params autoquote_params param_types return_type variadic body
@@ -3383,6 +3568,176 @@ and eval_call env_ref fn_val raw_args =
   | _ -> Error.not_callable_error (Utils.type_name fn_val)
   end
 
+(** Apply a builtin to evaluated arguments, each paired with the variable
+    or column it came from for error messages. *)
+and apply_builtin env_ref ({ b_name; b_arity; b_variadic; b_func } as builtin) named_args_enriched =
+  let named_args = List.map (fun (n, (_, v)) -> (n, v)) named_args_enriched in
+  let arg_count = List.length named_args in
+  if not b_variadic && arg_count <> b_arity then
+    match b_name with
+    | Some name -> Error.arity_error_named name b_arity arg_count
+    | None -> Error.arity_error b_arity arg_count
+  else
+    (* Verbs applied to a lazy frame extend its plan; any other builtin
+       is a materialisation boundary for lazy arguments. *)
+    (match Lazy_plan.record_step builtin named_args !env_ref with
+     | Some lazy_frame -> lazy_frame
+     | None ->
+         match Lazy_plan.materialize_args b_name named_args with
+         | Error err -> err
+         | Ok named_args ->
+             let res =
+               match named_args with
+               | (None, data) :: _ when !Profiler.enabled ->
+                   (match Ast.Utils.unwrap_value data with
+                    | VDataFrame df -> profile_verb b_name df (fun () -> b_func named_args env_ref)
+                    | _ -> b_func named_args env_ref)
+               | _ -> b_func named_args env_ref
+             in
+             enrich_type_error res named_args_enriched)
+
+(** The compiled body of a closure, or [None] when it is tree-walked.
+    Cached per body and parameter list. *)
+and compiled_lambda params autoquote_params variadic body =
+  if not !compile_lambdas || variadic || List.mem true autoquote_params then None
+  else
+    let key = (body, params) in
+    match Compiled_lambdas.find_opt compiled_lambdas key with
+    | Some code ->
+        if Option.is_some code then incr compiled_lambda_hits;
+        code
+    | None ->
+        let code =
+          if rebinds_names body then None
+          else compile_expr params body
+        in
+        if Option.is_some code then incr lambdas_compiled;
+        if Compiled_lambdas.length compiled_lambdas >= max_compiled_lambdas then begin
+          Compiled_lambdas.clean compiled_lambdas;
+          if Compiled_lambdas.length compiled_lambdas >= max_compiled_lambdas then
+            Compiled_lambdas.reset compiled_lambdas
+        end;
+        Compiled_lambdas.replace compiled_lambdas key code;
+        code
+
+(** Compile [e], or return [None] for forms left to the tree-walker.
+    Parameters become slot reads; other names are looked up at each call in
+    the frame's closure environment, so the code does not depend on which
+    closure it runs for. *)
+and compile_expr params (e : Ast.expr) : compiled option =
+  let sub = compile_or_walk params in
+  let located (code : compiled) = Some (fun fr -> attach_expr_location e (code fr)) in
+  match e.node with
+  | Value (VSymbol s) when String.length s > 0 && s.[0] = '^' -> None
+  | Value v -> located (fun _ -> v)
+  | Var s when s = "..." || String.starts_with ~prefix:"__" s -> None
+  | Var s ->
+      (match slot_index s params with
+       | Some i -> located (fun fr -> fr.slots.(i))
+       | None ->
+           (* Unbound names go to the tree-walker for node lookup and the
+              name error. *)
+           Some (fun fr ->
+             match Env.find_opt s fr.closure_env with
+             | Some v -> attach_expr_location e v
+             | None -> eval_expr (Lazy.force fr.call_env) e))
+  | ColumnRef field ->
+      let name = "$" ^ field in
+      located (fun fr ->
+        match Env.find_opt name fr.closure_env with
+        | Some v -> v
+        | None -> VSymbol name)
+  | BinOp { op = (Pipe | MaybePipe) as op; left; right } ->
+      located (compile_pipe params op left right)
+  | BinOp { op = (And | Or) as op; left; right } ->
+      let l = sub left and r = sub right in
+      located (fun fr -> short_circuit op (l fr) (fun () -> r fr))
+  | BinOp { op = (Formula | FatArrow | In); _ } -> None
+  | BinOp { op; left; right } ->
+      let l = sub left and r = sub right in
+      located (fun fr -> let lv = l fr in let rv = r fr in binop_values op lv rv)
+  | BroadcastOp { op; left; right } ->
+      let l = sub left and r = sub right in
+      located (fun fr -> let v1 = l fr in let v2 = r fr in broadcast2 op v1 v2)
+  | UnOp { op; operand } ->
+      let o = sub operand in
+      located (fun fr -> unop_value op (o fr))
+  | IfElse { cond; then_; else_ } ->
+      let c = sub cond and t = sub then_ and f = sub else_ in
+      located (fun fr ->
+        match if_condition (c fr) with
+        | Ok true -> t fr
+        | Ok false -> f fr
+        | Error err -> err)
+  | DotAccess { target; field } ->
+      let t = sub target in
+      located (fun fr -> dot_access_value (Lazy.force fr.params_env) (t fr) field)
+  | Call { fn = { node = Var name; _ }; _ } when List.mem name special_call_names -> None
+  | Call { fn; args } ->
+      let f = sub fn and call = compile_call params args in
+      located (fun fr -> call fr (Utils.unwrap_value (f fr)) None)
+  | _ -> None
+
+and compile_or_walk params (e : Ast.expr) : compiled =
+  match compile_expr params e with
+  | Some code -> code
+  | None -> fun fr -> eval_expr (Lazy.force fr.call_env) e
+
+(** `x |> f(y)` and `x ?|> f(y)`. A chain of pipes compiles to nested calls,
+    each passing its value straight to the next builtin. *)
+and compile_pipe params op left right : compiled =
+  let lhs = compile_or_walk params left in
+  let fn_expr, args =
+    match right.node with
+    | Call { fn; args } -> (fn, args)
+    | _ -> (right, [])
+  in
+  let f = compile_or_walk params fn_expr in
+  let call = compile_call params args in
+  fun fr ->
+    let lval_raw = lhs fr in
+    match op, Utils.unwrap_value lval_raw with
+    | Pipe, (VError _ as e) -> pipe_error lval_raw e
+    | Pipe, lval -> call fr (f fr) (Some lval)
+    | _ -> call fr (f fr) (Some lval_raw)
+
+(** Call a function value with [args], after the [piped] value if any.
+    Builtins that take their arguments evaluated get them from compiled
+    code; other callees receive the argument expressions via eval_call. *)
+and compile_call params args : frame -> value -> value option -> value =
+  let plain_args =
+    List.for_all (fun (_, (a : Ast.expr)) ->
+      match a.node with
+      | Unquote _ | UnquoteSplice _
+      | Call { fn = { node = Var "__dynamic_arg__"; _ }; _ } -> false
+      | _ -> true) args
+  in
+  let arg_codes =
+    List.map (fun (name, a) -> (name, arg_source a, compile_or_walk params a)) args
+  in
+  fun fr fn_val piped ->
+    let leading =
+      match piped with
+      | None -> Some []
+      | Some (VExpr _ | VQuo _) -> None
+      | Some (VSymbol s) when String.length s > 0 && s.[0] = '^' -> None
+      | Some v -> Some (spliced_arg_units None None v)
+    in
+    match fn_val, leading with
+    | VBuiltin ({ b_name; _ } as builtin), Some leading
+      when plain_args && not (uses_nse_builtin b_name)
+           && b_name <> Some "rm" && b_name <> Some "read_past_node" ->
+        let evaluated =
+          List.concat_map (fun (name, source, code) -> spliced_arg_units name source (code fr)) arg_codes
+        in
+        apply_builtin (Lazy.force fr.params_env) builtin (leading @ evaluated)
+    | _ ->
+        let raw_args = match piped with
+          | Some v -> (None, vexpr v) :: args
+          | None -> args
+        in
+        eval_call (Lazy.force fr.call_env) fn_val raw_args
+
 and eval_binop env_ref op left right =
   (* Pipe is special: x |> f(y) becomes f(x, y), x |> f becomes f(x) *)
   match op with
@@ -3404,14 +3759,7 @@ and eval_binop env_ref op left right =
       let lval_raw = eval_expr env_ref left in
       let lval = Utils.unwrap_value lval_raw in
       (match lval with
-       | VError _ as e ->
-           (match lval_raw with
-            | VNodeResult _ ->
-                Printf.eprintf "\n\
-                  \027[1m\u{1F4A1} Tip:\027[0m `read_node()` returned a first-class error value, but `|>` short-circuits on errors.\n\
-                  \027[1m   Use `?|>` instead:\027[0m  read_node(p.node) ?|> my_function()\n%!";
-                e
-            | _ -> e)
+       | VError _ as e -> pipe_error lval_raw e
        | _ ->
          match right.node with
          | Call { fn; args } ->
@@ -3436,34 +3784,8 @@ and eval_binop env_ref op left right =
       )
 
   (* Logical (Short-circuiting) *)
-  | And ->
-      let lval = eval_expr env_ref left in
-      (match lval with
-       | VError _ as e -> e
-       | VBool false -> VBool false
-       | VBool true ->
-           let rval = eval_expr env_ref right in
-           (match rval with
-            | VError _ as e -> e
-            | VBool b -> VBool b
-            | VNA _ -> Error.na_predicate_error "Cannot use NA as a condition in &&"
-            | _ -> make_error TypeError ("Right operand of && must be Bool, got " ^ Utils.type_name rval))
-       | VNA _ -> Error.na_predicate_error "Cannot use NA as a condition in &&"
-       | _ -> make_error TypeError ("Left operand of && must be Bool, got " ^ Utils.type_name lval))
-  | Or ->
-      let lval = eval_expr env_ref left in
-      (match lval with
-       | VError _ as e -> e
-       | VBool true -> VBool true
-       | VBool false ->
-           let rval = eval_expr env_ref right in
-           (match rval with
-            | VError _ as e -> e
-            | VBool b -> VBool b
-            | VNA _ -> Error.na_predicate_error "Cannot use NA as a condition in ||"
-            | _ -> make_error TypeError ("Right operand of || must be Bool, got " ^ Utils.type_name rval))
-       | VNA _ -> Error.na_predicate_error "Cannot use NA as a condition in ||"
-       | _ -> make_error TypeError ("Left operand of || must be Bool, got " ^ Utils.type_name lval))
+  | And | Or ->
+      short_circuit op (eval_expr env_ref left) (fun () -> eval_expr env_ref right)
   (* Membership Operator *)
   | In ->
       let lval = Utils.unwrap_value (eval_expr env_ref left) in
@@ -3501,41 +3823,10 @@ and eval_binop env_ref op left right =
   | _ ->
   let lval_raw = eval_expr env_ref left in
   let rval_raw = eval_expr env_ref right in
-  let lval = Utils.unwrap_value lval_raw in
-  let rval = Utils.unwrap_value rval_raw in
-  match (op, lval, rval) with
-  | _, VError _, _ -> lval
-  | _, _, VError _ -> rval
-  | (Plus | Minus | Mul | Div | Mod | Lt | Gt | LtEq | GtEq | Eq | NEq | BitAnd | BitOr), _, _ -> 
-      (match lval, rval with
-       | VNDArray _, _ | _, VNDArray _
-       | Ast.VVector _, _ | _, Ast.VVector _
-       | Ast.VList _, _ | _, Ast.VList _ -> 
-          let op_str = match op with
-            | Plus -> "+" | Minus -> "-" | Mul -> "*" | Div -> "/" | Mod -> "%"
-            | Lt -> "<" | Gt -> ">" | LtEq -> "<=" | GtEq -> ">="
-            | Eq -> "==" | NEq -> "!="
-            | BitAnd -> "&" | BitOr -> "|"
-            | _ -> "??"
-          in
-          let dot_op = "." ^ op_str in
-          let msg = Printf.sprintf "Operator '%s' is defined for scalars only.\nUse '%s' for element-wise (broadcast) operations." op_str dot_op in
-          Error.type_error msg
-       | _ -> eval_scalar_binop op lval rval)
-  | _ -> eval_scalar_binop op lval rval
+  binop_values op lval_raw rval_raw
 
 and eval_unop env_ref op operand =
-  let v = Utils.unwrap_value (eval_expr env_ref operand) in
-  match v with VError _ as e -> e | _ ->
-  match v with
-  | VNA _ -> Error.na_predicate_error "Operation on NA: NA values do not propagate implicitly. Handle missingness explicitly."
-  | _ ->
-  match (op, v) with
-  | (Not, VBool b) -> VBool (not b)
-  | (Not, other) -> make_error TypeError (Printf.sprintf "Operand of 'not' must be Bool, got %s" (Utils.type_name other))
-  | (Neg, VInt i) -> VInt (-i)
-  | (Neg, VFloat f) -> VFloat (-.f)
-  | (Neg, other) -> make_error TypeError (Printf.sprintf "Cannot negate %s" (Utils.type_name other))
+  unop_value op (eval_expr env_ref operand)
 
 (* --- Statement & Program Evaluation --- *)
 
@@ -3689,11 +3980,22 @@ and eval_statement (env : environment) (stmt : stmt) : value * environment =
   (attach_stmt_location stmt v, env')
 
 and eval_program ?(resilient=true) (program : program) (env : environment) : value * environment =
+  (* Each top-level statement runs in its own Arrow handle arena, so the
+     tables it leaves behind are accounted for (and collected when large)
+     before the next statement starts. *)
+  let eval_in_arena env (stmt : stmt) =
+    let label = match stmt.loc with
+      | Some { file = Some f; line; _ } -> Printf.sprintf "%s:%d" f line
+      | Some { line; _ } -> Printf.sprintf "line %d" line
+      | None -> "statement"
+    in
+    Arrow_table.with_arena label (fun () -> eval_statement env stmt)
+  in
   let rec go env = function
     | [] -> ((VNA NAGeneric), env)
-    | [stmt] -> eval_statement env stmt
+    | [stmt] -> eval_in_arena env stmt
     | stmt :: rest ->
-        let (v, new_env) = eval_statement env stmt in
+        let (v, new_env) = eval_in_arena env stmt in
         (match v with
          | VError err when not resilient || err.code = StructuralError -> (v, new_env)
          | _ -> go new_env rest)
@@ -13,8 +13,27 @@
 #include <caml/custom.h>
 #include <caml/fail.h>
 #include <caml/bigarray.h>
+#include <caml/signals.h>
 #include <math.h>
 #include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <nmmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif
+
+/* Blocking sections: stubs whose work is dominated by Arrow itself (file
+   I/O, CSV/Parquet decode, sorting) release the OCaml runtime lock with
+   caml_enter_blocking_section() so other domains and threads keep running.
+   Inside such a section no OCaml value may be read, written or allocated:
+   strings and scalars are copied into C locals first, GObject pointers are
+   fine because they live outside the OCaml heap, and results are only
+   wrapped after caml_leave_blocking_section(). A table used inside a
+   section is held with g_object_ref() for its duration: entering the
+   section can run pending finalisers, which would otherwise free a handle
+   whose OCaml owner is already unreachable. */
 
 /* Arrow C Data Interface struct for creating timestamp types with
    the correct timezone string, bypassing GLib timezone resolution.
@@ -152,6 +171,27 @@ CAMLprim value caml_arrow_table_free(value v_ptr) {
   CAMLreturn(Val_unit);
 }
 
+/* Statistics of Arrow's process-wide default memory pool, which every
+   arrow-glib allocation goes through: (backend, bytes allocated, peak).
+   The backend (jemalloc, mimalloc or system) is chosen by Arrow from the
+   ARROW_DEFAULT_MEMORY_POOL environment variable on first use. */
+CAMLprim value caml_arrow_memory_pool_stats(value v_unit) {
+  CAMLparam1(v_unit);
+  CAMLlocal2(v_result, v_backend);
+  GArrowMemoryPool *pool = garrow_memory_pool_default();
+  gint64 allocated = garrow_memory_pool_get_bytes_allocated(pool);
+  gint64 peak = garrow_memory_pool_get_max_memory(pool);
+  gchar *backend = garrow_memory_pool_get_backend_name(pool);
+  v_backend = caml_copy_string(backend != NULL ? backend : "unknown");
+  g_free(backend);
+  g_object_unref(pool);
+  v_result = caml_alloc_tuple(3);
+  Store_field(v_result, 0, v_backend);
+  Store_field(v_result, 1, Val_long(allocated));
+  Store_field(v_result, 2, Val_long(peak));
+  CAMLreturn(v_result);
+}
+
 /* ===================================================================== */
 /* Table Queries                                                         */
 /* ===================================================================== */
@@ -340,13 +380,261 @@ CAMLprim value caml_arrow_table_get_list_field_schema(value v_ptr, value v_col_n
   CAMLreturn(v_some);
 }
 
+/* ===================================================================== */
+/* Dictionary Unification                                                */
+/* ===================================================================== */
+
+/* Chunks of a dictionary-encoded string column may each carry their own
+   dictionary. A DictUnifier gives every level string one code for the
+   whole column (or for both sides of a join), so group-by, joins and chunk
+   concatenation work on integer codes. Codes are assigned in order of
+   first appearance across the chunk dictionaries, which keeps the first
+   dictionary's level order. */
+typedef struct {
+  GHashTable *codes;  /* level -> code + 1; keys are owned by `levels` */
+  GPtrArray *levels;  /* code -> NUL-terminated level */
+} DictUnifier;
+
+static DictUnifier *
+dict_unifier_new(void) {
+  DictUnifier *u = g_new(DictUnifier, 1);
+  u->codes = g_hash_table_new(g_str_hash, g_str_equal);
+  u->levels = g_ptr_array_new_with_free_func(g_free);
+  return u;
+}
+
+static void
+dict_unifier_free(DictUnifier *u) {
+  if (u == NULL) return;
+  g_hash_table_destroy(u->codes);
+  g_ptr_array_free(u->levels, TRUE);
+  g_free(u);
+}
+
+/* Code of `level`, adding it as a new level when unseen. */
+static gint64
+dict_unifier_code(DictUnifier *u, const gchar *level) {
+  gpointer code = g_hash_table_lookup(u->codes, level);
+  if (code == NULL) {
+    gchar *copy = g_strdup(level);
+    g_ptr_array_add(u->levels, copy);
+    code = GSIZE_TO_POINTER((gsize)u->levels->len);
+    g_hash_table_insert(u->codes, copy, code);
+  }
+  return (gint64)GPOINTER_TO_SIZE(code) - 1;
+}
+
+/* TRUE for dictionary types whose values are strings. */
+static gboolean
+dictionary_type_is_string(GArrowDataType *dtype) {
+  if (!GARROW_IS_DICTIONARY_DATA_TYPE(dtype)) return FALSE;
+  GArrowDataType *values = garrow_dictionary_data_type_get_value_data_type(
+    GARROW_DICTIONARY_DATA_TYPE(dtype));
+  gboolean is_string = values != NULL && GARROW_IS_STRING_DATA_TYPE(values);
+  if (values) g_object_unref(values);
+  return is_string;
+}
+
+/* Unified code of every entry of one chunk's dictionary. NULL unless it
+   is a string array without nulls. */
+static gint64 *
+dict_unifier_remap(DictUnifier *u, GArrowArray *dictionary, gint64 *n_entries) {
+  if (!GARROW_IS_STRING_ARRAY(dictionary) || garrow_array_get_n_nulls(dictionary) > 0)
+    return NULL;
+  gint64 n = garrow_array_get_length(dictionary);
+  gint64 *remap = g_new(gint64, n > 0 ? n : 1);
+  for (gint64 i = 0; i < n; i++) {
+    gchar *level = garrow_string_array_get_string(GARROW_STRING_ARRAY(dictionary), i);
+    remap[i] = dict_unifier_code(u, level ? level : "");
+    g_free(level);
+  }
+  *n_entries = n;
+  return remap;
+}
+
+#define DICT_COPY_INDICES(ARRAY_T, CAST, GETTER)                            \
+  do {                                                                      \
+    gint64 n_vals = 0;                                                      \
+    const ARRAY_T *vals = GETTER(CAST(indices), &n_vals);                   \
+    ok = (vals != NULL || len == 0) && n_vals >= len;                       \
+    for (gint64 i = 0; ok && i < len; i++) out[i] = (gint64)vals[i];        \
+  } while (0)
+
+/* Copy the first `len` indices of a dictionary chunk to out. FALSE for an
+   unsupported index type. Null rows hold arbitrary indices. */
+static gboolean
+dict_chunk_indices(GArrowArray *chunk, gint64 len, gint64 *out) {
+  GArrowArray *indices = garrow_dictionary_array_get_indices(GARROW_DICTIONARY_ARRAY(chunk));
+  if (indices == NULL) return FALSE;
+  gboolean ok = FALSE;
+  if (GARROW_IS_INT32_ARRAY(indices))
+    DICT_COPY_INDICES(gint32, GARROW_INT32_ARRAY, garrow_int32_array_get_values);
+  else if (GARROW_IS_INT8_ARRAY(indices))
+    DICT_COPY_INDICES(gint8, GARROW_INT8_ARRAY, garrow_int8_array_get_values);
+  else if (GARROW_IS_INT16_ARRAY(indices))
+    DICT_COPY_INDICES(gint16, GARROW_INT16_ARRAY, garrow_int16_array_get_values);
+  else if (GARROW_IS_INT64_ARRAY(indices))
+    DICT_COPY_INDICES(gint64, GARROW_INT64_ARRAY, garrow_int64_array_get_values);
+  g_object_unref(indices);
+  return ok;
+}
+
+#undef DICT_COPY_INDICES
+
+/* Write the unified code of every row of a dictionary chunk to codes, -1
+   for null rows. FALSE for a non-string dictionary, an unsupported index
+   type or an index outside the chunk's dictionary. */
+static gboolean
+dict_chunk_codes(DictUnifier *u, GArrowArray *chunk, gint64 *codes) {
+  GArrowArray *dictionary = garrow_dictionary_array_get_dictionary(GARROW_DICTIONARY_ARRAY(chunk));
+  gint64 n_entries = 0;
+  gint64 *remap = dictionary ? dict_unifier_remap(u, dictionary, &n_entries) : NULL;
+  if (dictionary) g_object_unref(dictionary);
+  if (remap == NULL) return FALSE;
+
+  gint64 len = garrow_array_get_length(chunk);
+  gboolean has_nulls = garrow_array_get_n_nulls(chunk) > 0;
+  gboolean ok = dict_chunk_indices(chunk, len, codes);
+  for (gint64 i = 0; ok && i < len; i++) {
+    if (has_nulls && garrow_array_is_null(chunk, i)) codes[i] = -1;
+    else if (codes[i] < 0 || codes[i] >= n_entries) ok = FALSE;
+    else codes[i] = remap[codes[i]];
+  }
+  g_free(remap);
+  return ok;
+}
+
+/* Dictionary array with int32 indices over the unifier's levels; codes of
+   -1 are null. */
+static GArrowArray *
+dict_unifier_build_array(const DictUnifier *u, const gint64 *codes, gint64 n,
+                         gboolean ordered, GError **error) {
+  GArrowStringArrayBuilder *level_builder = garrow_string_array_builder_new();
+  gboolean ok = TRUE;
+  for (guint i = 0; ok && i < u->levels->len; i++)
+    ok = garrow_string_array_builder_append_string(
+      level_builder, (const gchar *)g_ptr_array_index(u->levels, i), error);
+  GArrowArray *levels = ok
+    ? garrow_array_builder_finish(GARROW_ARRAY_BUILDER(level_builder), error) : NULL;
+  g_object_unref(level_builder);
+  if (levels == NULL) return NULL;
+
+  gint32 *idx = g_new(gint32, n > 0 ? n : 1);
+  gboolean *valid = g_new(gboolean, n > 0 ? n : 1);
+  for (gint64 i = 0; i < n; i++) {
+    valid[i] = codes[i] >= 0;
+    idx[i] = valid[i] ? (gint32)codes[i] : 0;
+  }
+  GArrowInt32ArrayBuilder *idx_builder = garrow_int32_array_builder_new();
+  GArrowArray *indices = NULL;
+  if (garrow_int32_array_builder_append_values(idx_builder, idx, n, valid, n, error))
+    indices = garrow_array_builder_finish(GARROW_ARRAY_BUILDER(idx_builder), error);
+  g_object_unref(idx_builder);
+  g_free(idx);
+  g_free(valid);
+
+  GArrowArray *result = NULL;
+  if (indices != NULL) {
+    GArrowDataType *idx_dtype = (GArrowDataType *)garrow_int32_data_type_new();
+    GArrowDataType *val_dtype = (GArrowDataType *)garrow_string_data_type_new();
+    GArrowDataType *dtype =
+      (GArrowDataType *)garrow_dictionary_data_type_new(idx_dtype, val_dtype, ordered);
+    result = (GArrowArray *)garrow_dictionary_array_new(dtype, indices, levels, error);
+    g_object_unref(dtype);
+    g_object_unref(val_dtype);
+    g_object_unref(idx_dtype);
+    g_object_unref(indices);
+  }
+  g_object_unref(levels);
+  return result;
+}
+
+/* Combine the chunks of a dictionary-encoded string column into one
+   dictionary array over the union of their dictionaries. Arrow's own
+   concatenation refuses chunks whose dictionaries differ. */
+static GArrowArray *
+dictionary_chunks_combine(GArrowChunkedArray *chunked, gboolean ordered) {
+  gint64 n = garrow_chunked_array_get_n_rows(chunked);
+  gint64 *codes = g_new(gint64, n > 0 ? n : 1);
+  DictUnifier *u = dict_unifier_new();
+  gboolean ok = TRUE;
+  gint64 row = 0;
+  guint n_chunks = garrow_chunked_array_get_n_chunks(chunked);
+  for (guint c = 0; c < n_chunks && ok; c++) {
+    GArrowArray *chunk = garrow_chunked_array_get_chunk(chunked, c);
+    if (chunk == NULL) { ok = FALSE; break; }
+    gint64 len = garrow_array_get_length(chunk);
+    ok = row + len <= n && GARROW_IS_DICTIONARY_ARRAY(chunk) &&
+         dict_chunk_codes(u, chunk, codes + row);
+    row += len;
+    g_object_unref(chunk);
+  }
+
+  GArrowArray *combined = NULL;
+  if (ok && row == n) {
+    GError *error = NULL;
+    combined = dict_unifier_build_array(u, codes, n, ordered, &error);
+    if (error) g_error_free(error);
+  }
+  dict_unifier_free(u);
+  g_free(codes);
+  return combined;
+}
+
+/* Key column of a grouped result for a dictionary-encoded string key: the
+   group key strings (NULL for NA) re-encoded over the source column's
+   levels, so the key keeps its factor type and level order. */
+static GArrowChunkedArray *
+dictionary_key_column(GArrowTable *table, gint col_idx, GArrowDataType *dtype,
+                      gchar ***key_values, int k, int n_groups) {
+  GArrowChunkedArray *source = garrow_table_get_column_data(table, col_idx);
+  if (source == NULL) return NULL;
+  DictUnifier *u = dict_unifier_new();
+  gboolean ok = TRUE;
+  guint n_chunks = garrow_chunked_array_get_n_chunks(source);
+  for (guint c = 0; c < n_chunks && ok; c++) {
+    GArrowArray *chunk = garrow_chunked_array_get_chunk(source, c);
+    GArrowArray *dictionary = chunk && GARROW_IS_DICTIONARY_ARRAY(chunk)
+      ? garrow_dictionary_array_get_dictionary(GARROW_DICTIONARY_ARRAY(chunk)) : NULL;
+    gint64 n_entries = 0;
+    gint64 *remap = dictionary ? dict_unifier_remap(u, dictionary, &n_entries) : NULL;
+    ok = remap != NULL;
+    g_free(remap);
+    if (dictionary) g_object_unref(dictionary);
+    if (chunk) g_object_unref(chunk);
+  }
+  g_object_unref(source);
+
+  GArrowChunkedArray *column = NULL;
+  if (ok) {
+    gint64 *codes = g_new(gint64, n_groups > 0 ? n_groups : 1);
+    for (int g = 0; g < n_groups; g++)
+      codes[g] = key_values[g][k] ? dict_unifier_code(u, key_values[g][k]) : -1;
+    GError *error = NULL;
+    GArrowArray *arr = dict_unifier_build_array(
+      u, codes, n_groups,
+      garrow_dictionary_data_type_is_ordered(GARROW_DICTIONARY_DATA_TYPE(dtype)), &error);
+    g_free(codes);
+    if (arr != NULL) {
+      GList *chunks = g_list_append(NULL, arr);
+      column = garrow_chunked_array_new(chunks, &error);
+      g_list_free(chunks);
+      g_object_unref(arr);
+    }
+    if (error) g_error_free(error);
+  }
+  dict_unifier_free(u);
+  return column;
+}
+
 /* ===================================================================== */
 /* Column Data Extraction                                                */
 /* ===================================================================== */
 
 /* Get a column's combined array pointer by name.
    For multi-chunk columns, combines all chunks into a single contiguous
-   array so that column reading functions receive complete data.
+   array so that column reading functions receive complete data; chunks of
+   a dictionary-encoded string column are re-encoded over one dictionary.
    Returns Some(nativeint) or None. */
 CAMLprim value caml_arrow_table_get_column_data_by_name(value v_ptr, value v_col_name) {
   CAMLparam2(v_ptr, v_col_name);
@@ -385,7 +673,13 @@ CAMLprim value caml_arrow_table_get_column_data_by_name(value v_ptr, value v_col
     if (array) g_object_ref(array);
   } else {
     GError *error = NULL;
-    GArrowArray *combined = garrow_chunked_array_combine(chunked, &error);
+    GArrowDataType *dtype = garrow_chunked_array_get_value_data_type(chunked);
+    GArrowArray *combined = NULL;
+    if (dictionary_type_is_string(dtype))
+      combined = dictionary_chunks_combine(
+        chunked, garrow_dictionary_data_type_is_ordered(GARROW_DICTIONARY_DATA_TYPE(dtype)));
+    g_object_unref(dtype);
+    if (combined == NULL) combined = garrow_chunked_array_combine(chunked, &error);
     if (combined != NULL) {
       array = combined;
     } else {
@@ -947,21 +1241,41 @@ CAMLprim value caml_arrow_unref(value v_ptr) {
 /* CSV Reading                                                           */
 /* ===================================================================== */
 
-/* Read CSV file using Arrow CSV reader */
-CAMLprim value caml_arrow_read_csv(value v_path) {
-  CAMLparam1(v_path);
-  CAMLlocal1(v_result);
+/* Reader settings beyond the defaults, copied out of the OCaml heap so the
+   parse can run without the runtime lock. Column type codes:
+   0=int64, 1=float64, 2=boolean, 3=utf8, 4=date32, 5=timestamp[us, UTC]. */
+typedef struct {
+  gboolean use_threads;
+  gint block_size;        /* 0 keeps Arrow's default */
+  guint skip_rows;
+  gchar delimiter;
+  int n_types;
+  gchar **type_names;
+  int *type_codes;
+} CsvReadSettings;
+
+static GArrowDataType *csv_column_data_type(int code) {
+  switch (code) {
+    case 0: return GARROW_DATA_TYPE(garrow_int64_data_type_new());
+    case 1: return GARROW_DATA_TYPE(garrow_double_data_type_new());
+    case 2: return GARROW_DATA_TYPE(garrow_boolean_data_type_new());
+    case 3: return GARROW_DATA_TYPE(garrow_string_data_type_new());
+    case 4: return GARROW_DATA_TYPE(garrow_date32_data_type_new());
+    case 5: return create_timestamp_data_type_with_tz_string(GARROW_TIME_UNIT_MICRO, "UTC");
+    default: return NULL;
+  }
+}
 
-  const char *path = String_val(v_path);
-  GError *error = NULL;
+/* Parse [path] with the Arrow CSV reader. [settings] may be NULL for the
+   defaults. Must be called with the runtime lock released. */
+static GArrowTable *read_csv_table(const gchar *path, const CsvReadSettings *settings,
+                                   GError **error) {
+  GArrowTable *table = NULL;
 
   /* Open input file */
   GArrowMemoryMappedInputStream *input =
-    garrow_memory_mapped_input_stream_new(path, &error);
-  if (input == NULL) {
-    if (error) g_error_free(error);
-    CAMLreturn(Val_none);
-  }
+    garrow_memory_mapped_input_stream_new(path, error);
+  if (input == NULL) return NULL;
 
   /* Create CSV read options with custom NULL values (NA, na, N/A, "") */
   GArrowCSVReadOptions *options = garrow_csv_read_options_new();
@@ -969,28 +1283,43 @@ CAMLprim value caml_arrow_read_csv(value v_path) {
     const gchar *null_values[] = {"NA", "na", "N/A", ""};
     garrow_csv_read_options_set_null_values(options, null_values, 4);
     g_object_set(options, "allow-null-strings", TRUE, NULL);
+    if (settings) {
+      g_object_set(options,
+                   "use-threads", settings->use_threads,
+                   "n-skip-rows", settings->skip_rows,
+                   "delimiter", settings->delimiter,
+                   NULL);
+      if (settings->block_size > 0)
+        g_object_set(options, "block-size", settings->block_size, NULL);
+      /* Declared types are used for every block instead of inferring them
+         from the first one. */
+      for (int i = 0; i < settings->n_types; i++) {
+        GArrowDataType *type = csv_column_data_type(settings->type_codes[i]);
+        if (type == NULL) continue;
+        garrow_csv_read_options_add_column_type(options, settings->type_names[i], type);
+        g_object_unref(type);
+      }
+    }
   }
 
   /* Create CSV reader */
   GArrowCSVReader *reader =
-    garrow_csv_reader_new(GARROW_INPUT_STREAM(input), options, &error);
+    garrow_csv_reader_new(GARROW_INPUT_STREAM(input), options, error);
   if (options) g_object_unref(options);
 
-  if (reader == NULL) {
-    g_object_unref(input);
-    if (error) g_error_free(error);
-    CAMLreturn(Val_none);
-  }
-
   /* Read table */
-  GArrowTable *table = garrow_csv_reader_read(reader, &error);
-  g_object_unref(reader);
+  if (reader != NULL) {
+    table = garrow_csv_reader_read(reader, error);
+    g_object_unref(reader);
+  }
   g_object_unref(input);
+  return table;
+}
 
-  if (table == NULL) {
-    if (error) g_error_free(error);
-    CAMLreturn(Val_none);
-  }
+static value csv_table_result(GArrowTable *table) {
+  CAMLparam0();
+  CAMLlocal1(v_result);
+  if (table == NULL) CAMLreturn(Val_none);
 
   /* Wrap as Some(nativeint) */
   v_result = caml_alloc(1, 0);  /* Some(...) */
@@ -998,28 +1327,99 @@ CAMLprim value caml_arrow_read_csv(value v_path) {
   CAMLreturn(v_result);
 }
 
-/* Read Parquet file using parquet-glib Arrow reader */
+/* Ok(table) or Error(message) for readers that report why they failed. */
+static value csv_read_result(GArrowTable *table, const GError *error) {
+  CAMLparam0();
+  CAMLlocal2(v_result, v_msg);
+  if (table != NULL) {
+    v_result = caml_alloc(1, 0);  /* Ok(...) */
+    Store_field(v_result, 0, caml_copy_nativeint((intnat)table));
+  } else {
+    v_msg = caml_copy_string(error != NULL ? error->message : "unknown error");
+    v_result = caml_alloc(1, 1);  /* Error(...) */
+    Store_field(v_result, 0, v_msg);
+  }
+  CAMLreturn(v_result);
+}
+
+/* Read CSV file using Arrow CSV reader.
+   The parse runs with the OCaml runtime lock released (see the note on
+   blocking sections above), so the path is copied out of the OCaml heap
+   before the section starts. */
+CAMLprim value caml_arrow_read_csv(value v_path) {
+  CAMLparam1(v_path);
+
+  gchar *path = g_strdup(String_val(v_path));
+  GError *error = NULL;
+
+  caml_enter_blocking_section();
+  GArrowTable *table = read_csv_table(path, NULL, &error);
+  caml_leave_blocking_section();
+
+  g_free(path);
+  if (error) g_error_free(error);
+  CAMLreturn(csv_table_result(table));
+}
+
+/* Read CSV file with explicit reader settings.
+   v_opts is { use_threads : bool; block_size : int; skip_rows : int;
+               delimiter : char; column_types : (string * int) array }.
+   Returns Ok(table) or Error(message); the caller decides how to report. */
+CAMLprim value caml_arrow_read_csv_with_options(value v_path, value v_opts) {
+  CAMLparam2(v_path, v_opts);
+
+  gchar *path = g_strdup(String_val(v_path));
+  value v_types = Field(v_opts, 4);
+  CsvReadSettings settings = {
+    .use_threads = Bool_val(Field(v_opts, 0)),
+    .block_size = (gint)Long_val(Field(v_opts, 1)),
+    .skip_rows = (guint)Long_val(Field(v_opts, 2)),
+    .delimiter = (gchar)Int_val(Field(v_opts, 3)),
+    .n_types = (int)Wosize_val(v_types),
+  };
+  settings.type_names = g_new0(gchar *, settings.n_types + 1);
+  settings.type_codes = g_new0(int, settings.n_types + 1);
+  for (int i = 0; i < settings.n_types; i++) {
+    value v_entry = Field(v_types, i);
+    settings.type_names[i] = g_strdup(String_val(Field(v_entry, 0)));
+    settings.type_codes[i] = Int_val(Field(v_entry, 1));
+  }
+  GError *error = NULL;
+
+  caml_enter_blocking_section();
+  GArrowTable *table = read_csv_table(path, &settings, &error);
+  caml_leave_blocking_section();
+
+  g_strfreev(settings.type_names);
+  g_free(settings.type_codes);
+  g_free(path);
+  value v_result = csv_read_result(table, error);
+  if (error) g_error_free(error);
+  CAMLreturn(v_result);
+}
+
+/* Read Parquet file using parquet-glib Arrow reader.
+   Decoding runs outside the OCaml runtime lock. */
 CAMLprim value caml_arrow_read_parquet(value v_path) {
   CAMLparam1(v_path);
   CAMLlocal1(v_result);
 
-  const char *path = String_val(v_path);
+  gchar *path = g_strdup(String_val(v_path));
   GError *error = NULL;
+  GArrowTable *table = NULL;
 
+  caml_enter_blocking_section();
   GParquetArrowFileReader *reader =
     gparquet_arrow_file_reader_new_path(path, &error);
-  if (reader == NULL) {
-    if (error) g_error_free(error);
-    CAMLreturn(Val_none);
+  if (reader != NULL) {
+    table = gparquet_arrow_file_reader_read_table(reader, &error);
+    g_object_unref(reader);
   }
+  caml_leave_blocking_section();
 
-  GArrowTable *table = gparquet_arrow_file_reader_read_table(reader, &error);
-  g_object_unref(reader);
-
-  if (table == NULL) {
-    if (error) g_error_free(error);
-    CAMLreturn(Val_none);
-  }
+  g_free(path);
+  if (error) g_error_free(error);
+  if (table == NULL) CAMLreturn(Val_none);
 
   v_result = caml_alloc(1, 0);  /* Some(...) */
   Store_field(v_result, 0, caml_copy_nativeint((intnat)table));
@@ -1103,6 +1503,31 @@ CAMLprim value caml_arrow_table_project(value v_ptr, value v_names) {
 /* Filter (Take with boolean mask)                                       */
 /* ===================================================================== */
 
+/* Filter `table` with a packed keep bitmap (bit i in word i / 64). The
+   words are wrapped as the values buffer of an Arrow boolean array without
+   copying; Arrow bitmaps are little-endian, so big-endian hosts copy them.
+   Touches no OCaml values. */
+static GArrowTable *
+filter_table_by_bitmap(GArrowTable *table, const guint64 *words, gint64 length,
+                       GError **error) {
+  gint64 n_words = (length + 63) / 64;
+  const guint64 *le_words = words;
+#if G_BYTE_ORDER == G_BIG_ENDIAN
+  guint64 *swapped = g_new(guint64, n_words > 0 ? n_words : 1);
+  for (gint64 w = 0; w < n_words; w++) swapped[w] = GUINT64_TO_LE(words[w]);
+  le_words = swapped;
+#endif
+  GArrowBuffer *data = garrow_buffer_new((const guint8 *)le_words, n_words * 8);
+  GArrowBooleanArray *mask = garrow_boolean_array_new(length, data, NULL, 0);
+  GArrowTable *result = garrow_table_filter(table, mask, NULL, error);
+  g_object_unref(mask);
+  g_object_unref(data);
+#if G_BYTE_ORDER == G_BIG_ENDIAN
+  g_free(swapped);
+#endif
+  return result;
+}
+
 /* Filter rows using a boolean array */
 CAMLprim value caml_arrow_table_filter_mask(value v_ptr, value v_mask) {
   CAMLparam2(v_ptr, v_mask);
@@ -1112,33 +1537,24 @@ CAMLprim value caml_arrow_table_filter_mask(value v_ptr, value v_mask) {
   if (!Is_block(v_mask)) {
     CAMLreturn(Val_none);
   }
-  int n = Wosize_val(v_mask);
-
-  /* Build boolean array from OCaml bool array */
-  GArrowBooleanArrayBuilder *builder = garrow_boolean_array_builder_new();
-  GError *error = NULL;
-
-  for (int i = 0; i < n; i++) {
-    gboolean mask_val = Bool_val(Field(v_mask, i));
-    garrow_boolean_array_builder_append_value(builder, mask_val, &error);
-    if (error) {
-      g_object_unref(builder);
-      g_error_free(error);
-      CAMLreturn(Val_none);
-    }
-  }
+  gint64 n = Wosize_val(v_mask);
 
-  GArrowArray *mask_array = garrow_array_builder_finish(GARROW_ARRAY_BUILDER(builder), &error);
-  g_object_unref(builder);
-
-  if (mask_array == NULL) {
-    if (error) g_error_free(error);
-    CAMLreturn(Val_none);
+  /* Pack the OCaml bool array into a bitmap while holding the runtime
+     lock; the filter itself then runs outside it. */
+  gint64 n_words = (n + 63) / 64;
+  guint64 *words = g_new0(guint64, n_words > 0 ? n_words : 1);
+  for (gint64 i = 0; i < n; i++) {
+    if (Bool_val(Field(v_mask, i)))
+      words[i >> 6] |= G_GUINT64_CONSTANT(1) << (i & 63);
   }
 
-  /* Apply filter - cast to GArrowBooleanArray as required by the API */
-  GArrowTable *result = garrow_table_filter(table, GARROW_BOOLEAN_ARRAY(mask_array), NULL, &error);
-  g_object_unref(mask_array);
+  GError *error = NULL;
+  g_object_ref(table);
+  caml_enter_blocking_section();
+  GArrowTable *result = filter_table_by_bitmap(table, words, n, &error);
+  caml_leave_blocking_section();
+  g_object_unref(table);
+  g_free(words);
 
   if (result == NULL) {
     if (error) g_error_free(error);
@@ -1150,76 +1566,540 @@ CAMLprim value caml_arrow_table_filter_mask(value v_ptr, value v_mask) {
   CAMLreturn(v_result);
 }
 
-/* Slice a table: offset, length.
-   Returns Some(new_table_ptr) or None. */
-CAMLprim value caml_arrow_table_slice(value v_ptr, value v_offset, value v_len) {
-  CAMLparam3(v_ptr, v_offset, v_len);
-  CAMLlocal1(v_result);
+/* ===================================================================== */
+/* Native Predicate Masks                                                */
+/* ===================================================================== */
 
-  GArrowTable *table = (GArrowTable *)Nativeint_val(v_ptr);
-  gint64 offset = Int64_val(v_offset);
-  gint64 len = Int64_val(v_len);
+/* Result of a vectorised filter predicate, kept in native memory so that
+   compound predicates combine a word at a time and the final mask reaches
+   Arrow's filter kernel without a round trip through an OCaml bool array.
+   `keep` marks rows where the predicate is true and `na` rows where it is
+   NA (never both); bit i lives in word i / 64 and bits past `length` are
+   zero. The masks are plain C memory, so every operation on them can run
+   outside the OCaml runtime lock. */
+typedef struct {
+  gint64 length;
+  gint64 n_words;
+  guint64 *keep;
+  guint64 *na;
+} PredicateMask;
+
+#define MASK_BIT(i) (G_GUINT64_CONSTANT(1) << ((i) & 63))
+
+static PredicateMask *
+predicate_mask_new(gint64 length) {
+  PredicateMask *m = g_new(PredicateMask, 1);
+  m->length = length;
+  m->n_words = (length + 63) / 64;
+  m->keep = g_new0(guint64, m->n_words > 0 ? m->n_words : 1);
+  m->na = g_new0(guint64, m->n_words > 0 ? m->n_words : 1);
+  return m;
+}
 
-  GArrowTable *result = garrow_table_slice(table, offset, len);
-  if (result == NULL) CAMLreturn(Val_none);
+static void
+predicate_mask_free(PredicateMask *m) {
+  if (m == NULL) return;
+  g_free(m->keep);
+  g_free(m->na);
+  g_free(m);
+}
 
-  v_result = caml_alloc(1, 0);
-  Store_field(v_result, 0, caml_copy_nativeint((intnat)result));
-  CAMLreturn(v_result);
+/* Mark the null rows of `chunk`, which starts at mask row `row`, as NA. */
+static void
+predicate_mask_mark_nulls(PredicateMask *m, GArrowArray *chunk, gint64 row, gint64 len) {
+  if (garrow_array_get_n_nulls(chunk) == 0) return;
+  GArrowBuffer *bitmap = garrow_array_get_null_bitmap(chunk);
+  GBytes *bytes = bitmap ? garrow_buffer_get_data(bitmap) : NULL;
+  const guint8 *bits = bytes ? (const guint8 *)g_bytes_get_data(bytes, NULL) : NULL;
+  gint64 off = garrow_array_get_offset(chunk);
+  for (gint64 i = 0; i < len; i++) {
+    gboolean is_null = bits
+      ? !((bits[(off + i) >> 3] >> ((off + i) & 7)) & 1)
+      : garrow_array_is_null(chunk, i);
+    if (is_null) {
+      gint64 r = row + i;
+      m->na[r >> 6] |= MASK_BIT(r);
+      m->keep[r >> 6] &= ~MASK_BIT(r);
+    }
+  }
+  if (bytes) g_bytes_unref(bytes);
+  if (bitmap) g_object_unref(bitmap);
 }
 
-/* Take rows from a table by indices. 
-   indices is an OCaml int array.
-   Returns Some(new_table_ptr) or None. */
-CAMLprim value caml_arrow_table_take(value v_ptr, value v_indices) {
-  CAMLparam2(v_ptr, v_indices);
-  CAMLlocal1(v_result);
+#define MASK_COMPARE_LOOP(OP)                                              \
+  for (gint64 i = 0; i < len; i++)                                         \
+    if ((gdouble)vals[i] OP scalar) m->keep[(row + i) >> 6] |= MASK_BIT(row + i)
+
+#define MASK_COMPARE_VALUES(ARRAY_T, CAST, GETTER)                         \
+  do {                                                                     \
+    gint64 n_vals = 0;                                                     \
+    const ARRAY_T *vals = GETTER(CAST(chunk), &n_vals);                    \
+    if ((vals == NULL && len > 0) || n_vals < len) { ok = FALSE; break; }  \
+    switch (op_code) {                                                     \
+    case 0: MASK_COMPARE_LOOP(==); break;                                  \
+    case 1: MASK_COMPARE_LOOP(<); break;                                   \
+    case 2: MASK_COMPARE_LOOP(>); break;                                   \
+    case 3: MASK_COMPARE_LOOP(<=); break;                                  \
+    case 4: MASK_COMPARE_LOOP(>=); break;                                  \
+    default: ok = FALSE; break;                                            \
+    }                                                                      \
+  } while (0)
+
+/* <column> <op> <scalar> over a numeric column; NULL rows are NA. Returns
+   NULL for a missing or non-numeric column. */
+static PredicateMask *
+predicate_mask_compare(GArrowTable *table, const gchar *col_name,
+                       gdouble scalar, int op_code) {
+  GArrowSchema *schema = garrow_table_get_schema(table);
+  gint idx = garrow_schema_get_field_index(schema, col_name);
+  g_object_unref(schema);
+  if (idx < 0) return NULL;
+  GArrowChunkedArray *col = garrow_table_get_column_data(table, idx);
+  if (col == NULL) return NULL;
 
-  GArrowTable *table = (GArrowTable *)Nativeint_val(v_ptr);
-  int n = Wosize_val(v_indices);
+  PredicateMask *m = predicate_mask_new(garrow_table_get_n_rows(table));
+  gboolean ok = TRUE;
+  gint64 row = 0;
+  guint n_chunks = garrow_chunked_array_get_n_chunks(col);
+  for (guint c = 0; c < n_chunks && ok; c++) {
+    GArrowArray *chunk = garrow_chunked_array_get_chunk(col, c);
+    gint64 len = garrow_array_get_length(chunk);
+    if (row + len > m->length) ok = FALSE;
+    else if (GARROW_IS_DOUBLE_ARRAY(chunk))
+      MASK_COMPARE_VALUES(gdouble, GARROW_DOUBLE_ARRAY, garrow_double_array_get_values);
+    else if (GARROW_IS_INT64_ARRAY(chunk))
+      MASK_COMPARE_VALUES(gint64, GARROW_INT64_ARRAY, garrow_int64_array_get_values);
+    else if (GARROW_IS_INT32_ARRAY(chunk))
+      MASK_COMPARE_VALUES(gint32, GARROW_INT32_ARRAY, garrow_int32_array_get_values);
+    else if (GARROW_IS_INT16_ARRAY(chunk))
+      MASK_COMPARE_VALUES(gint16, GARROW_INT16_ARRAY, garrow_int16_array_get_values);
+    else if (GARROW_IS_INT8_ARRAY(chunk))
+      MASK_COMPARE_VALUES(gint8, GARROW_INT8_ARRAY, garrow_int8_array_get_values);
+    else if (GARROW_IS_UINT64_ARRAY(chunk))
+      MASK_COMPARE_VALUES(guint64, GARROW_UINT64_ARRAY, garrow_uint64_array_get_values);
+    else if (GARROW_IS_UINT32_ARRAY(chunk))
+      MASK_COMPARE_VALUES(guint32, GARROW_UINT32_ARRAY, garrow_uint32_array_get_values);
+    else if (GARROW_IS_UINT16_ARRAY(chunk))
+      MASK_COMPARE_VALUES(guint16, GARROW_UINT16_ARRAY, garrow_uint16_array_get_values);
+    else if (GARROW_IS_UINT8_ARRAY(chunk))
+      MASK_COMPARE_VALUES(guint8, GARROW_UINT8_ARRAY, garrow_uint8_array_get_values);
+    else if (GARROW_IS_FLOAT_ARRAY(chunk))
+      MASK_COMPARE_VALUES(gfloat, GARROW_FLOAT_ARRAY, garrow_float_array_get_values);
+    else
+      ok = FALSE;
+    if (ok) predicate_mask_mark_nulls(m, chunk, row, len);
+    row += len;
+    g_object_unref(chunk);
+  }
+  g_object_unref(col);
 
-  GArrowInt64ArrayBuilder *builder = garrow_int64_array_builder_new();
-  GError *error = NULL;
+  if (!ok || row != m->length) {
+    predicate_mask_free(m);
+    return NULL;
+  }
+  return m;
+}
 
-  for (int i = 0; i < n; i++) {
-    gint64 idx = Long_val(Field(v_indices, i));
-    garrow_int64_array_builder_append_value(builder, idx, &error);
-    if (error) {
-      g_object_unref(builder);
-      g_error_free(error);
-      CAMLreturn(Val_none);
+#undef MASK_COMPARE_VALUES
+#undef MASK_COMPARE_LOOP
+
+/* Set keep for the rows of a string chunk equal to s. */
+static gboolean
+mask_equal_string_chunk(PredicateMask *m, GArrowArray *chunk, gint64 row, gint64 len,
+                        const gchar *s, gsize s_len) {
+  GArrowBinaryArray *bin = GARROW_BINARY_ARRAY(chunk);
+  GArrowBuffer *offsets_buf = garrow_binary_array_get_offsets_buffer(bin);
+  GArrowBuffer *data_buf = garrow_binary_array_get_data_buffer(bin);
+  GBytes *offsets_bytes = offsets_buf ? garrow_buffer_get_data(offsets_buf) : NULL;
+  GBytes *data_bytes = data_buf ? garrow_buffer_get_data(data_buf) : NULL;
+  gsize offsets_size = 0;
+  const gint32 *offsets = offsets_bytes
+    ? (const gint32 *)g_bytes_get_data(offsets_bytes, &offsets_size) : NULL;
+  const gchar *data = data_bytes ? (const gchar *)g_bytes_get_data(data_bytes, NULL) : NULL;
+  gint64 base = garrow_array_get_offset(chunk);
+  gboolean ok = offsets != NULL &&
+                (gsize)(base + len + 1) * sizeof(gint32) <= offsets_size;
+  for (gint64 i = 0; ok && i < len; i++) {
+    gint32 start = offsets[base + i];
+    if ((gsize)(offsets[base + i + 1] - start) == s_len &&
+        (s_len == 0 || (data && memcmp(data + start, s, s_len) == 0)))
+      m->keep[(row + i) >> 6] |= MASK_BIT(row + i);
+  }
+  if (data_bytes) g_bytes_unref(data_bytes);
+  if (offsets_bytes) g_bytes_unref(offsets_bytes);
+  if (data_buf) g_object_unref(data_buf);
+  if (offsets_buf) g_object_unref(offsets_buf);
+  return ok;
+}
+
+/* Set keep for the rows of a dictionary chunk equal to s. The literal is
+   looked up in the chunk's dictionary once; rows compare indices only. */
+static gboolean
+mask_equal_dictionary_chunk(PredicateMask *m, GArrowArray *chunk, gint64 row, gint64 len,
+                            const gchar *s, gsize s_len) {
+  GArrowArray *dictionary = garrow_dictionary_array_get_dictionary(GARROW_DICTIONARY_ARRAY(chunk));
+  if (dictionary == NULL) return FALSE;
+  if (!GARROW_IS_STRING_ARRAY(dictionary)) {
+    g_object_unref(dictionary);
+    return FALSE;
+  }
+  gint64 n_entries = garrow_array_get_length(dictionary);
+  guint8 *hit = g_new0(guint8, n_entries > 0 ? n_entries : 1);
+  gboolean any = FALSE;
+  for (gint64 e = 0; e < n_entries; e++) {
+    if (garrow_array_is_null(dictionary, e)) continue;
+    GBytes *level = garrow_binary_array_get_value(GARROW_BINARY_ARRAY(dictionary), e);
+    gsize level_len = 0;
+    const gchar *level_data = level ? (const gchar *)g_bytes_get_data(level, &level_len) : NULL;
+    if (level_len == s_len && (s_len == 0 || memcmp(level_data, s, s_len) == 0)) {
+      hit[e] = 1;
+      any = TRUE;
     }
+    if (level) g_bytes_unref(level);
   }
+  g_object_unref(dictionary);
 
-  GArrowArray *indices_array = garrow_array_builder_finish(GARROW_ARRAY_BUILDER(builder), &error);
-  g_object_unref(builder);
+  gboolean ok = TRUE;
+  if (any) {
+    gint64 *idx = g_new(gint64, len > 0 ? len : 1);
+    ok = dict_chunk_indices(chunk, len, idx);
+    for (gint64 i = 0; ok && i < len; i++)
+      if (idx[i] >= 0 && idx[i] < n_entries && hit[idx[i]])
+        m->keep[(row + i) >> 6] |= MASK_BIT(row + i);
+    g_free(idx);
+  }
+  g_free(hit);
+  return ok;
+}
 
-  if (indices_array == NULL) {
-    if (error) g_error_free(error);
-    CAMLreturn(Val_none);
+/* <column> == <string> over a string or dictionary-encoded string column;
+   NULL rows are NA. Returns NULL for a missing column of another type. */
+static PredicateMask *
+predicate_mask_equal_string(GArrowTable *table, const gchar *col_name,
+                            const gchar *s, gsize s_len) {
+  GArrowSchema *schema = garrow_table_get_schema(table);
+  gint idx = garrow_schema_get_field_index(schema, col_name);
+  g_object_unref(schema);
+  if (idx < 0) return NULL;
+  GArrowChunkedArray *col = garrow_table_get_column_data(table, idx);
+  if (col == NULL) return NULL;
+
+  PredicateMask *m = predicate_mask_new(garrow_table_get_n_rows(table));
+  gboolean ok = TRUE;
+  gint64 row = 0;
+  guint n_chunks = garrow_chunked_array_get_n_chunks(col);
+  for (guint c = 0; c < n_chunks && ok; c++) {
+    GArrowArray *chunk = garrow_chunked_array_get_chunk(col, c);
+    gint64 len = garrow_array_get_length(chunk);
+    if (row + len > m->length) ok = FALSE;
+    else if (GARROW_IS_DICTIONARY_ARRAY(chunk))
+      ok = mask_equal_dictionary_chunk(m, chunk, row, len, s, s_len);
+    else if (GARROW_IS_STRING_ARRAY(chunk))
+      ok = mask_equal_string_chunk(m, chunk, row, len, s, s_len);
+    else
+      ok = FALSE;
+    if (ok) predicate_mask_mark_nulls(m, chunk, row, len);
+    row += len;
+    g_object_unref(chunk);
   }
+  g_object_unref(col);
 
-  GArrowTable *result = garrow_table_take(table, indices_array, NULL, &error);
-  g_object_unref(indices_array);
+  if (!ok || row != m->length) {
+    predicate_mask_free(m);
+    return NULL;
+  }
+  return m;
+}
 
-  if (result == NULL) {
-    if (error) g_error_free(error);
-    CAMLreturn(Val_none);
+/* is_na(<column>) for a column of any type; never NA itself. */
+static PredicateMask *
+predicate_mask_is_na(GArrowTable *table, const gchar *col_name) {
+  GArrowSchema *schema = garrow_table_get_schema(table);
+  gint idx = garrow_schema_get_field_index(schema, col_name);
+  g_object_unref(schema);
+  if (idx < 0) return NULL;
+  GArrowChunkedArray *col = garrow_table_get_column_data(table, idx);
+  if (col == NULL) return NULL;
+
+  PredicateMask *m = predicate_mask_new(garrow_table_get_n_rows(table));
+  gint64 row = 0;
+  guint n_chunks = garrow_chunked_array_get_n_chunks(col);
+  for (guint c = 0; c < n_chunks; c++) {
+    GArrowArray *chunk = garrow_chunked_array_get_chunk(col, c);
+    gint64 len = MIN(garrow_array_get_length(chunk), m->length - row);
+    predicate_mask_mark_nulls(m, chunk, row, len);
+    row += len;
+    g_object_unref(chunk);
+  }
+  g_object_unref(col);
+  /* The null rows were marked NA; they are the rows this predicate keeps. */
+  guint64 *t = m->keep; m->keep = m->na; m->na = t;
+  return m;
+}
+
+/* NOT, AND and OR follow the interpreter's short-circuit evaluation: an NA
+   left side is always NA, and an NA right side only matters when the right
+   side would have been evaluated. */
+static PredicateMask *
+predicate_mask_not(const PredicateMask *a) {
+  PredicateMask *m = predicate_mask_new(a->length);
+  for (gint64 w = 0; w < a->n_words; w++) {
+    m->keep[w] = ~a->keep[w] & ~a->na[w];
+    m->na[w] = a->na[w];
+  }
+  if (a->length & 63) m->keep[a->n_words - 1] &= MASK_BIT(a->length) - 1;
+  return m;
+}
+
+static PredicateMask *
+predicate_mask_and(const PredicateMask *a, const PredicateMask *b) {
+  if (a->length != b->length) return NULL;
+  PredicateMask *m = predicate_mask_new(a->length);
+  for (gint64 w = 0; w < a->n_words; w++) {
+    guint64 evaluate_right = a->keep[w] | a->na[w];
+    m->na[w] = a->na[w] | (b->na[w] & evaluate_right);
+    m->keep[w] = a->keep[w] & b->keep[w] & ~m->na[w];
+  }
+  return m;
+}
+
+static PredicateMask *
+predicate_mask_or(const PredicateMask *a, const PredicateMask *b) {
+  if (a->length != b->length) return NULL;
+  PredicateMask *m = predicate_mask_new(a->length);
+  for (gint64 w = 0; w < a->n_words; w++) {
+    guint64 left_false = ~a->keep[w] & ~a->na[w];
+    m->keep[w] = a->keep[w] | (left_false & b->keep[w]);
+    m->na[w] = a->na[w] | (b->na[w] & left_false);
   }
+  return m;
+}
 
+static value
+predicate_mask_to_caml(PredicateMask *m) {
+  CAMLparam0();
+  CAMLlocal1(v_result);
+  if (m == NULL) CAMLreturn(Val_none);
   v_result = caml_alloc(1, 0);
-  Store_field(v_result, 0, caml_copy_nativeint((intnat)result));
+  Store_field(v_result, 0, caml_copy_nativeint((intnat)m));
   CAMLreturn(v_result);
 }
 
-CAMLprim value caml_arrow_table_merge_horizontal(value v_t1, value v_t2) {
-  CAMLparam2(v_t1, v_t2);
-  GArrowTable *t1 = (GArrowTable *)Nativeint_val(v_t1);
-  GArrowTable *t2 = (GArrowTable *)Nativeint_val(v_t2);
-  if (!t1 || !t2) CAMLreturn(Val_none);
-  GArrowSchema *s2 = garrow_table_get_schema(t2);
-  guint n2 = garrow_table_get_n_columns(t2);
-  GArrowTable *curr = g_object_ref(t1);
+/* (nativeint table_ptr, string col, float scalar, int op_code)
+     -> nativeint option; op codes as in compare_scalar. */
+CAMLprim value caml_arrow_mask_compare_scalar(value v_ptr, value v_col_name,
+                                              value v_scalar, value v_op_code) {
+  CAMLparam4(v_ptr, v_col_name, v_scalar, v_op_code);
+  GArrowTable *table = (GArrowTable *)Nativeint_val(v_ptr);
+  gchar *col_name = g_strdup(String_val(v_col_name));
+  gdouble scalar = Double_val(v_scalar);
+  int op_code = Int_val(v_op_code);
+
+  g_object_ref(table);
+  caml_enter_blocking_section();
+  PredicateMask *m = predicate_mask_compare(table, col_name, scalar, op_code);
+  caml_leave_blocking_section();
+  g_object_unref(table);
+
+  g_free(col_name);
+  CAMLreturn(predicate_mask_to_caml(m));
+}
+
+/* (nativeint table_ptr, string col, string s) -> nativeint option */
+CAMLprim value caml_arrow_mask_equal_string(value v_ptr, value v_col_name, value v_str) {
+  CAMLparam3(v_ptr, v_col_name, v_str);
+  GArrowTable *table = (GArrowTable *)Nativeint_val(v_ptr);
+  gchar *col_name = g_strdup(String_val(v_col_name));
+  gsize s_len = caml_string_length(v_str);
+  gchar *s = g_malloc(s_len + 1);
+  memcpy(s, String_val(v_str), s_len + 1);
+
+  g_object_ref(table);
+  caml_enter_blocking_section();
+  PredicateMask *m = predicate_mask_equal_string(table, col_name, s, s_len);
+  caml_leave_blocking_section();
+  g_object_unref(table);
+
+  g_free(s);
+  g_free(col_name);
+  CAMLreturn(predicate_mask_to_caml(m));
+}
+
+CAMLprim value caml_arrow_mask_is_na(value v_ptr, value v_col_name) {
+  CAMLparam2(v_ptr, v_col_name);
+  GArrowTable *table = (GArrowTable *)Nativeint_val(v_ptr);
+  gchar *col_name = g_strdup(String_val(v_col_name));
+
+  g_object_ref(table);
+  caml_enter_blocking_section();
+  PredicateMask *m = predicate_mask_is_na(table, col_name);
+  caml_leave_blocking_section();
+  g_object_unref(table);
+
+  g_free(col_name);
+  CAMLreturn(predicate_mask_to_caml(m));
+}
+
+CAMLprim value caml_arrow_mask_not(value v_mask) {
+  CAMLparam1(v_mask);
+  CAMLreturn(predicate_mask_to_caml(
+    predicate_mask_not((PredicateMask *)Nativeint_val(v_mask))));
+}
+
+CAMLprim value caml_arrow_mask_and(value v_a, value v_b) {
+  CAMLparam2(v_a, v_b);
+  CAMLreturn(predicate_mask_to_caml(
+    predicate_mask_and((PredicateMask *)Nativeint_val(v_a),
+                       (PredicateMask *)Nativeint_val(v_b))));
+}
+
+CAMLprim value caml_arrow_mask_or(value v_a, value v_b) {
+  CAMLparam2(v_a, v_b);
+  CAMLreturn(predicate_mask_to_caml(
+    predicate_mask_or((PredicateMask *)Nativeint_val(v_a),
+                      (PredicateMask *)Nativeint_val(v_b))));
+}
+
+/* (nativeint mask, int limit) -> int * int array
+   The number of NA rows and the 1-based positions of the first `limit`. */
+CAMLprim value caml_arrow_mask_na_rows(value v_mask, value v_limit) {
+  CAMLparam2(v_mask, v_limit);
+  CAMLlocal2(v_result, v_arr);
+  const PredicateMask *m = (const PredicateMask *)Nativeint_val(v_mask);
+  gint64 limit = Long_val(v_limit);
+
+  gint64 count = 0;
+  for (gint64 w = 0; w < m->n_words; w++) count += __builtin_popcountll(m->na[w]);
+
+  gint64 n_out = MIN(count, limit > 0 ? limit : 0);
+  v_arr = caml_alloc(n_out, 0);
+  gint64 o = 0;
+  for (gint64 w = 0; w < m->n_words && o < n_out; w++) {
+    guint64 bits = m->na[w];
+    while (bits != 0 && o < n_out) {
+      gint64 r = w * 64 + __builtin_ctzll(bits);
+      Store_field(v_arr, o++, Val_long(r + 1));
+      bits &= bits - 1;
+    }
+  }
+
+  v_result = caml_alloc_tuple(2);
+  Store_field(v_result, 0, Val_long(count));
+  Store_field(v_result, 1, v_arr);
+  CAMLreturn(v_result);
+}
+
+CAMLprim value caml_arrow_mask_free(value v_mask) {
+  CAMLparam1(v_mask);
+  predicate_mask_free((PredicateMask *)Nativeint_val(v_mask));
+  CAMLreturn(Val_unit);
+}
+
+/* Filter rows with a native predicate mask, keeping rows where it is true. */
+CAMLprim value caml_arrow_table_filter_native_mask(value v_ptr, value v_mask) {
+  CAMLparam2(v_ptr, v_mask);
+  CAMLlocal1(v_result);
+
+  GArrowTable *table = (GArrowTable *)Nativeint_val(v_ptr);
+  const PredicateMask *m = (const PredicateMask *)Nativeint_val(v_mask);
+  GError *error = NULL;
+  GArrowTable *result = NULL;
+
+  g_object_ref(table);
+  caml_enter_blocking_section();
+  if (m->length == garrow_table_get_n_rows(table))
+    result = filter_table_by_bitmap(table, m->keep, m->length, &error);
+  caml_leave_blocking_section();
+  g_object_unref(table);
+
+  if (error) g_error_free(error);
+  if (result == NULL) CAMLreturn(Val_none);
+
+  v_result = caml_alloc(1, 0);
+  Store_field(v_result, 0, caml_copy_nativeint((intnat)result));
+  CAMLreturn(v_result);
+}
+
+#undef MASK_BIT
+
+/* Slice a table: offset, length.
+   Returns Some(new_table_ptr) or None. */
+CAMLprim value caml_arrow_table_slice(value v_ptr, value v_offset, value v_len) {
+  CAMLparam3(v_ptr, v_offset, v_len);
+  CAMLlocal1(v_result);
+
+  GArrowTable *table = (GArrowTable *)Nativeint_val(v_ptr);
+  gint64 offset = Int64_val(v_offset);
+  gint64 len = Int64_val(v_len);
+
+  GArrowTable *result = garrow_table_slice(table, offset, len);
+  if (result == NULL) CAMLreturn(Val_none);
+
+  v_result = caml_alloc(1, 0);
+  Store_field(v_result, 0, caml_copy_nativeint((intnat)result));
+  CAMLreturn(v_result);
+}
+
+/* Take rows from a table by indices. 
+   indices is an OCaml int array; a negative index yields a null row, which
+   is how the hash join's unmatched rows are materialised.
+   Returns Some(new_table_ptr) or None. */
+CAMLprim value caml_arrow_table_take(value v_ptr, value v_indices) {
+  CAMLparam2(v_ptr, v_indices);
+  CAMLlocal1(v_result);
+
+  GArrowTable *table = (GArrowTable *)Nativeint_val(v_ptr);
+  int n = Wosize_val(v_indices);
+
+  GArrowInt64ArrayBuilder *builder = garrow_int64_array_builder_new();
+  GError *error = NULL;
+
+  for (int i = 0; i < n; i++) {
+    gint64 idx = Long_val(Field(v_indices, i));
+    if (idx < 0)
+      garrow_array_builder_append_null(GARROW_ARRAY_BUILDER(builder), &error);
+    else
+      garrow_int64_array_builder_append_value(builder, idx, &error);
+    if (error) {
+      g_object_unref(builder);
+      g_error_free(error);
+      CAMLreturn(Val_none);
+    }
+  }
+
+  GArrowArray *indices_array = garrow_array_builder_finish(GARROW_ARRAY_BUILDER(builder), &error);
+  g_object_unref(builder);
+
+  if (indices_array == NULL) {
+    if (error) g_error_free(error);
+    CAMLreturn(Val_none);
+  }
+
+  g_object_ref(table);
+  caml_enter_blocking_section();
+  GArrowTable *result = garrow_table_take(table, indices_array, NULL, &error);
+  caml_leave_blocking_section();
+  g_object_unref(table);
+  g_object_unref(indices_array);
+
+  if (result == NULL) {
+    if (error) g_error_free(error);
+    CAMLreturn(Val_none);
+  }
+
+  v_result = caml_alloc(1, 0);
+  Store_field(v_result, 0, caml_copy_nativeint((intnat)result));
+  CAMLreturn(v_result);
+}
+
+CAMLprim value caml_arrow_table_merge_horizontal(value v_t1, value v_t2) {
+  CAMLparam2(v_t1, v_t2);
+  GArrowTable *t1 = (GArrowTable *)Nativeint_val(v_t1);
+  GArrowTable *t2 = (GArrowTable *)Nativeint_val(v_t2);
+  if (!t1 || !t2) CAMLreturn(Val_none);
+  GArrowSchema *s2 = garrow_table_get_schema(t2);
+  guint n2 = garrow_table_get_n_columns(t2);
+  GArrowTable *curr = g_object_ref(t1);
   for (guint i = 0; i < n2; i++) {
     GArrowField *f = garrow_schema_get_field(s2, i);
     GArrowChunkedArray *c = garrow_table_get_column_data(t2, i);
@@ -1240,50 +2120,50 @@ CAMLprim value caml_arrow_table_merge_horizontal(value v_t1, value v_t2) {
 /* ===================================================================== */
 
 /* Sort table by column name, ascending or descending.
-   Returns Some(nativeint) or None on error. */
+   Returns Some(nativeint) or None on error. The sort and the take run
+   outside the OCaml runtime lock. */
 CAMLprim value caml_arrow_table_sort(value v_ptr, value v_col_name, value v_ascending) {
   CAMLparam3(v_ptr, v_col_name, v_ascending);
   CAMLlocal1(v_result);
 
   GArrowTable *table = (GArrowTable *)Nativeint_val(v_ptr);
-  const char *col_name = String_val(v_col_name);
+  gchar *col_name = g_strdup(String_val(v_col_name));
   gboolean ascending = Bool_val(v_ascending);
 
   GError *error = NULL;
+  GArrowTable *sorted = NULL;
+
+  g_object_ref(table);
+  caml_enter_blocking_section();
 
   /* Create sort key with column name and order */
   GArrowSortOrder order = ascending
     ? GARROW_SORT_ORDER_ASCENDING
     : GARROW_SORT_ORDER_DESCENDING;
   GArrowSortKey *sort_key = garrow_sort_key_new(col_name, order, &error);
-  if (sort_key == NULL) {
-    if (error) g_error_free(error);
-    CAMLreturn(Val_none);
-  }
-
-  GArrowSortOptions *options = garrow_sort_options_new(NULL);
-  garrow_sort_options_add_sort_key(options, sort_key);
-
-  /* Get sort indices */
-  GArrowUInt64Array *indices =
-    garrow_table_sort_indices(table, options, &error);
-  g_object_unref(sort_key);
-  g_object_unref(options);
-
-  if (indices == NULL) {
-    if (error) g_error_free(error);
-    CAMLreturn(Val_none);
+  if (sort_key != NULL) {
+    GArrowSortOptions *options = garrow_sort_options_new(NULL);
+    garrow_sort_options_add_sort_key(options, sort_key);
+
+    /* Get sort indices */
+    GArrowUInt64Array *indices =
+      garrow_table_sort_indices(table, options, &error);
+    g_object_unref(sort_key);
+    g_object_unref(options);
+
+    /* Take rows by sorted indices */
+    if (indices != NULL) {
+      sorted = garrow_table_take(table, GARROW_ARRAY(indices), NULL, &error);
+      g_object_unref(indices);
+    }
   }
 
-  /* Take rows by sorted indices */
-  GArrowTable *sorted = garrow_table_take(table,
-    GARROW_ARRAY(indices), NULL, &error);
-  g_object_unref(indices);
+  caml_leave_blocking_section();
+  g_object_unref(table);
 
-  if (sorted == NULL) {
-    if (error) g_error_free(error);
-    CAMLreturn(Val_none);
-  }
+  g_free(col_name);
+  if (error) g_error_free(error);
+  if (sorted == NULL) CAMLreturn(Val_none);
 
   v_result = caml_alloc(1, 0);
   Store_field(v_result, 0, caml_copy_nativeint((intnat)sorted));
@@ -2626,9 +3506,17 @@ build_aggregation_result(GroupedTable *gt, const char *agg_col_name,
     gint idx = garrow_schema_get_field_index(orig_schema, gt->key_names[k]);
     GArrowField *orig_field = garrow_schema_get_field(orig_schema, idx);
     GArrowDataType *dtype = garrow_field_get_data_type(orig_field);
+    GArrowDataType *key_type = dtype;
+    GArrowChunkedArray *dict_key = dictionary_type_is_string(dtype)
+      ? dictionary_key_column(gt->table, idx, dtype, gt->group_key_values, k, gt->n_groups)
+      : NULL;
 
     /* Build the key column array for this key */
-    if (GARROW_IS_INT64_DATA_TYPE(dtype)) {
+    if (dict_key != NULL) {
+      /* Factor keys keep their levels; the index type may change. */
+      columns[k] = dict_key;
+      key_type = garrow_chunked_array_get_value_data_type(dict_key);
+    } else if (GARROW_IS_INT64_DATA_TYPE(dtype)) {
       GArrowInt64ArrayBuilder *builder = garrow_int64_array_builder_new();
       for (int g = 0; g < gt->n_groups; g++) {
         if (gt->group_key_values[g][k] == NULL) {
@@ -2678,8 +3566,9 @@ build_aggregation_result(GroupedTable *gt, const char *agg_col_name,
       g_object_unref(builder);
     }
 
-    GArrowField *new_field = garrow_field_new(gt->key_names[k], dtype);
+    GArrowField *new_field = garrow_field_new(gt->key_names[k], key_type);
     fields_list = g_list_append(fields_list, new_field);
+    if (key_type != dtype) g_object_unref(key_type);
     g_object_unref(orig_field);
   }
   g_object_unref(orig_schema);
@@ -3031,173 +3920,1039 @@ CAMLprim value caml_arrow_group_count_distinct(value v_grouped_ptr, value v_col_
   CAMLreturn(v_result);
 }
 
-/* Multi-aggregate: compute multiple aggregations in a single call.
-   Builds key columns only ONCE for all aggregations, avoiding redundant
-   key column reconstruction in the single-aggregate path.
-   Args: grouped_table_ptr, agg_types (string list), col_names (string list),
-         result_names (string list)
-   agg_types: "sum", "mean", "count", "min", "max", "count_distinct"
-   Returns: Some(result_table_ptr) or None on failure. */
-CAMLprim value caml_arrow_group_multi_aggregate(
-    value v_grouped_ptr, value v_agg_types, value v_col_names, value v_result_names) {
-  CAMLparam4(v_grouped_ptr, v_agg_types, v_col_names, v_result_names);
-  CAMLlocal1(v_result);
-
-  GroupedTable *gt = (GroupedTable *)Nativeint_val(v_grouped_ptr);
+/* ===================================================================== */
+/* Typed Key Columns                                                     */
+/* ===================================================================== */
 
-  /* Count number of aggregations */
-  int n_aggs = 0;
-  value iter = v_agg_types;
-  while (iter != Val_emptylist) { n_aggs++; iter = Field(iter, 1); }
-  if (n_aggs == 0) CAMLreturn(Val_none);
+/* Key columns flattened across chunks, shared by the optimized group-by,
+   multi-aggregate distinct counts and the hash join. Fixed-width keys store
+   the value's bit pattern (integers sign-extended, floats widened to double
+   with NaN and zero canonicalised); string keys point into the chunk value buffers,
+   which stay alive through the references kept in `hold`. Dictionary keys
+   store their code in a DictUnifier, so they hash and compare as integers
+   and order by level. */
+typedef struct {
+  int tag;              /* 0=Int, 1=Float, 2=Bool, 3=String, 7=Date, 8=Dictionary */
+  gboolean is_unsigned; /* UInt64 keys, which must not print as negative */
+  guint64 *words;
+  const gchar **str;
+  gint32 *len;
+  guint8 *is_null;
+  DictUnifier *dict;    /* levels of dictionary keys */
+  gboolean owns_dict;
+} KeyColumn;
 
-  /* Parse agg specs from OCaml lists */
-  char **agg_types = (char **)malloc(sizeof(char *) * n_aggs);
-  char **col_names = (char **)malloc(sizeof(char *) * n_aggs);
-  char **result_names = (char **)malloc(sizeof(char *) * n_aggs);
-  if (agg_types == NULL || col_names == NULL || result_names == NULL) {
-    free(agg_types); free(col_names); free(result_names);
-    CAMLreturn(Val_none);
-  }
+static int
+key_column_tag(GArrowDataType *dtype) {
+  if (GARROW_IS_INT8_DATA_TYPE(dtype) || GARROW_IS_INT16_DATA_TYPE(dtype) ||
+      GARROW_IS_INT32_DATA_TYPE(dtype) || GARROW_IS_INT64_DATA_TYPE(dtype) ||
+      GARROW_IS_UINT8_DATA_TYPE(dtype) || GARROW_IS_UINT16_DATA_TYPE(dtype) ||
+      GARROW_IS_UINT32_DATA_TYPE(dtype) || GARROW_IS_UINT64_DATA_TYPE(dtype))
+    return 0;
+  if (GARROW_IS_DOUBLE_DATA_TYPE(dtype) || GARROW_IS_FLOAT_DATA_TYPE(dtype)) return 1;
+  if (GARROW_IS_BOOLEAN_DATA_TYPE(dtype)) return 2;
+  /* Large strings use 64-bit offsets; callers fall back for them. */
+  if (GARROW_IS_STRING_DATA_TYPE(dtype)) return 3;
+  if (GARROW_IS_DATE32_DATA_TYPE(dtype) || GARROW_IS_DATE64_DATA_TYPE(dtype)) return 7;
+  if (dictionary_type_is_string(dtype)) return 8;
+  return -1;
+}
 
-  iter = v_agg_types;
-  value iter2 = v_col_names;
-  value iter3 = v_result_names;
-  for (int i = 0; i < n_aggs; i++) {
-    agg_types[i] = g_strdup(String_val(Field(iter, 0)));
-    col_names[i] = g_strdup(String_val(Field(iter2, 0)));
-    result_names[i] = g_strdup(String_val(Field(iter3, 0)));
-    iter = Field(iter, 1);
-    iter2 = Field(iter2, 1);
-    iter3 = Field(iter3, 1);
-  }
+static void
+key_column_free(KeyColumn *col) {
+  g_free(col->words);
+  g_free(col->str);
+  g_free(col->len);
+  g_free(col->is_null);
+  if (col->owns_dict) dict_unifier_free(col->dict);
+}
 
-  /* Allocate result arrays for each aggregation */
-  gdouble **agg_values = (gdouble **)malloc(sizeof(gdouble *) * n_aggs);
-  gboolean **agg_nulls = (gboolean **)malloc(sizeof(gboolean *) * n_aggs);
-  gboolean *agg_is_int = (gboolean *)malloc(sizeof(gboolean) * n_aggs);
+static inline guint64
+key_double_bits(gdouble v) {
+  /* All NaNs compare equal, as with the string keys of the OCaml paths, and
+     -0.0 is stored as 0.0 so the two zeros hash, join and group as one key,
+     as they compare under ==. */
+  guint64 bits = 0x7ff8000000000000ULL;
+  if (v == 0.0) v = 0.0;
+  if (!isnan(v)) memcpy(&bits, &v, sizeof(bits));
+  return bits;
+}
 
-  for (int a = 0; a < n_aggs; a++) {
-    agg_values[a] = (gdouble *)calloc(gt->n_groups, sizeof(gdouble));
-    agg_nulls[a] = (gboolean *)calloc(gt->n_groups, sizeof(gboolean));
-    agg_is_int[a] = FALSE;
+#define KEY_LOAD_VALUES(ARRAY_T, CAST, GETTER)                              \
+  do {                                                                      \
+    gint64 n_vals = 0;                                                      \
+    const ARRAY_T *vals = GETTER(CAST(chunk), &n_vals);                     \
+    if (vals == NULL && len > 0) ok = FALSE;                                \
+    else for (gint64 i = 0; i < len && i < n_vals; i++)                     \
+      col->words[row + i] = (guint64)vals[i];                               \
+  } while (0)
+
+/* Dictionary keys take their codes from `shared` when given (the other side
+   of a join), otherwise from a unifier of their own. */
+static gboolean
+key_column_load(KeyColumn *col, GArrowChunkedArray *chunked, gint64 n,
+                int tag, DictUnifier *shared, GPtrArray *hold) {
+  col->tag = tag;
+  col->is_unsigned = tag == 8;
+  col->words = NULL;
+  col->str = NULL;
+  col->len = NULL;
+  col->dict = NULL;
+  col->owns_dict = FALSE;
+  if (tag == 8) {
+    col->dict = shared ? shared : dict_unifier_new();
+    col->owns_dict = shared == NULL;
+  }
+  col->is_null = g_new0(guint8, n > 0 ? n : 1);
+  if (tag == 3) {
+    col->str = g_new0(const gchar *, n > 0 ? n : 1);
+    col->len = g_new0(gint32, n > 0 ? n : 1);
+  } else {
+    col->words = g_new0(guint64, n > 0 ? n : 1);
   }
 
-  GArrowSchema *schema = garrow_table_get_schema(gt->table);
-  gboolean failed = FALSE;
+  gboolean ok = TRUE;
+  gint64 row = 0;
+  guint n_chunks = garrow_chunked_array_get_n_chunks(chunked);
+  for (guint c = 0; c < n_chunks && ok; c++) {
+    GArrowArray *chunk = garrow_chunked_array_get_chunk(chunked, c);
+    if (chunk == NULL) { ok = FALSE; break; }
+    g_ptr_array_add(hold, chunk);
+    gint64 len = garrow_array_get_length(chunk);
+    if (row + len > n) { ok = FALSE; break; }
+
+    if (garrow_array_get_n_nulls(chunk) > 0) {
+      for (gint64 i = 0; i < len; i++)
+        col->is_null[row + i] = garrow_array_is_null(chunk, i) ? 1 : 0;
+    }
 
-  /* Process each aggregation */
-  for (int a = 0; a < n_aggs && !failed; a++) {
-    if (strcmp(agg_types[a], "count") == 0) {
-      /* Count: just use group sizes */
-      for (int g = 0; g < gt->n_groups; g++) {
-        agg_values[a][g] = (gdouble)gt->group_sizes[g];
+    if (tag == 8) {
+      /* Codes are non-negative; null rows are ignored through is_null. */
+      ok = GARROW_IS_DICTIONARY_ARRAY(chunk) &&
+           dict_chunk_codes(col->dict, chunk, (gint64 *)(col->words + row));
+    } else if (GARROW_IS_INT64_ARRAY(chunk)) {
+      KEY_LOAD_VALUES(gint64, GARROW_INT64_ARRAY, garrow_int64_array_get_values);
+    } else if (GARROW_IS_INT32_ARRAY(chunk)) {
+      KEY_LOAD_VALUES(gint32, GARROW_INT32_ARRAY, garrow_int32_array_get_values);
+    } else if (GARROW_IS_INT16_ARRAY(chunk)) {
+      KEY_LOAD_VALUES(gint16, GARROW_INT16_ARRAY, garrow_int16_array_get_values);
+    } else if (GARROW_IS_INT8_ARRAY(chunk)) {
+      KEY_LOAD_VALUES(gint8, GARROW_INT8_ARRAY, garrow_int8_array_get_values);
+    } else if (GARROW_IS_UINT64_ARRAY(chunk)) {
+      col->is_unsigned = TRUE;
+      KEY_LOAD_VALUES(guint64, GARROW_UINT64_ARRAY, garrow_uint64_array_get_values);
+    } else if (GARROW_IS_UINT32_ARRAY(chunk)) {
+      KEY_LOAD_VALUES(guint32, GARROW_UINT32_ARRAY, garrow_uint32_array_get_values);
+    } else if (GARROW_IS_UINT16_ARRAY(chunk)) {
+      KEY_LOAD_VALUES(guint16, GARROW_UINT16_ARRAY, garrow_uint16_array_get_values);
+    } else if (GARROW_IS_UINT8_ARRAY(chunk)) {
+      KEY_LOAD_VALUES(guint8, GARROW_UINT8_ARRAY, garrow_uint8_array_get_values);
+    } else if (GARROW_IS_DATE32_ARRAY(chunk)) {
+      KEY_LOAD_VALUES(gint32, GARROW_DATE32_ARRAY, garrow_date32_array_get_values);
+    } else if (GARROW_IS_DATE64_ARRAY(chunk)) {
+      KEY_LOAD_VALUES(gint64, GARROW_DATE64_ARRAY, garrow_date64_array_get_values);
+    } else if (GARROW_IS_DOUBLE_ARRAY(chunk)) {
+      gint64 n_vals = 0;
+      const gdouble *vals = garrow_double_array_get_values(GARROW_DOUBLE_ARRAY(chunk), &n_vals);
+      if (vals == NULL && len > 0) ok = FALSE;
+      for (gint64 i = 0; ok && i < len && i < n_vals; i++)
+        col->words[row + i] = key_double_bits(vals[i]);
+    } else if (GARROW_IS_FLOAT_ARRAY(chunk)) {
+      gint64 n_vals = 0;
+      const gfloat *vals = garrow_float_array_get_values(GARROW_FLOAT_ARRAY(chunk), &n_vals);
+      if (vals == NULL && len > 0) ok = FALSE;
+      for (gint64 i = 0; ok && i < len && i < n_vals; i++)
+        col->words[row + i] = key_double_bits((gdouble)vals[i]);
+    } else if (GARROW_IS_BOOLEAN_ARRAY(chunk)) {
+      GArrowBooleanArray *bools = GARROW_BOOLEAN_ARRAY(chunk);
+      for (gint64 i = 0; i < len; i++)
+        col->words[row + i] = garrow_boolean_array_get_value(bools, i) ? 1 : 0;
+    } else if (GARROW_IS_STRING_ARRAY(chunk)) {
+      GArrowBinaryArray *bin = GARROW_BINARY_ARRAY(chunk);
+      GArrowBuffer *offsets_buf = garrow_binary_array_get_offsets_buffer(bin);
+      GArrowBuffer *data_buf = garrow_binary_array_get_data_buffer(bin);
+      if (offsets_buf == NULL) { ok = FALSE; if (data_buf) g_object_unref(data_buf); break; }
+      g_ptr_array_add(hold, offsets_buf);
+      if (data_buf) g_ptr_array_add(hold, data_buf);
+      GBytes *offsets_bytes = garrow_buffer_get_data(offsets_buf);
+      GBytes *data_bytes = data_buf ? garrow_buffer_get_data(data_buf) : NULL;
+      gsize offsets_size = 0;
+      const gint32 *offsets = (const gint32 *)g_bytes_get_data(offsets_bytes, &offsets_size);
+      const gchar *data = data_bytes ? (const gchar *)g_bytes_get_data(data_bytes, NULL) : NULL;
+      gint64 base = garrow_array_get_offset(chunk);
+      if (offsets == NULL ||
+          (gsize)(base + len + 1) * sizeof(gint32) > offsets_size) {
+        ok = FALSE;
+      } else {
+        for (gint64 i = 0; i < len; i++) {
+          gint32 start = offsets[base + i];
+          col->str[row + i] = data ? data + start : "";
+          col->len[row + i] = offsets[base + i + 1] - start;
+        }
       }
-      agg_is_int[a] = TRUE;
+      /* The GBytes wrap the buffers' memory without owning it. */
+      g_bytes_unref(offsets_bytes);
+      if (data_bytes) g_bytes_unref(data_bytes);
+    } else {
+      ok = FALSE;
+    }
+    row += len;
+  }
+  return ok && row == n;
+}
 
-    } else if (strcmp(agg_types[a], "count_distinct") == 0) {
-      /* Count distinct: per-group hash table */
-      gint col_idx = garrow_schema_get_field_index(schema, col_names[a]);
-      if (col_idx < 0) { failed = TRUE; break; }
+#undef KEY_LOAD_VALUES
 
-      GArrowChunkedArray *chunked = garrow_table_get_column_data(gt->table, col_idx);
-      if (chunked == NULL) { failed = TRUE; break; }
+/* Load the named columns of `table` as key columns. Returns FALSE when a
+   column is missing or its type has no typed-key representation. On
+   success `cols` holds n_keys loaded columns; on failure it is cleared. */
+static gboolean
+key_columns_load(GArrowTable *table, gchar **names, int n_keys,
+                 KeyColumn *cols, GPtrArray *hold) {
+  GArrowSchema *schema = garrow_table_get_schema(table);
+  gint64 nrows = garrow_table_get_n_rows(table);
+  int loaded = 0;
+  gboolean ok = TRUE;
+  for (int k = 0; k < n_keys && ok; k++) {
+    gint idx = garrow_schema_get_field_index(schema, names[k]);
+    if (idx < 0) { ok = FALSE; break; }
+    GArrowField *field = garrow_schema_get_field(schema, idx);
+    int tag = key_column_tag(garrow_field_get_data_type(field));
+    g_object_unref(field);
+    if (tag < 0) { ok = FALSE; break; }
+    GArrowChunkedArray *chunked = garrow_table_get_column_data(table, idx);
+    ok = key_column_load(&cols[k], chunked, nrows, tag, NULL, hold);
+    loaded = k + 1;
+    g_object_unref(chunked);
+  }
+  g_object_unref(schema);
+  if (!ok) {
+    for (int k = 0; k < loaded; k++) key_column_free(&cols[k]);
+    memset(cols, 0, sizeof(KeyColumn) * n_keys);
+  }
+  return ok;
+}
 
-      for (int g = 0; g < gt->n_groups && !failed; g++) {
-        GHashTable *seen = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
-        for (int r = 0; r < gt->group_sizes[g]; r++) {
-          gchar *key = NULL;
-          if (!get_distinct_key_string(chunked, gt->group_row_indices[g][r], &key)) {
-            g_hash_table_destroy(seen);
-            failed = TRUE;
-            break;
-          }
-          g_hash_table_add(seen, key);
-        }
-        if (!failed) {
-          agg_values[a][g] = (gdouble)g_hash_table_size(seen);
-          agg_nulls[a][g] = FALSE;
-        }
-        g_hash_table_destroy(seen);
-      }
-      g_object_unref(chunked);
-      agg_is_int[a] = TRUE;
+/* --- Key hashing ----------------------------------------------------- */
+/* Rows are hashed word by word. On x86-64 CPUs with SSE4.2 and on ARMv8
+   with the CRC extension the per-word step is the hardware CRC32C
+   instruction (two lanes with different seeds for 64 bits); elsewhere it is
+   a 64-bit multiply-xorshift mixer. The choice is made once per process, so
+   every side of a join or every morsel of a group-by hashes identically. */
+
+static inline guint64
+key_mix64(guint64 x) {
+  x ^= x >> 33;
+  x *= 0xff51afd7ed558ccdULL;
+  x ^= x >> 33;
+  x *= 0xc4ceb9fe1a85ec53ULL;
+  x ^= x >> 33;
+  return x;
+}
 
-    } else {
-      /* Numeric aggregations: sum, mean, min, max */
-      gint col_idx = garrow_schema_get_field_index(schema, col_names[a]);
-      if (col_idx < 0) { failed = TRUE; break; }
+static inline guint64
+key_word_hash_generic(guint64 h, guint64 x) {
+  return key_mix64(h ^ (x + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2)));
+}
 
-      GArrowChunkedArray *chunked = garrow_table_get_column_data(gt->table, col_idx);
-      if (chunked == NULL) { failed = TRUE; break; }
+#define KEY_NULL_WORD 0x5bd1e9955bd1e995ULL
+#define KEY_HASH_SEED 0x9e3779b97f4a7c15ULL
+
+/* Hash rows [begin, end) of the key columns into out[begin, end).
+   WORD_HASH(h, w) folds one 64-bit word into the running hash. */
+#define KEY_HASH_ROWS_BODY(WORD_HASH)                                       \
+  for (gint64 r = begin; r < end; r++) {                                    \
+    guint64 h = KEY_HASH_SEED;                                              \
+    for (int k = 0; k < n_keys; k++) {                                      \
+      const KeyColumn *col = &keys[k];                                      \
+      if (col->is_null[r]) {                                                \
+        h = WORD_HASH(h, KEY_NULL_WORD);                                    \
+      } else if (col->tag == 3) {                                           \
+        const gchar *s = col->str[r];                                       \
+        gint32 n = col->len[r];                                             \
+        gint32 i = 0;                                                       \
+        for (; i + 8 <= n; i += 8) {                                        \
+          guint64 w;                                                        \
+          memcpy(&w, s + i, 8);                                             \
+          h = WORD_HASH(h, w);                                              \
+        }                                                                   \
+        guint64 tail = (guint64)(guint32)n << 56;                           \
+        if (i < n) memcpy(&tail, s + i, (size_t)(n - i));                   \
+        h = WORD_HASH(h, tail);                                             \
+      } else {                                                              \
+        h = WORD_HASH(h, col->words[r]);                                    \
+      }                                                                     \
+    }                                                                       \
+    out[r] = h;                                                             \
+  }
 
-      gboolean is_sum  = (strcmp(agg_types[a], "sum") == 0);
-      gboolean is_mean = (strcmp(agg_types[a], "mean") == 0);
-      gboolean is_min  = (strcmp(agg_types[a], "min") == 0);
-      gboolean is_max  = (strcmp(agg_types[a], "max") == 0);
+static void
+key_hash_rows_generic(const KeyColumn *keys, int n_keys, gint64 begin, gint64 end, guint64 *out) {
+  KEY_HASH_ROWS_BODY(key_word_hash_generic)
+}
 
-      for (int g = 0; g < gt->n_groups && !failed; g++) {
-        NumericChunkCursor cursor;
-        numeric_chunk_cursor_init(&cursor, chunked);
-
-        gdouble sum = 0.0;
-        int count = 0;
-        gboolean has_value = FALSE;
-        gdouble best = 0.0;
-
-        for (int r = 0; r < gt->group_sizes[g]; r++) {
-          gboolean is_null;
-          gdouble val = 0.0;
-          if (!get_numeric_value(&cursor, gt->group_row_indices[g][r], &is_null, &val)) {
-            numeric_chunk_cursor_destroy(&cursor);
-            failed = TRUE;
-            break;
-          }
-          if (!is_null) {
-            if (is_sum || is_mean) {
-              sum += val;
-              count++;
-            }
-            if (is_min) {
-              if (!has_value || val < best) best = val;
-              has_value = TRUE;
-            }
-            if (is_max) {
-              if (!has_value || val > best) best = val;
-              has_value = TRUE;
-            }
-          }
-        }
-        numeric_chunk_cursor_destroy(&cursor);
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define KEY_HASH_HAVE_CRC 1
 
-        if (!failed) {
-          if (is_sum) {
-            agg_values[a][g] = sum;
-            agg_nulls[a][g] = (count == 0);
-          } else if (is_mean) {
-            if (count > 0) {
-              agg_values[a][g] = sum / (gdouble)count;
-              agg_nulls[a][g] = FALSE;
-            } else {
-              agg_nulls[a][g] = TRUE;
-            }
-          } else if (is_min || is_max) {
-            if (has_value) {
-              agg_values[a][g] = best;
-              agg_nulls[a][g] = FALSE;
-            } else {
-              agg_nulls[a][g] = TRUE;
-            }
-          }
-        }
-      }
-      g_object_unref(chunked);
-    }
-  }
+__attribute__((target("sse4.2"))) static inline guint64
+key_word_hash_crc(guint64 h, guint64 x) {
+  guint64 lo = _mm_crc32_u64(h & 0xffffffffULL, x);
+  guint64 hi = _mm_crc32_u64((h >> 32) ^ 0x7ed55d16ULL, x);
+  return (hi << 32) | lo;
+}
 
-  g_object_unref(schema);
+__attribute__((target("sse4.2"))) static void
+key_hash_rows_crc(const KeyColumn *keys, int n_keys, gint64 begin, gint64 end, guint64 *out) {
+  KEY_HASH_ROWS_BODY(key_word_hash_crc)
+}
 
-  if (failed) {
+static gboolean
+key_hash_crc_supported(void) {
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("sse4.2") ? TRUE : FALSE;
+}
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#define KEY_HASH_HAVE_CRC 1
+
+static inline guint64
+key_word_hash_crc(guint64 h, guint64 x) {
+  guint64 lo = __crc32cd((guint32)h, x);
+  guint64 hi = __crc32cd((guint32)(h >> 32) ^ 0x7ed55d16U, x);
+  return (hi << 32) | lo;
+}
+
+static void
+key_hash_rows_crc(const KeyColumn *keys, int n_keys, gint64 begin, gint64 end, guint64 *out) {
+  KEY_HASH_ROWS_BODY(key_word_hash_crc)
+}
+
+static gboolean
+key_hash_crc_supported(void) {
+  return TRUE;
+}
+#endif
+
+#undef KEY_HASH_ROWS_BODY
+
+typedef void (*KeyHashRowsFn)(const KeyColumn *, int, gint64, gint64, guint64 *);
+
+static KeyHashRowsFn
+key_hash_rows_impl(void) {
+  static gsize chosen = 0;
+  static KeyHashRowsFn fn = key_hash_rows_generic;
+  if (g_once_init_enter(&chosen)) {
+#ifdef KEY_HASH_HAVE_CRC
+    if (key_hash_crc_supported()) fn = key_hash_rows_crc;
+#endif
+    g_once_init_leave(&chosen, 1);
+  }
+  return fn;
+}
+
+static void
+key_hash_rows(const KeyColumn *keys, int n_keys, gint64 begin, gint64 end, guint64 *out) {
+  key_hash_rows_impl()(keys, n_keys, begin, end, out);
+}
+
+/* Null keys match each other, like NA keys in the OCaml group-by and join. */
+static inline gboolean
+key_rows_equal(const KeyColumn *lk, gint64 l, const KeyColumn *rk, gint64 r, int n_keys) {
+  for (int k = 0; k < n_keys; k++) {
+    gboolean ln = lk[k].is_null[l], rn = rk[k].is_null[r];
+    if (ln || rn) {
+      if (ln != rn) return FALSE;
+      continue;
+    }
+    if (lk[k].tag == 3) {
+      if (lk[k].len[l] != rk[k].len[r] ||
+          memcmp(lk[k].str[l], rk[k].str[r], (size_t)lk[k].len[l]) != 0)
+        return FALSE;
+    } else if (lk[k].words[l] != rk[k].words[r]) {
+      return FALSE;
+    }
+  }
+  return TRUE;
+}
+
+/* Order two non-NA cells of identically typed key columns: numeric order
+   for Int/Float/Date, false < true, byte order for strings and level order
+   for dictionaries. */
+static inline int
+key_cells_compare(const KeyColumn *ca, gint64 a, const KeyColumn *cb, gint64 b) {
+  if (ca->tag == 3) {
+    gint32 la = ca->len[a], lb = cb->len[b];
+    int c = memcmp(ca->str[a], cb->str[b], (size_t)MIN(la, lb));
+    if (c != 0) return c;
+    if (la != lb) return la < lb ? -1 : 1;
+  } else if (ca->tag == 1) {
+    gdouble va, vb;
+    memcpy(&va, &ca->words[a], sizeof(va));
+    memcpy(&vb, &cb->words[b], sizeof(vb));
+    /* NaN sorts after every number (nulls come later still, in the
+       callers), as in caml_arrow_compute_sort_indices; comparing it with
+       < and > alone would make it equal to everything. */
+    gboolean na = isnan(va), nb = isnan(vb);
+    if (na || nb) {
+      if (na && nb) return 0;
+      return na ? 1 : -1;
+    }
+    if (va < vb) return -1;
+    if (va > vb) return 1;
+  } else if (ca->is_unsigned || ca->tag == 2) {
+    if (ca->words[a] != cb->words[b]) return ca->words[a] < cb->words[b] ? -1 : 1;
+  } else {
+    gint64 va = (gint64)ca->words[a], vb = (gint64)cb->words[b];
+    if (va != vb) return va < vb ? -1 : 1;
+  }
+  return 0;
+}
+
+/* Order two rows by their keys, NAs last. */
+static int
+key_rows_compare(const KeyColumn *keys, int n_keys, gint64 a, gint64 b) {
+  for (int k = 0; k < n_keys; k++) {
+    const KeyColumn *col = &keys[k];
+    gboolean an = col->is_null[a], bn = col->is_null[b];
+    if (an || bn) {
+      if (an && bn) continue;
+      return an ? 1 : -1;
+    }
+    int c = key_cells_compare(col, a, col, b);
+    if (c != 0) return c;
+  }
+  return 0;
+}
+
+/* Render one key cell as the string stored in GroupedTable key values
+   (NULL for NA). Doubles use the shortest %g precision that round-trips. */
+static gchar *
+key_cell_string(const KeyColumn *col, gint64 r) {
+  if (col->is_null[r]) return NULL;
+  switch (col->tag) {
+  case 3:
+    return g_strndup(col->str[r], (gsize)col->len[r]);
+  case 8:
+    return g_strdup((const gchar *)g_ptr_array_index(col->dict->levels, col->words[r]));
+  case 2:
+    return g_strdup(col->words[r] ? "true" : "false");
+  case 1: {
+    gdouble v;
+    memcpy(&v, &col->words[r], sizeof(v));
+    for (int prec = 15; prec < 17; prec++) {
+      gchar *s = g_strdup_printf("%.*g", prec, v);
+      if (g_ascii_strtod(s, NULL) == v || isnan(v)) return s;
+      g_free(s);
+    }
+    return g_strdup_printf("%.17g", v);
+  }
+  default:
+    if (col->is_unsigned) return g_strdup_printf("%" G_GUINT64_FORMAT, col->words[r]);
+    return g_strdup_printf("%" G_GINT64_FORMAT, (gint64)col->words[r]);
+  }
+}
+
+/* --- Worker pool ----------------------------------------------------- */
+/* Morsel-driven helpers run one task per thread over disjoint row or group
+   ranges; the caller's thread runs the first task. They touch only plain C
+   buffers, so they may run inside a blocking section. */
+
+#define PARALLEL_MORSEL_ROWS 65536
+#define PARALLEL_MAX_THREADS 16
+
+static int
+parallel_thread_count(gint64 n_items) {
+  gint64 by_size = n_items / PARALLEL_MORSEL_ROWS;
+  gint64 n = MIN((gint64)g_get_num_processors(), (gint64)PARALLEL_MAX_THREADS);
+  n = MIN(n, by_size);
+  return n < 1 ? 1 : (int)n;
+}
+
+static void
+parallel_run(GThreadFunc fn, gpointer tasks, gsize task_size, int n_tasks) {
+  GThread **threads = g_new0(GThread *, n_tasks > 0 ? n_tasks : 1);
+  for (int t = 1; t < n_tasks; t++) {
+    gpointer task = (gchar *)tasks + (gsize)t * task_size;
+    threads[t] = g_thread_try_new("tlang-arrow", fn, task, NULL);
+    if (threads[t] == NULL) fn(task);
+  }
+  if (n_tasks > 0) fn(tasks);
+  for (int t = 1; t < n_tasks; t++)
+    if (threads[t] != NULL) g_thread_join(threads[t]);
+  g_free(threads);
+}
+
+typedef struct {
+  const KeyColumn *keys;
+  int n_keys;
+  gint64 begin;
+  gint64 end;
+  guint64 *out;
+} KeyHashTask;
+
+static gpointer
+key_hash_task_run(gpointer data) {
+  KeyHashTask *task = (KeyHashTask *)data;
+  key_hash_rows(task->keys, task->n_keys, task->begin, task->end, task->out);
+  return NULL;
+}
+
+/* key_hash_rows over [0, n), split across workers for large inputs. */
+static void
+key_hash_rows_parallel(const KeyColumn *keys, int n_keys, gint64 n, guint64 *out) {
+  int n_tasks = parallel_thread_count(n);
+  if (n_tasks == 1) {
+    key_hash_rows(keys, n_keys, 0, n, out);
+    return;
+  }
+  KeyHashTask *tasks = g_new(KeyHashTask, n_tasks);
+  for (int t = 0; t < n_tasks; t++) {
+    tasks[t].keys = keys;
+    tasks[t].n_keys = n_keys;
+    tasks[t].begin = n * t / n_tasks;
+    tasks[t].end = n * (t + 1) / n_tasks;
+    tasks[t].out = out;
+  }
+  parallel_run(key_hash_task_run, tasks, sizeof(KeyHashTask), n_tasks);
+  g_free(tasks);
+}
+
+/* --- Distinct-count sketches ----------------------------------------- */
+/* approx_n_distinct() uses HyperLogLog: each 64-bit key hash selects one of
+   2^HLL_PRECISION registers, which keeps the highest leading-zero rank seen
+   in the remaining bits. Sketches built over different chunks, groups or
+   workers merge by taking the register-wise maximum. 2^14 registers give a
+   standard error of about 0.8%; Sketch.Hll uses the same hash, precision
+   and estimator for OCaml-backed tables. */
+
+#define HLL_PRECISION 14
+#define HLL_REGISTERS (1 << HLL_PRECISION)
+/* Inputs of at most this many rows are counted exactly: the estimate would
+   be within linear-counting error of the exact count anyway, and clearing
+   a register set costs more than hashing a small group. */
+#define HLL_EXACT_LIMIT 4096
+
+/* Hash of one key value, the same as Sketch.hash_value on the OCaml side
+   so that a column counts alike whichever path sketches it. The CRC key
+   hashes cannot be used: they depend on the CPU. Date64 keys hold
+   milliseconds and so hash unlike the days of a Date value. */
+static guint64
+sketch_value_hash(const KeyColumn *col, gint64 r) {
+  if (col->is_null[r]) return KEY_NULL_WORD;
+  switch (col->tag) {
+  case 1: return key_mix64(col->words[r] ^ 0x5851f42d4c957f2dULL);
+  case 2: return key_mix64(col->words[r] ^ 0x2545f4914f6cdd1dULL);
+  case 7: return key_mix64(col->words[r] ^ 0x3c6ef372fe94f82bULL);
+  case 3:
+  case 8: {
+    const guchar *s;
+    gint64 n;
+    if (col->tag == 3) {
+      s = (const guchar *)col->str[r];
+      n = col->len[r];
+    } else {
+      s = g_ptr_array_index(col->dict->levels, (guint)col->words[r]);
+      n = (gint64)strlen((const gchar *)s);
+    }
+    /* FNV-1a over the bytes. */
+    guint64 h = 0xcbf29ce484222325ULL;
+    for (gint64 i = 0; i < n; i++) h = (h ^ s[i]) * 0x100000001b3ULL;
+    return key_mix64(h);
+  }
+  default: return key_mix64(col->words[r]);
+  }
+}
+
+static inline void
+hll_add(guint8 *reg, guint64 h) {
+  guint32 idx = (guint32)(h >> (64 - HLL_PRECISION));
+  guint64 rest = (h << HLL_PRECISION) | ((guint64)1 << (HLL_PRECISION - 1));
+  guint8 rank = 1;
+  while (!(rest & 0x8000000000000000ULL)) { rest <<= 1; rank++; }
+  if (rank > reg[idx]) reg[idx] = rank;
+}
+
+static inline void
+hll_merge(guint8 *into, const guint8 *from) {
+  for (int i = 0; i < HLL_REGISTERS; i++)
+    if (from[i] > into[i]) into[i] = from[i];
+}
+
+/* Raw HyperLogLog estimate, with linear counting for small cardinalities.
+   The 64-bit hashes make a large-range correction unnecessary. */
+static gint64
+hll_estimate(const guint8 *reg) {
+  gdouble m = (gdouble)HLL_REGISTERS;
+  gdouble sum = 0.0;
+  int zeros = 0;
+  for (int i = 0; i < HLL_REGISTERS; i++) {
+    sum += ldexp(1.0, -(int)reg[i]);
+    if (reg[i] == 0) zeros++;
+  }
+  gdouble e = 0.7213 / (1.0 + 1.079 / m) * m * m / sum;
+  if (e <= 2.5 * m && zeros > 0) e = m * log(m / (gdouble)zeros);
+  return (gint64)llround(e);
+}
+
+/* Exact number of distinct keys among `rows` (rows 0..size-1 when NULL),
+   using an open-addressing set of representative rows that grows in `*set`
+   across calls. NA is one value. */
+static gint64
+key_distinct_rows(const KeyColumn *col, const guint64 *hash,
+                  const gint64 *rows, gint64 size, gint64 **set, gint64 *set_cap) {
+  gint64 cap = 16;
+  while (cap < 2 * size) cap <<= 1;
+  if (cap > *set_cap) {
+    g_free(*set);
+    *set = g_new(gint64, cap);
+    *set_cap = cap;
+  }
+  gint64 *slots = *set;
+  for (gint64 s = 0; s < cap; s++) slots[s] = -1;
+  gint64 n_distinct = 0;
+  for (gint64 i = 0; i < size; i++) {
+    gint64 r = rows != NULL ? rows[i] : i;
+    guint64 h = hash[r];
+    gint64 s = (gint64)(h & (guint64)(cap - 1));
+    gboolean found = FALSE;
+    while (slots[s] >= 0) {
+      gint64 rep = slots[s];
+      if (hash[rep] == h && key_rows_equal(col, rep, col, r, 1)) {
+        found = TRUE;
+        break;
+      }
+      s = (s + 1) & (cap - 1);
+    }
+    if (!found) {
+      slots[s] = r;
+      n_distinct++;
+    }
+  }
+  return n_distinct;
+}
+
+typedef struct {
+  const KeyColumn *col;
+  gint64 begin;
+  gint64 end;
+  guint8 *reg;
+} HllTask;
+
+static gpointer
+hll_task_run(gpointer data) {
+  HllTask *task = (HllTask *)data;
+  for (gint64 r = task->begin; r < task->end; r++)
+    hll_add(task->reg, sketch_value_hash(task->col, r));
+  return NULL;
+}
+
+/* Approximate distinct count of a whole column. Each worker hashes a row
+   range into a sketch of its own; the sketches are merged at the end.
+   Returns Some(count) or None when the column type has no typed keys. */
+CAMLprim value caml_arrow_approx_count_distinct(value v_ptr, value v_col_name) {
+  CAMLparam2(v_ptr, v_col_name);
+  CAMLlocal1(v_result);
+
+  GArrowTable *table = (GArrowTable *)Nativeint_val(v_ptr);
+  gchar *names[1] = { (gchar *)String_val(v_col_name) };
+  gint64 nrows = garrow_table_get_n_rows(table);
+  GPtrArray *hold = g_ptr_array_new_with_free_func(g_object_unref);
+  KeyColumn col;
+  if (!key_columns_load(table, names, 1, &col, hold)) {
+    g_ptr_array_free(hold, TRUE);
+    CAMLreturn(Val_none);
+  }
+
+  gint64 count = 0;
+  g_object_ref(table);
+  caml_enter_blocking_section();
+  if (nrows <= HLL_EXACT_LIMIT) {
+    gint64 *set = NULL, set_cap = 0;
+    guint64 *hash = g_new(guint64, nrows > 0 ? nrows : 1);
+    key_hash_rows(&col, 1, 0, nrows, hash);
+    count = key_distinct_rows(&col, hash, NULL, nrows, &set, &set_cap);
+    g_free(set);
+    g_free(hash);
+  } else {
+    int n_tasks = parallel_thread_count(nrows);
+    HllTask *tasks = g_new(HllTask, n_tasks);
+    guint8 *regs = g_new0(guint8, (gsize)n_tasks * HLL_REGISTERS);
+    for (int t = 0; t < n_tasks; t++) {
+      tasks[t].col = &col;
+      tasks[t].begin = nrows * t / n_tasks;
+      tasks[t].end = nrows * (t + 1) / n_tasks;
+      tasks[t].reg = regs + (gsize)t * HLL_REGISTERS;
+    }
+    parallel_run(hll_task_run, tasks, sizeof(HllTask), n_tasks);
+    for (int t = 1; t < n_tasks; t++) hll_merge(regs, tasks[t].reg);
+    count = hll_estimate(regs);
+    g_free(regs);
+    g_free(tasks);
+  }
+  caml_leave_blocking_section();
+  g_object_unref(table);
+
+  key_column_free(&col);
+  g_ptr_array_free(hold, TRUE);
+
+  v_result = caml_alloc(1, 0);
+  Store_field(v_result, 0, Val_long(count));
+  CAMLreturn(v_result);
+}
+
+/* --- Multi-aggregate helpers ----------------------------------------- */
+
+/* Load a numeric column as doubles plus a null mask. Accepts the types of
+   read_numeric_array_value and fails for anything else. */
+#define NUMERIC_LOAD_VALUES(ARRAY_T, CAST, GETTER)                          \
+  do {                                                                      \
+    gint64 n_vals = 0;                                                      \
+    const ARRAY_T *src = GETTER(CAST(chunk), &n_vals);                      \
+    if (src == NULL && len > 0) ok = FALSE;                                 \
+    else for (gint64 i = 0; i < len && i < n_vals; i++)                     \
+      vals[row + i] = (gdouble)src[i];                                      \
+  } while (0)
+
+static gboolean
+numeric_column_load(GArrowChunkedArray *chunked, gint64 n, gdouble *vals, guint8 *is_null) {
+  gboolean ok = TRUE;
+  gint64 row = 0;
+  guint n_chunks = garrow_chunked_array_get_n_chunks(chunked);
+  for (guint c = 0; c < n_chunks && ok; c++) {
+    GArrowArray *chunk = garrow_chunked_array_get_chunk(chunked, c);
+    if (chunk == NULL) return FALSE;
+    gint64 len = garrow_array_get_length(chunk);
+    if (row + len > n) { g_object_unref(chunk); return FALSE; }
+    if (garrow_array_get_n_nulls(chunk) > 0) {
+      for (gint64 i = 0; i < len; i++)
+        is_null[row + i] = garrow_array_is_null(chunk, i) ? 1 : 0;
+    }
+    if (GARROW_IS_INT64_ARRAY(chunk)) {
+      NUMERIC_LOAD_VALUES(gint64, GARROW_INT64_ARRAY, garrow_int64_array_get_values);
+    } else if (GARROW_IS_INT32_ARRAY(chunk)) {
+      NUMERIC_LOAD_VALUES(gint32, GARROW_INT32_ARRAY, garrow_int32_array_get_values);
+    } else if (GARROW_IS_INT16_ARRAY(chunk)) {
+      NUMERIC_LOAD_VALUES(gint16, GARROW_INT16_ARRAY, garrow_int16_array_get_values);
+    } else if (GARROW_IS_INT8_ARRAY(chunk)) {
+      NUMERIC_LOAD_VALUES(gint8, GARROW_INT8_ARRAY, garrow_int8_array_get_values);
+    } else if (GARROW_IS_UINT64_ARRAY(chunk)) {
+      NUMERIC_LOAD_VALUES(guint64, GARROW_UINT64_ARRAY, garrow_uint64_array_get_values);
+    } else if (GARROW_IS_UINT32_ARRAY(chunk)) {
+      NUMERIC_LOAD_VALUES(guint32, GARROW_UINT32_ARRAY, garrow_uint32_array_get_values);
+    } else if (GARROW_IS_UINT16_ARRAY(chunk)) {
+      NUMERIC_LOAD_VALUES(guint16, GARROW_UINT16_ARRAY, garrow_uint16_array_get_values);
+    } else if (GARROW_IS_UINT8_ARRAY(chunk)) {
+      NUMERIC_LOAD_VALUES(guint8, GARROW_UINT8_ARRAY, garrow_uint8_array_get_values);
+    } else if (GARROW_IS_DOUBLE_ARRAY(chunk)) {
+      NUMERIC_LOAD_VALUES(gdouble, GARROW_DOUBLE_ARRAY, garrow_double_array_get_values);
+    } else if (GARROW_IS_FLOAT_ARRAY(chunk)) {
+      NUMERIC_LOAD_VALUES(gfloat, GARROW_FLOAT_ARRAY, garrow_float_array_get_values);
+    } else {
+      ok = FALSE;
+    }
+    g_object_unref(chunk);
+    row += len;
+  }
+  return ok && row == n;
+}
+
+#undef NUMERIC_LOAD_VALUES
+
+/* One input column of a multi-aggregate with its per-group statistics. */
+typedef struct {
+  const gchar *name;
+  gint col_idx;
+  gboolean has_numeric;
+  gdouble *vals;
+  guint8 *is_null;
+  gdouble *sum;
+  gdouble *min;
+  gdouble *max;
+  gint64 *count;
+  gboolean has_distinct;
+  KeyColumn distinct;
+  guint64 *distinct_hash;
+  gint64 *n_distinct;
+  gboolean want_exact;
+  gboolean want_approx;
+  gint64 *approx_distinct;
+} AggInputColumn;
+
+static void
+agg_input_column_free(AggInputColumn *in) {
+  g_free(in->vals); g_free(in->is_null);
+  g_free(in->sum); g_free(in->min); g_free(in->max); g_free(in->count);
+  if (in->has_distinct) key_column_free(&in->distinct);
+  g_free(in->distinct_hash);
+  g_free(in->n_distinct);
+  g_free(in->approx_distinct);
+}
+
+typedef struct {
+  GroupedTable *gt;
+  AggInputColumn *inputs;
+  int n_inputs;
+  int g_begin;
+  int g_end;
+} AggGroupTask;
+
+static gpointer
+agg_group_task_run(gpointer data) {
+  AggGroupTask *task = (AggGroupTask *)data;
+  GroupedTable *gt = task->gt;
+  gint64 set_cap = 0;
+  gint64 *set = NULL;
+  guint8 *reg = NULL;
+
+  for (int g = task->g_begin; g < task->g_end; g++) {
+    const gint64 *rows = gt->group_row_indices[g];
+    int size = gt->group_sizes[g];
+    for (int c = 0; c < task->n_inputs; c++) {
+      AggInputColumn *in = &task->inputs[c];
+      if (in->has_numeric) {
+        gdouble sum = 0.0, lo = 0.0, hi = 0.0;
+        gint64 count = 0;
+        for (int i = 0; i < size; i++) {
+          gint64 r = rows[i];
+          if (in->is_null[r]) continue;
+          gdouble v = in->vals[r];
+          if (count == 0) { lo = v; hi = v; }
+          else {
+            if (v < lo) lo = v;
+            if (v > hi) hi = v;
+          }
+          sum += v;
+          count++;
+        }
+        in->sum[g] = sum;
+        in->min[g] = lo;
+        in->max[g] = hi;
+        in->count[g] = count;
+      }
+      if (in->has_distinct) {
+        /* Large groups of approx-only inputs skip the exact set. */
+        gboolean sketch = in->want_approx && size > HLL_EXACT_LIMIT;
+        if (in->want_exact || !sketch)
+          in->n_distinct[g] = key_distinct_rows(&in->distinct, in->distinct_hash,
+                                                rows, size, &set, &set_cap);
+        if (in->want_approx) {
+          if (sketch) {
+            if (reg == NULL) reg = g_new(guint8, HLL_REGISTERS);
+            memset(reg, 0, HLL_REGISTERS);
+            for (int i = 0; i < size; i++)
+              hll_add(reg, sketch_value_hash(&in->distinct, rows[i]));
+            in->approx_distinct[g] = hll_estimate(reg);
+          } else {
+            in->approx_distinct[g] = in->n_distinct[g];
+          }
+        }
+      }
+    }
+  }
+  g_free(set);
+  g_free(reg);
+  return NULL;
+}
+
+/* Multi-aggregate: compute multiple aggregations in a single call.
+   Builds key columns only ONCE for all aggregations, avoiding redundant
+   key column reconstruction in the single-aggregate path.
+   Args: grouped_table_ptr, agg_types (string list), col_names (string list),
+         result_names (string list)
+   agg_types: "sum", "mean", "count", "min", "max", "count_distinct",
+              "approx_count_distinct"
+   Returns: Some(result_table_ptr) or None on failure. */
+CAMLprim value caml_arrow_group_multi_aggregate(
+    value v_grouped_ptr, value v_agg_types, value v_col_names, value v_result_names) {
+  CAMLparam4(v_grouped_ptr, v_agg_types, v_col_names, v_result_names);
+  CAMLlocal1(v_result);
+
+  GroupedTable *gt = (GroupedTable *)Nativeint_val(v_grouped_ptr);
+
+  /* Count number of aggregations */
+  int n_aggs = 0;
+  value iter = v_agg_types;
+  while (iter != Val_emptylist) { n_aggs++; iter = Field(iter, 1); }
+  if (n_aggs == 0) CAMLreturn(Val_none);
+
+  /* Parse agg specs from OCaml lists */
+  char **agg_types = (char **)malloc(sizeof(char *) * n_aggs);
+  char **col_names = (char **)malloc(sizeof(char *) * n_aggs);
+  char **result_names = (char **)malloc(sizeof(char *) * n_aggs);
+  if (agg_types == NULL || col_names == NULL || result_names == NULL) {
+    free(agg_types); free(col_names); free(result_names);
+    CAMLreturn(Val_none);
+  }
+
+  iter = v_agg_types;
+  value iter2 = v_col_names;
+  value iter3 = v_result_names;
+  for (int i = 0; i < n_aggs; i++) {
+    agg_types[i] = g_strdup(String_val(Field(iter, 0)));
+    col_names[i] = g_strdup(String_val(Field(iter2, 0)));
+    result_names[i] = g_strdup(String_val(Field(iter3, 0)));
+    iter = Field(iter, 1);
+    iter2 = Field(iter2, 1);
+    iter3 = Field(iter3, 1);
+  }
+
+  /* Every input column is loaded once: numeric aggregations of the same
+     column share one pass computing sum, count, min and max, and the
+     distinct counts (exact or sketched) hash the column's typed values. Groups are then split
+     into row-balanced ranges that workers aggregate in parallel. */
+  gdouble **agg_values = (gdouble **)malloc(sizeof(gdouble *) * n_aggs);
+  gboolean **agg_nulls = (gboolean **)malloc(sizeof(gboolean *) * n_aggs);
+  gboolean *agg_is_int = (gboolean *)malloc(sizeof(gboolean) * n_aggs);
+
+  for (int a = 0; a < n_aggs; a++) {
+    agg_values[a] = (gdouble *)calloc(gt->n_groups, sizeof(gdouble));
+    agg_nulls[a] = (gboolean *)calloc(gt->n_groups, sizeof(gboolean));
+    agg_is_int[a] = FALSE;
+  }
+
+  GArrowTable *held = g_object_ref(gt->table);
+  caml_enter_blocking_section();
+
+  gint64 nrows = garrow_table_get_n_rows(gt->table);
+  AggInputColumn *inputs = g_new0(AggInputColumn, n_aggs);
+  int *agg_input = g_new(int, n_aggs);
+  int n_inputs = 0;
+  GPtrArray *hold = g_ptr_array_new_with_free_func(g_object_unref);
+  GArrowSchema *schema = garrow_table_get_schema(gt->table);
+  gboolean failed = FALSE;
+
+  for (int a = 0; a < n_aggs && !failed; a++) {
+    agg_input[a] = -1;
+    if (strcmp(agg_types[a], "count") == 0) continue;
+    gboolean approx = (strcmp(agg_types[a], "approx_count_distinct") == 0);
+    gboolean distinct = approx || (strcmp(agg_types[a], "count_distinct") == 0);
+
+    int c = 0;
+    while (c < n_inputs && strcmp(inputs[c].name, col_names[a]) != 0) c++;
+    if (c == n_inputs) {
+      gint col_idx = garrow_schema_get_field_index(schema, col_names[a]);
+      if (col_idx < 0) { failed = TRUE; break; }
+      inputs[c].name = col_names[a];
+      inputs[c].col_idx = col_idx;
+      n_inputs++;
+    }
+    agg_input[a] = c;
+
+    AggInputColumn *in = &inputs[c];
+    if (approx) in->want_approx = TRUE;
+    else if (distinct) in->want_exact = TRUE;
+    GArrowChunkedArray *chunked = NULL;
+    if ((distinct && !in->has_distinct) || (!distinct && !in->has_numeric))
+      chunked = garrow_table_get_column_data(gt->table, in->col_idx);
+    if (distinct && !in->has_distinct) {
+      GArrowField *field = garrow_schema_get_field(schema, in->col_idx);
+      int tag = key_column_tag(garrow_field_get_data_type(field));
+      g_object_unref(field);
+      if (tag < 0 || chunked == NULL ||
+          !key_column_load(&in->distinct, chunked, nrows, tag, NULL, hold)) {
+        if (tag >= 0 && chunked != NULL) key_column_free(&in->distinct);
+        failed = TRUE;
+      } else {
+        in->has_distinct = TRUE;
+        in->distinct_hash = g_new(guint64, nrows > 0 ? nrows : 1);
+        key_hash_rows_parallel(&in->distinct, 1, nrows, in->distinct_hash);
+      }
+    } else if (!distinct && !in->has_numeric) {
+      in->vals = g_new(gdouble, nrows > 0 ? nrows : 1);
+      in->is_null = g_new0(guint8, nrows > 0 ? nrows : 1);
+      if (chunked == NULL || !numeric_column_load(chunked, nrows, in->vals, in->is_null))
+        failed = TRUE;
+      else
+        in->has_numeric = TRUE;
+    }
+    if (chunked != NULL) g_object_unref(chunked);
+  }
+  g_object_unref(schema);
+
+  if (!failed) {
+    for (int c = 0; c < n_inputs; c++) {
+      AggInputColumn *in = &inputs[c];
+      if (in->has_numeric) {
+        in->sum = g_new0(gdouble, gt->n_groups > 0 ? gt->n_groups : 1);
+        in->min = g_new0(gdouble, gt->n_groups > 0 ? gt->n_groups : 1);
+        in->max = g_new0(gdouble, gt->n_groups > 0 ? gt->n_groups : 1);
+        in->count = g_new0(gint64, gt->n_groups > 0 ? gt->n_groups : 1);
+      }
+      if (in->has_distinct)
+        in->n_distinct = g_new0(gint64, gt->n_groups > 0 ? gt->n_groups : 1);
+      if (in->want_approx)
+        in->approx_distinct = g_new0(gint64, gt->n_groups > 0 ? gt->n_groups : 1);
+    }
+
+    /* Split groups into ranges holding roughly equal numbers of rows. */
+    int n_tasks = parallel_thread_count(nrows);
+    if (n_tasks > gt->n_groups) n_tasks = gt->n_groups > 0 ? gt->n_groups : 1;
+    AggGroupTask *tasks = g_new0(AggGroupTask, n_tasks);
+    gint64 per_task = nrows / n_tasks + 1;
+    int t = 0;
+    gint64 acc = 0;
+    tasks[0].g_begin = 0;
+    for (int g = 0; g < gt->n_groups; g++) {
+      acc += gt->group_sizes[g];
+      if (acc >= per_task * (t + 1) && t < n_tasks - 1) {
+        tasks[t].g_end = g + 1;
+        tasks[++t].g_begin = g + 1;
+      }
+    }
+    tasks[t].g_end = gt->n_groups;
+    for (int i = t + 1; i < n_tasks; i++) tasks[i].g_begin = tasks[i].g_end = gt->n_groups;
+    for (int i = 0; i < n_tasks; i++) {
+      tasks[i].gt = gt;
+      tasks[i].inputs = inputs;
+      tasks[i].n_inputs = n_inputs;
+    }
+    parallel_run(agg_group_task_run, tasks, sizeof(AggGroupTask), n_tasks);
+    g_free(tasks);
+
+    for (int a = 0; a < n_aggs; a++) {
+      if (agg_input[a] < 0) {
+        for (int g = 0; g < gt->n_groups; g++) agg_values[a][g] = (gdouble)gt->group_sizes[g];
+        agg_is_int[a] = TRUE;
+        continue;
+      }
+      AggInputColumn *in = &inputs[agg_input[a]];
+      if (strcmp(agg_types[a], "count_distinct") == 0) {
+        for (int g = 0; g < gt->n_groups; g++) agg_values[a][g] = (gdouble)in->n_distinct[g];
+        agg_is_int[a] = TRUE;
+        continue;
+      }
+      if (strcmp(agg_types[a], "approx_count_distinct") == 0) {
+        for (int g = 0; g < gt->n_groups; g++) agg_values[a][g] = (gdouble)in->approx_distinct[g];
+        agg_is_int[a] = TRUE;
+        continue;
+      }
+      gboolean is_sum  = (strcmp(agg_types[a], "sum") == 0);
+      gboolean is_mean = (strcmp(agg_types[a], "mean") == 0);
+      gboolean is_min  = (strcmp(agg_types[a], "min") == 0);
+      gboolean is_max  = (strcmp(agg_types[a], "max") == 0);
+      for (int g = 0; g < gt->n_groups; g++) {
+        gboolean empty = (in->count[g] == 0);
+        if (is_sum) {
+          agg_values[a][g] = in->sum[g];
+          agg_nulls[a][g] = empty;
+        } else if (is_mean) {
+          if (!empty) agg_values[a][g] = in->sum[g] / (gdouble)in->count[g];
+          agg_nulls[a][g] = empty;
+        } else if (is_min || is_max) {
+          if (!empty) agg_values[a][g] = is_min ? in->min[g] : in->max[g];
+          agg_nulls[a][g] = empty;
+        }
+      }
+    }
+  }
+
+  for (int c = 0; c < n_inputs; c++) agg_input_column_free(&inputs[c]);
+  g_free(inputs);
+  g_free(agg_input);
+  g_ptr_array_free(hold, TRUE);
+
+  if (failed) {
+    caml_leave_blocking_section();
+    g_object_unref(held);
     for (int a = 0; a < n_aggs; a++) {
       free(agg_values[a]); free(agg_nulls[a]);
       g_free(agg_types[a]); g_free(col_names[a]); g_free(result_names[a]);
@@ -3220,8 +4975,18 @@ CAMLprim value caml_arrow_group_multi_aggregate(
     gint idx = garrow_schema_get_field_index(orig_schema, gt->key_names[k]);
     GArrowField *orig_field = garrow_schema_get_field(orig_schema, idx);
     GArrowDataType *dtype = garrow_field_get_data_type(orig_field);
+    GArrowChunkedArray *dict_key = dictionary_type_is_string(dtype)
+      ? dictionary_key_column(gt->table, idx, dtype, gt->group_key_values, k, gt->n_groups)
+      : NULL;
 
-    if (GARROW_IS_INT64_DATA_TYPE(dtype) || GARROW_IS_INT32_DATA_TYPE(dtype) ||
+    if (dict_key != NULL) {
+      /* Factor keys keep their levels; the index type may change. */
+      columns[k] = dict_key;
+      GArrowDataType *key_type = garrow_chunked_array_get_value_data_type(dict_key);
+      GArrowField *new_field = garrow_field_new(gt->key_names[k], key_type);
+      fields_list = g_list_append(fields_list, new_field);
+      g_object_unref(key_type);
+    } else if (GARROW_IS_INT64_DATA_TYPE(dtype) || GARROW_IS_INT32_DATA_TYPE(dtype) ||
         GARROW_IS_INT16_DATA_TYPE(dtype) || GARROW_IS_UINT8_DATA_TYPE(dtype) ||
         GARROW_IS_UINT16_DATA_TYPE(dtype) || GARROW_IS_UINT32_DATA_TYPE(dtype) ||
         GARROW_IS_UINT64_DATA_TYPE(dtype)) {
@@ -3349,6 +5114,9 @@ CAMLprim value caml_arrow_group_multi_aggregate(
   free(agg_values); free(agg_nulls); free(agg_is_int);
   free(agg_types); free(col_names); free(result_names);
 
+  caml_leave_blocking_section();
+  g_object_unref(held);
+
   if (result == NULL) {
     if (error) g_error_free(error);
     CAMLreturn(Val_none);
@@ -3524,31 +5292,193 @@ CAMLprim value caml_arrow_int64_array_to_bigarray(value v_array_ptr) {
 }
 
 /* ===================================================================== */
-/* Unary Math Operations (Phase 5 — Week 1)                              */
+/* Column Buffer Views                                                   */
 /* ===================================================================== */
 
-/* Helper: apply a unary math operation element-by-element on a numeric column.
-   op_code: 0=sqrt, 1=abs, 2=log, 3=exp.
-   Returns a new GArrowChunkedArray* with the results, or NULL on failure. */
-static GArrowChunkedArray *
-apply_unary_math_op(GArrowChunkedArray *chunked, int op_code)
-{
-  GError *error = NULL;
-  guint n_chunks = garrow_chunked_array_get_n_chunks(chunked);
+/* Custom block owning one reference to a GArrowArray. Column buffer views
+   keep it next to their Bigarrays so the Arrow memory the Bigarrays point
+   into stays alive for as long as the view itself is reachable. */
+#define Arrow_array_owner_val(v) (*((GArrowArray **)Data_custom_val(v)))
 
-  GList *result_chunks = NULL;
-  gboolean ok = TRUE;
+static void finalize_arrow_array_owner(value v) {
+  GArrowArray *array = Arrow_array_owner_val(v);
+  if (array) g_object_unref(array);
+  Arrow_array_owner_val(v) = NULL;
+}
 
-  for (guint c = 0; c < n_chunks && ok; c++) {
-    GArrowArray *chunk = garrow_chunked_array_get_chunk(chunked, c);
-    gint64 length = garrow_array_get_length(chunk);
+static struct custom_operations arrow_array_owner_ops = {
+  "org.tstats.arrow_array_owner",
+  finalize_arrow_array_owner,
+  custom_compare_default,
+  custom_hash_default,
+  custom_serialize_default,
+  custom_deserialize_default,
+  custom_compare_ext_default,
+  custom_fixed_length_default
+};
 
-    GArrowDoubleArrayBuilder *builder = garrow_double_array_builder_new();
+/* Fetch a named column as a single contiguous GArrowArray.
+   Single-chunk columns return the chunk itself; multi-chunk columns are
+   combined once. The caller owns the returned reference. */
+static GArrowArray *column_as_single_array(GArrowTable *table, const char *name) {
+  GArrowSchema *schema = garrow_table_get_schema(table);
+  gint idx = garrow_schema_get_field_index(schema, name);
+  g_object_unref(schema);
+  if (idx < 0) return NULL;
 
-    for (gint64 i = 0; i < length; i++) {
-      if (garrow_array_is_null(chunk, i)) {
-        garrow_array_builder_append_null(GARROW_ARRAY_BUILDER(builder), &error);
-      } else {
+  GArrowChunkedArray *chunked = garrow_table_get_column_data(table, idx);
+  if (chunked == NULL) return NULL;
+
+  GArrowArray *array = NULL;
+  guint n_chunks = garrow_chunked_array_get_n_chunks(chunked);
+  if (n_chunks == 1) {
+    /* get_chunk hands back a fresh wrapper we already own. */
+    array = garrow_chunked_array_get_chunk(chunked, 0);
+  } else if (n_chunks > 1) {
+    GError *error = NULL;
+    array = garrow_chunked_array_combine(chunked, &error);
+    if (error) g_error_free(error);
+  }
+  g_object_unref(chunked);
+  return array;
+}
+
+/* Build Some (owner, values, validity, bit_offset, null_count) for a
+   Float64 (kind 0) or Int64 (kind 1) column, or None when the column is
+   missing, has another physical type, is empty, or its buffers are too
+   short for its declared length.
+   values   — Bigarray over the value buffer, already advanced past the
+              array offset so index i is row i.
+   validity — Some bitmap Bigarray (uint8, LSB-first as in Arrow) when the
+              column has nulls, None otherwise. Row i is valid when bit
+              (bit_offset + i) is set.
+   Neither Bigarray owns its memory; both stay valid while owner is
+   reachable. */
+static value column_buffers_impl(value v_ptr, value v_name, int kind) {
+  CAMLparam2(v_ptr, v_name);
+  CAMLlocal5(v_result, v_tuple, v_owner, v_values, v_validity);
+  CAMLlocal1(v_bitmap);
+
+  GArrowTable *table = (GArrowTable *)Nativeint_val(v_ptr);
+  GArrowArray *array = column_as_single_array(table, String_val(v_name));
+  if (array == NULL) CAMLreturn(Val_none);
+
+  gboolean type_ok = (kind == 0)
+    ? GARROW_IS_DOUBLE_ARRAY(array)
+    : GARROW_IS_INT64_ARRAY(array);
+  gint64 length = garrow_array_get_length(array);
+  gint64 offset = garrow_array_get_offset(array);
+  if (!type_ok || length <= 0 || offset < 0 ||
+      length > (gint64)CAML_INTNAT_MAX ||
+      (gsize)(offset + length) > G_MAXSIZE / 8) {
+    g_object_unref(array);
+    CAMLreturn(Val_none);
+  }
+
+  GArrowBuffer *buffer =
+    garrow_primitive_array_get_data_buffer(GARROW_PRIMITIVE_ARRAY(array));
+  if (buffer == NULL) {
+    g_object_unref(array);
+    CAMLreturn(Val_none);
+  }
+  GBytes *bytes = garrow_buffer_get_data(buffer);
+  gsize size = 0;
+  const guint8 *data = (const guint8 *)g_bytes_get_data(bytes, &size);
+  g_bytes_unref(bytes);
+  g_object_unref(buffer);
+  /* Both element types are 8 bytes wide. */
+  if (data == NULL || size < (gsize)(offset + length) * 8) {
+    g_object_unref(array);
+    CAMLreturn(Val_none);
+  }
+
+  gint64 null_count = garrow_array_get_n_nulls(array);
+  const guint8 *bitmap = NULL;
+  gsize bitmap_len = 0;
+  if (null_count > 0) {
+    GArrowBuffer *bm_buffer = garrow_array_get_null_bitmap(array);
+    if (bm_buffer != NULL) {
+      GBytes *bm_bytes = garrow_buffer_get_data(bm_buffer);
+      gsize bm_size = 0;
+      bitmap = (const guint8 *)g_bytes_get_data(bm_bytes, &bm_size);
+      bitmap_len = (gsize)((offset + length + 7) / 8);
+      g_bytes_unref(bm_bytes);
+      g_object_unref(bm_buffer);
+      if (bm_size < bitmap_len) bitmap = NULL;
+    }
+    if (bitmap == NULL) {
+      g_object_unref(array);
+      CAMLreturn(Val_none);
+    }
+  }
+
+  /* The owner takes over the array reference from here on. */
+  v_owner = caml_alloc_custom(&arrow_array_owner_ops, sizeof(GArrowArray *), 0, 1);
+  Arrow_array_owner_val(v_owner) = array;
+
+  intnat dims[1] = { (intnat)length };
+  void *values_ptr = (void *)(data + offset * 8);
+  v_values = caml_ba_alloc(
+    (kind == 0 ? CAML_BA_FLOAT64 : CAML_BA_INT64) | CAML_BA_C_LAYOUT | CAML_BA_EXTERNAL,
+    1, values_ptr, dims);
+
+  if (bitmap != NULL) {
+    intnat bm_dims[1] = { (intnat)bitmap_len };
+    v_bitmap = caml_ba_alloc(
+      CAML_BA_UINT8 | CAML_BA_C_LAYOUT | CAML_BA_EXTERNAL,
+      1, (void *)bitmap, bm_dims);
+    v_validity = caml_alloc(1, 0); /* Some(...) */
+    Store_field(v_validity, 0, v_bitmap);
+  } else {
+    v_validity = Val_none;
+  }
+
+  v_tuple = caml_alloc(5, 0);
+  Store_field(v_tuple, 0, v_owner);
+  Store_field(v_tuple, 1, v_values);
+  Store_field(v_tuple, 2, v_validity);
+  Store_field(v_tuple, 3, Val_long(offset));
+  Store_field(v_tuple, 4, Val_long(null_count));
+
+  v_result = caml_alloc(1, 0); /* Some(...) */
+  Store_field(v_result, 0, v_tuple);
+  CAMLreturn(v_result);
+}
+
+CAMLprim value caml_arrow_float64_column_buffers(value v_ptr, value v_name) {
+  return column_buffers_impl(v_ptr, v_name, 0);
+}
+
+CAMLprim value caml_arrow_int64_column_buffers(value v_ptr, value v_name) {
+  return column_buffers_impl(v_ptr, v_name, 1);
+}
+
+/* ===================================================================== */
+/* Unary Math Operations (Phase 5 — Week 1)                              */
+/* ===================================================================== */
+
+/* Helper: apply a unary math operation element-by-element on a numeric column.
+   op_code: 0=sqrt, 1=abs, 2=log, 3=exp.
+   Returns a new GArrowChunkedArray* with the results, or NULL on failure. */
+static GArrowChunkedArray *
+apply_unary_math_op(GArrowChunkedArray *chunked, int op_code)
+{
+  GError *error = NULL;
+  guint n_chunks = garrow_chunked_array_get_n_chunks(chunked);
+
+  GList *result_chunks = NULL;
+  gboolean ok = TRUE;
+
+  for (guint c = 0; c < n_chunks && ok; c++) {
+    GArrowArray *chunk = garrow_chunked_array_get_chunk(chunked, c);
+    gint64 length = garrow_array_get_length(chunk);
+
+    GArrowDoubleArrayBuilder *builder = garrow_double_array_builder_new();
+
+    for (gint64 i = 0; i < length; i++) {
+      if (garrow_array_is_null(chunk, i)) {
+        garrow_array_builder_append_null(GARROW_ARRAY_BUILDER(builder), &error);
+      } else {
         gdouble val;
         if (GARROW_IS_DOUBLE_ARRAY(chunk)) {
           val = garrow_double_array_get_value(GARROW_DOUBLE_ARRAY(chunk), i);
@@ -3960,148 +5890,715 @@ CAMLprim value caml_arrow_column_null_mask(value v_ptr, value v_col_name) {
 /* IPC Read/Write                                                       */
 /* ===================================================================== */
 
-/* Read Arrow table from IPC file */
+/* Read Arrow table from IPC file. The read runs outside the OCaml
+   runtime lock. The file is mapped read-only and, for uncompressed files,
+   the table's buffers point into the mapping, so nothing is copied and
+   the pages are shared with other readers of the same file. */
+static GArrowTable *
+ipc_table_read_mapped(const gchar *path, GError **error) {
+  GArrowTable *table = NULL;
+  GArrowMemoryMappedInputStream *input =
+    garrow_memory_mapped_input_stream_new(path, error);
+  if (input != NULL) {
+    /* Feather V2 IS Arrow IPC File format */
+    GArrowFeatherFileReader *reader =
+      garrow_feather_file_reader_new(GARROW_SEEKABLE_INPUT_STREAM(input), error);
+    if (reader != NULL) {
+      table = garrow_feather_file_reader_read(reader, error);
+      g_object_unref(reader);
+    }
+    g_object_unref(input);
+  }
+  return table;
+}
+
 CAMLprim value caml_arrow_read_ipc(value v_path) {
   CAMLparam1(v_path);
   CAMLlocal1(v_result);
 
-  const char *path = String_val(v_path);
+  gchar *path = g_strdup(String_val(v_path));
   GError *error = NULL;
+  GArrowTable *table = NULL;
 
-  GArrowMemoryMappedInputStream *input =
-    garrow_memory_mapped_input_stream_new(path, &error);
-  if (input == NULL) {
-    if (error) g_error_free(error);
-    CAMLreturn(Val_none);
-  }
+  caml_enter_blocking_section();
+  table = ipc_table_read_mapped(path, &error);
+  caml_leave_blocking_section();
 
-  /* Feather V2 IS Arrow IPC File format */
-  GArrowFeatherFileReader *reader =
-    garrow_feather_file_reader_new(GARROW_SEEKABLE_INPUT_STREAM(input), &error);
-  if (reader == NULL) {
-    g_object_unref(input);
-    if (error) g_error_free(error);
-    CAMLreturn(Val_none);
+  g_free(path);
+  if (error) g_error_free(error);
+  if (table == NULL) CAMLreturn(Val_none);
+
+  /* Wrap as Some(nativeint) */
+  v_result = caml_alloc(1, 0);  /* Some(...) */
+  Store_field(v_result, 0, caml_copy_nativeint((intnat)table));
+  CAMLreturn(v_result);
+}
+
+/* Codec codes shared with Arrow_io.compression_code. */
+static GArrowCompressionType compression_of_code(int code) {
+  switch (code) {
+    case 1: return GARROW_COMPRESSION_TYPE_SNAPPY;
+    case 2: return GARROW_COMPRESSION_TYPE_GZIP;
+    case 3: return GARROW_COMPRESSION_TYPE_BROTLI;
+    case 4: return GARROW_COMPRESSION_TYPE_ZSTD;
+    case 5: return GARROW_COMPRESSION_TYPE_LZ4;
+    default: return GARROW_COMPRESSION_TYPE_UNCOMPRESSED;
   }
+}
 
-  GArrowTable *table = garrow_feather_file_reader_read(reader, &error);
-  g_object_unref(reader);
-  g_object_unref(input);
+/* The IPC format only accepts LZ4 in its frame format; Parquet takes raw
+   LZ4 blocks (written as LZ4_RAW), so only the IPC writer remaps it. */
+static GArrowCompressionType ipc_compression_of_code(int code) {
+  return code == 5 ? GARROW_COMPRESSION_TYPE_LZ4_FRAME : compression_of_code(code);
+}
 
-  if (table == NULL) {
-    if (error) g_error_free(error);
-    CAMLreturn(Val_none);
+/* Write Arrow table to IPC file, compressing record batch buffers with
+   codec [v_codec] (0 = uncompressed). Compressed files go through the
+   Feather V2 writer, which is the IPC file format with a codec; readers
+   then decompress instead of mapping the buffers in place. Must be called
+   outside the OCaml runtime lock. */
+static gboolean write_ipc_table(GArrowTable *table, const gchar *path,
+                                int codec, GError **error) {
+  gboolean ok = FALSE;
+  GArrowFileOutputStream *output =
+    garrow_file_output_stream_new(path, FALSE, error);
+  if (output != NULL) {
+    if (codec == 0) {
+      GArrowSchema *schema = garrow_table_get_schema(table);
+      GArrowRecordBatchFileWriter *writer =
+        garrow_record_batch_file_writer_new(GARROW_OUTPUT_STREAM(output), schema, error);
+      g_object_unref(schema);
+
+      if (writer != NULL) {
+        ok = garrow_record_batch_writer_write_table(GARROW_RECORD_BATCH_WRITER(writer), table, error);
+        garrow_record_batch_writer_close(GARROW_RECORD_BATCH_WRITER(writer), NULL);
+        g_object_unref(writer);
+      }
+    } else {
+      GArrowFeatherWriteProperties *props = garrow_feather_write_properties_new();
+      g_object_set(props, "compression", ipc_compression_of_code(codec), NULL);
+      ok = garrow_table_write_as_feather(table, GARROW_OUTPUT_STREAM(output), props, error);
+      g_object_unref(props);
+    }
+    g_object_unref(output);
   }
+  return ok;
+}
 
-  /* Wrap as Some(nativeint) */
-  v_result = caml_alloc(1, 0);  /* Some(...) */
-  Store_field(v_result, 0, caml_copy_nativeint((intnat)table));
+/* Write Arrow table to IPC file with codec [v_codec]. The write runs
+   outside the OCaml runtime lock. Returns Ok () or Error(message); the
+   caller decides how to report. */
+CAMLprim value caml_arrow_write_ipc_compressed(value v_ptr, value v_path, value v_codec) {
+  CAMLparam3(v_ptr, v_path, v_codec);
+  CAMLlocal2(v_result, v_msg);
+  GArrowTable *table = (GArrowTable *)Nativeint_val(v_ptr);
+  gchar *path = g_strdup(String_val(v_path));
+  int codec = Int_val(v_codec);
+  GError *error = NULL;
+
+  g_object_ref(table);
+  caml_enter_blocking_section();
+  gboolean ok = write_ipc_table(table, path, codec, &error);
+  caml_leave_blocking_section();
+  g_object_unref(table);
+  g_free(path);
+
+  if (ok) {
+    v_result = caml_alloc(1, 0);  /* Ok () */
+    Store_field(v_result, 0, Val_unit);
+  } else {
+    v_msg = caml_copy_string(error != NULL ? error->message : "unknown error");
+    v_result = caml_alloc(1, 1);  /* Error(...) */
+    Store_field(v_result, 0, v_msg);
+  }
+  if (error) g_error_free(error);
   CAMLreturn(v_result);
 }
 
-/* Write Arrow table to IPC file */
+/* Write Arrow table to IPC file, uncompressed. */
 CAMLprim value caml_arrow_write_ipc(value v_ptr, value v_path) {
   CAMLparam2(v_ptr, v_path);
   GArrowTable *table = (GArrowTable *)Nativeint_val(v_ptr);
-  const char *path = String_val(v_path);
+  gchar *path = g_strdup(String_val(v_path));
   GError *error = NULL;
 
-  GArrowFileOutputStream *output =
-    garrow_file_output_stream_new(path, FALSE, &error);
-  if (output == NULL) {
-    if (error) g_error_free(error);
-    CAMLreturn(Val_bool(FALSE));
-  }
+  g_object_ref(table);
+  caml_enter_blocking_section();
+  gboolean ok = write_ipc_table(table, path, 0, &error);
+  caml_leave_blocking_section();
+  g_object_unref(table);
+  g_free(path);
+
+  if (error) g_error_free(error);
+  CAMLreturn(Val_bool(ok));
+}
 
+/* Write [table] to a Parquet file with [props] (NULL for Arrow's defaults)
+   in row groups of [row_group_size] rows. Must be called outside the OCaml
+   runtime lock; on failure *stage names the step that failed. */
+static gboolean write_parquet_table(GArrowTable *table, const gchar *path,
+                                    GParquetWriterProperties *props,
+                                    gint64 row_group_size,
+                                    const char **stage, GError **error) {
+  gboolean ok = FALSE;
+  *stage = "gparquet_arrow_file_writer_new_path";
   GArrowSchema *schema = garrow_table_get_schema(table);
-  GArrowRecordBatchFileWriter *writer =
-    garrow_record_batch_file_writer_new(GARROW_OUTPUT_STREAM(output), schema, &error);
+  GParquetArrowFileWriter *writer =
+    gparquet_arrow_file_writer_new_path(schema, path, props, error);
+  if (writer != NULL) {
+    *stage = "gparquet_arrow_file_writer_write_table";
+    ok = gparquet_arrow_file_writer_write_table(writer, table, row_group_size, error);
+    gparquet_arrow_file_writer_close(writer, NULL);
+    g_object_unref(writer);
+  }
   g_object_unref(schema);
+  return ok;
+}
 
-  if (writer == NULL) {
-    g_object_unref(output);
-    if (error) g_error_free(error);
-    CAMLreturn(Val_bool(FALSE));
+static void report_parquet_failure(const char *stage, GError *error) {
+  if (error) {
+    fprintf(stderr, "%s failed: %s\n", stage, error->message);
+  } else {
+    fprintf(stderr, "%s failed: unknown error\n", stage);
   }
+}
+
+/* Write Arrow table to Parquet file. The write runs outside the OCaml
+   runtime lock; diagnostics are printed once the lock is re-acquired. */
+CAMLprim value caml_arrow_write_parquet(value v_ptr, value v_path) {
+  CAMLparam2(v_ptr, v_path);
+  GArrowTable *table = (GArrowTable *)Nativeint_val(v_ptr);
+  gchar *path = g_strdup(String_val(v_path));
+  GError *error = NULL;
+  const char *stage = NULL;
 
-  gboolean ok = garrow_record_batch_writer_write_table(GARROW_RECORD_BATCH_WRITER(writer), table, &error);
-  garrow_record_batch_writer_close(GARROW_RECORD_BATCH_WRITER(writer), NULL);
-  g_object_unref(writer);
-  g_object_unref(output);
+  g_object_ref(table);
+  caml_enter_blocking_section();
+  gboolean ok = write_parquet_table(table, path, NULL, 65536, &stage, &error);
+  caml_leave_blocking_section();
+  g_object_unref(table);
 
-  if (!ok && error) g_error_free(error);
+  g_free(path);
+  if (!ok) report_parquet_failure(stage, error);
+  if (error) g_error_free(error);
   CAMLreturn(Val_bool(ok));
 }
 
-/* Write Arrow table to Parquet file */
-CAMLprim value caml_arrow_write_parquet(value v_ptr, value v_path) {
-  CAMLparam2(v_ptr, v_path);
+/* Write Arrow table to Parquet file with explicit writer properties.
+   [v_opts] is an Arrow_ffi.parquet_write_options record:
+   { codec; row_group_size; dictionary; data_page_size } where
+   data_page_size <= 0 keeps Arrow's default. Column statistics are
+   always written, so readers can skip row groups by min/max. */
+CAMLprim value caml_arrow_write_parquet_with_options(value v_ptr, value v_path, value v_opts) {
+  CAMLparam3(v_ptr, v_path, v_opts);
   GArrowTable *table = (GArrowTable *)Nativeint_val(v_ptr);
-  const char *path = String_val(v_path);
+  gchar *path = g_strdup(String_val(v_path));
+  int codec = Int_val(Field(v_opts, 0));
+  gint64 row_group_size = Long_val(Field(v_opts, 1));
+  gboolean dictionary = Bool_val(Field(v_opts, 2));
+  gint64 data_page_size = Long_val(Field(v_opts, 3));
   GError *error = NULL;
+  const char *stage = NULL;
+
+  g_object_ref(table);
+  caml_enter_blocking_section();
+  GParquetWriterProperties *props = gparquet_writer_properties_new();
+  gparquet_writer_properties_set_compression(props, compression_of_code(codec), NULL);
+  if (dictionary)
+    gparquet_writer_properties_enable_dictionary(props, NULL);
+  else
+    gparquet_writer_properties_disable_dictionary(props, NULL);
+  gparquet_writer_properties_set_max_row_group_length(props, row_group_size);
+  if (data_page_size > 0)
+    gparquet_writer_properties_set_data_page_size(props, data_page_size);
+  gboolean ok = write_parquet_table(table, path, props, row_group_size, &stage, &error);
+  g_object_unref(props);
+  caml_leave_blocking_section();
+  g_object_unref(table);
+
+  g_free(path);
+  if (!ok) report_parquet_failure(stage, error);
+  if (error) g_error_free(error);
+  CAMLreturn(Val_bool(ok));
+}
+
+/* ===================================================================== */
+/* Scan Reading (projection + predicate pushdown)                        */
+/* ===================================================================== */
+
+/* One conjunct of a scan predicate: <column> <op> <scalar>.
+   op_code: 0=eq, 1=lt, 2=gt, 3=le, 4=ge (same codes as compare_scalar). */
+typedef struct {
+  gchar *column;
+  int op_code;
+  gdouble scalar;
+  gboolean is_int;   /* the literal is an integer, held exactly in iscalar */
+  gint64 iscalar;
+} ScanPredicate;
+
+static gboolean scan_compare(gdouble val, int op_code, gdouble scalar) {
+  switch (op_code) {
+    case 0: return val == scalar;
+    case 1: return val < scalar;
+    case 2: return val > scalar;
+    case 3: return val <= scalar;
+    case 4: return val >= scalar;
+    default: return FALSE;
+  }
+}
+
+/* Order of an integer against a double, exactly: -1, 0 or 1 as `v` is
+   below, equal to or above `s`, and 2 when `s` is NaN. Casting `v` to
+   double instead rounds above 2^53, which could make distinct values
+   compare equal. */
+static int scan_order_i64(gint64 v, gdouble s) {
+  if (isnan(s)) return 2;
+  if (s >= 9223372036854775808.0) return -1;
+  if (s < -9223372036854775808.0) return 1;
+  gdouble f = floor(s);
+  gint64 t = (gint64)f;
+  if (v != t) return v < t ? -1 : 1;
+  return s > f ? -1 : 0;
+}
+
+/* Order of an integer column value against the predicate's literal. */
+static int scan_order_int(gint64 v, const ScanPredicate *pred) {
+  if (pred->is_int) return (v > pred->iscalar) - (v < pred->iscalar);
+  return scan_order_i64(v, pred->scalar);
+}
+
+static gboolean scan_compare_int(gint64 val, const ScanPredicate *pred) {
+  int order = scan_order_int(val, pred);
+  if (order == 2) return FALSE;
+  switch (pred->op_code) {
+    case 0: return order == 0;
+    case 1: return order < 0;
+    case 2: return order > 0;
+    case 3: return order <= 0;
+    case 4: return order >= 0;
+    default: return FALSE;
+  }
+}
+
+/* Copy an OCaml (string * int * float * int option) list into a
+   ScanPredicate array so the scan itself can run without touching the
+   OCaml heap. */
+static ScanPredicate *scan_predicates_of_list(value v_preds, int *n_out) {
+  int n = 0;
+  for (value it = v_preds; it != Val_emptylist; it = Field(it, 1)) n++;
+  *n_out = n;
+  if (n == 0) return NULL;
+  ScanPredicate *preds = g_new0(ScanPredicate, n);
+  int i = 0;
+  for (value it = v_preds; it != Val_emptylist; it = Field(it, 1), i++) {
+    value v_pred = Field(it, 0);
+    preds[i].column = g_strdup(String_val(Field(v_pred, 0)));
+    preds[i].op_code = Int_val(Field(v_pred, 1));
+    preds[i].scalar = Double_val(Field(v_pred, 2));
+    preds[i].is_int = Is_block(Field(v_pred, 3));
+    if (preds[i].is_int) preds[i].iscalar = Long_val(Field(Field(v_pred, 3), 0));
+  }
+  return preds;
+}
+
+static void scan_predicates_free(ScanPredicate *preds, int n) {
+  for (int i = 0; i < n; i++) g_free(preds[i].column);
+  g_free(preds);
+}
+
+static gboolean is_numeric_data_type(GArrowDataType *dtype) {
+  return GARROW_IS_INT8_DATA_TYPE(dtype) || GARROW_IS_INT16_DATA_TYPE(dtype) ||
+         GARROW_IS_INT32_DATA_TYPE(dtype) || GARROW_IS_INT64_DATA_TYPE(dtype) ||
+         GARROW_IS_UINT8_DATA_TYPE(dtype) || GARROW_IS_UINT16_DATA_TYPE(dtype) ||
+         GARROW_IS_UINT32_DATA_TYPE(dtype) || GARROW_IS_UINT64_DATA_TYPE(dtype) ||
+         GARROW_IS_FLOAT_DATA_TYPE(dtype) || GARROW_IS_DOUBLE_DATA_TYPE(dtype);
+}
+
+/* Resolve every predicate column against a schema. Returns NULL on success or
+   a newly allocated message naming the first missing / non-numeric column. */
+static gchar *scan_check_predicates(GArrowSchema *schema,
+                                    const ScanPredicate *preds, int n_preds) {
+  for (int p = 0; p < n_preds; p++) {
+    gint idx = garrow_schema_get_field_index(schema, preds[p].column);
+    if (idx < 0)
+      return g_strdup_printf("Column `%s` not found.", preds[p].column);
+    GArrowField *field = garrow_schema_get_field(schema, idx);
+    gboolean numeric = is_numeric_data_type(garrow_field_get_data_type(field));
+    g_object_unref(field);
+    if (!numeric)
+      return g_strdup_printf(
+        "Filter column `%s` must be numeric to be pushed down.", preds[p].column);
+  }
+  return NULL;
+}
+
+/* Keep the rows of `table` that satisfy every predicate. Rows where a
+   predicate column is null are dropped. Returns a new reference (the input
+   itself, re-reffed, when there is nothing to filter) or NULL on error.
+   Runs without the OCaml runtime lock. */
+static GArrowTable *filter_table_by_predicates(GArrowTable *table,
+                                               const ScanPredicate *preds,
+                                               int n_preds, GError **error) {
+  if (n_preds == 0) return g_object_ref(table);
+
+  gint64 nrows = garrow_table_get_n_rows(table);
+  gboolean *keep = g_new(gboolean, nrows > 0 ? nrows : 1);
+  for (gint64 i = 0; i < nrows; i++) keep[i] = TRUE;
 
   GArrowSchema *schema = garrow_table_get_schema(table);
+  for (int p = 0; p < n_preds; p++) {
+    gint idx = garrow_schema_get_field_index(schema, preds[p].column);
+    GArrowChunkedArray *col =
+      idx < 0 ? NULL : garrow_table_get_column_data(table, idx);
+    if (col == NULL) {
+      for (gint64 i = 0; i < nrows; i++) keep[i] = FALSE;
+      continue;
+    }
+    gint64 row = 0;
+    guint n_chunks = garrow_chunked_array_get_n_chunks(col);
+    for (guint c = 0; c < n_chunks; c++) {
+      GArrowArray *chunk = garrow_chunked_array_get_chunk(col, c);
+      gint64 len = garrow_array_get_length(chunk);
+      for (gint64 i = 0; i < len; i++, row++) {
+        if (!keep[row]) continue;
+        gdouble val = 0.0;
+        if (garrow_array_is_null(chunk, i)) {
+          keep[row] = FALSE;
+        } else if (GARROW_IS_INT64_ARRAY(chunk)) {
+          keep[row] = scan_compare_int(garrow_int64_array_get_value(GARROW_INT64_ARRAY(chunk), i),
+                                       &preds[p]);
+        } else if (!read_numeric_array_value(chunk, i, &val)) {
+          keep[row] = FALSE;
+        } else {
+          keep[row] = scan_compare(val, preds[p].op_code, preds[p].scalar);
+        }
+      }
+      g_object_unref(chunk);
+    }
+    g_object_unref(col);
+  }
+  g_object_unref(schema);
 
-  GParquetArrowFileWriter *writer =
-    gparquet_arrow_file_writer_new_path(schema, path, NULL, &error);
-  if (writer == NULL) {
-    g_object_unref(schema);
-    if (error) {
-      fprintf(stderr, "gparquet_arrow_file_writer_new_path failed: %s\n", error->message);
-      g_error_free(error);
-    } else {
-      fprintf(stderr, "gparquet_arrow_file_writer_new_path failed: unknown error\n");
+  GArrowBooleanArrayBuilder *builder = garrow_boolean_array_builder_new();
+  GArrowTable *result = NULL;
+  if (garrow_boolean_array_builder_append_values(builder, keep, nrows, NULL, 0, error)) {
+    GArrowArray *mask = garrow_array_builder_finish(GARROW_ARRAY_BUILDER(builder), error);
+    if (mask != NULL) {
+      result = garrow_table_filter(table, GARROW_BOOLEAN_ARRAY(mask), NULL, error);
+      g_object_unref(mask);
     }
-    CAMLreturn(Val_bool(FALSE));
   }
+  g_object_unref(builder);
+  g_free(keep);
+  return result;
+}
 
-  gboolean ok = gparquet_arrow_file_writer_write_table(writer, table, 65536, &error);
-  gparquet_arrow_file_writer_close(writer, NULL);
-  g_object_unref(writer);
-  g_object_unref(schema);
+/* Ascending order of schema field indices, so a projected read returns its
+   columns in file order whatever order they were requested in. */
+static gint compare_field_index(gconstpointer a, gconstpointer b, gpointer user_data) {
+  (void)user_data;
+  gint x = *(const gint *)a, y = *(const gint *)b;
+  return (x > y) - (x < y);
+}
 
-  if (!ok) {
-    if (error) {
-      fprintf(stderr, "gparquet_arrow_file_writer_write_table failed: %s\n", error->message);
-      g_error_free(error);
+/* Decide from row-group statistics whether no row of the group can satisfy
+   the predicate (TRUE = the group can be skipped). Missing statistics never
+   skip. */
+static gboolean row_group_excluded(GParquetRowGroupMetadata *rg, gint column_index,
+                                   const ScanPredicate *pred) {
+  GError *error = NULL;
+  GParquetColumnChunkMetadata *chunk =
+    gparquet_row_group_metadata_get_column_chunk(rg, column_index, &error);
+  if (chunk == NULL) {
+    if (error) g_error_free(error);
+    return FALSE;
+  }
+  GParquetStatistics *stats = gparquet_column_chunk_metadata_get_statistics(chunk);
+  g_object_unref(chunk);
+  if (stats == NULL) return FALSE;
+
+  /* Integer statistics are compared as integers; only float columns go
+     through doubles. */
+  gboolean have = gparquet_statistics_has_min_max(stats);
+  gboolean integral = FALSE;
+  gdouble lo = 0.0, hi = 0.0;
+  gint64 ilo = 0, ihi = 0;
+  if (have) {
+    if (GPARQUET_IS_DOUBLE_STATISTICS(stats)) {
+      lo = gparquet_double_statistics_get_min(GPARQUET_DOUBLE_STATISTICS(stats));
+      hi = gparquet_double_statistics_get_max(GPARQUET_DOUBLE_STATISTICS(stats));
+    } else if (GPARQUET_IS_FLOAT_STATISTICS(stats)) {
+      lo = gparquet_float_statistics_get_min(GPARQUET_FLOAT_STATISTICS(stats));
+      hi = gparquet_float_statistics_get_max(GPARQUET_FLOAT_STATISTICS(stats));
+    } else if (GPARQUET_IS_INT64_STATISTICS(stats)) {
+      integral = TRUE;
+      ilo = gparquet_int64_statistics_get_min(GPARQUET_INT64_STATISTICS(stats));
+      ihi = gparquet_int64_statistics_get_max(GPARQUET_INT64_STATISTICS(stats));
+    } else if (GPARQUET_IS_INT32_STATISTICS(stats)) {
+      integral = TRUE;
+      ilo = gparquet_int32_statistics_get_min(GPARQUET_INT32_STATISTICS(stats));
+      ihi = gparquet_int32_statistics_get_max(GPARQUET_INT32_STATISTICS(stats));
     } else {
-      fprintf(stderr, "gparquet_arrow_file_writer_write_table failed: unknown error\n");
+      have = FALSE;
     }
   }
-  CAMLreturn(Val_bool(ok));
+  g_object_unref(stats);
+  if (!have) return FALSE;
+
+  gdouble s = pred->scalar;
+  if (integral) {
+    int at_lo = scan_order_int(ilo, pred), at_hi = scan_order_int(ihi, pred);
+    if (at_lo == 2) return FALSE;
+    switch (pred->op_code) {
+      case 0: return at_lo > 0 || at_hi < 0;
+      case 1: return at_lo >= 0;
+      case 2: return at_hi <= 0;
+      case 3: return at_lo > 0;
+      case 4: return at_hi < 0;
+      default: return FALSE;
+    }
+  }
+  switch (pred->op_code) {
+    case 0: return s < lo || s > hi;
+    case 1: return lo >= s;
+    case 2: return hi <= s;
+    case 3: return lo > s;
+    case 4: return hi < s;
+    default: return FALSE;
+  }
 }
 
-/* Create a native Arrow table from a list of (name, type_tag, timezone, array)
-   tuples.
-   type_tag: 0=Int64, 1=Float64, 2=Boolean, 3=String, 4=Dictionary,
-             5=List, 6=Null, 7=Date, 8=Timestamp.
-   array is an OCaml option array (None = null, Some x = value). */
-CAMLprim value caml_arrow_table_new(value v_cols) {
-  CAMLparam1(v_cols);
-  CAMLlocal4(v_iter, v_col, v_arr, v_res);
-  GError *error = NULL;
+static value scan_result_ok(GArrowTable *table) {
+  CAMLparam0();
+  CAMLlocal1(v_result);
+  v_result = caml_alloc(1, 0); /* Ok(...) */
+  Store_field(v_result, 0, caml_copy_nativeint((intnat)table));
+  CAMLreturn(v_result);
+}
 
-  GList *fields = NULL;
-  GList *columns = NULL;
-  
-  v_iter = v_cols;
-  while (v_iter != Val_emptylist) {
-    v_col = Field(v_iter, 0);
-    const char *name = String_val(Field(v_col, 0));
-    int type_tag = Int_val(Field(v_col, 1));
-    value v_time_zone = Field(v_col, 2);
-    v_arr = Field(v_col, 3);
-    int n_rows = Wosize_val(v_arr);
-    
-    GArrowDataType *dtype = NULL;
-    GArrowArrayBuilder *builder = NULL;
+static value scan_result_error(const char *message) {
+  CAMLparam0();
+  CAMLlocal2(v_result, v_msg);
+  v_msg = caml_copy_string(message);
+  v_result = caml_alloc(1, 1); /* Error(...) */
+  Store_field(v_result, 0, v_msg);
+  CAMLreturn(v_result);
+}
 
-    switch (type_tag) {
-      case 0: // Int64
-        dtype = (GArrowDataType *)garrow_int64_data_type_new();
-        builder = (GArrowArrayBuilder *)garrow_int64_array_builder_new();
-        for (int i = 0; i < n_rows; i++) {
-          value v_opt = Field(v_arr, i);
+/* Read a Parquet file one row group at a time.
+   Args: path, columns (empty list = all), predicates as (column, op_code,
+   scalar) conjuncts.
+   Only the requested columns plus the predicate columns are decoded. Row
+   groups whose min/max statistics rule out the predicate are never read,
+   and every decoded row group is filtered before the next one is read, so
+   peak memory is bounded by the result plus one row group.
+   Returns Ok table_ptr or Error message. The returned table may carry
+   predicate-only columns; the caller projects them away. */
+CAMLprim value caml_arrow_read_parquet_scan(value v_path, value v_columns, value v_preds) {
+  CAMLparam3(v_path, v_columns, v_preds);
+
+  gchar *path = g_strdup(String_val(v_path));
+  int n_cols = 0;
+  for (value it = v_columns; it != Val_emptylist; it = Field(it, 1)) n_cols++;
+  gchar **columns = g_new0(gchar *, n_cols + 1);
+  {
+    int i = 0;
+    for (value it = v_columns; it != Val_emptylist; it = Field(it, 1), i++)
+      columns[i] = g_strdup(String_val(Field(it, 0)));
+  }
+  int n_preds = 0;
+  ScanPredicate *preds = scan_predicates_of_list(v_preds, &n_preds);
+
+  GError *error = NULL;
+  gchar *message = NULL;
+  GArrowTable *result = NULL;
+
+  caml_enter_blocking_section();
+
+  GParquetArrowFileReader *reader = gparquet_arrow_file_reader_new_path(path, &error);
+  GArrowSchema *schema = reader ? gparquet_arrow_file_reader_get_schema(reader, &error) : NULL;
+  GParquetFileMetadata *metadata = NULL;
+  gint *indices = NULL;
+  gint n_indices = 0;
+
+  if (schema != NULL) {
+    message = scan_check_predicates(schema, preds, n_preds);
+    gint n_fields = garrow_schema_n_fields(schema);
+    metadata = gparquet_arrow_file_reader_get_metadata(reader);
+    /* Column indices are only meaningful as leaf indices for flat schemas;
+       nested files are read whole and filtered afterwards. */
+    gboolean flat = metadata != NULL &&
+      gparquet_file_metadata_get_n_columns(metadata) == n_fields;
+
+    if (message == NULL && n_cols > 0 && flat) {
+      indices = g_new(gint, n_cols + n_preds);
+      for (int i = 0; i < n_cols && message == NULL; i++) {
+        gint idx = garrow_schema_get_field_index(schema, columns[i]);
+        if (idx < 0) message = g_strdup_printf("Column `%s` not found.", columns[i]);
+        else indices[n_indices++] = idx;
+      }
+      for (int p = 0; p < n_preds && message == NULL; p++) {
+        gint idx = garrow_schema_get_field_index(schema, preds[p].column);
+        gboolean seen = FALSE;
+        for (int j = 0; j < n_indices; j++) if (indices[j] == idx) seen = TRUE;
+        if (!seen) indices[n_indices++] = idx;
+      }
+      if (message == NULL) {
+#if GLIB_CHECK_VERSION(2, 82, 0)
+        g_sort_array(indices, n_indices, sizeof(gint), compare_field_index, NULL);
+#else
+        g_qsort_with_data(indices, n_indices, sizeof(gint), compare_field_index, NULL);
+#endif
+      }
+    } else if (message == NULL) {
+      for (int i = 0; i < n_cols && message == NULL; i++) {
+        if (garrow_schema_get_field_index(schema, columns[i]) < 0)
+          message = g_strdup_printf("Column `%s` not found.", columns[i]);
+      }
+    }
+
+    gint n_groups = gparquet_arrow_file_reader_get_n_row_groups(reader);
+    if (message == NULL && flat && n_groups > 0) {
+      GList *parts = NULL;
+      GArrowTable *first_read = NULL;
+      for (gint g = 0; g < n_groups && error == NULL; g++) {
+        GParquetRowGroupMetadata *rg =
+          gparquet_file_metadata_get_row_group(metadata, g, NULL);
+        gboolean skip = FALSE;
+        for (int p = 0; rg != NULL && p < n_preds && !skip; p++) {
+          gint idx = garrow_schema_get_field_index(schema, preds[p].column);
+          skip = row_group_excluded(rg, idx, &preds[p]);
+        }
+        if (rg) g_object_unref(rg);
+        if (skip) continue;
+
+        GArrowTable *part = gparquet_arrow_file_reader_read_row_group(
+          reader, g, indices, indices ? (gsize)n_indices : 0, &error);
+        if (part == NULL) break;
+        GArrowTable *filtered = filter_table_by_predicates(part, preds, n_preds, &error);
+        g_object_unref(part);
+        if (filtered == NULL) break;
+        if (first_read == NULL) first_read = filtered;
+        else parts = g_list_prepend(parts, filtered);
+      }
+      parts = g_list_reverse(parts);
+
+      if (error == NULL && first_read == NULL) {
+        /* Every row group was skipped: return an empty table with the
+           projected schema by reading (and emptying) the first group. */
+        GArrowTable *probe = gparquet_arrow_file_reader_read_row_group(
+          reader, 0, indices, indices ? (gsize)n_indices : 0, &error);
+        if (probe != NULL) {
+          result = garrow_table_slice(probe, 0, 0);
+          g_object_unref(probe);
+        }
+      } else if (error == NULL && parts == NULL) {
+        result = first_read;
+        first_read = NULL;
+      } else if (error == NULL) {
+        result = garrow_table_concatenate(first_read, parts, NULL, &error);
+      }
+      if (first_read) g_object_unref(first_read);
+      g_list_free_full(parts, g_object_unref);
+    } else if (message == NULL) {
+      /* Empty or nested file: read whole, then filter. */
+      GArrowTable *whole = gparquet_arrow_file_reader_read_table(reader, &error);
+      if (whole != NULL) {
+        result = filter_table_by_predicates(whole, preds, n_preds, &error);
+        g_object_unref(whole);
+      }
+    }
+  }
+
+  if (metadata) g_object_unref(metadata);
+  if (schema) g_object_unref(schema);
+  if (reader) g_object_unref(reader);
+
+  caml_leave_blocking_section();
+
+  g_free(indices);
+  g_strfreev(columns);
+  g_free(path);
+  scan_predicates_free(preds, n_preds);
+
+  if (message == NULL && result == NULL) {
+    message = g_strdup(error && error->message ? error->message : "unknown error");
+  }
+  if (error) g_error_free(error);
+  if (message != NULL) {
+    if (result) g_object_unref(result);
+    value v_err = scan_result_error(message);
+    g_free(message);
+    CAMLreturn(v_err);
+  }
+  CAMLreturn(scan_result_ok(result));
+}
+
+/* Filter a native table by conjunctive (column, op_code, scalar) predicates.
+   Shares the row-group filter used by caml_arrow_read_parquet_scan.
+   Returns Ok table_ptr or Error message. */
+CAMLprim value caml_arrow_table_filter_predicates(value v_ptr, value v_preds) {
+  CAMLparam2(v_ptr, v_preds);
+
+  GArrowTable *table = (GArrowTable *)Nativeint_val(v_ptr);
+  int n_preds = 0;
+  ScanPredicate *preds = scan_predicates_of_list(v_preds, &n_preds);
+  GError *error = NULL;
+  GArrowTable *result = NULL;
+
+  g_object_ref(table);
+  caml_enter_blocking_section();
+  GArrowSchema *schema = garrow_table_get_schema(table);
+  gchar *message = scan_check_predicates(schema, preds, n_preds);
+  g_object_unref(schema);
+  if (message == NULL)
+    result = filter_table_by_predicates(table, preds, n_preds, &error);
+  caml_leave_blocking_section();
+  g_object_unref(table);
+
+  scan_predicates_free(preds, n_preds);
+  if (message == NULL && result == NULL)
+    message = g_strdup(error && error->message ? error->message : "unknown error");
+  if (error) g_error_free(error);
+  if (message != NULL) {
+    value v_err = scan_result_error(message);
+    g_free(message);
+    CAMLreturn(v_err);
+  }
+  CAMLreturn(scan_result_ok(result));
+}
+
+/* Create a native Arrow table from a list of (name, type_tag, timezone, array)
+   tuples.
+   type_tag: 0=Int64, 1=Float64, 2=Boolean, 3=String, 4=Dictionary,
+             5=List, 6=Null, 7=Date, 8=Timestamp.
+   array is an OCaml option array (None = null, Some x = value). */
+CAMLprim value caml_arrow_table_new(value v_cols) {
+  CAMLparam1(v_cols);
+  CAMLlocal4(v_iter, v_col, v_arr, v_res);
+  GError *error = NULL;
+
+  GList *fields = NULL;
+  GList *columns = NULL;
+  
+  v_iter = v_cols;
+  while (v_iter != Val_emptylist) {
+    v_col = Field(v_iter, 0);
+    const char *name = String_val(Field(v_col, 0));
+    int type_tag = Int_val(Field(v_col, 1));
+    value v_time_zone = Field(v_col, 2);
+    v_arr = Field(v_col, 3);
+    int n_rows = Wosize_val(v_arr);
+    
+    GArrowDataType *dtype = NULL;
+    GArrowArrayBuilder *builder = NULL;
+
+    switch (type_tag) {
+      case 0: // Int64
+        dtype = (GArrowDataType *)garrow_int64_data_type_new();
+        builder = (GArrowArrayBuilder *)garrow_int64_array_builder_new();
+        for (int i = 0; i < n_rows; i++) {
+          value v_opt = Field(v_arr, i);
           if (Is_block(v_opt)) { // Some(x)
             garrow_int64_array_builder_append_value(GARROW_INT64_ARRAY_BUILDER(builder), Long_val(Field(v_opt, 0)), &error);
           } else {
@@ -4755,461 +7252,2058 @@ CAMLprim value caml_arrow_table_new(value v_cols) {
 }
 
 /* ===================================================================== */
-/* Arrow Window Operations                                               */
+/* Table Construction from Buffers                                       */
 /* ===================================================================== */
 
-/* --- Sort indices ---------------------------------------------------- */
-/* (nativeint table_ptr, string col_name, bool ascending) -> int array option
-   Returns 0-based row indices that would sort the column, NULLs last. */
-
+/* A column handed over as flat buffers instead of an option array: the
+   OCaml side packs values (and, for strings, int32 offsets) into Bigarrays
+   plus an optional validity bitmap, and each buffer becomes an Arrow
+   buffer with a single copy. The OCaml constructor tags are
+     0 Int64_buffer (values, validity)
+     1 Float64_buffer (values, validity)
+     2 Boolean_buffer (length, bit-packed values, validity)
+     3 Utf8_buffer (offsets, data, validity)
+     4 Date32_buffer (values, validity)
+     5 Timestamp_buffer (values, timezone, validity)   -- microseconds */
 typedef struct {
-  gint64 index;
-  gdouble value;
-  gboolean is_null;
-} SortTriple;
-
-static int sort_triple_cmp_asc(const void *a, const void *b) {
-  const SortTriple *sa = (const SortTriple *)a;
-  const SortTriple *sb = (const SortTriple *)b;
-  if (sa->is_null && sb->is_null) return 0;
-  if (sa->is_null) return 1;   /* NULLs last */
-  if (sb->is_null) return -1;
-  if (sa->value < sb->value) return -1;
-  if (sa->value > sb->value) return 1;
-  /* Stable tie-break by original index */
-  return (sa->index < sb->index) ? -1 : (sa->index > sb->index) ? 1 : 0;
-}
-
-static int sort_triple_cmp_desc(const void *a, const void *b) {
-  const SortTriple *sa = (const SortTriple *)a;
-  const SortTriple *sb = (const SortTriple *)b;
-  if (sa->is_null && sb->is_null) return 0;
-  if (sa->is_null) return 1;   /* NULLs last */
-  if (sb->is_null) return -1;
-  if (sa->value > sb->value) return -1;
-  if (sa->value < sb->value) return 1;
-  return (sa->index < sb->index) ? -1 : (sa->index > sb->index) ? 1 : 0;
-}
-
-CAMLprim value caml_arrow_compute_sort_indices(value v_ptr, value v_col, value v_asc) {
-  CAMLparam3(v_ptr, v_col, v_asc);
-  CAMLlocal2(v_result, v_arr);
-
-  GArrowTable *table = (GArrowTable *)Nativeint_val(v_ptr);
-  const char *col_name = String_val(v_col);
-  int ascending = Bool_val(v_asc);
-
-  GArrowSchema *schema = garrow_table_get_schema(table);
-  gint col_idx = garrow_schema_get_field_index(schema, col_name);
-  g_object_unref(schema);
-  if (col_idx < 0) CAMLreturn(Val_none);
-
-  gint64 nrows = garrow_table_get_n_rows(table);
-  GArrowChunkedArray *chunked = garrow_table_get_column_data(table, col_idx);
-  if (chunked == NULL) CAMLreturn(Val_none);
-
-  NumericChunkCursor cursor;
-  numeric_chunk_cursor_init(&cursor, chunked);
-
-  SortTriple *triples = (SortTriple *)malloc(sizeof(SortTriple) * (size_t)nrows);
-  if (triples == NULL) {
-    numeric_chunk_cursor_destroy(&cursor);
-    g_object_unref(chunked);
-    CAMLreturn(Val_none);
-  }
+  gchar *name;
+  int kind;
+  gint64 length;
+  const void *values;      /* value data, bit-packed booleans or UTF-8 bytes */
+  gsize values_size;
+  const gint32 *offsets;   /* Utf8_buffer only, length + 1 entries */
+  const guint8 *validity;  /* NULL when every row is valid */
+  gchar *timezone;
+} BufferColumnSpec;
+
+static const void *bigarray_bytes(value v_ba, gsize *size) {
+  *size = caml_ba_byte_size(Caml_ba_array_val(v_ba));
+  return Caml_ba_data_val(v_ba);
+}
 
-  gboolean supported = TRUE;
-  for (gint64 i = 0; i < nrows; i++) {
-    triples[i].index = i;
-    if (!get_numeric_value(&cursor, i, &triples[i].is_null, &triples[i].value)) {
-      supported = FALSE;
+/* Read a buffer column's descriptor. Returns FALSE when the buffers are
+   inconsistent (short bitmaps, offsets out of range), so that nothing
+   past the end of a Bigarray is ever copied. The Bigarray memory is
+   outside the OCaml heap and stays put while v_col is rooted. */
+static gboolean buffer_column_spec(value v_name, value v_col, BufferColumnSpec *spec) {
+  memset(spec, 0, sizeof(*spec));
+  spec->kind = Tag_val(v_col);
+  value v_validity;
+  gsize size = 0;
+  switch (spec->kind) {
+    case 0: case 1: case 4: case 5: {
+      struct caml_ba_array *ba = Caml_ba_array_val(Field(v_col, 0));
+      spec->length = ba->dim[0];
+      spec->values = bigarray_bytes(Field(v_col, 0), &spec->values_size);
+      v_validity = Field(v_col, spec->kind == 5 ? 2 : 1);
+      if (spec->kind == 5 && Is_block(Field(v_col, 1)))
+        spec->timezone = g_strdup(String_val(Field(Field(v_col, 1), 0)));
       break;
     }
+    case 2:
+      spec->length = Long_val(Field(v_col, 0));
+      spec->values = bigarray_bytes(Field(v_col, 1), &spec->values_size);
+      v_validity = Field(v_col, 2);
+      if (spec->length < 0 || spec->values_size < (gsize)((spec->length + 7) / 8)) return FALSE;
+      break;
+    case 3: {
+      struct caml_ba_array *ba = Caml_ba_array_val(Field(v_col, 0));
+      if (ba->dim[0] < 1) return FALSE;
+      spec->length = ba->dim[0] - 1;
+      spec->offsets = (const gint32 *)ba->data;
+      spec->values = bigarray_bytes(Field(v_col, 1), &spec->values_size);
+      v_validity = Field(v_col, 2);
+      if (spec->offsets[0] != 0) return FALSE;
+      for (gint64 i = 0; i < spec->length; i++)
+        if (spec->offsets[i + 1] < spec->offsets[i]) return FALSE;
+      if ((gsize)spec->offsets[spec->length] > spec->values_size) return FALSE;
+      break;
+    }
+    default:
+      return FALSE;
   }
-  numeric_chunk_cursor_destroy(&cursor);
-  g_object_unref(chunked);
-
-  if (!supported) {
-    free(triples);
-    CAMLreturn(Val_none);
-  }
-
-  qsort(triples, (size_t)nrows,
-        sizeof(SortTriple),
-        ascending ? sort_triple_cmp_asc : sort_triple_cmp_desc);
-
-  v_arr = caml_alloc(nrows, 0);
-  for (gint64 i = 0; i < nrows; i++) {
-    Store_field(v_arr, i, Val_int((int)triples[i].index));
+  if (Is_block(v_validity)) {
+    spec->validity = (const guint8 *)bigarray_bytes(Field(v_validity, 0), &size);
+    if (size < (gsize)((spec->length + 7) / 8)) return FALSE;
   }
-  free(triples);
-
-  v_result = caml_alloc(1, 0);
-  Store_field(v_result, 0, v_arr);
-  CAMLreturn(v_result);
+  spec->name = g_strdup(String_val(v_name));
+  return TRUE;
 }
 
-/* --- Dense rank ------------------------------------------------------ */
-/* (nativeint table_ptr, string col_name) -> int option array option
-   Assigns dense ranks (no gaps) to non-NULL numeric values.
-   NULL positions receive None; ranked positions receive Some(rank). */
-
-typedef struct {
-  gint64 row_index;
-  gdouble value;
-} RankPair;
-
-static int rank_pair_cmp(const void *a, const void *b) {
-  const RankPair *ra = (const RankPair *)a;
-  const RankPair *rb = (const RankPair *)b;
-  if (ra->value < rb->value) return -1;
-  if (ra->value > rb->value) return 1;
-  /* Stable tie-break by original row index */
-  return (ra->row_index < rb->row_index) ? -1 : (ra->row_index > rb->row_index) ? 1 : 0;
+static void buffer_column_spec_clear(BufferColumnSpec *spec) {
+  g_free(spec->name);
+  g_free(spec->timezone);
+  spec->name = spec->timezone = NULL;
 }
 
-CAMLprim value caml_arrow_compute_dense_rank(value v_ptr, value v_col) {
-  CAMLparam2(v_ptr, v_col);
-  CAMLlocal3(v_result, v_arr, v_some);
-
-  GArrowTable *table = (GArrowTable *)Nativeint_val(v_ptr);
-  const char *col_name = String_val(v_col);
-
-  GArrowSchema *schema = garrow_table_get_schema(table);
-  gint col_idx = garrow_schema_get_field_index(schema, col_name);
-  g_object_unref(schema);
-  if (col_idx < 0) CAMLreturn(Val_none);
-
-  gint64 nrows = garrow_table_get_n_rows(table);
-  GArrowChunkedArray *chunked = garrow_table_get_column_data(table, col_idx);
-  if (chunked == NULL) CAMLreturn(Val_none);
-
-  NumericChunkCursor cursor;
-  numeric_chunk_cursor_init(&cursor, chunked);
+static GArrowBuffer *arrow_buffer_copy(const void *data, gsize size) {
+  GBytes *bytes = g_bytes_new(data, size);
+  GArrowBuffer *buffer = garrow_buffer_new_bytes(bytes);
+  g_bytes_unref(bytes);
+  return buffer;
+}
 
-  /* Separate NULL and non-NULL rows */
-  gboolean *is_null_flag = (gboolean *)malloc(sizeof(gboolean) * (size_t)nrows);
-  RankPair *pairs = (RankPair *)malloc(sizeof(RankPair) * (size_t)nrows);
-  if (is_null_flag == NULL || pairs == NULL) {
-    free(is_null_flag);
-    free(pairs);
-    numeric_chunk_cursor_destroy(&cursor);
-    g_object_unref(chunked);
-    CAMLreturn(Val_none);
+/* Build the column described by [spec] as a one-chunk array. Touches no
+   OCaml values, so callers run it outside the runtime lock. */
+static GArrowChunkedArray *chunked_array_of_spec(const BufferColumnSpec *spec, GError **error) {
+  gint64 n = spec->length;
+  gint64 n_nulls = 0;
+  GArrowBuffer *null_bitmap = NULL;
+  if (spec->validity != NULL) {
+    for (gint64 i = 0; i < n; i++)
+      if (!(spec->validity[i >> 3] & (1u << (i & 7)))) n_nulls++;
+    if (n_nulls > 0) null_bitmap = arrow_buffer_copy(spec->validity, (gsize)((n + 7) / 8));
   }
 
-  gint64 n_valid = 0;
-  gboolean supported = TRUE;
-  for (gint64 i = 0; i < nrows; i++) {
-    gboolean is_null;
-    gdouble val;
-    if (!get_numeric_value(&cursor, i, &is_null, &val)) {
-      supported = FALSE;
+  GArrowArray *array = NULL;
+  GArrowBuffer *data = NULL;
+  switch (spec->kind) {
+    case 0:
+      data = arrow_buffer_copy(spec->values, (gsize)n * sizeof(gint64));
+      array = GARROW_ARRAY(garrow_int64_array_new(n, data, null_bitmap, n_nulls));
+      break;
+    case 1:
+      data = arrow_buffer_copy(spec->values, (gsize)n * sizeof(gdouble));
+      array = GARROW_ARRAY(garrow_double_array_new(n, data, null_bitmap, n_nulls));
+      break;
+    case 2:
+      data = arrow_buffer_copy(spec->values, (gsize)((n + 7) / 8));
+      array = GARROW_ARRAY(garrow_boolean_array_new(n, data, null_bitmap, n_nulls));
+      break;
+    case 3: {
+      GArrowBuffer *offsets = arrow_buffer_copy(spec->offsets, (gsize)(n + 1) * sizeof(gint32));
+      data = arrow_buffer_copy(spec->values, (gsize)spec->offsets[n]);
+      array = GARROW_ARRAY(garrow_string_array_new(n, offsets, data, null_bitmap, n_nulls));
+      g_object_unref(offsets);
       break;
     }
-    is_null_flag[i] = is_null;
-    if (!is_null) {
-      pairs[n_valid].row_index = i;
-      pairs[n_valid].value = val;
-      n_valid++;
+    case 4:
+      data = arrow_buffer_copy(spec->values, (gsize)n * sizeof(gint32));
+      array = GARROW_ARRAY(garrow_date32_array_new(n, data, null_bitmap, n_nulls));
+      break;
+    case 5: {
+      GArrowTimestampDataType *dtype = GARROW_TIMESTAMP_DATA_TYPE(
+        create_timestamp_data_type_with_tz_string(GARROW_TIME_UNIT_MICRO, spec->timezone));
+      data = arrow_buffer_copy(spec->values, (gsize)n * sizeof(gint64));
+      array = GARROW_ARRAY(garrow_timestamp_array_new(dtype, n, data, null_bitmap, n_nulls));
+      g_object_unref(dtype);
+      break;
     }
   }
-  numeric_chunk_cursor_destroy(&cursor);
-  g_object_unref(chunked);
+  if (data) g_object_unref(data);
+  if (null_bitmap) g_object_unref(null_bitmap);
+  if (array == NULL) return NULL;
 
-  if (!supported) {
-    free(is_null_flag);
-    free(pairs);
-    CAMLreturn(Val_none);
-  }
+  GList *chunks = g_list_append(NULL, array);
+  GArrowChunkedArray *chunked = garrow_chunked_array_new(chunks, error);
+  g_list_free(chunks);
+  g_object_unref(array);
+  return chunked;
+}
 
-  /* Sort non-null pairs by value */
-  qsort(pairs, (size_t)n_valid, sizeof(RankPair), rank_pair_cmp);
+static value native_table_option(GArrowTable *table) {
+  CAMLparam0();
+  CAMLlocal1(v_res);
+  if (table == NULL) CAMLreturn(Val_none);
+  v_res = caml_alloc(1, 0);
+  Store_field(v_res, 0, caml_copy_nativeint((intnat)table));
+  CAMLreturn(v_res);
+}
 
-  /* Assign dense ranks: same value → same rank, no gaps */
-  int *ranks = (int *)calloc((size_t)nrows, sizeof(int));
-  if (ranks == NULL) {
-    free(is_null_flag);
-    free(pairs);
-    CAMLreturn(Val_none);
-  }
+/* Create a native Arrow table from a (name * buffer_column) list. */
+CAMLprim value caml_arrow_table_from_buffers(value v_cols) {
+  CAMLparam1(v_cols);
+  int n = 0;
+  for (value it = v_cols; it != Val_emptylist; it = Field(it, 1)) n++;
+  if (n == 0) CAMLreturn(Val_none);
 
-  if (n_valid > 0) {
-    int current_rank = 1;
-    ranks[pairs[0].row_index] = current_rank;
-    for (gint64 i = 1; i < n_valid; i++) {
-      if (pairs[i].value != pairs[i - 1].value) {
-        current_rank++;
-      }
-      ranks[pairs[i].row_index] = current_rank;
-    }
+  BufferColumnSpec *specs = g_new0(BufferColumnSpec, n);
+  gboolean ok = TRUE;
+  int i = 0;
+  for (value it = v_cols; it != Val_emptylist && ok; it = Field(it, 1), i++) {
+    value v_pair = Field(it, 0);
+    ok = buffer_column_spec(Field(v_pair, 0), Field(v_pair, 1), &specs[i]);
+    if (ok && specs[i].length != specs[0].length) ok = FALSE;
   }
-  free(pairs);
+  GArrowTable *table = NULL;
 
-  /* Build int option array: None for NULLs, Some(rank) for others */
-  v_arr = caml_alloc(nrows, 0);
-  for (gint64 i = 0; i < nrows; i++) {
-    if (is_null_flag[i]) {
-      Store_field(v_arr, i, Val_none);
-    } else {
-      v_some = caml_alloc(1, 0);
-      Store_field(v_some, 0, Val_int(ranks[i]));
-      Store_field(v_arr, i, v_some);
+  if (ok) {
+    GError *error = NULL;
+    caml_enter_blocking_section();
+    GList *fields = NULL;
+    GArrowChunkedArray **columns = g_new0(GArrowChunkedArray *, n);
+    for (i = 0; i < n && ok; i++) {
+      columns[i] = chunked_array_of_spec(&specs[i], &error);
+      if (columns[i] == NULL) { ok = FALSE; break; }
+      GArrowDataType *dtype = garrow_chunked_array_get_value_data_type(columns[i]);
+      fields = g_list_append(fields, garrow_field_new(specs[i].name, dtype));
+      g_object_unref(dtype);
+    }
+    if (ok) {
+      GArrowSchema *schema = garrow_schema_new(fields);
+      table = garrow_table_new_chunked_arrays(schema, columns, n, &error);
+      g_object_unref(schema);
     }
+    for (i = 0; i < n; i++)
+      if (columns[i]) g_object_unref(columns[i]);
+    g_free(columns);
+    g_list_free_full(fields, g_object_unref);
+    caml_leave_blocking_section();
+    if (error) g_error_free(error);
   }
-  free(is_null_flag);
-  free(ranks);
 
-  v_result = caml_alloc(1, 0);
-  Store_field(v_result, 0, v_arr);
-  CAMLreturn(v_result);
+  for (i = 0; i < n; i++) buffer_column_spec_clear(&specs[i]);
+  g_free(specs);
+  CAMLreturn(native_table_option(table));
 }
 
-/* --- Generalized rank ------------------------------------------------ */
-/* (nativeint table_ptr, string col_name, int rank_type) -> int option array option
-   rank_type: 0 = row_number, 1 = min_rank, 2 = dense_rank */
+/* Add [column] to [table] as [name], replacing a column of the same name
+   in place; the other columns are shared, not copied. */
+static GArrowTable *table_with_column(GArrowTable *table, const char *name,
+                                      GArrowChunkedArray *column, GError **error) {
+  GArrowSchema *schema = garrow_table_get_schema(table);
+  gint idx = garrow_schema_get_field_index(schema, name);
+  g_object_unref(schema);
+  if (idx >= 0) return rebuild_table_with_column(table, (guint)idx, column);
 
-CAMLprim value caml_arrow_compute_rank(value v_ptr, value v_col, value v_rank_type) {
-  CAMLparam3(v_ptr, v_col, v_rank_type);
-  CAMLlocal3(v_result, v_arr, v_some);
+  GArrowDataType *dtype = garrow_chunked_array_get_value_data_type(column);
+  GArrowField *field = garrow_field_new(name, dtype);
+  GArrowTable *result =
+    garrow_table_add_column(table, garrow_table_get_n_columns(table), field, column, error);
+  g_object_unref(field);
+  g_object_unref(dtype);
+  return result;
+}
 
+/* Add a buffer column to a native table, replacing a column of the same
+   name in place. */
+CAMLprim value caml_arrow_table_set_buffer_column(value v_ptr, value v_name, value v_col) {
+  CAMLparam3(v_ptr, v_name, v_col);
   GArrowTable *table = (GArrowTable *)Nativeint_val(v_ptr);
-  const char *col_name = String_val(v_col);
-  int rank_type = Int_val(v_rank_type);
+  BufferColumnSpec spec;
+  GArrowTable *result = NULL;
 
-  GArrowSchema *schema = garrow_table_get_schema(table);
-  gint col_idx = garrow_schema_get_field_index(schema, col_name);
-  g_object_unref(schema);
-  if (col_idx < 0) CAMLreturn(Val_none);
+  if (buffer_column_spec(v_name, v_col, &spec)
+      && spec.length == garrow_table_get_n_rows(table)) {
+    GError *error = NULL;
+    g_object_ref(table);
+    caml_enter_blocking_section();
+    GArrowChunkedArray *column = chunked_array_of_spec(&spec, &error);
+    if (column != NULL) {
+      result = table_with_column(table, spec.name, column, &error);
+      g_object_unref(column);
+    }
+    caml_leave_blocking_section();
+    g_object_unref(table);
+    if (error) g_error_free(error);
+  }
 
-  gint64 nrows = garrow_table_get_n_rows(table);
-  GArrowChunkedArray *chunked = garrow_table_get_column_data(table, col_idx);
-  if (chunked == NULL) CAMLreturn(Val_none);
+  buffer_column_spec_clear(&spec);
+  CAMLreturn(native_table_option(result));
+}
 
-  NumericChunkCursor cursor;
-  numeric_chunk_cursor_init(&cursor, chunked);
+/* ===================================================================== */
+/* Fused Expression Kernels                                              */
+/* ===================================================================== */
 
-  gboolean *is_null_flag = (gboolean *)malloc(sizeof(gboolean) * (size_t)nrows);
-  RankPair *pairs = (RankPair *)malloc(sizeof(RankPair) * (size_t)nrows);
-  if (is_null_flag == NULL || pairs == NULL) {
-    free(is_null_flag);
-    free(pairs);
-    numeric_chunk_cursor_destroy(&cursor);
-    g_object_unref(chunked);
-    CAMLreturn(Val_none);
-  }
+/* Evaluates a whole mutate right-hand side in one pass instead of one
+   Arrow compute call (and one temporary column) per operator. The program
+   is a postfix list of Arrow_ffi.expr_op over Float64 columns; Int64
+   columns are rejected, since converting them to double is inexact past
+   2^53. Rows are processed in blocks of at most EXPR_BLOCK that never
+   straddle a chunk boundary of any input, so each operator is a plain loop
+   over contiguous doubles that the compiler vectorises for the target (see
+   the vectoriser flags in src/dune). A row is null in the result when it
+   is null in any input column. */
+
+#define EXPR_BLOCK 1024
+#define EXPR_MAX_STACK 16
+
+/* Constant constructors of Arrow_ffi.expr_op, in declaration order, then
+   the two constructors with an argument (tags 0 and 1). */
+enum {
+  EXPR_ADD, EXPR_SUB, EXPR_MUL, EXPR_DIV, EXPR_POW,
+  EXPR_SQRT, EXPR_LOG, EXPR_EXP, EXPR_ABS,
+  EXPR_LT, EXPR_LE, EXPR_GT, EXPR_GE, EXPR_EQ, EXPR_NE,
+  EXPR_COLUMN, EXPR_CONST
+};
 
-  gint64 n_valid = 0;
-  gboolean supported = TRUE;
-  for (gint64 i = 0; i < nrows; i++) {
-    gboolean is_null;
-    gdouble val;
-    if (!get_numeric_value(&cursor, i, &is_null, &val)) {
-      supported = FALSE;
-      break;
-    }
-    is_null_flag[i] = is_null;
-    if (!is_null) {
-      pairs[n_valid].row_index = i;
-      pairs[n_valid].value = val;
-      n_valid++;
+typedef struct {
+  int op;
+  int column;       /* EXPR_COLUMN: index into the column list */
+  double constant;  /* EXPR_CONST */
+} ExprInstr;
+
+/* Read position of one input column. */
+typedef struct {
+  GArrowChunkedArray *chunked;
+  guint n_chunks;
+  guint next_chunk;
+  GArrowArray *chunk;     /* current chunk, owned */
+  gint64 remaining;       /* rows left in the current chunk */
+  const gdouble *f64;     /* current row of the chunk */
+  const guint8 *bitmap;   /* NULL when the chunk has no nulls */
+  gint64 bit;             /* bitmap position of the current row */
+} ExprCursor;
+
+static gboolean expr_is_comparison(int op) {
+  return op >= EXPR_LT && op <= EXPR_NE;
+}
+
+/* Copy the OCaml program into [code]. Rejects programs that underflow or
+   overflow the stack, reference a missing column, leave anything but one
+   value, or compare anywhere but in the last instruction. */
+static gboolean expr_program_of_value(value v_program, int n_cols, ExprInstr *code, int n_code) {
+  int depth = 0;
+  for (int k = 0; k < n_code; k++) {
+    value v_op = Field(v_program, k);
+    ExprInstr *in = &code[k];
+    in->column = 0;
+    in->constant = 0.0;
+    if (Is_long(v_op)) {
+      in->op = Int_val(v_op);
+      if (in->op < EXPR_ADD || in->op > EXPR_NE) return FALSE;
+      if (in->op >= EXPR_SQRT && in->op <= EXPR_ABS) {
+        if (depth < 1) return FALSE;
+      } else {
+        if (depth < 2) return FALSE;
+        depth--;
+      }
+      if (expr_is_comparison(in->op) && k != n_code - 1) return FALSE;
+    } else if (Tag_val(v_op) == 0) {
+      in->op = EXPR_COLUMN;
+      in->column = Int_val(Field(v_op, 0));
+      if (in->column < 0 || in->column >= n_cols) return FALSE;
+      depth++;
+    } else {
+      in->op = EXPR_CONST;
+      in->constant = Double_val(Field(v_op, 0));
+      depth++;
     }
+    if (depth > EXPR_MAX_STACK) return FALSE;
   }
-  numeric_chunk_cursor_destroy(&cursor);
-  g_object_unref(chunked);
+  return depth == 1;
+}
 
-  if (!supported) {
-    free(is_null_flag);
-    free(pairs);
-    CAMLreturn(Val_none);
+/* Move [c] to its next non-empty chunk. FALSE when none is left or the
+   chunk's buffers are shorter than its declared length. */
+static gboolean expr_cursor_next_chunk(ExprCursor *c) {
+  while (c->next_chunk < c->n_chunks) {
+    if (c->chunk) g_object_unref(c->chunk);
+    c->chunk = garrow_chunked_array_get_chunk(c->chunked, c->next_chunk++);
+    if (c->chunk == NULL) return FALSE;
+    gint64 length = garrow_array_get_length(c->chunk);
+    if (length == 0) continue;
+    gint64 offset = garrow_array_get_offset(c->chunk);
+
+    GArrowBuffer *buffer =
+      garrow_primitive_array_get_data_buffer(GARROW_PRIMITIVE_ARRAY(c->chunk));
+    if (buffer == NULL) return FALSE;
+    GBytes *bytes = garrow_buffer_get_data(buffer);
+    gsize size = 0;
+    const guint8 *data = (const guint8 *)g_bytes_get_data(bytes, &size);
+    g_bytes_unref(bytes);
+    g_object_unref(buffer);
+    if (data == NULL || size < (gsize)(offset + length) * sizeof(gdouble)) return FALSE;
+    c->f64 = (const gdouble *)data + offset;
+
+    c->bitmap = NULL;
+    c->bit = offset;
+    if (garrow_array_get_n_nulls(c->chunk) > 0) {
+      GArrowBuffer *bm_buffer = garrow_array_get_null_bitmap(c->chunk);
+      if (bm_buffer == NULL) return FALSE;
+      GBytes *bm_bytes = garrow_buffer_get_data(bm_buffer);
+      gsize bm_size = 0;
+      c->bitmap = (const guint8 *)g_bytes_get_data(bm_bytes, &bm_size);
+      g_bytes_unref(bm_bytes);
+      g_object_unref(bm_buffer);
+      if (c->bitmap == NULL || bm_size < (gsize)((offset + length + 7) / 8)) return FALSE;
+    }
+    c->remaining = length;
+    return TRUE;
   }
+  return FALSE;
+}
 
-  qsort(pairs, (size_t)n_valid, sizeof(RankPair), rank_pair_cmp);
-
-  int *ranks = (int *)calloc((size_t)nrows, sizeof(int));
-  if (ranks == NULL) {
-    free(is_null_flag);
-    free(pairs);
-    CAMLreturn(Val_none);
-  }
+static void expr_cursor_advance(ExprCursor *c, gint64 n) {
+  c->f64 += n;
+  c->bit += n;
+  c->remaining -= n;
+}
 
-  if (n_valid > 0) {
-    switch (rank_type) {
-      case 0: {
-        /* row_number: sequential 1..n among non-NULL values */
-        for (gint64 i = 0; i < n_valid; i++) {
-          ranks[pairs[i].row_index] = (int)(i + 1);
-        }
-        break;
+/* Run [code] over the current [n] rows of [cols]. [valid] is 1 for rows
+   where every input is valid; the result is left in stack[0]. Returns
+   FALSE when a valid row divides by zero or leaves the domain of sqrt or
+   log, so the caller can fall back to the path that reports the error. */
+static gboolean expr_eval_block(const ExprInstr *code, int n_code, const ExprCursor *cols,
+                                const guint8 *restrict valid, gint64 n,
+                                gdouble (*stack)[EXPR_BLOCK]) {
+  int sp = 0;
+  for (int k = 0; k < n_code; k++) {
+    const ExprInstr *in = &code[k];
+    int bad = 0;
+    switch (in->op) {
+      case EXPR_COLUMN: {
+        gdouble *restrict dst = stack[sp++];
+        memcpy(dst, cols[in->column].f64, (gsize)n * sizeof(gdouble));
+        continue;
       }
-      case 1: {
-        /* min_rank: ties get minimum rank, gaps after ties */
-        int current_rank = 1;
-        ranks[pairs[0].row_index] = current_rank;
-        for (gint64 i = 1; i < n_valid; i++) {
-          if (pairs[i].value != pairs[i - 1].value) {
-            current_rank = (int)(i + 1);
-          }
-          ranks[pairs[i].row_index] = current_rank;
+      case EXPR_CONST: {
+        gdouble *restrict dst = stack[sp++];
+        double x = in->constant;
+        for (gint64 i = 0; i < n; i++) dst[i] = x;
+        continue;
+      }
+      case EXPR_SQRT: case EXPR_LOG: case EXPR_EXP: case EXPR_ABS: {
+        gdouble *restrict a = stack[sp - 1];
+        switch (in->op) {
+          case EXPR_SQRT:
+            for (gint64 i = 0; i < n; i++) bad |= valid[i] & (a[i] < 0.0);
+            for (gint64 i = 0; i < n; i++) a[i] = sqrt(a[i]);
+            break;
+          case EXPR_LOG:
+            for (gint64 i = 0; i < n; i++) bad |= valid[i] & (a[i] <= 0.0);
+            for (gint64 i = 0; i < n; i++) a[i] = log(a[i]);
+            break;
+          case EXPR_EXP:
+            for (gint64 i = 0; i < n; i++) a[i] = exp(a[i]);
+            break;
+          default:
+            for (gint64 i = 0; i < n; i++) a[i] = fabs(a[i]);
+            break;
         }
         break;
       }
-      case 2: {
-        /* dense_rank: ties get same rank, no gaps */
-        int current_rank = 1;
-        ranks[pairs[0].row_index] = current_rank;
-        for (gint64 i = 1; i < n_valid; i++) {
-          if (pairs[i].value != pairs[i - 1].value) {
-            current_rank++;
-          }
-          ranks[pairs[i].row_index] = current_rank;
+      default: {
+        gdouble *restrict a = stack[sp - 2];
+        const gdouble *restrict b = stack[sp - 1];
+        sp--;
+        switch (in->op) {
+          case EXPR_ADD: for (gint64 i = 0; i < n; i++) a[i] = a[i] + b[i]; break;
+          case EXPR_SUB: for (gint64 i = 0; i < n; i++) a[i] = a[i] - b[i]; break;
+          case EXPR_MUL: for (gint64 i = 0; i < n; i++) a[i] = a[i] * b[i]; break;
+          case EXPR_DIV:
+            for (gint64 i = 0; i < n; i++) bad |= valid[i] & (b[i] == 0.0);
+            for (gint64 i = 0; i < n; i++) a[i] = a[i] / b[i];
+            break;
+          case EXPR_POW: for (gint64 i = 0; i < n; i++) a[i] = pow(a[i], b[i]); break;
+          case EXPR_LT: for (gint64 i = 0; i < n; i++) a[i] = a[i] < b[i] ? 1.0 : 0.0; break;
+          case EXPR_LE: for (gint64 i = 0; i < n; i++) a[i] = a[i] <= b[i] ? 1.0 : 0.0; break;
+          case EXPR_GT: for (gint64 i = 0; i < n; i++) a[i] = a[i] > b[i] ? 1.0 : 0.0; break;
+          case EXPR_GE: for (gint64 i = 0; i < n; i++) a[i] = a[i] >= b[i] ? 1.0 : 0.0; break;
+          case EXPR_EQ: for (gint64 i = 0; i < n; i++) a[i] = a[i] == b[i] ? 1.0 : 0.0; break;
+          default:      for (gint64 i = 0; i < n; i++) a[i] = a[i] != b[i] ? 1.0 : 0.0; break;
         }
         break;
       }
-      default:
-        /* Unknown rank type — fall through with zero ranks, treated below */
-        break;
     }
+    if (bad) return FALSE;
   }
-  free(pairs);
+  return TRUE;
+}
 
-  v_arr = caml_alloc(nrows, 0);
-  for (gint64 i = 0; i < nrows; i++) {
-    if (is_null_flag[i]) {
-      Store_field(v_arr, i, Val_none);
-    } else {
-      v_some = caml_alloc(1, 0);
-      Store_field(v_some, 0, Val_int(ranks[i]));
-      Store_field(v_arr, i, v_some);
+/* Evaluate the program over every row of [table] and build the result as
+   a one-chunk Float64 column, or Boolean when the program ends in a
+   comparison. Touches no OCaml values. */
+static GArrowChunkedArray *expr_evaluate(GArrowTable *table, char **names, int n_cols,
+                                         const ExprInstr *code, int n_code, GError **error) {
+  gint64 nrows = garrow_table_get_n_rows(table);
+  if (nrows <= 0) return NULL;
+  gboolean boolean_result = expr_is_comparison(code[n_code - 1].op);
+
+  GArrowSchema *schema = garrow_table_get_schema(table);
+  ExprCursor *cols = g_new0(ExprCursor, n_cols);
+  gboolean ok = TRUE;
+  for (int j = 0; j < n_cols && ok; j++) {
+    gint idx = garrow_schema_get_field_index(schema, names[j]);
+    if (idx < 0) { ok = FALSE; break; }
+    cols[j].chunked = garrow_table_get_column_data(table, idx);
+    if (cols[j].chunked == NULL) { ok = FALSE; break; }
+    ok = (garrow_chunked_array_get_value_type(cols[j].chunked) == GARROW_TYPE_DOUBLE);
+    cols[j].n_chunks = garrow_chunked_array_get_n_chunks(cols[j].chunked);
+  }
+  g_object_unref(schema);
+
+  gsize bitmap_len = (gsize)((nrows + 7) / 8);
+  gdouble *out = NULL;
+  guint8 *out_bits = NULL;
+  guint8 *validity = g_malloc0(bitmap_len);
+  if (boolean_result) out_bits = g_malloc0(bitmap_len);
+  else out = g_new(gdouble, nrows);
+  gdouble (*stack)[EXPR_BLOCK] = g_malloc(sizeof(gdouble) * EXPR_MAX_STACK * EXPR_BLOCK);
+  guint8 valid[EXPR_BLOCK];
+  gint64 n_nulls = 0;
+
+  for (gint64 row = 0; ok && row < nrows; ) {
+    gint64 n = MIN((gint64)EXPR_BLOCK, nrows - row);
+    for (int j = 0; j < n_cols && ok; j++) {
+      if (cols[j].remaining == 0) ok = expr_cursor_next_chunk(&cols[j]);
+      if (ok) n = MIN(n, cols[j].remaining);
+    }
+    if (!ok) break;
+
+    memset(valid, 1, (gsize)n);
+    for (int j = 0; j < n_cols; j++) {
+      const guint8 *bm = cols[j].bitmap;
+      if (bm == NULL) continue;
+      gint64 bit = cols[j].bit;
+      for (gint64 i = 0; i < n; i++)
+        valid[i] &= (bm[(bit + i) >> 3] >> ((bit + i) & 7)) & 1;
+    }
+
+    if (!expr_eval_block(code, n_code, cols, valid, n, stack)) { ok = FALSE; break; }
+
+    const gdouble *res = stack[0];
+    if (boolean_result) {
+      for (gint64 i = 0; i < n; i++)
+        if (res[i] != 0.0) out_bits[(row + i) >> 3] |= (guint8)(1u << ((row + i) & 7));
+    } else {
+      memcpy(out + row, res, (gsize)n * sizeof(gdouble));
+    }
+    for (gint64 i = 0; i < n; i++) {
+      if (valid[i]) validity[(row + i) >> 3] |= (guint8)(1u << ((row + i) & 7));
+      else n_nulls++;
+    }
+
+    for (int j = 0; j < n_cols; j++) expr_cursor_advance(&cols[j], n);
+    row += n;
+  }
+
+  g_free(stack);
+  for (int j = 0; j < n_cols; j++) {
+    if (cols[j].chunk) g_object_unref(cols[j].chunk);
+    if (cols[j].chunked) g_object_unref(cols[j].chunked);
+  }
+  g_free(cols);
+
+  GArrowChunkedArray *result = NULL;
+  if (ok) {
+    GArrowBuffer *null_bitmap = NULL;
+    if (n_nulls > 0) {
+      GBytes *bytes = g_bytes_new_take(validity, bitmap_len);
+      null_bitmap = garrow_buffer_new_bytes(bytes);
+      g_bytes_unref(bytes);
+      validity = NULL;
+    }
+    GBytes *bytes = boolean_result
+      ? g_bytes_new_take(out_bits, bitmap_len)
+      : g_bytes_new_take(out, (gsize)nrows * sizeof(gdouble));
+    out = NULL;
+    out_bits = NULL;
+    GArrowBuffer *data = garrow_buffer_new_bytes(bytes);
+    g_bytes_unref(bytes);
+
+    GArrowArray *array = boolean_result
+      ? GARROW_ARRAY(garrow_boolean_array_new(nrows, data, null_bitmap, n_nulls))
+      : GARROW_ARRAY(garrow_double_array_new(nrows, data, null_bitmap, n_nulls));
+    g_object_unref(data);
+    if (null_bitmap) g_object_unref(null_bitmap);
+    if (array != NULL) {
+      GList *chunks = g_list_append(NULL, array);
+      result = garrow_chunked_array_new(chunks, error);
+      g_list_free(chunks);
+      g_object_unref(array);
+    }
+  }
+  g_free(validity);
+  g_free(out);
+  g_free(out_bits);
+  return result;
+}
+
+/* Evaluate a fused expression and store it as column [result_name].
+   Args: table_ptr, column names (string array), program (expr_op array),
+         result_name
+   Returns: Some(new_table_ptr), or None when a column is missing or not
+   Float64/Int64, the program is malformed, or a valid row divides by zero
+   or takes sqrt/log outside their domain. */
+CAMLprim value caml_arrow_eval_expression(value v_ptr, value v_columns,
+                                          value v_program, value v_result_name) {
+  CAMLparam4(v_ptr, v_columns, v_program, v_result_name);
+  GArrowTable *table = (GArrowTable *)Nativeint_val(v_ptr);
+  int n_cols = (int)Wosize_val(v_columns);
+  int n_code = (int)Wosize_val(v_program);
+  if (n_code == 0) CAMLreturn(Val_none);
+
+  ExprInstr *code = g_new(ExprInstr, n_code);
+  if (!expr_program_of_value(v_program, n_cols, code, n_code)) {
+    g_free(code);
+    CAMLreturn(Val_none);
+  }
+  char **names = g_new0(char *, n_cols + 1);
+  for (int j = 0; j < n_cols; j++) names[j] = g_strdup(String_val(Field(v_columns, j)));
+  char *result_name = g_strdup(String_val(v_result_name));
+
+  GArrowTable *result = NULL;
+  GError *error = NULL;
+  g_object_ref(table);
+  caml_enter_blocking_section();
+  GArrowChunkedArray *column = expr_evaluate(table, names, n_cols, code, n_code, &error);
+  if (column != NULL) {
+    result = table_with_column(table, result_name, column, &error);
+    g_object_unref(column);
+  }
+  caml_leave_blocking_section();
+  g_object_unref(table);
+  if (error) g_error_free(error);
+
+  g_strfreev(names);
+  g_free(result_name);
+  g_free(code);
+  CAMLreturn(native_table_option(result));
+}
+
+/* ===================================================================== */
+/* Arrow Window Operations                                               */
+/* ===================================================================== */
+
+/* --- Typed sort kernel ----------------------------------------------- */
+/* Sorts row indices by one or more key columns loaded as KeyColumns, so
+   int64 keys keep full precision and string keys are supported. NULLs sort
+   last and float NaNs sort after every number but before NULLs, in either
+   direction. Both paths are stable, so ties keep their original row order.
+
+   A single fixed-width key uses an LSD radix sort on order-preserving
+   64-bit images of the values; strings and multi-column keys use a merge
+   sort whose runs are sorted and merged on worker threads. */
+
+#define SORT_NAN_WORD 0x7ff8000000000000ULL
+#define SORT_INSERTION_RUN 32
+
+typedef struct {
+  const KeyColumn *keys;
+  const gboolean *descending;
+  int n_keys;
+} SortKeys;
+
+static inline gboolean
+sort_cell_is_nan(const KeyColumn *col, gint64 r) {
+  return col->tag == 1 && col->words[r] == SORT_NAN_WORD;
+}
+
+/* Order row a of keys ka against row b of keys kb, which may belong to
+   different tables with the same key types (the runs of an external sort). */
+static int
+sort_rows_compare(const KeyColumn *ka, gint64 a, const KeyColumn *kb, gint64 b,
+                  const gboolean *descending, int n_keys) {
+  for (int k = 0; k < n_keys; k++) {
+    const KeyColumn *ca = &ka[k], *cb = &kb[k];
+    gboolean an = ca->is_null[a], bn = cb->is_null[b];
+    if (an || bn) {
+      if (an && bn) continue;
+      return an ? 1 : -1;
+    }
+    gboolean anan = sort_cell_is_nan(ca, a), bnan = sort_cell_is_nan(cb, b);
+    if (anan || bnan) {
+      if (anan && bnan) continue;
+      return anan ? 1 : -1;
     }
+    int c = key_cells_compare(ca, a, cb, b);
+    if (c != 0) return descending[k] ? -c : c;
+  }
+  return 0;
+}
+
+static inline int
+sort_keys_compare(const SortKeys *sk, gint64 a, gint64 b) {
+  return sort_rows_compare(sk->keys, a, sk->keys, b, sk->descending, sk->n_keys);
+}
+
+/* Map a key cell to a word whose unsigned order is the key order. */
+static inline guint64
+sort_radix_word(const KeyColumn *col, gint64 r) {
+  guint64 w = col->words[r];
+  if (col->tag == 1) {
+    if (w == 0x8000000000000000ULL) w = 0;  /* -0.0 ties with 0.0 */
+    return (w & 0x8000000000000000ULL) ? ~w : w ^ 0x8000000000000000ULL;
+  }
+  if (col->tag == 2 || col->is_unsigned) return w;
+  return w ^ 0x8000000000000000ULL;
+}
+
+static void
+sort_radix_single(const KeyColumn *col, gboolean descending, gint64 n, gint64 *out) {
+  gint64 n_valid = 0, n_nan = 0;
+  for (gint64 r = 0; r < n; r++) {
+    if (col->is_null[r]) continue;
+    if (sort_cell_is_nan(col, r)) n_nan++;
+    else n_valid++;
+  }
+
+  /* NaN and NULL rows keep row order behind the sorted values. */
+  gint64 nan_pos = n_valid, null_pos = n_valid + n_nan;
+  guint64 *keys = g_new(guint64, n_valid > 0 ? n_valid : 1);
+  gint64 *idx = g_new(gint64, n_valid > 0 ? n_valid : 1);
+  gint64 v = 0;
+  for (gint64 r = 0; r < n; r++) {
+    if (col->is_null[r]) { out[null_pos++] = r; continue; }
+    if (sort_cell_is_nan(col, r)) { out[nan_pos++] = r; continue; }
+    guint64 w = sort_radix_word(col, r);
+    keys[v] = descending ? ~w : w;
+    idx[v] = r;
+    v++;
+  }
+
+  gint64 (*counts)[256] = g_malloc0(sizeof(gint64) * 256 * 8);
+  for (gint64 i = 0; i < n_valid; i++)
+    for (int pass = 0; pass < 8; pass++)
+      counts[pass][(keys[i] >> (pass * 8)) & 0xff]++;
+
+  guint64 *keys_tmp = g_new(guint64, n_valid > 0 ? n_valid : 1);
+  gint64 *idx_tmp = g_new(gint64, n_valid > 0 ? n_valid : 1);
+  for (int pass = 0; pass < 8; pass++) {
+    /* Skip bytes that are the same in every key, e.g. the high bytes of
+       small integers. */
+    if (n_valid == 0 || counts[pass][(keys[0] >> (pass * 8)) & 0xff] == n_valid)
+      continue;
+    gint64 offset = 0;
+    for (int b = 0; b < 256; b++) {
+      gint64 c = counts[pass][b];
+      counts[pass][b] = offset;
+      offset += c;
+    }
+    for (gint64 i = 0; i < n_valid; i++) {
+      gint64 dst = counts[pass][(keys[i] >> (pass * 8)) & 0xff]++;
+      keys_tmp[dst] = keys[i];
+      idx_tmp[dst] = idx[i];
+    }
+    guint64 *ks = keys; keys = keys_tmp; keys_tmp = ks;
+    gint64 *is = idx; idx = idx_tmp; idx_tmp = is;
+  }
+  memcpy(out, idx, sizeof(gint64) * (size_t)n_valid);
+
+  g_free(counts);
+  g_free(keys);
+  g_free(keys_tmp);
+  g_free(idx);
+  g_free(idx_tmp);
+}
+
+/* Stable merge of src[lo, mid) and src[mid, hi) into dst[lo, hi). */
+static void
+sort_merge(const SortKeys *sk, const gint64 *src, gint64 lo, gint64 mid, gint64 hi,
+           gint64 *dst) {
+  gint64 i = lo, j = mid, o = lo;
+  while (i < mid && j < hi) {
+    if (sort_keys_compare(sk, src[j], src[i]) < 0) dst[o++] = src[j++];
+    else dst[o++] = src[i++];
+  }
+  while (i < mid) dst[o++] = src[i++];
+  while (j < hi) dst[o++] = src[j++];
+}
+
+/* Sort idx[lo, hi) in place, using tmp[lo, hi) as scratch. */
+static void
+sort_run(const SortKeys *sk, gint64 *idx, gint64 *tmp, gint64 lo, gint64 hi) {
+  for (gint64 s = lo; s < hi; s += SORT_INSERTION_RUN) {
+    gint64 e = MIN(s + SORT_INSERTION_RUN, hi);
+    for (gint64 i = s + 1; i < e; i++) {
+      gint64 x = idx[i], j = i;
+      while (j > s && sort_keys_compare(sk, x, idx[j - 1]) < 0) {
+        idx[j] = idx[j - 1];
+        j--;
+      }
+      idx[j] = x;
+    }
+  }
+  gint64 *src = idx, *dst = tmp;
+  for (gint64 width = SORT_INSERTION_RUN; width < hi - lo; width *= 2) {
+    for (gint64 s = lo; s < hi; s += 2 * width) {
+      gint64 mid = MIN(s + width, hi), e = MIN(s + 2 * width, hi);
+      sort_merge(sk, src, s, mid, e, dst);
+    }
+    gint64 *t = src; src = dst; dst = t;
+  }
+  if (src != idx) memcpy(idx + lo, src + lo, sizeof(gint64) * (size_t)(hi - lo));
+}
+
+typedef struct {
+  const SortKeys *sk;
+  gint64 *idx;
+  gint64 *tmp;
+  gint64 lo;
+  gint64 mid;
+  gint64 hi;
+} SortTask;
+
+static gpointer
+sort_run_task(gpointer data) {
+  SortTask *task = (SortTask *)data;
+  sort_run(task->sk, task->idx, task->tmp, task->lo, task->hi);
+  return NULL;
+}
+
+static gpointer
+sort_merge_task(gpointer data) {
+  SortTask *task = (SortTask *)data;
+  sort_merge(task->sk, task->idx, task->lo, task->mid, task->hi, task->tmp);
+  return NULL;
+}
+
+static void
+sort_merge_parallel(const SortKeys *sk, gint64 n, gint64 *out) {
+  for (gint64 r = 0; r < n; r++) out[r] = r;
+  gint64 *tmp = g_new(gint64, n > 0 ? n : 1);
+  int n_runs = parallel_thread_count(n);
+  gint64 *bounds = g_new(gint64, n_runs + 1);
+  for (int t = 0; t <= n_runs; t++) bounds[t] = n * t / n_runs;
+
+  SortTask *tasks = g_new(SortTask, n_runs);
+  for (int t = 0; t < n_runs; t++) {
+    tasks[t] = (SortTask){ sk, out, tmp, bounds[t], bounds[t], bounds[t + 1] };
+  }
+  parallel_run(sort_run_task, tasks, sizeof(SortTask), n_runs);
+
+  /* Merge neighbouring runs pairwise until one remains. */
+  gint64 *src = out, *dst = tmp;
+  while (n_runs > 1) {
+    int n_merges = n_runs / 2;
+    for (int m = 0; m < n_merges; m++) {
+      tasks[m] = (SortTask){ sk, src, dst, bounds[2 * m], bounds[2 * m + 1], bounds[2 * m + 2] };
+    }
+    parallel_run(sort_merge_task, tasks, sizeof(SortTask), n_merges);
+    if (n_runs % 2 == 1) {
+      gint64 lo = bounds[n_runs - 1];
+      memcpy(dst + lo, src + lo, sizeof(gint64) * (size_t)(n - lo));
+    }
+    int kept = 0;
+    for (int t = 0; t <= n_runs; t += 2) bounds[kept++] = bounds[t];
+    if (n_runs % 2 == 1) bounds[kept++] = n;
+    n_runs = kept - 1;
+    gint64 *t = src; src = dst; dst = t;
+  }
+  if (src != out) memcpy(out, src, sizeof(gint64) * (size_t)n);
+
+  g_free(tasks);
+  g_free(bounds);
+  g_free(tmp);
+}
+
+/* Fill out[0, n) with the row order of the keys. */
+static void
+sort_rows_by_keys(const KeyColumn *keys, const gboolean *descending, int n_keys,
+                  gint64 n, gint64 *out) {
+  if (n_keys == 1 && keys[0].tag != 3) {
+    sort_radix_single(&keys[0], descending[0], n, out);
+    return;
+  }
+  SortKeys sk = { keys, descending, n_keys };
+  sort_merge_parallel(&sk, n, out);
+}
+
+/* --- Sort indices ---------------------------------------------------- */
+/* (nativeint table_ptr, string list col_names, bool list ascending)
+     -> int array option
+   Returns 0-based row indices that sort the table by the columns, the
+   first column being the primary key. None for unsupported column types. */
+
+CAMLprim value caml_arrow_compute_sort_indices(value v_ptr, value v_cols, value v_asc) {
+  CAMLparam3(v_ptr, v_cols, v_asc);
+  CAMLlocal2(v_result, v_arr);
+
+  GArrowTable *table = (GArrowTable *)Nativeint_val(v_ptr);
+
+  int n_keys = 0;
+  for (value it = v_cols; it != Val_emptylist; it = Field(it, 1)) n_keys++;
+  if (n_keys == 0 || table == NULL) CAMLreturn(Val_none);
+
+  gchar **names = g_new0(gchar *, n_keys + 1);
+  gboolean *descending = g_new0(gboolean, n_keys);
+  {
+    int k = 0;
+    value a = v_asc;
+    for (value it = v_cols; it != Val_emptylist; it = Field(it, 1), k++) {
+      names[k] = g_strdup(String_val(Field(it, 0)));
+      if (a != Val_emptylist) {
+        descending[k] = !Bool_val(Field(a, 0));
+        a = Field(a, 1);
+      }
+    }
+  }
+
+  gint64 nrows = 0;
+  gint64 *order = NULL;
+
+  g_object_ref(table);
+  caml_enter_blocking_section();
+  KeyColumn *keys = g_new0(KeyColumn, n_keys);
+  GPtrArray *hold = g_ptr_array_new_with_free_func(g_object_unref);
+  nrows = garrow_table_get_n_rows(table);
+  if (nrows <= G_MAXINT32 && key_columns_load(table, names, n_keys, keys, hold)) {
+    order = g_new(gint64, nrows > 0 ? nrows : 1);
+    sort_rows_by_keys(keys, descending, n_keys, nrows, order);
+    for (int k = 0; k < n_keys; k++) key_column_free(&keys[k]);
+  }
+  g_ptr_array_unref(hold);
+  g_free(keys);
+  caml_leave_blocking_section();
+  g_object_unref(table);
+
+  g_strfreev(names);
+  g_free(descending);
+  if (order == NULL) CAMLreturn(Val_none);
+
+  v_arr = caml_alloc(nrows, 0);
+  for (gint64 i = 0; i < nrows; i++) {
+    Store_field(v_arr, i, Val_long(order[i]));
   }
-  free(is_null_flag);
-  free(ranks);
+  g_free(order);
 
   v_result = caml_alloc(1, 0);
   Store_field(v_result, 0, v_arr);
   CAMLreturn(v_result);
 }
 
-/* --- Lag column ------------------------------------------------------ */
-/* (nativeint table_ptr, string col_name, int offset) -> nativeint option
-   Shifts a numeric column forward by `offset` rows, filling NAs at start.
-   Returns a new table with the column replaced. */
+/* --- Spilling -------------------------------------------------------- */
+/* Memory-budgeted sort and partitioning for tables larger than the limit
+   set through Spill (TLANG_MEMORY_LIMIT). Both write Arrow IPC files to a
+   scratch directory and read them back memory-mapped, so the working set
+   is one run or window of rows instead of the whole table plus its
+   intermediates. The files are unlinked before returning; mapped results
+   keep their pages until the table is freed. Dictionary keys are refused,
+   since their codes come from a unifier per window and would not agree
+   across windows. */
 
-CAMLprim value caml_arrow_compute_lag_column(value v_ptr, value v_col, value v_offset) {
-  CAMLparam3(v_ptr, v_col, v_offset);
-  CAMLlocal1(v_result);
+#define SPILL_WINDOW_ROWS 65536
 
-  GArrowTable *table = (GArrowTable *)Nativeint_val(v_ptr);
-  const char *col_name = String_val(v_col);
-  int offset = Int_val(v_offset);
+static gint spill_file_serial = 0;
 
+static gchar *
+spill_file_path(const gchar *dir) {
+  gint serial = g_atomic_int_add(&spill_file_serial, 1);
+  return g_strdup_printf("%s/tlang-spill-%d-%d.arrow", dir, (int)getpid(), serial);
+}
+
+static gboolean
+spill_keys_supported(GArrowTable *table, gchar **names, int n_keys) {
   GArrowSchema *schema = garrow_table_get_schema(table);
-  gint col_idx = garrow_schema_get_field_index(schema, col_name);
-  if (col_idx < 0) {
-    g_object_unref(schema);
-    CAMLreturn(Val_none);
+  gboolean ok = TRUE;
+  for (int k = 0; k < n_keys && ok; k++) {
+    gint idx = garrow_schema_get_field_index(schema, names[k]);
+    if (idx < 0) { ok = FALSE; break; }
+    GArrowField *field = garrow_schema_get_field(schema, idx);
+    int tag = key_column_tag(garrow_field_get_data_type(field));
+    g_object_unref(field);
+    ok = tag >= 0 && tag != 8;
   }
+  g_object_unref(schema);
+  return ok;
+}
 
-  GArrowField *field = garrow_schema_get_field(schema, col_idx);
-  /* dtype is transfer-none from garrow_field_get_data_type — owned by field,
-     do not unref dtype separately; field is unreffed after use. */
-  GArrowDataType *dtype = garrow_field_get_data_type(field);
+/* An uncompressed IPC file being written batch by batch. */
+typedef struct {
+  GArrowFileOutputStream *output;
+  GArrowRecordBatchFileWriter *writer;
+} SpillWriter;
 
-  gint64 nrows = garrow_table_get_n_rows(table);
-  GArrowChunkedArray *chunked = garrow_table_get_column_data(table, col_idx);
-  if (chunked == NULL) {
-    g_object_unref(field);
+static gboolean
+spill_writer_open(SpillWriter *w, const gchar *path, GArrowSchema *schema, GError **error) {
+  w->writer = NULL;
+  w->output = garrow_file_output_stream_new(path, FALSE, error);
+  if (w->output == NULL) return FALSE;
+  w->writer = garrow_record_batch_file_writer_new(GARROW_OUTPUT_STREAM(w->output), schema, error);
+  return w->writer != NULL;
+}
+
+static gboolean
+spill_writer_write(SpillWriter *w, GArrowTable *table, GError **error) {
+  return garrow_record_batch_writer_write_table(GARROW_RECORD_BATCH_WRITER(w->writer), table, error);
+}
+
+static gboolean
+spill_writer_close(SpillWriter *w, GError **error) {
+  gboolean ok = TRUE;
+  if (w->writer != NULL) {
+    ok = garrow_record_batch_writer_close(GARROW_RECORD_BATCH_WRITER(w->writer), error);
+    g_object_unref(w->writer);
+  }
+  if (w->output != NULL) g_object_unref(w->output);
+  w->writer = NULL;
+  w->output = NULL;
+  return ok;
+}
+
+static gboolean
+spill_write_table(GArrowTable *table, const gchar *path, GError **error) {
+  SpillWriter w;
+  GArrowSchema *schema = garrow_table_get_schema(table);
+  gboolean ok = spill_writer_open(&w, path, schema, error) &&
+                spill_writer_write(&w, table, error);
+  g_object_unref(schema);
+  return spill_writer_close(&w, ok ? error : NULL) && ok;
+}
+
+static GArrowTable *
+spill_take(GArrowTable *table, const gint64 *idx, gint64 n, GError **error) {
+  GArrowTable *result = NULL;
+  GArrowInt64ArrayBuilder *builder = garrow_int64_array_builder_new();
+  if (garrow_int64_array_builder_append_values(builder, idx, n, NULL, 0, error)) {
+    GArrowArray *indices = garrow_array_builder_finish(GARROW_ARRAY_BUILDER(builder), error);
+    if (indices != NULL) {
+      result = garrow_table_take(table, indices, NULL, error);
+      g_object_unref(indices);
+    }
+  }
+  g_object_unref(builder);
+  return result;
+}
+
+/* One sorted run of an external sort, mapped from its file. Only a window
+   of its keys is loaded at a time. */
+typedef struct {
+  GArrowTable *table;
+  gint64 n_rows;
+  gint64 offset;     /* first row of the run in the concatenated runs */
+  gint64 pos;        /* next row to merge */
+  gint64 win_start;
+  gint64 win_end;
+  GArrowTable *window;
+  KeyColumn *keys;
+  GPtrArray *hold;
+} SpillRun;
+
+static void
+spill_run_release_window(SpillRun *run, int n_keys) {
+  if (run->window == NULL) return;
+  for (int k = 0; k < n_keys; k++) key_column_free(&run->keys[k]);
+  g_ptr_array_unref(run->hold);
+  g_object_unref(run->window);
+  run->window = NULL;
+  run->hold = NULL;
+}
+
+static gboolean
+spill_run_load_window(SpillRun *run, gchar **names, int n_keys) {
+  spill_run_release_window(run, n_keys);
+  gint64 len = MIN((gint64)SPILL_WINDOW_ROWS, run->n_rows - run->pos);
+  run->window = garrow_table_slice(run->table, run->pos, len);
+  run->hold = g_ptr_array_new_with_free_func(g_object_unref);
+  run->win_start = run->pos;
+  run->win_end = run->pos + len;
+  if (run->window != NULL && key_columns_load(run->window, names, n_keys, run->keys, run->hold))
+    return TRUE;
+  if (run->window != NULL) g_object_unref(run->window);
+  g_ptr_array_unref(run->hold);
+  run->window = NULL;
+  run->hold = NULL;
+  return FALSE;
+}
+
+/* Ties go to the earlier run, which keeps the merge stable. */
+static int
+spill_run_compare(const SpillRun *runs, int a, int b, const gboolean *descending, int n_keys) {
+  const SpillRun *ra = &runs[a], *rb = &runs[b];
+  int c = sort_rows_compare(ra->keys, ra->pos - ra->win_start,
+                            rb->keys, rb->pos - rb->win_start, descending, n_keys);
+  if (c != 0) return c;
+  return a < b ? -1 : (a > b ? 1 : 0);
+}
+
+static void
+spill_heap_sift(int *heap, int n, int i, const SpillRun *runs,
+                const gboolean *descending, int n_keys) {
+  for (;;) {
+    int l = 2 * i + 1, r = l + 1, m = i;
+    if (l < n && spill_run_compare(runs, heap[l], heap[m], descending, n_keys) < 0) m = l;
+    if (r < n && spill_run_compare(runs, heap[r], heap[m], descending, n_keys) < 0) m = r;
+    if (m == i) return;
+    int t = heap[i]; heap[i] = heap[m]; heap[m] = t;
+    i = m;
+  }
+}
+
+/* Sort [table] by the keys in runs of [run_rows] rows, each sorted with the
+   typed sort kernel and written to [dir], then k-way merge the mapped runs
+   into one more file, written SPILL_WINDOW_ROWS rows at a time. Returns
+   the mapped result, or NULL on failure. Must be called outside the OCaml
+   runtime lock. */
+static GArrowTable *
+spill_sort_table(GArrowTable *table, gchar **names, const gboolean *descending,
+                 int n_keys, gint64 run_rows, const gchar *dir, GError **error) {
+  gint64 n = garrow_table_get_n_rows(table);
+  if (n == 0 || run_rows <= 0 || !spill_keys_supported(table, names, n_keys)) return NULL;
+  int n_runs = (int)((n + run_rows - 1) / run_rows);
+  gchar **paths = g_new0(gchar *, n_runs + 2);
+  SpillRun *runs = g_new0(SpillRun, n_runs);
+  gboolean ok = TRUE;
+
+  /* Pass 1: sorted runs. */
+  for (int r = 0; r < n_runs && ok; r++) {
+    gint64 start = (gint64)r * run_rows, len = MIN(run_rows, n - start);
+    GArrowTable *slice = garrow_table_slice(table, start, len);
+    KeyColumn *keys = g_new0(KeyColumn, n_keys);
+    GPtrArray *hold = g_ptr_array_new_with_free_func(g_object_unref);
+    ok = slice != NULL && key_columns_load(slice, names, n_keys, keys, hold);
+    if (ok) {
+      gint64 *order = g_new(gint64, len);
+      sort_rows_by_keys(keys, descending, n_keys, len, order);
+      for (int k = 0; k < n_keys; k++) key_column_free(&keys[k]);
+      GArrowTable *sorted = spill_take(slice, order, len, error);
+      g_free(order);
+      paths[r] = spill_file_path(dir);
+      ok = sorted != NULL && spill_write_table(sorted, paths[r], error);
+      if (sorted != NULL) g_object_unref(sorted);
+    }
+    g_ptr_array_unref(hold);
+    g_free(keys);
+    if (slice != NULL) g_object_unref(slice);
+  }
+
+  /* Pass 2: merge. Output rows are taken from the runs concatenated, which
+     only references the mapped chunks. */
+  GArrowTable *concat = NULL;
+  GList *others = NULL;
+  gint64 offset = 0;
+  for (int r = 0; r < n_runs && ok; r++) {
+    runs[r].table = ipc_table_read_mapped(paths[r], error);
+    if (runs[r].table == NULL) { ok = FALSE; break; }
+    runs[r].n_rows = garrow_table_get_n_rows(runs[r].table);
+    runs[r].offset = offset;
+    runs[r].keys = g_new0(KeyColumn, n_keys);
+    offset += runs[r].n_rows;
+    if (r > 0) others = g_list_append(others, runs[r].table);
+  }
+  if (ok) {
+    concat = garrow_table_concatenate(runs[0].table, others, NULL, error);
+    ok = concat != NULL;
+  }
+  g_list_free(others);
+
+  GArrowTable *result = NULL;
+  if (ok) {
+    int *heap = g_new(int, n_runs);
+    int heap_n = 0;
+    for (int r = 0; r < n_runs && ok; r++) {
+      ok = spill_run_load_window(&runs[r], names, n_keys);
+      heap[heap_n++] = r;
+    }
+    for (int i = heap_n / 2 - 1; ok && i >= 0; i--)
+      spill_heap_sift(heap, heap_n, i, runs, descending, n_keys);
+
+    SpillWriter out = { NULL, NULL };
+    GArrowSchema *schema = garrow_table_get_schema(table);
+    paths[n_runs] = spill_file_path(dir);
+    ok = ok && spill_writer_open(&out, paths[n_runs], schema, error);
     g_object_unref(schema);
-    CAMLreturn(Val_none);
+
+    gint64 *batch = g_new(gint64, SPILL_WINDOW_ROWS);
+    gint64 n_batch = 0;
+    while (ok && heap_n > 0) {
+      SpillRun *run = &runs[heap[0]];
+      batch[n_batch++] = run->offset + run->pos;
+      run->pos++;
+      if (run->pos == run->n_rows) {
+        spill_run_release_window(run, n_keys);
+        heap[0] = heap[--heap_n];
+      } else if (run->pos == run->win_end) {
+        ok = spill_run_load_window(run, names, n_keys);
+      }
+      if (ok && heap_n > 0) spill_heap_sift(heap, heap_n, 0, runs, descending, n_keys);
+      if (ok && (n_batch == SPILL_WINDOW_ROWS || (heap_n == 0 && n_batch > 0))) {
+        GArrowTable *part = spill_take(concat, batch, n_batch, error);
+        ok = part != NULL && spill_writer_write(&out, part, error);
+        if (part != NULL) g_object_unref(part);
+        n_batch = 0;
+      }
+    }
+    g_free(batch);
+    g_free(heap);
+    ok = spill_writer_close(&out, ok ? error : NULL) && ok;
+    if (ok) result = ipc_table_read_mapped(paths[n_runs], error);
+  }
+
+  for (int r = 0; r < n_runs; r++) {
+    spill_run_release_window(&runs[r], n_keys);
+    g_free(runs[r].keys);
+    if (runs[r].table != NULL) g_object_unref(runs[r].table);
+  }
+  if (concat != NULL) g_object_unref(concat);
+  for (int r = 0; r <= n_runs; r++) {
+    if (paths[r] != NULL) unlink(paths[r]);
   }
+  g_strfreev(paths);
+  g_free(runs);
+  return result;
+}
 
-  NumericChunkCursor cursor;
-  numeric_chunk_cursor_init(&cursor, chunked);
+/* Split [table] into [n_parts] IPC files by a hash of the keys, reading
+   SPILL_WINDOW_ROWS rows at a time, so equal keys land in the same file
+   and each file keeps the input's row order. With [with_row_ids] every file
+   gains an int64 column `__spill_row` holding the input row number. Paths
+   of the non-empty files are stored in [paths] (NULL-terminated, in
+   partition order). Must be called outside the OCaml runtime lock. */
+static gboolean
+spill_partition_table(GArrowTable *table, gchar **names, int n_keys, int n_parts,
+                      const gchar *dir, gboolean with_row_ids, gchar ***paths_out,
+                      GError **error) {
+  if (n_parts < 1 || !spill_keys_supported(table, names, n_keys)) return FALSE;
+  gint64 n = garrow_table_get_n_rows(table);
+  SpillWriter *writers = g_new0(SpillWriter, n_parts);
+  gchar **paths = g_new0(gchar *, n_parts + 1);
+  guint64 *hashes = g_new(guint64, SPILL_WINDOW_ROWS);
+  gint64 *idx = g_new(gint64, SPILL_WINDOW_ROWS);
+  gint64 *ids = g_new(gint64, SPILL_WINDOW_ROWS);
+  gint64 *bounds = g_new(gint64, n_parts + 1);
+  KeyColumn *keys = g_new0(KeyColumn, n_keys);
+  gboolean ok = TRUE;
 
+  for (gint64 off = 0; off < n && ok; off += SPILL_WINDOW_ROWS) {
+    gint64 len = MIN((gint64)SPILL_WINDOW_ROWS, n - off);
+    GArrowTable *slice = garrow_table_slice(table, off, len);
+    GPtrArray *hold = g_ptr_array_new_with_free_func(g_object_unref);
+    ok = slice != NULL && key_columns_load(slice, names, n_keys, keys, hold);
+    if (ok) {
+      key_hash_rows_parallel(keys, n_keys, len, hashes);
+      for (int k = 0; k < n_keys; k++) key_column_free(&keys[k]);
+    }
+    g_ptr_array_unref(hold);
+
+    /* Counting sort of the window's rows by partition. The partition is
+       taken from a remix of the hash so that the group-by run on each file
+       does not see keys that all agree in their low hash bits. */
+    if (ok) {
+      memset(bounds, 0, sizeof(gint64) * (size_t)(n_parts + 1));
+      for (gint64 i = 0; i < len; i++) {
+        hashes[i] = key_mix64(hashes[i]) % (guint64)n_parts;
+        bounds[hashes[i] + 1]++;
+      }
+      for (int p = 0; p < n_parts; p++) bounds[p + 1] += bounds[p];
+      gint64 *fill = g_new(gint64, n_parts);
+      memcpy(fill, bounds, sizeof(gint64) * (size_t)n_parts);
+      for (gint64 i = 0; i < len; i++) idx[fill[hashes[i]]++] = i;
+      g_free(fill);
+    }
+
+    for (int p = 0; p < n_parts && ok; p++) {
+      gint64 count = bounds[p + 1] - bounds[p];
+      if (count == 0) continue;
+      GArrowTable *part = spill_take(slice, idx + bounds[p], count, error);
+      if (part != NULL && with_row_ids) {
+        for (gint64 i = 0; i < count; i++) ids[i] = off + idx[bounds[p] + i];
+        GArrowBuffer *id_data = arrow_buffer_copy(ids, sizeof(gint64) * (size_t)count);
+        GArrowArray *id_array = GARROW_ARRAY(garrow_int64_array_new(count, id_data, NULL, 0));
+        g_object_unref(id_data);
+        GList *chunks = g_list_append(NULL, id_array);
+        GArrowChunkedArray *column = garrow_chunked_array_new(chunks, error);
+        g_list_free(chunks);
+        g_object_unref(id_array);
+        GArrowTable *with_ids =
+          column != NULL ? table_with_column(part, "__spill_row", column, error) : NULL;
+        if (column != NULL) g_object_unref(column);
+        g_object_unref(part);
+        part = with_ids;
+      }
+      if (part != NULL && writers[p].writer == NULL) {
+        GArrowSchema *schema = garrow_table_get_schema(part);
+        paths[p] = spill_file_path(dir);
+        ok = spill_writer_open(&writers[p], paths[p], schema, error);
+        g_object_unref(schema);
+      }
+      ok = ok && part != NULL && spill_writer_write(&writers[p], part, error);
+      if (part != NULL) g_object_unref(part);
+    }
+    if (slice != NULL) g_object_unref(slice);
+  }
+
+  for (int p = 0; p < n_parts; p++)
+    ok = spill_writer_close(&writers[p], ok ? error : NULL) && ok;
+
+  /* Compact the paths of the partitions that received rows. */
+  int kept = 0;
+  for (int p = 0; p < n_parts; p++) {
+    if (paths[p] == NULL) continue;
+    if (!ok) { unlink(paths[p]); g_free(paths[p]); continue; }
+    paths[kept++] = paths[p];
+  }
+  for (int p = kept; p <= n_parts; p++) paths[p] = NULL;
+
+  g_free(writers);
+  g_free(hashes);
+  g_free(idx);
+  g_free(ids);
+  g_free(bounds);
+  g_free(keys);
+  if (!ok) {
+    g_free(paths);
+    return FALSE;
+  }
+  *paths_out = paths;
+  return TRUE;
+}
+
+static gchar **
+spill_key_names(value v_cols, int *n_keys) {
+  int n = 0;
+  for (value it = v_cols; it != Val_emptylist; it = Field(it, 1)) n++;
+  gchar **names = g_new0(gchar *, n + 1);
+  int k = 0;
+  for (value it = v_cols; it != Val_emptylist; it = Field(it, 1))
+    names[k++] = g_strdup(String_val(Field(it, 0)));
+  *n_keys = n;
+  return names;
+}
+
+/* (nativeint table_ptr, string list col_names, bool list ascending,
+    int run_rows, string dir) -> nativeint option
+   External merge sort, see spill_sort_table. Same order as
+   caml_arrow_compute_sort_indices. */
+CAMLprim value caml_arrow_spill_sort(value v_ptr, value v_cols, value v_asc,
+                                     value v_run_rows, value v_dir) {
+  CAMLparam5(v_ptr, v_cols, v_asc, v_run_rows, v_dir);
+  GArrowTable *table = (GArrowTable *)Nativeint_val(v_ptr);
+  int n_keys = 0;
+  gchar **names = spill_key_names(v_cols, &n_keys);
+  gboolean *descending = g_new0(gboolean, n_keys > 0 ? n_keys : 1);
+  {
+    int k = 0;
+    for (value a = v_asc; a != Val_emptylist && k < n_keys; a = Field(a, 1), k++)
+      descending[k] = !Bool_val(Field(a, 0));
+  }
+  gint64 run_rows = Long_val(v_run_rows);
+  gchar *dir = g_strdup(String_val(v_dir));
   GError *error = NULL;
-  GArrowArrayBuilder *builder = NULL;
-  gboolean is_int64 = GARROW_IS_INT64_DATA_TYPE(dtype);
-  gboolean is_double = GARROW_IS_DOUBLE_DATA_TYPE(dtype);
+  GArrowTable *result = NULL;
 
-  if (is_int64) {
-    builder = (GArrowArrayBuilder *)garrow_int64_array_builder_new();
-  } else if (is_double) {
-    builder = (GArrowArrayBuilder *)garrow_double_array_builder_new();
-  } else {
-    /* Unsupported column type — return None to trigger OCaml fallback */
-    numeric_chunk_cursor_destroy(&cursor);
+  if (table != NULL && n_keys > 0) {
+    g_object_ref(table);
+    caml_enter_blocking_section();
+    result = spill_sort_table(table, names, descending, n_keys, run_rows, dir, &error);
+    caml_leave_blocking_section();
+    g_object_unref(table);
+  }
+
+  if (error) g_error_free(error);
+  g_strfreev(names);
+  g_free(descending);
+  g_free(dir);
+  CAMLreturn(native_table_option(result));
+}
+
+/* (nativeint table_ptr, string list col_names, int n_parts, string dir,
+    bool with_row_ids) -> string list option
+   Hash partitioning to IPC files, see spill_partition_table. The caller
+   reads and removes the files. */
+CAMLprim value caml_arrow_spill_partition(value v_ptr, value v_cols, value v_n_parts,
+                                          value v_dir, value v_row_ids) {
+  CAMLparam5(v_ptr, v_cols, v_n_parts, v_dir, v_row_ids);
+  CAMLlocal3(v_list, v_cell, v_result);
+  GArrowTable *table = (GArrowTable *)Nativeint_val(v_ptr);
+  int n_keys = 0;
+  gchar **names = spill_key_names(v_cols, &n_keys);
+  int n_parts = Int_val(v_n_parts);
+  gboolean with_row_ids = Bool_val(v_row_ids);
+  gchar *dir = g_strdup(String_val(v_dir));
+  GError *error = NULL;
+  gchar **paths = NULL;
+  gboolean ok = FALSE;
+
+  if (table != NULL && n_keys > 0) {
+    g_object_ref(table);
+    caml_enter_blocking_section();
+    ok = spill_partition_table(table, names, n_keys, n_parts, dir, with_row_ids, &paths, &error);
+    caml_leave_blocking_section();
+    g_object_unref(table);
+  }
+
+  if (error) g_error_free(error);
+  g_strfreev(names);
+  g_free(dir);
+  if (!ok) CAMLreturn(Val_none);
+
+  int n_paths = 0;
+  while (paths[n_paths] != NULL) n_paths++;
+  v_list = Val_emptylist;
+  for (int p = n_paths - 1; p >= 0; p--) {
+    v_cell = caml_alloc(2, 0);
+    Store_field(v_cell, 0, caml_copy_string(paths[p]));
+    Store_field(v_cell, 1, v_list);
+    v_list = v_cell;
+  }
+  g_strfreev(paths);
+  v_result = caml_alloc(1, 0);
+  Store_field(v_result, 0, v_list);
+  CAMLreturn(v_result);
+}
+
+/* Estimated bytes held by a table's buffers: value widths for fixed-width
+   columns, offsets plus character data for strings and 8 bytes per row for
+   anything else, plus the validity bitmaps. Used to decide when to spill. */
+CAMLprim value caml_arrow_table_nbytes(value v_ptr) {
+  CAMLparam1(v_ptr);
+  GArrowTable *table = (GArrowTable *)Nativeint_val(v_ptr);
+  gint64 total = 0;
+  guint n_cols = garrow_table_get_n_columns(table);
+  for (guint c = 0; c < n_cols; c++) {
+    GArrowChunkedArray *chunked = garrow_table_get_column_data(table, (gint)c);
+    guint n_chunks = garrow_chunked_array_get_n_chunks(chunked);
+    for (guint i = 0; i < n_chunks; i++) {
+      GArrowArray *chunk = garrow_chunked_array_get_chunk(chunked, i);
+      gint64 len = garrow_array_get_length(chunk);
+      GArrowDataType *dtype = garrow_array_get_value_data_type(chunk);
+      total += (len + 7) / 8;
+      if (GARROW_IS_STRING_ARRAY(chunk)) {
+        GArrowBuffer *data = garrow_binary_array_get_data_buffer(GARROW_BINARY_ARRAY(chunk));
+        total += 4 * (len + 1);
+        if (data != NULL) {
+          total += garrow_buffer_get_size(data);
+          g_object_unref(data);
+        }
+      } else if (GARROW_IS_FIXED_WIDTH_DATA_TYPE(dtype)) {
+        gint bits = garrow_fixed_width_data_type_get_bit_width(GARROW_FIXED_WIDTH_DATA_TYPE(dtype));
+        total += (len * bits + 7) / 8;
+      } else {
+        total += 8 * len;
+      }
+      g_object_unref(dtype);
+      g_object_unref(chunk);
+    }
     g_object_unref(chunked);
-    g_object_unref(field);
-    g_object_unref(schema);
-    CAMLreturn(Val_none);
   }
+  CAMLreturn(Val_long(total));
+}
+
+/* --- Rank ------------------------------------------------------------ */
+/* Ranks a numeric column with the typed sort kernel. Ties are exact value
+   matches, so int64 values above 2^53 are not merged. */
+
+enum { RANK_ROW_NUMBER = 0, RANK_MIN = 1, RANK_DENSE = 2 };
+
+/* Fill ranks[0, nrows) (0 for NULL rows) and set *nrows. Returns FALSE when
+   the column is missing or not numeric. */
+static gboolean
+rank_column_rows(GArrowTable *table, const gchar *col_name, int rank_type,
+                 gint64 *nrows, gint32 **ranks_out) {
+  gchar *names[1] = { (gchar *)col_name };
+  KeyColumn key;
+  GPtrArray *hold = g_ptr_array_new_with_free_func(g_object_unref);
+  gint64 n = garrow_table_get_n_rows(table);
+  gboolean ok = n <= G_MAXINT32 && key_columns_load(table, names, 1, &key, hold);
+  if (ok && key.tag != 0 && key.tag != 1) {
+    key_column_free(&key);
+    ok = FALSE;
+  }
+  if (!ok) {
+    g_ptr_array_unref(hold);
+    return FALSE;
+  }
+
+  gint64 *order = g_new(gint64, n > 0 ? n : 1);
+  gboolean ascending = FALSE;
+  sort_rows_by_keys(&key, &ascending, 1, n, order);
+
+  gint32 *ranks = g_new0(gint32, n > 0 ? n : 1);
+  gint32 current = 0;
+  for (gint64 i = 0; i < n; i++) {
+    gint64 r = order[i];
+    if (key.is_null[r]) break;  /* NULLs are sorted last */
+    gboolean tie = i > 0 && key_rows_equal(&key, order[i - 1], &key, r, 1);
+    switch (rank_type) {
+    case RANK_ROW_NUMBER: current = (gint32)(i + 1); break;
+    case RANK_MIN: if (!tie) current = (gint32)(i + 1); break;
+    case RANK_DENSE: if (!tie) current++; break;
+    default: current = 0; break;
+    }
+    ranks[r] = current;
+  }
+
+  g_free(order);
+  key_column_free(&key);
+  g_ptr_array_unref(hold);
+  *nrows = n;
+  *ranks_out = ranks;
+  return TRUE;
+}
+
+/* Shared body of the rank entry points: None for unsupported columns,
+   otherwise an int option array with None at NULL rows. */
+static value
+rank_column_to_caml(value v_ptr, value v_col, int rank_type) {
+  CAMLparam2(v_ptr, v_col);
+  CAMLlocal3(v_result, v_arr, v_some);
+
+  GArrowTable *table = (GArrowTable *)Nativeint_val(v_ptr);
+  gchar *col_name = g_strdup(String_val(v_col));
+  gint64 nrows = 0;
+  gint32 *ranks = NULL;
+
+  g_object_ref(table);
+  caml_enter_blocking_section();
+  gboolean ok = rank_column_rows(table, col_name, rank_type, &nrows, &ranks);
+  caml_leave_blocking_section();
+  g_object_unref(table);
+
+  g_free(col_name);
+  if (!ok) CAMLreturn(Val_none);
 
+  v_arr = caml_alloc(nrows, 0);
   for (gint64 i = 0; i < nrows; i++) {
-    gint64 src_row = i - (gint64)offset;
-    if (src_row < 0 || src_row >= nrows) {
-      garrow_array_builder_append_null(builder, &error);
+    if (ranks[i] == 0) {
+      Store_field(v_arr, i, Val_none);
     } else {
-      gboolean is_null;
-      gdouble val;
-      if (!get_numeric_value(&cursor, src_row, &is_null, &val) || is_null) {
-        garrow_array_builder_append_null(builder, &error);
-      } else if (is_int64) {
-        garrow_int64_array_builder_append_value(
-            GARROW_INT64_ARRAY_BUILDER(builder), (gint64)val, &error);
-      } else {
-        garrow_double_array_builder_append_value(
-            GARROW_DOUBLE_ARRAY_BUILDER(builder), val, &error);
+      v_some = caml_alloc(1, 0);
+      Store_field(v_some, 0, Val_int(ranks[i]));
+      Store_field(v_arr, i, v_some);
+    }
+  }
+  g_free(ranks);
+
+  v_result = caml_alloc(1, 0);
+  Store_field(v_result, 0, v_arr);
+  CAMLreturn(v_result);
+}
+
+/* --- Dense rank ------------------------------------------------------ */
+/* (nativeint table_ptr, string col_name) -> int option array option
+   Assigns dense ranks (no gaps) to non-NULL numeric values.
+   NULL positions receive None; ranked positions receive Some(rank). */
+
+CAMLprim value caml_arrow_compute_dense_rank(value v_ptr, value v_col) {
+  return rank_column_to_caml(v_ptr, v_col, RANK_DENSE);
+}
+
+/* --- Generalized rank ------------------------------------------------ */
+/* (nativeint table_ptr, string col_name, int rank_type) -> int option array option
+   rank_type: 0 = row_number, 1 = min_rank, 2 = dense_rank */
+
+CAMLprim value caml_arrow_compute_rank(value v_ptr, value v_col, value v_rank_type) {
+  return rank_column_to_caml(v_ptr, v_col, Int_val(v_rank_type));
+}
+
+/* --- Chunk-aware window kernels -------------------------------------- */
+/* lag/lead, cumulative and rank kernels over an Int64 or Float64 column,
+   over the whole column or within each group of a GroupedTable. Chunks are
+   read in place through their value buffers and validity bitmaps and are
+   never combined: a row is found from the chunk start offsets, and the
+   result comes back split at the input's chunk boundaries, so a table
+   concatenated from many files keeps its layout.
+
+   Groups, balanced by row count, run on the worker pool; an ungrouped
+   lag/lead is split into row morsels instead. Each task gathers its rows,
+   computes, and scatters into rows no other task writes. NA semantics
+   follow the T builtins: cumulative results are NA from the first NA on,
+   ranks leave NA rows NA and order NaN before every number. */
+
+enum {
+  WINDOW_LAG = 0,
+  WINDOW_LEAD = 1,
+  WINDOW_CUMSUM = 2,
+  WINDOW_CUMMIN = 3,
+  WINDOW_CUMMAX = 4,
+  WINDOW_ROW_NUMBER = 5,
+  WINDOW_MIN_RANK = 6,
+  WINDOW_DENSE_RANK = 7
+};
+
+/* The chunks of one numeric column. Both types are 8 bytes wide, so cells
+   are moved as raw words and only reinterpreted where arithmetic needs it. */
+typedef struct {
+  guint n_chunks;
+  GArrowArray **chunks;     /* owned */
+  gint64 *starts;           /* first row of each chunk; starts[n_chunks] = rows */
+  const gint64 **words;     /* first value of each chunk */
+  const guint8 **bitmaps;   /* NULL for chunks without nulls */
+  gint64 *bits;             /* bitmap position of each chunk's first value */
+  gboolean is_int;
+} WindowColumn;
+
+static void window_column_clear(WindowColumn *wc) {
+  for (guint c = 0; c < wc->n_chunks; c++)
+    if (wc->chunks[c]) g_object_unref(wc->chunks[c]);
+  g_free(wc->chunks);
+  g_free(wc->starts);
+  g_free(wc->words);
+  g_free(wc->bitmaps);
+  g_free(wc->bits);
+  memset(wc, 0, sizeof *wc);
+}
+
+/* Point [wc] at the buffers of chunk [c]. FALSE when they are shorter than
+   the chunk's declared length. */
+static gboolean window_column_map_chunk(WindowColumn *wc, guint c, gint64 length) {
+  GArrowArray *chunk = wc->chunks[c];
+  gint64 offset = garrow_array_get_offset(chunk);
+  GArrowBuffer *buffer = garrow_primitive_array_get_data_buffer(GARROW_PRIMITIVE_ARRAY(chunk));
+  if (buffer == NULL) return FALSE;
+  GBytes *bytes = garrow_buffer_get_data(buffer);
+  gsize size = 0;
+  const gint64 *data = (const gint64 *)g_bytes_get_data(bytes, &size);
+  g_bytes_unref(bytes);
+  g_object_unref(buffer);
+  if (data == NULL || size < (gsize)(offset + length) * 8) return FALSE;
+  wc->words[c] = data + offset;
+
+  wc->bits[c] = offset;
+  if (garrow_array_get_n_nulls(chunk) > 0) {
+    GArrowBuffer *bm_buffer = garrow_array_get_null_bitmap(chunk);
+    if (bm_buffer == NULL) return FALSE;
+    GBytes *bm_bytes = garrow_buffer_get_data(bm_buffer);
+    gsize bm_size = 0;
+    wc->bitmaps[c] = (const guint8 *)g_bytes_get_data(bm_bytes, &bm_size);
+    g_bytes_unref(bm_bytes);
+    g_object_unref(bm_buffer);
+    if (wc->bitmaps[c] == NULL || bm_size < (gsize)((offset + length + 7) / 8)) return FALSE;
+  }
+  return TRUE;
+}
+
+static gboolean window_column_load(WindowColumn *wc, GArrowChunkedArray *chunked, gboolean is_int) {
+  guint n = garrow_chunked_array_get_n_chunks(chunked);
+  guint alloc = n > 0 ? n : 1;
+  wc->n_chunks = n;
+  wc->is_int = is_int;
+  wc->chunks = g_new0(GArrowArray *, alloc);
+  wc->starts = g_new0(gint64, n + 1);
+  wc->words = g_new0(const gint64 *, alloc);
+  wc->bitmaps = g_new0(const guint8 *, alloc);
+  wc->bits = g_new0(gint64, alloc);
+
+  gint64 row = 0;
+  for (guint c = 0; c < n; c++) {
+    wc->starts[c] = row;
+    wc->chunks[c] = garrow_chunked_array_get_chunk(chunked, c);
+    if (wc->chunks[c] == NULL) {
+      window_column_clear(wc);
+      return FALSE;
+    }
+    gint64 length = garrow_array_get_length(wc->chunks[c]);
+    if (length > 0 && !window_column_map_chunk(wc, c, length)) {
+      window_column_clear(wc);
+      return FALSE;
+    }
+    row += length;
+  }
+  wc->starts[n] = row;
+  return TRUE;
+}
+
+/* Chunk holding [row] (< the row count). Walks forward from [hint] when
+   the row is at or past it, as for the ascending rows of a group, and
+   bisects otherwise; pass n_chunks to force the bisection. */
+static inline guint window_chunk_of(const WindowColumn *wc, gint64 row, guint hint) {
+  if (hint >= wc->n_chunks || row < wc->starts[hint]) {
+    guint lo = 0, hi = wc->n_chunks - 1;
+    while (lo < hi) {
+      guint mid = lo + (hi - lo + 1) / 2;
+      if (wc->starts[mid] <= row) lo = mid;
+      else hi = mid - 1;
+    }
+    return lo;
+  }
+  while (row >= wc->starts[hint + 1]) hint++;
+  return hint;
+}
+
+/* Copy rows [first, first + n) into [words]/[ok], one chunk segment at a
+   time. */
+static void window_gather_range(const WindowColumn *wc, gint64 first, gint64 n,
+                                gint64 *words, guint8 *ok) {
+  guint c = wc->n_chunks;
+  gint64 done = 0;
+  while (done < n) {
+    gint64 row = first + done;
+    c = window_chunk_of(wc, row, c);
+    gint64 local = row - wc->starts[c];
+    gint64 take = MIN(n - done, wc->starts[c + 1] - row);
+    memcpy(words + done, wc->words[c] + local, (gsize)take * sizeof(gint64));
+    const guint8 *bm = wc->bitmaps[c];
+    if (bm == NULL) {
+      memset(ok + done, 1, (gsize)take);
+    } else {
+      gint64 bit = wc->bits[c] + local;
+      for (gint64 j = 0; j < take; j++, bit++)
+        ok[done + j] = (bm[bit >> 3] >> (bit & 7)) & 1;
+    }
+    done += take;
+  }
+}
+
+/* Copy the ascending [rows] into [words]/[ok]. */
+static void window_gather_rows(const WindowColumn *wc, const gint64 *rows, gint64 n,
+                               gint64 *words, guint8 *ok) {
+  guint c = wc->n_chunks;
+  for (gint64 j = 0; j < n; j++) {
+    c = window_chunk_of(wc, rows[j], c);
+    gint64 local = rows[j] - wc->starts[c];
+    words[j] = wc->words[c][local];
+    const guint8 *bm = wc->bitmaps[c];
+    gint64 bit = wc->bits[c] + local;
+    ok[j] = bm == NULL || ((bm[bit >> 3] >> (bit & 7)) & 1);
+  }
+}
+
+static inline gdouble window_f64(gint64 word) {
+  gdouble f;
+  memcpy(&f, &word, sizeof f);
+  return f;
+}
+
+static inline gint64 window_word(gdouble f) {
+  gint64 word;
+  memcpy(&word, &f, sizeof word);
+  return word;
+}
+
+/* Order-preserving image of a cell for ranking. Floats order as
+   Float.compare does: NaN below everything, -0.0 equal to 0.0. */
+static inline guint64 window_rank_image(gint64 word, gboolean is_int) {
+  if (is_int) return (guint64)word ^ 0x8000000000000000ULL;
+  gdouble f = window_f64(word);
+  if (isnan(f)) return 0;
+  if (f == 0.0) f = 0.0;
+  guint64 bits = (guint64)window_word(f);
+  return (bits >> 63) ? ~bits : bits ^ 0x8000000000000000ULL;
+}
+
+static gint window_rank_compare(gconstpointer a, gconstpointer b, gpointer data) {
+  const guint64 *images = (const guint64 *)data;
+  gint64 x = *(const gint64 *)a, y = *(const gint64 *)b;
+  if (images[x] != images[y]) return images[x] < images[y] ? -1 : 1;
+  return x < y ? -1 : (x > y);
+}
+
+typedef struct {
+  const WindowColumn *col;
+  const GroupedTable *gt;  /* NULL: rows [first, first + count) form one run */
+  int op;
+  gint64 offset;
+  int group_lo, group_hi;
+  gint64 first, count;
+  gint64 *out;             /* one word per table row */
+  guint8 *ok;              /* one validity byte per table row */
+} WindowTask;
+
+/* Per-task buffers for one group at a time. */
+typedef struct {
+  gint64 *words;
+  guint8 *ok;
+  guint64 *images;
+  gint64 *order;
+} WindowScratch;
+
+/* Apply the task's op to one group: [rows] (ascending), or rows
+   [first, first + n) when [rows] is NULL. */
+static void window_run_group(const WindowTask *t, WindowScratch *s,
+                             const gint64 *rows, gint64 first, gint64 n) {
+  const WindowColumn *wc = t->col;
+  if (rows == NULL) window_gather_range(wc, first, n, s->words, s->ok);
+  else window_gather_rows(wc, rows, n, s->words, s->ok);
+
+#define WINDOW_EMIT(j, word, valid) do {                \
+    gint64 dest_ = rows == NULL ? first + (j) : rows[j];  \
+    t->out[dest_] = (word);                               \
+    t->ok[dest_] = (valid);                               \
+  } while (0)
+
+  switch (t->op) {
+    case WINDOW_LAG:
+    case WINDOW_LEAD: {
+      gint64 delta = t->op == WINDOW_LAG ? -t->offset : t->offset;
+      for (gint64 j = 0; j < n; j++) {
+        gint64 src = j + delta;
+        if (src >= 0 && src < n) WINDOW_EMIT(j, s->words[src], s->ok[src]);
+        else WINDOW_EMIT(j, 0, 0);
+      }
+      break;
+    }
+    case WINDOW_CUMSUM:
+    case WINDOW_CUMMIN:
+    case WINDOW_CUMMAX: {
+      gboolean alive = TRUE;
+      guint64 isum = 0;
+      gint64 irun = 0;
+      gdouble frun = 0.0;
+      for (gint64 j = 0; j < n; j++) {
+        alive = alive && s->ok[j];
+        if (!alive) {
+          WINDOW_EMIT(j, 0, 0);
+          continue;
+        }
+        gint64 w = s->words[j];
+        if (wc->is_int) {
+          if (t->op == WINDOW_CUMSUM) irun = (gint64)(isum += (guint64)w);
+          else if (j == 0 || (t->op == WINDOW_CUMMIN ? w < irun : w > irun)) irun = w;
+          WINDOW_EMIT(j, irun, 1);
+        } else {
+          gdouble x = window_f64(w);
+          if (t->op == WINDOW_CUMSUM) frun = j == 0 ? x : frun + x;
+          else if (j == 0 || isnan(x) || (t->op == WINDOW_CUMMIN ? x < frun : x > frun)) frun = x;
+          WINDOW_EMIT(j, window_word(frun), 1);
+        }
+      }
+      break;
+    }
+    default: {
+      gint64 m = 0;
+      for (gint64 j = 0; j < n; j++) {
+        if (s->ok[j]) {
+          s->images[j] = window_rank_image(s->words[j], wc->is_int);
+          s->order[m++] = j;
+        } else {
+          WINDOW_EMIT(j, 0, 0);
+        }
+      }
+#if GLIB_CHECK_VERSION(2, 82, 0)
+      g_sort_array(s->order, (gsize)m, sizeof(gint64), window_rank_compare, s->images);
+#else
+      g_qsort_with_data(s->order, (gint)m, sizeof(gint64), window_rank_compare, s->images);
+#endif
+      gint64 rank = 0, dense = 0;
+      for (gint64 i = 0; i < m; i++) {
+        gint64 j = s->order[i];
+        gboolean tie = i > 0 && s->images[s->order[i - 1]] == s->images[j];
+        if (!tie) {
+          rank = i + 1;
+          dense++;
+        }
+        gint64 value = t->op == WINDOW_ROW_NUMBER ? i + 1
+                     : t->op == WINDOW_MIN_RANK ? rank : dense;
+        WINDOW_EMIT(j, value, 1);
       }
+      break;
     }
-    if (error) { g_error_free(error); error = NULL; }
   }
-  numeric_chunk_cursor_destroy(&cursor);
-  g_object_unref(chunked);
+#undef WINDOW_EMIT
+}
 
-  GArrowArray *arr = garrow_array_builder_finish(builder, &error);
-  g_object_unref(builder);
-  if (arr == NULL) {
-    if (error) g_error_free(error);
-    g_object_unref(field);
-    g_object_unref(schema);
-    CAMLreturn(Val_none);
+/* Ungrouped lag/lead over output rows [first, first + count): the source
+   rows are contiguous, so they are copied straight into the output. */
+static void window_shift_range(const WindowTask *t) {
+  gint64 nrows = t->col->starts[t->col->n_chunks];
+  gint64 delta = t->op == WINDOW_LAG ? -t->offset : t->offset;
+  gint64 src_lo = t->first + delta;
+  gint64 lo = MAX(src_lo, 0);
+  gint64 hi = MIN(src_lo + t->count, nrows);
+  memset(t->ok + t->first, 0, (gsize)t->count);
+  if (lo < hi) {
+    gint64 dest = t->first + (lo - src_lo);
+    window_gather_range(t->col, lo, hi - lo, t->out + dest, t->ok + dest);
   }
+}
 
-  GList *chunk_list = g_list_append(NULL, arr);
-  GArrowChunkedArray *new_ca = garrow_chunked_array_new(chunk_list, &error);
-  g_list_free_full(chunk_list, g_object_unref);
-  if (new_ca == NULL) {
-    if (error) g_error_free(error);
-    g_object_unref(field);
-    g_object_unref(schema);
-    CAMLreturn(Val_none);
+static gpointer window_task_run(gpointer data) {
+  const WindowTask *t = (const WindowTask *)data;
+  if (t->gt == NULL && (t->op == WINDOW_LAG || t->op == WINDOW_LEAD)) {
+    window_shift_range(t);
+    return NULL;
+  }
+
+  gint64 max_n = t->count;
+  if (t->gt != NULL) {
+    max_n = 0;
+    for (int g = t->group_lo; g < t->group_hi; g++)
+      max_n = MAX(max_n, (gint64)t->gt->group_sizes[g]);
+  }
+  gsize alloc = (gsize)(max_n > 0 ? max_n : 1);
+  gboolean ranked = t->op >= WINDOW_ROW_NUMBER;
+  WindowScratch s = {
+    .words = g_new(gint64, alloc),
+    .ok = g_new(guint8, alloc),
+    .images = ranked ? g_new(guint64, alloc) : NULL,
+    .order = ranked ? g_new(gint64, alloc) : NULL,
+  };
+
+  if (t->gt != NULL) {
+    for (int g = t->group_lo; g < t->group_hi; g++)
+      window_run_group(t, &s, t->gt->group_row_indices[g], 0, t->gt->group_sizes[g]);
+  } else {
+    window_run_group(t, &s, NULL, t->first, t->count);
   }
 
-  GArrowField *new_field = garrow_field_new(col_name, dtype);
+  g_free(s.words);
+  g_free(s.ok);
+  g_free(s.images);
+  g_free(s.order);
+  return NULL;
+}
+
+/* Wrap [out]/[ok] (one entry per row) as a chunked array with [wc]'s chunk
+   boundaries. The chunks share one value buffer; only their validity
+   bitmaps are packed separately. Takes ownership of [out]. */
+static GArrowChunkedArray *window_result_chunks(const WindowColumn *wc, gint64 *out,
+                                                const guint8 *ok, gboolean is_int,
+                                                GError **error) {
+  gint64 nrows = wc->starts[wc->n_chunks];
+  GBytes *all = g_bytes_new_take(out, (gsize)nrows * sizeof(gint64));
+  GList *chunks = NULL;
+  gboolean failed = FALSE;
+
+  for (guint c = 0; c < wc->n_chunks && !failed; c++) {
+    gint64 start = wc->starts[c];
+    gint64 length = wc->starts[c + 1] - start;
+    GBytes *slice = g_bytes_new_from_bytes(all, (gsize)start * sizeof(gint64),
+                                           (gsize)length * sizeof(gint64));
+    GArrowBuffer *data = garrow_buffer_new_bytes(slice);
+    g_bytes_unref(slice);
+
+    gsize bitmap_len = (gsize)((length + 7) / 8);
+    guint8 *bitmap = g_malloc0(bitmap_len > 0 ? bitmap_len : 1);
+    gint64 n_nulls = 0;
+    for (gint64 i = 0; i < length; i++) {
+      if (ok[start + i]) bitmap[i >> 3] |= (guint8)(1u << (i & 7));
+      else n_nulls++;
+    }
+    GArrowBuffer *null_bitmap = NULL;
+    if (n_nulls > 0) {
+      GBytes *bm_bytes = g_bytes_new_take(bitmap, bitmap_len);
+      null_bitmap = garrow_buffer_new_bytes(bm_bytes);
+      g_bytes_unref(bm_bytes);
+    } else {
+      g_free(bitmap);
+    }
+
+    GArrowArray *array = is_int
+      ? GARROW_ARRAY(garrow_int64_array_new(length, data, null_bitmap, n_nulls))
+      : GARROW_ARRAY(garrow_double_array_new(length, data, null_bitmap, n_nulls));
+    g_object_unref(data);
+    if (null_bitmap) g_object_unref(null_bitmap);
+    if (array == NULL) failed = TRUE;
+    else chunks = g_list_append(chunks, array);
+  }
+  g_bytes_unref(all);
+
+  GArrowChunkedArray *result = failed ? NULL : garrow_chunked_array_new(chunks, error);
+  g_list_free_full(chunks, g_object_unref);
+  return result;
+}
+
+/* Compute [op] over [col_name] of [table], within each group of [gt] when
+   it is not NULL (its table must be [table]), and return [table] with the
+   result stored as [result_name]. Touches no OCaml values. NULL when the
+   column is missing, empty or not Int64/Float64. */
+static GArrowTable *window_apply(GArrowTable *table, const GroupedTable *gt,
+                                 const char *col_name, int op, gint64 offset,
+                                 const char *result_name, GError **error) {
+  if (op < WINDOW_LAG || op > WINDOW_DENSE_RANK || offset < 0) return NULL;
+
+  GArrowSchema *schema = garrow_table_get_schema(table);
+  gint col_idx = garrow_schema_get_field_index(schema, col_name);
+  if (col_idx < 0) {
+    g_object_unref(schema);
+    return NULL;
+  }
+  GArrowField *field = garrow_schema_get_field(schema, col_idx);
+  GArrowDataType *dtype = garrow_field_get_data_type(field);
+  gboolean is_int = GARROW_IS_INT64_DATA_TYPE(dtype);
+  gboolean is_double = GARROW_IS_DOUBLE_DATA_TYPE(dtype);
   g_object_unref(field);
   g_object_unref(schema);
+  if (!is_int && !is_double) return NULL;
 
-  GArrowTable *tmp = garrow_table_remove_column(table, col_idx, &error);
-  if (tmp == NULL) {
-    g_object_unref(new_ca);
-    g_object_unref(new_field);
-    if (error) g_error_free(error);
-    CAMLreturn(Val_none);
+  GArrowChunkedArray *chunked = garrow_table_get_column_data(table, col_idx);
+  if (chunked == NULL) return NULL;
+  WindowColumn wc;
+  gboolean loaded = window_column_load(&wc, chunked, is_int);
+  g_object_unref(chunked);
+  if (!loaded) return NULL;
+  if (wc.n_chunks == 0) {
+    window_column_clear(&wc);
+    return NULL;
   }
 
-  GArrowTable *result = garrow_table_add_column(tmp, col_idx, new_field, new_ca, &error);
-  g_object_unref(tmp);
-  g_object_unref(new_ca);
-  g_object_unref(new_field);
-  if (result == NULL) {
-    if (error) g_error_free(error);
-    CAMLreturn(Val_none);
+  gint64 nrows = wc.starts[wc.n_chunks];
+  gsize alloc = (gsize)(nrows > 0 ? nrows : 1);
+  gint64 *out = g_new0(gint64, alloc);
+  guint8 *ok = g_new0(guint8, alloc);
+
+  int n_tasks = parallel_thread_count(nrows);
+  WindowTask *tasks = g_new0(WindowTask, n_tasks);
+  for (int i = 0; i < n_tasks; i++) {
+    tasks[i] = (WindowTask){ .col = &wc, .gt = gt, .op = op, .offset = offset,
+                             .out = out, .ok = ok };
   }
+  if (gt != NULL) {
+    /* Contiguous group ranges of roughly nrows / n_tasks rows each. */
+    if (n_tasks > gt->n_groups) n_tasks = gt->n_groups > 0 ? gt->n_groups : 1;
+    gint64 per_task = (nrows + n_tasks - 1) / n_tasks;
+    gint64 seen = 0;
+    int t = 0;
+    for (int g = 0; g < gt->n_groups; g++) {
+      seen += gt->group_sizes[g];
+      if (t < n_tasks - 1 && seen >= per_task * (t + 1)) {
+        tasks[t].group_hi = g + 1;
+        tasks[++t].group_lo = g + 1;
+      }
+    }
+    tasks[t].group_hi = gt->n_groups;
+    n_tasks = t + 1;
+  } else if (op == WINDOW_LAG || op == WINDOW_LEAD) {
+    gint64 per_task = (nrows + n_tasks - 1) / n_tasks;
+    for (int i = 0; i < n_tasks; i++) {
+      tasks[i].first = MIN((gint64)i * per_task, nrows);
+      tasks[i].count = MIN(per_task, nrows - tasks[i].first);
+    }
+  } else {
+    n_tasks = 1;
+    tasks[0].count = nrows;
+  }
+  parallel_run(window_task_run, tasks, sizeof(WindowTask), n_tasks);
+  g_free(tasks);
+
+  GArrowChunkedArray *column =
+    window_result_chunks(&wc, out, ok, is_int || op >= WINDOW_ROW_NUMBER, error);
+  g_free(ok);
+  window_column_clear(&wc);
+  if (column == NULL) return NULL;
+  GArrowTable *result = table_with_column(table, result_name, column, error);
+  g_object_unref(column);
+  return result;
+}
 
-  v_result = caml_alloc(1, 0);
-  Store_field(v_result, 0, caml_copy_nativeint((intnat)result));
-  CAMLreturn(v_result);
+/* Copy the stub arguments, run window_apply outside the runtime lock and
+   wrap the result. */
+static value window_apply_to_caml(GArrowTable *table, const GroupedTable *gt, value v_col,
+                                  value v_op, value v_offset, value v_result_name) {
+  char *col_name = g_strdup(String_val(v_col));
+  char *result_name = g_strdup(String_val(v_result_name));
+  int op = Int_val(v_op);
+  gint64 offset = Long_val(v_offset);
+  GError *error = NULL;
+
+  g_object_ref(table);
+  caml_enter_blocking_section();
+  GArrowTable *result = window_apply(table, gt, col_name, op, offset, result_name, &error);
+  caml_leave_blocking_section();
+  g_object_unref(table);
+
+  if (error) g_error_free(error);
+  g_free(col_name);
+  g_free(result_name);
+  return native_table_option(result);
+}
+
+/* (nativeint table_ptr, string col_name, int op, int offset, string result_name)
+   -> nativeint option
+   Window op over the whole column: 0 = lag, 1 = lead, 2 = cumsum,
+   3 = cummin, 4 = cummax, 5 = row_number, 6 = min_rank, 7 = dense_rank.
+   [offset] is the lag/lead distance. Returns a new table with the result
+   stored as result_name, or None for columns that are not Int64/Float64. */
+CAMLprim value caml_arrow_window_column(value v_ptr, value v_col, value v_op,
+                                        value v_offset, value v_result_name) {
+  CAMLparam5(v_ptr, v_col, v_op, v_offset, v_result_name);
+  GArrowTable *table = (GArrowTable *)Nativeint_val(v_ptr);
+  CAMLreturn(window_apply_to_caml(table, NULL, v_col, v_op, v_offset, v_result_name));
+}
+
+/* (nativeint grouped_ptr, string col_name, int op, int offset, string result_name)
+   -> nativeint option
+   Same ops as caml_arrow_window_column, computed within each group and
+   returned in the grouped table's original row order. */
+CAMLprim value caml_arrow_grouped_window(value v_grouped_ptr, value v_col, value v_op,
+                                         value v_offset, value v_result_name) {
+  CAMLparam5(v_grouped_ptr, v_col, v_op, v_offset, v_result_name);
+  GroupedTable *gt = (GroupedTable *)Nativeint_val(v_grouped_ptr);
+  CAMLreturn(window_apply_to_caml(gt->table, gt, v_col, v_op, v_offset, v_result_name));
+}
+
+/* --- Lag column ------------------------------------------------------ */
+/* (nativeint table_ptr, string col_name, int offset) -> nativeint option
+   Shifts a numeric column forward by `offset` rows, filling NAs at start.
+   Returns a new table with the column replaced. */
+
+CAMLprim value caml_arrow_compute_lag_column(value v_ptr, value v_col, value v_offset) {
+  CAMLparam3(v_ptr, v_col, v_offset);
+  GArrowTable *table = (GArrowTable *)Nativeint_val(v_ptr);
+  CAMLreturn(window_apply_to_caml(table, NULL, v_col, Val_int(WINDOW_LAG), v_offset, v_col));
 }
 
 /* --- Lead column ----------------------------------------------------- */
@@ -5219,153 +9313,241 @@ CAMLprim value caml_arrow_compute_lag_column(value v_ptr, value v_col, value v_o
 
 CAMLprim value caml_arrow_compute_lead_column(value v_ptr, value v_col, value v_offset) {
   CAMLparam3(v_ptr, v_col, v_offset);
-  CAMLlocal1(v_result);
-
   GArrowTable *table = (GArrowTable *)Nativeint_val(v_ptr);
-  const char *col_name = String_val(v_col);
-  int offset = Int_val(v_offset);
-
-  GArrowSchema *schema = garrow_table_get_schema(table);
-  gint col_idx = garrow_schema_get_field_index(schema, col_name);
-  if (col_idx < 0) {
-    g_object_unref(schema);
-    CAMLreturn(Val_none);
-  }
+  CAMLreturn(window_apply_to_caml(table, NULL, v_col, Val_int(WINDOW_LEAD), v_offset, v_col));
+}
 
-  GArrowField *field = garrow_schema_get_field(schema, col_idx);
-  /* dtype is transfer-none from garrow_field_get_data_type — owned by field,
-     do not unref dtype separately; field is unreffed after use. */
-  GArrowDataType *dtype = garrow_field_get_data_type(field);
+/* --- Optimized group-by ---------------------------------------------- */
+/* Same interface as caml_arrow_table_group_by. Keys are loaded once into
+   typed flat arrays and grouped without formatting a string per row:
+     1. the rows are split into morsels, and each worker hashes its morsel
+        and assigns local group ids with its own open-addressing table;
+     2. a merge pass maps every local group to a global id, in order of
+        first appearance;
+     3. row indices are scattered into per-group arrays (ascending) and the
+        groups are sorted by key like the standard group-by.
+   Only first-seen rows of each group are formatted as key strings. Returns
+   None for key types without a typed representation (large strings, dates)
+   so the caller can use the standard group-by. */
 
-  gint64 nrows = garrow_table_get_n_rows(table);
-  GArrowChunkedArray *chunked = garrow_table_get_column_data(table, col_idx);
-  if (chunked == NULL) {
-    g_object_unref(field);
-    g_object_unref(schema);
-    CAMLreturn(Val_none);
+typedef struct {
+  const KeyColumn *keys;
+  int n_keys;
+  gint64 begin;
+  gint64 end;
+  guint64 *hash;       /* per-row hash, shared array, slice [begin, end) */
+  gint32 *local_gid;   /* per-row local group id, shared array */
+  gint64 *first_row;   /* first row of each local group */
+  gint64 n_groups;
+} GroupMorsel;
+
+static gpointer
+group_morsel_run(gpointer data) {
+  GroupMorsel *m = (GroupMorsel *)data;
+  key_hash_rows(m->keys, m->n_keys, m->begin, m->end, m->hash);
+
+  gint64 cap = 1024;
+  gint64 first_cap = 256;
+  gint32 *slots = g_new(gint32, cap);
+  for (gint64 i = 0; i < cap; i++) slots[i] = -1;
+  m->first_row = g_new(gint64, first_cap);
+  m->n_groups = 0;
+
+  for (gint64 r = m->begin; r < m->end; r++) {
+    guint64 h = m->hash[r];
+    gint64 mask = cap - 1;
+    gint64 s = (gint64)(h & (guint64)mask);
+    gint32 gid = -1;
+    while (slots[s] >= 0) {
+      gint64 rep = m->first_row[slots[s]];
+      if (m->hash[rep] == h && key_rows_equal(m->keys, rep, m->keys, r, m->n_keys)) {
+        gid = slots[s];
+        break;
+      }
+      s = (s + 1) & mask;
+    }
+    if (gid < 0) {
+      gid = (gint32)m->n_groups;
+      if (m->n_groups == first_cap) {
+        first_cap *= 2;
+        m->first_row = g_renew(gint64, m->first_row, first_cap);
+      }
+      m->first_row[m->n_groups++] = r;
+      slots[s] = gid;
+      if (m->n_groups * 2 > cap) {
+        /* Grow and reinsert so the load factor stays at or below 1/2. */
+        gint64 new_cap = cap * 2;
+        gint32 *grown = g_new(gint32, new_cap);
+        for (gint64 i = 0; i < new_cap; i++) grown[i] = -1;
+        for (gint64 g = 0; g < m->n_groups; g++) {
+          gint64 t = (gint64)(m->hash[m->first_row[g]] & (guint64)(new_cap - 1));
+          while (grown[t] >= 0) t = (t + 1) & (new_cap - 1);
+          grown[t] = (gint32)g;
+        }
+        g_free(slots);
+        slots = grown;
+        cap = new_cap;
+      }
+    }
+    m->local_gid[r] = gid;
   }
+  g_free(slots);
+  return NULL;
+}
+
+typedef struct {
+  const KeyColumn *keys;
+  int n_keys;
+  const gint64 *first_row; /* first row of each global group */
+} GroupSortContext;
 
-  NumericChunkCursor cursor;
-  numeric_chunk_cursor_init(&cursor, chunked);
+static int
+compare_group_first_rows(gconstpointer a, gconstpointer b, gpointer user_data) {
+  GroupSortContext *ctx = (GroupSortContext *)user_data;
+  gint64 ra = ctx->first_row[*(const int *)a];
+  gint64 rb = ctx->first_row[*(const int *)b];
+  return key_rows_compare(ctx->keys, ctx->n_keys, ra, rb);
+}
 
-  GError *error = NULL;
-  GArrowArrayBuilder *builder = NULL;
-  gboolean is_int64 = GARROW_IS_INT64_DATA_TYPE(dtype);
-  gboolean is_double = GARROW_IS_DOUBLE_DATA_TYPE(dtype);
+/* Group rows of `table` by typed key columns. Runs without the OCaml
+   runtime lock. Returns NULL when the keys are unsupported. */
+static GroupedTable *
+group_by_typed_keys(GArrowTable *table, gchar **key_names, int n_keys) {
+  gint64 nrows = garrow_table_get_n_rows(table);
+  if (nrows > G_MAXINT32) return NULL;
 
-  if (is_int64) {
-    builder = (GArrowArrayBuilder *)garrow_int64_array_builder_new();
-  } else if (is_double) {
-    builder = (GArrowArrayBuilder *)garrow_double_array_builder_new();
-  } else {
-    numeric_chunk_cursor_destroy(&cursor);
-    g_object_unref(chunked);
-    g_object_unref(field);
-    g_object_unref(schema);
-    CAMLreturn(Val_none);
+  KeyColumn *keys = g_new0(KeyColumn, n_keys);
+  GPtrArray *hold = g_ptr_array_new_with_free_func(g_object_unref);
+  if (!key_columns_load(table, key_names, n_keys, keys, hold)) {
+    g_free(keys);
+    g_ptr_array_free(hold, TRUE);
+    return NULL;
   }
-
-  for (gint64 i = 0; i < nrows; i++) {
-    gint64 src_row = i + (gint64)offset;
-    if (src_row < 0 || src_row >= nrows) {
-      garrow_array_builder_append_null(builder, &error);
-    } else {
-      gboolean is_null;
-      gdouble val;
-      if (!get_numeric_value(&cursor, src_row, &is_null, &val) || is_null) {
-        garrow_array_builder_append_null(builder, &error);
-      } else if (is_int64) {
-        garrow_int64_array_builder_append_value(
-            GARROW_INT64_ARRAY_BUILDER(builder), (gint64)val, &error);
-      } else {
-        garrow_double_array_builder_append_value(
-            GARROW_DOUBLE_ARRAY_BUILDER(builder), val, &error);
-      }
+  for (int k = 0; k < n_keys; k++) {
+    if (keys[k].tag == 7) {
+      /* Date keys keep the standard path's string rendering. */
+      for (int j = 0; j < n_keys; j++) key_column_free(&keys[j]);
+      g_free(keys);
+      g_ptr_array_free(hold, TRUE);
+      return NULL;
     }
-    if (error) { g_error_free(error); error = NULL; }
   }
-  numeric_chunk_cursor_destroy(&cursor);
-  g_object_unref(chunked);
 
-  GArrowArray *arr = garrow_array_builder_finish(builder, &error);
-  g_object_unref(builder);
-  if (arr == NULL) {
-    if (error) g_error_free(error);
-    g_object_unref(field);
-    g_object_unref(schema);
-    CAMLreturn(Val_none);
+  guint64 *hash = g_new(guint64, nrows > 0 ? nrows : 1);
+  gint32 *local_gid = g_new(gint32, nrows > 0 ? nrows : 1);
+
+  /* Phase 1: per-morsel local grouping. */
+  int n_tasks = parallel_thread_count(nrows);
+  GroupMorsel *morsels = g_new0(GroupMorsel, n_tasks);
+  for (int t = 0; t < n_tasks; t++) {
+    morsels[t].keys = keys;
+    morsels[t].n_keys = n_keys;
+    morsels[t].begin = nrows * t / n_tasks;
+    morsels[t].end = nrows * (t + 1) / n_tasks;
+    morsels[t].hash = hash;
+    morsels[t].local_gid = local_gid;
+  }
+  parallel_run(group_morsel_run, morsels, sizeof(GroupMorsel), n_tasks);
+
+  /* Phase 2: merge local groups into global ids in first-seen order. */
+  gint64 total_local = 0;
+  for (int t = 0; t < n_tasks; t++) total_local += morsels[t].n_groups;
+  gint64 cap = 16;
+  while (cap < 2 * total_local) cap <<= 1;
+  gint32 *slots = g_new(gint32, cap);
+  for (gint64 i = 0; i < cap; i++) slots[i] = -1;
+  gint64 *first_row = g_new(gint64, total_local > 0 ? total_local : 1);
+  gint32 **global_of = g_new(gint32 *, n_tasks);
+  int n_groups = 0;
+  for (int t = 0; t < n_tasks; t++) {
+    GroupMorsel *m = &morsels[t];
+    global_of[t] = g_new(gint32, m->n_groups > 0 ? m->n_groups : 1);
+    for (gint64 g = 0; g < m->n_groups; g++) {
+      gint64 r = m->first_row[g];
+      guint64 h = hash[r];
+      gint64 s = (gint64)(h & (guint64)(cap - 1));
+      gint32 gid = -1;
+      while (slots[s] >= 0) {
+        gint64 rep = first_row[slots[s]];
+        if (hash[rep] == h && key_rows_equal(keys, rep, keys, r, n_keys)) {
+          gid = slots[s];
+          break;
+        }
+        s = (s + 1) & (cap - 1);
+      }
+      if (gid < 0) {
+        gid = n_groups++;
+        first_row[gid] = r;
+        slots[s] = gid;
+      }
+      global_of[t][g] = gid;
+    }
   }
+  g_free(slots);
 
-  GList *chunk_list = g_list_append(NULL, arr);
-  GArrowChunkedArray *new_ca = garrow_chunked_array_new(chunk_list, &error);
-  g_list_free_full(chunk_list, g_object_unref);
-  if (new_ca == NULL) {
-    if (error) g_error_free(error);
-    g_object_unref(field);
-    g_object_unref(schema);
-    CAMLreturn(Val_none);
+  /* Phase 3: scatter rows into per-group index arrays, in row order. */
+  int *sizes = g_new0(int, n_groups > 0 ? n_groups : 1);
+  for (int t = 0; t < n_tasks; t++) {
+    GroupMorsel *m = &morsels[t];
+    for (gint64 r = m->begin; r < m->end; r++) {
+      local_gid[r] = global_of[t][local_gid[r]];
+      sizes[local_gid[r]]++;
+    }
   }
-
-  GArrowField *new_field = garrow_field_new(col_name, dtype);
-  g_object_unref(field);
-  g_object_unref(schema);
-
-  GArrowTable *tmp = garrow_table_remove_column(table, col_idx, &error);
-  if (tmp == NULL) {
-    g_object_unref(new_ca);
-    g_object_unref(new_field);
-    if (error) g_error_free(error);
-    CAMLreturn(Val_none);
+  gint64 **rows_of = g_new(gint64 *, n_groups > 0 ? n_groups : 1);
+  int *fill = g_new0(int, n_groups > 0 ? n_groups : 1);
+  for (int g = 0; g < n_groups; g++) rows_of[g] = (gint64 *)malloc(sizeof(gint64) * (sizes[g] > 0 ? sizes[g] : 1));
+  for (gint64 r = 0; r < nrows; r++) {
+    int g = local_gid[r];
+    rows_of[g][fill[g]++] = r;
   }
+  g_free(fill);
 
-  GArrowTable *result = garrow_table_add_column(tmp, col_idx, new_field, new_ca, &error);
-  g_object_unref(tmp);
-  g_object_unref(new_ca);
-  g_object_unref(new_field);
-  if (result == NULL) {
-    if (error) g_error_free(error);
-    CAMLreturn(Val_none);
+  for (int t = 0; t < n_tasks; t++) {
+    g_free(morsels[t].first_row);
+    g_free(global_of[t]);
   }
+  g_free(global_of);
+  g_free(morsels);
+  g_free(hash);
+  g_free(local_gid);
 
-  v_result = caml_alloc(1, 0);
-  Store_field(v_result, 0, caml_copy_nativeint((intnat)result));
-  CAMLreturn(v_result);
-}
-
-/* --- Optimized group-by ---------------------------------------------- */
-/* Same interface as caml_arrow_table_group_by but with pre-sized hash table
-   and faster key concatenation for high-cardinality data.
-   Uses the existing GroupedTable struct for the return value. */
+  /* Sort groups by key, NAs last, as the standard group-by does. */
+  int *perm = g_new(int, n_groups > 0 ? n_groups : 1);
+  for (int g = 0; g < n_groups; g++) perm[g] = g;
+  GroupSortContext sort_ctx = { .keys = keys, .n_keys = n_keys, .first_row = first_row };
+#if GLIB_CHECK_VERSION(2, 82, 0)
+  g_sort_array(perm, n_groups, sizeof(int), compare_group_first_rows, &sort_ctx);
+#else
+  g_qsort_with_data(perm, n_groups, sizeof(int), compare_group_first_rows, &sort_ctx);
+#endif
 
-/* Hash helper: compute a quick 64-bit hash for a numeric cell to avoid
-   string formatting overhead on high-cardinality numeric columns. */
-static guint64
-numeric_cell_hash(GArrowArray *chunk, gint64 offset) {
-  guint64 bits = 0;
-  if (GARROW_IS_INT64_ARRAY(chunk)) {
-    gint64 v = garrow_int64_array_get_value(GARROW_INT64_ARRAY(chunk), offset);
-    memcpy(&bits, &v, sizeof(gint64));
-  } else if (GARROW_IS_INT32_ARRAY(chunk)) {
-    gint32 v = garrow_int32_array_get_value(GARROW_INT32_ARRAY(chunk), offset);
-    bits = (guint64)(guint32)v;
-  } else if (GARROW_IS_INT16_ARRAY(chunk)) {
-    gint16 v = garrow_int16_array_get_value(GARROW_INT16_ARRAY(chunk), offset);
-    bits = (guint64)(guint16)v;
-  } else if (GARROW_IS_UINT32_ARRAY(chunk)) {
-    guint32 v = garrow_uint32_array_get_value(GARROW_UINT32_ARRAY(chunk), offset);
-    bits = (guint64)v;
-  } else if (GARROW_IS_DOUBLE_ARRAY(chunk)) {
-    gdouble v = garrow_double_array_get_value(GARROW_DOUBLE_ARRAY(chunk), offset);
-    memcpy(&bits, &v, sizeof(gdouble));
-  } else if (GARROW_IS_FLOAT_ARRAY(chunk)) {
-    gfloat v = garrow_float_array_get_value(GARROW_FLOAT_ARRAY(chunk), offset);
-    guint32 u;
-    memcpy(&u, &v, sizeof(gfloat));
-    bits = (guint64)u;
-  } else {
-    bits = 0;
-  }
-  return bits;
+  GroupedTable *gt = (GroupedTable *)malloc(sizeof(GroupedTable));
+  gt->table = g_object_ref(table);
+  gt->n_groups = n_groups;
+  gt->n_keys = n_keys;
+  gt->key_names = (gchar **)malloc(sizeof(gchar *) * n_keys);
+  for (int k = 0; k < n_keys; k++) gt->key_names[k] = g_strdup(key_names[k]);
+  gt->group_sizes = (int *)malloc(sizeof(int) * (n_groups > 0 ? n_groups : 1));
+  gt->group_row_indices = (gint64 **)malloc(sizeof(gint64 *) * (n_groups > 0 ? n_groups : 1));
+  gt->group_key_values = (gchar ***)malloc(sizeof(gchar **) * (n_groups > 0 ? n_groups : 1));
+  for (int i = 0; i < n_groups; i++) {
+    int g = perm[i];
+    gt->group_sizes[i] = sizes[g];
+    gt->group_row_indices[i] = rows_of[g];
+    gt->group_key_values[i] = (gchar **)malloc(sizeof(gchar *) * n_keys);
+    for (int k = 0; k < n_keys; k++)
+      gt->group_key_values[i][k] = key_cell_string(&keys[k], first_row[g]);
+  }
+
+  g_free(perm);
+  g_free(rows_of);
+  g_free(sizes);
+  g_free(first_row);
+  for (int k = 0; k < n_keys; k++) key_column_free(&keys[k]);
+  g_free(keys);
+  g_ptr_array_free(hold, TRUE);
+  return gt;
 }
 
 CAMLprim value caml_arrow_group_by_optimized(value v_ptr, value v_key_names) {
@@ -5373,269 +9555,309 @@ CAMLprim value caml_arrow_group_by_optimized(value v_ptr, value v_key_names) {
   CAMLlocal1(v_result);
 
   GArrowTable *table = (GArrowTable *)Nativeint_val(v_ptr);
-  gint64 nrows = garrow_table_get_n_rows(table);
-  GArrowSchema *schema = garrow_table_get_schema(table);
 
-  /* Count and resolve key column names → indices */
   int n_keys = 0;
-  value iter = v_key_names;
-  while (iter != Val_emptylist) {
-    n_keys++;
-    iter = Field(iter, 1);
-  }
-  if (n_keys == 0) {
-    g_object_unref(schema);
-    CAMLreturn(Val_none);
-  }
+  for (value it = v_key_names; it != Val_emptylist; it = Field(it, 1)) n_keys++;
+  if (n_keys == 0 || table == NULL) CAMLreturn(Val_none);
 
-  int *key_indices = (int *)malloc(sizeof(int) * n_keys);
-  int *key_types = (int *)malloc(sizeof(int) * n_keys);
-  gchar **key_names = (gchar **)malloc(sizeof(gchar *) * n_keys);
-  if (key_indices == NULL || key_types == NULL || key_names == NULL) {
-    free(key_indices);
-    free(key_types);
-    free(key_names);
-    g_object_unref(schema);
-    CAMLreturn(Val_none);
+  gchar **key_names = g_new0(gchar *, n_keys + 1);
+  {
+    int k = 0;
+    for (value it = v_key_names; it != Val_emptylist; it = Field(it, 1))
+      key_names[k++] = g_strdup(String_val(Field(it, 0)));
   }
 
-  iter = v_key_names;
-  for (int i = 0; i < n_keys; i++) {
-    value head = Field(iter, 0);
-    const char *name = String_val(head);
-    key_names[i] = g_strdup(name);
-    key_indices[i] = garrow_schema_get_field_index(schema, name);
-    if (key_indices[i] < 0) {
-      for (int j = 0; j <= i; j++) g_free(key_names[j]);
-      free(key_names);
-      free(key_indices);
-      free(key_types);
-      g_object_unref(schema);
-      CAMLreturn(Val_none);
-    }
+  g_object_ref(table);
+  caml_enter_blocking_section();
+  GroupedTable *gt = group_by_typed_keys(table, key_names, n_keys);
+  caml_leave_blocking_section();
+  g_object_unref(table);
 
-    GArrowField *field = garrow_schema_get_field(schema, key_indices[i]);
-    GArrowDataType *dtype = garrow_field_get_data_type(field);
-    /* Type tags match caml_arrow_table_get_schema conventions:
-       0=Int, 1=Float64, 2=Bool, 3=String, 6=Other/Null, 7=Date */
-    if (GARROW_IS_INT8_DATA_TYPE(dtype) || GARROW_IS_INT16_DATA_TYPE(dtype) ||
-        GARROW_IS_INT32_DATA_TYPE(dtype) || GARROW_IS_INT64_DATA_TYPE(dtype) ||
-        GARROW_IS_UINT8_DATA_TYPE(dtype) || GARROW_IS_UINT16_DATA_TYPE(dtype) ||
-        GARROW_IS_UINT32_DATA_TYPE(dtype) || GARROW_IS_UINT64_DATA_TYPE(dtype))
-                                                  key_types[i] = 0;
-    else if (GARROW_IS_DOUBLE_DATA_TYPE(dtype))   key_types[i] = 1;
-    else if (GARROW_IS_BOOLEAN_DATA_TYPE(dtype))  key_types[i] = 2;
-    else if (GARROW_IS_STRING_DATA_TYPE(dtype) ||
-             GARROW_IS_LARGE_STRING_DATA_TYPE(dtype))
-                                                  key_types[i] = 3;
-    else if (GARROW_IS_DATE32_DATA_TYPE(dtype) ||
-             GARROW_IS_DATE64_DATA_TYPE(dtype))   key_types[i] = 7;
-    else                                          key_types[i] = 6;
+  g_strfreev(key_names);
+  if (gt == NULL) CAMLreturn(Val_none);
 
-    g_object_unref(field);
-    iter = Field(iter, 1);
-  }
-  g_object_unref(schema);
+  v_result = caml_alloc(1, 0);
+  Store_field(v_result, 0, caml_copy_nativeint((intnat)gt));
+  CAMLreturn(v_result);
+}
 
-  /* Fetch key column chunked arrays */
-  GArrowChunkedArray **key_cols = (GArrowChunkedArray **)malloc(sizeof(GArrowChunkedArray *) * n_keys);
-  if (key_cols == NULL) {
-    for (int j = 0; j < n_keys; j++) g_free(key_names[j]);
-    free(key_names); free(key_indices); free(key_types);
-    CAMLreturn(Val_none);
-  }
-  for (int k = 0; k < n_keys; k++) {
-    key_cols[k] = garrow_table_get_column_data(table, key_indices[k]);
-  }
+/* ===================================================================== */
+/* Hash Join                                                             */
+/* ===================================================================== */
 
-  /* GHashTable handles resizing automatically. There is no public pre-sizing API. */
-  GHashTable *group_map = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+/* Join kinds, matching Arrow_compute.join_kind_code. */
+enum { JOIN_INNER = 0, JOIN_LEFT = 1, JOIN_FULL = 2, JOIN_SEMI = 3, JOIN_ANTI = 4 };
 
-  GPtrArray *group_order = g_ptr_array_new();
-  GPtrArray *group_rows = g_ptr_array_new();
-  GPtrArray *group_key_vals = g_ptr_array_new();
+/* Build-side rows that fit in L2 per partition. Each build row costs about
+   32 bytes (two bucket heads, a chain link and its hash). */
+static gint64
+join_rows_per_partition(void) {
+  long l2 = 0;
+#ifdef _SC_LEVEL2_CACHE_SIZE
+  l2 = sysconf(_SC_LEVEL2_CACHE_SIZE);
+#endif
+  if (l2 <= 0) l2 = 256 * 1024;
+  return (gint64)l2 / 32;
+}
 
-  /* Determine if we should use numeric hashing (all keys numeric and
-     high-cardinality expected: nrows > 10000) */
-  gboolean use_numeric_hash = (nrows > 10000);
-  for (int k = 0; k < n_keys && use_numeric_hash; k++) {
-    if (key_types[k] != 0 && key_types[k] != 1) {
-      use_numeric_hash = FALSE;
+typedef struct {
+  gint64 *left_idx;
+  gint64 *right_idx;
+  gint64 n_out;
+} JoinOutput;
+
+/* Radix-partitioned hash join. Both sides are partitioned on the top bits of
+   the key hash so every partition's hash table stays cache resident; with a
+   small build side there is a single partition and this is a plain hash
+   join. Output rows follow the left table's order, matches for a left row
+   are in right-table order, and (for full joins) unmatched right rows come
+   last — the same order the OCaml join produces. */
+static gboolean
+hash_join_indices(const KeyColumn *lk, gint64 n_left,
+                  const KeyColumn *rk, gint64 n_right,
+                  int n_keys, int kind, JoinOutput *out) {
+  guint64 *lhash = g_new(guint64, n_left > 0 ? n_left : 1);
+  guint64 *rhash = g_new(guint64, n_right > 0 ? n_right : 1);
+  key_hash_rows_parallel(lk, n_keys, n_left, lhash);
+  key_hash_rows_parallel(rk, n_keys, n_right, rhash);
+
+  int bits = 0;
+  gint64 per_part = join_rows_per_partition();
+  while (bits < 10 && (n_right >> bits) > per_part) bits++;
+  gint64 n_parts = (gint64)1 << bits;
+#define JOIN_PART(h) (bits == 0 ? 0 : (gint64)((h) >> (64 - bits)))
+
+  /* Stable counting sort of the build rows by partition. */
+  gint64 *part_start = g_new0(gint64, n_parts + 1);
+  for (gint64 r = 0; r < n_right; r++) part_start[JOIN_PART(rhash[r]) + 1]++;
+  for (gint64 p = 0; p < n_parts; p++) part_start[p + 1] += part_start[p];
+  gint64 *fill = g_new(gint64, n_parts);
+  memcpy(fill, part_start, sizeof(gint64) * n_parts);
+  gint64 *right_perm = g_new(gint64, n_right > 0 ? n_right : 1);
+  for (gint64 r = 0; r < n_right; r++) right_perm[fill[JOIN_PART(rhash[r])]++] = r;
+
+  /* Per-partition chained tables, laid out back to back. Inserting in
+     reverse keeps every chain in ascending right-row order. */
+  gint64 *bucket_base = g_new(gint64, n_parts + 1);
+  gint64 *bucket_mask = g_new(gint64, n_parts);
+  bucket_base[0] = 0;
+  for (gint64 p = 0; p < n_parts; p++) {
+    gint64 m = part_start[p + 1] - part_start[p];
+    gint64 nb = 1;
+    while (nb < 2 * m) nb <<= 1;
+    bucket_mask[p] = nb - 1;
+    bucket_base[p + 1] = bucket_base[p] + nb;
+  }
+  gint64 *head = g_new(gint64, bucket_base[n_parts]);
+  for (gint64 b = 0; b < bucket_base[n_parts]; b++) head[b] = -1;
+  gint64 *next = g_new(gint64, n_right > 0 ? n_right : 1);
+  for (gint64 p = 0; p < n_parts; p++) {
+    for (gint64 pos = part_start[p + 1] - 1; pos >= part_start[p]; pos--) {
+      gint64 b = bucket_base[p] + (gint64)(rhash[right_perm[pos]] & (guint64)bucket_mask[p]);
+      next[pos] = head[b];
+      head[b] = pos;
     }
   }
 
-  /* Pre-allocate per-key cursors for numeric columns when using fast path */
-  NumericChunkCursor *key_cursors = NULL;
-  if (use_numeric_hash) {
-    key_cursors = (NumericChunkCursor *)malloc(sizeof(NumericChunkCursor) * n_keys);
-    if (key_cursors != NULL) {
-      for (int k = 0; k < n_keys; k++) {
-        numeric_chunk_cursor_init(&key_cursors[k], key_cols[k]);
-      }
-    } else {
-      use_numeric_hash = FALSE;
+  /* Probe in partition order for locality, counting matches per left row. */
+  gint64 *left_count = g_new0(gint64, n_left > 0 ? n_left : 1);
+  gint64 *left_perm = g_new(gint64, n_left > 0 ? n_left : 1);
+  {
+    gint64 *lstart = g_new0(gint64, n_parts + 1);
+    for (gint64 l = 0; l < n_left; l++) lstart[JOIN_PART(lhash[l]) + 1]++;
+    for (gint64 p = 0; p < n_parts; p++) lstart[p + 1] += lstart[p];
+    for (gint64 l = 0; l < n_left; l++) left_perm[lstart[JOIN_PART(lhash[l])]++] = l;
+    g_free(lstart);
+  }
+  for (gint64 i = 0; i < n_left; i++) {
+    gint64 l = left_perm[i];
+    gint64 p = JOIN_PART(lhash[l]);
+    gint64 c = 0;
+    for (gint64 pos = head[bucket_base[p] + (gint64)(lhash[l] & (guint64)bucket_mask[p])];
+         pos >= 0; pos = next[pos]) {
+      gint64 r = right_perm[pos];
+      if (rhash[r] == lhash[l] && key_rows_equal(lk, l, rk, r, n_keys)) c++;
     }
+    left_count[l] = c;
   }
 
-  /* Build composite key string for each row and group */
-  GString *key_buf = g_string_sized_new(n_keys * 20);
-
-  for (gint64 row = 0; row < nrows; row++) {
-    g_string_truncate(key_buf, 0);
-
-    gchar **cell_strs = NULL;
-    if (use_numeric_hash && key_cursors != NULL) {
-      /* Fast path: use numeric hash bytes directly */
-      for (int k = 0; k < n_keys; k++) {
-        if (k > 0) g_string_append_c(key_buf, '|');
-        gint64 offset = 0;
-        if (numeric_chunk_cursor_seek(&key_cursors[k], row, &offset) &&
-            !garrow_array_is_null(key_cursors[k].chunk, offset)) {
-          guint64 h = numeric_cell_hash(key_cursors[k].chunk, offset);
-          g_string_append_printf(key_buf, "%" G_GUINT64_FORMAT, h);
-        } else {
-          g_string_append(key_buf, "N");
+  gboolean ok = TRUE;
+  if (kind == JOIN_SEMI || kind == JOIN_ANTI) {
+    gint64 n_out = 0;
+    for (gint64 l = 0; l < n_left; l++)
+      if ((left_count[l] > 0) == (kind == JOIN_SEMI)) n_out++;
+    out->left_idx = g_new(gint64, n_out > 0 ? n_out : 1);
+    out->right_idx = NULL;
+    out->n_out = 0;
+    for (gint64 l = 0; l < n_left; l++)
+      if ((left_count[l] > 0) == (kind == JOIN_SEMI)) out->left_idx[out->n_out++] = l;
+  } else {
+    gboolean keep_unmatched_left = (kind == JOIN_LEFT || kind == JOIN_FULL);
+    gint64 *offset = g_new(gint64, n_left + 1);
+    offset[0] = 0;
+    for (gint64 l = 0; l < n_left; l++) {
+      gint64 rows = left_count[l];
+      if (rows == 0 && keep_unmatched_left) rows = 1;
+      offset[l + 1] = offset[l] + rows;
+    }
+    guint8 *right_matched = g_new0(guint8, n_right > 0 ? n_right : 1);
+    gint64 total = offset[n_left];
+
+    /* Second probe pass writes each left row's matches at its offset. */
+    out->left_idx = g_new(gint64, total + n_right + 1);
+    out->right_idx = g_new(gint64, total + n_right + 1);
+    for (gint64 i = 0; i < n_left; i++) {
+      gint64 l = left_perm[i];
+      gint64 p = JOIN_PART(lhash[l]);
+      gint64 w = offset[l];
+      for (gint64 pos = head[bucket_base[p] + (gint64)(lhash[l] & (guint64)bucket_mask[p])];
+           pos >= 0; pos = next[pos]) {
+        gint64 r = right_perm[pos];
+        if (rhash[r] == lhash[l] && key_rows_equal(lk, l, rk, r, n_keys)) {
+          out->left_idx[w] = l;
+          out->right_idx[w] = r;
+          right_matched[r] = 1;
+          w++;
         }
       }
-    } else {
-      /* Standard path: string-format each key.
-         Extract values once, reuse for composite key and storage. */
-      cell_strs = (gchar **)malloc(sizeof(gchar *) * n_keys);
-      for (int k = 0; k < n_keys; k++) {
-        if (k > 0) g_string_append_c(key_buf, '|');
-        cell_strs[k] = cell_value_as_string(table, key_indices[k], row);
-        g_string_append(key_buf, cell_strs[k] ? cell_strs[k] : "N");
+      if (w == offset[l] && keep_unmatched_left) {
+        out->left_idx[w] = l;
+        out->right_idx[w] = -1;
       }
     }
-
-    gpointer existing = g_hash_table_lookup(group_map, key_buf->str);
-    if (existing == NULL) {
-      gchar *key_copy = g_strdup(key_buf->str);
-      guint group_id = group_order->len;
-      g_hash_table_insert(group_map, key_copy, GUINT_TO_POINTER(group_id + 1));
-      g_ptr_array_add(group_order, g_strdup(key_buf->str));
-
-      GArray *rows_arr = g_array_new(FALSE, FALSE, sizeof(gint64));
-      g_array_append_val(rows_arr, row);
-      g_ptr_array_add(group_rows, rows_arr);
-
-      /* Store per-group key values */
-      gchar **kv;
-      if (cell_strs != NULL) {
-        /* Standard path: reuse values already extracted */
-        kv = cell_strs;
-        cell_strs = NULL;
-      } else {
-        /* Numeric hash path: extract string values now.
-           Note: first-encounter rows in high-cardinality data still pay
-           the per-key string-formatting cost; the fast path only avoids it
-           for existing-group lookups. */
-        kv = (gchar **)malloc(sizeof(gchar *) * n_keys);
-        for (int k = 0; k < n_keys; k++) {
-          kv[k] = cell_value_as_string(table, key_indices[k], row);
+    out->n_out = total;
+    if (kind == JOIN_FULL) {
+      for (gint64 r = 0; r < n_right; r++) {
+        if (!right_matched[r]) {
+          out->left_idx[out->n_out] = -1;
+          out->right_idx[out->n_out] = r;
+          out->n_out++;
         }
       }
-      g_ptr_array_add(group_key_vals, kv);
-    } else {
-      if (cell_strs) {
-        for (int k = 0; k < n_keys; k++) g_free(cell_strs[k]);
-        free(cell_strs);
-      }
-      guint group_id = GPOINTER_TO_UINT(existing) - 1;
-      GArray *rows_arr = (GArray *)g_ptr_array_index(group_rows, group_id);
-      g_array_append_val(rows_arr, row);
-    }
-  }
-
-  g_string_free(key_buf, TRUE);
-
-  if (use_numeric_hash && key_cursors != NULL) {
-    for (int k = 0; k < n_keys; k++) {
-      numeric_chunk_cursor_destroy(&key_cursors[k]);
     }
-    free(key_cursors);
+    g_free(right_matched);
+    g_free(offset);
   }
+#undef JOIN_PART
 
-  for (int k = 0; k < n_keys; k++) g_object_unref(key_cols[k]);
-  free(key_cols);
-
-  int n_groups = (int)group_order->len;
+  g_free(lhash); g_free(rhash);
+  g_free(part_start); g_free(fill); g_free(right_perm);
+  g_free(bucket_base); g_free(bucket_mask); g_free(head); g_free(next);
+  g_free(left_count); g_free(left_perm);
+  return ok;
+}
 
-  /* Build GroupedTable result and sort it to match R's convention */
-  int *group_permutation = (int *)malloc(sizeof(int) * n_groups);
-  for (int i = 0; i < n_groups; i++) group_permutation[i] = i;
+static value
+join_indices_to_caml(const gint64 *idx, gint64 n) {
+  CAMLparam0();
+  CAMLlocal1(v_arr);
+  if (n == 0) CAMLreturn(Atom(0));
+  v_arr = caml_alloc(n, 0);
+  for (gint64 i = 0; i < n; i++) Field(v_arr, i) = Val_long(idx[i]);
+  CAMLreturn(v_arr);
+}
 
-  GroupedTableSortContext sort_ctx = {
-    .table = table,
-    .n_keys = n_keys,
-    .key_indices = key_indices,
-    .key_types = key_types,
-    .group_key_values = (gchar ***)group_key_vals->pdata
-  };
+/* Hash join on equally named, identically typed key columns.
+   Args: v_left, v_right (GArrowTable*), v_keys (string list),
+         v_kind (0=inner, 1=left, 2=full, 3=semi, 4=anti)
+   Returns: Some (left_indices, right_indices) for caml_arrow_table_take,
+            where -1 stands for "no row" (a null-filled output row). Semi and
+            anti joins return an empty right array. None when a key column
+            is missing or its type is not supported. */
+CAMLprim value caml_arrow_hash_join(value v_left, value v_right, value v_keys, value v_kind) {
+  CAMLparam4(v_left, v_right, v_keys, v_kind);
+  CAMLlocal4(v_result, v_pair, v_left_arr, v_right_arr);
+
+  GArrowTable *left = (GArrowTable *)Nativeint_val(v_left);
+  GArrowTable *right = (GArrowTable *)Nativeint_val(v_right);
+  int kind = Int_val(v_kind);
 
-#if GLIB_CHECK_VERSION(2, 82, 0)
-  g_sort_array(group_permutation, n_groups, sizeof(int),
-               compare_group_keys, &sort_ctx);
-#else
-  g_qsort_with_data(group_permutation, n_groups, sizeof(int),
-                    compare_group_keys, &sort_ctx);
-#endif
+  int n_keys = 0;
+  for (value it = v_keys; it != Val_emptylist; it = Field(it, 1)) n_keys++;
+  if (n_keys == 0 || left == NULL || right == NULL) CAMLreturn(Val_none);
 
-  GroupedTable *gt = (GroupedTable *)malloc(sizeof(GroupedTable));
-  if (gt == NULL) {
-    /* Cleanup on allocation failure */
-    free(group_permutation);
-    for (int j = 0; j < n_keys; j++) g_free(key_names[j]);
-    free(key_names); free(key_indices); free(key_types);
-    g_hash_table_destroy(group_map);
-    for (guint g = 0; g < (guint)n_groups; g++) {
-      g_array_free((GArray *)g_ptr_array_index(group_rows, g), TRUE);
-      gchar **kv = (gchar **)g_ptr_array_index(group_key_vals, g);
-      for (int k = 0; k < n_keys; k++) g_free(kv[k]);
-      free(kv);
-    }
-    g_ptr_array_free(group_order, TRUE);
-    g_ptr_array_free(group_rows, TRUE);
-    g_ptr_array_free(group_key_vals, TRUE);
-    CAMLreturn(Val_none);
+  gchar **key_names = g_new0(gchar *, n_keys + 1);
+  {
+    int k = 0;
+    for (value it = v_keys; it != Val_emptylist; it = Field(it, 1))
+      key_names[k++] = g_strdup(String_val(Field(it, 0)));
   }
 
-  gt->table = g_object_ref(table);
-  gt->n_groups = n_groups;
-  gt->n_keys = n_keys;
-  gt->key_names = key_names;
-  gt->group_sizes = (int *)malloc(sizeof(int) * n_groups);
-  gt->group_row_indices = (gint64 **)malloc(sizeof(gint64 *) * n_groups);
-  gt->group_key_values = (gchar ***)malloc(sizeof(gchar **) * n_groups);
-
-  for (int i = 0; i < n_groups; i++) {
-    int g = group_permutation[i];
-    GArray *rows_arr = (GArray *)g_ptr_array_index(group_rows, g);
-    gt->group_sizes[i] = (int)rows_arr->len;
-    gt->group_row_indices[i] = (gint64 *)malloc(sizeof(gint64) * rows_arr->len);
-    memcpy(gt->group_row_indices[i], rows_arr->data, sizeof(gint64) * rows_arr->len);
-    /* GArray itself will be free'd later */
-
-    gt->group_key_values[i] = (gchar **)g_ptr_array_index(group_key_vals, g);
-  }
+  gboolean ok = TRUE;
+  JoinOutput out = { NULL, NULL, 0 };
+
+  g_object_ref(left);
+  g_object_ref(right);
+  caml_enter_blocking_section();
+
+  gint64 n_left = garrow_table_get_n_rows(left);
+  gint64 n_right = garrow_table_get_n_rows(right);
+  GArrowSchema *lschema = garrow_table_get_schema(left);
+  GArrowSchema *rschema = garrow_table_get_schema(right);
+  KeyColumn *lk = g_new0(KeyColumn, n_keys);
+  KeyColumn *rk = g_new0(KeyColumn, n_keys);
+  GPtrArray *hold = g_ptr_array_new_with_free_func(g_object_unref);
+  int loaded = 0;
+
+  for (int k = 0; k < n_keys && ok; k++) {
+    gint li = garrow_schema_get_field_index(lschema, key_names[k]);
+    gint ri = garrow_schema_get_field_index(rschema, key_names[k]);
+    if (li < 0 || ri < 0) { ok = FALSE; break; }
+    GArrowField *lf = garrow_schema_get_field(lschema, li);
+    GArrowField *rf = garrow_schema_get_field(rschema, ri);
+    GArrowDataType *lt = garrow_field_get_data_type(lf);
+    GArrowDataType *rt = garrow_field_get_data_type(rf);
+    int tag = key_column_tag(lt);
+    if (tag < 0 || !garrow_data_type_equal(lt, rt)) ok = FALSE;
+    g_object_unref(lf);
+    g_object_unref(rf);
+    if (!ok) break;
+
+    GArrowChunkedArray *lc = garrow_table_get_column_data(left, li);
+    GArrowChunkedArray *rc = garrow_table_get_column_data(right, ri);
+    /* Both sides share the left side's codes for dictionary keys. */
+    gboolean l_ok = key_column_load(&lk[k], lc, n_left, tag, NULL, hold);
+    gboolean r_ok = key_column_load(&rk[k], rc, n_right, tag, lk[k].dict, hold);
+    loaded = k + 1;
+    g_object_unref(lc);
+    g_object_unref(rc);
+    ok = l_ok && r_ok;
+  }
+  g_object_unref(lschema);
+  g_object_unref(rschema);
+
+  if (ok) ok = hash_join_indices(lk, n_left, rk, n_right, n_keys, kind, &out);
+
+  for (int k = 0; k < loaded; k++) {
+    key_column_free(&lk[k]);
+    key_column_free(&rk[k]);
+  }
+  g_free(lk);
+  g_free(rk);
+  g_ptr_array_free(hold, TRUE);
+
+  caml_leave_blocking_section();
+  g_object_unref(left);
+  g_object_unref(right);
+
+  g_strfreev(key_names);
 
-  for (int g = 0; g < n_groups; g++) {
-    GArray *rows_arr = (GArray *)g_ptr_array_index(group_rows, g);
-    g_array_free(rows_arr, TRUE);
+  if (!ok) {
+    g_free(out.left_idx);
+    g_free(out.right_idx);
+    CAMLreturn(Val_none);
   }
 
-  free(group_permutation);
-  g_hash_table_destroy(group_map);
-
-  g_ptr_array_free(group_order, TRUE);
-  g_ptr_array_free(group_rows, FALSE);     /* elements transferred to gt */
-  g_ptr_array_free(group_key_vals, FALSE); /* elements transferred to gt */
-
-  free(key_indices);
-  free(key_types);
+  v_left_arr = join_indices_to_caml(out.left_idx, out.n_out);
+  v_right_arr = out.right_idx ? join_indices_to_caml(out.right_idx, out.n_out) : Atom(0);
+  g_free(out.left_idx);
+  g_free(out.right_idx);
 
+  v_pair = caml_alloc_tuple(2);
+  Store_field(v_pair, 0, v_left_arr);
+  Store_field(v_pair, 1, v_right_arr);
   v_result = caml_alloc(1, 0);
-  Store_field(v_result, 0, caml_copy_nativeint((intnat)gt));
+  Store_field(v_result, 0, v_pair);
   CAMLreturn(v_result);
 }
 
@@ -5652,7 +9874,7 @@ CAMLprim value caml_arrow_table_concatenate(value v_table_ptrs) {
     v_head = Field(v_curr, 0);
     GArrowTable *table = (GArrowTable *)Nativeint_val(v_head);
     if (table != NULL) {
-      all_tables = g_list_prepend(all_tables, table);
+      all_tables = g_list_prepend(all_tables, g_object_ref(table));
     }
     v_curr = Field(v_curr, 1);
   }
@@ -5666,9 +9888,11 @@ CAMLprim value caml_arrow_table_concatenate(value v_table_ptrs) {
   GList *others = all_tables->next;
 
   GError *error = NULL;
+  caml_enter_blocking_section();
   GArrowTable *result = garrow_table_concatenate(first, others, NULL, &error);
+  caml_leave_blocking_section();
 
-  g_list_free(all_tables);
+  g_list_free_full(all_tables, g_object_unref);
 
   if (result == NULL) {
     if (error) g_error_free(error);
@@ -1,24 +1,28 @@
 /* src/ffi/chrono_stubs.c                                       */
 /* C FFI stubs for the chrono package.                          */
 /*                                                              */
-/* Provides caml_tz_offset: computes the UTC offset (in seconds */
-/* EAST of UTC) for a given UNIX microsecond timestamp and IANA */
-/* timezone name using POSIX localtime_r with TZ= override.     */
+/* UTC offsets (in seconds EAST of UTC) of UNIX microsecond     */
+/* timestamps in IANA timezones, read from the system zoneinfo  */
+/* database without touching the process environment:          */
+/*   caml_tz_offset  - one timestamp;                           */
+/*   caml_tz_offsets - every element of an int64 Bigarray (the  */
+/*                     layout of an Arrow timestamp buffer),    */
+/*                     outside the runtime lock.                */
 /*                                                              */
-/* THREAD-SAFETY NOTE: setenv/tzset/localtime_r operate on      */
-/* global process state (the TZ environment variable and         */
-/* tzset()'s internal cache). This is safe under OCaml 4.x      */
-/* (single-domain runtime — the equivalent of the GIL holds     */
-/* the runtime lock across C stubs). If the runtime is ever      */
-/* upgraded to OCaml 5 with multiple Domains calling this        */
-/* simultaneously, a data race will occur. Revisit this          */
-/* function before enabling multicore.                          */
+/* Each TZif file is parsed once into a table of transitions    */
+/* plus its POSIX TZ footer rule, which covers instants after   */
+/* the last transition (zic's "slim" files rely on it). Parsed  */
+/* zones are immutable and cached for the life of the process;  */
+/* the cache is guarded by a mutex, so lookups are safe from    */
+/* any thread or domain.                                        */
 
 #include <caml/mlvalues.h>
 #include <caml/alloc.h>
 #include <caml/memory.h>
 #include <caml/fail.h>
-#include <time.h>
+#include <caml/bigarray.h>
+#include <caml/signals.h>
+#include <pthread.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
@@ -64,64 +68,459 @@ static int find_zoneinfo_path(const char *tz_name, char *out, size_t out_size)
   return -1;
 }
 
-CAMLprim value caml_tz_offset(value v_micros, value v_tz_name)
+/* ------------------------------------------------------------------ */
+/* POSIX TZ rules (the TZif footer, e.g. "CET-1CEST,M3.5.0,M10.5.0/3") */
+/* ------------------------------------------------------------------ */
+
+typedef struct {
+  char kind;      /* 'J': Julian day 1..365 without Feb 29, 'D': day 0..365, 'M': month rule */
+  int month, week, wday, day;
+  int32_t time;   /* local time of day of the change, may be negative or past 24h */
+} TzRuleDate;
+
+typedef struct {
+  int32_t std_off;  /* east of UTC */
+  int32_t dst_off;
+  int has_dst;
+  TzRuleDate start, end;
+} TzRule;
+
+static const char *tz_parse_name(const char *p)
 {
-  CAMLparam2(v_micros, v_tz_name);
+  if (*p == '<') {
+    while (*p && *p != '>') p++;
+    return *p == '>' ? p + 1 : NULL;
+  }
+  const char *start = p;
+  while ((*p >= 'A' && *p <= 'Z') || (*p >= 'a' && *p <= 'z')) p++;
+  return p - start >= 3 ? p : NULL;
+}
+
+/* [+-]hh[:mm[:ss]] as seconds; hours may go up to 167 in rule times. */
+static const char *tz_parse_hms(const char *p, int32_t *out)
+{
+  int sign = 1;
+  if (*p == '+' || *p == '-') {
+    if (*p == '-') sign = -1;
+    p++;
+  }
+  if (*p < '0' || *p > '9') return NULL;
+  int32_t parts[3] = { 0, 0, 0 };
+  for (int k = 0; k < 3; k++) {
+    if (k > 0) {
+      if (*p != ':') break;
+      p++;
+    }
+    if (*p < '0' || *p > '9') return NULL;
+    int32_t v = 0;
+    while (*p >= '0' && *p <= '9') v = v * 10 + (*p++ - '0');
+    parts[k] = v;
+  }
+  if (parts[0] > 167 || parts[1] > 59 || parts[2] > 59) return NULL;
+  *out = sign * (parts[0] * 3600 + parts[1] * 60 + parts[2]);
+  return p;
+}
+
+static const char *tz_parse_int(const char *p, int *out)
+{
+  if (*p < '0' || *p > '9') return NULL;
+  int v = 0;
+  while (*p >= '0' && *p <= '9') v = v * 10 + (*p++ - '0');
+  *out = v;
+  return p;
+}
+
+static const char *tz_parse_rule_date(const char *p, TzRuleDate *d)
+{
+  d->time = 2 * 3600;
+  if (*p == 'M') {
+    d->kind = 'M';
+    if (!(p = tz_parse_int(p + 1, &d->month)) || *p++ != '.') return NULL;
+    if (!(p = tz_parse_int(p, &d->week)) || *p++ != '.') return NULL;
+    if (!(p = tz_parse_int(p, &d->wday))) return NULL;
+    if (d->month < 1 || d->month > 12 || d->week < 1 || d->week > 5 || d->wday > 6) return NULL;
+  } else if (*p == 'J') {
+    d->kind = 'J';
+    if (!(p = tz_parse_int(p + 1, &d->day)) || d->day < 1 || d->day > 365) return NULL;
+  } else {
+    d->kind = 'D';
+    if (!(p = tz_parse_int(p, &d->day)) || d->day > 365) return NULL;
+  }
+  if (*p == '/') p = tz_parse_hms(p + 1, &d->time);
+  return p;
+}
+
+/* Parse a POSIX TZ string. Offsets in it count west of UTC, so they are
+   negated. Returns 0 on success. */
+static int tz_parse_rule(const char *p, TzRule *rule)
+{
+  int32_t west;
+  memset(rule, 0, sizeof *rule);
+  if (!(p = tz_parse_name(p)) || !(p = tz_parse_hms(p, &west))) return -1;
+  rule->std_off = -west;
+  if (*p == '\0') return 0;
+
+  if (!(p = tz_parse_name(p))) return -1;
+  rule->has_dst = 1;
+  rule->dst_off = rule->std_off + 3600;
+  if (*p != ',' && *p != '\0') {
+    if (!(p = tz_parse_hms(p, &west))) return -1;
+    rule->dst_off = -west;
+  }
+  if (*p == '\0') {
+    /* No dates: POSIX leaves them implementation-defined; use the US rule. */
+    rule->start = (TzRuleDate){ 'M', 3, 2, 0, 0, 2 * 3600 };
+    rule->end = (TzRuleDate){ 'M', 11, 1, 0, 0, 2 * 3600 };
+    return 0;
+  }
+  if (*p++ != ',' || !(p = tz_parse_rule_date(p, &rule->start))) return -1;
+  if (*p++ != ',' || !(p = tz_parse_rule_date(p, &rule->end))) return -1;
+  return *p == '\0' ? 0 : -1;
+}
+
+static int tz_is_leap(int64_t y)
+{
+  return (y % 4 == 0 && y % 100 != 0) || y % 400 == 0;
+}
+
+/* Days since 1970-01-01 of a proleptic Gregorian date. */
+static int64_t tz_days_from_civil(int64_t y, int m, int d)
+{
+  y -= m <= 2;
+  int64_t era = (y >= 0 ? y : y - 399) / 400;
+  int64_t yoe = y - era * 400;
+  int64_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+  int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + doe - 719468;
+}
 
-  int64_t micros = Int64_val(v_micros);
-
-  /* Extract tz_name immediately — String_val returns a pointer
-     into the OCaml heap; any subsequent allocation
-     (malloc, setenv, etc.) could trigger GC compaction. */
-  const char *tz_name_raw = String_val(v_tz_name);
-
-  /* Resolve the full zoneinfo path for this tz_name. */
-  char zone_path[512];
-  if (find_zoneinfo_path(tz_name_raw, zone_path, sizeof(zone_path)) != 0) {
-    char err_msg[1024];
-    snprintf(err_msg, sizeof(err_msg),
-      "caml_tz_offset: cannot find zoneinfo file for '%s' "
-      "(searched: TZDIR, /etc/zoneinfo, /usr/share/zoneinfo, "
-      "/usr/lib/zoneinfo)",
-      tz_name_raw);
-    caml_failwith(err_msg);
-  }
-
-  size_t zone_path_len = strlen(zone_path);
-  /* TZ value = ":" + zone_path + NUL */
-  char *tz_buf = (char *)malloc(zone_path_len + 2);
-  tz_buf[0] = ':';
-  memcpy(tz_buf + 1, zone_path, zone_path_len + 1);
-
-  /* Save TZ before changing it — getenv returns a pointer into
-     environ which setenv invalidates, so strdup immediately. */
-  char *orig_tz = getenv("TZ");
-  char *saved_tz = orig_tz ? strdup(orig_tz) : NULL;
-
-  setenv("TZ", tz_buf, 1);
-  free(tz_buf);
-  tzset();
-
-  /* Floor division for negative timestamps (pre-1970) */
-  int64_t secs = micros >= 0
-    ? micros / 1000000
-    : (micros - 999999) / 1000000;
-
-  time_t t = (time_t)secs;
-  struct tm tm;
-  localtime_r(&t, &tm);
-  int64_t offset_sec = (int64_t)tm.tm_gmtoff;
-
-  /* Restore original TZ */
-  if (saved_tz) {
-    setenv("TZ", saved_tz, 1);
-    free(saved_tz);
+static int64_t tz_floor_div(int64_t a, int64_t b)
+{
+  int64_t q = a / b;
+  return (a % b != 0 && ((a < 0) != (b < 0))) ? q - 1 : q;
+}
+
+static int64_t tz_year_of_days(int64_t days)
+{
+  int64_t z = days + 719468;
+  int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+  int64_t doe = z - era * 146097;
+  int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  int64_t mp = (5 * doy + 2) / 153;
+  return yoe + era * 400 + (mp >= 10);
+}
+
+/* Local seconds since the epoch (in the clock the rule is stated in) at
+   which [d] happens in year [y]. */
+static int64_t tz_rule_local_time(const TzRuleDate *d, int64_t y)
+{
+  int64_t days;
+  if (d->kind == 'J') {
+    days = tz_days_from_civil(y, 1, 1) + d->day - 1 + (tz_is_leap(y) && d->day >= 60);
+  } else if (d->kind == 'D') {
+    days = tz_days_from_civil(y, 1, 1) + d->day;
   } else {
-    unsetenv("TZ");
+    static const int month_days[12] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    int64_t first = tz_days_from_civil(y, d->month, 1);
+    int first_wday = (int)(((first + 4) % 7 + 7) % 7);   /* 1970-01-01 was a Thursday */
+    int mday = 1 + (d->wday - first_wday + 7) % 7 + (d->week - 1) * 7;
+    int last = month_days[d->month - 1] + (d->month == 2 && tz_is_leap(y));
+    while (mday > last) mday -= 7;
+    days = first + mday - 1;
   }
-  tzset();
+  return days * 86400 + d->time;
+}
+
+/* A stretch of time with one offset: [start, end). */
+typedef struct {
+  int64_t start, end;
+  int32_t offset;
+} TzSpan;
+
+static void tz_rule_span(const TzRule *rule, int64_t secs, TzSpan *span)
+{
+  span->offset = rule->std_off;
+  span->start = INT64_MIN;
+  span->end = INT64_MAX;
+  if (!rule->has_dst) return;
 
+  /* The changes of the surrounding years, in UTC, with the offset in
+     effect after each; DST starts on standard time and ends on DST. */
+  int64_t y = tz_year_of_days(tz_floor_div(secs + rule->std_off, 86400));
+  int64_t at[6];
+  int32_t after[6];
+  for (int k = 0; k < 3; k++) {
+    at[2 * k] = tz_rule_local_time(&rule->start, y - 1 + k) - rule->std_off;
+    after[2 * k] = rule->dst_off;
+    at[2 * k + 1] = tz_rule_local_time(&rule->end, y - 1 + k) - rule->dst_off;
+    after[2 * k + 1] = rule->std_off;
+  }
+  for (int i = 1; i < 6; i++) {
+    for (int j = i; j > 0 && at[j - 1] > at[j]; j--) {
+      int64_t t = at[j]; at[j] = at[j - 1]; at[j - 1] = t;
+      int32_t o = after[j]; after[j] = after[j - 1]; after[j - 1] = o;
+    }
+  }
+  for (int i = 0; i < 6; i++) {
+    if (at[i] <= secs) {
+      span->start = at[i];
+      span->offset = after[i];
+    } else {
+      span->end = at[i];
+      break;
+    }
+  }
+}
+
+/* ------------------------------------------------------------------ */
+/* TZif zones                                                         */
+/* ------------------------------------------------------------------ */
+
+typedef struct TzZone {
+  char *name;
+  int n_transitions;
+  int64_t *times;      /* UTC seconds, ascending */
+  int32_t *offsets;    /* offset from times[i] until the next transition */
+  int32_t initial;     /* offset before the first transition */
+  int has_rule;        /* rule applies from the last transition on */
+  TzRule rule;
+  struct TzZone *next;
+} TzZone;
+
+static int64_t tz_be(const unsigned char *p, int width)
+{
+  uint64_t v = 0;
+  for (int i = 0; i < width; i++) v = (v << 8) | p[i];
+  if (width == 4) return (int32_t)(uint32_t)v;
+  return (int64_t)v;
+}
+
+static void tz_zone_free(TzZone *z)
+{
+  if (z == NULL) return;
+  free(z->name);
+  free(z->times);
+  free(z->offsets);
+  free(z);
+}
+
+/* Parse one TZif data block (and, for version 2+, the footer after it).
+   [width] is 4 for the version 1 block and 8 for later ones. Returns the
+   zone, or NULL when the block is truncated or inconsistent. */
+static TzZone *tz_parse_block(const unsigned char *p, size_t size, int width, int footer)
+{
+  if (size < 44 || memcmp(p, "TZif", 4) != 0) return NULL;
+  int64_t isut = tz_be(p + 20, 4), isstd = tz_be(p + 24, 4), leap = tz_be(p + 28, 4);
+  int64_t timecnt = tz_be(p + 32, 4), typecnt = tz_be(p + 36, 4), charcnt = tz_be(p + 40, 4);
+  if (isut < 0 || isstd < 0 || leap < 0 || timecnt < 0 || typecnt <= 0 || charcnt < 0)
+    return NULL;
+  size_t need = 44 + (size_t)timecnt * (width + 1) + (size_t)typecnt * 6 + (size_t)charcnt
+              + (size_t)leap * (width + 4) + (size_t)isstd + (size_t)isut;
+  if (need > size) return NULL;
+
+  const unsigned char *times = p + 44;
+  const unsigned char *idx = times + timecnt * width;
+  const unsigned char *types = idx + timecnt;
+
+  TzZone *z = calloc(1, sizeof *z);
+  if (z == NULL) return NULL;
+  z->n_transitions = (int)timecnt;
+  z->times = malloc(sizeof(int64_t) * (timecnt > 0 ? timecnt : 1));
+  z->offsets = malloc(sizeof(int32_t) * (timecnt > 0 ? timecnt : 1));
+  if (z->times == NULL || z->offsets == NULL) {
+    tz_zone_free(z);
+    return NULL;
+  }
+  /* RFC 8536: time type 0 applies before the first transition. */
+  z->initial = (int32_t)tz_be(types, 4);
+  for (int64_t i = 0; i < timecnt; i++) {
+    int type = idx[i];
+    if (type >= typecnt || (i > 0 && tz_be(times + i * width, width) < z->times[i - 1])) {
+      tz_zone_free(z);
+      return NULL;
+    }
+    z->times[i] = tz_be(times + i * width, width);
+    z->offsets[i] = (int32_t)tz_be(types + type * 6, 4);
+  }
+
+  if (footer && need < size && p[need] == '\n') {
+    const char *start = (const char *)p + need + 1;
+    const char *end = memchr(start, '\n', size - need - 1);
+    if (end != NULL && end > start) {
+      char buf[128];
+      size_t len = (size_t)(end - start);
+      if (len < sizeof buf) {
+        memcpy(buf, start, len);
+        buf[len] = '\0';
+        z->has_rule = tz_parse_rule(buf, &z->rule) == 0;
+      }
+    }
+  }
+  return z;
+}
+
+static TzZone *tz_zone_parse(const unsigned char *data, size_t size)
+{
+  if (size < 44 || memcmp(data, "TZif", 4) != 0) return NULL;
+  if (data[4] < '2') return tz_parse_block(data, size, 4, 0);
+
+  /* Skip the version 1 block to reach the 64-bit one. */
+  int64_t isut = tz_be(data + 20, 4), isstd = tz_be(data + 24, 4), leap = tz_be(data + 28, 4);
+  int64_t timecnt = tz_be(data + 32, 4), typecnt = tz_be(data + 36, 4), charcnt = tz_be(data + 40, 4);
+  if (isut < 0 || isstd < 0 || leap < 0 || timecnt < 0 || typecnt < 0 || charcnt < 0)
+    return NULL;
+  size_t v1 = 44 + (size_t)timecnt * 5 + (size_t)typecnt * 6 + (size_t)charcnt
+            + (size_t)leap * 8 + (size_t)isstd + (size_t)isut;
+  if (v1 >= size) return NULL;
+  return tz_parse_block(data + v1, size - v1, 8, 1);
+}
+
+static TzZone *tz_zone_load(const char *name)
+{
+  char path[512];
+  if (find_zoneinfo_path(name, path, sizeof(path)) != 0) return NULL;
+  FILE *f = fopen(path, "rb");
+  if (f == NULL) return NULL;
+  unsigned char *data = NULL;
+  size_t size = 0, cap = 0;
+  for (;;) {
+    if (size == cap) {
+      cap = cap ? cap * 2 : 8192;
+      if (cap > (1u << 24)) break;   /* zoneinfo files are a few KB */
+      unsigned char *grown = realloc(data, cap);
+      if (grown == NULL) break;
+      data = grown;
+    }
+    size_t got = fread(data + size, 1, cap - size, f);
+    size += got;
+    if (got == 0) break;
+  }
+  fclose(f);
+  TzZone *z = data ? tz_zone_parse(data, size) : NULL;
+  free(data);
+  if (z != NULL) {
+    z->name = strdup(name);
+    if (z->name == NULL) {
+      tz_zone_free(z);
+      z = NULL;
+    }
+  }
+  return z;
+}
+
+static pthread_mutex_t tz_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+static TzZone *tz_cache = NULL;
+
+/* The parsed zone [name], loading it on first use; NULL when no readable
+   TZif file exists for it. Failures are not cached, so a zone installed
+   later is picked up. */
+static const TzZone *tz_zone_get(const char *name)
+{
+  pthread_mutex_lock(&tz_cache_lock);
+  TzZone *z = tz_cache;
+  while (z != NULL && strcmp(z->name, name) != 0) z = z->next;
+  if (z == NULL) {
+    z = tz_zone_load(name);
+    if (z != NULL) {
+      z->next = tz_cache;
+      tz_cache = z;
+    }
+  }
+  pthread_mutex_unlock(&tz_cache_lock);
+  return z;
+}
+
+/* The span of constant offset around [secs] (UTC seconds). */
+static void tz_zone_span(const TzZone *z, int64_t secs, TzSpan *span)
+{
+  int n = z->n_transitions;
+  if (n == 0 || secs >= z->times[n - 1]) {
+    if (z->has_rule) {
+      tz_rule_span(&z->rule, secs, span);
+      if (n > 0 && span->start < z->times[n - 1]) span->start = z->times[n - 1];
+      return;
+    }
+    span->offset = n == 0 ? z->initial : z->offsets[n - 1];
+    span->start = n == 0 ? INT64_MIN : z->times[n - 1];
+    span->end = INT64_MAX;
+    return;
+  }
+  if (secs < z->times[0]) {
+    span->offset = z->initial;
+    span->start = INT64_MIN;
+    span->end = z->times[0];
+    return;
+  }
+  /* Last transition at or before secs. */
+  int lo = 0, hi = n - 1;
+  while (lo < hi) {
+    int mid = lo + (hi - lo + 1) / 2;
+    if (z->times[mid] <= secs) lo = mid;
+    else hi = mid - 1;
+  }
+  span->offset = z->offsets[lo];
+  span->start = z->times[lo];
+  span->end = z->times[lo + 1];
+}
+
+static void tz_fail_not_found(const char *tz_name)
+{
+  char err_msg[1024];
+  snprintf(err_msg, sizeof(err_msg),
+    "caml_tz_offset: cannot find zoneinfo file for '%s' "
+    "(searched: TZDIR, /etc/zoneinfo, /usr/share/zoneinfo, "
+    "/usr/lib/zoneinfo)",
+    tz_name);
+  caml_failwith(err_msg);
+}
+
+/* Floor division for negative timestamps (pre-1970) */
+static int64_t tz_micros_to_secs(int64_t micros)
+{
+  return micros >= 0 ? micros / 1000000 : (micros - 999999) / 1000000;
+}
+
+CAMLprim value caml_tz_offset(value v_micros, value v_tz_name)
+{
+  CAMLparam2(v_micros, v_tz_name);
   CAMLlocal1(result);
-  result = caml_copy_int64(offset_sec);
+
+  const TzZone *zone = tz_zone_get(String_val(v_tz_name));
+  if (zone == NULL) tz_fail_not_found(String_val(v_tz_name));
+
+  TzSpan span;
+  tz_zone_span(zone, tz_micros_to_secs(Int64_val(v_micros)), &span);
+  result = caml_copy_int64((int64_t)span.offset);
   CAMLreturn(result);
 }
+
+/* (int64 Bigarray micros, string tz_name, int64 Bigarray out) -> unit
+   Writes the offset of every timestamp into [out], which must be at least
+   as long. Sorted or clustered timestamps reuse the previous span instead
+   of searching again. */
+CAMLprim value caml_tz_offsets(value v_micros, value v_tz_name, value v_out)
+{
+  CAMLparam3(v_micros, v_tz_name, v_out);
+
+  intnat n = Caml_ba_array_val(v_micros)->dim[0];
+  if (Caml_ba_array_val(v_out)->dim[0] < n)
+    caml_invalid_argument("caml_tz_offsets: output shorter than input");
+
+  const TzZone *zone = tz_zone_get(String_val(v_tz_name));
+  if (zone == NULL) tz_fail_not_found(String_val(v_tz_name));
+
+  const int64_t *micros = (const int64_t *)Caml_ba_data_val(v_micros);
+  int64_t *out = (int64_t *)Caml_ba_data_val(v_out);
+
+  caml_enter_blocking_section();
+  TzSpan span = { INT64_MAX, INT64_MIN, 0 };
+  for (intnat i = 0; i < n; i++) {
+    int64_t secs = tz_micros_to_secs(micros[i]);
+    if (secs < span.start || secs >= span.end) tz_zone_span(zone, secs, &span);
+    out[i] = span.offset;
+  }
+  caml_leave_blocking_section();
+
+  CAMLreturn(Val_unit);
+}
@@ -6,6 +6,9 @@
 #include <caml/fail.h>
 #include <caml/callback.h>
 #include <caml/custom.h>
+#include <caml/bigarray.h>
+#include <caml/signals.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
@@ -50,8 +53,30 @@ cleanup:
     caml_failwith(err_buf);
 }
 
+/* Per-session state reused by every column-batched run: the CPU memory info,
+   the I/O binding and the row-major float batch buffer. It lives outside the
+   custom block (which the GC may move) and is guarded by [lock] because the
+   binding and buffer are shared between callers of the same session. */
+typedef struct {
+    OrtMemoryInfo* memory_info;
+    OrtIoBinding* binding;
+    float* batch_buf;
+    size_t batch_cap;
+    pthread_mutex_t lock;
+} tlang_onnx_runner;
+
+static void free_onnx_runner(tlang_onnx_runner* r) {
+    if (r == NULL) return;
+    if (r->binding) g_ort->ReleaseIoBinding(r->binding);
+    if (r->memory_info) g_ort->ReleaseMemoryInfo(r->memory_info);
+    free(r->batch_buf);
+    pthread_mutex_destroy(&r->lock);
+    free(r);
+}
+
 typedef struct {
     OrtSession* session;
+    tlang_onnx_runner* runner;
     size_t input_count;
     size_t output_count;
     int64_t input_width;
@@ -61,6 +86,8 @@ typedef struct {
 
 static void finalize_onnx_session(value v) {
     tlang_onnx_session* s = (tlang_onnx_session*)Data_custom_val(v);
+    free_onnx_runner(s->runner);
+    s->runner = NULL;
     if (s->session) {
         g_ort->ReleaseSession(s->session);
         s->session = NULL;
@@ -82,13 +109,36 @@ static struct custom_operations onnx_session_ops = {
     custom_fixed_length_default
 };
 
-CAMLprim value caml_onnx_session_create(value v_path) {
+/* Session settings from [Onnx_ffi.session_options]. Zero thread counts keep
+   ORT's defaults; [optimized_path], when set, is where ORT saves the graph
+   after optimisation so later loads can skip it. create_onnx_session takes
+   ownership of [optimized_path] and frees it. */
+typedef struct {
+    int intra_op_threads;
+    int inter_op_threads;
+    int graph_optimization;
+    int parallel_execution;
+    char* optimized_path;
+} onnx_session_config;
+
+static GraphOptimizationLevel onnx_graph_level(int level) {
+    switch (level) {
+        case 0: return ORT_DISABLE_ALL;
+        case 1: return ORT_ENABLE_BASIC;
+        case 2: return ORT_ENABLE_EXTENDED;
+        default: return ORT_ENABLE_ALL;
+    }
+}
+
+static value create_onnx_session(value v_path, onnx_session_config* cfg) {
     CAMLparam1(v_path);
     CAMLlocal1(v);
     init_ort();
-    const char* path = String_val(v_path);
+    char* path = strdup(String_val(v_path));
+    OrtStatus* create_status = NULL;
     OrtSessionOptions* session_options = NULL;
     OrtSession* session = NULL;
+    tlang_onnx_runner* runner = NULL;
     OrtAllocator* allocator = NULL;
     OrtTypeInfo* input_type_info = NULL;
     const OrtTensorTypeAndShapeInfo* tensor_info = NULL;
@@ -100,8 +150,28 @@ CAMLprim value caml_onnx_session_create(value v_path) {
     int64_t input_width = 0;
     char err_buf[2048] = {0};
 
+    if (path == NULL) {
+        SET_ERROR("Failed to copy ONNX model path.");
+    }
     CHECK_STATUS_GOTO(g_ort->CreateSessionOptions(&session_options));
-    CHECK_STATUS_GOTO(g_ort->CreateSession(g_env, path, session_options, &session));
+    if (cfg->intra_op_threads > 0) {
+        CHECK_STATUS_GOTO(g_ort->SetIntraOpNumThreads(session_options, cfg->intra_op_threads));
+    }
+    if (cfg->inter_op_threads > 0) {
+        CHECK_STATUS_GOTO(g_ort->SetInterOpNumThreads(session_options, cfg->inter_op_threads));
+    }
+    CHECK_STATUS_GOTO(g_ort->SetSessionGraphOptimizationLevel(session_options, onnx_graph_level(cfg->graph_optimization)));
+    CHECK_STATUS_GOTO(g_ort->SetSessionExecutionMode(session_options, cfg->parallel_execution ? ORT_PARALLEL : ORT_SEQUENTIAL));
+    if (cfg->optimized_path != NULL) {
+        CHECK_STATUS_GOTO(g_ort->SetOptimizedModelFilePath(session_options, cfg->optimized_path));
+    }
+
+    /* Loading and optimising the graph is the slow part; let other OCaml
+       threads run meanwhile. */
+    caml_enter_blocking_section();
+    create_status = g_ort->CreateSession(g_env, path, session_options, &session);
+    caml_leave_blocking_section();
+    CHECK_STATUS_GOTO(create_status);
     CHECK_STATUS_GOTO(g_ort->SessionGetInputCount(session, &input_count));
     CHECK_STATUS_GOTO(g_ort->SessionGetOutputCount(session, &output_count));
     if (input_count == 0 || output_count == 0) {
@@ -154,9 +224,18 @@ CAMLprim value caml_onnx_session_create(value v_path) {
         }
     }
 
+    runner = calloc(1, sizeof(tlang_onnx_runner));
+    if (runner == NULL) {
+        SET_ERROR("Failed to allocate ONNX run state.");
+    }
+    pthread_mutex_init(&runner->lock, NULL);
+    CHECK_STATUS_GOTO(g_ort->CreateCpuMemoryInfo(OrtDeviceAllocator, OrtMemTypeDefault, &runner->memory_info));
+    CHECK_STATUS_GOTO(g_ort->CreateIoBinding(session, &runner->binding));
+
     v = caml_alloc_custom(&onnx_session_ops, sizeof(tlang_onnx_session), 0, 1);
     tlang_onnx_session* s = (tlang_onnx_session*)Data_custom_val(v);
     s->session = session;
+    s->runner = runner;
     s->input_count = input_count;
     s->output_count = output_count;
     s->input_width = input_width;
@@ -165,11 +244,14 @@ CAMLprim value caml_onnx_session_create(value v_path) {
     if (input_type_info) g_ort->ReleaseTypeInfo(input_type_info);
     if (session_options) g_ort->ReleaseSessionOptions(session_options);
     free(input_dims);
+    free(path);
+    free(cfg->optimized_path);
     CAMLreturn(v);
 
 cleanup:
     if (input_type_info) g_ort->ReleaseTypeInfo(input_type_info);
     if (session_options) g_ort->ReleaseSessionOptions(session_options);
+    free_onnx_runner(runner);
     if (session) g_ort->ReleaseSession(session);
     if (input_names) {
         for (size_t i = 0; i < input_count; i++) free(input_names[i]);
@@ -180,9 +262,37 @@ cleanup:
         free(output_names);
     }
     free(input_dims);
+    free(path);
+    free(cfg->optimized_path);
     caml_failwith(err_buf);
 }
 
+CAMLprim value caml_onnx_session_create(value v_path) {
+    onnx_session_config cfg = { 0, 0, 3, 0, NULL };
+    return create_onnx_session(v_path, &cfg);
+}
+
+/* [v_opts] is an [Onnx_ffi.session_options] record. */
+CAMLprim value caml_onnx_session_create_with_options(value v_path, value v_opts) {
+    CAMLparam2(v_path, v_opts);
+    CAMLlocal1(v);
+    value v_optimized = Field(v_opts, 4);
+    char* optimized_path = NULL;
+    if (Is_block(v_optimized)) {
+        optimized_path = strdup(String_val(Field(v_optimized, 0)));
+        if (optimized_path == NULL) caml_failwith("Failed to copy ONNX optimized model path.");
+    }
+    onnx_session_config cfg = {
+        Int_val(Field(v_opts, 0)),
+        Int_val(Field(v_opts, 1)),
+        Int_val(Field(v_opts, 2)),
+        Bool_val(Field(v_opts, 3)),
+        optimized_path
+    };
+    v = create_onnx_session(v_path, &cfg);
+    CAMLreturn(v);
+}
+
 CAMLprim value caml_onnx_session_run_multi(value v_session, value v_input_names, value v_input_tensors, value v_output_names) {
     CAMLparam4(v_session, v_input_names, v_input_tensors, v_output_names);
     CAMLlocal3(v_result, v_temp_out, v_row);
@@ -200,9 +310,7 @@ CAMLprim value caml_onnx_session_run_multi(value v_session, value v_input_names,
     OrtValue** in_tensors = calloc(in_count, sizeof(OrtValue*));
     OrtValue** out_tensors = calloc(out_req_count, sizeof(OrtValue*));
     float** in_data_ptrs = calloc(in_count, sizeof(float*));
-    OrtMemoryInfo* memory_info = NULL;
-
-    CHECK_STATUS_GOTO(g_ort->CreateCpuMemoryInfo(OrtDeviceAllocator, OrtMemTypeDefault, &memory_info));
+    const OrtMemoryInfo* memory_info = s->runner->memory_info;
 
     size_t common_nrows = 0;
     for (size_t i = 0; i < in_count; i++) {
@@ -299,12 +407,10 @@ CAMLprim value caml_onnx_session_run_multi(value v_session, value v_input_names,
         if (out_tensors[i]) g_ort->ReleaseValue(out_tensors[i]);
     }
     free(in_names); free(out_names); free(in_tensors); free(out_tensors); free(in_data_ptrs);
-    if (memory_info) g_ort->ReleaseMemoryInfo(memory_info);
 
     CAMLreturn(v_result);
 
 cleanup:
-    if (memory_info) g_ort->ReleaseMemoryInfo(memory_info);
     for (size_t i = 0; i < in_count; i++) {
         if (in_tensors[i]) g_ort->ReleaseValue(in_tensors[i]);
         if (in_data_ptrs[i]) free(in_data_ptrs[i]);
@@ -316,6 +422,236 @@ cleanup:
     caml_failwith(err_buf);
 }
 
+/* ===================================================================== */
+/* Column-batched scoring                                                 */
+/* ===================================================================== */
+
+/* Rows transposed per tile, so the destination rows stay in cache while
+   each column is read sequentially. */
+#define ONNX_TRANSPOSE_TILE 512
+
+typedef struct {
+    OrtSession* session;
+    tlang_onnx_runner* runner;
+    const char* input_name;
+    const char* output_name;
+    size_t ncols;
+    const void** columns;
+    const int* column_is_int;
+    size_t nrows;
+    size_t batch_rows;
+    double* out;
+    size_t out_width;
+    char err_buf[2048];
+} onnx_column_run;
+
+/* Copy rows [start, start + rows) of the feature columns into [dst] as a
+   row-major float matrix. */
+static void transpose_columns(const onnx_column_run* r, size_t start, size_t rows, float* dst) {
+    size_t ncols = r->ncols;
+    for (size_t t0 = 0; t0 < rows; t0 += ONNX_TRANSPOSE_TILE) {
+        size_t t1 = t0 + ONNX_TRANSPOSE_TILE < rows ? t0 + ONNX_TRANSPOSE_TILE : rows;
+        for (size_t c = 0; c < ncols; c++) {
+            float* out = dst + c;
+            if (r->column_is_int[c]) {
+                const int64_t* src = (const int64_t*)r->columns[c] + start;
+                for (size_t i = t0; i < t1; i++) out[i * ncols] = (float)src[i];
+            } else {
+                const double* src = (const double*)r->columns[c] + start;
+                for (size_t i = t0; i < t1; i++) out[i * ncols] = (float)src[i];
+            }
+        }
+    }
+}
+
+/* Convert [n] elements of an output tensor to doubles. Returns 0 on success. */
+static int copy_tensor_doubles(OrtValue* tensor, ONNXTensorElementDataType type, double* dst, size_t n, char* err_buf, size_t err_buf_size) {
+    void* data = NULL;
+    OrtStatus* status = g_ort->GetTensorMutableData(tensor, &data);
+    if (status != NULL) {
+        copy_status_message(status, err_buf, err_buf_size);
+        return -1;
+    }
+    switch (type) {
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT:
+            for (size_t i = 0; i < n; i++) dst[i] = (double)((float*)data)[i];
+            return 0;
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_DOUBLE:
+            memcpy(dst, data, n * sizeof(double));
+            return 0;
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT64:
+            for (size_t i = 0; i < n; i++) dst[i] = (double)((int64_t*)data)[i];
+            return 0;
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT32:
+            for (size_t i = 0; i < n; i++) dst[i] = (double)((int32_t*)data)[i];
+            return 0;
+        default:
+            snprintf(err_buf, err_buf_size, "%s", "Unsupported ONNX output tensor element type.");
+            return -1;
+    }
+}
+
+/* Score every batch through the session's I/O binding. Runs without the
+   OCaml runtime lock, so it touches no OCaml values. The output buffer is
+   sized once the first batch reveals the number of values per row. */
+static int run_column_batches(onnx_column_run* r) {
+    char err_buf[2048] = {0};
+    tlang_onnx_runner* runner = r->runner;
+    OrtAllocator* allocator = NULL;
+    OrtValue* in_tensor = NULL;
+    OrtValue** outputs = NULL;
+    size_t output_count = 0;
+    OrtTensorTypeAndShapeInfo* shape_info = NULL;
+    int64_t* dims = NULL;
+    int ok = 0;
+
+    pthread_mutex_lock(&runner->lock);
+
+    size_t needed = r->batch_rows * r->ncols;
+    if (runner->batch_cap < needed) {
+        float* buf = realloc(runner->batch_buf, needed * sizeof(float));
+        if (buf == NULL) SET_ERROR("Failed to allocate ONNX batch buffer.");
+        runner->batch_buf = buf;
+        runner->batch_cap = needed;
+    }
+
+    CHECK_STATUS_GOTO(g_ort->GetAllocatorWithDefaultOptions(&allocator));
+    CHECK_STATUS_GOTO(g_ort->BindOutputToDevice(runner->binding, r->output_name, runner->memory_info));
+
+    for (size_t start = 0; start < r->nrows; start += r->batch_rows) {
+        size_t rows = r->nrows - start < r->batch_rows ? r->nrows - start : r->batch_rows;
+        transpose_columns(r, start, rows, runner->batch_buf);
+
+        int64_t shape[] = { (int64_t)rows, (int64_t)r->ncols };
+        CHECK_STATUS_GOTO(g_ort->CreateTensorWithDataAsOrtValue(runner->memory_info, runner->batch_buf, rows * r->ncols * sizeof(float), shape, 2, ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT, &in_tensor));
+        CHECK_STATUS_GOTO(g_ort->BindInput(runner->binding, r->input_name, in_tensor));
+        CHECK_STATUS_GOTO(g_ort->RunWithBinding(r->session, NULL, runner->binding));
+        CHECK_STATUS_GOTO(g_ort->GetBoundOutputValues(runner->binding, allocator, &outputs, &output_count));
+        if (output_count == 0) SET_ERROR("ONNX model produced no output for the requested name.");
+
+        ONNXTensorElementDataType output_type = ONNX_TENSOR_ELEMENT_DATA_TYPE_UNDEFINED;
+        size_t dim_count = 0;
+        CHECK_STATUS_GOTO(g_ort->GetTensorTypeAndShape(outputs[0], &shape_info));
+        CHECK_STATUS_GOTO(g_ort->GetTensorElementType(shape_info, &output_type));
+        CHECK_STATUS_GOTO(g_ort->GetDimensionsCount(shape_info, &dim_count));
+        dims = malloc(sizeof(int64_t) * (dim_count > 0 ? dim_count : 1));
+        if (dims == NULL) SET_ERROR("Failed to allocate ONNX output shape buffer.");
+        CHECK_STATUS_GOTO(g_ort->GetDimensions(shape_info, dims, dim_count));
+
+        size_t total = 1;
+        for (size_t i = 0; i < dim_count; i++) total *= (size_t)dims[i];
+        if (total % rows != 0) SET_ERROR("ONNX output does not hold a whole number of values per input row.");
+        size_t width = total / rows;
+        if (r->out == NULL) {
+            if (width == 0) SET_ERROR("ONNX model produced an empty output tensor.");
+            r->out_width = width;
+            r->out = malloc(r->nrows * width * sizeof(double));
+            if (r->out == NULL) SET_ERROR("Failed to allocate ONNX prediction buffer.");
+        } else if (width != r->out_width) {
+            SET_ERROR("ONNX output width changed between batches.");
+        }
+        if (copy_tensor_doubles(outputs[0], output_type, r->out + start * width, total, err_buf, sizeof(err_buf)) != 0) goto cleanup;
+
+        g_ort->ReleaseTensorTypeAndShapeInfo(shape_info);
+        shape_info = NULL;
+        free(dims);
+        dims = NULL;
+        for (size_t i = 0; i < output_count; i++) g_ort->ReleaseValue(outputs[i]);
+        allocator->Free(allocator, outputs);
+        outputs = NULL;
+        g_ort->ReleaseValue(in_tensor);
+        in_tensor = NULL;
+    }
+    ok = 1;
+
+cleanup:
+    if (shape_info) g_ort->ReleaseTensorTypeAndShapeInfo(shape_info);
+    free(dims);
+    if (outputs) {
+        for (size_t i = 0; i < output_count; i++) g_ort->ReleaseValue(outputs[i]);
+        allocator->Free(allocator, outputs);
+    }
+    g_ort->ClearBoundInputs(runner->binding);
+    g_ort->ClearBoundOutputs(runner->binding);
+    if (in_tensor) g_ort->ReleaseValue(in_tensor);
+    pthread_mutex_unlock(&runner->lock);
+    if (!ok) memcpy(r->err_buf, err_buf, sizeof(err_buf));
+    return ok ? 0 : -1;
+}
+
+/* Score feature columns without materialising a row matrix.
+   [v_columns] is an array of [Arrow_column.numeric_view] (Float64 or Int64
+   Bigarrays, usually the Arrow buffers themselves). Rows are fed to the
+   model [v_batch_size] at a time and the outputs are returned flattened
+   row-major as one Float64 Bigarray. */
+CAMLprim value caml_onnx_session_run_columns(value v_session, value v_input_name, value v_output_name, value v_columns, value v_batch_size) {
+    CAMLparam5(v_session, v_input_name, v_output_name, v_columns, v_batch_size);
+    CAMLlocal1(v_result);
+    tlang_onnx_session* s = (tlang_onnx_session*)Data_custom_val(v_session);
+    onnx_column_run run;
+    memset(&run, 0, sizeof(run));
+    char* input_name = NULL;
+    char* output_name = NULL;
+    int failed = 0;
+
+    size_t ncols = Wosize_val(v_columns);
+    intnat batch_size = Long_val(v_batch_size);
+    if (ncols == 0) caml_failwith("No feature columns provided for ONNX prediction");
+    if (batch_size <= 0) caml_failwith("ONNX batch size must be positive");
+
+    run.columns = calloc(ncols, sizeof(void*));
+    int* column_is_int = calloc(ncols, sizeof(int));
+    if (run.columns == NULL || column_is_int == NULL) {
+        free(run.columns);
+        free(column_is_int);
+        caml_failwith("Failed to allocate ONNX column table.");
+    }
+    for (size_t c = 0; c < ncols; c++) {
+        value v_view = Field(v_columns, c);
+        value v_ba = Field(v_view, 0);
+        size_t len = (size_t)Caml_ba_array_val(v_ba)->dim[0];
+        if (c == 0) run.nrows = len;
+        else if (len != run.nrows) {
+            free(run.columns);
+            free(column_is_int);
+            caml_failwith("All ONNX feature columns must have the same length");
+        }
+        run.columns[c] = Caml_ba_data_val(v_ba);
+        column_is_int[c] = Tag_val(v_view) == 1;
+    }
+    run.column_is_int = column_is_int;
+    run.ncols = ncols;
+    run.batch_rows = (size_t)batch_size < run.nrows ? (size_t)batch_size : (run.nrows > 0 ? run.nrows : 1);
+    run.session = s->session;
+    run.runner = s->runner;
+
+    if (run.nrows > 0) {
+        input_name = strdup(String_val(v_input_name));
+        output_name = strdup(String_val(v_output_name));
+        if (input_name == NULL || output_name == NULL) {
+            snprintf(run.err_buf, sizeof(run.err_buf), "%s", "Failed to copy ONNX input/output names.");
+            failed = 1;
+        } else {
+            run.input_name = input_name;
+            run.output_name = output_name;
+            caml_enter_blocking_section();
+            failed = run_column_batches(&run) != 0;
+            caml_leave_blocking_section();
+        }
+    }
+
+    free(input_name);
+    free(output_name);
+    free(run.columns);
+    free(column_is_int);
+    if (failed) {
+        free(run.out);
+        caml_failwith(run.err_buf);
+    }
+    v_result = caml_ba_alloc_dims(CAML_BA_FLOAT64 | CAML_BA_C_LAYOUT | CAML_BA_MANAGED, 1, run.out, (intnat)(run.nrows * run.out_width));
+    CAMLreturn(v_result);
+}
+
 CAMLprim value caml_onnx_session_input_width(value v_session) {
     CAMLparam1(v_session);
     tlang_onnx_session* s = (tlang_onnx_session*)Data_custom_val(v_session);
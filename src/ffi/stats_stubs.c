@@ -1,7 +1,16 @@
 /* src/ffi/stats_stubs.c */
 #include <caml/mlvalues.h>
 #include <caml/alloc.h>
+#include <caml/memory.h>
+#include <caml/fail.h>
+#include <caml/bigarray.h>
+#include <caml/signals.h>
 #include <math.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 
 /* Acklam's algorithm for the inverse normal CDF.
    Provides accuracy of about 10^-9. */
@@ -49,9 +58,14 @@ CAMLprim value caml_stats_normal_quantile(value v) {
     return caml_copy_double(normal_quantile_c(Double_val(v)));
 }
 
+double caml_stats_normal_quantile_unboxed(double p) {
+    return normal_quantile_c(p);
+}
+
 /* Cornish-Fisher expansion for Student's T distribution.
-   Accurate for df > 4 and p not extremely close to 0 or 1. */
-double t_quantile_c(double p, int df) {
+   Accurate for df > 4 and p not extremely close to 0 or 1; used as the
+   starting point of the exact solver below. */
+static double t_quantile_cornish_fisher(double p, int df) {
     double z = normal_quantile_c(p);
     if (df <= 0) return z;
     
@@ -72,6 +86,1009 @@ double t_quantile_c(double p, int df) {
     return t;
 }
 
+/* ===================================================================== */
+/* Distribution functions                                                */
+/* ===================================================================== */
+
+/* CDF, density and quantile of the normal, Student t, chi-squared and F
+   distributions. The special functions are the same Lanczos / series /
+   continued-fraction evaluations Distributions used in OCaml, so scalar
+   results are unchanged; the array entry point runs a whole column per
+   call with the distribution dispatch hoisted out of the loop. */
+
+/* Matches Stats.dist and Stats.dist_fn. */
+enum { DIST_NORMAL, DIST_T, DIST_CHISQ, DIST_F };
+enum { DIST_CDF, DIST_DENSITY, DIST_QUANTILE };
+
+static double dist_lanczos(double v) {
+    static const double coefs[9] = {
+        0.99999999999980993, 676.5203681218851, -1259.1392167224028,
+        771.32342877765313, -176.61502916214059, 12.507343278686905,
+        -0.13857109526572012, 9.9843695780195716e-6, 1.5056327351493116e-7
+    };
+    double vv = v - 1.0;
+    double x = coefs[0];
+    for (int i = 1; i <= 8; i++) x += coefs[i] / (vv + (double)i);
+    double t = vv + 7.0 + 0.5;
+    return 0.5 * log(2.0 * M_PI) + (vv + 0.5) * log(t) - t + log(x);
+}
+
+static double dist_log_gamma(double v) {
+    if (v < 0.5)
+        return log(M_PI) - log(fabs(sin(M_PI * v))) - dist_lanczos(1.0 - v);
+    return dist_lanczos(v);
+}
+
+/* Regularised incomplete gamma function P(a, x). */
+static double dist_gammp(double a, double x) {
+    if (x < 0.0 || a <= 0.0) return 0.0;
+    double gln = dist_log_gamma(a);
+    if (x < a + 1.0) {
+        double ap = a;
+        double term = 1.0 / a;
+        double sum = term;
+        for (int n = 0; ; n++) {
+            ap += 1.0;
+            term *= x / ap;
+            sum += term;
+            if (fabs(term) < fabs(sum) * 3.0e-12 || n > 100) break;
+        }
+        return exp(a * log(x) - x - gln) * sum;
+    }
+    const double fpmin = 1.0e-30;
+    double b = x + 1.0 - a;
+    double h = b;
+    if (fabs(h) < fpmin) h = fpmin;
+    double c = h;
+    double d = 0.0;
+    for (int i = 1; i <= 100; i++) {
+        double an = -(double)i * ((double)i - a);
+        double bi = x + (double)(2 * i + 1) - a;
+        d = bi + an * d;
+        if (fabs(d) < fpmin) d = fpmin;
+        c = bi + an / c;
+        if (fabs(c) < fpmin) c = fpmin;
+        d = 1.0 / d;
+        double del = d * c;
+        h *= del;
+        if (fabs(del - 1.0) < 3.0e-12) break;
+    }
+    return 1.0 - exp(a * log(x) - x - gln) * (1.0 / h);
+}
+
+static double dist_guard(double v) { return fabs(v) < 1.0e-30 ? 1.0e-30 : v; }
+
+static double dist_beta_cf(double a, double b, double x) {
+    double qab = a + b;
+    double qap = a + 1.0;
+    double qam = a - 1.0;
+    double c = 1.0;
+    double d = 1.0 / dist_guard(1.0 - qab * x / qap);
+    double h = d;
+    for (int m = 1; ; m++) {
+        double mf = (double)m;
+        double m2 = 2.0 * mf;
+        double aa = mf * (b - mf) * x / ((qam + m2) * (a + m2));
+        d = 1.0 / dist_guard(1.0 + aa * d);
+        c = dist_guard(1.0 + aa / c);
+        h *= d * c;
+        aa = -(a + mf) * (qab + mf) * x / ((a + m2) * (qap + m2));
+        d = 1.0 / dist_guard(1.0 + aa * d);
+        c = dist_guard(1.0 + aa / c);
+        double del = d * c;
+        h *= del;
+        if (fabs(del - 1.0) < 3.0e-12 || m > 100) return h;
+    }
+}
+
+/* Regularised incomplete beta function I_x(a, b). */
+static double dist_betai(double x, double a, double b) {
+    if (x <= 0.0) return 0.0;
+    if (x >= 1.0) return 1.0;
+    double gln = dist_log_gamma(a + b) - dist_log_gamma(a) - dist_log_gamma(b);
+    if (x < (a + 1.0) / (a + b + 2.0))
+        return exp(gln + a * log(x) + b * log(1.0 - x)) / a * dist_beta_cf(a, b, x);
+    return 1.0 - exp(gln + b * log(1.0 - x) + a * log(x)) / b * dist_beta_cf(b, a, 1.0 - x);
+}
+
+/* [a] and [b] are (mean, sd) for the normal, (df, -) for t and
+   chi-squared and (df1, df2) for F. */
+static inline double dist_cdf(int kind, double x, double a, double b) {
+    switch (kind) {
+        case DIST_NORMAL: {
+            double z = (x - a) / b;
+            return z < 0.0 ? 0.5 * erfc(-z / sqrt(2.0)) : 1.0 - 0.5 * erfc(z / sqrt(2.0));
+        }
+        case DIST_T: {
+            double p = 0.5 * dist_betai(a / (a + x * x), 0.5 * a, 0.5);
+            return x > 0.0 ? 1.0 - p : p;
+        }
+        case DIST_CHISQ:
+            return dist_gammp(0.5 * a, 0.5 * x);
+        default:
+            if (x < 0.0) return 0.0;
+            return 1.0 - dist_betai(b / (b + a * x), 0.5 * b, 0.5 * a);
+    }
+}
+
+static inline double dist_density(int kind, double x, double a, double b) {
+    switch (kind) {
+        case DIST_NORMAL: {
+            double z = (x - a) / b;
+            return 1.0 / (b * sqrt(2.0 * M_PI)) * exp(-0.5 * z * z);
+        }
+        case DIST_T:
+            return exp(dist_log_gamma(0.5 * (a + 1.0)) - dist_log_gamma(0.5 * a)
+                       - 0.5 * log(a * M_PI) - 0.5 * (a + 1.0) * log1p(x * x / a));
+        case DIST_CHISQ:
+            if (x < 0.0) return 0.0;
+            if (x == 0.0) return a < 2.0 ? HUGE_VAL : a == 2.0 ? 0.5 : 0.0;
+            return exp((0.5 * a - 1.0) * log(x) - 0.5 * x - 0.5 * a * log(2.0) - dist_log_gamma(0.5 * a));
+        default:
+            if (x < 0.0) return 0.0;
+            if (x == 0.0) return a < 2.0 ? HUGE_VAL : a == 2.0 ? 1.0 : 0.0;
+            return exp(0.5 * (a * log(a * x) + b * log(b) - (a + b) * log(a * x + b)) - log(x)
+                       - (dist_log_gamma(0.5 * a) + dist_log_gamma(0.5 * b) - dist_log_gamma(0.5 * (a + b))));
+    }
+}
+
+/* Invert the CDF on [lo, hi) by Newton steps on the density, falling back
+   to bisection whenever a step leaves the bracket. An infinite [hi] is
+   found by doubling. */
+static double dist_solve(int kind, double p, double a, double b, double x, double lo, double hi) {
+    if (isinf(hi)) {
+        hi = x > 1.0 ? 2.0 * x : 1.0;
+        while (dist_cdf(kind, hi, a, b) < p) {
+            lo = hi;
+            hi *= 2.0;
+            if (isinf(hi)) return HUGE_VAL;
+        }
+    }
+    if (!(x > lo && x < hi)) x = 0.5 * (lo + hi);
+    for (int iter = 0; iter < 200; iter++) {
+        double f = dist_cdf(kind, x, a, b) - p;
+        if (f == 0.0) return x;
+        if (f < 0.0) lo = x; else hi = x;
+        double dens = dist_density(kind, x, a, b);
+        double next = dens > 0.0 && isfinite(dens) ? x - f / dens : lo;
+        if (!(next > lo && next < hi)) next = 0.5 * (lo + hi);
+        if (fabs(next - x) <= 1.0e-15 * fmax(1.0, fabs(next)) || hi - lo <= 1.0e-15 * fmax(1.0, fabs(lo)))
+            return next;
+        x = next;
+    }
+    return x;
+}
+
+/* Exact Student t quantile: closed forms for 1, 2 and 4 degrees of
+   freedom, otherwise the Cornish-Fisher value refined against the CDF. */
+double t_quantile_c(double p, int df) {
+    if (df <= 0) return normal_quantile_c(p);
+    if (p <= 0.0) return -HUGE_VAL;
+    if (p >= 1.0) return HUGE_VAL;
+    if (p == 0.5) return 0.0;
+    if (p < 0.5) return -t_quantile_c(1.0 - p, df);
+    switch (df) {
+        case 1: return tan(M_PI * (p - 0.5));
+        case 2: return (2.0 * p - 1.0) / sqrt(2.0 * p * (1.0 - p));
+        case 4: {
+            double alpha = 4.0 * p * (1.0 - p);
+            double q = cos(acos(sqrt(alpha)) / 3.0) / sqrt(alpha);
+            return 2.0 * sqrt(q - 1.0);
+        }
+        default:
+            return dist_solve(DIST_T, p, (double)df, 0.0, t_quantile_cornish_fisher(p, df), 0.0, HUGE_VAL);
+    }
+}
+
+static inline double dist_quantile(int kind, double p, double a, double b) {
+    if (isnan(p)) return p;
+    switch (kind) {
+        case DIST_NORMAL:
+            return a + b * normal_quantile_c(p);
+        case DIST_T:
+            return t_quantile_c(p, (int)a);
+        default:
+            if (p <= 0.0) return 0.0;
+            if (p >= 1.0) return HUGE_VAL;
+            if (dist_cdf(kind, 0.0, a, b) >= p) return 0.0;
+            return dist_solve(kind, p, a, b, kind == DIST_CHISQ ? a : 1.0, 0.0, HUGE_VAL);
+    }
+}
+
+static double dist_eval(int kind, int fn, double x, double a, double b) {
+    switch (fn) {
+        case DIST_CDF: return dist_cdf(kind, x, a, b);
+        case DIST_DENSITY: return dist_density(kind, x, a, b);
+        default: return dist_quantile(kind, x, a, b);
+    }
+}
+
 CAMLprim value caml_stats_t_quantile(value vp, value vdf) {
     return caml_copy_double(t_quantile_c(Double_val(vp), Int_val(vdf)));
 }
+
+double caml_stats_t_quantile_unboxed(double p, intnat df) {
+    return t_quantile_c(p, (int)df);
+}
+
+CAMLprim value caml_stats_dist_byte(value v_kind, value v_fn, value v_x, value v_a, value v_b) {
+    return caml_copy_double(dist_eval(Int_val(v_kind), Int_val(v_fn),
+                                      Double_val(v_x), Double_val(v_a), Double_val(v_b)));
+}
+
+double caml_stats_dist(value v_kind, value v_fn, double x, double a, double b) {
+    return dist_eval(Int_val(v_kind), Int_val(v_fn), x, a, b);
+}
+
+/* Apply one distribution function to every element of the float64
+   Bigarray [v_x], writing into [v_out]. [v_params] is a float array
+   holding the two parameters. NaN inputs give NaN. */
+CAMLprim value caml_stats_dist_array(value v_kind, value v_fn, value v_params, value v_x, value v_out) {
+    CAMLparam5(v_kind, v_fn, v_params, v_x, v_out);
+    int kind = Int_val(v_kind);
+    int fn = Int_val(v_fn);
+    double a = Double_flat_field(v_params, 0);
+    double b = Double_flat_field(v_params, 1);
+    size_t n = (size_t)Caml_ba_array_val(v_x)->dim[0];
+    if ((size_t)Caml_ba_array_val(v_out)->dim[0] < n)
+        caml_invalid_argument("Stats.dist_array: output is shorter than input");
+    const double* x = (const double*)Caml_ba_data_val(v_x);
+    double* out = (double*)Caml_ba_data_val(v_out);
+
+    caml_enter_blocking_section();
+    if (kind == DIST_NORMAL && fn == DIST_DENSITY) {
+        /* Branch-free, so the loop vectorises with libmvec's exp. */
+        double scale = 1.0 / (b * sqrt(2.0 * M_PI));
+        for (size_t i = 0; i < n; i++) {
+            double z = (x[i] - a) / b;
+            out[i] = scale * exp(-0.5 * z * z);
+        }
+    } else if (fn == DIST_CDF) {
+        for (size_t i = 0; i < n; i++) out[i] = isnan(x[i]) ? x[i] : dist_cdf(kind, x[i], a, b);
+    } else if (fn == DIST_DENSITY) {
+        for (size_t i = 0; i < n; i++) out[i] = isnan(x[i]) ? x[i] : dist_density(kind, x[i], a, b);
+    } else {
+        for (size_t i = 0; i < n; i++) out[i] = dist_quantile(kind, x[i], a, b);
+    }
+    caml_leave_blocking_section();
+    CAMLreturn(Val_unit);
+}
+
+/* ===================================================================== */
+/* Compiled tree ensembles                                               */
+/* ===================================================================== */
+
+/* Node arrays built by Tree_ensemble.build. The children of a node are
+   stored contiguously from first_child; a node's test is on the feature in
+   feature[] (or always true/false), and score_kind[] is 0 for no score, 1 for
+   a numeric score and 2 for a score that counts as present but not numeric. */
+typedef struct {
+    const int32_t* feature;
+    const uint8_t* op;
+    const double* threshold;
+    const int32_t* first_child;
+    const int32_t* n_children;
+    const double* score;
+    const uint8_t* score_kind;
+    const int32_t* tree_root;
+    const int32_t* tree_group;
+    int n_trees;
+    const double* group_base;
+    const double* group_scale;
+    int n_groups;
+    int n_labels;
+} TreeEnsemble;
+
+/* One feature column: Float64 or Int64 values plus an optional Arrow
+   validity bitmap. */
+typedef struct {
+    const double* f64;
+    const int64_t* i64;
+    const uint8_t* validity;
+    size_t bit_offset;
+} TreeFeature;
+
+enum { TREE_OP_LT, TREE_OP_LE, TREE_OP_GT, TREE_OP_GE, TREE_OP_EQ, TREE_OP_NE };
+enum { TREE_FEATURE_TRUE = -1, TREE_FEATURE_FALSE = -2 };
+/* Matches Tree_ensemble.mode. */
+enum { TREE_MODE_SINGLE, TREE_MODE_MEAN, TREE_MODE_VOTE, TREE_MODE_BOOSTED };
+enum { TREE_ROW_OK, TREE_ROW_NA, TREE_ROW_TIE };
+
+#define TREE_BLOCK_ROWS 256
+#define TREE_MORSEL_ROWS 65536
+#define TREE_MAX_THREADS 16
+
+/* A missing value fails every comparison, as in the interpreted scorer. */
+static inline int tree_node_matches(const TreeEnsemble* e, const TreeFeature* feats, int32_t node, size_t row) {
+    int32_t f = e->feature[node];
+    if (f < 0) return f == TREE_FEATURE_TRUE;
+    const TreeFeature* col = &feats[f];
+    if (col->validity != NULL) {
+        size_t bit = col->bit_offset + row;
+        if (!(col->validity[bit >> 3] & (1u << (bit & 7)))) return 0;
+    }
+    double x = col->f64 != NULL ? col->f64[row] : (double)col->i64[row];
+    double t = e->threshold[node];
+    switch (e->op[node]) {
+        case TREE_OP_LT: return x < t;
+        case TREE_OP_LE: return x <= t;
+        case TREE_OP_GT: return x > t;
+        case TREE_OP_GE: return x >= t;
+        case TREE_OP_EQ: return x == t;
+        case TREE_OP_NE: return x != t;
+        default: return 0;
+    }
+}
+
+/* Follow the first matching child from [root] and return the deepest node
+   on the path that carries a score, or -1. */
+static inline int32_t tree_leaf(const TreeEnsemble* e, const TreeFeature* feats, int32_t root, size_t row) {
+    int32_t best = -1;
+    int32_t cur = root;
+    for (;;) {
+        if (e->score_kind[cur] != 0) best = cur;
+        int32_t first = e->first_child[cur];
+        int32_t n = e->n_children[cur];
+        int32_t next = -1;
+        for (int32_t k = 0; k < n; k++) {
+            if (tree_node_matches(e, feats, first + k, row)) {
+                next = first + k;
+                break;
+            }
+        }
+        if (next < 0) return best;
+        cur = next;
+    }
+}
+
+typedef struct {
+    const TreeEnsemble* e;
+    const TreeFeature* feats;
+    int mode;
+    size_t begin;
+    size_t end;
+    double* out;
+    uint8_t* status;
+    int failed;
+} TreeTask;
+
+/* Score rows [begin, end) a block at a time: every tree runs over the whole
+   block before the next one, so each tree's nodes stay in cache. */
+static void* tree_task_run(void* data) {
+    TreeTask* t = (TreeTask*)data;
+    const TreeEnsemble* e = t->e;
+    size_t acc_width = t->mode == TREE_MODE_VOTE ? (size_t)e->n_labels
+                     : t->mode == TREE_MODE_BOOSTED ? (size_t)e->n_groups : 1;
+    double* acc = malloc(TREE_BLOCK_ROWS * (acc_width > 0 ? acc_width : 1) * sizeof(double));
+    int32_t* count = malloc(TREE_BLOCK_ROWS * sizeof(int32_t));
+    if (acc == NULL || count == NULL) {
+        free(acc);
+        free(count);
+        t->failed = 1;
+        return NULL;
+    }
+
+    for (size_t b0 = t->begin; b0 < t->end; b0 += TREE_BLOCK_ROWS) {
+        size_t n = t->end - b0 < TREE_BLOCK_ROWS ? t->end - b0 : TREE_BLOCK_ROWS;
+        memset(acc, 0, n * acc_width * sizeof(double));
+        memset(count, 0, n * sizeof(int32_t));
+
+        for (int tr = 0; tr < e->n_trees; tr++) {
+            int32_t root = e->tree_root[tr];
+            int32_t g = e->tree_group[tr];
+            for (size_t r = 0; r < n; r++) {
+                int32_t leaf = tree_leaf(e, t->feats, root, b0 + r);
+                if (leaf < 0) continue;
+                int numeric = e->score_kind[leaf] == 1;
+                switch (t->mode) {
+                    case TREE_MODE_SINGLE:
+                        count[r] = leaf + 1;
+                        break;
+                    case TREE_MODE_MEAN:
+                        if (numeric) {
+                            acc[r] += e->score[leaf];
+                            count[r]++;
+                        }
+                        break;
+                    case TREE_MODE_VOTE:
+                        count[r]++;
+                        acc[r * acc_width + (size_t)e->score[leaf]] += 1.0;
+                        break;
+                    default:
+                        if (numeric) acc[r * acc_width + (size_t)g] += e->score[leaf];
+                        break;
+                }
+            }
+        }
+
+        for (size_t r = 0; r < n; r++) {
+            size_t row = b0 + r;
+            switch (t->mode) {
+                case TREE_MODE_SINGLE: {
+                    int32_t leaf = count[r] - 1;
+                    if (leaf < 0 || e->score_kind[leaf] != 1) {
+                        t->status[row] = TREE_ROW_NA;
+                    } else {
+                        t->out[row] = e->score[leaf];
+                        t->status[row] = TREE_ROW_OK;
+                    }
+                    break;
+                }
+                case TREE_MODE_MEAN:
+                    if (count[r] == 0) {
+                        t->status[row] = TREE_ROW_NA;
+                    } else {
+                        t->out[row] = acc[r] / (double)count[r];
+                        t->status[row] = TREE_ROW_OK;
+                    }
+                    break;
+                case TREE_MODE_VOTE: {
+                    if (count[r] == 0) {
+                        t->status[row] = TREE_ROW_NA;
+                        break;
+                    }
+                    const double* votes = acc + r * acc_width;
+                    size_t best = 0;
+                    int tie = 0;
+                    for (size_t k = 1; k < acc_width; k++) {
+                        if (votes[k] > votes[best]) {
+                            best = k;
+                            tie = 0;
+                        } else if (votes[k] == votes[best]) {
+                            tie = 1;
+                        }
+                    }
+                    t->out[row] = (double)best;
+                    t->status[row] = tie ? TREE_ROW_TIE : TREE_ROW_OK;
+                    break;
+                }
+                default:
+                    for (int g = 0; g < e->n_groups; g++) {
+                        t->out[row * acc_width + (size_t)g] =
+                            e->group_base[g] + e->group_scale[g] * acc[r * acc_width + (size_t)g];
+                    }
+                    t->status[row] = TREE_ROW_OK;
+                    break;
+            }
+        }
+    }
+    free(acc);
+    free(count);
+    return NULL;
+}
+
+static int tree_thread_count(size_t n_rows) {
+    long procs = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t n = n_rows / TREE_MORSEL_ROWS;
+    if (procs > 0 && n > (size_t)procs) n = (size_t)procs;
+    if (n > TREE_MAX_THREADS) n = TREE_MAX_THREADS;
+    return n < 1 ? 1 : (int)n;
+}
+
+static const int32_t* tree_int32_data(value v) { return (const int32_t*)Caml_ba_data_val(v); }
+static const double* tree_float_data(value v) { return (const double*)Caml_ba_data_val(v); }
+static const uint8_t* tree_byte_data(value v) { return (const uint8_t*)Caml_ba_data_val(v); }
+
+/* [v_ens] is a Tree_ensemble.t, [v_feats] a Tree_ensemble.feature array.
+   Fills [v_out] (rows x groups for boosted models, else one value per row)
+   and [v_status] (one TREE_ROW_* code per row). Rows are split across
+   threads outside the runtime lock. */
+CAMLprim value caml_tree_ensemble_predict(value v_ens, value v_feats, value v_mode, value v_out, value v_status) {
+    CAMLparam5(v_ens, v_feats, v_mode, v_out, v_status);
+    TreeEnsemble e;
+    e.feature = tree_int32_data(Field(v_ens, 0));
+    e.op = tree_byte_data(Field(v_ens, 1));
+    e.threshold = tree_float_data(Field(v_ens, 2));
+    e.first_child = tree_int32_data(Field(v_ens, 3));
+    e.n_children = tree_int32_data(Field(v_ens, 4));
+    e.score = tree_float_data(Field(v_ens, 5));
+    e.score_kind = tree_byte_data(Field(v_ens, 6));
+    e.tree_root = tree_int32_data(Field(v_ens, 7));
+    e.tree_group = tree_int32_data(Field(v_ens, 8));
+    e.n_trees = (int)Caml_ba_array_val(Field(v_ens, 7))->dim[0];
+    e.group_base = tree_float_data(Field(v_ens, 9));
+    e.group_scale = tree_float_data(Field(v_ens, 10));
+    e.n_groups = (int)Caml_ba_array_val(Field(v_ens, 9))->dim[0];
+    e.n_labels = Int_val(Field(v_ens, 11));
+    int mode = Int_val(v_mode);
+    size_t n_rows = (size_t)Caml_ba_array_val(v_status)->dim[0];
+
+    size_t n_feats = Wosize_val(v_feats);
+    TreeFeature* feats = calloc(n_feats > 0 ? n_feats : 1, sizeof(TreeFeature));
+    if (feats == NULL) caml_failwith("Failed to allocate tree ensemble features.");
+    for (size_t f = 0; f < n_feats; f++) {
+        value v_feat = Field(v_feats, f);
+        value v_view = Field(v_feat, 0);
+        value v_validity = Field(v_feat, 1);
+        if (Tag_val(v_view) == 0) feats[f].f64 = (const double*)Caml_ba_data_val(Field(v_view, 0));
+        else feats[f].i64 = (const int64_t*)Caml_ba_data_val(Field(v_view, 0));
+        if (Is_block(v_validity)) feats[f].validity = tree_byte_data(Field(v_validity, 0));
+        feats[f].bit_offset = (size_t)Long_val(Field(v_feat, 2));
+    }
+
+    int n_tasks = tree_thread_count(n_rows);
+    TreeTask* tasks = calloc((size_t)n_tasks, sizeof(TreeTask));
+    pthread_t* threads = calloc((size_t)n_tasks, sizeof(pthread_t));
+    int* started = calloc((size_t)n_tasks, sizeof(int));
+    if (tasks == NULL || threads == NULL || started == NULL) {
+        free(feats); free(tasks); free(threads); free(started);
+        caml_failwith("Failed to allocate tree ensemble tasks.");
+    }
+    size_t per_task = (n_rows + (size_t)n_tasks - 1) / (size_t)n_tasks;
+    for (int k = 0; k < n_tasks; k++) {
+        tasks[k].e = &e;
+        tasks[k].feats = feats;
+        tasks[k].mode = mode;
+        tasks[k].begin = (size_t)k * per_task < n_rows ? (size_t)k * per_task : n_rows;
+        tasks[k].end = tasks[k].begin + per_task < n_rows ? tasks[k].begin + per_task : n_rows;
+        tasks[k].out = (double*)Caml_ba_data_val(v_out);
+        tasks[k].status = (uint8_t*)Caml_ba_data_val(v_status);
+    }
+
+    caml_enter_blocking_section();
+    for (int k = 1; k < n_tasks; k++) {
+        started[k] = pthread_create(&threads[k], NULL, tree_task_run, &tasks[k]) == 0;
+        if (!started[k]) tree_task_run(&tasks[k]);
+    }
+    tree_task_run(&tasks[0]);
+    for (int k = 1; k < n_tasks; k++) {
+        if (started[k]) pthread_join(threads[k], NULL);
+    }
+    caml_leave_blocking_section();
+
+    int failed = 0;
+    for (int k = 0; k < n_tasks; k++) failed |= tasks[k].failed;
+    free(feats);
+    free(tasks);
+    free(threads);
+    free(started);
+    if (failed) caml_failwith("Failed to allocate tree ensemble scoring buffers.");
+    CAMLreturn(Val_unit);
+}
+
+/* ===================================================================== */
+/* Linear models                                                         */
+/* ===================================================================== */
+
+/* Weighted least squares for Arrow_owl_bridge.linreg_multi. The in-memory
+   path factors the column-major design matrix [sqrt(w) X | sqrt(w) y] with
+   Householder QR, one panel of LM_PANEL reflectors at a time, applying each
+   panel to the remaining columns in parallel. The streaming path never
+   builds the matrix: it accumulates the augmented cross product
+   [X y]' W [X y] over row blocks from the predictor columns and solves
+   the normal equations by Cholesky. */
+
+#define LM_PANEL 16
+#define LM_BLOCK_ROWS 256
+#define LM_MIN_PARALLEL_WORK 262144
+#define LM_MAX_THREADS 16
+
+static int lm_thread_count(size_t work, size_t max_tasks) {
+    long procs = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t n = work / LM_MIN_PARALLEL_WORK;
+    if (procs > 0 && n > (size_t)procs) n = (size_t)procs;
+    if (n > max_tasks) n = max_tasks;
+    if (n > LM_MAX_THREADS) n = LM_MAX_THREADS;
+    return n < 1 ? 1 : (int)n;
+}
+
+/* Run fn over tasks[0..n), the first on the calling thread. */
+static void lm_run_tasks(void* (*fn)(void*), void* tasks, size_t size, int n) {
+    pthread_t threads[LM_MAX_THREADS];
+    int started[LM_MAX_THREADS] = {0};
+    for (int k = 1; k < n; k++) {
+        void* task = (char*)tasks + (size_t)k * size;
+        started[k] = pthread_create(&threads[k], NULL, fn, task) == 0;
+        if (!started[k]) fn(task);
+    }
+    fn(tasks);
+    for (int k = 1; k < n; k++) {
+        if (started[k]) pthread_join(threads[k], NULL);
+    }
+}
+
+/* Reflector j is stored below the diagonal of column j with an implicit
+   leading 1; apply H_j = I - tau_j v v' to rows j..n of column c. */
+static inline void lm_apply_reflector(double* a, size_t n, size_t j, double tau, double* c) {
+    if (tau == 0.0) return;
+    const double* v = a + j * n;
+    double s = c[j];
+    for (size_t i = j + 1; i < n; i++) s += v[i] * c[i];
+    s *= tau;
+    c[j] -= s;
+    for (size_t i = j + 1; i < n; i++) c[i] -= s * v[i];
+}
+
+typedef struct {
+    double* a;
+    size_t n;
+    const double* tau;
+    size_t first;       /* reflectors first .. last-1 */
+    size_t last;
+    int backward;       /* apply last-1 down to first */
+    size_t col_begin;
+    size_t col_end;
+} LmApplyTask;
+
+static void* lm_apply_task_run(void* data) {
+    LmApplyTask* t = (LmApplyTask*)data;
+    for (size_t c = t->col_begin; c < t->col_end; c++) {
+        double* col = t->a + c * t->n;
+        if (t->backward) {
+            for (size_t r = t->last; r-- > t->first; ) lm_apply_reflector(t->a, t->n, r, t->tau[r], col);
+        } else {
+            for (size_t r = t->first; r < t->last; r++) lm_apply_reflector(t->a, t->n, r, t->tau[r], col);
+        }
+    }
+    return NULL;
+}
+
+/* Apply reflectors [first, last) to columns [col_begin, col_end), split
+   by columns across threads when the update is large enough. */
+static void lm_apply_panel(double* a, size_t n, const double* tau, size_t first, size_t last,
+                           int backward, size_t col_begin, size_t col_end) {
+    if (col_end <= col_begin || last <= first) return;
+    size_t n_cols = col_end - col_begin;
+    int n_tasks = lm_thread_count((n - first) * n_cols * (last - first), n_cols);
+    LmApplyTask tasks[LM_MAX_THREADS];
+    size_t per_task = (n_cols + (size_t)n_tasks - 1) / (size_t)n_tasks;
+    for (int k = 0; k < n_tasks; k++) {
+        size_t begin = col_begin + (size_t)k * per_task;
+        size_t end = begin + per_task;
+        tasks[k] = (LmApplyTask){ a, n, tau, first, last, backward,
+                                  begin < col_end ? begin : col_end, end < col_end ? end : col_end };
+    }
+    lm_run_tasks(lm_apply_task_run, tasks, sizeof(LmApplyTask), n_tasks);
+}
+
+/* Householder QR of the first p columns of the n x (p+1) column-major
+   matrix [a]; the last column is carried along so it ends up as Q'y.
+   Returns 0 when a diagonal of R is negligible relative to its column
+   norm, i.e. the design is rank deficient. */
+static int lm_qr_factor(double* a, size_t n, size_t p, double* tau) {
+    double* norms = malloc((p > 0 ? p : 1) * sizeof(double));
+    if (norms == NULL) return -1;
+    for (size_t j = 0; j < p; j++) {
+        double s = 0.0;
+        const double* col = a + j * n;
+        for (size_t i = 0; i < n; i++) s += col[i] * col[i];
+        norms[j] = sqrt(s);
+    }
+    int ok = 1;
+    for (size_t j0 = 0; j0 < p && ok; j0 += LM_PANEL) {
+        size_t j1 = j0 + LM_PANEL < p ? j0 + LM_PANEL : p;
+        for (size_t j = j0; j < j1; j++) {
+            double* col = a + j * n;
+            double alpha = col[j];
+            double xnorm = 0.0;
+            for (size_t i = j + 1; i < n; i++) xnorm += col[i] * col[i];
+            xnorm = sqrt(xnorm);
+            if (xnorm == 0.0) {
+                tau[j] = 0.0;
+            } else {
+                double beta = -copysign(hypot(alpha, xnorm), alpha);
+                tau[j] = (beta - alpha) / beta;
+                double scale = 1.0 / (alpha - beta);
+                for (size_t i = j + 1; i < n; i++) col[i] *= scale;
+                col[j] = beta;
+            }
+            if (!(fabs(col[j]) > 1.0e-7 * norms[j])) {
+                ok = 0;
+                break;
+            }
+            for (size_t c = j + 1; c < j1; c++) lm_apply_reflector(a, n, j, tau[j], a + c * n);
+        }
+        if (ok) lm_apply_panel(a, n, tau, j0, j1, 0, j1, p + 1);
+    }
+    free(norms);
+    return ok;
+}
+
+/* Overwrite the reflectors in the first p columns with the thin Q. */
+static void lm_qr_form_q(double* a, size_t n, size_t p, const double* tau) {
+    size_t n_panels = (p + LM_PANEL - 1) / LM_PANEL;
+    for (size_t k = n_panels; k-- > 0; ) {
+        size_t j0 = k * LM_PANEL;
+        size_t j1 = j0 + LM_PANEL < p ? j0 + LM_PANEL : p;
+        lm_apply_panel(a, n, tau, j0, j1, 1, j1, p);
+        for (size_t j = j1; j-- > j0; ) {
+            double* col = a + j * n;
+            for (size_t c = j + 1; c < j1; c++) lm_apply_reflector(a, n, j, tau[j], a + c * n);
+            for (size_t i = j + 1; i < n; i++) col[i] *= -tau[j];
+            col[j] = 1.0 - tau[j];
+            for (size_t i = 0; i < j; i++) col[i] = 0.0;
+        }
+    }
+}
+
+/* Invert the p x p upper triangle [r] (leading dimension ld) into the
+   dense [inv] (row-major, lower part zero) and return inv * inv'. */
+static void lm_r_inverse_gram(const double* r, size_t ld, size_t p, double* rinv, double* out) {
+    memset(rinv, 0, p * p * sizeof(double));
+    for (size_t j = p; j-- > 0; ) {
+        rinv[j * p + j] = 1.0 / r[j + j * ld];
+        for (size_t i = j; i-- > 0; ) {
+            double s = 0.0;
+            for (size_t k = i + 1; k <= j; k++) s += r[i + k * ld] * rinv[k * p + j];
+            rinv[i * p + j] = -s / r[i + i * ld];
+        }
+    }
+    for (size_t i = 0; i < p; i++) {
+        for (size_t j = i; j < p; j++) {
+            double s = 0.0;
+            for (size_t k = j; k < p; k++) s += rinv[i * p + k] * rinv[j * p + k];
+            out[i * p + j] = s;
+            out[j * p + i] = s;
+        }
+    }
+}
+
+/* [v_a] is the n x (p+1) column-major matrix [sqrt(w) X | sqrt(w) y]
+   (intercept column included) and is destroyed. Fills [v_beta] (p),
+   [v_inv] ((X'WX)^-1, p x p row-major) and [v_hat] (leverages, n).
+   Returns false when the design is singular. */
+CAMLprim value caml_stats_lm_qr(value v_a, value v_beta, value v_inv, value v_hat) {
+    CAMLparam4(v_a, v_beta, v_inv, v_hat);
+    double* a = (double*)Caml_ba_data_val(v_a);
+    double* beta = (double*)Caml_ba_data_val(v_beta);
+    double* inv = (double*)Caml_ba_data_val(v_inv);
+    double* hat = (double*)Caml_ba_data_val(v_hat);
+    size_t p = (size_t)Caml_ba_array_val(v_beta)->dim[0];
+    size_t n = (size_t)Caml_ba_array_val(v_hat)->dim[0];
+    if ((size_t)Caml_ba_array_val(v_a)->dim[0] < n * (p + 1) || (size_t)Caml_ba_array_val(v_inv)->dim[0] < p * p)
+        caml_invalid_argument("Stats.lm_qr: buffer sizes do not match");
+    if (n < p || p == 0) CAMLreturn(Val_false);
+
+    double* tau = malloc(p * sizeof(double));
+    double* rinv = malloc(p * p * sizeof(double));
+    double* r = malloc(p * p * sizeof(double));
+    if (tau == NULL || rinv == NULL || r == NULL) {
+        free(tau); free(rinv); free(r);
+        caml_failwith("Failed to allocate lm workspace.");
+    }
+
+    caml_enter_blocking_section();
+    int ok = lm_qr_factor(a, n, p, tau);
+    if (ok == 1) {
+        /* R and Q'y survive in the upper triangle and the last column */
+        for (size_t j = 0; j < p; j++)
+            for (size_t i = 0; i < p; i++) r[i + j * p] = i <= j ? a[i + j * n] : 0.0;
+        const double* qty = a + p * n;
+        for (size_t i = p; i-- > 0; ) {
+            double s = qty[i];
+            for (size_t k = i + 1; k < p; k++) s -= r[i + k * p] * beta[k];
+            beta[i] = s / r[i + i * p];
+        }
+        lm_r_inverse_gram(r, p, p, rinv, inv);
+        lm_qr_form_q(a, n, p, tau);
+        memset(hat, 0, n * sizeof(double));
+        for (size_t j = 0; j < p; j++) {
+            const double* q = a + j * n;
+            for (size_t i = 0; i < n; i++) hat[i] += q[i] * q[i];
+        }
+    }
+    caml_leave_blocking_section();
+
+    free(tau);
+    free(rinv);
+    free(r);
+    if (ok < 0) caml_failwith("Failed to allocate lm workspace.");
+    CAMLreturn(Val_bool(ok == 1));
+}
+
+typedef struct {
+    const double* const* cols;  /* predictor columns, then y */
+    const double* w;            /* NULL for unit weights */
+    size_t q;           /* columns of the augmented matrix, intercept first */
+    size_t begin;
+    size_t end;
+    double* acc;        /* q x q, upper triangle */
+    double* tile;
+} LmCrossTask;
+
+static inline double lm_col_value(const double* const* cols, size_t j, size_t row) {
+    return j == 0 ? 1.0 : cols[j - 1][row];
+}
+
+/* Sum the block rows' outer products a tile at a time, so each column is
+   read once per block. */
+static void* lm_cross_task_run(void* data) {
+    LmCrossTask* t = (LmCrossTask*)data;
+    size_t q = t->q;
+    for (size_t b0 = t->begin; b0 < t->end; b0 += LM_BLOCK_ROWS) {
+        size_t m = t->end - b0 < LM_BLOCK_ROWS ? t->end - b0 : LM_BLOCK_ROWS;
+        for (size_t j = 0; j < q; j++) {
+            double* dst = t->tile + j * LM_BLOCK_ROWS;
+            for (size_t r = 0; r < m; r++) {
+                double x = lm_col_value(t->cols, j, b0 + r);
+                dst[r] = t->w != NULL ? x * sqrt(t->w[b0 + r]) : x;
+            }
+        }
+        for (size_t i = 0; i < q; i++) {
+            const double* xi = t->tile + i * LM_BLOCK_ROWS;
+            for (size_t j = i; j < q; j++) {
+                const double* xj = t->tile + j * LM_BLOCK_ROWS;
+                double s = 0.0;
+                for (size_t r = 0; r < m; r++) s += xi[r] * xj[r];
+                t->acc[i * q + j] += s;
+            }
+        }
+    }
+    return NULL;
+}
+
+/* Data pointers of the float64 Bigarrays in [v_cols], each checked to
+   hold at least [n] rows, and of the weights [v_w] (NULL when empty). The
+   Bigarray data does not move, so the pointers stay valid outside the
+   runtime lock while the values are rooted. Returns NULL on a length
+   mismatch or allocation failure. */
+static const double** lm_column_pointers(value v_cols, value v_w, size_t n, const double** w) {
+    size_t k = Wosize_val(v_cols);
+    const double** cols = malloc((k > 0 ? k : 1) * sizeof(double*));
+    if (cols == NULL) return NULL;
+    for (size_t j = 0; j < k; j++) {
+        value col = Field(v_cols, j);
+        if ((size_t)Caml_ba_array_val(col)->dim[0] < n) { free(cols); return NULL; }
+        cols[j] = (const double*)Caml_ba_data_val(col);
+    }
+    size_t n_w = (size_t)Caml_ba_array_val(v_w)->dim[0];
+    if (n_w > 0 && n_w < n) { free(cols); return NULL; }
+    *w = n_w > 0 ? (const double*)Caml_ba_data_val(v_w) : NULL;
+    return cols;
+}
+
+/* Augmented cross product [1 X y]' W [1 X y] into the float array
+   [v_out] (q x q row-major, q = Array.length cols + 1). The columns are
+   float64 Bigarrays, typically Arrow buffers, read a row block at a time
+   on plain threads outside the runtime lock. */
+CAMLprim value caml_stats_lm_cross(value v_cols, value v_w, value v_out) {
+    CAMLparam3(v_cols, v_w, v_out);
+    size_t q = Wosize_val(v_cols) + 1;
+    size_t n = q > 1 ? (size_t)Caml_ba_array_val(Field(v_cols, q - 2))->dim[0] : 0;
+    const double* w = NULL;
+    const double** cols = lm_column_pointers(v_cols, v_w, n, &w);
+    if (cols == NULL) caml_invalid_argument("Stats.lm_cross: column lengths do not match");
+    int n_tasks = lm_thread_count(n * q * q, (n + LM_BLOCK_ROWS - 1) / LM_BLOCK_ROWS);
+    LmCrossTask tasks[LM_MAX_THREADS];
+    double* acc = calloc((size_t)n_tasks * q * q, sizeof(double));
+    double* tiles = malloc((size_t)n_tasks * q * LM_BLOCK_ROWS * sizeof(double));
+    if (acc == NULL || tiles == NULL) {
+        free(acc); free(tiles); free(cols);
+        caml_failwith("Failed to allocate lm workspace.");
+    }
+    size_t per_task = ((n + (size_t)n_tasks - 1) / (size_t)n_tasks + LM_BLOCK_ROWS - 1) / LM_BLOCK_ROWS * LM_BLOCK_ROWS;
+    for (int k = 0; k < n_tasks; k++) {
+        size_t begin = (size_t)k * per_task < n ? (size_t)k * per_task : n;
+        size_t end = begin + per_task < n ? begin + per_task : n;
+        tasks[k] = (LmCrossTask){ cols, w, q, begin, end, acc + (size_t)k * q * q,
+                                  tiles + (size_t)k * q * LM_BLOCK_ROWS };
+    }
+    caml_enter_blocking_section();
+    lm_run_tasks(lm_cross_task_run, tasks, sizeof(LmCrossTask), n_tasks);
+    caml_leave_blocking_section();
+    for (size_t i = 0; i < q; i++) {
+        for (size_t j = i; j < q; j++) {
+            double s = 0.0;
+            for (int k = 0; k < n_tasks; k++) s += acc[(size_t)k * q * q + i * q + j];
+            Store_double_flat_field(v_out, i * q + j, s);
+            Store_double_flat_field(v_out, j * q + i, s);
+        }
+    }
+    free(acc);
+    free(tiles);
+    free(cols);
+    CAMLreturn(Val_unit);
+}
+
+/* Cholesky solve of the normal equations from the augmented cross
+   product [v_g] (q x q, last row/column the response). Fills [v_beta]
+   (q-1) and [v_inv] ((X'WX)^-1) and returns false when a pivot is
+   negligible relative to its diagonal (a singular design). */
+CAMLprim value caml_stats_lm_cholesky(value v_g, value v_beta, value v_inv) {
+    CAMLparam3(v_g, v_beta, v_inv);
+    size_t p = Wosize_val(v_beta) / Double_wosize;
+    size_t q = p + 1;
+    double* l = calloc(q * q, sizeof(double));
+    double* linv = malloc(p * p * sizeof(double));
+    double* inv = malloc(p * p * sizeof(double));
+    if (l == NULL || linv == NULL || inv == NULL) {
+        free(l); free(linv); free(inv);
+        caml_failwith("Failed to allocate lm workspace.");
+    }
+    int ok = p > 0;
+    /* Factor the p x p block; the response row then holds L^-1 X'Wy. */
+    for (size_t j = 0; j < p && ok; j++) {
+        double d = Double_flat_field(v_g, j * q + j);
+        for (size_t k = 0; k < j; k++) d -= l[j * q + k] * l[j * q + k];
+        if (!(d > 1.0e-14 * Double_flat_field(v_g, j * q + j))) {
+            ok = 0;
+            break;
+        }
+        l[j * q + j] = sqrt(d);
+        for (size_t i = j + 1; i < q; i++) {
+            double s = Double_flat_field(v_g, i * q + j);
+            for (size_t k = 0; k < j; k++) s -= l[i * q + k] * l[j * q + k];
+            l[i * q + j] = s / l[j * q + j];
+        }
+    }
+    if (ok) {
+        /* X'WX = L L', so beta solves L' beta = z with z in the last row */
+        for (size_t i = p; i-- > 0; ) {
+            double s = l[p * q + i];
+            for (size_t k = i + 1; k < p; k++) s -= l[k * q + i] * Double_flat_field(v_beta, k);
+            Store_double_flat_field(v_beta, i, s / l[i * q + i]);
+        }
+        /* L' is upper triangular with leading dimension q when read
+           column-major, which is the layout lm_r_inverse_gram expects. */
+        lm_r_inverse_gram(l, q, p, linv, inv);
+        for (size_t k = 0; k < p * p; k++) Store_double_flat_field(v_inv, k, inv[k]);
+    }
+    free(l);
+    free(linv);
+    free(inv);
+    CAMLreturn(Val_bool(ok));
+}
+
+typedef struct {
+    const double* const* cols;
+    const double* w;
+    const double* inv;
+    size_t p;
+    size_t begin;
+    size_t end;
+    double* hat;
+    double* x;
+} LmLeverageTask;
+
+static void* lm_leverage_task_run(void* data) {
+    LmLeverageTask* t = (LmLeverageTask*)data;
+    size_t p = t->p;
+    double* x = t->x;
+    for (size_t row = t->begin; row < t->end; row++) {
+        for (size_t j = 0; j < p; j++) x[j] = lm_col_value(t->cols, j, row);
+        double h = 0.0;
+        for (size_t i = 0; i < p; i++) {
+            double s = 0.0;
+            for (size_t j = 0; j < p; j++) s += t->inv[i * p + j] * x[j];
+            h += x[i] * s;
+        }
+        t->hat[row] = t->w != NULL ? t->w[row] * h : h;
+    }
+    return NULL;
+}
+
+/* Leverages w_i x_i' (X'WX)^-1 x_i of every row into the Bigarray
+   [v_hat], from the predictor columns [v_cols] (intercept implicit) and
+   the row-major inverse [v_inv]. Runs outside the runtime lock, as in
+   caml_stats_lm_cross. */
+CAMLprim value caml_stats_lm_leverage(value v_cols, value v_w, value v_inv, value v_hat) {
+    CAMLparam4(v_cols, v_w, v_inv, v_hat);
+    size_t p = Wosize_val(v_cols) + 1;
+    size_t n = (size_t)Caml_ba_array_val(v_hat)->dim[0];
+    const double* w = NULL;
+    const double** cols = lm_column_pointers(v_cols, v_w, n, &w);
+    if (cols == NULL) caml_invalid_argument("Stats.lm_leverage: column lengths do not match");
+    int n_tasks = lm_thread_count(n * p * p, n);
+    double* inv = malloc(p * p * sizeof(double));
+    double* scratch = malloc((size_t)n_tasks * p * sizeof(double));
+    if (inv == NULL || scratch == NULL) {
+        free(inv); free(scratch); free(cols);
+        caml_failwith("Failed to allocate lm workspace.");
+    }
+    for (size_t k = 0; k < p * p; k++) inv[k] = Double_flat_field(v_inv, k);
+    double* hat = (double*)Caml_ba_data_val(v_hat);
+    LmLeverageTask tasks[LM_MAX_THREADS];
+    size_t per_task = (n + (size_t)n_tasks - 1) / (size_t)n_tasks;
+    for (int k = 0; k < n_tasks; k++) {
+        size_t begin = (size_t)k * per_task < n ? (size_t)k * per_task : n;
+        size_t end = begin + per_task < n ? begin + per_task : n;
+        tasks[k] = (LmLeverageTask){ cols, w, inv, p, begin, end, hat, scratch + (size_t)k * p };
+    }
+    caml_enter_blocking_section();
+    lm_run_tasks(lm_leverage_task_run, tasks, sizeof(LmLeverageTask), n_tasks);
+    caml_leave_blocking_section();
+    free(inv);
+    free(scratch);
+    free(cols);
+    CAMLreturn(Val_unit);
+}
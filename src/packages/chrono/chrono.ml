@@ -7,6 +7,24 @@ let micros_per_day = 86_400_000_000L
 
 external tz_offset : int64 -> string -> int64 = "caml_tz_offset"
 
+(** [tz_offsets micros zone out] writes the UTC offset of every element of
+    [micros] into [out], parsing the zone's TZif file at most once. *)
+external tz_offsets :
+  (int64, Bigarray.int64_elt, Bigarray.c_layout) Bigarray.Array1.t -> string ->
+  (int64, Bigarray.int64_elt, Bigarray.c_layout) Bigarray.Array1.t -> unit
+  = "caml_tz_offsets"
+
+(** UTC offsets in [timezone] of the datetimes in [arr], as one native
+    pass; elements that are not datetimes get 0. *)
+let tz_offsets_of_values timezone (arr : value array) =
+  let n = Array.length arr in
+  let micros = Bigarray.Array1.create Bigarray.int64 Bigarray.c_layout n in
+  Array.iteri (fun i v ->
+    micros.{i} <- (match v with VDatetime (m, _) -> m | _ -> 0L)) arr;
+  let out = Bigarray.Array1.create Bigarray.int64 Bigarray.c_layout n in
+  tz_offsets micros timezone out;
+  out
+
 let month_abbrevs = [|"Jan"; "Feb"; "Mar"; "Apr"; "May"; "Jun"; "Jul"; "Aug"; "Sep"; "Oct"; "Nov"; "Dec"|]
 let month_names = [|"January"; "February"; "March"; "April"; "May"; "June"; "July"; "August"; "September"; "October"; "November"; "December"|]
 let weekday_abbrevs = [|"Sun"; "Mon"; "Tue"; "Wed"; "Thu"; "Fri"; "Sat"|]
@@ -475,11 +493,11 @@ let date_diff_period left right =
   | VDatetime (t1, _), VDatetime (t2, _) -> VDuration (Int64.to_float (Int64.sub t1 t2) /. 1_000_000.0)
   | _ -> Error.type_error "Date subtraction expects Date or Datetime values."
 
-let format_datetime_value micros tz format =
+let format_datetime_value ?offset micros tz format =
   let adjusted_micros =
     match tz with
     | Some label ->
-        let offset_sec = tz_offset micros label in
+        let offset_sec = match offset with Some o -> o | None -> tz_offset micros label in
         Int64.add micros (Int64.mul offset_sec 1_000_000L)
     | None -> micros
   in
@@ -685,6 +703,13 @@ let rec force_tz_scalar ~timezone = function
       let offset_sec = tz_offset micros timezone in
       let offset_micros = Int64.mul offset_sec 1_000_000L in
       VDatetime (Int64.sub micros offset_micros, Some timezone)
+  | VVector arr when Array.exists (function VDatetime _ -> true | _ -> false) arr ->
+      let offsets = tz_offsets_of_values timezone arr in
+      VVector (Array.mapi (fun i v ->
+        match v with
+        | VDatetime (micros, _) ->
+            VDatetime (Int64.sub micros (Int64.mul offsets.{i} 1_000_000L), Some timezone)
+        | v -> force_tz_scalar ~timezone v) arr)
   | VVector arr -> VVector (Array.map (force_tz_scalar ~timezone) arr)
   | VNA _ -> (VNA NAGeneric)
   | _ ->
@@ -1554,6 +1579,24 @@ let register env =
     match args with
     | [VDate days; VString fmt] -> VString (format_datetime_value (Int64.mul (Int64.of_int days) micros_per_day) None fmt)
     | [VDatetime (micros, tz); VString fmt] -> VString (format_datetime_value micros tz fmt)
+    | [VVector arr; VString _]
+      when Array.exists (function VDate _ | VDatetime _ | VNA _ -> false | _ -> true) arr ->
+        Error.type_error "Function `format_datetime` expects (Date|Datetime, String)."
+    | [VVector arr; VString fmt] ->
+        (* Offsets of each zone in the vector are looked up in one pass *)
+        let zones = Array.fold_left (fun acc v ->
+          match v with
+          | VDatetime (_, Some zone) when not (List.mem zone acc) -> zone :: acc
+          | _ -> acc) [] arr
+        in
+        let offsets = List.map (fun zone -> (zone, tz_offsets_of_values zone arr)) zones in
+        VVector (Array.mapi (fun i v ->
+          match v with
+          | VDate days -> VString (format_datetime_value (Int64.mul (Int64.of_int days) micros_per_day) None fmt)
+          | VDatetime (micros, tz) ->
+              let offset = Option.map (fun zone -> (List.assoc zone offsets).{i}) tz in
+              VString (format_datetime_value ?offset micros tz fmt)
+          | _ -> VNA NAString) arr)
     | [_; _] -> Error.type_error "Function `format_datetime` expects (Date|Datetime, String)."
     | _ -> Error.arity_error_named "format_datetime" 2 (List.length args))) env in
   let env = Env.add "to_date" (make_builtin_named ~name:"to_date" ~variadic:true 1 (fun named_args _env ->
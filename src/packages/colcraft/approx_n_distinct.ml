@@ -0,0 +1,34 @@
+open Ast
+
+(*
+--# Approximate distinct count
+--#
+--# Estimates the number of distinct values in a vector or list with a
+--# HyperLogLog sketch, using a fixed 16 KB of state however many values
+--# there are. The standard error is about 0.8%; inputs of up to 4096
+--# values are counted exactly. NA counts as one value, as in `n_distinct`.
+--#
+--# Inside `summarize()` on a native DataFrame the sketches are built in
+--# Arrow, per group and per worker, and merged.
+--#
+--# @name approx_n_distinct
+--# @param x :: Vector | List The input values.
+--# @return :: Int The estimated number of distinct values.
+--# @example
+--#   summarize(group_by(trips, $month), $riders = approx_n_distinct($pickup_id))
+--# @family colcraft
+--# @seealso n_distinct, summarize
+--# @export
+*)
+let register env =
+  Env.add "approx_n_distinct"
+    (make_builtin ~name:"approx_n_distinct" 1 (fun args _env ->
+      match args with
+      | [VVector values] -> VInt (Sketch.count_distinct values)
+      | [VList values] ->
+          VInt (Sketch.count_distinct (Array.of_list (List.map snd values)))
+      | [VNA _] -> Error.type_error "Function `approx_n_distinct` expects a vector or list, got NA."
+      | [_] -> Error.type_error "Function `approx_n_distinct` expects a vector or list."
+      | _ -> Error.arity_error_named "approx_n_distinct" 1 (List.length args)
+    ))
+    env
@@ -1,18 +1,63 @@
 open Ast
 
+(** Order two cell values of the same column, NAs last in either direction. *)
+let compare_cells ascending a b =
+  let c =
+    match (a, b) with
+    | (VInt x, VInt y) -> compare x y
+    | (VFloat x, VFloat y) -> Float.compare x y
+    | (VString x, VString y) -> String.compare x y
+    | (VBool x, VBool y) -> compare x y
+    | (VDate x, VDate y) -> compare x y
+    | (VDatetime (x, _), VDatetime (y, _)) -> Int64.compare x y
+    | (VFactor (x, _, _), VFactor (y, _, _)) -> compare x y
+    | _ -> 0
+  in
+  match (a, b) with
+  | (VNA _, VNA _) -> 0
+  | (VNA _, _) -> 1
+  | (_, VNA _) -> -1
+  | _ -> if ascending then c else -c
+
+(** Sort by materialised column values, for tables the native sort kernel
+    does not handle. *)
+let sort_by_values (df : dataframe) (keys : (string * bool) list) : Arrow_table.t =
+  let nrows = Arrow_table.num_rows df.arrow_table in
+  let key_values = List.map (fun (col_name, ascending) ->
+    let col = match Arrow_table.get_column df.arrow_table col_name with
+      | Some c -> c | None -> Arrow_table.NAColumn nrows in
+    (Arrow_bridge.column_to_values col, ascending)
+  ) keys in
+  let indices = Array.init nrows (fun i -> i) in
+  let compare_rows i j =
+    let rec go = function
+      | [] -> 0
+      | (values, ascending) :: rest ->
+          let c = compare_cells ascending values.(i) values.(j) in
+          if c <> 0 then c else go rest
+    in
+    go key_values
+  in
+  Array.stable_sort compare_rows indices;
+  Arrow_compute.sort_by_indices df.arrow_table indices
+
 (*
 --# Arrange rows
 --#
---# Sorts a DataFrame by a column. Use "desc" for descending order.
+--# Sorts a DataFrame by one or more columns. Later columns break ties in
+--# earlier ones, and rows that tie on every column keep their order. Use
+--# "desc" as the last argument, after the columns, for descending order.
+--# Columns may also be given by name as strings. NA values sort last.
 --#
 --# @name arrange
 --# @param df :: DataFrame The input DataFrame.
---# @param col :: Symbol The column to sort by.
+--# @param ... :: Symbol The columns to sort by.
 --# @param direction :: String (Optional) "asc" (default) or "desc".
 --# @return :: DataFrame The sorted DataFrame.
 --# @example
 --#   arrange(mtcars, $mpg)
 --#   arrange(mtcars, $mpg, "desc")
+--#   arrange(mtcars, $cyl, $mpg)
 --# @family colcraft
 --# @seealso filter, group_by
 --# @export
@@ -21,75 +66,43 @@ let register env =
   Env.add "arrange"
     (make_builtin ~name:"arrange" ~variadic:true 2 (fun args _env ->
       match args with
-      | [VDataFrame df; col_val] | [VDataFrame df; col_val; VString "asc"] ->
-          (match Utils.extract_column_name col_val with
-           | None -> Error.type_error "Function `arrange` expects a $column reference."
-           | Some col_name ->
-              if not (Arrow_table.has_column df.arrow_table col_name) then
-                Error.make_error KeyError (Printf.sprintf "Column `%s` not found in DataFrame." col_name)
-              else
-                (match Arrow_compute.sort_by_column df.arrow_table col_name true with
-                 | Some new_table ->
-                   VDataFrame { arrow_table = new_table; group_keys = df.group_keys }
-                 | None ->
-                   let col = match Arrow_table.get_column df.arrow_table col_name with
-                     | Some c -> c | None -> Arrow_table.NAColumn (Arrow_table.num_rows df.arrow_table) in
-                   let col_values = Arrow_bridge.column_to_values col in
-                   let nrows = Arrow_table.num_rows df.arrow_table in
-                   let indices = Array.init nrows (fun i -> i) in
-                   let compare_values a b =
-                     match (a, b) with
-                     | (VInt x, VInt y) -> compare x y
-                     | (VFloat x, VFloat y) -> Float.compare x y
-                      | (VString x, VString y) -> String.compare x y
-                      | (VBool x, VBool y) -> compare x y
-                      | (VDate x, VDate y) -> compare x y
-                      | (VDatetime (x, _), VDatetime (y, _)) -> Int64.compare x y
-                      | (VFactor (x, _, _), VFactor (y, _, _)) -> compare x y
-                      | (VNA _, _) -> 1
-                      | (_, VNA _) -> -1
-                     | _ -> 0
-                   in
-                   Array.stable_sort (fun i j -> compare_values col_values.(i) col_values.(j)) indices;
-                   let new_table = Arrow_compute.sort_by_indices df.arrow_table indices in
-                   VDataFrame { arrow_table = new_table; group_keys = df.group_keys }))
-      | [VDataFrame df; col_val; VString "desc"] ->
-          (match Utils.extract_column_name col_val with
-           | None -> Error.type_error "Function `arrange` expects a $column reference."
-           | Some col_name ->
-              if not (Arrow_table.has_column df.arrow_table col_name) then
-                Error.make_error KeyError (Printf.sprintf "Column `%s` not found in DataFrame." col_name)
-              else
-                (match Arrow_compute.sort_by_column df.arrow_table col_name false with
-                 | Some new_table ->
-                   VDataFrame { arrow_table = new_table; group_keys = df.group_keys }
+      | VDataFrame df :: (_ :: _ as rest) ->
+          (* A trailing "asc"/"desc" after at least one key is the
+             direction; any other trailing string names a column, unless no
+             such column exists, in which case it is a misspelt direction. *)
+          let cols, direction =
+            match List.rev rest with
+            | VString ("asc" | "desc" as dir) :: (_ :: _ as rev_cols) -> (List.rev rev_cols, Some dir)
+            | VString dir :: _ :: _ when not (Arrow_table.has_column df.arrow_table dir) ->
+                (rest, Some dir)
+            | _ -> (rest, None)
+          in
+          (match direction with
+           | Some dir when dir <> "asc" && dir <> "desc" ->
+               Error.value_error (Printf.sprintf "Function `arrange` direction must be \"asc\" or \"desc\", got \"%s\"." dir)
+           | _ ->
+               let ascending = direction <> Some "desc" in
+               let names = List.map Utils.extract_column_name cols in
+               if List.mem None names then
+                 Error.type_error "Function `arrange` expects a $column reference."
+               else
+                 let names = List.filter_map Fun.id names in
+                 match List.find_opt (fun n -> not (Arrow_table.has_column df.arrow_table n)) names with
+                 | Some missing ->
+                     Error.make_error KeyError (Printf.sprintf "Column `%s` not found in DataFrame." missing)
                  | None ->
-                   let col = match Arrow_table.get_column df.arrow_table col_name with
-                     | Some c -> c | None -> Arrow_table.NAColumn (Arrow_table.num_rows df.arrow_table) in
-                   let col_values = Arrow_bridge.column_to_values col in
-                   let nrows = Arrow_table.num_rows df.arrow_table in
-                   let indices = Array.init nrows (fun i -> i) in
-                   let compare_values a b =
-                     match (a, b) with
-                     | (VInt x, VInt y) -> compare y x
-                     | (VFloat x, VFloat y) -> Float.compare y x
-                      | (VString x, VString y) -> String.compare y x
-                      | (VBool x, VBool y) -> compare y x
-                      | (VDate x, VDate y) -> compare y x
-                      | (VDatetime (x, _), VDatetime (y, _)) -> Int64.compare y x
-                      | (VFactor (x, _, _), VFactor (y, _, _)) -> compare y x
-                      | (VNA _, _) -> 1
-                      | (_, VNA _) -> -1
-                     | _ -> 0
-                   in
-                   Array.stable_sort (fun i j -> compare_values col_values.(i) col_values.(j)) indices;
-                   let new_table = Arrow_compute.sort_by_indices df.arrow_table indices in
-                   VDataFrame { arrow_table = new_table; group_keys = df.group_keys }))
-      | [VDataFrame _; _; VString dir] ->
-          Error.value_error (Printf.sprintf "Function `arrange` direction must be \"asc\" or \"desc\", got \"%s\"." dir)
-      | [VDataFrame _; _; _] ->
-          Error.type_error "Function `arrange` expects a $column reference."
-      | [_; _] | [_; _; _] -> Error.type_error "Function `arrange` expects a DataFrame as first argument."
-      | _ -> Error.make_error ArityError "Function `arrange` takes 2 or 3 arguments."
+                     let keys = List.map (fun n -> (n, ascending)) names in
+                     let sorted =
+                       match keys with
+                       | [(col_name, _)] -> Arrow_compute.sort_by_column df.arrow_table col_name ascending
+                       | _ -> Arrow_compute.sort_by_keys df.arrow_table keys
+                     in
+                     let new_table = match sorted with
+                       | Some t -> t
+                       | None -> sort_by_values df keys
+                     in
+                     VDataFrame { arrow_table = new_table; group_keys = df.group_keys })
+      | _ :: _ :: _ -> Error.type_error "Function `arrange` expects a DataFrame as first argument."
+      | _ -> Error.make_error ArityError "Function `arrange` takes a DataFrame and at least one column."
      ))
      env
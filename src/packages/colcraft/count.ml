@@ -15,15 +15,22 @@ let count_impl (named_args : (string option * value) list) _env =
         let arrow_table = Arrow_bridge.table_from_value_columns [(name_val, [|VInt n|])] 1 in
         VDataFrame { arrow_table; group_keys = [] }
       else
-        let grouped = Arrow_compute.group_by df.arrow_table keys in
-        let agg_table = match Arrow_compute.group_aggregate grouped "count" "" with
-          | Some t -> t
-          | None -> Arrow_table.empty
-        in
-        (* group_aggregate returns "n" as column name for "count". Rename if needed. *)
-        let final_table = 
+        let count_groups table =
+          let grouped = Arrow_compute.group_by table keys in
+          let agg_table = match Arrow_compute.group_aggregate grouped "count" "" with
+            | Some t -> t
+            | None -> Arrow_table.empty
+          in
+          (* group_aggregate returns "n" as column name for "count". Rename if needed. *)
           if name_val <> "n" then Arrow_compute.rename_columns agg_table [(name_val, "n")]
-          else agg_table in
+          else agg_table
+        in
+        (* Over the memory limit, count each spill partition separately. *)
+        let final_table =
+          match Arrow_compute.group_partitioned df.arrow_table keys (fun part -> Ok (count_groups part)) with
+          | Some (Ok t) -> t
+          | _ -> count_groups df.arrow_table
+        in
         VDataFrame { arrow_table = final_table; group_keys = [] }
   | _ :: _ -> Error.type_error "Function `count` expects a DataFrame as first argument."
   | [] -> Error.make_error ArityError "Function `count` requires a DataFrame."
@@ -0,0 +1,59 @@
+open Ast
+
+(*
+--# Most frequent values
+--#
+--# Finds the `k` most frequent values of a vector or list with a
+--# count-min sketch, in one pass and bounded memory. Counts are estimates
+--# that never undercount; with 2048 counters per row the overcount is at
+--# most 0.1% of the input length with high probability. Exact counts of
+--# the same values are given by `count()`.
+--#
+--# Inside `summarize()` each group gets its own table, stored as a nested
+--# DataFrame column that `unnest()` expands.
+--#
+--# @name heavy_hitters
+--# @param x :: Vector | List The input values.
+--# @param k :: Int = 10 How many values to return.
+--# @return :: DataFrame Columns `value` and `count`, most frequent first.
+--# @example
+--#   heavy_hitters(trips.pickup_zone, 5)
+--#   summarize(group_by(trips, $month), $top_zones = heavy_hitters($pickup_zone, k = 3))
+--# @family colcraft
+--# @seealso count, approx_n_distinct
+--# @export
+*)
+let heavy_hitters values k =
+  let capacity = max 64 (4 * k) in
+  let sk =
+    Sketch.build ~create:(fun () -> Sketch.Count_min.create ~capacity ())
+      ~add:Sketch.Count_min.add ~merge:Sketch.Count_min.merge values
+  in
+  let top = Array.of_list (Sketch.Count_min.top sk k) in
+  let n = Array.length top in
+  let arrow_table = Arrow_bridge.table_from_value_columns [
+    ("value", Array.map fst top);
+    ("count", Array.map (fun (_, c) -> VInt c) top);
+  ] n in
+  VDataFrame { arrow_table; group_keys = [] }
+
+let register env =
+  Env.add "heavy_hitters"
+    (make_builtin_named ~name:"heavy_hitters" ~variadic:true 1 (fun named_args _env ->
+      let run x k =
+        match x, k with
+        | _, VInt k when k <= 0 ->
+            Error.value_error "Function `heavy_hitters` expects `k` to be a positive Int."
+        | VVector arr, VInt k -> heavy_hitters arr k
+        | VList items, VInt k -> heavy_hitters (Array.of_list (List.map snd items)) k
+        | VNA _, _ -> Error.type_error "Function `heavy_hitters` expects a vector or list, got NA."
+        | (VVector _ | VList _), _ -> Error.type_error "Function `heavy_hitters` expects `k` to be an Int."
+        | _ -> Error.type_error "Function `heavy_hitters` expects a vector or list."
+      in
+      match Math_common.positional_args_without ["k"] named_args,
+            List.assoc_opt (Some "k") named_args with
+      | [x], None -> run x (VInt 10)
+      | [x], Some k | [x; k], None -> run x k
+      | _ -> Error.arity_error_named "heavy_hitters" 2 (List.length named_args)
+    ))
+    env
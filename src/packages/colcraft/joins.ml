@@ -171,6 +171,64 @@ let rows_to_dataframe ?(group_keys=[]) ?(column_types=(fun _ -> NAGeneric)) colu
     group_keys;
   }
 
+(* Native path: the C hash join returns row indices for both sides, and the
+   output is gathered with Arrow take so no row is ever boxed. [None] sends
+   the caller to the OCaml join (non-native tables, mixed or unsupported key
+   types, or a failed native step). *)
+let native_join kind (left : dataframe) (right : dataframe) by right_projection =
+  let arrow_kind =
+    match kind with
+    | Left -> Arrow_compute.Left_join
+    | Inner -> Arrow_compute.Inner_join
+    | Full -> Arrow_compute.Full_join
+    | Semi -> Arrow_compute.Semi_join
+    | Anti -> Arrow_compute.Anti_join
+  in
+  match Arrow_compute.hash_join_indices left.arrow_table right.arrow_table by arrow_kind with
+  | None -> None
+  | Some (left_idx, right_idx) ->
+      (match kind with
+       | Semi | Anti ->
+           Arrow_compute.take_with_nulls left.arrow_table left_idx
+           |> Option.map (fun table -> VDataFrame { arrow_table = table; group_keys = left.group_keys })
+       | Left | Inner | Full ->
+           let with_right =
+             match Arrow_compute.take_with_nulls left.arrow_table left_idx with
+             | None -> None
+             | Some taken when right_projection = [] -> Some taken
+             | Some taken ->
+                 let right_values = Arrow_compute.project right.arrow_table (List.map fst right_projection) in
+                 (match Arrow_compute.take_with_nulls right_values right_idx with
+                  | None -> None
+                  | Some right_taken ->
+                      Some (List.fold_left (fun acc (source_name, output_name) ->
+                        Arrow_table.add_column_from_table acc output_name right_taken source_name
+                      ) taken right_projection))
+           in
+           (* Unmatched right rows of a full join take their keys from the
+              right table: gather keys from [left keys; right keys] stacked. *)
+           let with_keys =
+             match kind, with_right with
+             | Full, Some joined ->
+                 let n_left = Arrow_table.num_rows left.arrow_table in
+                 let key_rows =
+                   Array.mapi (fun i l -> if l >= 0 then l else n_left + right_idx.(i)) left_idx
+                 in
+                 let keys =
+                   Arrow_table.concatenate
+                     [ Arrow_compute.project left.arrow_table by;
+                       Arrow_compute.project right.arrow_table by ]
+                 in
+                 Arrow_compute.take_with_nulls keys key_rows
+                 |> Option.map (fun key_table ->
+                      List.fold_left (fun acc name ->
+                        Arrow_table.add_column_from_table acc name key_table name
+                      ) joined by)
+             | _, joined -> joined
+           in
+           let group_keys = match kind with Full -> [] | _ -> left.group_keys in
+           Option.map (fun table -> VDataFrame { arrow_table = table; group_keys }) with_keys)
+
 let join_impl kind named_args _env =
   match positional_args named_args with
   | [VDataFrame left; VDataFrame right]
@@ -181,6 +239,9 @@ let join_impl kind named_args _env =
             let left_names = Arrow_table.column_names left.arrow_table in
             let right_names = Arrow_table.column_names right.arrow_table in
             let right_projection = right_projection left_names right_names by in
+            match native_join kind left right by right_projection with
+            | Some result -> result
+            | None ->
             let right_na_of name =
               match Arrow_table.get_column right.arrow_table name with
               | Some col -> Arrow_bridge.na_for_column_type col
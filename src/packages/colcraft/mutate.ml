@@ -33,6 +33,148 @@ let scalar_op_fn = function
   | Div ->  Some Arrow_compute.divide_scalar
   | _ -> None
 
+(** Result type of a fused subexpression under T's numeric rules: Int stays
+    Int under [+], [-], [*] and [abs]; division, sqrt, log, exp and pow give
+    Float; comparisons give Bool. *)
+type fused_type = FusedInt | FusedFloat | FusedBool
+
+let fused_binop = function
+  | Plus -> Some Arrow_ffi.Expr_add
+  | Minus -> Some Arrow_ffi.Expr_sub
+  | Mul -> Some Arrow_ffi.Expr_mul
+  | Div -> Some Arrow_ffi.Expr_div
+  | Lt -> Some Arrow_ffi.Expr_lt
+  | LtEq -> Some Arrow_ffi.Expr_le
+  | Gt -> Some Arrow_ffi.Expr_gt
+  | GtEq -> Some Arrow_ffi.Expr_ge
+  | Eq -> Some Arrow_ffi.Expr_eq
+  | NEq -> Some Arrow_ffi.Expr_ne
+  | _ -> None
+
+let fused_unary = function
+  | "sqrt" -> Some Arrow_ffi.Expr_sqrt
+  | "log" -> Some Arrow_ffi.Expr_log
+  | "exp" -> Some Arrow_ffi.Expr_exp
+  | "abs" -> Some Arrow_ffi.Expr_abs
+  | _ -> None
+
+(** Compile a mutate body into a postfix program for
+    [Arrow_compute.eval_expression], so the whole right-hand side runs as
+    one native kernel instead of one Arrow call and temporary column per
+    operator. Covers arithmetic, comparisons and sqrt/log/exp/abs/pow over
+    numeric literals and Float64 columns. The kernel computes in doubles,
+    so Int64 columns and integer literals beyond 2^53 are declined, as are
+    bare column references and Int-typed results; [vectorize_expr] keeps
+    integer arithmetic and comparisons exact for those.
+
+    @return [Some (columns, program)] or [None] when the body has any other
+            shape. *)
+let compile_fused_expr (table : Arrow_table.t) param body =
+  let columns = ref [] in
+  let column_index name =
+    match List.assoc_opt name !columns with
+    | Some i -> i
+    | None ->
+      let i = List.length !columns in
+      columns := (name, i) :: !columns;
+      i
+  in
+  let program = ref [] in
+  let emit op = program := op :: !program in
+  let numeric = function Some (FusedInt | FusedFloat) -> true | _ -> false in
+  let rec compile expr =
+    match is_col_ref param expr with
+    | Some name ->
+      (match Arrow_table.column_type table name with
+       | Some Arrow_table.ArrowFloat64 ->
+         emit (Arrow_ffi.Expr_column (column_index name)); Some FusedFloat
+       | _ -> None)
+    | None ->
+      match expr.node with
+      | Value (VInt i) when i >= -(1 lsl 53) && i <= 1 lsl 53 ->
+        emit (Arrow_ffi.Expr_const (float_of_int i)); Some FusedInt
+      | Value (VFloat f) -> emit (Arrow_ffi.Expr_const f); Some FusedFloat
+      | UnOp { op = Neg; operand } ->
+        let t = compile operand in
+        if numeric t then begin
+          emit (Arrow_ffi.Expr_const (-1.0));
+          emit Arrow_ffi.Expr_mul;
+          t
+        end else None
+      | BinOp { op; left; right } ->
+        (match fused_binop op with
+         | None -> None
+         | Some fop ->
+           let lt = compile left in
+           if not (numeric lt) then None
+           else
+             let rt = compile right in
+             if not (numeric rt) then None
+             else begin
+               emit fop;
+               match op with
+               | Plus | Minus | Mul when lt = Some FusedInt && rt = Some FusedInt -> Some FusedInt
+               | Plus | Minus | Mul | Div -> Some FusedFloat
+               | _ -> Some FusedBool
+             end)
+      | Call { fn = { node = Var "pow"; _ }; args = [ (None, base); (None, exponent) ] } ->
+        if numeric (compile base) && numeric (compile exponent) then begin
+          emit Arrow_ffi.Expr_pow;
+          Some FusedFloat
+        end else None
+      | Call { fn = { node = Var name; _ }; args = [ (None, arg) ] } ->
+        (match fused_unary name with
+         | None -> None
+         | Some fop ->
+           let t = compile arg in
+           if not (numeric t) then None
+           else begin
+             emit fop;
+             if name = "abs" then t else Some FusedFloat
+           end)
+      | _ -> None
+  in
+  match is_col_ref param body with
+  | Some _ -> None
+  | None ->
+    match compile body with
+    | Some (FusedFloat | FusedBool) ->
+      let names = Array.make (List.length !columns) "" in
+      List.iter (fun (name, i) -> names.(i) <- name) !columns;
+      Some (names, Array.of_list (List.rev !program))
+    | _ -> None
+
+(** Recognise [f($col)] (and [lag]/[lead] with an offset) for the window
+    functions computed by the chunk-aware native kernel. *)
+let window_call param body =
+  match body.node with
+  | Call { fn = { node = Var fn_name; _ }; args = (None, arg) :: rest } ->
+    let with_offset make =
+      match rest with
+      | [] -> Some (make 1)
+      | [(None, offset_expr)] ->
+        (match extract_scalar offset_expr with
+         | Some (IntScalar n) when n >= 0 -> Some (make n)
+         | _ -> None)
+      | _ -> None
+    in
+    let op =
+      match fn_name, rest with
+      | "lag", _ -> with_offset (fun n -> Arrow_compute.Lag n)
+      | "lead", _ -> with_offset (fun n -> Arrow_compute.Lead n)
+      | "cumsum", [] -> Some Arrow_compute.Cumsum
+      | "cummin", [] -> Some Arrow_compute.Cummin
+      | "cummax", [] -> Some Arrow_compute.Cummax
+      | "row_number", [] -> Some Arrow_compute.Row_number
+      | "min_rank", [] -> Some Arrow_compute.Min_rank
+      | "dense_rank", [] -> Some Arrow_compute.Dense_rank
+      | _ -> None
+    in
+    (match is_col_ref param arg, op with
+     | Some src_col, Some op -> Some (src_col, op)
+     | _ -> None)
+  | _ -> None
+
 let try_vectorize_mutate (table : Arrow_table.t) (fn : value)
     (col_name : string) : Arrow_table.t option =
   match fn with
@@ -55,7 +197,8 @@ let try_vectorize_mutate (table : Arrow_table.t) (fn : value)
     in
     (* Detect window function calls and lower them to Arrow native kernels.
        Patterns: dense_rank($col), row_number($col), min_rank($col),
-                 lag($col), lag($col, n), lead($col), lead($col, n). *)
+                 lag($col), lag($col, n), lead($col), lead($col, n),
+                 cumsum($col), cummin($col), cummax($col). *)
     let try_vectorize_window_call fn_name args =
       match fn_name, args with
       (* rank functions: single column arg *)
@@ -86,40 +229,12 @@ let try_vectorize_mutate (table : Arrow_table.t) (fn : value)
               Some (Arrow_compute.add_computed_column table col_name col_data)
             | None -> None)
          | None -> None)
-      (* lag/lead: column arg + optional offset *)
-      | "lag", [(None, arg)] ->
-        (match is_col_ref param arg with
-         | Some src_col ->
-           (match Arrow_compute.lag_column table src_col 1 with
-            | Some new_table ->
-              Some (Arrow_table.add_column_from_table table col_name new_table src_col)
-            | None -> None)
-         | None -> None)
-      | "lag", [(None, arg); (None, offset_expr)] ->
-        (match is_col_ref param arg, extract_scalar offset_expr with
-         | Some src_col, Some (IntScalar n) when n >= 0 ->
-           (match Arrow_compute.lag_column table src_col n with
-            | Some new_table ->
-              Some (Arrow_table.add_column_from_table table col_name new_table src_col)
-            | None -> None)
-         | _ -> None)
-      | "lead", [(None, arg)] ->
-        (match is_col_ref param arg with
-         | Some src_col ->
-           (match Arrow_compute.lead_column table src_col 1 with
-            | Some new_table ->
-              Some (Arrow_table.add_column_from_table table col_name new_table src_col)
-            | None -> None)
-         | None -> None)
-      | "lead", [(None, arg); (None, offset_expr)] ->
-        (match is_col_ref param arg, extract_scalar offset_expr with
-         | Some src_col, Some (IntScalar n) when n >= 0 ->
-           (match Arrow_compute.lead_column table src_col n with
-            | Some new_table ->
-              Some (Arrow_table.add_column_from_table table col_name new_table src_col)
-            | None -> None)
+      (* lag/lead and cumulative functions: chunk-aware window kernel *)
+      | _ ->
+        (match window_call param body with
+         | Some (src_col, (Arrow_compute.(Lag _ | Lead _ | Cumsum | Cummin | Cummax) as op)) ->
+           Arrow_compute.window_column table src_col op col_name
          | _ -> None)
-      | _ -> None
     in
     let rec vectorize_expr current_table expr =
       match is_col_ref param expr with
@@ -196,16 +311,25 @@ let try_vectorize_mutate (table : Arrow_table.t) (fn : value)
                  | None -> None))
         | _ -> None
     in
-    (* Try window function vectorization first, then arithmetic vectorization *)
+    (* Try window functions first, then a fused kernel for the whole
+       expression, then operator-by-operator arithmetic *)
     let window_result =
       match body.node with
       | Call { fn = { node = Var fn_name; _ }; args } ->
         try_vectorize_window_call fn_name args
       | _ -> None
     in
+    let fused_result () =
+      match compile_fused_expr table param body with
+      | Some (columns, program) -> Arrow_compute.eval_expression table columns program col_name
+      | None -> None
+    in
     (match window_result with
      | Some _ -> window_result
      | None ->
+       match fused_result () with
+       | Some _ as fused -> fused
+       | None ->
        match vectorize_expr table body with
        | Some (result_table, result_col) ->
          if result_col = col_name then Some result_table
@@ -237,6 +361,19 @@ let register ~eval_call ~eval_expr:(_eval_expr : Ast.value Ast.Env.t -> Ast.expr
         let nrows = Arrow_table.num_rows df.arrow_table in
         if df.group_keys <> [] then
           let grouped = Arrow_compute.group_by df.arrow_table df.group_keys in
+          (* Window functions of one column run natively across all groups *)
+          let native_window =
+            match fn with
+            | VLambda { params = [param]; body; _ } ->
+              (match window_call param body with
+               | Some (src_col, op) -> Arrow_compute.grouped_window grouped src_col op col_name
+               | None -> None)
+            | _ -> None
+          in
+          (match native_window with
+           | Some new_table ->
+             VDataFrame { arrow_table = new_table; group_keys = df.group_keys }
+           | None ->
           let groups = Arrow_compute.get_groups grouped in
           let new_col = Array.make nrows (VNA NAGeneric) in
           let had_error = ref None in
@@ -265,7 +402,7 @@ let register ~eval_call ~eval_expr:(_eval_expr : Ast.value Ast.Env.t -> Ast.expr
            | None ->
              let arrow_col = Arrow_bridge.values_to_column new_col in
              let new_table = Arrow_table.add_column df.arrow_table col_name arrow_col in
-             VDataFrame { arrow_table = new_table; group_keys = df.group_keys })
+             VDataFrame { arrow_table = new_table; group_keys = df.group_keys }))
         else (
           match try_vectorize_mutate df.arrow_table fn col_name with
           | Some new_table ->
@@ -319,8 +456,20 @@ let register ~eval_call ~eval_expr:(_eval_expr : Ast.value Ast.Env.t -> Ast.expr
             (Printf.sprintf "Function `mutate` vector length %d does not match DataFrame row count %d."
                (Array.length vec) nrows)
         else
-          let arrow_col = Arrow_bridge.values_to_column vec in
-          let new_table = Arrow_table.add_column df.arrow_table col_name arrow_col in
+          (* Numeric vectors go straight into Arrow buffers; everything
+             else is boxed into a column first. *)
+          let numeric =
+            match Arrow_column.numeric_of_values vec with
+            | Some (values, validity) ->
+                Arrow_column.add_numeric_column df.arrow_table col_name values validity
+            | None -> None
+          in
+          let new_table =
+            match numeric with
+            | Some table -> table
+            | None ->
+                Arrow_table.add_column df.arrow_table col_name (Arrow_bridge.values_to_column vec)
+          in
           VDataFrame { arrow_table = new_table; group_keys = df.group_keys }
       in
       match named_args with
@@ -1,6 +1,19 @@
 open Ast
 open Arrow_table
 
+(* Column of input row numbers in spill partitions (see Spill). *)
+let row_id_col = "__spill_row"
+
+(* Put rows pivoted per spill partition back in order of their first input
+   row and drop the row number column. *)
+let in_row_order (table : Arrow_table.t) : Arrow_table.t =
+  let row_ids = Arrow_table.get_int_column table row_id_col in
+  let order = Array.init (Array.length row_ids) (fun i -> i) in
+  Array.stable_sort (fun a b -> compare row_ids.(a) row_ids.(b)) order;
+  let ordered = Arrow_table.sort_by_indices table order in
+  Arrow_table.project ordered
+    (List.filter (fun c -> c <> row_id_col) (Arrow_table.column_names ordered))
+
 (*
 --# Pivot wider
 --#
@@ -43,11 +56,11 @@ let register env =
           if names_from = "" || values_from = "" then Error.make_error ValueError "Function `pivot_wider` requires `names_from` and `values_from` as $column references." else
 
           (* Validate that names_from exists and is a String column, and that values_from exists *)
-          let names_from_col = Arrow_table.get_column df.arrow_table names_from in
-          let values_from_col = Arrow_table.get_column df.arrow_table values_from in
+          let names_from_col = Arrow_table.column_type df.arrow_table names_from in
+          let values_from_col = Arrow_table.column_type df.arrow_table values_from in
           (match names_from_col with
           | None -> Error.make_error KeyError (Printf.sprintf "Function `pivot_wider` expects `names_from` to refer to an existing column, but \"%s\" was not found." names_from)
-          | Some (StringColumn _) ->
+          | Some ArrowString ->
           (match values_from_col with
           | None -> Error.make_error KeyError (Printf.sprintf "Function `pivot_wider` expects `values_from` to refer to an existing column, but \"%s\" was not found." values_from)
           | Some _ ->
@@ -63,6 +76,11 @@ let register env =
           let collisions = List.filter (fun n -> List.mem n id_cols) pvt_names in
           if collisions <> [] then Error.make_error ValueError (Printf.sprintf "Function `pivot_wider`: pivot column name(s) collide with existing columns: %s" (String.concat ", " collisions)) else
           
+          (* Pivot [df] to one row per distinct id, one column per pivot name;
+             the [carry] columns take the value of each row's first input row. *)
+          let pivot carry (df : dataframe) =
+          let pvt_names_col = Arrow_table.get_string_column df.arrow_table names_from in
+          let orig_nrows = Arrow_table.num_rows df.arrow_table in
           (* Find unique rows across id_cols using structured value keys to avoid collisions *)
           let get_row_key i =
              List.map (fun c ->
@@ -124,7 +142,7 @@ let register env =
                    if idx >= 0 && idx < Array.length a then a.(idx) else None))
              in
             (col_name, rep_col)
-          ) id_cols in
+          ) (id_cols @ carry) in
           
           (* Reconstruct values cols based on names_from values.
              Use precomputed sorted indices for deterministic first-match behaviour. *)
@@ -154,11 +172,23 @@ let register env =
            
            let new_columns = new_id_columns @ new_pivot_columns in
            let new_schema = List.map (fun (n, c) -> (n, Arrow_table.column_type_of c)) new_columns in
+           { schema = new_schema; columns = new_columns; nrows = new_nrows; native_handle = None } |> Arrow_table.materialize
+          in
+
+          (* Over the memory limit, rows are hash-partitioned by the id columns
+             so that each partition holds whole output rows; each one is pivoted
+             with the names of the whole input as it is read. *)
+          let table =
+            match Spill.map_partitions ~row_ids:true df.arrow_table id_cols
+                    (fun part -> pivot [row_id_col] { df with arrow_table = part }) with
+            | Some pivoted -> in_row_order (Arrow_table.concatenate pivoted)
+            | None -> pivot [] df
+          in
            let new_group_keys =
-             List.filter (fun key -> List.exists (fun (name, _) -> name = key) new_columns) df.group_keys
+             List.filter (fun key -> Arrow_table.has_column table key) df.group_keys
            in
           
-          VDataFrame { arrow_table = { schema = new_schema; columns = new_columns; nrows = new_nrows; native_handle = None } |> Arrow_table.materialize; group_keys = new_group_keys })
+          VDataFrame { arrow_table = table; group_keys = new_group_keys })
           | Some _ -> Error.type_error (Printf.sprintf "Function `pivot_wider` expects `names_from` to refer to a String column, but \"%s\" has a non-String type." names_from))
     ))
     env
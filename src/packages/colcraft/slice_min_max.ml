@@ -10,28 +10,39 @@ let slice_generic ~desc (named_args : (string option * value) list) _env =
       (match Utils.extract_column_name order_by_val with
        | None -> Error.type_error "slice_max/min expects `order_by = $column`."
        | Some col_name ->
+           (* The native sort kernel is stable and sorts NAs last. *)
+           match Arrow_compute.sort_indices df.arrow_table [(col_name, not desc)] with
+           | Some order ->
+               let k = max 0 (min n_limit (Array.length order)) in
+               let sub_table = Arrow_compute.take_rows df.arrow_table (Array.to_list (Array.sub order 0 k)) in
+               VDataFrame { df with arrow_table = sub_table }
+           | None ->
            match Arrow_table.get_column df.arrow_table col_name with
            | None -> Error.make_error KeyError (Printf.sprintf "Column `%s` not found." col_name)
            | Some col ->
                let values = Arrow_bridge.column_to_values col in
                let indexed = Array.mapi (fun i v -> (i, v)) values in
                
+               (* NAs go last in both directions and ties keep row order,
+                  matching the native kernel. *)
                let compare_v (_, v1) (_, v2) =
-                 let c = match v1, v2 with
-                   | VInt x, VInt y -> compare x y
-                   | VFloat x, VFloat y -> Float.compare x y
-                   | VInt x, VFloat y -> Float.compare (float_of_int x) y
-                   | VFloat x, VInt y -> Float.compare x (float_of_int y)
-                   | VString x, VString y -> String.compare x y
-                   | VNA _, VNA _ -> 0
-                   | VNA _, _ -> -1
-                   | _, VNA _ -> 1
-                   | _ -> 0
-                 in
-                 if desc then -c else c
+                 match v1, v2 with
+                 | VNA _, VNA _ -> 0
+                 | VNA _, _ -> 1
+                 | _, VNA _ -> -1
+                 | _ ->
+                   let c = match v1, v2 with
+                     | VInt x, VInt y -> compare x y
+                     | VFloat x, VFloat y -> Float.compare x y
+                     | VInt x, VFloat y -> Float.compare (float_of_int x) y
+                     | VFloat x, VInt y -> Float.compare x (float_of_int y)
+                     | VString x, VString y -> String.compare x y
+                     | _ -> 0
+                   in
+                   if desc then -c else c
                in
                
-               Array.sort compare_v indexed;
+               Array.stable_sort compare_v indexed;
                
                let top_n = ref [] in
                for i = 0 to min n_limit (Array.length indexed) - 1 do
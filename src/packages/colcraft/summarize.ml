@@ -19,7 +19,8 @@ let detect_vectorizable_agg (fn : value) : (string * string * bool) option =
               args = [(None, { node = DotAccess { target = { node = Var p; _ }; field }; _ })] }
         when p = param ->
         (match agg_name with
-         | "mean" | "sum" | "min" | "max" | "count" | "nrow" | "n_distinct" -> Some (agg_name, field, false)
+         | "mean" | "sum" | "min" | "max" | "count" | "nrow" | "n_distinct"
+         | "approx_n_distinct" -> Some (agg_name, field, false)
          | _ -> None)
      (* Pattern: agg(row.col, na_rm = true) *)
      | Call { fn = { node = Var agg_name; _ };
@@ -69,20 +70,32 @@ let can_vectorize_agg
     (col_name : string)
     (na_rm : bool) : bool =
   match agg_name with
-  | "n" | "n_distinct" -> true
+  | "n" | "n_distinct" | "approx_n_distinct" -> true
   | _ -> na_rm || not (column_has_nulls_cached table null_cache col_name)
 
 let finalize_vectorized_agg_value (agg_name : string) (value : value) : value =
   match agg_name, value with
-  | ("n" | "count" | "nrow" | "n_distinct"), VFloat f -> VInt (int_of_float f)
+  | ("n" | "count" | "nrow" | "n_distinct" | "approx_n_distinct"), VFloat f -> VInt (int_of_float f)
   | _ -> value
 
 let finalize_vectorized_agg_values (agg_name : string) (values : value array) : value array =
   match agg_name with
-  | "n" | "count" | "nrow" | "n_distinct" ->
+  | "n" | "count" | "nrow" | "n_distinct" | "approx_n_distinct" ->
       Array.map (finalize_vectorized_agg_value agg_name) values
   | _ -> values
 
+(** Grouped summarize of a table over the memory limit: [summarize_df] runs
+    once per spill partition, each holding whole groups, and the results are
+    concatenated. None when the table fits in memory. *)
+let summarize_partitioned summarize_df (df : dataframe) : value option =
+  match Arrow_compute.group_partitioned df.arrow_table df.group_keys (fun part ->
+    match summarize_df { arrow_table = part; group_keys = df.group_keys } with
+    | VDataFrame r -> Ok r.arrow_table
+    | v -> Error v) with
+  | Some (Ok arrow_table) -> Some (VDataFrame { arrow_table; group_keys = [] })
+  | Some (Error e) -> Some e
+  | None -> None
+
 let register ~eval_call ~eval_expr:(_eval_expr : Ast.value Ast.Env.t -> Ast.expr -> Ast.value) ~uses_nse:(_uses_nse : Ast.expr -> bool) ~desugar_nse_expr:(_desugar_nse_expr : Ast.expr -> Ast.expr) env =
   (* Helper: apply aggregation fn with arg if callable, otherwise use fn as a constant value *)
   let apply_aggregation env fn arg =
@@ -107,7 +120,7 @@ let register ~eval_call ~eval_expr:(_eval_expr : Ast.value Ast.Env.t -> Ast.expr
   --# @export
   *)
   Env.add "summarize"
-    (make_builtin_named ~name:"summarize" ~variadic:true 1 (fun named_args env ->
+    (make_builtin_named ~name:"summarize" ~variadic:true 1 (let rec summarize_fn named_args env =
       match named_args with
       | (_, VDataFrame df) :: rest_args ->
           (* Parse named args: summarize(df, $total = sum($amount), ...) *)
@@ -139,6 +152,7 @@ let register ~eval_call ~eval_expr:(_eval_expr : Ast.value Ast.Env.t -> Ast.expr
                         | "min"  -> Option.map (fun f -> VFloat f) (Arrow_compute.min_column df.arrow_table col_name)
                         | "max"  -> Option.map (fun f -> VFloat f) (Arrow_compute.max_column df.arrow_table col_name)
                         | "n_distinct" -> Option.map (fun i -> VInt i) (Arrow_compute.count_distinct_column df.arrow_table col_name)
+                        | "approx_n_distinct" -> Option.map (fun i -> VInt i) (Arrow_compute.approx_count_distinct_column df.arrow_table col_name)
                         | "n" | "count" | "nrow" -> Some (VInt (Arrow_table.num_rows df.arrow_table))
                         | _ -> None
                       in
@@ -160,6 +174,9 @@ let register ~eval_call ~eval_expr:(_eval_expr : Ast.value Ast.Env.t -> Ast.expr
                   let arrow_table = Arrow_bridge.table_from_value_columns value_columns 1 in
                   VDataFrame { arrow_table; group_keys = [] })
                else
+                 match summarize_partitioned (fun part -> summarize_fn ((None, VDataFrame part) :: rest_args) env) df with
+                 | Some result -> result
+                 | None ->
                  let grouped = Arrow_compute.group_by df.arrow_table df.group_keys in
                 let vectorized_pairs =
                   List.map (fun (name, fn) ->
@@ -170,6 +187,7 @@ let register ~eval_call ~eval_expr:(_eval_expr : Ast.value Ast.Env.t -> Ast.expr
                         match agg_name with
                         | "nrow" | "n" -> "count"
                         | "n_distinct" -> "count_distinct"
+                        | "approx_n_distinct" -> "approx_count_distinct"
                         | _ -> agg_name
                       in
                       Some (name, fn, agg_name, agg_name_eff, col_name)
@@ -248,6 +266,7 @@ let register ~eval_call ~eval_expr:(_eval_expr : Ast.value Ast.Env.t -> Ast.expr
                       let agg_name_eff = match agg_name with
                         | "nrow" | "n" -> "count"
                         | "n_distinct" -> "count_distinct"
+                        | "approx_n_distinct" -> "approx_count_distinct"
                         | _ -> agg_name
                       in
                       Some (name, agg_name, agg_name_eff, col_name)
@@ -289,6 +308,7 @@ let register ~eval_call ~eval_expr:(_eval_expr : Ast.value Ast.Env.t -> Ast.expr
                              let agg_name_eff = match agg_name with
                                | "nrow" | "n" -> "count"
                                | "n_distinct" -> "count_distinct"
+                               | "approx_n_distinct" -> "approx_count_distinct"
                                | _ -> agg_name
                              in
                              let result_table_opt = Arrow_compute.group_aggregate grouped agg_name_eff col_name in
@@ -356,5 +376,5 @@ let register ~eval_call ~eval_expr:(_eval_expr : Ast.value Ast.Env.t -> Ast.expr
                      let arrow_table = Arrow_bridge.table_from_value_columns all_columns n_groups in
                      VDataFrame { arrow_table; group_keys = [] })))
       | _ -> Error.type_error "Function `summarize` expects a DataFrame as first argument."
-    ))
+    in summarize_fn))
     env
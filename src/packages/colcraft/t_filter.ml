@@ -7,38 +7,39 @@ let is_na_predicate_error = function
 let plural_suffix count =
   if count = 1 then "" else "s"
 
-let emit_na_filter_warning na_indices =
-  match na_indices with
-  | [] -> ()
-  | _ ->
-      let indices = List.rev na_indices in
-      let count = List.length indices in
-      let capped_indices = Utils.list_take 50 indices in
-      let message =
-        Printf.sprintf
-          "filter() excluded %d row%s because the predicate evaluated to NA"
-          count
-          (plural_suffix count)
+let emit_na_warning count capped_indices =
+  if count > 0 then begin
+    let message =
+      Printf.sprintf
+        "filter() excluded %d row%s because the predicate evaluated to NA"
+        count
+        (plural_suffix count)
+    in
+    (* Emit structured diagnostic for the pipeline engine *)
+    Eval.emit_node_warning {
+      nw_kind = "NAExcluded";
+      nw_fn = "filter";
+      nw_na_count = count;
+      nw_na_indices = capped_indices;
+      nw_message = message;
+      nw_source = WarningOwn;
+    };
+    (* Optional interactive stderr reporting *)
+    if !Eval.show_warnings then
+      let rendered =
+        capped_indices |> List.map string_of_int |> String.concat ", "
       in
-      (* Emit structured diagnostic for the pipeline engine *)
-      Eval.emit_node_warning {
-        nw_kind = "NAExcluded";
-        nw_fn = "filter";
-        nw_na_count = count;
-        nw_na_indices = capped_indices;
-        nw_message = message;
-        nw_source = WarningOwn;
-      };
-      (* Optional interactive stderr reporting *)
-      if !Eval.show_warnings then
-        let rendered =
-          capped_indices |> List.map string_of_int |> String.concat ", "
-        in
-        Printf.eprintf
-          "Warning: %s at row%s %s\n%!"
-          message
-          (plural_suffix count)
-          rendered
+      Printf.eprintf
+        "Warning: %s at row%s %s\n%!"
+        message
+        (plural_suffix count)
+        rendered
+  end
+
+(** [na_indices] are 1-based row numbers, most recent first. *)
+let emit_na_filter_warning na_indices =
+  let indices = List.rev na_indices in
+  emit_na_warning (List.length indices) (Utils.list_take 50 indices)
 
 type vectorized_predicate = {
   keep : bool array;
@@ -74,12 +75,20 @@ let vectorized_compare table field scalar op_v =
       in
       Some { keep; na }
 
-(** Try to vectorize a filter predicate.
-    Detects simple patterns like \(row) row.col > scalar and uses
-    Arrow_compute.compare_column_scalar for zero-copy filtering.
-    Also handles AND/OR combinations of simple comparisons. *)
-let try_vectorize_filter (table : Arrow_table.t) (fn : value)
-    : vectorized_predicate option =
+(** Vectorisable predicate shapes: comparisons of a numeric column with a
+    number, equality of a string or factor column with a string, [is_na]
+    tests, and their [!] / [&&] / [||] combinations. *)
+type predicate =
+  | PCompare of string * Arrow_compute.comparison_op * float
+  | PEqualString of string * string
+  | PIsNA of string
+  | PNot of predicate
+  | PAnd of predicate * predicate
+  | POr of predicate * predicate
+
+(** Recognise a vectorisable predicate such as \(row) row.col > scalar.
+    Returns None for lambdas that must be evaluated row by row. *)
+let predicate_of_lambda (fn : value) : predicate option =
   match fn with
   | VLambda { params = [param]; body; _ } ->
     let extract_scalar = function
@@ -87,110 +96,185 @@ let try_vectorize_filter (table : Arrow_table.t) (fn : value)
       | VFloat f -> Some f
       | _ -> None
     in
+    let flip = function
+      | Arrow_compute.Gt -> Arrow_compute.Lt
+      | Arrow_compute.Lt -> Arrow_compute.Gt
+      | Arrow_compute.Ge -> Arrow_compute.Le
+      | Arrow_compute.Le -> Arrow_compute.Ge
+      | Arrow_compute.Eq -> Arrow_compute.Eq
+    in
     let try_cmp op left right =
-      let op_variant = match op with
-        | Gt -> Some Arrow_compute.Gt
-        | Lt -> Some Arrow_compute.Lt
-        | GtEq -> Some Arrow_compute.Ge
-        | LtEq -> Some Arrow_compute.Le
-        | Eq -> Some Arrow_compute.Eq
-        | _ -> None
+      let op_variant, negate = match op with
+        | Gt -> Some Arrow_compute.Gt, false
+        | Lt -> Some Arrow_compute.Lt, false
+        | GtEq -> Some Arrow_compute.Ge, false
+        | LtEq -> Some Arrow_compute.Le, false
+        | Eq -> Some Arrow_compute.Eq, false
+        (* a != b is !(a == b): both are NA exactly when a or b is NA *)
+        | NEq -> Some Arrow_compute.Eq, true
+        | _ -> None, false
       in
-      match op_variant with
-      | None -> None
-      | Some op_v ->
-        (* Pattern: row.field op scalar *)
-        (match left.node, right.node with
-         | DotAccess { target = { node = Var p; _ }; field }, Value scalar when p = param ->
-            (match extract_scalar scalar with
-             | Some sf -> vectorized_compare table field sf op_v
-             | None -> None)
-         (* Pattern: scalar op row.field → flip comparison *)
-         | Value scalar, DotAccess { target = { node = Var p; _ }; field } when p = param ->
-           let flipped_op = match op_v with
-             | Arrow_compute.Gt -> Arrow_compute.Lt
-             | Arrow_compute.Lt -> Arrow_compute.Gt
-             | Arrow_compute.Ge -> Arrow_compute.Le
-             | Arrow_compute.Le -> Arrow_compute.Ge
-             | Arrow_compute.Eq -> Arrow_compute.Eq
-            in
-            (match extract_scalar scalar with
-             | Some sf -> vectorized_compare table field sf flipped_op
-             | None -> None)
-         | _ -> None)
+      let cmp =
+        match op_variant with
+        | None -> None
+        | Some op_v ->
+          (match left.node, right.node with
+           (* Pattern: row.field == "level", in either order *)
+           | DotAccess { target = { node = Var p; _ }; field }, Value (VString s)
+           | Value (VString s), DotAccess { target = { node = Var p; _ }; field }
+             when p = param && op_v = Arrow_compute.Eq ->
+             Some (PEqualString (field, s))
+           (* Pattern: row.field op scalar *)
+           | DotAccess { target = { node = Var p; _ }; field }, Value scalar when p = param ->
+             Option.map (fun sf -> PCompare (field, op_v, sf)) (extract_scalar scalar)
+           (* Pattern: scalar op row.field → flip comparison *)
+           | Value scalar, DotAccess { target = { node = Var p; _ }; field } when p = param ->
+             Option.map (fun sf -> PCompare (field, flip op_v, sf)) (extract_scalar scalar)
+           | _ -> None)
+      in
+      if negate then Option.map (fun c -> PNot c) cmp else cmp
     in
-    (* Recursively try to vectorize an expression, handling AND/OR *)
-    let rec try_vectorize_expr expr =
+    let rec of_expr expr =
       match expr.node with
-      | UnOp { op = Not; operand } ->
-        (match try_vectorize_expr operand with
-         | Some { keep; na } ->
-           let n = min_array_len keep na in
-           Some {
-             keep = Array.init n (fun i -> (not keep.(i)) && not na.(i));
-             na = take_bool_array n na;
-           }
-          | None -> None)
+      | UnOp { op = Not; operand } -> Option.map (fun p -> PNot p) (of_expr operand)
       | Call { fn = { node = Var "is_na"; _ };
                args = [(None, { node = DotAccess { target = { node = Var p; _ }; field }; _ })] }
            when p = param ->
-        (match Arrow_compute.column_null_mask table field with
-         | Some keep -> Some { keep; na = Array.make (Array.length keep) false }
-         | None -> None)
-      | BinOp { op; left; right } ->
-        (match op with
-         | And ->
-             (* Pattern: predA && predB — intersect boolean masks *)
-             (match try_vectorize_expr left, try_vectorize_expr right with
-              | Some left_pred, Some right_pred ->
-                let n = min_array_len left_pred.keep right_pred.keep in
-                let left_keep = take_bool_array n left_pred.keep in
-                let right_keep = take_bool_array n right_pred.keep in
-                let left_na = take_bool_array n left_pred.na in
-                let right_na = take_bool_array n right_pred.na in
-                let should_evaluate_right =
-                  Array.init n (fun i -> left_keep.(i) || left_na.(i))
-                in
-                Some {
-                  keep = Array.init n (fun i -> left_keep.(i) && right_keep.(i));
-                  na =
-                    (* Matches interpreter short-circuit AND: left-side NA always
-                       propagates; right-side NA only propagates when the left
-                      side is not definitively false (so the right predicate
-                       would be evaluated). *)
-                    Array.init n (fun i ->
-                      left_na.(i)
-                      || (right_na.(i) && should_evaluate_right.(i)));
-                }
-             | _ -> None)
-          | Or ->
-            (* Pattern: predA || predB — union boolean masks *)
-            (match try_vectorize_expr left, try_vectorize_expr right with
-              | Some left_pred, Some right_pred ->
-                let n = min_array_len left_pred.keep right_pred.keep in
-                let left_keep = take_bool_array n left_pred.keep in
-                let right_keep = take_bool_array n right_pred.keep in
-                let left_na = take_bool_array n left_pred.na in
-                let right_na = take_bool_array n right_pred.na in
-                let left_false = false_mask left_keep left_na in
-                Some {
-                  keep =
-                    Array.init n (fun i ->
-                      left_keep.(i) || (left_false.(i) && right_keep.(i)));
-                  na =
-                    (* Matches interpreter short-circuit OR: left-side NA always
-                       propagates; right-side NA only propagates when the left
-                       side is false (so the right predicate would be evaluated). *)
-                    Array.init n (fun i ->
-                      left_na.(i) || (right_na.(i) && left_false.(i)));
-                }
-             | _ -> None)
-         | _ -> try_cmp op left right)
+        Some (PIsNA field)
+      | BinOp { op = And; left; right } ->
+        (match of_expr left, of_expr right with
+         | Some l, Some r -> Some (PAnd (l, r))
+         | _ -> None)
+      | BinOp { op = Or; left; right } ->
+        (match of_expr left, of_expr right with
+         | Some l, Some r -> Some (POr (l, r))
+         | _ -> None)
+      | BinOp { op; left; right } -> try_cmp op left right
       | _ -> None
     in
-    try_vectorize_expr body
+    of_expr body
   | _ -> None
 
+(** Evaluate a predicate into native keep/NA bitmaps. None when the table
+    is not native or a column is missing or unsupported. *)
+let rec native_mask_of_predicate table = function
+  | PCompare (field, op, scalar) -> Arrow_compute.mask_compare_scalar table field scalar op
+  | PEqualString (field, s) -> Arrow_compute.mask_equal_string table field s
+  | PIsNA field -> Arrow_compute.mask_is_na table field
+  | PNot p -> Option.bind (native_mask_of_predicate table p) Arrow_compute.mask_not
+  | PAnd (l, r) ->
+    (match native_mask_of_predicate table l, native_mask_of_predicate table r with
+     | Some l, Some r -> Arrow_compute.mask_and l r
+     | _ -> None)
+  | POr (l, r) ->
+    (match native_mask_of_predicate table l, native_mask_of_predicate table r with
+     | Some l, Some r -> Arrow_compute.mask_or l r
+     | _ -> None)
+
+(** Evaluate a predicate into OCaml keep/NA arrays, for tables without a
+    native handle. *)
+let rec arrays_of_predicate table = function
+  | PCompare (field, op, scalar) -> vectorized_compare table field scalar op
+  | PEqualString (field, s) ->
+    (* Factor levels are compared once; rows then test their index. *)
+    let na_of a = Array.map Option.is_none a in
+    (match Arrow_table.get_column table field with
+     | Some (Arrow_table.StringColumn a) ->
+       Some { keep = Array.map (fun v -> v = Some s) a; na = na_of a }
+     | Some (Arrow_table.DictionaryColumn (a, levels, _)) ->
+       let hit = Array.of_list (List.map (String.equal s) levels) in
+       let keep = Array.map (function
+         | Some i -> i >= 0 && i < Array.length hit && hit.(i)
+         | None -> false) a
+       in
+       Some { keep; na = na_of a }
+     | _ -> None)
+  | PIsNA field ->
+    (match Arrow_compute.column_null_mask table field with
+     | Some keep -> Some { keep; na = Array.make (Array.length keep) false }
+     | None -> None)
+  | PNot p ->
+    (match arrays_of_predicate table p with
+     | Some { keep; na } ->
+       let n = min_array_len keep na in
+       Some {
+         keep = Array.init n (fun i -> (not keep.(i)) && not na.(i));
+         na = take_bool_array n na;
+       }
+     | None -> None)
+  | PAnd (l, r) ->
+    (* Pattern: predA && predB — intersect boolean masks *)
+    (match arrays_of_predicate table l, arrays_of_predicate table r with
+     | Some left_pred, Some right_pred ->
+       let n = min_array_len left_pred.keep right_pred.keep in
+       let left_keep = take_bool_array n left_pred.keep in
+       let right_keep = take_bool_array n right_pred.keep in
+       let left_na = take_bool_array n left_pred.na in
+       let right_na = take_bool_array n right_pred.na in
+       let should_evaluate_right =
+         Array.init n (fun i -> left_keep.(i) || left_na.(i))
+       in
+       Some {
+         keep = Array.init n (fun i -> left_keep.(i) && right_keep.(i));
+         na =
+           (* Matches interpreter short-circuit AND: left-side NA always
+              propagates; right-side NA only propagates when the left
+              side is not definitively false (so the right predicate
+              would be evaluated). *)
+           Array.init n (fun i ->
+             left_na.(i)
+             || (right_na.(i) && should_evaluate_right.(i)));
+       }
+     | _ -> None)
+  | POr (l, r) ->
+    (* Pattern: predA || predB — union boolean masks *)
+    (match arrays_of_predicate table l, arrays_of_predicate table r with
+     | Some left_pred, Some right_pred ->
+       let n = min_array_len left_pred.keep right_pred.keep in
+       let left_keep = take_bool_array n left_pred.keep in
+       let right_keep = take_bool_array n right_pred.keep in
+       let left_na = take_bool_array n left_pred.na in
+       let right_na = take_bool_array n right_pred.na in
+       let left_false = false_mask left_keep left_na in
+       Some {
+         keep =
+           Array.init n (fun i ->
+             left_keep.(i) || (left_false.(i) && right_keep.(i)));
+         na =
+           (* Matches interpreter short-circuit OR: left-side NA always
+              propagates; right-side NA only propagates when the left
+              side is false (so the right predicate would be evaluated). *)
+           Array.init n (fun i ->
+             left_na.(i) || (right_na.(i) && left_false.(i)));
+       }
+     | _ -> None)
+
+(** Filter with a vectorised predicate: native bitmaps when the table is
+    native-backed, OCaml bool arrays otherwise. Emits the NA warning.
+    Returns None when the predicate cannot be vectorised for this table. *)
+let try_vectorized_filter (table : Arrow_table.t) (fn : value) : Arrow_table.t option =
+  match predicate_of_lambda fn with
+  | None -> None
+  | Some pred ->
+    if Arrow_table.is_native_backed table then
+      (* A native table whose predicate columns the mask kernels reject
+         (e.g. a string compared with a number) is evaluated row by row. *)
+      match native_mask_of_predicate table pred with
+      | None -> None
+      | Some mask ->
+        (match Arrow_compute.filter_by_mask table mask with
+         | Some filtered ->
+           let count, first_rows = Arrow_compute.mask_na_rows mask 50 in
+           emit_na_warning count first_rows;
+           Some filtered
+         | None -> None)
+    else
+      match arrays_of_predicate table pred with
+      | Some { keep; na } ->
+        emit_na_filter_warning (na_indices_of_mask na);
+        Some (Arrow_compute.filter table keep)
+      | None -> None
+
 let register ~eval_call ~eval_expr:(_eval_expr : Ast.value Ast.Env.t -> Ast.expr -> Ast.value) ~uses_nse:(_uses_nse : Ast.expr -> bool) ~desugar_nse_expr:(_desugar_nse_expr : Ast.expr -> Ast.expr) env =
   (*
   --# Filter rows
@@ -212,10 +296,8 @@ let register ~eval_call ~eval_expr:(_eval_expr : Ast.value Ast.Env.t -> Ast.expr
       match args with
       | [VDataFrame df; fn] ->
           (* Try vectorized path first for simple predicates *)
-          (match try_vectorize_filter df.arrow_table fn with
-           | Some { keep; na } ->
-             emit_na_filter_warning (na_indices_of_mask na);
-             let new_table = Arrow_compute.filter df.arrow_table keep in
+          (match try_vectorized_filter df.arrow_table fn with
+           | Some new_table ->
              VDataFrame { arrow_table = new_table; group_keys = df.group_keys }
            | None ->
              (* Fall back to row-by-row evaluation *)
@@ -83,9 +83,16 @@ let docs_loaded : unit Lazy.t =
         prerr_endline "Documentation: no docs.json found in any search path; proceeding without documentation."
   )
 
+(* Runs the registry's loader first, so the entries registered while
+   docs.json is read do not re-enter it mid-load. *)
 let ensure_docs_loaded () =
+  Tdoc_registry.ensure_loaded ();
   Lazy.force docs_loaded
 
+(** Load docs.json on the first documentation lookup instead of at startup. *)
+let install_docs_loader () =
+  Tdoc_registry.set_loader (fun () -> Lazy.force docs_loaded)
+
 let package_families = function
   | "core" -> ["core"; "boolean"; "repl"; "package_manager"; "tdoc"]
   | "strcraft" -> ["strcraft"; "string"]
@@ -136,9 +143,9 @@ let strcraft_package = {
 let stats_package = {
   name = "stats";
   description = "Statistical summaries and models";
-  functions = ["mean"; "sd"; "quantile"; "cor"; "lm"; "predict"; "summary"; "fit_stats"; "add_diagnostics"; "min"; "max"; "coef"; "conf_int"; 
+  functions = ["mean"; "sd"; "quantile"; "approx_quantile"; "cor"; "lm"; "predict"; "summary"; "fit_stats"; "add_diagnostics"; "min"; "max"; "coef"; "conf_int"; 
                "nobs"; "df_residual"; "sigma"; "dispersion"; "vcov"; "compare"; "residuals"; "add_diagnostics"; "score"; "deviance";
-               "pnorm"; "pt"; "pf"; "pchisq"; "qnorm"; "qt"; "qf"; "qchisq";
+               "pnorm"; "pt"; "pf"; "pchisq"; "dnorm"; "dchisq"; "qnorm"; "qt"; "qf"; "qchisq";
                "anova"; "wald_test"; "cut"; "poly"; "compare_native_vs_pmml_scores"];
 }
 
@@ -146,7 +153,7 @@ let colcraft_package = {
   name = "colcraft";
   description = "DataFrame manipulation verbs and window functions";
   functions = ["select"; "filter"; "mutate"; "arrange"; "group_by"; "ungroup"; "summarize";
-               "n"; "n_distinct";
+               "n"; "n_distinct"; "approx_n_distinct"; "heavy_hitters";
                "ntile"; "dense_rank"; "row_number"; "min_rank"; "cume_dist"; "percent_rank";
                "lag"; "lead"; "cumany"; "cumall"; "cummax"; "cummin"; "cummean"; "cumsum";
                "pivot_longer"; "pivot_wider"; "complete"; "fill"; "separate"; "unite"; "drop_na"; "replace_na"; "expand"; "crossing"; "nesting"; "to_factor"; "fct"; "fct_infreq"; "fct_reorder"; "fct_relevel"; "fct_rev"; "fct_recode"; "fct_collapse"; "fct_lump_n"; "fct_lump_min"; "fct_lump_prop"; "fct_other"; "fct_drop"; "fct_expand"; "fct_c"; "levels"; "ordered";
@@ -187,7 +194,7 @@ let chrono_package = {
 let dataframe_package = {
   name = "dataframe";
   description = "DataFrame creation and introspection";
-  functions = ["to_dataframe"; "read_csv"; "read_parquet"; "write_csv"; "colnames"; "nrow"; "ncol"; "clean_colnames"; "glimpse"; "pull"; "to_array"; "read_arrow"; "write_arrow"; "write_parquet"];
+  functions = ["to_dataframe"; "read_csv"; "read_parquet"; "lazy"; "collect"; "scan_parquet"; "scan_csv"; "write_csv"; "colnames"; "nrow"; "ncol"; "clean_colnames"; "glimpse"; "pull"; "to_array"; "read_arrow"; "write_arrow"; "write_parquet"; "memory_report"; "memory_pool"; "profile"; "write_profile"];
 }
 
 let pipeline_package = {
@@ -763,12 +770,15 @@ let init_env () =
   let env = T_dataframe.register env in
   let env = T_read_csv.register env in
   let env = T_read_parquet.register env in
+  let env = T_lazy.register env in
   let env = T_write_csv.register ~write_csv_fn:(fun ~sep table path -> Arrow_io.write_csv ~sep table path) env in
   let env = T_read_arrow.register env in
   let env = T_write_arrow.register env in
   let env = T_write_parquet.register env in
   let env = Colnames.register env in
   let env = Nrow.register env in
+  let env = Memory_report.register env in
+  let env = T_profile.register env in
   let env = Ncol.register env in
   let env = Glimpse.register env in
 (*
@@ -860,6 +870,8 @@ let init_env () =
   let env = Summarize.register ~eval_call:Eval.eval_call_immutable ~eval_expr:Eval.eval_expr_immutable ~uses_nse:Eval.uses_nse ~desugar_nse_expr:Eval.desugar_nse_expr env in
   let env = N.register env in
   let env = N_distinct.register env in
+  let env = Approx_n_distinct.register env in
+  let env = Heavy_hitters.register env in
   let env = Window_rank.register env in
   let env = Window_offset.register env in
   let env = Window_cumulative.register env in
@@ -918,6 +930,7 @@ let init_env () =
   let env = Mean.register env in
   let env = Sd.register env in
   let env = Quantile.register env in
+  let env = Approx_quantile.register env in
   let env = Cor.register env in
   let env = Lm.register env in
   let env = Predict.register env in
@@ -356,6 +356,7 @@ let rec pretty_print_value v =
       else
         base ^ "  ⚠ Warnings in nodes: " ^ String.concat ", " warning_nodes ^ "\n"
   | VDataFrame df -> pretty_print_dataframe df
+  | VLazyFrame lf -> !Ast.lazy_frame_plan_resolver lf ^ "\n"
   | VError err -> pretty_print_error err
   | VPipeline p -> pretty_print_pipeline p
   | VNodeResult { v; _ } -> pretty_print_value v
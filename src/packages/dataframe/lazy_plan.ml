@@ -0,0 +1,349 @@
+(* src/packages/dataframe/lazy_plan.ml *)
+(* Logical plans for lazy dataframes.                                       *)
+(* Verbs applied to a LazyFrame are recorded instead of run. At collect()  *)
+(* time the plan is optimised: leading numeric filters and the set of      *)
+(* columns the query actually reads are folded into one scan of the        *)
+(* source (row-group pruning for Parquet, a single native filter+project   *)
+(* pass for in-memory tables), consecutive mutates are merged into one     *)
+(* call so each expression runs as a single fused kernel over the scanned  *)
+(* columns, and the remaining verbs are replayed on the scanned table.     *)
+
+open Ast
+
+module StringSet = Set.Make (String)
+
+(** Verbs recorded on a lazy frame instead of being executed. *)
+let lazy_verbs =
+  ["filter"; "select"; "mutate"; "arrange"; "summarize"; "group_by"; "ungroup"; "rename"]
+
+(** Builtins that take a lazy frame as-is; every other builtin materialises
+    lazy arguments before it runs. *)
+let lazy_aware_builtins = ["lazy"; "collect"; "explain"; "type"]
+
+(** The scan a physical plan starts with. [columns = []] decodes every
+    column, otherwise the listed columns are decoded and kept in source
+    order; [predicates] are evaluated while scanning. *)
+type scan = {
+  source : lazy_source;
+  columns : string list;
+  predicates : Arrow_io.scan_predicate list;
+}
+
+type physical_plan = {
+  scan : scan;
+  steps : lazy_step list;
+}
+
+(* ===================================================================== *)
+(* Column requirements                                                   *)
+(* ===================================================================== *)
+
+(** What a step needs from its input: every column, or a known set. *)
+type requirement = All | Cols of StringSet.t
+
+let strip_dollar name =
+  if String.length name > 0 && name.[0] = '$' then
+    String.sub name 1 (String.length name - 1)
+  else name
+
+(** Columns a row lambda reads through its row parameter, or [None] when the
+    body uses the row in a way the planner cannot see through (passing it to
+    a function, nested lambdas, blocks, ...). [n(row)] is allowed since it
+    only counts rows. *)
+let lambda_columns (l : lambda) : StringSet.t option =
+  match l.params with
+  | [row] ->
+      let rec walk acc (e : expr) =
+        match acc with
+        | None -> None
+        | Some cols ->
+            (match e.node with
+             | DotAccess { target = { node = Var p; _ }; field } when p = row ->
+                 Some (StringSet.add field cols)
+             | ColumnRef field -> Some (StringSet.add field cols)
+             | Var p when p = row -> None
+             | Var _ | Value _ -> acc
+             | Call { fn = { node = Var "n"; _ }; args = [ (None, { node = Var p; _ }) ] }
+               when p = row -> acc
+             | Call { fn; args } ->
+                 List.fold_left (fun acc (_, a) -> walk acc a) (walk acc fn) args
+             | BinOp { left; right; _ } | BroadcastOp { left; right; _ } ->
+                 walk (walk acc left) right
+             | UnOp { operand; _ } -> walk acc operand
+             | DotAccess { target; _ } -> walk acc target
+             | IfElse { cond; then_; else_ } -> walk (walk (walk acc cond) then_) else_
+             | ListLit items -> List.fold_left (fun acc (_, a) -> walk acc a) acc items
+             | DictLit items -> List.fold_left (fun acc (_, a) -> walk acc a) acc items
+             | _ -> None)
+      in
+      walk (Some StringSet.empty) l.body
+  | _ -> None
+
+let value_columns ~strings_are_columns (v : value) : StringSet.t option =
+  match v with
+  | VSymbol _ -> Option.map StringSet.singleton (Utils.extract_column_name v)
+  | VString s when strings_are_columns -> Some (StringSet.singleton s)
+  | VLambda l -> lambda_columns l
+  | VInt _ | VFloat _ | VBool _ | VString _ | VNA _ | VVector _ -> Some StringSet.empty
+  | _ -> None
+
+let union_all (sets : StringSet.t option list) : StringSet.t option =
+  List.fold_left (fun acc s ->
+    match acc, s with
+    | Some a, Some b -> Some (StringSet.union a b)
+    | _ -> None
+  ) (Some StringSet.empty) sets
+
+(** Columns [step] needs from its input, given what later steps need from
+    its output. Unknown verbs and argument shapes fall back to [All]. *)
+let required_before (step : lazy_step) (after : requirement) : requirement =
+  let refs ~strings args =
+    union_all (List.map (fun (_, v) -> value_columns ~strings_are_columns:strings v) args)
+  in
+  let extend = function
+    | Some r -> (match after with Cols a -> Cols (StringSet.union a r) | All -> All)
+    | None -> All
+  in
+  match step.ls_verb with
+  | "select" ->
+      let plain =
+        List.for_all (fun (name, v) ->
+          name = None && (match v with VSymbol _ | VString _ -> true | _ -> false)
+        ) step.ls_args
+      in
+      (match plain, refs ~strings:true step.ls_args with
+       | true, Some cols -> Cols cols
+       | _ -> All)
+  | "filter" | "group_by" | "ungroup" -> extend (refs ~strings:false step.ls_args)
+  | "arrange" ->
+      let cols =
+        List.filter (fun (_, v) ->
+          match v with VString ("asc" | "desc") -> false | _ -> true
+        ) step.ls_args
+      in
+      extend (refs ~strings:true cols)
+  | "mutate" ->
+      (* Walk the assignments right to left so that a column defined earlier
+         in the same call is not requested from the input. *)
+      List.fold_right (fun (name, v) acc ->
+        match acc, name, value_columns ~strings_are_columns:false v with
+        | Cols a, Some n, Some r -> Cols (StringSet.union (StringSet.remove (strip_dollar n) a) r)
+        | _ -> All
+      ) step.ls_args after
+  | "summarize" ->
+      (match refs ~strings:false step.ls_args with
+       | Some r -> Cols r
+       | None -> All)
+  | _ -> All
+
+(* ===================================================================== *)
+(* Optimisation                                                          *)
+(* ===================================================================== *)
+
+let is_numeric_column (df : dataframe) (name : string) =
+  match Arrow_table.column_type df.arrow_table name with
+  | Some (Arrow_table.ArrowInt64 | Arrow_table.ArrowFloat64) -> true
+  | _ -> false
+
+(** The scan predicates of a filter step, when every conjunct is a numeric
+    comparison the scan can evaluate. *)
+let pushable_predicates (source : lazy_source) (step : lazy_step) =
+  match step.ls_verb, step.ls_args with
+  | "filter", [ (None, (VLambda _ as fn)) ] ->
+      (match Scan_args.predicates_of_fn "filter" fn with
+       | Ok preds ->
+           (match source with
+            | LazyTable df ->
+                if List.for_all (fun (p : Arrow_io.scan_predicate) -> is_numeric_column df p.column) preds
+                then Some preds else None
+            | LazyParquet _ | LazyCsv _ -> Some preds)
+       | Error _ -> None)
+  | _ -> None
+
+(** Pull pushable filters out of the leading run of filter/arrange steps.
+    Row-wise predicates commute with each other and with a stable sort, so
+    hoisting them into the scan does not change the result. *)
+let hoist_predicates (source : lazy_source) (steps : lazy_step list) =
+  let rec go preds kept = function
+    | step :: rest ->
+        (match pushable_predicates source step with
+         | Some p -> go (preds @ p) kept rest
+         | None when step.ls_verb = "arrange" -> go preds (step :: kept) rest
+         | None -> (preds, List.rev_append kept (step :: rest)))
+    | [] -> (preds, List.rev kept)
+  in
+  go [] [] steps
+
+(** Merge runs of [mutate] steps recorded in the same environment into one
+    step. mutate applies its assignments in order, so the merged call gives
+    the same result while the table is rebuilt once per run instead of once
+    per verb, and each assignment reaches mutate's fused expression kernel
+    with the scanned columns already in place. *)
+let merge_mutates (steps : lazy_step list) : lazy_step list =
+  let rec go acc = function
+    | a :: b :: rest
+      when a.ls_verb = "mutate" && b.ls_verb = "mutate" && a.ls_env == b.ls_env ->
+        go acc ({ a with ls_args = a.ls_args @ b.ls_args } :: rest)
+    | step :: rest -> go (step :: acc) rest
+    | [] -> List.rev acc
+  in
+  go [] steps
+
+(** Build the physical plan for a lazy frame. *)
+let optimize (lf : lazy_frame) : physical_plan =
+  let predicates, steps = hoist_predicates lf.lf_source lf.lf_steps in
+  let steps = merge_mutates steps in
+  let required = List.fold_right required_before steps All in
+  let columns =
+    match required, lf.lf_source with
+    | All, _ -> []
+    | Cols cols, LazyTable df ->
+        let cols = List.fold_left (fun acc k -> StringSet.add k acc) cols df.group_keys in
+        let names = Arrow_table.column_names df.arrow_table in
+        let kept = List.filter (fun c -> StringSet.mem c cols) names in
+        (* Projecting to every column (or to none, which would lose the row
+           count) buys nothing. *)
+        if kept = [] || List.length kept = List.length names then [] else kept
+    | Cols cols, (LazyParquet _ | LazyCsv _) -> StringSet.elements cols
+  in
+  { scan = { source = lf.lf_source; columns; predicates }; steps }
+
+(* ===================================================================== *)
+(* Execution                                                             *)
+(* ===================================================================== *)
+
+let run_scan (scan : scan) : value =
+  let { columns; predicates; _ } = scan in
+  match scan.source with
+  | LazyTable df when columns = [] && predicates = [] -> VDataFrame df
+  | LazyTable df ->
+      (match Arrow_io.apply_scan ~columns ~predicates df.arrow_table with
+       | Ok table ->
+           let group_keys = List.filter (Arrow_table.has_column table) df.group_keys in
+           VDataFrame { arrow_table = table; group_keys }
+       | Error msg -> Error.value_error msg)
+  | LazyParquet path ->
+      (match Arrow_io.read_parquet ~columns ~predicates ~file_order:true path with
+       | Ok table -> VDataFrame { arrow_table = table; group_keys = [] }
+       | Error msg -> Error.make_error FileError msg)
+  | LazyCsv path ->
+      (match Arrow_io.read_csv ~columns ~predicates ~file_order:true path with
+       | Ok table -> VDataFrame { arrow_table = table; group_keys = [] }
+       | Error msg -> Error.make_error FileError msg)
+
+let run_step (acc : value) (step : lazy_step) : value =
+  match acc with
+  | VError _ -> acc
+  | _ -> step.ls_fn.b_func ((None, acc) :: step.ls_args) (ref step.ls_env)
+
+(** Optimise and execute a lazy frame, returning the materialised result. *)
+let collect (lf : lazy_frame) : value =
+  let plan = optimize lf in
+  List.fold_left run_step (run_scan plan.scan) plan.steps
+
+(* ===================================================================== *)
+(* Evaluator hooks                                                       *)
+(* ===================================================================== *)
+
+(** Record a call to a lazy verb whose data argument is a lazy frame.
+    Returns [None] when the call should run eagerly. *)
+let record_step (b : builtin) (named_args : (string option * value) list) (env : value Env.t)
+    : value option =
+  match b.b_name, named_args with
+  | Some verb, (None, data) :: rest when List.mem verb lazy_verbs ->
+      (match Utils.unwrap_value data with
+       | VLazyFrame lf ->
+           let step = { ls_verb = verb; ls_fn = b; ls_args = rest; ls_env = env } in
+           Some (VLazyFrame { lf with lf_steps = lf.lf_steps @ [step] })
+       | _ -> None)
+  | _ -> None
+
+(** Materialise lazy frames passed to builtins that need a concrete table.
+    Returns the first execution error instead of the arguments. *)
+let materialize_args (name : string option) (named_args : (string option * value) list)
+    : ((string option * value) list, value) result =
+  let lazy_of v = match Utils.unwrap_value v with VLazyFrame lf -> Some lf | _ -> None in
+  let aware = match name with Some n -> List.mem n lazy_aware_builtins | None -> false in
+  if aware || not (List.exists (fun (_, v) -> lazy_of v <> None) named_args) then Ok named_args
+  else
+    let rec go acc = function
+      | [] -> Ok (List.rev acc)
+      | ((n, v) as arg) :: rest ->
+          (match lazy_of v with
+           | Some lf ->
+               (match collect lf with
+                | VError _ as e -> Error e
+                | v -> go ((n, v) :: acc) rest)
+           | None -> go (arg :: acc) rest)
+    in
+    go [] named_args
+
+(* ===================================================================== *)
+(* Explain                                                               *)
+(* ===================================================================== *)
+
+let op_to_string = function
+  | Arrow_compute.Eq -> "==" | Arrow_compute.Lt -> "<" | Arrow_compute.Gt -> ">"
+  | Arrow_compute.Le -> "<=" | Arrow_compute.Ge -> ">="
+
+let predicate_to_string (p : Arrow_io.scan_predicate) =
+  Printf.sprintf "$%s %s %g" p.column (op_to_string p.op) p.scalar
+
+let step_to_string (step : lazy_step) =
+  let arg_to_string (name, v) =
+    let shown =
+      match v with
+      | VLambda { body; _ } -> Utils.unparse_expr body
+      | VSymbol _ ->
+          (match Utils.extract_column_name v with
+           | Some c -> "$" ^ c
+           | None -> Utils.value_to_string v)
+      | _ -> Utils.value_to_string v
+    in
+    match name with
+    | Some n -> "$" ^ strip_dollar n ^ " = " ^ shown
+    | None -> shown
+  in
+  Printf.sprintf "%s(%s)" step.ls_verb (String.concat ", " (List.map arg_to_string step.ls_args))
+
+let source_to_string = function
+  | LazyTable df ->
+      Printf.sprintf "DataFrame(%d rows x %d cols)"
+        (Arrow_table.num_rows df.arrow_table) (Arrow_table.num_columns df.arrow_table)
+  | LazyParquet path -> Printf.sprintf "parquet(\"%s\")" path
+  | LazyCsv path -> Printf.sprintf "csv(\"%s\")" path
+
+(** The optimised plan, one line per operation starting with the scan. *)
+let plan_lines (plan : physical_plan) : string list =
+  let scan_line =
+    let parts =
+      (if plan.scan.columns = [] then []
+       else ["columns = [" ^ String.concat ", " plan.scan.columns ^ "]"])
+      @ (if plan.scan.predicates = [] then []
+         else ["filter = " ^ String.concat " && " (List.map predicate_to_string plan.scan.predicates)])
+    in
+    match parts with
+    | [] -> "scan " ^ source_to_string plan.scan.source
+    | _ -> Printf.sprintf "scan %s [%s]" (source_to_string plan.scan.source) (String.concat "; " parts)
+  in
+  scan_line :: List.map step_to_string plan.steps
+
+(** Fields describing a lazy frame for [explain()]: the recorded verbs and
+    the optimised plan that [collect()] will run. *)
+let explain_fields (lf : lazy_frame) : (string * value) list =
+  let plan = optimize lf in
+  let strings xs = VList (List.map (fun s -> (None, VString s)) xs) in
+  [
+    ("kind", VString "lazy_frame");
+    ("source", VString (source_to_string lf.lf_source));
+    ("steps", strings (List.map step_to_string lf.lf_steps));
+    ("plan", strings (plan_lines plan));
+    ("pushed_predicates", strings (List.map predicate_to_string plan.scan.predicates));
+    ("projected_columns", strings plan.scan.columns);
+  ]
+
+(** How a lazy frame prints: its recorded step count and the optimised
+    plan, without running the query. *)
+let plan_to_string (lf : lazy_frame) : string =
+  Printf.sprintf "LazyFrame(%d steps)\n%s" (List.length lf.lf_steps)
+    (String.concat "\n" (List.map (fun l -> "  " ^ l) (plan_lines (optimize lf))))
@@ -0,0 +1,79 @@
+open Ast
+
+(*
+--# Arrow memory report
+--#
+--# Returns one row per top-level statement that created native Arrow
+--# tables: how many tables it created, how many had been released when it
+--# finished, and the Arrow memory pool size at its start, peak and end.
+--# When a statement grew the pool by more than 64 MiB and left dead
+--# intermediate tables behind, a collection runs on exit so they are freed
+--# before the next statement runs.
+--#
+--# @name memory_report
+--# @return :: DataFrame Columns `statement`, `tables`, `released`,
+--#   `start_bytes`, `peak_bytes` and `end_bytes`.
+--# @example
+--#   memory_report()
+--# @family dataframe
+--# @seealso memory_pool
+--# @export
+*)
+let memory_report_table () =
+  let reports = Array.of_list (Arrow_table.arena_history ()) in
+  let ints f = Arrow_table.IntColumn (Array.map (fun r -> Some (f r)) reports) in
+  Arrow_table.create [
+    ("statement", Arrow_table.StringColumn
+                    (Array.map (fun (r : Arrow_table.arena_report) -> Some r.arena_label) reports));
+    ("tables", ints (fun r -> r.Arrow_table.handles_created));
+    ("released", ints (fun r -> r.Arrow_table.handles_released));
+    ("start_bytes", ints (fun r -> r.Arrow_table.start_bytes));
+    ("peak_bytes", ints (fun r -> r.Arrow_table.peak_bytes));
+    ("end_bytes", ints (fun r -> r.Arrow_table.end_bytes));
+  ] (Array.length reports)
+
+(*
+--# Arrow memory pool
+--#
+--# Describes the default Arrow memory pool. The backend is chosen by Arrow
+--# at startup and can be set with the `ARROW_DEFAULT_MEMORY_POOL`
+--# environment variable (`jemalloc`, `mimalloc` or `system`). It also
+--# reports the `TLANG_MEMORY_LIMIT` budget (NA when unset) and how many
+--# sorts and grouped operations spilled to `TLANG_SPILL_DIR` to stay
+--# under it.
+--#
+--# @name memory_pool
+--# @return :: Dict `backend`, `bytes_allocated`, `max_memory`,
+--#   `memory_limit` and `spills`.
+--# @example
+--#   memory_pool().backend
+--# @family dataframe
+--# @seealso memory_report
+--# @export
+*)
+let register env =
+  let env = Env.add "memory_report"
+    (make_builtin ~name:"memory_report" 0 (fun args _env ->
+      match args with
+      | [] -> VDataFrame { arrow_table = memory_report_table (); group_keys = [] }
+      | _ -> Error.arity_error_named "memory_report" 0 (List.length args)
+    ))
+    env
+  in
+  Env.add "memory_pool"
+    (make_builtin ~name:"memory_pool" 0 (fun args _env ->
+      match args with
+      | [] when not Arrow_ffi.arrow_available ->
+          Error.value_error "Function `memory_pool` requires native Arrow support."
+      | [] ->
+          let (backend, allocated, peak) = Arrow_ffi.arrow_memory_pool_stats () in
+          VDict [
+            ("backend", VString backend);
+            ("bytes_allocated", VInt allocated);
+            ("max_memory", VInt peak);
+            ("memory_limit", match !Spill.memory_limit with Some b -> VInt b | None -> VNA NAInt);
+            ("spills", VInt !Spill.spill_count);
+          ]
+      | _ -> Error.arity_error_named "memory_pool" 0 (List.length args)
+    ))
+    env
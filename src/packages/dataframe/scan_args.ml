@@ -0,0 +1,129 @@
+(* src/packages/dataframe/scan_args.ml *)
+(* Shared parsing of the `columns =` and `filter =` arguments accepted by  *)
+(* the file readers. `filter` is a row predicate that is pushed down into  *)
+(* the scan, so it is restricted to conjunctions of numeric comparisons.   *)
+
+open Ast
+
+(** Parse a `columns =` argument: a column symbol/string or a list of them.
+
+    @param fn_name The calling builtin, for error messages.
+    @param v The argument value.
+    @return [Ok names] or a TypeError value. *)
+let columns_of_value (fn_name : string) (v : value) : (string list, value) result =
+  let bad () =
+    Error (Error.type_error
+      (Printf.sprintf
+         "Function `%s` expects `columns` to be a column name or a List of column names." fn_name))
+  in
+  match v with
+  | VSymbol _ | VString _ ->
+      (match Utils.extract_column_name v with
+       | Some name -> Ok [name]
+       | None -> bad ())
+  | VList items ->
+      let rec collect acc = function
+        | [] -> Ok (List.rev acc)
+        | (_, item) :: rest ->
+            (match item with
+             | VSymbol _ | VString _ ->
+                 (match Utils.extract_column_name item with
+                  | Some name -> collect (name :: acc) rest
+                  | None -> bad ())
+             | _ -> bad ())
+      in
+      collect [] items
+  | _ -> bad ()
+
+(** Turn a row predicate such as [$fare > 10 && $trip_distance <= 30] into
+    pushed-down scan conjuncts. Both [row.col op number] and
+    [number op row.col] are accepted, and the number may be negative;
+    anything else is rejected so the reader never silently scans a
+    different predicate than the one given.
+
+    @param fn_name The calling builtin, for error messages.
+    @param fn The predicate (a one-parameter lambda after NSE desugaring).
+    @return [Ok predicates] or a TypeError value. *)
+let predicates_of_fn (fn_name : string) (fn : value) : (Arrow_io.scan_predicate list, value) result =
+  let unsupported () =
+    Error (Error.type_error
+      (Printf.sprintf
+         "Function `%s` `filter` must combine comparisons of a column with a number using `&&` (e.g. `$x > 10 && $y <= 3`)." fn_name))
+  in
+  match fn with
+  | VLambda { params = [param]; body; _ } ->
+      (* A number literal, possibly negated: [-5] parses as [Neg 5]. *)
+      let rec literal_of (e : expr) =
+        match e.node with
+        | Value (VInt i) -> Some (VInt i)
+        | Value (VFloat f) -> Some (VFloat f)
+        | UnOp { op = Neg; operand } ->
+            (match literal_of operand with
+             | Some (VInt i) -> Some (VInt (- i))
+             | Some (VFloat f) -> Some (VFloat (-. f))
+             | _ -> None)
+        | _ -> None
+      in
+      let predicate column op e =
+        match literal_of e with
+        | Some (VInt i) ->
+            Some [ { Arrow_io.column; op; scalar = float_of_int i; int_scalar = Some i } ]
+        | Some (VFloat f) -> Some [ { Arrow_io.column; op; scalar = f; int_scalar = None } ]
+        | _ -> None
+      in
+      let op_of = function
+        | Gt -> Some Arrow_compute.Gt
+        | Lt -> Some Arrow_compute.Lt
+        | GtEq -> Some Arrow_compute.Ge
+        | LtEq -> Some Arrow_compute.Le
+        | Eq -> Some Arrow_compute.Eq
+        | _ -> None
+      in
+      let flip = function
+        | Arrow_compute.Gt -> Arrow_compute.Lt
+        | Arrow_compute.Lt -> Arrow_compute.Gt
+        | Arrow_compute.Ge -> Arrow_compute.Le
+        | Arrow_compute.Le -> Arrow_compute.Ge
+        | Arrow_compute.Eq -> Arrow_compute.Eq
+      in
+      let rec conjuncts expr =
+        match expr.node with
+        | BinOp { op = And; left; right } ->
+            (match conjuncts left, conjuncts right with
+             | Some l, Some r -> Some (l @ r)
+             | _ -> None)
+        | BinOp { op; left; right } ->
+            (match op_of op, left.node, right.node with
+             | Some op, DotAccess { target = { node = Var p; _ }; field }, _ when p = param ->
+                 predicate field op right
+             | Some op, _, DotAccess { target = { node = Var p; _ }; field } when p = param ->
+                 predicate field (flip op) left
+             | _ -> None)
+        | _ -> None
+      in
+      (match conjuncts body with
+       | Some preds -> Ok preds
+       | None -> unsupported ())
+  | _ -> unsupported ()
+
+(** Extract the optional `columns =` and `filter =` named arguments.
+
+    @return [Ok (columns, predicates)], both empty when absent. *)
+let scan_options (fn_name : string) (named_args : (string option * value) list)
+    : (string list * Arrow_io.scan_predicate list, value) result =
+  let columns =
+    match List.assoc_opt (Some "columns") named_args with
+    | None -> Ok []
+    | Some v -> columns_of_value fn_name v
+  in
+  match columns with
+  | Error e -> Error e
+  | Ok columns ->
+      (match List.assoc_opt (Some "filter") named_args with
+       | None -> Ok (columns, [])
+       | Some fn ->
+           (match predicates_of_fn fn_name fn with
+            | Ok preds -> Ok (columns, preds)
+            | Error e -> Error e))
+
+let is_scan_arg = function Some "columns" | Some "filter" -> true | _ -> false
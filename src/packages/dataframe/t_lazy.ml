@@ -0,0 +1,113 @@
+open Ast
+
+let scan_source fn_name make_source args =
+  match args with
+  | [VString path] ->
+      if not (Arrow_io.is_url path) && not (Sys.file_exists path) then
+        Error.make_error FileError (Printf.sprintf "File Error: %s: No such file or directory." path)
+      else
+        VLazyFrame { lf_source = make_source path; lf_steps = [] }
+  | [VNA _] -> Error.type_error (Printf.sprintf "Function `%s` expects a String path, got NA." fn_name)
+  | [_] -> Error.type_error (Printf.sprintf "Function `%s` expects a String path." fn_name)
+  | _ -> Error.arity_error_named fn_name 1 (List.length args)
+
+let register env =
+  Ast.lazy_frame_collect_resolver := Lazy_plan.collect;
+  Ast.lazy_frame_plan_resolver := Lazy_plan.plan_to_string;
+(*
+--# Lazy DataFrame
+--#
+--# Turns a DataFrame into a LazyFrame. Verbs applied to a LazyFrame
+--# (`filter`, `select`, `mutate`, `arrange`, `summarize`, `group_by`,
+--# `ungroup`, `rename`) are recorded into a query plan instead of being run.
+--# The plan is optimised and executed by `collect()`, or implicitly when the
+--# LazyFrame is serialized or passed to any other function. Printing a
+--# LazyFrame shows its optimised plan without running it.
+--#
+--# @name lazy
+--# @param df :: DataFrame The data to query lazily.
+--# @return :: LazyFrame A lazy query over `df`.
+--# @example
+--#   lazy(mtcars) |> filter($mpg > 20) |> select($mpg, $hp) |> collect()
+--# @family to_dataframe
+--# @seealso collect, scan_parquet, explain
+--# @export
+*)
+  let env = Env.add "lazy"
+    (make_builtin ~name:"lazy" 1 (fun args _env ->
+      match args with
+      | [VDataFrame df] -> VLazyFrame { lf_source = LazyTable df; lf_steps = [] }
+      | [VLazyFrame _ as lf] -> lf
+      | [_] -> Error.type_error "Function `lazy` expects a DataFrame."
+      | _ -> Error.arity_error_named "lazy" 1 (List.length args)
+    ))
+    env
+  in
+(*
+--# Collect LazyFrame
+--#
+--# Optimises and runs a LazyFrame's query plan, returning a DataFrame.
+--# Leading numeric filters and the columns the query needs are pushed into
+--# a single scan of the source; the remaining verbs run on the result.
+--# DataFrames are returned unchanged.
+--#
+--# @name collect
+--# @param x :: LazyFrame | DataFrame The query to run.
+--# @return :: DataFrame The materialised result.
+--# @example
+--#   scan_parquet("trips.parquet") |> filter($fare > 10) |> collect()
+--# @family to_dataframe
+--# @seealso lazy, explain
+--# @export
+*)
+  let env = Env.add "collect"
+    (make_builtin ~name:"collect" 1 (fun args _env ->
+      match args with
+      | [VLazyFrame lf] -> Lazy_plan.collect lf
+      | [VDataFrame _ as df] -> df
+      | [_] -> Error.type_error "Function `collect` expects a LazyFrame or DataFrame."
+      | _ -> Error.arity_error_named "collect" 1 (List.length args)
+    ))
+    env
+  in
+(*
+--# Lazy Parquet Scan
+--#
+--# Starts a LazyFrame over a Parquet file without reading it. At `collect()`
+--# only the columns the query uses are decoded, and leading numeric filters
+--# skip row groups through their statistics.
+--#
+--# @name scan_parquet
+--# @param path :: String Path or URL to the Parquet file.
+--# @return :: LazyFrame A lazy query over the file.
+--# @example
+--#   scan_parquet("trips.parquet") |> filter($trip_distance > 10) |> select($fare_amount)
+--# @family to_dataframe
+--# @seealso read_parquet, scan_csv, collect
+--# @export
+*)
+  let env = Env.add "scan_parquet"
+    (make_builtin ~name:"scan_parquet" 1 (fun args _env ->
+      scan_source "scan_parquet" (fun path -> LazyParquet path) args))
+    env
+  in
+(*
+--# Lazy CSV Scan
+--#
+--# Starts a LazyFrame over a CSV file without reading it. At `collect()`
+--# leading numeric filters and the needed columns are applied as part of the
+--# native read.
+--#
+--# @name scan_csv
+--# @param path :: String Path or URL to the CSV file.
+--# @return :: LazyFrame A lazy query over the file.
+--# @example
+--#   scan_csv("data.csv") |> filter($score >= 50) |> collect()
+--# @family to_dataframe
+--# @seealso read_csv, scan_parquet, collect
+--# @export
+*)
+  Env.add "scan_csv"
+    (make_builtin ~name:"scan_csv" 1 (fun args _env ->
+      scan_source "scan_csv" (fun path -> LazyCsv path) args))
+    env
@@ -0,0 +1,121 @@
+open Ast
+
+(* Summary rows as frame columns; [nodes] adds a leading `node` column. *)
+let summary_columns ?nodes (rows : Profiler.summary list) =
+  let rows = Array.of_list rows in
+  let strings f = Arrow_table.StringColumn (Array.map (fun s -> Some (f s)) rows) in
+  let ints f = Arrow_table.IntColumn (Array.map (fun s -> Some (f s)) rows) in
+  let floats f = Arrow_table.FloatColumn (Array.map (fun s -> Some (f s)) rows) in
+  let node_column = match nodes with
+    | Some names -> [("node", Arrow_table.StringColumn (Array.map Option.some names))]
+    | None -> []
+  in
+  node_column @ [
+    ("category", strings (fun s -> s.Profiler.s_cat));
+    ("name", strings (fun s -> s.Profiler.s_name));
+    ("path", strings (fun s -> s.Profiler.s_path));
+    ("calls", ints (fun s -> s.Profiler.s_calls));
+    ("total_ms", floats (fun s -> s.Profiler.s_total_us /. 1000.0));
+    ("mean_ms", floats (fun s -> s.Profiler.s_total_us /. 1000.0 /. float_of_int s.Profiler.s_calls));
+    ("rows_in", ints (fun s -> s.Profiler.s_rows_in));
+    ("rows_out", ints (fun s -> s.Profiler.s_rows_out));
+    ("native_bytes", ints (fun s -> s.Profiler.s_native_bytes));
+    ("ocaml_bytes", ints (fun s -> s.Profiler.s_ocaml_bytes));
+  ]
+
+let frame columns nrows =
+  VDataFrame { arrow_table = Arrow_table.create columns nrows; group_keys = [] }
+
+(* Per-node summaries of a build log, stacked into one frame. Nodes built
+   without profiling have no trace and contribute no rows. *)
+let build_log_profile (bl : build_log) =
+  let per_node = List.filter_map (function
+    | VDict fields ->
+        (match List.assoc_opt "name" fields, List.assoc_opt "profile" fields with
+         | Some (VString name), Some (VString path) ->
+             (match Profiler.read_chrome_trace path with
+              | Ok evs -> Some (Ok (name, Profiler.summarize evs))
+              | Error msg -> Some (Error (path, msg)))
+         | _ -> None)
+    | _ -> None) bl.bl_nodes
+  in
+  match List.find_map (function Error e -> Some e | Ok _ -> None) per_node with
+  | Some (path, msg) ->
+      Error.make_error FileError (Printf.sprintf "Failed to read profile `%s`: %s" path msg)
+  | None ->
+      let rows = List.concat_map (function
+        | Ok (name, summary) -> List.map (fun s -> (name, s)) summary
+        | Error _ -> []) per_node in
+      let nodes = Array.of_list (List.map fst rows) in
+      frame (summary_columns ~nodes (List.map snd rows)) (Array.length nodes)
+
+(*
+--# Hot-path profile
+--#
+--# Summarises the calls recorded by the profiler, one row per function and
+--# execution path, slowest first. Profiling is enabled by setting
+--# `TLANG_PROFILE=1` before starting `t`; with `TLANG_PROFILE_OUT=<path>`
+--# the raw events are also written there as a Chrome trace on exit.
+--#
+--# `category` is `ffi` for native Arrow calls and `verb` for functions
+--# whose first argument is a DataFrame. `path` tells whether a verb stayed
+--# on the native Arrow path (`native`), fell back to OCaml (`fallback`),
+--# or ran on an OCaml-only table (`ocaml`). Verb times include the FFI
+--# calls they make.
+--#
+--# Given a BuildLog from a pipeline built with `TLANG_PROFILE=1`, returns
+--# the same summary for every T node, with a leading `node` column.
+--#
+--# @name profile
+--# @param log :: BuildLog (Optional) A build log to read node profiles from.
+--# @return :: DataFrame Columns `category`, `name`, `path`, `calls`,
+--#   `total_ms`, `mean_ms`, `rows_in`, `rows_out`, `native_bytes` and
+--#   `ocaml_bytes`.
+--# @example
+--#   profile()
+--#   profile(build_log(p))
+--# @family to_dataframe
+--# @seealso write_profile, memory_report
+--# @export
+*)
+let profile_fn args _env =
+  match args with
+  | [] ->
+      let summary = Profiler.summarize (Profiler.take_events ()) in
+      frame (summary_columns summary) (List.length summary)
+  | [VBuildLog bl] -> build_log_profile bl
+  | [_] -> Error.type_error "Function `profile` expects no argument or a BuildLog."
+  | _ -> Error.arity_error_named "profile" 1 (List.length args)
+
+(*
+--# Write a Chrome trace
+--#
+--# Writes the events recorded by the profiler to a JSON file in the
+--# Chrome trace format, viewable in chrome://tracing or Perfetto.
+--#
+--# @name write_profile
+--# @param path :: String The output file path.
+--# @return :: Null
+--# @example
+--#   write_profile("trace.json")
+--# @family to_dataframe
+--# @seealso profile
+--# @export
+*)
+let write_profile_fn args _env =
+  match args with
+  | [VString path] ->
+      (try
+         Profiler.write_chrome_trace path (Profiler.take_events ());
+         VNA NAGeneric
+       with Sys_error msg ->
+         Error.make_error FileError
+           (Printf.sprintf "Failed to write profile to `%s`: %s" path msg))
+  | [_] -> Error.type_error "Function `write_profile` expects a String path."
+  | _ -> Error.arity_error_named "write_profile" 1 (List.length args)
+
+let register env =
+  let env = Env.add "profile"
+    (make_builtin ~name:"profile" ~variadic:true 0 profile_fn) env in
+  Env.add "write_profile"
+    (make_builtin ~name:"write_profile" 1 write_profile_fn) env
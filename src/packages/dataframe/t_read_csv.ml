@@ -2,6 +2,79 @@ open Ast
 
 let is_sep_name = function Some "separator" | Some "sep" -> true | _ -> false
 
+let is_skip_name = function Some "skip_lines" | Some "skip_rows" -> true | _ -> false
+
+(** Arguments that only tune the native Arrow reader. *)
+let is_reader_arg = function
+  | Some ("threads" | "block_size" | "col_types") -> true
+  | _ -> false
+
+let column_type_of_name = function
+  | "int" -> Some Arrow_table.ArrowInt64
+  | "float" -> Some Arrow_table.ArrowFloat64
+  | "bool" -> Some Arrow_table.ArrowBoolean
+  | "string" -> Some Arrow_table.ArrowString
+  | "date" -> Some Arrow_table.ArrowDate
+  | "datetime" -> Some (Arrow_table.ArrowTimestamp (Some "UTC"))
+  | _ -> None
+
+(** Parse `col_types = [name: "Int", ...]` into declared column types. *)
+let column_types_of_value (v : value) : ((string * Arrow_table.arrow_type) list, value) result =
+  let bad () =
+    Error (Error.type_error
+      "Function `read_csv` expects `col_types` to be a named List of type names, e.g. `[fare: \"Float\", vendor: \"String\"]`.")
+  in
+  let entries =
+    match v with
+    | VDict pairs -> Some (List.map (fun (k, v) -> (Some k, v)) pairs)
+    | VList items -> Some items
+    | _ -> None
+  in
+  match entries with
+  | None -> bad ()
+  | Some entries ->
+      let rec collect acc = function
+        | [] -> Ok (List.rev acc)
+        | (Some name, VString ty) :: rest ->
+            (match column_type_of_name (String.lowercase_ascii ty) with
+             | Some t -> collect ((name, t) :: acc) rest
+             | None ->
+                 Error (Error.value_error
+                   (Printf.sprintf
+                      "Function `read_csv` does not know column type \"%s\" for `%s`; use \"Int\", \"Float\", \"Bool\", \"String\", \"Date\" or \"Datetime\"."
+                      ty name)))
+        | _ -> bad ()
+      in
+      collect [] entries
+
+(** Native reader settings from the named arguments, or [Ok None] when the
+    defaults apply. *)
+let reader_options ~sep ~skip_lines named_args : (Arrow_io.csv_options option, value) result =
+  let threads =
+    match List.assoc_opt (Some "threads") named_args with
+    | None -> Ok true
+    | Some (VBool b) -> Ok b
+    | Some _ -> Error (Error.type_error "Function `read_csv` expects `threads` to be a Bool.")
+  in
+  let block_size =
+    match List.assoc_opt (Some "block_size") named_args with
+    | None -> Ok None
+    | Some (VInt n) when n > 0 -> Ok (Some n)
+    | Some _ -> Error (Error.type_error "Function `read_csv` expects `block_size` to be a positive Int (bytes).")
+  in
+  let column_types =
+    match List.assoc_opt (Some "col_types") named_args with
+    | None -> Ok []
+    | Some v -> column_types_of_value v
+  in
+  match threads, block_size, column_types with
+  | Error e, _, _ | _, Error e, _ | _, _, Error e -> Error e
+  | Ok threads, Ok block_size, Ok column_types ->
+      let options =
+        { Arrow_io.threads; block_size; skip_rows = skip_lines; delimiter = sep; column_types }
+      in
+      if options = Arrow_io.default_csv_options then Ok None else Ok (Some options)
+
 (*
 --# Read CSV file
 --#
@@ -11,12 +84,19 @@ let is_sep_name = function Some "separator" | Some "sep" -> true | _ -> false
 --# @param path :: String Path or URL to the CSV file.
 --# @param separator :: String (Optional) Field separator (default ",").
 --# @param skip_header :: Bool (Optional) Skip proper header parsing? (default false).
---# @param skip_lines :: Int (Optional) Number of lines to skip at start.
+--# @param skip_lines :: Int (Optional) Number of lines to skip at start (alias `skip_rows`).
 --# @param clean_colnames :: Bool (Optional) Clean column names? (default false).
+--# @param columns :: List (Optional) Columns to keep.
+--# @param filter :: Expression (Optional) Row predicate applied during the read, e.g. `$x > 10 && $y <= 3`.
+--# @param col_types :: List (Optional) Column types by name ("Int", "Float", "Bool", "String", "Date", "Datetime"); other columns are inferred.
+--# @param threads :: Bool (Optional) Parse blocks on several cores (default true).
+--# @param block_size :: Int (Optional) Bytes per parsed block.
 --# @return :: DataFrame The loaded data.
 --# @example
 --#   df = read_csv("data.csv")
 --#   df = read_csv("data.csv", separator = ";")
+--#   df = read_csv("data.csv", columns = [$id, $score], filter = $score >= 50)
+--#   df = read_csv("trips.csv", col_types = [vendor_id: "String", fare_amount: "Float"])
 --# @family to_dataframe
 --# @seealso write_csv
 --# @export
@@ -147,12 +227,19 @@ let parse_csv_string ?(sep=',') ?(skip_header=false) ?(skip_lines=0) ?(clean_col
 --# @param path :: String Path or URL to the CSV file.
 --# @param separator :: String (Optional) Field separator (default ",").
 --# @param skip_header :: Bool (Optional) Skip proper header parsing? (default false).
---# @param skip_lines :: Int (Optional) Number of lines to skip at start.
+--# @param skip_lines :: Int (Optional) Number of lines to skip at start (alias `skip_rows`).
 --# @param clean_colnames :: Bool (Optional) Clean column names? (default false).
+--# @param columns :: List (Optional) Columns to keep.
+--# @param filter :: Expression (Optional) Row predicate applied during the read, e.g. `$x > 10 && $y <= 3`.
+--# @param col_types :: List (Optional) Column types by name ("Int", "Float", "Bool", "String", "Date", "Datetime"); other columns are inferred.
+--# @param threads :: Bool (Optional) Parse blocks on several cores (default true).
+--# @param block_size :: Int (Optional) Bytes per parsed block.
 --# @return :: DataFrame The loaded data.
 --# @example
 --#   df = read_csv("data.csv")
 --#   df = read_csv("data.csv", separator = ";")
+--#   df = read_csv("data.csv", columns = [$id, $score], filter = $score >= 50)
+--#   df = read_csv("trips.csv", col_types = [vendor_id: "String", fare_amount: "Float"])
 --# @family to_dataframe
 --# @seealso write_csv
 --# @export
@@ -181,7 +268,7 @@ let register env =
       ) named_args in
       let skip_lines = List.fold_left (fun acc (name, v) ->
         match name, v with
-        | Some "skip_lines", VInt n when n >= 0 -> n
+        | n, VInt k when is_skip_name n && k >= 0 -> k
         | _ -> acc
       ) 0 named_args in
       let do_clean = List.exists (fun (name, v) ->
@@ -190,18 +277,29 @@ let register env =
       (* Extract positional arguments *)
       let args = List.filter (fun (name, _) ->
         not (is_sep_name name) && name <> Some "skip_header"
-        && name <> Some "skip_lines" && name <> Some "clean_colnames"
+        && not (is_skip_name name) && name <> Some "clean_colnames"
+        && not (Scan_args.is_scan_arg name) && not (is_reader_arg name)
       ) named_args |> List.map snd in
-      (* Native Arrow CSV ingestion only matches the public read_csv defaults.
-         Non-default separators and line/header/name transformations still rely
-         on the richer OCaml parser below. *)
-      let use_native_default_path =
-        sep = ',' && not skip_header && skip_lines = 0 && not do_clean
-      in
       match args with
       | [VString path] ->
-          if use_native_default_path then
-            (match Arrow_io.read_csv path with
+          (match Scan_args.scan_options "read_csv" named_args, reader_options ~sep ~skip_lines named_args with
+          | Error e, _ | _, Error e -> e
+          | Ok (columns, predicates), Ok options ->
+          (* Native Arrow CSV ingestion matches the public read_csv defaults.
+             Non-default separators and skipped lines keep the richer OCaml
+             parser unless reader settings ask for the native reader, which
+             handles them itself; generated or cleaned header names always
+             use the OCaml parser. *)
+          let wants_reader = List.exists (fun (name, _) -> is_reader_arg name) named_args in
+          let use_native_path =
+            not skip_header && not do_clean
+            && ((sep = ',' && skip_lines = 0) || (wants_reader && Arrow_ffi.arrow_available))
+          in
+          if wants_reader && not use_native_path then
+            Error.value_error
+              "Function `read_csv` `col_types`, `threads` and `block_size` need the native Arrow reader and cannot be combined with `skip_header` or `clean_colnames`."
+          else if use_native_path then
+            (match Arrow_io.read_csv ?options ~columns ~predicates path with
             | Ok table -> VDataFrame { arrow_table = table; group_keys = [] }
             | Error msg -> Error.make_error FileError msg)
           else
@@ -224,9 +322,15 @@ let register env =
                 else
                   read_content_from_path path
               in
-              parse_csv_string ~sep ~skip_header ~skip_lines ~clean_colnames:do_clean content
+              match parse_csv_string ~sep ~skip_header ~skip_lines ~clean_colnames:do_clean content with
+              | VDataFrame df when columns <> [] || predicates <> [] ->
+                  (match Arrow_io.apply_scan ~columns ~predicates df.arrow_table with
+                  | Ok table -> VDataFrame { df with arrow_table = table }
+                  | Error msg ->
+                      Error.make_error FileError (Printf.sprintf "CSV read failed: %s: %s" path msg))
+              | result -> result
             with
-            | e -> Error.make_error FileError (Printexc.to_string e))
+            | e -> Error.make_error FileError (Printexc.to_string e)))
       | [VNA _] -> Error.type_error "Function `read_csv` expects a String path, got NA."
       | [_] -> Error.type_error "Function `read_csv` expects a String path."
       | _ -> Error.make_error ArityError "Function `read_csv` takes exactly 1 positional argument (path)."
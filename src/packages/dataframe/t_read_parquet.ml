@@ -7,21 +7,32 @@ open Ast
 --#
 --# @name read_parquet
 --# @param path :: String Path or URL to the Parquet file.
+--# @param columns :: List (Optional) Columns to read; other columns are never decoded.
+--# @param filter :: Expression (Optional) Row predicate pushed into the scan, e.g. `$x > 10 && $y <= 3`.
+--#   Row groups whose statistics exclude the predicate are skipped.
 --# @return :: DataFrame The loaded data.
 --# @example
 --#   df = read_parquet("data.parquet")
+--#   df = read_parquet("trips.parquet", columns = [$fare, $trip_distance], filter = $trip_distance > 10)
 --# @family to_dataframe
 --# @seealso read_csv, read_arrow
 --# @export
 *)
 let register env =
   Env.add "read_parquet"
-    (make_builtin ~name:"read_parquet" 1 (fun args _env ->
+    (make_builtin_named ~name:"read_parquet" ~variadic:true 1 (fun named_args _env ->
+      let args =
+        List.filter (fun (name, _) -> not (Scan_args.is_scan_arg name)) named_args
+        |> List.map snd
+      in
       match args with
       | [VString path] ->
-          (match Arrow_io.read_parquet path with
-          | Ok table -> VDataFrame { arrow_table = table; group_keys = [] }
-          | Error msg -> Error.make_error FileError msg)
+          (match Scan_args.scan_options "read_parquet" named_args with
+          | Error e -> e
+          | Ok (columns, predicates) ->
+              (match Arrow_io.read_parquet ~columns ~predicates path with
+              | Ok table -> VDataFrame { arrow_table = table; group_keys = [] }
+              | Error msg -> Error.make_error FileError msg))
       | [VNA _] -> Error.type_error "Function `read_parquet` expects a String path, got NA."
       | [_] -> Error.type_error "Function `read_parquet` expects a String path."
       | _ -> Error.arity_error_named "read_parquet" 1 (List.length args)
@@ -10,20 +10,31 @@ let register env =
   --# @name write_arrow
   --# @param df :: DataFrame The DataFrame to write.
   --# @param path :: String The output file path.
+  --# @param compression :: String (Optional) "uncompressed" (default), "zstd" or "lz4".
+  --#   Uncompressed files can be memory-mapped by readers; compressed ones
+  --#   are decoded on read.
   --# @return :: Null
   --# @example
   --#   write_arrow(df, "data.arrow")
+  --#   write_arrow(df, "data.arrow", compression = "zstd")
   --# @family to_dataframe
   --# @seealso read_arrow
   --# @export
   *)
   Env.add "write_arrow"
-    (make_builtin ~name:"write_arrow" 2 (fun args _env ->
+    (make_builtin_named ~name:"write_arrow" ~variadic:true 2 (fun named_args _env ->
+      let args =
+        List.filter (fun (name, _) -> not (Write_args.is_write_arg name)) named_args
+        |> List.map snd
+      in
       match args with
       | [VDataFrame df; VString path] ->
-          (match Arrow_io.write_ipc df.arrow_table path with
-          | Ok () -> (VNA NAGeneric)
-          | Error msg -> Error.make_error FileError (Printf.sprintf "File Error: %s." msg))
+          (match Write_args.ipc_compression named_args with
+          | Error e -> e
+          | Ok compression ->
+              (match Arrow_io.write_ipc ~compression df.arrow_table path with
+              | Ok () -> (VNA NAGeneric)
+              | Error msg -> Error.make_error FileError (Printf.sprintf "File Error: %s." msg)))
       | [v; VString _] ->
           let type_name = Utils.type_name v in
           let detail = match v with 
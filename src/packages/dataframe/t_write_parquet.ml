@@ -4,25 +4,39 @@ open Ast
 --# Write Parquet file
 --#
 --# Writes a DataFrame to a Parquet file using the native parquet-glib writer.
+--# Column statistics are always written, so readers can skip row groups
+--# with `filter =`.
 --#
 --# @name write_parquet
 --# @param df :: DataFrame The DataFrame to write.
 --# @param path :: String The output file path.
+--# @param compression :: String (Optional) Page codec: "uncompressed" (default), "snappy", "gzip", "brotli", "zstd" or "lz4".
+--# @param row_group_size :: Int (Optional) Maximum rows per row group (default 65536).
+--# @param dictionary :: Bool (Optional) Dictionary-encode columns (default true).
+--# @param data_page_size :: Int (Optional) Target data page size in bytes.
 --# @return :: Null
 --# @example
 --#   write_parquet(df, "data.parquet")
+--#   write_parquet(df, "data.parquet", compression = "zstd", row_group_size = 1000000)
 --# @family to_dataframe
 --# @seealso read_parquet, write_arrow
 --# @export
 *)
 let register env =
   Env.add "write_parquet"
-    (make_builtin ~name:"write_parquet" 2 (fun args _env ->
+    (make_builtin_named ~name:"write_parquet" ~variadic:true 2 (fun named_args _env ->
+      let args =
+        List.filter (fun (name, _) -> not (Write_args.is_write_arg name)) named_args
+        |> List.map snd
+      in
       match args with
       | [VDataFrame df; VString path] ->
-          (match Arrow_io.write_parquet df.arrow_table path with
-          | Ok () -> (VNA NAGeneric)
-          | Error msg -> Error.make_error FileError (Printf.sprintf "File Error: %s." msg))
+          (match Write_args.parquet_options named_args with
+          | Error e -> e
+          | Ok options ->
+              (match Arrow_io.write_parquet ?options df.arrow_table path with
+              | Ok () -> (VNA NAGeneric)
+              | Error msg -> Error.make_error FileError (Printf.sprintf "File Error: %s." msg)))
       | [v; VString _] ->
           let type_name = Utils.type_name v in
           let detail = match v with 
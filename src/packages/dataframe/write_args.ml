@@ -0,0 +1,85 @@
+(* src/packages/dataframe/write_args.ml *)
+(* Shared parsing of the writer options accepted by `write_parquet` and   *)
+(* `write_arrow`: `compression`, plus `row_group_size`, `dictionary` and  *)
+(* `data_page_size` for Parquet.                                          *)
+
+open Ast
+
+let codec_names = "\"uncompressed\", \"snappy\", \"gzip\", \"brotli\", \"zstd\" or \"lz4\""
+
+(** Parse a `compression =` argument.
+
+    @param allowed Codecs the format supports. *)
+let compression_of_value (fn_name : string) (allowed : Arrow_io.compression list) (v : value)
+    : (Arrow_io.compression, value) result =
+  let name = match v with VString s | VSymbol s -> Some (String.lowercase_ascii s) | _ -> None in
+  match Option.bind name Arrow_io.compression_of_name with
+  | Some c when List.mem c allowed -> Ok c
+  | Some c ->
+      Error (Error.value_error
+        (Printf.sprintf "Function `%s` does not support `compression = \"%s\"`; use one of %s."
+           fn_name (Arrow_io.compression_name c)
+           (String.concat ", " (List.map (fun c -> "\"" ^ Arrow_io.compression_name c ^ "\"") allowed))))
+  | None ->
+      (match v with
+       | VString _ | VSymbol _ ->
+           Error (Error.value_error
+             (Printf.sprintf "Function `%s` expects `compression` to be one of %s." fn_name codec_names))
+       | _ ->
+           Error (Error.type_error
+             (Printf.sprintf "Function `%s` expects `compression` to be a String." fn_name)))
+
+let positive_int fn_name arg = function
+  | VInt n when n > 0 -> Ok n
+  | VInt _ ->
+      Error (Error.value_error (Printf.sprintf "Function `%s` expects `%s` to be a positive Int." fn_name arg))
+  | _ -> Error (Error.type_error (Printf.sprintf "Function `%s` expects `%s` to be an Int." fn_name arg))
+
+let is_write_arg = function
+  | Some ("compression" | "row_group_size" | "dictionary" | "data_page_size") -> true
+  | _ -> false
+
+(** Options for `write_parquet`; [Ok None] when none were given, so the
+    writer keeps its historical defaults. *)
+let parquet_options (named_args : (string option * value) list)
+    : (Arrow_io.parquet_options option, value) result =
+  let fn_name = "write_parquet" in
+  let ( let* ) = Result.bind in
+  let opt name parse default =
+    match List.assoc_opt (Some name) named_args with
+    | None -> Ok default
+    | Some v -> parse v
+  in
+  let d = Arrow_io.default_parquet_options in
+  let* compression =
+    opt "compression"
+      (compression_of_value fn_name Arrow_io.[ Uncompressed; Snappy; Gzip; Brotli; Zstd; Lz4 ])
+      d.compression
+  in
+  let* row_group_size = opt "row_group_size" (positive_int fn_name "row_group_size") d.row_group_size in
+  let* dictionary =
+    opt "dictionary"
+      (function
+        | VBool b -> Ok b
+        | _ -> Error (Error.type_error "Function `write_parquet` expects `dictionary` to be a Bool."))
+      d.dictionary
+  in
+  let* data_page_size =
+    opt "data_page_size" (fun v -> Result.map Option.some (positive_int fn_name "data_page_size" v))
+      d.data_page_size
+  in
+  if List.exists (fun (name, _) -> is_write_arg name) named_args then
+    Ok (Some { Arrow_io.compression; row_group_size; dictionary; data_page_size })
+  else Ok None
+
+(** `compression` for `write_arrow`: IPC files support zstd and lz4. *)
+let ipc_compression (named_args : (string option * value) list)
+    : (Arrow_io.compression, value) result =
+  match List.find_opt (fun (name, _) -> is_write_arg name && name <> Some "compression") named_args with
+  | Some (Some name, _) ->
+      Error (Error.value_error
+        (Printf.sprintf "Function `write_arrow` does not accept `%s`; it only applies to Parquet." name))
+  | _ ->
+      (match List.assoc_opt (Some "compression") named_args with
+       | None -> Ok Arrow_io.Uncompressed
+       | Some v -> compression_of_value "write_arrow" Arrow_io.[ Uncompressed; Zstd; Lz4 ] v)
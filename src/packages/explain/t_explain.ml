@@ -123,6 +123,8 @@ let register env =
           ("na_count", VInt na_count);
           ("examples", examples);
         ]
+    | VLazyFrame lf ->
+        make_explain_dict (Lazy_plan.explain_fields lf)
     | VDataFrame df ->
         let value_columns = Arrow_bridge.table_to_value_columns df.arrow_table in
         let nrows = Arrow_table.num_rows df.arrow_table in
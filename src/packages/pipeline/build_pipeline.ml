@@ -43,7 +43,7 @@ let write_atelier_diagrams p env =
 --# @param nix_options :: Dict (Optional) A dictionary of Nix orchestration options:
 --#   - `targets` :: List[String] Specific node names to build. Maps to `-A <target>` in nix-build.
 --#   - `force` :: Bool|List[String] Force-rebuild nodes even if cached. Maps to `--check`.
---#   - `max_jobs` :: Int Maximum parallel build jobs. Maps to `--max-jobs N`.
+--#   - `max_jobs` :: Int Maximum parallel build jobs. Maps to `--max-jobs N`. Defaults to the DAG width, capped at the CPU count.
 --#   - `cache` :: String Cachix cache name to configure as an extra binary substituter.
 --# @return :: BuildLog|DataFrame A structured build log (`nodes`, `duration`, `failed_nodes`, `out_path`), or a dry-run DataFrame.
 --# @family pipeline
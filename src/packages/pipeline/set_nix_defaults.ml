@@ -8,7 +8,7 @@ open Ast
 --# @param nix_options :: Dict A dictionary of default Nix orchestration options:
 --#   - `force` :: Bool|List[String] Force-rebuild nodes even if cached. Maps to `--check`.
 --#   - `dry_run` :: Bool Return a planned build DataFrame without executing. Maps to `--dry-run`.
---#   - `max_jobs` :: Int Maximum parallel build jobs. Maps to `--max-jobs N`.
+--#   - `max_jobs` :: Int Maximum parallel build jobs. Maps to `--max-jobs N`. Defaults to the DAG width, capped at the CPU count.
 --#   - `cache` :: String Cachix cache name to configure as an extra binary substituter.
 --#   - `builders` :: String Nix remote builders config.
 --#   - `keep_env` :: List[String] Environment variables to pass through to the Nix sandbox.
@@ -0,0 +1,56 @@
+open Ast
+
+(*
+--# Approximate quantiles
+--#
+--# Estimates a quantile with a KLL sketch instead of sorting the data.
+--# The sketch keeps a few hundred values however long the input is, and
+--# the returned value's rank is within about 1% of the requested one.
+--# Inputs of up to 200 values are answered exactly, matching `quantile`.
+--#
+--# @name approx_quantile
+--# @param x :: Vector | List The numeric data.
+--# @param probs :: Float The probability (0 to 1).
+--# @param na_rm :: Bool (Optional) Should missing values be removed? Default is false.
+--# @return :: Float The estimated quantile.
+--# @example
+--#   approx_quantile(x, 0.95)
+--#   summarize(group_by(trips, $month), $p95_fare = approx_quantile($fare, 0.95))
+--# @family stats
+--# @seealso quantile, median
+--# @export
+*)
+let register env =
+  Env.add "approx_quantile"
+    (make_builtin_named ~name:"approx_quantile" ~variadic:true 2 (fun named_args _env ->
+      match Math_common.get_bool_flag "na_rm" false named_args with
+      | Error e -> e
+      | Ok na_rm ->
+      let args = Math_common.positional_args_without ["na_rm"] named_args in
+      let get_p = function
+        | VFloat f when f >= 0.0 && f <= 1.0 -> Some f
+        | VInt 0 -> Some 0.0
+        | VInt 1 -> Some 1.0
+        | _ -> None
+      in
+      (match args with
+       | [VNA _; _] | [_; VNA _] -> Error.na_value_error ~na_rm:true "approx_quantile"
+       | [(VVector _ | VList _) as x; p_val] ->
+           (match get_p p_val with
+            | None -> Error.value_error "Function `approx_quantile` expects a probability between 0 and 1."
+            | Some p ->
+                (match Median.numeric_values ~label:"approx_quantile" ~na_rm x with
+                 | Error e -> e
+                 | Ok [] when na_rm -> VNA NAFloat
+                 | Ok nums ->
+                     let sk =
+                       Sketch.build ~create:(fun () -> Sketch.Kll.create ())
+                         ~add:Sketch.Kll.add ~merge:Sketch.Kll.merge (Array.of_list nums)
+                     in
+                     (match Sketch.Kll.quantile sk p with
+                      | Some q -> VFloat q
+                      | None -> Error.value_error "Function `approx_quantile` called on empty data.")))
+       | [_; _] -> Error.type_error "Function `approx_quantile` expects a numeric List or Vector as first argument."
+       | _ -> Error.arity_error_named "approx_quantile" 2 (List.length args))
+    ))
+    env
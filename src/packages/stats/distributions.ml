@@ -1,226 +1,77 @@
 (* src/packages/stats/distributions.ml *)
 open Ast
 
-(* --- Math Primitives --- *)
-
-(** Log-gamma via Lanczos approximation *)
-let log_gamma v =
-  let g = 7.0 in
-  let coefs = [| 0.99999999999980993; 676.5203681218851; -1259.1392167224028;
-                 771.32342877765313; -176.61502916214059; 12.507343278686905;
-                 -0.13857109526572012; 9.9843695780195716e-6; 1.5056327351493116e-7 |] in
-  if v < 0.5 then
-    let pi = Float.pi in
-    log pi -. log (Float.abs (sin (pi *. v))) -. (let lg v = 
-      let vv = v -. 1.0 in
-      let x = ref coefs.(0) in
-      for i = 1 to 8 do
-        x := !x +. coefs.(i) /. (vv +. float_of_int i)
-      done;
-      let t = vv +. g +. 0.5 in
-      0.5 *. log (2.0 *. Float.pi) +. (vv +. 0.5) *. log t -. t +. log !x
-    in lg (1.0 -. v))
-  else begin
-    let vv = v -. 1.0 in
-    let x = ref coefs.(0) in
-    for i = 1 to 8 do
-      x := !x +. coefs.(i) /. (vv +. float_of_int i)
-    done;
-    let t = vv +. g +. 0.5 in
-    0.5 *. log (2.0 *. Float.pi) +. (vv +. 0.5) *. log t -. t +. log !x
-  end
-
-(** Regularised incomplete gamma function P(a, x) = gamma(a, x) / Gamma(a) *)
-let gammp a x =
-  if x < 0.0 || a <= 0.0 then 0.0
-  else if x < a +. 1.0 then begin
-    (* Series representation *)
-    let gln = log_gamma a in
-    let rec loop n ap term sum =
-      let ap = ap +. 1.0 in
-      let term = term *. x /. ap in
-      let sum = sum +. term in
-      if Float.abs term < Float.abs sum *. 3.0e-12 || n > 100 then sum
-      else loop (n + 1) ap term sum
-    in
-    let initial_term = 1.0 /. a in
-    exp (a *. log x -. x -. gln) *. (loop 0 a initial_term initial_term)
-  end else begin
-    (* Continued fraction representation (Lentz's method) *)
-    let gln = log_gamma a in
-    let b = x +. 1.0 -. a in
-    let fpmin = 1.0e-30 in
-    let h = ref b in
-    if Float.abs !h < fpmin then h := fpmin;
-    let c = ref !h in
-    let d = ref 0.0 in
-    let i = ref 1 in
-    let converged = ref false in
-    while !i <= 100 && not !converged do
-      let an = -. float_of_int !i *. (float_of_int !i -. a) in
-      let b_i = x +. float_of_int (2 * !i + 1) -. a in
-      d := b_i +. an *. !d;
-      if Float.abs !d < fpmin then d := fpmin;
-      c := b_i +. an /. !c;
-      if Float.abs !c < fpmin then c := fpmin;
-      d := 1.0 /. !d;
-      let del = !d *. !c in
-      h := !h *. del;
-      if Float.abs (del -. 1.0) < 3.0e-12 then converged := true;
-      incr i
-    done;
-    1.0 -. exp (a *. log x -. x -. gln) *. (1.0 /. !h)
-  end
-
-(** Regularised incomplete beta function I_x(a, b) *)
-let betai x a b =
-  if x <= 0.0 then 0.0
-  else if x >= 1.0 then 1.0
-  else begin
-    let gln = log_gamma (a +. b) -. log_gamma a -. log_gamma b in
-    let continued_fraction a b x =
-      let qab = a +. b in
-      let qap = a +. 1.0 in
-      let qam = a -. 1.0 in
-      let c = 1.0 in
-      let d = 1.0 -. qab *. x /. qap in
-      let d = if Float.abs d < 1.0e-30 then 1.0e-30 else d in
-      let d = 1.0 /. d in
-      let h = d in
-      let rec loop m d h c =
-        let m_f = float_of_int m in
-        let m2 = 2.0 *. m_f in
-        let aa = m_f *. (b -. m_f) *. x /. ((qam +. m2) *. (a +. m2)) in
-        let d = 1.0 +. aa *. d in
-        let d = if Float.abs d < 1.0e-30 then 1.0e-30 else d in
-        let c = 1.0 +. aa /. c in
-        let c = if Float.abs c < 1.0e-30 then 1.0e-30 else c in
-        let d = 1.0 /. d in
-        let h = h *. d *. c in
-        let aa = -. (a +. m_f) *. (qab +. m_f) *. x /. ((a +. m2) *. (qap +. m2)) in
-        let d = 1.0 +. aa *. d in
-        let d = if Float.abs d < 1.0e-30 then 1.0e-30 else d in
-        let c = 1.0 +. aa /. c in
-        let c = if Float.abs c < 1.0e-30 then 1.0e-30 else c in
-        let d = 1.0 /. d in
-        let del = d *. c in
-        let h = h *. del in
-        if Float.abs (del -. 1.0) < 3.0e-12 then h
-        else if m > 100 then h
-        else loop (m + 1) d h c
-      in
-      loop 1 d h c
-    in
-    if x < (a +. 1.0) /. (a +. b +. 2.0) then
-      exp (gln +. a *. log x +. b *. log (1.0 -. x)) /. a *. (continued_fraction a b x)
-    else
-      1.0 -. exp (gln +. b *. log (1.0 -. x) +. a *. log x) /. b *. (continued_fraction b a (1.0 -. x))
-  end
-
 (* --- Statistical Distributions (CDFs) --- *)
 
-let pnorm x =
-  if x < 0.0 then
-    0.5 *. Float.erfc (-. x /. Float.sqrt 2.0)
-  else
-    1.0 -. 0.5 *. Float.erfc (x /. Float.sqrt 2.0)
-
-let pt x df =
-  let x2 = x *. x in
-  let df_f = float_of_int df in
-  let beta_x = df_f /. (df_f +. x2) in
-  let p = 0.5 *. betai beta_x (0.5 *. df_f) 0.5 in
-  if x > 0.0 then 1.0 -. p else p
+(* The special functions (log-gamma, incomplete gamma and beta) live in
+   stats_stubs.c so that whole vectors can be evaluated in one call. *)
 
-let rec t_quantile p df =
-  if p <= 0.0 then Float.neg_infinity
-  else if p >= 1.0 then Float.infinity
-  else if p = 0.5 then 0.0
-  else if p < 0.5 then
-    -. (t_quantile (1.0 -. p) df)
-  else
-    let rec loop lo hi iter =
-      if iter >= 100 || hi -. lo < 1e-15 then
-        0.5 *. (lo +. hi)
-      else
-        let mid = 0.5 *. (lo +. hi) in
-        let val_mid = pt mid df in
-        if val_mid < p then
-          loop mid hi (iter + 1)
-        else
-          loop lo mid (iter + 1)
-    in
-    let rec find_hi hi =
-      if pt hi df >= p then hi
-      else find_hi (hi *. 2.0)
-    in
-    let hi = find_hi 1.0 in
-    loop 0.0 hi 0
+let pnorm x = Stats.dist_scalar Stats.Normal Stats.Cdf x 0.0 1.0
 
-let () =
-  Stats.t_quantile_fun := t_quantile
+let pt x df = Stats.dist_scalar Stats.Student_t Stats.Cdf x (float_of_int df) 0.0
 
 let pf q df1 df2 =
-  if q < 0.0 then 0.0
-  else
-    let df1_f = float_of_int df1 in
-    let df2_f = float_of_int df2 in
-    let x = df2_f /. (df2_f +. df1_f *. q) in
-    1.0 -. betai x (0.5 *. df2_f) (0.5 *. df1_f)
+  Stats.dist_scalar Stats.Fisher_f Stats.Cdf q (float_of_int df1) (float_of_int df2)
 
-let pchisq q df =
-  gammp (0.5 *. float_of_int df) (0.5 *. q)
+let pchisq q df = Stats.dist_scalar Stats.Chi_squared Stats.Cdf q (float_of_int df) 0.0
 
 (* --- Inverse CDFs (Quantile Functions) --- *)
 
 let normal_quantile p =
   Stats.normal_quantile p
 
+let t_quantile p df = Stats.t_quantile p df
+
 let f_quantile p df1 df2 =
   if df1 <= 0 || df2 <= 0 then Float.nan
-  else
-    let fwd x = pf x df1 df2 in
-    if p <= 0.0 then 0.0
-    else if p >= 1.0 then Float.infinity
-    else
-      let rec loop lo hi iter =
-        if iter >= 100 || hi -. lo < 1e-15 then
-          0.5 *. (lo +. hi)
-        else
-          let mid = 0.5 *. (lo +. hi) in
-          if fwd mid < p then loop mid hi (iter + 1)
-          else loop lo mid (iter + 1)
-      in
-      let rec find_hi hi =
-        if fwd hi >= p then hi
-        else find_hi (hi *. 2.0)
-      in
-      let hi = find_hi 1.0 in
-      if fwd 0.0 >= p then 0.0
-      else loop 0.0 hi 0
+  else Stats.dist_scalar Stats.Fisher_f Stats.Quantile p (float_of_int df1) (float_of_int df2)
 
 let chisq_quantile p df =
   if df <= 0 then Float.nan
-  else
-    let fwd x = pchisq x df in
-    if p <= 0.0 then 0.0
-    else if p >= 1.0 then Float.infinity
-    else
-      let rec loop lo hi iter =
-        if iter >= 100 || hi -. lo < 1e-15 then
-          0.5 *. (lo +. hi)
+  else Stats.dist_scalar Stats.Chi_squared Stats.Quantile p (float_of_int df) 0.0
+
+(* --- Builtin helpers --- *)
+
+(** Evaluate [fn] of [dist] on a numeric scalar, List or Vector. A Vector is
+    converted once and evaluated in a single native call; NA elements stay
+    NA. [check] validates each element and returns an error value to
+    reject it. *)
+let rec eval_numeric ~type_msg ?(check = fun _ -> None) dist fn a b v =
+  let scalar x =
+    match check x with
+    | Some err -> err
+    | None -> VFloat (Stats.dist_scalar dist fn x a b)
+  in
+  match v with
+  | VFloat x -> scalar x
+  | VInt x -> scalar (float_of_int x)
+  | VVector arr ->
+      let n = Array.length arr in
+      let xs = Array.make n Float.nan in
+      let rec fill i =
+        if i = n then None
         else
-          let mid = 0.5 *. (lo +. hi) in
-          if fwd mid < p then loop mid hi (iter + 1)
-          else loop lo mid (iter + 1)
+          let ok x = match check x with Some err -> Some err | None -> xs.(i) <- x; fill (i + 1) in
+          match arr.(i) with
+          | VFloat x -> ok x
+          | VInt x -> ok (float_of_int x)
+          | VNA _ -> fill (i + 1)
+          | _ -> Some (Error.type_error type_msg)
       in
-      let rec find_hi hi =
-        if fwd hi >= p then hi
-        else find_hi (hi *. 2.0)
-      in
-      let hi = find_hi 1.0 in
-      if fwd 0.0 >= p then 0.0
-      else loop 0.0 hi 0
+      (match fill 0 with
+       | Some err -> err
+       | None ->
+           let out = Stats.dist_map dist fn a b xs in
+           VVector (Array.mapi (fun i v ->
+             match v with VNA _ -> VNA NAFloat | _ -> VFloat out.(i)) arr))
+  | VList items ->
+      eval_numeric ~type_msg ~check dist fn a b (VVector (Array.of_list (List.map snd items)))
+  | _ -> Error.type_error type_msg
+
+let probability_check name p =
+  if p < 0.0 || p > 1.0 then
+    Some (Error.value_error (Printf.sprintf "Function `%s` expects `p` to be between 0 and 1." name))
+  else None
 
 (* --- Registration --- *)
 
@@ -230,7 +81,7 @@ let chisq_quantile p df =
 --# Returns cumulative probabilities from the standard normal distribution.
 --#
 --# @name pnorm
---# @param x :: Float The value at which to evaluate the CDF.
+--# @param x :: Float The value at which to evaluate the CDF, or a Vector of them.
 --# @return :: Float The cumulative probability.
 --# @family stats
 --# @export
@@ -241,7 +92,7 @@ let chisq_quantile p df =
 --# Returns cumulative probabilities from the Student t distribution.
 --#
 --# @name pt
---# @param x :: Float The value at which to evaluate the CDF.
+--# @param x :: Float The value at which to evaluate the CDF, or a Vector of them.
 --# @param df :: Int Degrees of freedom.
 --# @return :: Float The cumulative probability.
 --# @family stats
@@ -253,7 +104,7 @@ let chisq_quantile p df =
 --# Returns cumulative probabilities from the F distribution.
 --#
 --# @name pf
---# @param q :: Float The value at which to evaluate the CDF.
+--# @param q :: Float The value at which to evaluate the CDF, or a Vector of them.
 --# @param df1 :: Int Degrees of freedom 1.
 --# @param df2 :: Int Degrees of freedom 2.
 --# @return :: Float The cumulative probability.
@@ -266,57 +117,89 @@ let chisq_quantile p df =
 --# Returns cumulative probabilities from the chi-squared distribution.
 --#
 --# @name pchisq
---# @param q :: Float The value at which to evaluate the CDF.
+--# @param q :: Float The value at which to evaluate the CDF, or a Vector of them.
 --# @param df :: Int Degrees of freedom.
 --# @return :: Float The cumulative probability.
 --# @family stats
 --# @export
 *)
 let register env =
+  let positive_df name df =
+    if df <= 0 then Some (Error.value_error (Printf.sprintf "Function `%s` expects `df` to be positive." name))
+    else None
+  in
+  let positive_df2 name df1 df2 =
+    if df1 <= 0 || df2 <= 0 then
+      Some (Error.value_error (Printf.sprintf "Function `%s` expects `df1` and `df2` to be positive." name))
+    else None
+  in
+  let or_eval check eval = match check with None -> eval () | Some err -> err in
   let env = Env.add "pnorm" (make_builtin ~name:"pnorm" 1 (fun args _env ->
     match args with
-    | [VFloat x] -> VFloat (pnorm x)
-    | [VInt x] -> VFloat (pnorm (float_of_int x))
+    | [x] -> eval_numeric ~type_msg:"pnorm expects a numeric argument." Stats.Normal Stats.Cdf 0.0 1.0 x
     | _ -> Error.type_error "pnorm expects a numeric argument."
   )) env in
   let env = Env.add "pt" (make_builtin ~name:"pt" 2 (fun args _env ->
     match args with
-    | [VFloat x; VInt df] ->
-        if df <= 0 then Error.value_error "Function `pt` expects `df` to be positive."
-        else VFloat (pt x df)
-    | [VInt x; VInt df] ->
-        if df <= 0 then Error.value_error "Function `pt` expects `df` to be positive."
-        else VFloat (pt (float_of_int x) df)
+    | [x; VInt df] ->
+        or_eval (positive_df "pt" df) (fun () ->
+          eval_numeric ~type_msg:"pt expects (numeric, Int)." Stats.Student_t Stats.Cdf (float_of_int df) 0.0 x)
     | _ -> Error.type_error "pt expects (numeric, Int)."
   )) env in
   let env = Env.add "pf" (make_builtin ~name:"pf" 3 (fun args _env ->
     match args with
-    | [VFloat q; VInt df1; VInt df2] ->
-        if df1 <= 0 || df2 <= 0 then Error.value_error "Function `pf` expects `df1` and `df2` to be positive."
-        else VFloat (pf q df1 df2)
-    | [VInt q; VInt df1; VInt df2] ->
-        if df1 <= 0 || df2 <= 0 then Error.value_error "Function `pf` expects `df1` and `df2` to be positive."
-        else VFloat (pf (float_of_int q) df1 df2)
+    | [q; VInt df1; VInt df2] ->
+        or_eval (positive_df2 "pf" df1 df2) (fun () ->
+          eval_numeric ~type_msg:"pf expects (numeric, Int, Int)." Stats.Fisher_f Stats.Cdf
+            (float_of_int df1) (float_of_int df2) q)
     | _ -> Error.type_error "pf expects (numeric, Int, Int)."
   )) env in
   let env = Env.add "pchisq" (make_builtin ~name:"pchisq" 2 (fun args _env ->
     match args with
-    | [VFloat q; VInt df] ->
-        if df <= 0 then Error.value_error "Function `pchisq` expects `df` to be positive."
-        else VFloat (pchisq q df)
-    | [VInt q; VInt df] ->
-        if df <= 0 then Error.value_error "Function `pchisq` expects `df` to be positive."
-        else VFloat (pchisq (float_of_int q) df)
+    | [q; VInt df] ->
+        or_eval (positive_df "pchisq" df) (fun () ->
+          eval_numeric ~type_msg:"pchisq expects (numeric, Int)." Stats.Chi_squared Stats.Cdf (float_of_int df) 0.0 q)
     | _ -> Error.type_error "pchisq expects (numeric, Int)."
   )) env in
 (*
+--# Normal distribution density
+--#
+--# Returns the probability density of the normal distribution with given
+--# mean and standard deviation.
+--#
+--# @name dnorm
+--# @param x :: Float | Vector[Float] The value(s) at which to evaluate the density.
+--# @param mean :: Float = 0 The mean of the distribution.
+--# @param sd :: Float = 1 The standard deviation of the distribution.
+--# @return :: Float | Vector[Float] The density.
+--# @family stats
+--# @export
+--# @example
+--#   dnorm(0)
+--#   dnorm(1.5, mean = 1, sd = 2)
+*)
+(*
+--# Chi-squared distribution density
+--#
+--# Returns the probability density of the chi-squared distribution.
+--#
+--# @name dchisq
+--# @param x :: Float | Vector[Float] The value(s) at which to evaluate the density.
+--# @param df :: Int Degrees of freedom.
+--# @return :: Float | Vector[Float] The density.
+--# @family stats
+--# @export
+--# @example
+--#   dchisq(1, 3)
+*)
+(*
 --# Normal distribution quantile (inverse CDF)
 --#
 --# Returns the quantile (inverse cumulative probability) from the
 --# normal distribution with given mean and standard deviation.
 --#
 --# @name qnorm
---# @param p :: Float The probability (0 < p < 1).
+--# @param p :: Float The probability (0 < p < 1), or a Vector of them.
 --# @param mean :: Float = 0 The mean of the distribution.
 --# @param sd :: Float = 1 The standard deviation of the distribution.
 --# @return :: Float The quantile.
@@ -333,7 +216,7 @@ let register env =
 --# Student t distribution with given degrees of freedom.
 --#
 --# @name qt
---# @param p :: Float The probability (0 < p < 1).
+--# @param p :: Float The probability (0 < p < 1), or a Vector of them.
 --# @param df :: Int Degrees of freedom.
 --# @return :: Float The quantile.
 --# @family stats
@@ -348,7 +231,7 @@ let register env =
 --# F distribution with given degrees of freedom.
 --#
 --# @name qf
---# @param p :: Float The probability (0 < p < 1).
+--# @param p :: Float The probability (0 < p < 1), or a Vector of them.
 --# @param df1 :: Int Degrees of freedom 1.
 --# @param df2 :: Int Degrees of freedom 2.
 --# @return :: Float The quantile.
@@ -364,7 +247,7 @@ let register env =
 --# chi-squared distribution with given degrees of freedom.
 --#
 --# @name qchisq
---# @param p :: Float The probability (0 < p < 1).
+--# @param p :: Float The probability (0 < p < 1), or a Vector of them.
 --# @param df :: Int Degrees of freedom.
 --# @return :: Float The quantile.
 --# @family stats
@@ -372,69 +255,75 @@ let register env =
 --# @example
 --#   qchisq(0.95, 2)
 +*)
-  (* --- Quantile (inverse CDF) functions --- *)
-  let env = Env.add "qnorm" (make_builtin_named ~name:"qnorm" ~variadic:true 1 (fun named_args _env ->
-    let extract_named_float name default =
-      match Math_common.optional_named_arg name named_args with
-      | Some (VFloat v) -> `Float v
-      | Some (VInt v) -> `Float (float_of_int v)
-      | Some _ -> `Error (Error.type_error (Printf.sprintf "Function `qnorm` expects `%s` to be numeric." name))
-      | None -> `Float default
+  (* --- Density functions --- *)
+  let mean_sd name named_args =
+    let extract_named_float key default =
+      match Math_common.optional_named_arg key named_args with
+      | Some (VFloat v) -> Ok v
+      | Some (VInt v) -> Ok (float_of_int v)
+      | Some _ -> Error (Error.type_error (Printf.sprintf "Function `%s` expects `%s` to be numeric." name key))
+      | None -> Ok default
     in
     match (extract_named_float "mean" 0.0, extract_named_float "sd" 1.0) with
-    | `Error e, _ | _, `Error e -> e
-    | `Float mean, `Float sd ->
-      if sd <= 0.0 then
-        Error.value_error "Function `qnorm` expects `sd` to be positive."
-      else
-        let args = Math_common.positional_args_without ["mean"; "sd"] named_args in
-        match args with
-        | [VFloat p] ->
-            if p < 0.0 || p > 1.0 then Error.value_error "Function `qnorm` expects `p` to be between 0 and 1."
-            else VFloat (mean +. sd *. normal_quantile p)
-        | [VInt p] ->
-            let p_f = float_of_int p in
-            if p_f < 0.0 || p_f > 1.0 then Error.value_error "Function `qnorm` expects `p` to be between 0 and 1."
-            else VFloat (mean +. sd *. normal_quantile p_f)
-        | _ -> Error.type_error "Function `qnorm` expects a numeric probability as first argument."
+    | Error e, _ | _, Error e -> Error e
+    | Ok _, Ok sd when sd <= 0.0 ->
+        Error (Error.value_error (Printf.sprintf "Function `%s` expects `sd` to be positive." name))
+    | Ok mean, Ok sd -> Ok (mean, sd, Math_common.positional_args_without ["mean"; "sd"] named_args)
+  in
+  let env = Env.add "dnorm" (make_builtin_named ~name:"dnorm" ~variadic:true 1 (fun named_args _env ->
+    match mean_sd "dnorm" named_args with
+    | Error e -> e
+    | Ok (mean, sd, [x]) ->
+        eval_numeric ~type_msg:"Function `dnorm` expects a numeric first argument." Stats.Normal Stats.Density mean sd x
+    | Ok _ -> Error.type_error "Function `dnorm` expects a numeric first argument."
+  )) env in
+  let env = Env.add "dchisq" (make_builtin ~name:"dchisq" 2 (fun args _env ->
+    match args with
+    | [x; VInt df] ->
+        or_eval (positive_df "dchisq" df) (fun () ->
+          eval_numeric ~type_msg:"dchisq expects (numeric, Int)." Stats.Chi_squared Stats.Density (float_of_int df) 0.0 x)
+    | _ -> Error.type_error "dchisq expects (numeric, Int)."
+  )) env in
+  (* --- Quantile (inverse CDF) functions --- *)
+  let env = Env.add "qnorm" (make_builtin_named ~name:"qnorm" ~variadic:true 1 (fun named_args _env ->
+    match mean_sd "qnorm" named_args with
+    | Error e -> e
+    | Ok (mean, sd, [p]) ->
+        eval_numeric ~type_msg:"Function `qnorm` expects a numeric probability as first argument."
+          ~check:(probability_check "qnorm") Stats.Normal Stats.Quantile mean sd p
+    | Ok _ -> Error.type_error "Function `qnorm` expects a numeric probability as first argument."
   )) env in
   let env = Env.add "qt" (make_builtin ~name:"qt" 2 (fun args _env ->
     match args with
-    | [VFloat p; VInt df] ->
-        if p < 0.0 || p > 1.0 then Error.value_error "Function `qt` expects `p` to be between 0 and 1."
-        else if df <= 0 then Error.value_error "Function `qt` expects `df` to be positive."
-        else VFloat (t_quantile p df)
-    | [VInt p; VInt df] ->
-        let p_f = float_of_int p in
-        if p_f < 0.0 || p_f > 1.0 then Error.value_error "Function `qt` expects `p` to be between 0 and 1."
-        else if df <= 0 then Error.value_error "Function `qt` expects `df` to be positive."
-        else VFloat (t_quantile p_f df)
+    | [p; VInt df] ->
+        let check p = match probability_check "qt" p with
+          | None when df <= 0 -> Some (Error.value_error "Function `qt` expects `df` to be positive.")
+          | r -> r
+        in
+        eval_numeric ~type_msg:"qt expects (numeric, Int)." ~check Stats.Student_t Stats.Quantile (float_of_int df) 0.0 p
     | _ -> Error.type_error "qt expects (numeric, Int)."
   )) env in
   let env = Env.add "qf" (make_builtin ~name:"qf" 3 (fun args _env ->
     match args with
-    | [VFloat p; VInt df1; VInt df2] ->
-        if p < 0.0 || p > 1.0 then Error.value_error "Function `qf` expects `p` to be between 0 and 1."
-        else if df1 <= 0 || df2 <= 0 then Error.value_error "Function `qf` expects `df1` and `df2` to be positive."
-        else VFloat (f_quantile p df1 df2)
-    | [VInt p; VInt df1; VInt df2] ->
-        let p_f = float_of_int p in
-        if p_f < 0.0 || p_f > 1.0 then Error.value_error "Function `qf` expects `p` to be between 0 and 1."
-        else if df1 <= 0 || df2 <= 0 then Error.value_error "Function `qf` expects `df1` and `df2` to be positive."
-        else VFloat (f_quantile p_f df1 df2)
+    | [p; VInt df1; VInt df2] ->
+        let check p = match probability_check "qf" p with
+          | None when df1 <= 0 || df2 <= 0 ->
+              Some (Error.value_error "Function `qf` expects `df1` and `df2` to be positive.")
+          | r -> r
+        in
+        eval_numeric ~type_msg:"qf expects (numeric, Int, Int)." ~check Stats.Fisher_f Stats.Quantile
+          (float_of_int df1) (float_of_int df2) p
     | _ -> Error.type_error "qf expects (numeric, Int, Int)."
   )) env in
   let env = Env.add "qchisq" (make_builtin ~name:"qchisq" 2 (fun args _env ->
     match args with
-    | [VFloat p; VInt df] ->
-        if p < 0.0 || p > 1.0 then Error.value_error "Function `qchisq` expects `p` to be between 0 and 1."
-        else if df <= 0 then Error.value_error "Function `qchisq` expects `df` to be positive."
-        else VFloat (chisq_quantile p df)
-    | [VInt p; VInt df] ->
-        let p_f = float_of_int p in
-        if p_f < 0.0 || p_f > 1.0 then Error.value_error "Function `qchisq` expects `p` to be between 0 and 1."
-        else if df <= 0 then Error.value_error "Function `qchisq` expects `df` to be positive."
-        else VFloat (chisq_quantile p_f df)
+    | [p; VInt df] ->
+        let check p = match probability_check "qchisq" p with
+          | None when df <= 0 -> Some (Error.value_error "Function `qchisq` expects `df` to be positive.")
+          | r -> r
+        in
+        eval_numeric ~type_msg:"qchisq expects (numeric, Int)." ~check Stats.Chi_squared Stats.Quantile
+          (float_of_int df) 0.0 p
     | _ -> Error.type_error "qchisq expects (numeric, Int)."
   )) env in
   env
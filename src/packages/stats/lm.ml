@@ -1,8 +1,10 @@
 open Ast
 
+(** A design-matrix column. Plain Float64 columns of native tables share
+    their Arrow buffer; encoded and interaction terms are built once. *)
 type design_term = {
   name : string;
-  values : float array;
+  values : Arrow_owl_bridge.float_buffer;
 }
 
 module StringSet = Set.Make (String)
@@ -241,7 +243,8 @@ let categorical_design_terms col_name = function
             let result = Array.make n 0.0 in
             let rec fill row_idx =
               if row_idx = n then
-                build ({ name = col_name ^ level_name; values = result } :: acc) rest
+                build ({ name = col_name ^ level_name;
+                         values = Arrow_owl_bridge.float_buffer_of_array result } :: acc) rest
               else
                 match indices.(row_idx) with
                 | Some idx ->
@@ -284,8 +287,8 @@ let categorical_design_terms col_name = function
              List.map (fun level_name ->
                {
                  name = col_name ^ level_name;
-                 values = Array.init n (fun i ->
-                   if String.equal string_values.(i) level_name then 1.0 else 0.0);
+                 values = Arrow_owl_bridge.float_buffer_of_array (Array.init n (fun i ->
+                   if String.equal string_values.(i) level_name then 1.0 else 0.0));
                }
              ) encoded_levels
            in
@@ -298,6 +301,10 @@ let categorical_design_terms col_name = function
               col_name))
 
 let predictor_terms_for_column arrow_table col_name =
+  (* Native NA-free numeric columns are used straight from their Arrow buffer. *)
+  match Arrow_owl_bridge.numeric_column_buffer arrow_table col_name with
+  | Some values -> Ok [ { name = col_name; values } ]
+  | None ->
   match Arrow_table.get_column arrow_table col_name with
   | None ->
       Error
@@ -307,7 +314,8 @@ let predictor_terms_for_column arrow_table col_name =
       match Arrow_table.column_type_of col with
       | Arrow_table.ArrowFloat64 | Arrow_table.ArrowInt64 ->
           (match float_array_of_numeric_column col_name col with
-           | Ok values -> Ok [ { name = col_name; values } ]
+           | Ok values ->
+               Ok [ { name = col_name; values = Arrow_owl_bridge.float_buffer_of_array values } ]
            | Error _ as err -> err)
       | Arrow_table.ArrowString | Arrow_table.ArrowDictionary ->
           categorical_design_terms col_name col
@@ -321,11 +329,12 @@ let predictor_terms_for_column arrow_table col_name =
 let multiply_design_terms left_terms right_terms =
   List.concat_map (fun left ->
     List.map (fun right ->
-      let n = Array.length left.values in
-      {
-        name = left.name ^ ":" ^ right.name;
-        values = Array.init n (fun i -> left.values.(i) *. right.values.(i));
-      }
+      let n = Bigarray.Array1.dim left.values in
+      let values = Bigarray.Array1.create Bigarray.float64 Bigarray.c_layout n in
+      for i = 0 to n - 1 do
+        values.{i} <- left.values.{i} *. right.values.{i}
+      done;
+      { name = left.name ^ ":" ^ right.name; values }
     ) right_terms
   ) left_terms
 
@@ -404,11 +413,11 @@ let register env =
                Error.value_error "Function `lm` right side of formula is empty."
              else begin
                (* Verify response column exists *)
-                (match Arrow_table.get_column df.arrow_table y_col with
-                 | None ->
+                (match Arrow_table.has_column df.arrow_table y_col with
+                 | false ->
                      Error.make_error KeyError
                        (Printf.sprintf "Column `%s` not found in DataFrame." y_col)
-                 | Some _ ->
+                 | true ->
                      (* Verify all base columns exist, including those referenced by interaction terms. *)
                      let missing =
                        predictors
@@ -2,37 +2,226 @@
 
 type session
 
+(** ONNX Runtime graph optimisation levels, in increasing order. *)
+type graph_optimization = Opt_none | Opt_basic | Opt_extended | Opt_all
+
+(** Settings applied when a session is created. Thread counts of [0] leave
+    the choice to ONNX Runtime. When [optimized_model_dir] is set, the
+    optimised graph is saved there and reused by later loads of the same
+    model. *)
+type session_options = {
+  intra_op_threads : int;
+  inter_op_threads : int;
+  graph_optimization : graph_optimization;
+  parallel_execution : bool;
+  optimized_model_dir : string option;
+}
+
+let default_options = {
+  intra_op_threads = 0;
+  inter_op_threads = 0;
+  graph_optimization = Opt_all;
+  parallel_execution = false;
+  optimized_model_dir = None;
+}
+
+(* Field layout read by caml_onnx_session_create_with_options. *)
+type native_options = {
+  n_intra_op_threads : int;
+  n_inter_op_threads : int;
+  n_graph_optimization : graph_optimization;
+  n_parallel_execution : bool;
+  n_optimized_model_path : string option;
+}
+
 external session_create : string -> session = "caml_onnx_session_create"
+external session_create_with_options : string -> native_options -> session = "caml_onnx_session_create_with_options"
 external session_run_multi : session -> string array -> float array array array -> string array -> float array array = "caml_onnx_session_run_multi"
+(** [session_run_columns session input output columns batch_size] scores
+    equal-length Float64/Int64 feature columns, feeding them to the model
+    [batch_size] rows at a time through a reusable row-major float buffer.
+    Outputs are returned flattened row-major. *)
+external session_run_columns :
+  session -> string -> string -> Arrow_column.numeric_view array -> int ->
+  (float, Bigarray.float64_elt, Bigarray.c_layout) Bigarray.Array1.t = "caml_onnx_session_run_columns"
 external session_input_width : session -> int = "caml_onnx_session_input_width"
 external session_input_names : session -> string array = "caml_onnx_session_input_names"
 external session_output_names : session -> string array = "caml_onnx_session_output_names"
 external session_metadata : session -> (string * string) list = "caml_onnx_session_metadata"
 
-(* Global registry for session handles, indexed by path *)
-(** Global registry for session handles, indexed by path. *)
-let registry = Hashtbl.create 8
+(** Rows per inference batch when the model does not set [batch_size]. *)
+let default_batch_size = 65536
+
+let graph_optimization_name = function
+  | Opt_none -> "none"
+  | Opt_basic -> "basic"
+  | Opt_extended -> "extended"
+  | Opt_all -> "all"
+
+let graph_optimization_of_name = function
+  | "none" | "disable" -> Some Opt_none
+  | "basic" -> Some Opt_basic
+  | "extended" -> Some Opt_extended
+  | "all" -> Some Opt_all
+  | _ -> None
+
+(** Session options as stored in a model dictionary. *)
+let options_to_value (o : session_options) : Ast.value =
+  Ast.VDict ([
+    "intra_op_threads", Ast.VInt o.intra_op_threads;
+    "inter_op_threads", Ast.VInt o.inter_op_threads;
+    "graph_optimization", Ast.VString (graph_optimization_name o.graph_optimization);
+    "execution_mode", Ast.VString (if o.parallel_execution then "parallel" else "sequential");
+  ] @ (match o.optimized_model_dir with
+       | Some dir -> [ "optimized_model_dir", Ast.VString dir ]
+       | None -> []))
+
+(** Read session options from named settings, starting from [default_options].
+    Accepts the fields written by [options_to_value].
+
+    @return [Ok options] or [Error message]. *)
+let options_of_pairs (pairs : (string * Ast.value) list) : (session_options, string) result =
+  let rec go o = function
+    | [] -> Ok o
+    | ("intra_op_threads", Ast.VInt n) :: rest when n >= 0 -> go { o with intra_op_threads = n } rest
+    | ("inter_op_threads", Ast.VInt n) :: rest when n >= 0 -> go { o with inter_op_threads = n } rest
+    | ("graph_optimization", Ast.VString s) :: rest ->
+        (match graph_optimization_of_name s with
+         | Some level -> go { o with graph_optimization = level } rest
+         | None -> Error "`graph_optimization` must be one of \"none\", \"basic\", \"extended\" or \"all\".")
+    | ("execution_mode", Ast.VString "sequential") :: rest -> go { o with parallel_execution = false } rest
+    | ("execution_mode", Ast.VString "parallel") :: rest -> go { o with parallel_execution = true } rest
+    | ("execution_mode", _) :: _ -> Error "`execution_mode` must be \"sequential\" or \"parallel\"."
+    | ("optimized_model_dir", Ast.VString dir) :: rest -> go { o with optimized_model_dir = Some dir } rest
+    | (("intra_op_threads" | "inter_op_threads") as name, _) :: _ ->
+        Error (Printf.sprintf "`%s` must be a non-negative Int." name)
+    | (name, _) :: _ -> Error (Printf.sprintf "Unknown ONNX session option `%s`." name)
+  in
+  go default_options pairs
+
+(* Model digests, recomputed only when the file's size or mtime changes. *)
+let digest_memo : (string, float * int * string) Hashtbl.t = Hashtbl.create 8
+
+(** Content hash of a model file. *)
+let model_digest path =
+  let st =
+    try Unix.stat path
+    with Unix.Unix_error (err, _, _) -> failwith (Printf.sprintf "%s: %s" path (Unix.error_message err))
+  in
+  match Hashtbl.find_opt digest_memo path with
+  | Some (mtime, size, digest) when mtime = st.Unix.st_mtime && size = st.Unix.st_size -> digest
+  | _ ->
+      let digest =
+        try Digest.to_hex (Digest.file path) with Sys_error msg -> failwith msg
+      in
+      Hashtbl.replace digest_memo path (st.Unix.st_mtime, st.Unix.st_size, digest);
+      digest
+
+(** Global registry of live sessions, keyed by model content hash and the
+    options that affect execution, so copies of the same model at different
+    paths share one session. Entries remember the path they were loaded from. *)
+let registry : (string * session) Value_hash.ValueHash.t = Value_hash.ValueHash.create 8
+
+let registry_key digest (o : session_options) =
+  Ast.VList [
+    (None, Ast.VString digest);
+    (None, Ast.VInt o.intra_op_threads);
+    (None, Ast.VInt o.inter_op_threads);
+    (None, Ast.VString (graph_optimization_name o.graph_optimization));
+    (None, Ast.VBool o.parallel_execution);
+  ]
+
+let rec mkdir_p dir =
+  if not (Sys.file_exists dir) then begin
+    let parent = Filename.dirname dir in
+    if parent <> dir then mkdir_p parent;
+    (try Unix.mkdir dir 0o755 with Unix.Unix_error (Unix.EEXIST, _, _) -> ())
+  end
+
+(** Create a session, going through the on-disk optimised-model cache when
+    [optimized_model_dir] is set. A cached graph is loaded with optimisation
+    disabled; otherwise ONNX Runtime writes the optimised graph to a
+    temporary file that is renamed into the cache once the load succeeds,
+    and removed if the load fails. *)
+let create_session digest path (o : session_options) =
+  let native ?save load_level = {
+    n_intra_op_threads = o.intra_op_threads;
+    n_inter_op_threads = o.inter_op_threads;
+    n_graph_optimization = load_level;
+    n_parallel_execution = o.parallel_execution;
+    n_optimized_model_path = save;
+  } in
+  match o.optimized_model_dir with
+  | Some dir when o.graph_optimization <> Opt_none ->
+      let cached =
+        Filename.concat dir
+          (Printf.sprintf "%s-%s.onnx" digest (graph_optimization_name o.graph_optimization))
+      in
+      if Sys.file_exists cached then
+        session_create_with_options cached (native Opt_none)
+      else begin
+        mkdir_p dir;
+        let tmp = Printf.sprintf "%s.%d.tmp" cached (Unix.getpid ()) in
+        let remove_tmp () = try Sys.remove tmp with Sys_error _ -> () in
+        let session =
+          try session_create_with_options path (native ~save:tmp o.graph_optimization)
+          with e -> remove_tmp (); raise e
+        in
+        (try Sys.rename tmp cached with Sys_error _ -> remove_tmp ());
+        session
+      end
+  | _ -> session_create_with_options path (native o.graph_optimization)
 
 (** Get or create a persistent ONNX session handle for a model path.
     
-    Caches the session inside the global registry map to prevent duplicate model loads.
+    @raise Failure if the model cannot be read or loaded.
+    Sessions are shared by every load of the same model content with the
+    same options, so repeated [t_read_onnx] calls and pipeline nodes do not
+    reload or re-optimise the graph.
     
+    @param options Session settings; defaults to [default_options].
     @param path The path to the ONNX model file.
     @return An active ONNX session handle. *)
-let get_session path =
-  match Hashtbl.find_opt registry path with
-  | Some session -> session
+let get_session ?(options = default_options) path =
+  let digest = model_digest path in
+  let key = registry_key digest options in
+  match Value_hash.ValueHash.find_opt registry key with
+  | Some (_, session) -> session
   | None ->
-      let session = session_create path in
-      Hashtbl.add registry path session;
+      let session = create_session digest path options in
+      Value_hash.ValueHash.replace registry key (path, session);
       session
 
-(** Close and remove an ONNX session handle from the cache registry.
+(** Close and remove the cached ONNX sessions loaded from a path.
     
     @param path The path of the session to close/remove. *)
 let close_session path =
-  Hashtbl.remove registry path
+  Value_hash.ValueHash.filter_map_inplace
+    (fun _ ((p, _) as entry) -> if p = path then None else Some entry)
+    registry;
+  Hashtbl.remove digest_memo path
 
 (** Clear all cached ONNX session handles from the registry. *)
 let clear_cache () =
-  Hashtbl.clear registry
+  Value_hash.ValueHash.clear registry;
+  Hashtbl.clear digest_memo
+
+(** Build the model dictionary returned by [t_read_onnx] and ONNX pipeline
+    nodes. Non-default options are recorded under [session_options] so
+    [predict] reuses the same session.
+    
+    @raise Failure if the model cannot be loaded. *)
+let model_value ?(options = default_options) path =
+  let session = get_session ~options path in
+  let input_names = session_input_names session in
+  let output_names = session_output_names session in
+  let input_width = session_input_width session in
+  let meta = session_metadata session in
+  Ast.VDict ([
+    "model_type", Ast.VSymbol "^onnx";
+    "path", Ast.VString path;
+    "inputs", Ast.VList (Array.to_list input_names |> List.map (fun s -> (None, Ast.VString s)));
+    "outputs", Ast.VList (Array.to_list output_names |> List.map (fun s -> (None, Ast.VString s)));
+    "input_width", Ast.VInt input_width;
+    "metadata", Ast.VDict (List.map (fun (k, v) -> (k, Ast.VString v)) meta);
+  ] @ (if options = default_options then [] else [ "session_options", options_to_value options ]))
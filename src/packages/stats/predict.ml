@@ -15,6 +15,7 @@ open Ast
 --# @name predict
 --# @param data :: DataFrame The new data used for prediction.
 --# @param model :: Model The model object (PMML, ONNX, or T-native).
+--# @param batch_size :: Int (Optional) Rows scored per inference call for ONNX models. Default = 65536.
 --# @return :: Vector | DataFrame The predicted values. For JPMML-backed PMML models (e.g. classification), 
 --#            this returns a DataFrame including probabilities. For regression or native models, 
 --#            this returns a Vector of labels/values.
@@ -64,7 +65,11 @@ let register env =
            | Some ("random_forest" | "forest") -> T_native_scoring.predict_forest_model df (VDict pairs)
            | Some ("decision_tree" | "tree") -> T_native_scoring.predict_tree_model df (VDict pairs)
            | Some ("xgboost" | "lightgbm") -> T_native_scoring.predict_boosted_model df (VDict pairs)
-           | Some "onnx" -> T_native_scoring.predict_onnx_model df (VDict pairs)
+           | Some "onnx" ->
+              (match List.assoc_opt "batch_size" named with
+               | None -> T_native_scoring.predict_onnx_model df (VDict pairs)
+               | Some (VInt n) -> T_native_scoring.predict_onnx_model ~batch_size:n df (VDict pairs)
+               | Some _ -> Error.type_error "Function `predict` expects `batch_size` to be an Int.")
            | _ ->
               (* Final fallback: Linear model coefficients *)
               let coeffs = match List.assoc_opt "coefficients" pairs with
@@ -420,12 +420,13 @@ let rec eval_tree evals node row_idx =
        | Some s -> Some s
        | None -> node.score)
 
-(** Score a complete DataFrame using a single decision tree model.
+(** Score a complete DataFrame using a single decision tree model, walking
+    the parsed tree for each row.
     
     @param df The input DataFrame.
     @param model The tree model dictionary.
     @return A T-Lang vector value containing predictions. *)
-let predict_tree_model df model =
+let interpret_tree_model df model =
   match model with
   | VDict pairs ->
       (match List.assoc_opt "tree" pairs with
@@ -467,14 +468,15 @@ let predict_tree_model df model =
        | None -> Error.type_error "Function `predict` expects a tree model with a `tree` field.")
   | _ -> Error.type_error "Function `predict` expects a tree model Dict."
 
-(** Score a complete DataFrame using a Random Forest model.
+(** Score a complete DataFrame using a Random Forest model, walking the
+    parsed trees for each row.
     
     Aggregates leaf node scores across all individual forest trees.
     
     @param df The input DataFrame.
     @param model The forest model dictionary.
     @return A T-Lang vector value containing aggregated predictions. *)
-let predict_forest_model df model =
+let interpret_forest_model df model =
   match model with
   | VDict pairs ->
       (match List.assoc_opt "forest" pairs with
@@ -584,12 +586,33 @@ let score_to_class classes scores =
         let max_idx = loop 0 s 1 rest in
         class_val max_idx
 
-(** Score a complete DataFrame using a gradient boosted ensemble model (XGBoost / LightGBM).
+(** Turn the per-segment scores of a boosted ensemble into a prediction.
+    
+    @param function_name The ensemble's PMML function name.
+    @param classes The class labels.
+    @param scores One [rescale_constant + rescale_factor * sum] per segment.
+    @return The predicted value for the row. *)
+let boosted_row_value function_name classes scores =
+  match function_name with
+  | "classification" ->
+      if List.length classes = 2 then
+        (match scores with
+         | s :: _ -> VFloat (1.0 /. (1.0 +. exp(-. s)))
+         | [] -> VNA NAFloat)
+      else
+        score_to_class classes scores
+  | _ ->
+      (match scores with
+       | s :: _ when not (Float.is_nan s) -> VFloat s
+       | _ -> VNA NAFloat)
+
+(** Score a complete DataFrame using a gradient boosted ensemble model
+    (XGBoost / LightGBM), walking the parsed trees for each row.
     
     @param df The input DataFrame.
     @param model The boosted model dictionary.
     @return A T-Lang vector value containing predictions. *)
-let predict_boosted_model df model =
+let interpret_boosted_model df model =
   match model with
   | VDict pairs ->
       (match List.assoc_opt "boosted_model" pairs with
@@ -630,41 +653,296 @@ let predict_boosted_model df model =
                            rc +. rf *. sum
                          )
                        in
-                       match ensemble.function_name with
-                       | "classification" ->
-                           if List.length ensemble.classes = 2 then
-                             (match scores with
-                              | s :: _ ->
-                                  let prob = 1.0 /. (1.0 +. exp(-. s)) in
-                                  out.(i) <- VFloat prob
-                              | [] -> out.(i) <- VNA NAFloat)
-                           else if List.length scores = 1 then
-                             out.(i) <- score_to_class ensemble.classes scores
-                           else
-                             out.(i) <- score_to_class ensemble.classes scores
-                       | _ ->
-                           (match scores with
-                            | s :: _ when not (Float.is_nan s) -> out.(i) <- VFloat s
-                            | _ -> out.(i) <- VNA NAFloat)
+                       out.(i) <- boosted_row_value ensemble.function_name ensemble.classes scores
                      done;
                      VVector out))
        | None -> Error.type_error "Function `predict` expects a boosted model (xgboost/lightgbm) with `boosted_model`.")
   | _ -> Error.type_error "Function `predict` expects a boosted model Dict."
 
+(* ------------------------------------------------------------------ *)
+(* Compiled scoring                                                     *)
+(* ------------------------------------------------------------------ *)
+
+(** A model compiled to the flat layout of [Tree_ensemble]. [compiled_labels]
+    maps the label indices of classification scores back to strings. *)
+type compiled_model = {
+  compiled_ensemble : Tree_ensemble.t;
+  compiled_labels : string array;
+  compiled_function : string;
+  compiled_classes : string list;
+}
+
+(** Class labels interned in order of first appearance. *)
+type label_table = {
+  label_ids : (string, int) Hashtbl.t;
+  mutable label_list : string list;
+}
+
+let new_label_table () = { label_ids = Hashtbl.create 8; label_list = [] }
+
+let intern_label table s =
+  match Hashtbl.find_opt table.label_ids s with
+  | Some i -> i
+  | None ->
+      let i = Hashtbl.length table.label_ids in
+      Hashtbl.add table.label_ids s i;
+      table.label_list <- s :: table.label_list;
+      i
+
+let label_array table = Array.of_list (List.rev table.label_list)
+
+(* Leaf score conversions, mirroring the interpreters: single regression
+   trees parse string scores, forests and boosted models skip them, and
+   classifiers vote on labels (numeric scores by their string form). *)
+let score_regression_tree = function
+  | ScoreFloat f -> Tree_ensemble.Value f
+  | ScoreString s ->
+      (match float_of_string_opt s with
+       | Some f -> Tree_ensemble.Value f
+       | None -> Tree_ensemble.Na_score)
+
+let score_numeric = function
+  | ScoreFloat f -> Tree_ensemble.Value f
+  | ScoreString _ -> Tree_ensemble.Na_score
+
+let score_label labels = function
+  | ScoreString s -> Tree_ensemble.Value (float_of_int (intern_label labels s))
+  | ScoreFloat f -> Tree_ensemble.Value (float_of_int (intern_label labels (string_of_float f)))
+
+(** Convert a parsed tree for the compiled scorer. The root's own predicate
+    is never evaluated, so it is ignored.
+    
+    @return [None] if a set or compound predicate is used below the root. *)
+let compile_tree_root score_of (root : tree_node) : Tree_ensemble.node option =
+  let compile_test = function
+    | PredTrue -> Some Tree_ensemble.Always
+    | PredFalse -> Some Tree_ensemble.Never
+    | PredSimple { field; op; value } ->
+        (match Option.bind value float_of_string_opt with
+         | Some threshold -> Some (Tree_ensemble.Compare { field; op = Tree_ensemble.op_of_pmml op; threshold })
+         | None -> Some (Tree_ensemble.Compare { field; op = Tree_ensemble.op_never; threshold = 0.0 }))
+    | PredSimpleSet _ | PredCompound _ -> None
+  in
+  let rec compile test node =
+    let rec children acc = function
+      | [] -> Some (List.rev acc)
+      | c :: rest ->
+          (match Option.bind (compile_test c.predicate) (fun t -> compile t c) with
+           | Some n -> children (n :: acc) rest
+           | None -> None)
+    in
+    Option.map (fun kids ->
+      let score = match node.score with Some sc -> score_of sc | None -> Tree_ensemble.No_score in
+      { Tree_ensemble.test; score; children = kids })
+      (children [] node.children)
+  in
+  compile Tree_ensemble.Always root
+
+let compile_tree_model (tree : tree_model) =
+  let labels = new_label_table () in
+  let score_of = if tree.function_name = "regression" then score_regression_tree else score_label labels in
+  Option.map (fun root ->
+    { compiled_ensemble = Tree_ensemble.build [ (0, root) ];
+      compiled_labels = label_array labels;
+      compiled_function = tree.function_name;
+      compiled_classes = [] })
+    (compile_tree_root score_of tree.root)
+
+let compile_forest_model (forest : forest_model) =
+  let labels = new_label_table () in
+  let score_of = if forest.function_name = "regression" then score_numeric else score_label labels in
+  let roots = List.map (fun (t : tree_model) -> compile_tree_root score_of t.root) forest.trees in
+  if List.mem None roots then None
+  else
+    let trees = List.map (fun r -> (0, Option.get r)) roots in
+    Some { compiled_ensemble = Tree_ensemble.build ~n_labels:(Hashtbl.length labels.label_ids) trees;
+           compiled_labels = label_array labels;
+           compiled_function = forest.function_name;
+           compiled_classes = [] }
+
+let compile_boosted_model (ensemble : boosted_ensemble) =
+  let segments = List.mapi (fun g (_, _, (forest : forest_model)) ->
+    List.map (fun (t : tree_model) -> Option.map (fun r -> (g, r)) (compile_tree_root score_numeric t.root)) forest.trees)
+    ensemble.models |> List.concat
+  in
+  if List.mem None segments then None
+  else
+    let base = Array.of_list (List.map (fun (rc, _, _) -> rc) ensemble.models) in
+    let scale = Array.of_list (List.map (fun (_, rf, _) -> rf) ensemble.models) in
+    Some { compiled_ensemble = Tree_ensemble.build ~group_base:base ~group_scale:scale (List.map Option.get segments);
+           compiled_labels = [||];
+           compiled_function = ensemble.function_name;
+           compiled_classes = ensemble.classes }
+
+(* Compiled models, keyed by the physical model value so repeated predict
+   calls on the same model skip parsing and layout. *)
+module Compiled_cache = Ephemeron.K1.Make (struct
+  type t = value
+  let equal = ( == )
+  let hash = Hashtbl.hash
+end)
+
+let compiled_cache : compiled_model option Compiled_cache.t = Compiled_cache.create 8
+
+(** Compile [model_val] with [parse] and [compile], memoised per model value.
+    Models that fail to parse or use unsupported predicates map to [None]. *)
+let cached_compile model_val parse compile =
+  match Compiled_cache.find_opt compiled_cache model_val with
+  | Some c -> c
+  | None ->
+      let c = match parse model_val with Ok m -> compile m | Error _ -> None in
+      Compiled_cache.replace compiled_cache model_val c;
+      c
+
+(** Predictions served by a compiled model since startup. *)
+let compiled_runs = ref 0
+
+(** Run a compiled model over [df]; [None] when it is not compiled or a
+    field is missing or not numeric, in which case the interpreter runs. *)
+let run_compiled df compiled mode =
+  Option.bind compiled (fun c ->
+    Option.map (fun result -> incr compiled_runs; (c, result))
+      (Tree_ensemble.predict c.compiled_ensemble df.arrow_table mode))
+
+(** Score a complete DataFrame using a single decision tree model.
+    
+    The tree is compiled once into flat node arrays and evaluated in C over
+    the feature columns; trees with set or compound predicates, or with
+    string features, use [interpret_tree_model].
+    
+    @param df The input DataFrame.
+    @param model The tree model dictionary.
+    @return A T-Lang vector value containing predictions. *)
+let predict_tree_model df model =
+  let compiled =
+    match model with
+    | VDict pairs ->
+        (match List.assoc_opt "tree" pairs with
+         | Some tree_val -> run_compiled df (cached_compile tree_val tree_of_value compile_tree_model) Tree_ensemble.Single
+         | None -> None)
+    | _ -> None
+  in
+  match compiled with
+  | Some (c, (out, status, _)) ->
+      let regression = c.compiled_function = "regression" in
+      VVector (Array.init (Bigarray.Array1.dim status) (fun i ->
+        if status.{i} <> Tree_ensemble.row_ok then VNA (if regression then NAFloat else NAString)
+        else if regression then VFloat out.{i}
+        else VString c.compiled_labels.(int_of_float out.{i})))
+  | None -> interpret_tree_model df model
+
+(** Score a complete DataFrame using a Random Forest model.
+    
+    Leaf scores are aggregated in C over batches of rows split across
+    cores. Rows whose majority vote is tied are resolved by
+    [interpret_forest_model] so results do not depend on the path taken.
+    
+    @param df The input DataFrame.
+    @param model The forest model dictionary.
+    @return A T-Lang vector value containing aggregated predictions. *)
+let predict_forest_model df model =
+  let compiled =
+    match model with
+    | VDict pairs ->
+        (match List.assoc_opt "forest" pairs with
+         | Some forest_val -> cached_compile forest_val forest_of_value compile_forest_model
+         | None -> None)
+    | _ -> None
+  in
+  let regression = match compiled with Some c -> c.compiled_function = "regression" | None -> false in
+  match run_compiled df compiled (if regression then Tree_ensemble.Mean else Tree_ensemble.Vote) with
+  | Some (c, (out, status, _)) ->
+      let interpreted = lazy (interpret_forest_model df model) in
+      VVector (Array.init (Bigarray.Array1.dim status) (fun i ->
+        let st = status.{i} in
+        if st = Tree_ensemble.row_na then VNA (if regression then NAFloat else NAString)
+        else if st = Tree_ensemble.row_tie then
+          (match Lazy.force interpreted with
+           | VVector values -> values.(i)
+           | _ -> VNA NAString)
+        else if regression then VFloat out.{i}
+        else VString c.compiled_labels.(int_of_float out.{i})))
+  | None -> interpret_forest_model df model
+
+(** Score a complete DataFrame using a gradient boosted ensemble model (XGBoost / LightGBM).
+    
+    All segments' trees are compiled into one flat ensemble and summed per
+    segment in C; see [predict_forest_model].
+    
+    @param df The input DataFrame.
+    @param model The boosted model dictionary.
+    @return A T-Lang vector value containing predictions. *)
+let predict_boosted_model df model =
+  let compiled =
+    match model with
+    | VDict pairs ->
+        (match List.assoc_opt "boosted_model" pairs with
+         | Some ensemble_val ->
+             run_compiled df (cached_compile ensemble_val boosted_model_of_value compile_boosted_model) Tree_ensemble.Boosted
+         | None -> None)
+    | _ -> None
+  in
+  match compiled with
+  | Some (c, (out, status, width)) ->
+      VVector (Array.init (Bigarray.Array1.dim status) (fun i ->
+        let scores = List.init width (fun g -> out.{i * width + g}) in
+        boosted_row_value c.compiled_function c.compiled_classes scores))
+  | None -> interpret_boosted_model df model
+
+(** Collect the ONNX feature columns as unboxed numeric views. Native
+    Float64/Int64 columns are passed as their Arrow buffers; other tables are
+    copied once into a Float64 Bigarray per column.
+
+    @return [Some (owners, views)], where [owners] must stay reachable while
+            the views are in use, or [None] if any feature value is missing. *)
+let onnx_feature_views table nrows feature_cols =
+  let rec collect owners views = function
+    | [] -> Some (owners, Array.of_list (List.rev views))
+    | cname :: rest ->
+        (match Arrow_column.buffer_view table cname with
+         | Some bv when Arrow_column.buffer_null_count bv > 0 -> None
+         | Some bv -> collect (bv :: owners) (Arrow_column.buffer_values bv :: views) rest
+         | None ->
+             let col = Arrow_table.get_float_column table cname in
+             let ba = Bigarray.Array1.create Bigarray.float64 Bigarray.c_layout nrows in
+             let rec fill i =
+               if i >= nrows then true
+               else match col.(i) with
+                 | Some f -> ba.{i} <- f; fill (i + 1)
+                 | None -> false
+             in
+             if fill 0 then collect owners (Arrow_column.FloatView ba :: views) rest
+             else None)
+  in
+  collect [] [] feature_cols
+
 (** Score a DataFrame using a sandboxed ONNX deep learning model.
     
-    Invokes C++ FFI bindings to feed row tensors through the active session.
+    Feature columns are handed to the C stubs as unboxed buffers and scored
+    in fixed-size row batches, so memory use is bounded by the batch size
+    rather than the table size.
     
+    @param batch_size Rows per inference batch; defaults to the model's
+           [batch_size] field, then [Onnx_ffi.default_batch_size].
     @param df The input DataFrame.
     @param model The ONNX model dictionary (containing path, expected feature columns).
     @return A T-Lang vector value containing computed target predictions. *)
-let predict_onnx_model df model =
+let predict_onnx_model ?batch_size df model =
   match model with
    | VDict pairs ->
        (match List.assoc_opt "path" pairs with
         | Some (VString path) ->
+            let options =
+              match List.assoc_opt "session_options" pairs with
+              | Some (VDict opts) -> Onnx_ffi.options_of_pairs opts
+              | Some _ -> Error "`session_options` must be a Dict."
+              | None -> Ok Onnx_ffi.default_options
+            in
+            (match options with
+             | Error msg -> Error.value_error (Printf.sprintf "Function `predict`: %s" msg)
+             | Ok options ->
             (try
-              let session = Onnx_ffi.get_session path in
+              let session = Onnx_ffi.get_session ~options path in
               let colnames = Arrow_table.column_names df.arrow_table in
               let numeric_cols =
                 List.filter (fun n ->
@@ -700,33 +978,30 @@ let predict_onnx_model df model =
                                    "Function `predict` expected %d numeric feature columns for this ONNX model but received %d."
                                    expected_width ncols)
                             else
-                              let data = Array.make_matrix nrows ncols 0.0 in
-                              let has_missing = ref false in
-                              List.iteri (fun j cname ->
-                                if not !has_missing then begin
-                                  let col = Arrow_table.get_float_column df.arrow_table cname in
-                                  for i = 0 to nrows - 1 do
-                                    if not !has_missing then
-                                      match col.(i) with
-                                      | Some f -> data.(i).(j) <- f
-                                      | None -> has_missing := true
-                                  done
-                                end
-                              ) feature_cols;
-                              if !has_missing then
+                              match onnx_feature_views df.arrow_table nrows feature_cols with
+                              | None ->
                                 Error.make_error ValueError
                                   "DataFrame contains missing values in numeric columns required for ONNX prediction."
-                              else
-                                let res = Onnx_ffi.session_run_multi session 
-                                    [| (match List.assoc_opt "inputs" pairs with
-                                        | Some (VList ((_, VString name) :: _)) -> name
-                                        | _ -> "input") |]
-                                    [| data |] 
-                                    [| (match List.assoc_opt "outputs" pairs with
-                                        | Some (VList ((_, VString name) :: _)) -> name
-                                        | _ -> "output") |] in
-                                VVector (Array.map (fun f -> VFloat f) res.(0)))
-            with Failure msg -> Error.make_error RuntimeError msg)
+                              | Some (owners, views) ->
+                                let batch_size =
+                                  match batch_size, List.assoc_opt "batch_size" pairs with
+                                  | Some n, _ | None, Some (VInt n) -> n
+                                  | _ -> Onnx_ffi.default_batch_size
+                                in
+                                if batch_size <= 0 then
+                                  Error.make_error ValueError "Function `predict` expects `batch_size` to be a positive Int."
+                                else
+                                  let res = Onnx_ffi.session_run_columns session
+                                      (match List.assoc_opt "inputs" pairs with
+                                       | Some (VList ((_, VString name) :: _)) -> name
+                                       | _ -> "input")
+                                      (match List.assoc_opt "outputs" pairs with
+                                       | Some (VList ((_, VString name) :: _)) -> name
+                                       | _ -> "output")
+                                      views batch_size in
+                                  ignore (Sys.opaque_identity owners);
+                                  VVector (Array.init (Bigarray.Array1.dim res) (fun i -> VFloat res.{i})))
+            with Failure msg -> Error.make_error RuntimeError msg))
         | _ -> Error.type_error "Function `predict` expects an ONNX model with a `path` field.")
    | _ -> Error.type_error "Function `predict` expects an ONNX model Dict."
 
@@ -8,8 +8,16 @@ open Ast
 --# the file path, input/output names, and model-level metadata.
 --# This model object can be passed to `predict()` for native T-side inference.
 --#
+--# Sessions are cached for the whole process by model content and options,
+--# so reading the same model again does not reload or re-optimise it.
+--#
 --# @name t_read_onnx
 --# @param path :: String The file path to the .onnx model.
+--# @param intra_op_threads :: Int (Optional) Threads used within an operator. Default = 0 (ONNX Runtime decides).
+--# @param inter_op_threads :: Int (Optional) Threads used across operators in parallel mode. Default = 0.
+--# @param graph_optimization :: String (Optional) "none", "basic", "extended" or "all". Default = "all".
+--# @param execution_mode :: String (Optional) "sequential" or "parallel". Default = "sequential".
+--# @param optimized_model_dir :: String (Optional) Directory where the optimised graph is saved and reused.
 --# @return :: Dict A model dictionary containing:
 --#   - `model_type` :: Symbol (^onnx)
 --#   - `path` :: String
@@ -17,32 +25,27 @@ open Ast
 --#   - `outputs` :: List[String]
 --#   - `input_width` :: Int
 --#   - `metadata` :: Dict Model-level custom properties (producer, description, etc.)
+--#   - `session_options` :: Dict (Only when options were given)
+--# @example
+--#   model = t_read_onnx("model.onnx", intra_op_threads = 4, optimized_model_dir = "_onnx_cache")
 --# @family stats
 --# @export
 *)
 let t_read_onnx_builtin =
-  make_builtin ~name:"t_read_onnx" 1 (fun args _env ->
-    match args with
+  make_builtin_named ~name:"t_read_onnx" ~variadic:true 1 (fun named_args _env ->
+    let positional = List.filter_map (fun (n, v) -> if n = None then Some v else None) named_args in
+    let options = List.filter_map (fun (n, v) -> Option.map (fun n -> (n, v)) n) named_args in
+    match positional with
     | [VString path] ->
         if not (Sys.file_exists path) then
           Error.make_error FileError (Printf.sprintf "Function `t_read_onnx`: ONNX model file not found: %s" path)
         else begin
-          try
-            let session = Onnx_ffi.get_session path in
-            let input_names = Onnx_ffi.session_input_names session in
-            let output_names = Onnx_ffi.session_output_names session in
-            let input_width = Onnx_ffi.session_input_width session in
-            let meta = Onnx_ffi.session_metadata session in
-            VDict [
-              "model_type", VSymbol "^onnx";
-              "path", VString path;
-              "inputs", VList (Array.to_list input_names |> List.map (fun s -> (None, VString s)));
-              "outputs", VList (Array.to_list output_names |> List.map (fun s -> (None, VString s)));
-              "input_width", VInt input_width;
-              "metadata", VDict (List.map (fun (k, v) -> (k, VString v)) meta);
-            ]
-          with Failure msg ->
-            Error.make_error RuntimeError (Printf.sprintf "Function `t_read_onnx` failed to load model: %s" msg)
+          match Onnx_ffi.options_of_pairs options with
+          | Error msg -> Error.value_error (Printf.sprintf "Function `t_read_onnx`: %s" msg)
+          | Ok options ->
+              (try Onnx_ffi.model_value ~options path
+               with Failure msg ->
+                 Error.make_error RuntimeError (Printf.sprintf "Function `t_read_onnx` failed to load model: %s" msg))
         end
     | [VError _ as e] -> e
     | _ -> Error.type_error "t_read_onnx expects a single String argument (file path).")
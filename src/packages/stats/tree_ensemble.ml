@@ -0,0 +1,202 @@
+(* src/packages/stats/tree_ensemble.ml *)
+(* Flat array layout for PMML decision trees, forests and boosted          *)
+(* ensembles, scored in C (caml_tree_ensemble_predict) over Arrow columns. *)
+
+open Bigarray
+
+type int32_array = (int32, int32_elt, c_layout) Array1.t
+type float_array = (float, float64_elt, c_layout) Array1.t
+type byte_array = (int, int8_unsigned_elt, c_layout) Array1.t
+
+(** A node's test against its parent's row. [Compare] thresholds are
+    already parsed; an unparsable or unsupported comparison keeps its field
+    (so scoring still checks the column exists) with [op_never]. *)
+type test =
+  | Always
+  | Never
+  | Compare of { field : string; op : int; threshold : float }
+
+(** [Value] scores take part in sums and means; [Na_score] marks a node
+    that has a score which is not numeric. *)
+type score = No_score | Value of float | Na_score
+
+type node = { test : test; score : score; children : node list }
+
+(** How per-tree results are combined, matching the C [TREE_MODE_*] codes. *)
+type mode =
+  | Single   (** one tree: the leaf score *)
+  | Mean     (** forest regression: mean of numeric leaf scores *)
+  | Vote     (** forest classification: most frequent label index *)
+  | Boosted  (** per-group [base + scale * sum] of numeric leaf scores *)
+
+(** Compiled ensemble. The first twelve fields are read by the C stub in
+    this order. Node [i]'s children are [first_child.{i}] up to
+    [first_child.{i} + n_children.{i} - 1]. *)
+type t = {
+  feature : int32_array;      (* feature index, -1 always true, -2 always false *)
+  op : byte_array;
+  threshold : float_array;
+  first_child : int32_array;
+  n_children : int32_array;
+  score : float_array;
+  score_kind : byte_array;    (* 0 none, 1 numeric, 2 non-numeric *)
+  tree_root : int32_array;
+  tree_group : int32_array;
+  group_base : float_array;
+  group_scale : float_array;
+  n_labels : int;
+  fields : string array;      (* feature index -> column name *)
+}
+
+(** A feature column handed to C: values and an optional Arrow validity
+    bitmap, where row [i] is valid when bit [bit_offset + i] is set. *)
+type feature = {
+  values : Arrow_column.numeric_view;
+  validity : Arrow_ffi.validity_bitmap option;
+  bit_offset : int;
+}
+
+external predict_native : t -> feature array -> mode -> float_array -> byte_array -> unit
+  = "caml_tree_ensemble_predict"
+
+let row_ok = 0
+let row_na = 1
+let row_tie = 2
+
+(** Operator code of a comparison that never matches. *)
+let op_never = 6
+
+(** Operator code of a PMML [SimplePredicate] on a numeric field. *)
+let op_of_pmml = function
+  | "lessThan" -> 0
+  | "lessOrEqual" -> 1
+  | "greaterThan" -> 2
+  | "greaterOrEqual" -> 3
+  | "equal" -> 4
+  | "notEqual" -> 5
+  | _ -> op_never
+
+(** Lay out trees depth-first with siblings contiguous.
+
+    @param trees [(group, root)] pairs, in scoring order.
+    @param group_base Per-group additive constant (boosted models).
+    @param group_scale Per-group factor (boosted models).
+    @param n_labels Number of class labels that [Value] scores index. *)
+let build ?(group_base = [| 0.0 |]) ?(group_scale = [| 1.0 |]) ?(n_labels = 0)
+    (trees : (int * node) list) : t =
+  let nodes = ref [] in
+  let count = ref 0 in
+  let field_index = Hashtbl.create 16 in
+  let fields = ref [] in
+  let index_of field =
+    match Hashtbl.find_opt field_index field with
+    | Some i -> i
+    | None ->
+        let i = Hashtbl.length field_index in
+        Hashtbl.add field_index field i;
+        fields := field :: !fields;
+        i
+  in
+  (* Reserve indices for a sibling list, then place each sibling's children;
+     returns the first sibling's index. *)
+  let rec place siblings =
+    let base = !count in
+    let slots = List.map (fun n -> let slot = (n, ref 0) in nodes := slot :: !nodes; incr count; slot) siblings in
+    List.iter (fun (n, first) -> first := place n.children) slots;
+    base
+  in
+  let roots = List.map (fun (group, root) -> (group, place [ { root with test = Always } ])) trees in
+  let nodes = Array.of_list (List.rev !nodes) in
+  let n = Array.length nodes in
+  let int32s len f = let a = Array1.create int32 c_layout len in for i = 0 to len - 1 do a.{i} <- Int32.of_int (f i) done; a in
+  let floats len f = let a = Array1.create float64 c_layout len in for i = 0 to len - 1 do a.{i} <- f i done; a in
+  let bytes len f = let a = Array1.create int8_unsigned c_layout len in for i = 0 to len - 1 do a.{i} <- f i done; a in
+  let feature_of i =
+    match (fst nodes.(i)).test with
+    | Always -> -1
+    | Never -> -2
+    | Compare { field; _ } -> index_of field
+  in
+  let feature = int32s n feature_of in
+  let roots = Array.of_list roots in
+  {
+    feature;
+    op = bytes n (fun i -> match (fst nodes.(i)).test with Compare { op; _ } -> op | _ -> op_never);
+    threshold = floats n (fun i -> match (fst nodes.(i)).test with Compare { threshold; _ } -> threshold | _ -> 0.0);
+    first_child = int32s n (fun i -> !(snd nodes.(i)));
+    n_children = int32s n (fun i -> List.length (fst nodes.(i)).children);
+    score = floats n (fun i -> match (fst nodes.(i)).score with Value f -> f | _ -> 0.0);
+    score_kind = bytes n (fun i -> match (fst nodes.(i)).score with No_score -> 0 | Value _ -> 1 | Na_score -> 2);
+    tree_root = int32s (Array.length roots) (fun i -> snd roots.(i));
+    tree_group = int32s (Array.length roots) (fun i -> fst roots.(i));
+    group_base = floats (Array.length group_base) (fun i -> group_base.(i));
+    group_scale = floats (Array.length group_scale) (fun i -> group_scale.(i));
+    n_labels;
+    fields = Array.of_list (List.rev !fields);
+  }
+
+(** Map the ensemble's fields to feature columns of [table]. Native
+    Float64/Int64 columns are used in place; Boolean and non-native numeric
+    columns are copied once into a Float64 Bigarray.
+
+    @return [Some (owners, features)], where [owners] must stay reachable
+            while the features are used, or [None] if a field is absent or
+            not numeric. *)
+let features (ens : t) (table : Arrow_table.t) =
+  let nrows = Arrow_table.num_rows table in
+  let copied get =
+    let values = Array1.create float64 c_layout nrows in
+    let validity = Array1.create int8_unsigned c_layout ((nrows + 7) / 8) in
+    Array1.fill validity 0;
+    for i = 0 to nrows - 1 do
+      match get i with
+      | Some f ->
+          values.{i} <- f;
+          validity.{i lsr 3} <- validity.{i lsr 3} lor (1 lsl (i land 7))
+      | None -> values.{i} <- 0.0
+    done;
+    { values = Arrow_column.FloatView values; validity = Some validity; bit_offset = 0 }
+  in
+  let rec collect owners acc i =
+    if i >= Array.length ens.fields then Some (owners, Array.of_list (List.rev acc))
+    else
+      let field = ens.fields.(i) in
+      match Arrow_table.column_type table field with
+      | Some (Arrow_table.ArrowFloat64 | Arrow_table.ArrowInt64) ->
+          (match Arrow_column.buffer_view table field with
+           | Some bv ->
+               let validity, bit_offset =
+                 match Arrow_column.buffer_validity bv with
+                 | Some (bitmap, offset) -> (Some bitmap, offset)
+                 | None -> (None, 0)
+               in
+               collect (bv :: owners)
+                 ({ values = Arrow_column.buffer_values bv; validity; bit_offset } :: acc) (i + 1)
+           | None ->
+               let col = Arrow_table.get_float_column table field in
+               collect owners (copied (fun r -> col.(r)) :: acc) (i + 1))
+      | Some Arrow_table.ArrowBoolean ->
+          let col = Arrow_table.get_bool_column table field in
+          collect owners
+            (copied (fun r -> Option.map (fun b -> if b then 1.0 else 0.0) col.(r)) :: acc) (i + 1)
+      | _ -> None
+  in
+  collect [] [] 0
+
+(** Score every row of [table].
+
+    @return [Some (out, status, width)]: [out] holds [width] values per row
+            (the number of groups for [Boosted], otherwise 1) and [status]
+            one of [row_ok], [row_na] or [row_tie] per row. [None] when
+            [features] rejects the table. *)
+let predict (ens : t) (table : Arrow_table.t) (mode : mode) =
+  match features ens table with
+  | None -> None
+  | Some (owners, feats) ->
+      let nrows = Arrow_table.num_rows table in
+      let width = match mode with Boosted -> Array1.dim ens.group_base | _ -> 1 in
+      let out = Array1.create float64 c_layout (nrows * width) in
+      let status = Array1.create int8_unsigned c_layout nrows in
+      predict_native ens feats mode out status;
+      ignore (Sys.opaque_identity owners);
+      Some (out, status, width)
@@ -30,7 +30,10 @@ let pipeline_copy ?(node_name=None) ?(target_dir="pipeline-output") ?(dir_mode="
             let () = if not (Sys.file_exists target_dir) then Unix.mkdir target_dir 0o755 in
 
             let copy_item src dest =
-               let argv = [| "cp"; "-RP"; src; dest |] in
+               (* Follow links: pipeline_output links each node to its store
+                  path, and the copy must hold the files themselves so it
+                  survives garbage collection and takes the requested modes. *)
+               let argv = [| "cp"; "-RL"; src; dest |] in
                match run_command_argv_exit argv with
                | Ok code -> code
                | Error _ -> 1
@@ -21,6 +21,32 @@ let nix_verbosity_args verbose =
   if verbose <= 0 then []
   else List.init (max 0 (verbose - 1)) (fun _ -> "--verbose")
 
+(** `--max-jobs` / `--cores` for a build whose DAG is [width] nodes wide.
+    Explicit settings win. Without `max_jobs`, up to one job per CPU runs
+    independent nodes side by side (Nix otherwise builds one derivation at
+    a time) and, unless `max_cores` is set, each job gets an even share of
+    the CPUs so concurrent nodes don't oversubscribe the machine. *)
+let parallel_build_args ?(cpus = Domain.recommended_domain_count ()) ~max_jobs ~max_cores ~width () =
+  let explicit_cores =
+    match max_cores with
+    | Some (VInt n) when n >= 0 -> Some n
+    | _ -> None
+  in
+  let jobs, cores =
+    match max_jobs with
+    | Some (VInt n) when n > 0 -> (Some n, explicit_cores)
+    | _ ->
+        let jobs = max 1 (min width cpus) in
+        if jobs <= 1 then (None, explicit_cores)
+        else
+          (Some jobs,
+           match explicit_cores with
+           | Some _ as c -> c
+           | None -> Some (max 1 (cpus / jobs)))
+  in
+  (match jobs with Some n -> ["--max-jobs"; string_of_int n] | None -> [])
+  @ (match cores with Some n -> ["--cores"; string_of_int n] | None -> [])
+
 (*
 --# Print Failed Node Logs
 --#
@@ -198,27 +224,62 @@ let build_pipeline_internal ?verbose ?pipeline_name ?(nix_options : nix_opts opt
     match target_args_result, force_check_result with
     | Error msg, _ | _, Error msg -> Error msg
     | Ok target_args, Ok () ->
-    let force_args =
-      let force_enabled =
-        match force with
-        | None -> false
-        | Some (VBool b) -> b
-        | Some (VList items) -> List.length items > 0
-        | Some (VVector arr) -> Array.length arr > 0
-        | Some (VString s) -> s <> ""
-        | _ -> false
-      in
-      if force_enabled then ["--check"] else []
+    let force_enabled =
+      match force with
+      | None -> false
+      | Some (VBool b) -> b
+      | Some (VList items) -> List.length items > 0
+      | Some (VVector arr) -> Array.length arr > 0
+      | Some (VString s) -> s <> ""
+      | _ -> false
     in
-    let max_jobs_args =
-      match max_jobs with
-      | Some (VInt n) when n > 0 -> ["--max-jobs"; string_of_int n]
-      | _ -> []
+    let target_names =
+      List.filter (fun a -> a <> "-A" && a <> "pipeline_output") target_args
     in
-    let max_cores_args =
-      match max_cores with
-      | Some (VInt n) when n >= 0 -> ["--cores"; string_of_int n]
-      | _ -> []
+    let wanted_nodes = Builder_write_dag.dag_closure ~targets:target_names p in
+    (* Keys hash the project sources, so only compute them when the cache
+       is consulted or recorded. *)
+    let node_keys = lazy (Builder_node_cache.node_keys p) in
+    let unchanged_nodes, stale_nodes =
+      if dry_run || force_enabled then ([], wanted_nodes)
+      else Builder_node_cache.partition (Lazy.force node_keys) wanted_nodes
+    in
+    match unchanged_nodes, stale_nodes with
+    | (_ :: _ as paths), [] ->
+        let soft_failed =
+          List.filter_map (fun (name, path) ->
+            match read_file_first_line (Filename.concat path "class") with
+            | Some "VError" | Some "Error" -> Some (None, VString name)
+            | _ -> None
+          ) paths
+        in
+        Printf.eprintf "\n○ %d nodes unchanged since the last build — skipped Nix evaluation.\n%!"
+          (List.length paths);
+        Ok (VDict [
+          ("out_path", VString "");
+          ("built", VInt 0);
+          ("cached", VInt (List.length paths));
+          ("soft_failed", VList soft_failed);
+        ])
+    | _ ->
+    (* When part of the wanted closure is unchanged, build only the stale
+       nodes; Nix reuses the unchanged dependencies from the store. *)
+    let target_args, target_names =
+      if unchanged_nodes = [] then (target_args, target_names)
+      else begin
+        Printf.eprintf "\n○ %d nodes unchanged since the last build — building %d changed node(s).\n%!"
+          (List.length unchanged_nodes) (List.length stale_nodes);
+        (List.concat_map (fun n -> ["-A"; n]) stale_nodes, stale_nodes)
+      end
+    in
+    let force_args = if force_enabled then ["--check"] else [] in
+    let schedule_args =
+      let width = Builder_write_dag.dag_width ~targets:target_names p in
+      let args = parallel_build_args ~max_jobs ~max_cores ~width () in
+      if verbose > 0 then
+        Printf.eprintf "[Debug] DAG width %d; scheduling with: %s\n%!" width
+          (if args = [] then "nix defaults" else String.concat " " args);
+      args
     in
     let cache_args =
       match cache with
@@ -253,8 +314,9 @@ let build_pipeline_internal ?verbose ?pipeline_name ?(nix_options : nix_opts opt
       | Some (VString "none") -> ["--option"; "sandbox"; "false"]
       | _ -> []
     in
-    let all_args = !nix_build_args @ (nix_verbosity_args verbose) @ force_args @ max_jobs_args @ max_cores_args @ cache_args @ builders_args @ keep_env_args @ sandbox_args in
+    let all_args = !nix_build_args @ (nix_verbosity_args verbose) @ force_args @ schedule_args @ cache_args @ builders_args @ keep_env_args @ sandbox_args in
     let node_store_paths = Hashtbl.create (List.length node_names) in
+    List.iter (fun (name, path) -> Hashtbl.replace node_store_paths name path) unchanged_nodes;
     let () =
       if Sys.file_exists pipeline_nix_path then (
         let expr =
@@ -548,6 +610,11 @@ let build_pipeline_internal ?verbose ?pipeline_name ?(nix_options : nix_opts opt
                  | _ -> [])
               else []
             in
+            let profile_fields =
+              match Builder_logs.node_profile_path artifact_path with
+              | Some p -> [("profile", "\"" ^ Serialization.json_escape p ^ "\"")]
+              | None -> []
+            in
             
             Serialization.json_dict ([
               ("node", "\"" ^ Serialization.json_escape name ^ "\"");
@@ -560,7 +627,7 @@ let build_pipeline_internal ?verbose ?pipeline_name ?(nix_options : nix_opts opt
               ("success", success);
               ("warnings", has_warns);
               ("duration", Printf.sprintf "%.4f" node_dur)
-            ] @ error_fields)
+            ] @ error_fields @ profile_fields)
           ) p.p_exprs
         in
         let base_pairs = [
@@ -622,6 +689,12 @@ let build_pipeline_internal ?verbose ?pipeline_name ?(nix_options : nix_opts opt
               | _ ->
                   let out_path = List.nth store_paths (List.length store_paths - 1) in
                   let reconcile_end_time = Unix.gettimeofday () in
+                  Builder_node_cache.record (Lazy.force node_keys)
+                    (List.filter_map (fun name ->
+                       match Hashtbl.find_opt node_store_paths name with
+                       | Some path when Sys.file_exists path -> Some (name, path)
+                       | _ -> None
+                     ) wanted_nodes);
                   
                   (* Compute cache info before reconciliation overwrites statuses *)
                   let cached_nodes = List.filter (fun n -> not (Hashtbl.mem node_was_built n)) node_names in
@@ -631,8 +704,8 @@ let build_pipeline_internal ?verbose ?pipeline_name ?(nix_options : nix_opts opt
                   (* Reconcile statuses: if nix-build succeeded, check which nodes were built (cached or otherwise) *)
                   List.iter (fun name ->
                     let node_path = Filename.concat out_path name in
-                    Hashtbl.replace node_store_paths name node_path;
                     if Sys.file_exists node_path then (
+                      Hashtbl.replace node_store_paths name node_path;
                       let class_path = Filename.concat node_path "class" in
                       let warnings_path = Filename.concat node_path "warnings" in
                       if Sys.file_exists warnings_path then Hashtbl.replace node_has_warnings name true;
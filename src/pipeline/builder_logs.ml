@@ -56,6 +56,14 @@ let find_log_for_out_path out_path =
     | Some log_file -> Some (Filename.concat pipeline_dir log_file)
     | None -> None
 
+(** Chrome trace written next to a node's artifact by a profiled build
+    (see [Profiler]), if there is one. *)
+let node_profile_path artifact_path =
+  if artifact_path = "" then None
+  else
+    let path = Filename.concat (Filename.dirname artifact_path) "profile.json" in
+    if Sys.file_exists path then Some path else None
+
 let read_log path =
   try
     let json = Yojson.Safe.from_file path in
@@ -202,12 +210,17 @@ let parse_json_log_to_vbuildlog log_path =
           | "softfailed" | "errored" -> true
           | _ -> false
         in
+        let profile_fields =
+          match node_json |> member "profile" with
+          | `String p -> [("profile", Ast.VString p)]
+          | _ -> []
+        in
         let record_fields = [
           ("name", Ast.VString name);
           ("status", Ast.VString display_status);
           ("duration", Ast.VFloat node_duration);
           ("path", Ast.VString node_path);
-        ] in
+        ] @ profile_fields in
         (Ast.VDict record_fields, name, is_failed)
       in
       let parsed_nodes = List.map parse_node nodes_list in
@@ -0,0 +1,143 @@
+(* src/pipeline/builder_node_cache.ml *)
+(* Node-level build cache. Every node gets a key hashing its emitted      *)
+(* derivation text, the keys of its dependencies and the project sources  *)
+(* Nix builds it from. When each node a build needs still has the key and *)
+(* live store path recorded by an earlier successful build, the build is  *)
+(* answered from the cache without evaluating pipeline.nix; otherwise     *)
+(* only the nodes whose key changed are handed to nix-build.              *)
+
+open Builder_utils
+
+let cache_path = Filename.concat pipeline_dir "node_cache.json"
+
+(* Bump when the key recipe changes so old entries stop matching. *)
+let key_version = "1"
+
+(** Fingerprint of the tree that pipeline.nix copies into every node as
+    `sources`: relative path, size and mtime of each file outside the
+    directories it filters out. Only metadata is read, so large data files
+    cost nothing; touching a file merely sends the next build through Nix. *)
+let source_digest root =
+  let skipped = [ "_pipeline"; ".git"; ".direnv"; "_build" ] in
+  let buf = Buffer.create 4096 in
+  let rec walk rel =
+    let dir = if rel = "" then root else Filename.concat root rel in
+    let entries = try Sys.readdir dir with Sys_error _ -> [||] in
+    Array.sort compare entries;
+    Array.iter (fun entry ->
+      if not (List.mem entry skipped) then begin
+        let rel = if rel = "" then entry else Filename.concat rel entry in
+        match Unix.lstat (Filename.concat root rel) with
+        | { Unix.st_kind = Unix.S_DIR; _ } -> walk rel
+        | st -> Printf.bprintf buf "%s\000%d\000%.6f\n" rel st.Unix.st_size st.Unix.st_mtime
+        | exception Unix.Unix_error _ -> ()
+      end
+    ) entries
+  in
+  walk "";
+  Digest.string (Buffer.contents buf)
+
+(** Cache key of every node of [p], or [] when no project root was found
+    (the sources would then be the whole filesystem). A node's key changes
+    when its derivation text, the pipeline-wide build inputs, the project
+    sources or any upstream key change. *)
+let node_keys ?(root = get_project_root ()) (p : Ast.pipeline_result) : (string * string) list =
+  if Filename.dirname root = root then []
+  else begin
+    let has_julia, has_pmml = Nix_emit_pipeline.runtime_flags p in
+    let global =
+      String.concat "\000"
+        [ key_version; source_digest root; string_of_bool has_julia; string_of_bool has_pmml ]
+    in
+    let import_lines = Nix_emit_pipeline.import_lines p in
+    let keys = Hashtbl.create (List.length p.p_exprs) in
+    let rec key visiting (name, expr) =
+      match Hashtbl.find_opt keys name with
+      | Some k -> k
+      | None ->
+          let deps = match List.assoc_opt name p.p_deps with Some d -> d | None -> [] in
+          let dep_keys =
+            List.filter_map (fun d ->
+              match List.assoc_opt d p.p_exprs with
+              | Some dep_expr when not (List.mem d visiting) ->
+                  Some (d ^ "=" ^ key (name :: visiting) (d, dep_expr))
+              | _ -> None
+            ) deps
+          in
+          let text = Nix_emit_pipeline.emit_pipeline_node p import_lines (name, expr) in
+          let k = Digest.to_hex (Digest.string (String.concat "\000" (global :: text :: dep_keys))) in
+          Hashtbl.replace keys name k;
+          k
+    in
+    List.map (fun (name, expr) -> (name, key [] (name, expr))) p.p_exprs
+  end
+
+(** Recorded entries: node name -> (key, store path). *)
+let load () : (string, string * string) Hashtbl.t =
+  let entries = Hashtbl.create 64 in
+  (if Sys.file_exists cache_path then
+     try
+       let open Yojson.Safe.Util in
+       let json = Yojson.Safe.from_file cache_path in
+       List.iter (fun (name, entry) ->
+         Hashtbl.replace entries name
+           (entry |> member "key" |> to_string, entry |> member "path" |> to_string)
+       ) (json |> member "nodes" |> to_assoc)
+     with _ -> Hashtbl.reset entries);
+  entries
+
+(** Split [wanted] into the nodes whose recorded entry has the same key and
+    a store path that still exists, paired with that path, and the nodes
+    that must be rebuilt. A key covers every upstream key, so the stale
+    nodes include each wanted descendant of a changed node. With no keys
+    every node is stale. *)
+let partition (keys : (string * string) list) (wanted : string list)
+    : (string * string) list * string list =
+  let entries = if keys = [] then Hashtbl.create 1 else load () in
+  List.fold_right (fun name (hits, stale) ->
+    match List.assoc_opt name keys, Hashtbl.find_opt entries name with
+    | Some key, Some (recorded, path) when key = recorded && Sys.file_exists path ->
+        ((name, path) :: hits, stale)
+    | _ -> (hits, name :: stale)
+  ) wanted ([], [])
+
+(** Store paths of [wanted] when every one of them has a recorded entry
+    with the same key whose path still exists, otherwise [None]. *)
+let unchanged (keys : (string * string) list) (wanted : string list) : (string * string) list option =
+  if keys = [] || wanted = [] then None
+  else
+    match partition keys wanted with
+    | hits, [] -> Some hits
+    | _ -> None
+
+(** Record the store paths of freshly built nodes under their keys, keeping
+    entries of nodes this build did not cover. Best effort: a cache that
+    cannot be written only costs the next build a Nix evaluation. *)
+let record (keys : (string * string) list) (built : (string * string) list) =
+  if keys <> [] && built <> [] then begin
+    let entries = load () in
+    List.iter (fun (name, path) ->
+      match List.assoc_opt name keys with
+      | Some key -> Hashtbl.replace entries name (key, path)
+      | None -> ()
+    ) built;
+    let nodes =
+      Hashtbl.fold (fun name (key, path) acc ->
+        (name, Serialization.json_dict [
+          ("key", "\"" ^ Serialization.json_escape key ^ "\"");
+          ("path", "\"" ^ Serialization.json_escape path ^ "\"");
+        ]) :: acc
+      ) entries []
+      |> List.sort compare
+    in
+    let json =
+      Serialization.json_dict [
+        ("version", "\"" ^ key_version ^ "\"");
+        ("nodes", Serialization.json_dict nodes);
+      ] ^ "\n"
+    in
+    let tmp = cache_path ^ ".tmp" in
+    match write_file tmp json with
+    | Ok () -> (try Sys.rename tmp cache_path with Sys_error _ -> ())
+    | Error _ -> ()
+  end
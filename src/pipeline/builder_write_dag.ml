@@ -14,3 +14,45 @@ let write_dag (p : Ast.pipeline_result) =
   in
   let dag_json = "[\n" ^ (String.concat ",\n" nodes_json) ^ "\n]\n" in
   write_file dag_path dag_json
+
+(** Depth of each node in the DAG: 0 for nodes without in-pipeline
+    dependencies, otherwise one more than the deepest dependency. Nodes at
+    the same depth never depend on each other, so they can build together.
+    Dependencies outside the pipeline do not add a level. *)
+let dag_levels (p : Ast.pipeline_result) : (string * int) list =
+  let names = List.map fst p.p_exprs in
+  let local_deps =
+    List.map (fun name ->
+      let deps = match List.assoc_opt name p.p_deps with Some d -> d | None -> [] in
+      (name, List.filter (fun d -> List.mem d names) deps)
+    ) names
+  in
+  Pipeline_to_frame.compute_depths local_deps
+
+(** [targets] and every node they depend on, in pipeline order; all nodes
+    when [targets] is empty. *)
+let dag_closure ?(targets = []) (p : Ast.pipeline_result) : string list =
+  let names = List.map fst p.p_exprs in
+  if targets = [] then names
+  else begin
+    let seen = Hashtbl.create 16 in
+    let rec visit name =
+      if not (Hashtbl.mem seen name) && List.mem name names then begin
+        Hashtbl.replace seen name ();
+        List.iter visit (match List.assoc_opt name p.p_deps with Some d -> d | None -> [])
+      end
+    in
+    List.iter visit targets;
+    List.filter (Hashtbl.mem seen) names
+  end
+
+(** Largest number of nodes sharing a depth among [dag_closure ~targets p]:
+    how many node derivations can usefully build at once. *)
+let dag_width ?targets (p : Ast.pipeline_result) : int =
+  let levels = dag_levels p in
+  let counts = Hashtbl.create 16 in
+  List.iter (fun name ->
+    let l = List.assoc name levels in
+    Hashtbl.replace counts l (1 + Option.value ~default:0 (Hashtbl.find_opt counts l))
+  ) (dag_closure ?targets p);
+  Hashtbl.fold (fun _ n acc -> max n acc) counts 0
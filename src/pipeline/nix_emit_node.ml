@@ -526,7 +526,8 @@ def deserialize(path):
 
   let t_arrow_r_code = {|
 r_write_arrow <- function(object, path) {
-  arrow::write_ipc_file(as.data.frame(object), path)
+  # Uncompressed, so readers can map the buffers straight from the store.
+  arrow::write_ipc_file(as.data.frame(object), path, compression = "uncompressed")
 }
 r_read_arrow <- function(path) {
   arrow::read_ipc_file(path)
@@ -560,7 +561,9 @@ def py_write_arrow(df, path):
             writer.write_table(table)
 
 def py_read_arrow(path):
-    with pa.OSFile(path, 'rb') as f:
+    # Map the artifact instead of reading it onto the heap; the pages are
+    # shared with every other reader of the same store path.
+    with pa.memory_map(path, 'r') as f:
         return ipc.open_file(f).read_pandas()
 |} in
 
@@ -2811,7 +2814,12 @@ EOF
              @ dep_env @ node_env)
         in
         Printf.sprintf "%s %s > $out/artifact\n      echo ShellOutput > $out/class" hermetic_env launcher
-    | _ -> "t run --unsafe --mode repl node_script.t"
+    | _ ->
+        (* A profiled build writes each T node's trace next to its artifact,
+           where the build log picks it up. *)
+        if !Profiler.enabled then
+          "TLANG_PROFILE_OUT=$out/profile.json t run --unsafe --mode repl node_script.t"
+        else "t run --unsafe --mode repl node_script.t"
   in
 
   Printf.sprintf {|
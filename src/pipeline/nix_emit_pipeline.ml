@@ -2,36 +2,33 @@ open Ast
 open Nix_unparse
 open Nix_emit_node
 
-let emit_pipeline ?(rel_root="..") (p : Ast.pipeline_result) =
-  let import_lines = List.filter_map (fun stmt ->
+(** Import statements emitted into every T node script. *)
+let import_lines (p : Ast.pipeline_result) =
+  List.filter_map (fun stmt ->
     let s = unparse_import_stmt stmt in
     if s = "" then None else Some s
-  ) p.p_imports in
+  ) p.p_imports
+
+(** The derivation text of one node of [p]. *)
+let emit_pipeline_node (p : Ast.pipeline_result) import_lines (name, expr) =
   let node_names = List.map fst p.p_exprs in
+  let deps = match List.assoc_opt name p.p_deps with Some d -> d | None -> [] in
+  let runtime = match List.assoc_opt name p.p_runtimes with Some r -> r | None -> "T" in
+  let serializer = match List.assoc_opt name p.p_serializers with Some s -> s | None -> Ast.mk_expr (Ast.Var "default") in
+  let deserializer = match List.assoc_opt name p.p_deserializers with Some d -> d | None -> Ast.mk_expr (Ast.Var "default") in
+  let env_vars = match List.assoc_opt name p.p_env_vars with Some vars -> vars | None -> [] in
+  let runtime_args = match List.assoc_opt name p.p_args with Some args -> args | None -> [] in
+  let functions = match List.assoc_opt name p.p_functions with Some f -> f | None -> [] in
+  let includes = match List.assoc_opt name p.p_includes with Some f -> f | None -> [] in
+  let noop = match List.assoc_opt name p.p_noops with Some b -> b | None -> false in
+  let script = match List.assoc_opt name p.p_scripts with Some s -> s | None -> None in
+  let shell = match List.assoc_opt name p.p_shells with Some s -> s | None -> None in
+  let shell_args = match List.assoc_opt name p.p_shell_args with Some args -> args | None -> [] in
+  emit_node (name, expr) deps node_names import_lines runtime serializer deserializer env_vars runtime_args functions includes noop script shell shell_args
 
-  let nodes =
-    p.p_exprs
-    |> List.map (fun (name, expr) ->
-      let deps = match List.assoc_opt name p.p_deps with Some d -> d | None -> [] in
-      let runtime = match List.assoc_opt name p.p_runtimes with Some r -> r | None -> "T" in
-      let serializer = match List.assoc_opt name p.p_serializers with Some s -> s | None -> Ast.mk_expr (Ast.Var "default") in
-      let deserializer = match List.assoc_opt name p.p_deserializers with Some d -> d | None -> Ast.mk_expr (Ast.Var "default") in
-      let env_vars = match List.assoc_opt name p.p_env_vars with Some vars -> vars | None -> [] in
-      let runtime_args = match List.assoc_opt name p.p_args with Some args -> args | None -> [] in
-      let functions = match List.assoc_opt name p.p_functions with Some f -> f | None -> [] in
-      let includes = match List.assoc_opt name p.p_includes with Some f -> f | None -> [] in
-      let noop = match List.assoc_opt name p.p_noops with Some b -> b | None -> false in
-      let script = match List.assoc_opt name p.p_scripts with Some s -> s | None -> None in
-      let shell = match List.assoc_opt name p.p_shells with Some s -> s | None -> None in
-      let shell_args = match List.assoc_opt name p.p_shell_args with Some args -> args | None -> [] in
-      emit_node (name, expr) deps node_names import_lines runtime serializer deserializer env_vars runtime_args functions includes noop script shell shell_args)
-    |> String.concat "\n"
-  in
-  let final_copy =
-    node_names
-    |> List.map (fun n -> Printf.sprintf "      cp -r ${%s} $out/%s" n n)
-    |> String.concat "\n"
-  in
+(** Whether any node runs Julia and whether any node reads or writes PMML;
+    both change the build inputs shared by every node. *)
+let runtime_flags (p : Ast.pipeline_result) =
   let has_julia = List.exists (fun (name, _) ->
     let runtime = match List.assoc_opt name p.p_runtimes with Some r -> r | None -> "T" in
     runtime = "Julia"
@@ -41,6 +38,25 @@ let emit_pipeline ?(rel_root="..") (p : Ast.pipeline_result) =
     let des = match List.assoc_opt name p.p_deserializers with Some d -> d | None -> Ast.mk_expr (Ast.Var "default") in
     is_pmml_ser ser || is_pmml_des des
   ) p.p_exprs in
+  (has_julia, has_pmml)
+
+let emit_pipeline ?(rel_root="..") (p : Ast.pipeline_result) =
+  let import_lines = import_lines p in
+  let node_names = List.map fst p.p_exprs in
+
+  let nodes =
+    p.p_exprs
+    |> List.map (emit_pipeline_node p import_lines)
+    |> String.concat "\n"
+  in
+  (* Link rather than copy: node outputs are already immutable store paths,
+     and readers map artifacts in place through the link. *)
+  let final_copy =
+    node_names
+    |> List.map (fun n -> Printf.sprintf "      ln -s ${%s} $out/%s" n n)
+    |> String.concat "\n"
+  in
+  let has_julia, has_pmml = runtime_flags p in
   let julia_build_input = if has_julia && has_pmml then "\n                      ++ [ juliaPkg pkgs.gcc.cc.lib pkgs.avahi ]" 
                           else if has_julia then "\n                      ++ [ juliaPkg ]"
                           else "" in
@@ -12,7 +12,8 @@ let history_file =
 
 let max_history_length = 1000
 
-let () =
+(* Loaded when the interactive REPL starts, not by every `t run`. *)
+let load_history () =
   ignore (LNoise.history_set ~max_length:max_history_length);
   ignore (LNoise.history_load ~filename:history_file)
 
@@ -43,16 +44,26 @@ let interrupt_error () =
     na_count = 0;
   }
 
-let parse_and_eval ?filename ?(failfast=false) mode env input =
+(** Parse and check [input] from [lexbuf]. With [cached], scripts go through
+    Script_cache so an unchanged file is not lexed, parsed or checked again. *)
+let compile_source ?filename ?(cached=false) mode lexbuf input =
+  let compile () =
+    let program = Parser.program Lexer.token lexbuf in
+    { Script_cache.program; check = Typecheck.validate_program ~mode program }
+  in
+  if cached then Script_cache.find_or_add ?filename ~mode input compile
+  else compile ()
+
+let parse_and_eval ?filename ?(failfast=false) ?cached mode env input =
   let lexbuf = Lexing.from_string input in
   (match filename with
    | Some file -> lexbuf.lex_curr_p <- { lexbuf.lex_curr_p with pos_fname = file }
    | None -> ());
   try
-    let program = Parser.program Lexer.token lexbuf in
-    match Typecheck.validate_program ~mode program with
+    let compiled = compile_source ?filename ?cached mode lexbuf input in
+    match compiled.Script_cache.check with
     | Error err -> (Ast.VError err, env)
-    | Ok () -> Eval.eval_program ~resilient:(not failfast) program env
+    | Ok () -> Eval.eval_program ~resilient:(not failfast) compiled.Script_cache.program env
   with
   | Lexer.SyntaxError msg ->
       let pos = Lexing.lexeme_start_p lexbuf in
@@ -68,7 +79,7 @@ let run_file ?failfast mode filename env =
     let ch = open_in filename in
     let content = really_input_string ch (in_channel_length ch) in
     close_in ch;
-    parse_and_eval ~filename ?failfast mode env content
+    parse_and_eval ~filename ?failfast ~cached:true mode env content
   with
   | Sys_error msg ->
       (Ast.VError {
@@ -334,6 +345,7 @@ let rec value_summary v =
   | Ast.VQuo { q_expr; _ } -> "Quosure(" ^ Ast.Utils.unparse_expr q_expr ^ ")"
   | Ast.VComputedNode cn -> Printf.sprintf "computed_node<%s>" cn.cn_runtime
   | Ast.VSerializer s -> Printf.sprintf "serializer<^%s>" s.s_format
+  | Ast.VLazyFrame lf -> Printf.sprintf "LazyFrame(%d steps)" (List.length lf.Ast.lf_steps)
   | Ast.VNode un -> Printf.sprintf "node<%s>" un.un_runtime
   | Ast.VNullNode -> "<null>"
   | Ast.VPattern _ -> "Pattern"
@@ -591,7 +603,6 @@ let resolve_pipeline_from_program_result filename (program : Ast.program) result
                filename (String.concat ", " (List.map fst bindings)))
 
 let cmd_artifact_transfer action filename archive_path env =
-  Packages.ensure_docs_loaded ();
   ensure_file_path filename;
   match parse_program_from_file filename with
   | Error err ->
@@ -659,7 +670,6 @@ let flush_warnings_to_out () =
   | None -> ()
 
 let cmd_run ?(unsafe=false) ?failfast mode filename env =
-  Packages.ensure_docs_loaded ();
   ensure_file_path filename;
   if not unsafe then begin
     try
@@ -667,8 +677,11 @@ let cmd_run ?(unsafe=false) ?failfast mode filename env =
       let content = really_input_string ch (in_channel_length ch) in
       close_in ch;
       let lexbuf = Lexing.from_string content in
+      lexbuf.lex_curr_p <- { lexbuf.lex_curr_p with pos_fname = filename };
       (try
-        let program = Parser.program Lexer.token lexbuf in
+        (* Shares the script cache with run_file below, so the script is
+           parsed at most once. *)
+        let { Script_cache.program; _ } = compile_source ~filename ~cached:true mode lexbuf content in
         if not (program_has_build_pipeline program) then begin
           Printf.eprintf "Error: non-interactive execution requires a pipeline.\n";
           Printf.eprintf "Use --unsafe to override.\n";
@@ -686,7 +699,6 @@ let cmd_run ?(unsafe=false) ?failfast mode filename env =
   | v -> print_string (Pretty_print.pretty_print_value v)
 
 let cmd_run_expr ?failfast mode expr env =
-  Packages.ensure_docs_loaded ();
   let (result, _) = parse_and_eval ?failfast mode env expr in
   flush_warnings_to_out ();
   match result with
@@ -697,7 +709,6 @@ let cmd_run_expr ?failfast mode expr env =
 
 let cmd_debug ?(unsafe=false) ?failfast mode filename node_name env =
   let _ = unsafe in
-  Packages.ensure_docs_loaded ();
   ensure_file_path filename;
   let (result, new_env) = run_file ?failfast mode filename env in
   match result with
@@ -764,7 +775,6 @@ let cmd_init_project args =
       | Error msg -> Printf.eprintf "Error: %s\n" msg; exit 1
 
 let cmd_explain ?failfast mode rest env =
-  Packages.ensure_docs_loaded ();
   let expr_str = String.concat " " (List.filter (fun s -> s <> "--json") rest) in
   if expr_str = "" then (Printf.eprintf "Usage: t explain <expr>\n"; exit 1)
   else begin
@@ -846,6 +856,9 @@ let cmd_doc args =
   let do_gen = List.mem "--generate" args || args = [] in
   let dir = Sys.getcwd () in
   let src_dir = Filename.concat dir "src" in
+  (* Documentation is rebuilt from the sources alone, not merged into the
+     installed docs.json. *)
+  Tdoc_registry.set_loader ignore;
   if do_parse then begin
     List.iter (fun f -> List.iter Tdoc_registry.register (Tdoc_parser.parse_file f)) (recursive_files src_dir);
     let help_dir = Filename.concat dir "help" in
@@ -971,6 +984,7 @@ let write_vars_csv env =
   | _ -> ()
 
 let cmd_repl ?failfast mode env =
+  load_history ();
   Packages.ensure_docs_loaded ();
   
   (* Track base environment keys to filter %objects *)
@@ -1178,6 +1192,7 @@ let () =
   (match Cli_args.validate_cli_flags ~mode_flag:mode_parse.mode_flag ~unsafe_flag:unsafe ~failfast_flag:failfast args with
    | Ok () -> ()
    | Error msg -> exit_with_error msg);
+  Packages.install_docs_loader ();
   let env = Packages.init_env () in
   (* Register interactive CLI wrappers — must be here (not in packages.ml)
      to avoid dependency cycles with Test_discovery *)
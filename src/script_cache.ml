@@ -0,0 +1,121 @@
+(* src/script_cache.ml *)
+(* Content-addressed cache of parsed and checked T scripts.               *)
+(* A script is keyed on its text, file name, checking mode and the `t`     *)
+(* binary itself; the parsed program and the outcome of                    *)
+(* Typecheck.validate_program are marshalled to                            *)
+(* TLANG_CACHE_DIR (default $XDG_CACHE_HOME/tlang/scripts, else            *)
+(* ~/.cache/tlang/scripts). A hit skips the lexer, parser and checker.     *)
+(* TLANG_SCRIPT_CACHE=0 turns the disk cache off. Inside a Nix build only  *)
+(* an explicit TLANG_CACHE_DIR is used: builders point HOME at the build   *)
+(* directory, which is thrown away, so an entry written there is never     *)
+(* read and only costs the run the time to write it.                       *)
+
+type entry = {
+  program : Ast.program;
+  check : (unit, Ast.error_info) result;
+}
+
+let header = "TLANG-SCRIPT-CACHE-1\n"
+
+let enabled () =
+  match Sys.getenv_opt "TLANG_SCRIPT_CACHE" with
+  | Some v -> not (List.mem (String.lowercase_ascii (String.trim v)) ["0"; "false"; "off"; "no"])
+  | None -> true
+
+let cache_dir () =
+  let nonempty = function Some d when String.trim d <> "" -> Some d | _ -> None in
+  match nonempty (Sys.getenv_opt "TLANG_CACHE_DIR") with
+  | Some d -> Some d
+  | None when nonempty (Sys.getenv_opt "NIX_BUILD_TOP") <> None -> None
+  | None ->
+      match nonempty (Sys.getenv_opt "XDG_CACHE_HOME") with
+      | Some d -> Some (Filename.concat (Filename.concat d "tlang") "scripts")
+      | None ->
+          Option.map (fun home -> List.fold_left Filename.concat home [".cache"; "tlang"; "scripts"])
+            (nonempty (Sys.getenv_opt "HOME"))
+
+(* The marshalled AST is only meaningful to the binary that wrote it, and a
+   development build can change the AST without a version bump, so the key
+   covers the executable's identity as well as the version. *)
+let binary_id : string Lazy.t =
+  lazy (
+    let exe = try Unix.readlink "/proc/self/exe" with Unix.Unix_error _ -> Sys.executable_name in
+    match Unix.stat exe with
+    | st -> Printf.sprintf "%s:%d:%d:%.0f" exe st.Unix.st_ino st.Unix.st_size st.Unix.st_mtime
+    | exception Unix.Unix_error _ -> exe)
+
+let key ?(filename = "") ~(mode : Typecheck.mode) (source : string) : string =
+  let mode = match mode with Typecheck.Repl -> "repl" | Typecheck.Strict -> "strict" in
+  Digest.to_hex (Digest.string (String.concat "\000"
+    [header; Version.version; Lazy.force binary_id; mode; filename; source]))
+
+let path_of_key k = Option.map (fun dir -> Filename.concat dir (k ^ ".ast")) (cache_dir ())
+
+(** Where the entry for this script lives, None when there is no cache directory. *)
+let entry_path ?filename ~mode source = path_of_key (key ?filename ~mode source)
+
+(* Entries already seen by this process, so several passes over one script
+   (the pipeline check in `t run`, then the run itself) parse it once. *)
+let memo : (string, entry) Hashtbl.t = Hashtbl.create 8
+
+(** Scripts served from the disk cache and compiled since startup. *)
+let hits = ref 0
+let misses = ref 0
+
+let read_entry path : entry option =
+  match open_in_bin path with
+  | exception Sys_error _ -> None
+  | ic ->
+      Fun.protect ~finally:(fun () -> close_in_noerr ic) (fun () ->
+        try
+          let hlen = String.length header in
+          if really_input_string ic hlen <> header then None
+          else
+            let digest = input_line ic in
+            let payload = really_input_string ic (in_channel_length ic - pos_in ic) in
+            if Digest.to_hex (Digest.string payload) <> digest then None
+            else Some (Marshal.from_string payload 0 : entry)
+        with End_of_file | Failure _ | Sys_error _ -> None)
+
+let rec ensure_dir d =
+  if not (Sys.file_exists d) then begin
+    ensure_dir (Filename.dirname d);
+    (try Unix.mkdir d 0o755 with Unix.Unix_error (Unix.EEXIST, _, _) -> ())
+  end
+
+(* Written to a temporary name and renamed, so concurrent runs of the same
+   script never see a partial entry. *)
+let write_entry path (e : entry) =
+  try
+    let payload = Marshal.to_string e [] in
+    ensure_dir (Filename.dirname path);
+    let tmp = Printf.sprintf "%s.%d.tmp" path (Unix.getpid ()) in
+    let oc = open_out_bin tmp in
+    Fun.protect ~finally:(fun () -> close_out_noerr oc) (fun () ->
+      output_string oc header;
+      output_string oc (Digest.to_hex (Digest.string payload));
+      output_char oc '\n';
+      output_string oc payload);
+    Unix.rename tmp path
+  with Invalid_argument _ | Sys_error _ | Unix.Unix_error _ -> ()
+
+(** The cached entry for [source], or the result of [compile ()], which is
+    then stored. Exceptions from [compile] (syntax errors) propagate and
+    nothing is cached for them. *)
+let find_or_add ?filename ~mode (source : string) (compile : unit -> entry) : entry =
+  let k = key ?filename ~mode source in
+  match Hashtbl.find_opt memo k with
+  | Some e -> e
+  | None ->
+      let path = if enabled () then path_of_key k else None in
+      let e =
+        match Option.bind path read_entry with
+        | Some e -> incr hits; e
+        | None ->
+            let e = compile () in
+            incr misses;
+            Option.iter (fun p -> write_entry p e) path;
+            e
+      in
+      Hashtbl.replace memo k e;
+      e
@@ -294,6 +294,7 @@ let rec value_to_yojson (v : Ast.value) : Yojson.Safe.t =
   | VFactor _ | VSerializer _ | VBuildLog _ | VPattern _ ->
       invalid_arg "value_to_yojson: VFactor/VSerializer/VBuildLog/VPattern is not supported for JSON serialization"
   | VNullNode -> `Null
+  | VLazyFrame lf -> value_to_yojson (!Ast.lazy_frame_collect_resolver lf)
   | VUnquote _ | VUnquoteSplice _ | VDynamicArg _ | VQuo _ | VEnv _ ->
       invalid_arg "value_to_yojson: metaprogramming intermediate values are not serializable"
   | VLens l ->
@@ -502,6 +503,12 @@ let read_verror_json path =
 let serialize_to_file path value =
   try
     ensure_parent_dir path;
+    (* A lazy frame holds builtins and closures; only its result is stored. *)
+    let value =
+      match value with
+      | Ast.VLazyFrame lf -> !Ast.lazy_frame_collect_resolver lf
+      | v -> v
+    in
     let payload = Marshal.to_bytes value [] in
     let digest = Digest.bytes payload in
     let hex = Digest.to_hex digest in
@@ -0,0 +1,357 @@
+(* src/sketch.ml *)
+(* Mergeable streaming sketches behind the approximate summary functions: *)
+(* HyperLogLog distinct counts, KLL quantiles and count-min heavy hitters. *)
+(* A sketch can be built per chunk or per worker and the pieces merged;   *)
+(* the merged sketch answers as if it had seen every value itself.        *)
+
+open Ast
+
+(* --- Hashing --- *)
+
+let mix64 x =
+  let open Int64 in
+  let x = logxor x (shift_right_logical x 33) in
+  let x = mul x 0xff51afd7ed558ccdL in
+  let x = logxor x (shift_right_logical x 33) in
+  let x = mul x 0xc4ceb9fe1a85ec53L in
+  logxor x (shift_right_logical x 33)
+
+(* FNV-1a over the bytes, remixed for well-spread high bits. *)
+let string_hash s =
+  let h = ref 0xcbf29ce484222325L in
+  String.iter (fun c ->
+    h := Int64.mul (Int64.logxor !h (Int64.of_int (Char.code c))) 0x100000001b3L) s;
+  mix64 !h
+
+(** 64-bit hash of a value. Values equal under {!Value_hash.ValueHash}
+    hash equally; each type is salted so that [1], [1.0] and [true] stay
+    distinct, as they do for [n_distinct]. All NAs hash alike. The native
+    distinct-count kernel computes the same hash ([sketch_value_hash] in
+    arrow_stubs.c), so both paths fill identical registers; keep the two
+    in step. *)
+let hash_value (v : value) : int64 =
+  match v with
+  | VInt n -> mix64 (Int64.of_int n)
+  | VFloat f ->
+      let bits =
+        if Float.is_nan f then 0x7ff8000000000000L
+        else if f = 0.0 then 0L
+        else Int64.bits_of_float f
+      in
+      mix64 (Int64.logxor bits 0x5851f42d4c957f2dL)
+  | VString s -> string_hash s
+  | VBool b -> mix64 (Int64.logxor (if b then 1L else 0L) 0x2545f4914f6cdd1dL)
+  | VDate d -> mix64 (Int64.logxor (Int64.of_int d) 0x3c6ef372fe94f82bL)
+  | VFactor (i, levels, _) ->
+      (match List.nth_opt levels i with
+       | Some level -> string_hash level
+       | None -> mix64 (Int64.of_int (Hashtbl.hash v)))
+  | VNA _ -> 0x5bd1e9955bd1e995L
+  | v -> mix64 (Int64.of_int (Hashtbl.hash v))
+
+(* --- Building in slices --- *)
+
+(** Inputs are cut into slices of at least this many values. *)
+let slice_min = 1 lsl 16
+
+let max_slices = 8
+
+(** [build ~create ~add ~merge values] sketches [values] one slice at a
+    time and merges the slice sketches in order. The slices depend only on
+    the input length, so the result is the same whether they run on one
+    domain or, when more are available, one domain each. Short inputs are
+    a single slice. *)
+let build ~create ~add ~merge (values : 'a array) =
+  let n = Array.length values in
+  let slices = max 1 (min max_slices (n / slice_min)) in
+  let step = (n + slices - 1) / slices in
+  let sketch_slice s () =
+    let sk = create () in
+    for i = s * step to min n ((s + 1) * step) - 1 do add sk values.(i) done;
+    sk
+  in
+  if slices = 1 then sketch_slice 0 ()
+  else begin
+    let parts =
+      if Domain.recommended_domain_count () > 1 then
+        let spawned = List.init (slices - 1) (fun s -> Domain.spawn (sketch_slice (s + 1))) in
+        let first = sketch_slice 0 () in
+        first :: List.map Domain.join spawned
+      else List.init slices (fun s -> sketch_slice s ())
+    in
+    match parts with
+    | first :: rest -> List.fold_left merge first rest
+    | [] -> create ()
+  end
+
+(* --- HyperLogLog --- *)
+
+(** Distinct counts with 2^14 one-byte registers (standard error about
+    0.8%). The hash, precision, exact-count limit and estimator match the
+    native kernel in arrow_stubs.c. *)
+module Hll = struct
+  let precision = 14
+  let registers = 1 lsl precision
+
+  (** Inputs of at most this many values are counted exactly. *)
+  let exact_limit = 4096
+
+  type t = { reg : Bytes.t }
+
+  let create () = { reg = Bytes.make registers '\000' }
+
+  let add_hash t h =
+    let idx = Int64.to_int (Int64.shift_right_logical h (64 - precision)) in
+    let rest = ref (Int64.logor (Int64.shift_left h precision)
+                      (Int64.shift_left 1L (precision - 1))) in
+    let rank = ref 1 in
+    (* Count leading zeros: the top bit is set once [rest] is negative. *)
+    while Int64.compare !rest 0L > 0 do
+      rest := Int64.shift_left !rest 1;
+      incr rank
+    done;
+    if !rank > Char.code (Bytes.get t.reg idx) then
+      Bytes.set t.reg idx (Char.chr !rank)
+
+  let add t v = add_hash t (hash_value v)
+
+  (** Register-wise maximum: the sketch of both inputs together. *)
+  let merge a b =
+    { reg = Bytes.init registers (fun i ->
+        Char.chr (max (Char.code (Bytes.get a.reg i)) (Char.code (Bytes.get b.reg i)))) }
+
+  (** Raw estimate, with linear counting for small cardinalities. *)
+  let estimate t =
+    let m = float_of_int registers in
+    let sum = ref 0.0 in
+    let zeros = ref 0 in
+    Bytes.iter (fun c ->
+      let r = Char.code c in
+      sum := !sum +. ldexp 1.0 (- r);
+      if r = 0 then incr zeros) t.reg;
+    let e = 0.7213 /. (1.0 +. 1.079 /. m) *. m *. m /. !sum in
+    let e = if e <= 2.5 *. m && !zeros > 0 then m *. log (m /. float_of_int !zeros) else e in
+    int_of_float (Float.round e)
+end
+
+let exact_distinct (values : value array) =
+  let seen = Value_hash.ValueHash.create (max 1 (min 64 (Array.length values))) in
+  Array.iter (fun value -> Value_hash.ValueHash.replace seen value ()) values;
+  Value_hash.ValueHash.length seen
+
+(** Approximate number of distinct values, NA counted once. Exact for up
+    to {!Hll.exact_limit} values. *)
+let count_distinct (values : value array) : int =
+  if Array.length values <= Hll.exact_limit then exact_distinct values
+  else Hll.estimate (build ~create:Hll.create ~add:Hll.add ~merge:Hll.merge values)
+
+(* --- KLL quantiles --- *)
+
+(** Quantiles from a KLL sketch (Karnin, Lang and Liberty): a stack of
+    compactors where items at level [h] stand for [2^h] inputs. A full
+    level is sorted and every other item, from a random offset, moves up a
+    level. Capacities shrink by 2/3 per level below the top, so the sketch
+    holds O(k) items and ranks are off by about 1.7/k of the input size.
+    The random offsets come from a fixed seed, so results are repeatable. *)
+module Kll = struct
+  let default_k = 200
+
+  type level = { mutable items : float array; mutable len : int }
+
+  type t = {
+    k : int;
+    mutable levels : level array;
+    mutable n : int;
+    mutable lo : float;
+    mutable hi : float;
+    rng : Random.State.t;
+  }
+
+  let new_level () = { items = Array.make 8 0.0; len = 0 }
+
+  let create ?(k = default_k) () =
+    { k = max 8 k; levels = [| new_level () |]; n = 0;
+      lo = infinity; hi = neg_infinity; rng = Random.State.make [| 0x6b6c6c |] }
+
+  let push lvl x =
+    if lvl.len = Array.length lvl.items then begin
+      let grown = Array.make (2 * lvl.len) 0.0 in
+      Array.blit lvl.items 0 grown 0 lvl.len;
+      lvl.items <- grown
+    end;
+    lvl.items.(lvl.len) <- x;
+    lvl.len <- lvl.len + 1
+
+  let capacity t h =
+    let depth = Array.length t.levels - 1 - h in
+    max 2 (int_of_float (Float.ceil (float_of_int t.k *. ((2.0 /. 3.0) ** float_of_int depth))))
+
+  let retained t = Array.fold_left (fun acc l -> acc + l.len) 0 t.levels
+
+  let total_capacity t =
+    let acc = ref 0 in
+    for h = 0 to Array.length t.levels - 1 do acc := !acc + capacity t h done;
+    !acc
+
+  (* Halve level [h] into level [h + 1]; an odd item stays behind. *)
+  let compact t h =
+    if h = Array.length t.levels - 1 then
+      t.levels <- Array.append t.levels [| new_level () |];
+    let lvl = t.levels.(h) and up = t.levels.(h + 1) in
+    let items = Array.sub lvl.items 0 lvl.len in
+    Array.sort Float.compare items;
+    let paired = lvl.len land (lnot 1) in
+    let offset = if Random.State.bool t.rng then 1 else 0 in
+    let i = ref offset in
+    while !i < paired do
+      push up items.(!i);
+      i := !i + 2
+    done;
+    lvl.len <- 0;
+    if paired < Array.length items then push lvl items.(paired)
+
+  let rec compress t =
+    if retained t > total_capacity t then begin
+      let h = ref 0 in
+      while !h < Array.length t.levels - 1 && t.levels.(!h).len < capacity t !h do incr h done;
+      compact t !h;
+      compress t
+    end
+
+  let add t x =
+    push t.levels.(0) x;
+    t.n <- t.n + 1;
+    if x < t.lo then t.lo <- x;
+    if x > t.hi then t.hi <- x;
+    if t.levels.(0).len >= capacity t 0 then compress t
+
+  (** Stack the levels of both sketches and compact back to capacity. *)
+  let merge a b =
+    let depth = max (Array.length a.levels) (Array.length b.levels) in
+    let t = { (create ~k:(min a.k b.k) ()) with
+              levels = Array.init depth (fun _ -> new_level ());
+              n = a.n + b.n; lo = Float.min a.lo b.lo; hi = Float.max a.hi b.hi } in
+    let copy src =
+      Array.iteri (fun h l ->
+        for i = 0 to l.len - 1 do push t.levels.(h) l.items.(i) done) src.levels
+    in
+    copy a;
+    copy b;
+    compress t;
+    t
+
+  (** Quantile at probability [p]. Until the first compaction the sketch
+      holds every input and the answer is exact, interpolated like
+      [quantile()]; [p = 0] and [p = 1] always give the exact extremes. *)
+  let quantile t p =
+    if t.n = 0 then None
+    else if p <= 0.0 then Some t.lo
+    else if p >= 1.0 then Some t.hi
+    else if Array.length t.levels = 1 then begin
+      let xs = Array.sub t.levels.(0).items 0 t.levels.(0).len in
+      Array.sort Float.compare xs;
+      let h = p *. float_of_int (Array.length xs - 1) in
+      let lo = int_of_float (Float.floor h) in
+      let hi = min (lo + 1) (Array.length xs - 1) in
+      Some (xs.(lo) +. (h -. float_of_int lo) *. (xs.(hi) -. xs.(lo)))
+    end else begin
+      let weighted = ref [] in
+      Array.iteri (fun h l ->
+        let w = 1 lsl h in
+        for i = 0 to l.len - 1 do weighted := (l.items.(i), w) :: !weighted done) t.levels;
+      let sorted = List.sort (fun (a, _) (b, _) -> Float.compare a b) !weighted in
+      let total = List.fold_left (fun acc (_, w) -> acc + w) 0 sorted in
+      let target = p *. float_of_int total in
+      let rec walk acc = function
+        | [(x, _)] -> x
+        | (x, w) :: rest ->
+            let acc = acc + w in
+            if float_of_int acc >= target then x else walk acc rest
+        | [] -> t.hi
+      in
+      Some (walk 0 sorted)
+    end
+end
+
+(* --- Count-min heavy hitters --- *)
+
+(** Frequent values from a count-min sketch ([depth] rows of [width]
+    counters) plus a bounded set of candidate values. A value's estimate is
+    the smallest of its counters, which never undercounts and overcounts by
+    at most [2n/width] with probability [1 - 2^-depth]. Candidates are
+    pruned back to [capacity] by estimate; a value not yet tracked is
+    admitted once its estimate reaches the smallest one kept. *)
+module Count_min = struct
+  type t = {
+    width : int;
+    depth : int;
+    table : int array;
+    mutable total : int;
+    capacity : int;
+    candidates : unit Value_hash.ValueHash.t;
+    mutable floor : int;
+  }
+
+  let create ?(width = 2048) ?(depth = 4) ~capacity () =
+    { width; depth; table = Array.make (width * depth) 0; total = 0;
+      capacity = max 1 capacity;
+      candidates = Value_hash.ValueHash.create (max 16 capacity); floor = 0 }
+
+  (* Row [i] uses the double hash h1 + i * h2 of the value's 64-bit hash. *)
+  let slot t h i =
+    let h1 = Int64.to_int h land max_int in
+    let h2 = Int64.to_int (Int64.shift_right_logical h 32) lor 1 in
+    i * t.width + ((h1 + i * h2) land max_int) mod t.width
+
+  let estimate_hash t h =
+    let best = ref max_int in
+    for i = 0 to t.depth - 1 do
+      best := min !best t.table.(slot t h i)
+    done;
+    !best
+
+  let estimate t v = estimate_hash t (hash_value v)
+
+  let ranked t =
+    Value_hash.ValueHash.fold (fun v () acc -> (v, estimate t v) :: acc) t.candidates []
+    |> List.stable_sort (fun (_, a) (_, b) -> compare b a)
+
+  let prune t =
+    let kept = List.filteri (fun i _ -> i < t.capacity) (ranked t) in
+    Value_hash.ValueHash.reset t.candidates;
+    List.iter (fun (v, _) -> Value_hash.ValueHash.replace t.candidates v ()) kept;
+    t.floor <- (match List.rev kept with (_, est) :: _ -> est | [] -> 0)
+
+  let add t v =
+    let h = hash_value v in
+    let best = ref max_int in
+    for i = 0 to t.depth - 1 do
+      let s = slot t h i in
+      t.table.(s) <- t.table.(s) + 1;
+      best := min !best t.table.(s)
+    done;
+    t.total <- t.total + 1;
+    if !best >= t.floor && not (Value_hash.ValueHash.mem t.candidates v) then begin
+      Value_hash.ValueHash.replace t.candidates v ();
+      if Value_hash.ValueHash.length t.candidates > 2 * t.capacity then prune t
+    end
+
+  (** Merge two sketches of the same dimensions. Counters add up; the
+      candidates are the union of both sets, pruned back to capacity. *)
+  let merge a b =
+    if a.width <> b.width || a.depth <> b.depth then
+      invalid_arg "Sketch.Count_min.merge: sketches have different dimensions";
+    let t = create ~width:a.width ~depth:a.depth ~capacity:(max a.capacity b.capacity) () in
+    Array.iteri (fun i c -> t.table.(i) <- c + b.table.(i)) a.table;
+    t.total <- a.total + b.total;
+    let union src = Value_hash.ValueHash.iter (fun v () ->
+      Value_hash.ValueHash.replace t.candidates v ()) src.candidates in
+    union a;
+    union b;
+    if Value_hash.ValueHash.length t.candidates > t.capacity then prune t;
+    t
+
+  (** The [k] most frequent candidates with their estimated counts, most
+      frequent first. *)
+  let top t k = List.filteri (fun i _ -> i < k) (ranked t)
+end
@@ -3,17 +3,47 @@
 
 (** Inverse CDF (Percent-point function) of the standard normal distribution.
     Uses a rational approximation (Beasley-Springer-Moro or similar). *)
-external normal_quantile : float -> float = "caml_stats_normal_quantile"
+external normal_quantile : (float [@unboxed]) -> (float [@unboxed])
+  = "caml_stats_normal_quantile" "caml_stats_normal_quantile_unboxed" [@@noalloc]
 
 (** Inverse CDF (Percent-point function) of Student's t distribution.
-    p: cumulative probability (0 < p < 1), df: degrees of freedom (df > 0). *)
-external t_quantile : float -> int -> float = "caml_stats_t_quantile"
+    p: cumulative probability (0 < p < 1), df: degrees of freedom (df > 0).
+    Exact up to the precision of the incomplete beta function. *)
+external t_quantile : (float [@unboxed]) -> (int [@untagged]) -> (float [@unboxed])
+  = "caml_stats_t_quantile" "caml_stats_t_quantile_unboxed" [@@noalloc]
 
-let t_quantile_fun = ref (fun p df -> t_quantile p df)
+(** Distributions with native CDF, density and quantile kernels. The
+    constructor order matches the DIST_* enums in stats_stubs.c. *)
+type dist = Normal | Student_t | Chi_squared | Fisher_f
 
-(** Unified quantile function. Use t-distribution if df is provided, 
+type dist_fn = Cdf | Density | Quantile
+
+type float_buffer = (float, Bigarray.float64_elt, Bigarray.c_layout) Bigarray.Array1.t
+
+(** [dist_scalar d fn x a b] evaluates [fn] of distribution [d] at [x].
+    [a] and [b] are (mean, sd) for [Normal], (df, unused) for [Student_t]
+    and [Chi_squared], and (df1, df2) for [Fisher_f]. *)
+external dist_scalar :
+  dist -> dist_fn -> (float [@unboxed]) -> (float [@unboxed]) -> (float [@unboxed]) -> (float [@unboxed])
+  = "caml_stats_dist_byte" "caml_stats_dist" [@@noalloc]
+
+(** [dist_array d fn [|a; b|] xs out] is [dist_scalar] over every element
+    of [xs], in one call outside the runtime lock. NaN maps to NaN. *)
+external dist_array : dist -> dist_fn -> float array -> float_buffer -> float_buffer -> unit
+  = "caml_stats_dist_array"
+
+(** [dist_map d fn a b xs] applies [dist_array] to a float array. *)
+let dist_map d fn a b (xs : float array) =
+  let n = Array.length xs in
+  let input = Bigarray.Array1.create Bigarray.float64 Bigarray.c_layout n in
+  Array.iteri (fun i x -> input.{i} <- x) xs;
+  let out = Bigarray.Array1.create Bigarray.float64 Bigarray.c_layout n in
+  dist_array d fn [| a; b |] input out;
+  Array.init n (fun i -> out.{i})
+
+(** Unified quantile function. Use t-distribution if df is provided,
     otherwise fall back to normal distribution. *)
 let quantile p df_opt =
   match df_opt with
-  | Some df -> !t_quantile_fun p df
+  | Some df -> t_quantile p df
   | None -> normal_quantile p
@@ -5,10 +5,30 @@ open Tdoc_types
 
 let registry : (string, doc_entry) Hashtbl.t = Hashtbl.create 100
 
-(** Register a documentation entry in the in-memory registry.
+(* The standard documentation is loaded on first use rather than at
+   startup, so commands that never consult it do not parse docs.json. *)
+let loader : (unit -> unit) ref = ref (fun () -> ())
+let loaded = ref false
+
+(** Install the function that fills the registry the first time it is read.
+    
+    @param f Loads the standard documentation, usually from docs.json. *)
+let set_loader f =
+  loader := f;
+  loaded := false
+
+let ensure_loaded () =
+  if not !loaded then begin
+    loaded := true;
+    !loader ()
+  end
+
+(** Register a documentation entry in the in-memory registry. The standard
+    documentation is loaded first, so explicitly registered entries win.
     
     @param entry The doc_entry to add or update. *)
 let register entry =
+  ensure_loaded ();
   Hashtbl.replace registry entry.name entry
 
 (** Search the registry for a documentation entry by its function or symbol name.
@@ -16,12 +36,14 @@ let register entry =
     @param name The name of the symbol to find.
     @return [Some doc_entry] if found, otherwise [None]. *)
 let lookup name =
+  ensure_loaded ();
   Hashtbl.find_opt registry name
 
 (** Retrieve all registered documentation entries from the registry.
     
     @return A list of all registered doc_entry records. *)
 let get_all () =
+  ensure_loaded ();
   Hashtbl.fold (fun _ v acc -> v :: acc) registry []
 
 (** Save all currently registered documentation entries to a JSON file.
@@ -271,6 +271,18 @@ let run_tests pass_count fail_count _failures _eval_string eval_string_env test
     (Printf.sprintf {|df = read_csv("%s"); filter(df, !is_na($trip_distance)) |> nrow|} csv_filter_na)
     "2";
 
+  test "Arrow filter compound predicate with NA rows"
+    (Printf.sprintf {|df = read_csv("%s"); filter(df, $trip_distance > 1 && $trip_distance < 3 || $trip_distance > 3).name|} csv_filter_na)
+    {|Vector["Alice", "Charlie"]|};
+
+  test "Arrow filter with != keeps NA rows out"
+    (Printf.sprintf {|df = read_csv("%s"); filter(df, $trip_distance != 1.2).name|} csv_filter_na)
+    {|Vector["Charlie"]|};
+
+  test "Arrow filter with is_na || comparison"
+    (Printf.sprintf {|df = read_csv("%s"); filter(df, is_na($trip_distance) || $trip_distance < 2).name|} csv_filter_na)
+    {|Vector["Alice", "Bob"]|};
+
   let (v, _) = eval_string_env
     (Printf.sprintf {|df_f = read_csv("%s"); explain(filter(df_f, !is_na($trip_distance))).native_path_active|} csv_filter_na)
     env in
@@ -361,6 +373,81 @@ let run_tests pass_count fail_count _failures _eval_string eval_string_env test
         Test_arrow_helpers.record_native_requirement_result pass_count fail_count
           "Arrow mutate chained arithmetic stays native-backed");
 
+  let csv_fused = "test_arrow_mutate_fused.csv" in
+  let oc = open_out csv_fused in
+  output_string oc "tip_amount,total_amount,passengers\n2.0,10.0,1\n,20.0,2\n3.0,12.0,4\n";
+  close_out oc;
+  if Arrow_ffi.arrow_available then begin
+    test "Arrow mutate fused expression propagates nulls"
+      (Printf.sprintf
+        {|df = read_csv("%s"); mutate(df, $tip_pct = $tip_amount / $total_amount * 100) |> \(d) d.tip_pct|}
+        csv_fused)
+      "Vector[20., NA(Float), 25.]";
+    test "Arrow mutate fused expression with math and comparison"
+      (Printf.sprintf
+        {|df = read_csv("%s"); mutate(df, $big = sqrt($total_amount * $passengers) > 4) |> \(d) d.big|}
+        csv_fused)
+      "Vector[false, true, true]";
+    let was_profiling = !Profiler.enabled in
+    Profiler.enabled := true;
+    Profiler.reset ();
+    test "profile records native filter as a verb"
+      (Printf.sprintf
+        {|df = read_csv("%s"); f = filter(df, $passengers > 1); p = profile(); filter(p, $category == "verb" && $name == "filter") |> \(d) d.path|}
+        csv_fused)
+      {|Vector["native"]|};
+    let trace = Filename.temp_file "tlang_profile" ".json" in
+    let recorded = Profiler.take_events () in
+    Profiler.write_chrome_trace trace recorded;
+    (match Profiler.read_chrome_trace trace with
+     | Ok evs when List.length evs = List.length recorded
+                   && List.exists (fun e -> e.Profiler.ev_cat = "ffi") evs ->
+         incr pass_count; Printf.printf "  ✓ Chrome trace round-trips profiler events\n"
+     | Ok evs ->
+         incr fail_count;
+         Printf.printf "  ✗ Chrome trace round-trip: %d of %d events\n"
+           (List.length evs) (List.length recorded)
+     | Error msg ->
+         incr fail_count; Printf.printf "  ✗ Chrome trace round-trip: %s\n" msg);
+    (try Sys.remove trace with _ -> ());
+    Profiler.reset ();
+    Profiler.enabled := was_profiling
+  end else
+    Test_arrow_helpers.record_native_requirement_result pass_count fail_count
+      "Arrow mutate fused expressions";
+  (try Sys.remove csv_fused with _ -> ());
+  print_newline ();
+
+  Printf.printf "Arrow Integration — Memory Report:\n";
+  if Arrow_ffi.arrow_available then begin
+    test "memory_report records statements that create tables"
+      (Printf.sprintf {|df = read_csv("%s"); nrow(memory_report()) > 0|} csv_path)
+      "true";
+    test "memory_report columns"
+      {|colnames(memory_report())|}
+      {|["statement", "tables", "released", "start_bytes", "peak_bytes", "end_bytes"]|};
+    (* A statement whose only table stays reachable must not force a
+       major collection, however much the pool grew. *)
+    let saved_collect_bytes = !Arrow_table.arena_collect_bytes in
+    Arrow_table.arena_collect_bytes := 0;
+    let collections = !Arrow_table.arena_collections in
+    let kept = Arrow_table.with_arena "live table" (fun () ->
+      Arrow_table.materialize (Arrow_table.create [
+        ("x", Arrow_table.IntColumn [| Some 1; Some 2; Some 3 |]) ] 3)) in
+    Arrow_table.arena_collect_bytes := saved_collect_bytes;
+    if not (Arrow_table.is_native_backed kept) then
+      Test_arrow_helpers.record_native_requirement_result pass_count fail_count
+        "arena skips the major collection while its tables are live"
+    else if !Arrow_table.arena_collections = collections
+            && Arrow_table.num_rows (Sys.opaque_identity kept) = 3 then begin
+      incr pass_count; Printf.printf "  ✓ arena skips the major collection while its tables are live\n"
+    end else begin
+      incr fail_count; Printf.printf "  ✗ arena collected although its only table was live\n"
+    end
+  end else
+    Test_arrow_helpers.record_native_requirement_result pass_count fail_count
+      "Arrow memory report";
+
   test "Arrow arrange"
     (Printf.sprintf
       {|df = read_csv("%s"); df2 = arrange(df, $age); select(df2, $name) |> \(d) d.name|} csv_path)
@@ -395,6 +482,32 @@ let run_tests pass_count fail_count _failures _eval_string eval_string_env test
        incr fail_count; Printf.printf "  ✗ Arrow_io.read_csv expected nrow=3 on same file, got %d\n" (Arrow_table.num_rows tbl)
    | Error msg ->
        incr fail_count; Printf.printf "  ✗ Arrow_io.read_csv failed on CSV path distinction test: %s\n" msg);
+  let csv_types_path = "test_arrow_csv_col_types.csv" in
+  let oc = open_out csv_types_path in
+  output_string oc "# export\nzip;fare\n00501;3\n02134;12\n";
+  close_out oc;
+  if Arrow_ffi.arrow_available then begin
+    let (v, _) =
+      eval_string_env
+        (Printf.sprintf
+           {|read_csv("%s", separator = ";", skip_rows = 1, col_types = [zip: "String", fare: "Float"], threads = false, block_size = 4096)|}
+           csv_types_path)
+        (Packages.init_env ())
+    in
+    (match v with
+     | Ast.VDataFrame { arrow_table; _ }
+       when Arrow_table.column_type arrow_table "zip" = Some Arrow_table.ArrowString
+            && Arrow_table.column_type arrow_table "fare" = Some Arrow_table.ArrowFloat64 ->
+         incr pass_count; Printf.printf "  ✓ read_csv(col_types) reads declared column types natively\n"
+     | v ->
+         incr fail_count; Printf.printf "  ✗ read_csv(col_types) expected String/Float columns, got %s\n" (Ast.Utils.value_to_string v))
+  end else
+    Test_arrow_helpers.record_native_requirement_result pass_count fail_count
+      "read_csv(col_types) reads declared column types natively";
+  test "read_csv rejects unknown col_types"
+    (Printf.sprintf {|read_csv("%s", col_types = [zip: "Text"])|} csv_types_path)
+    {|Error(ValueError: "Function `read_csv` does not know column type \"Text\" for `zip`; use \"Int\", \"Float\", \"Bool\", \"String\", \"Date\" or \"Datetime\".")|};
+  (try Sys.remove csv_types_path with _ -> ());
   print_newline ();
 
   Printf.printf "Arrow Integration — Compute Module:\n";
@@ -1201,6 +1314,49 @@ let run_tests pass_count fail_count _failures _eval_string eval_string_env test
       "DatetimeColumn materialization did not retain a native Arrow handle"
   end;
 
+  (* Test: buffer-built tables and columns keep strings, nulls and booleans *)
+  let buf_tbl = Arrow_table.materialize (Arrow_table.create [
+    ("s", Arrow_table.StringColumn [| Some "héllo"; None; Some ""; Some "z" |]);
+    ("b", Arrow_table.BoolColumn [| Some true; Some false; None; Some true |]);
+  ] 4) in
+  if Arrow_table.is_native_backed buf_tbl then begin
+    let with_x = Arrow_table.add_column buf_tbl "x" (Arrow_table.FloatColumn [| Some 1.5; None; Some 3.0; Some 4.0 |]) in
+    let squared = Bigarray.Array1.of_array Bigarray.int64 Bigarray.c_layout [| 1L; 4L; 9L; 16L |] in
+    let with_sq = Arrow_column.add_numeric_column with_x "s" (Arrow_column.IntView squared) None in
+    (match Arrow_table.get_column buf_tbl "s", Arrow_table.get_column buf_tbl "b",
+           Arrow_table.get_column with_x "x", with_sq with
+     | Some (Arrow_table.StringColumn [| Some "héllo"; None; Some ""; Some "z" |]),
+       Some (Arrow_table.BoolColumn [| Some true; Some false; None; Some true |]),
+       Some (Arrow_table.FloatColumn [| Some 1.5; None; Some 3.0; Some 4.0 |]),
+       Some sq_tbl
+       when Arrow_table.is_native_backed with_x
+            && Arrow_table.column_names sq_tbl = ["s"; "b"; "x"]
+            && Arrow_table.get_column sq_tbl "s" = Some (Arrow_table.IntColumn [| Some 1; Some 4; Some 9; Some 16 |]) ->
+         incr pass_count; Printf.printf "  ✓ buffer-built native columns round-trip values and nulls\n"
+     | _ ->
+         incr fail_count; Printf.printf "  ✗ buffer-built native columns lost values or the native handle\n")
+  end else
+    Test_arrow_helpers.record_native_requirement_result pass_count fail_count
+      "buffer-built native columns round-trip values and nulls";
+
+  (* Test: mutate with a numeric vector builds the column from buffers *)
+  if Arrow_table.is_native_backed buf_tbl then begin
+    let env = Ast.Env.add "buf_df"
+      (Ast.VDataFrame { arrow_table = buf_tbl; group_keys = [] }) (Packages.init_env ()) in
+    let (v, _) = eval_string_env "mutate(buf_df, $n = [1, NA, 3, 4])" env in
+    (match v with
+     | Ast.VDataFrame { arrow_table; _ }
+       when Arrow_table.is_native_backed arrow_table
+            && Arrow_table.get_column arrow_table "n"
+               = Some (Arrow_table.IntColumn [| Some 1; None; Some 3; Some 4 |]) ->
+         incr pass_count; Printf.printf "  ✓ mutate packs numeric vectors into native buffers\n"
+     | other ->
+         incr fail_count;
+         Printf.printf "  ✗ mutate numeric vector: %s\n" (Ast.Utils.value_to_string other))
+  end else
+    Test_arrow_helpers.record_native_requirement_result pass_count fail_count
+      "mutate packs numeric vectors into native buffers";
+
   print_newline ();
 
   Printf.printf "Arrow Integration — Dictionary (Factor) Native Support:\n";
@@ -1358,6 +1514,53 @@ let run_tests pass_count fail_count _failures _eval_string eval_string_env test
       "Ordered to_factor native round-trip preserves ordered=true"
   end;
 
+  (* Test: factor keys stay dictionary-encoded through group_by, filter and joins *)
+  let factor_tbl = Arrow_table.materialize (Arrow_table.create [
+    ("dept", Arrow_table.DictionaryColumn (
+       [| Some 1; Some 0; None; Some 1; Some 2 |], ["HR"; "IT"; "Ops"], false));
+    ("val", Arrow_table.IntColumn [| Some 10; Some 20; Some 30; Some 40; Some 50 |]);
+  ] 5) in
+  if Arrow_table.is_native_backed factor_tbl then begin
+    let grouped = Arrow_compute.group_by factor_tbl ["dept"] in
+    (match Arrow_compute.group_aggregate grouped "sum" "val" with
+     | Some result ->
+         (match Arrow_table.get_column result "dept" with
+          | Some (Arrow_table.DictionaryColumn (idx, levels, _))
+            when idx = [| Some 0; Some 1; Some 2; None |] && levels = ["HR"; "IT"; "Ops"] ->
+              incr pass_count; Printf.printf "  ✓ group_by on a factor keeps its levels in level order\n"
+          | _ ->
+              incr fail_count; Printf.printf "  ✗ group_by on a factor returned wrong key column\n")
+     | None ->
+         incr fail_count; Printf.printf "  ✗ group_by on a factor failed to aggregate\n");
+    (match Arrow_compute.mask_equal_string factor_tbl "dept" "HR" with
+     | Some mask ->
+         let na_count, na_rows = Arrow_compute.mask_na_rows mask 10 in
+         (match Arrow_compute.filter_by_mask factor_tbl mask with
+          | Some filtered when Arrow_table.num_rows filtered = 2 && na_count = 1 && na_rows = [3] ->
+              incr pass_count; Printf.printf "  ✓ factor equality filter compares dictionary codes\n"
+          | _ ->
+              incr fail_count; Printf.printf "  ✗ factor equality filter returned wrong rows\n")
+     | None ->
+         incr fail_count; Printf.printf "  ✗ factor equality filter was not vectorised\n");
+    let factor_right = Arrow_table.materialize (Arrow_table.create [
+      ("dept", Arrow_table.DictionaryColumn ([| Some 0; Some 1 |], ["IT"; "Sales"], false));
+      ("floor", Arrow_table.IntColumn [| Some 3; Some 7 |]);
+    ] 2) in
+    (match Arrow_compute.hash_join_indices factor_tbl factor_right ["dept"] Arrow_compute.Inner_join with
+     | Some (left_idx, right_idx) when left_idx = [| 0; 3 |] && right_idx = [| 0; 0 |] ->
+         incr pass_count; Printf.printf "  ✓ hash join matches factor keys across dictionaries\n"
+     | Some _ ->
+         incr fail_count; Printf.printf "  ✗ hash join on factor keys returned wrong rows\n"
+     | None ->
+         incr fail_count; Printf.printf "  ✗ hash join on factor keys fell back\n")
+  end else
+    Test_arrow_helpers.record_native_requirement_result pass_count fail_count
+      "Factor keys stay dictionary-encoded";
+
+  test "Filter on string and factor equality"
+    {|df = to_dataframe([[name: "A", dept: "HR"], [name: "B", dept: "IT"], [name: "C", dept: "HR"]]); [nrow(filter(df, $dept == "HR")), nrow(filter(mutate(df, $d = to_factor($dept)), "HR" != $d))]|}
+    "[2, 1]";
+
   print_newline ();
 
   Printf.printf "Arrow Integration — ListColumn (Nested DataFrame) Native Support:\n";
@@ -2257,7 +2460,136 @@ let run_tests pass_count fail_count _failures _eval_string eval_string_env test
       incr pass_count; Printf.printf "  ✓ write_parquet/read_parquet preserves schema/column names\n"
     end else begin
       incr fail_count; Printf.printf "  ✗ write_parquet/read_parquet schema mismatch: %s\n" colnames_result
-    end
+    end;
+
+    (* Projection and predicate pushdown into the Parquet scan *)
+    let parquet_scan_path = Filename.temp_file "test_arrow_scan_" ".parquet" in
+    let (_, env_parquet) =
+      eval_string_env
+        (Printf.sprintf
+           {|df_scan = to_dataframe([id: [1, 2, 3, 4], score: [1.5, 2.5, 3.5, 4.5], grp: ["a", "b", "a", "b"]]); write_parquet(df_scan, "%s")|}
+           parquet_scan_path)
+        env_parquet
+    in
+    let (v, _) =
+      eval_string_env
+        (Printf.sprintf {|colnames(read_parquet("%s", columns = [$id, $grp]))|} parquet_scan_path)
+        env_parquet
+    in
+    let scan_cols = Ast.Utils.value_to_string v in
+    if scan_cols = {|["id", "grp"]|} then begin
+      incr pass_count; Printf.printf "  ✓ read_parquet columns = projects the scan\n"
+    end else begin
+      incr fail_count; Printf.printf "  ✗ read_parquet columns = projection mismatch: %s\n" scan_cols
+    end;
+    let (v, _) =
+      eval_string_env
+        (Printf.sprintf {|df_pushed = read_parquet("%s", columns = [$id], filter = $score > 2 && $id < 4); [nrow(df_pushed), get(pull(df_pushed, "id"), 0)]|} parquet_scan_path)
+        env_parquet
+    in
+    let scan_ids = Ast.Utils.value_to_string v in
+    if scan_ids = "[2, 2]" then begin
+      incr pass_count; Printf.printf "  ✓ read_parquet filter = pushes the predicate into the scan\n"
+    end else begin
+      incr fail_count; Printf.printf "  ✗ read_parquet filter = mismatch: %s\n" scan_ids
+    end;
+    let scan_order file_order =
+      match Arrow_io.read_parquet ~columns:["grp"; "id"] ~file_order parquet_scan_path with
+      | Ok table -> String.concat "," (Arrow_table.column_names table)
+      | Error msg -> msg
+    in
+    if scan_order true = "id,grp" && scan_order false = "grp,id" then begin
+      incr pass_count; Printf.printf "  ✓ read_parquet ~file_order keeps projected columns in file order\n"
+    end else begin
+      incr fail_count;
+      Printf.printf "  ✗ read_parquet projection order: file_order=%s, requested=%s\n"
+        (scan_order true) (scan_order false)
+    end;
+    (try Sys.remove parquet_scan_path with Sys_error _ -> ());
+
+    (* One row per row group, so the min/max statistics decide each skip:
+       integers above 2^53 and negative literals must compare exactly. *)
+    let parquet_big_path = Filename.temp_file "test_arrow_scan_big_" ".parquet" in
+    let (v, _) =
+      eval_string_env
+        (Printf.sprintf
+           {|write_parquet(to_dataframe([id: [9007199254740993, 9007199254740992, -7, 3]]), "%s", row_group_size = 1); [nrow(read_parquet("%s", filter = $id == 9007199254740993)), nrow(read_parquet("%s", filter = $id > -5)), nrow(read_parquet("%s", filter = -5 > $id))]|}
+           parquet_big_path parquet_big_path parquet_big_path parquet_big_path)
+        env_parquet
+    in
+    let big_result = Ast.Utils.value_to_string v in
+    if big_result = "[1, 3, 1]" then begin
+      incr pass_count; Printf.printf "  ✓ read_parquet filter = compares int64 statistics exactly and accepts negative literals\n"
+    end else begin
+      incr fail_count; Printf.printf "  ✗ read_parquet exact int64 pushdown expected [1, 3, 1], got %s\n" big_result
+    end;
+    (try Sys.remove parquet_big_path with Sys_error _ -> ());
+
+    let (v, _) =
+      eval_string_env
+        (Printf.sprintf
+           {|write_parquet(df_parquet, "%s", compression = "zstd", row_group_size = 1, dictionary = false); nrow(read_parquet("%s", filter = $id > 15))|}
+           parquet_write_path parquet_write_path)
+        env_parquet
+    in
+    let options_result = Ast.Utils.value_to_string v in
+    if options_result = "1" then begin
+      incr pass_count; Printf.printf "  ✓ write_parquet writer options round-trip\n"
+    end else begin
+      incr fail_count; Printf.printf "  ✗ write_parquet writer options expected nrow=1, got %s\n" options_result
+    end;
+
+    let (v, _) =
+      eval_string_env
+        (Printf.sprintf {|write_arrow(df_parquet, "%s", compression = "snappy")|} parquet_write_path)
+        env_parquet
+    in
+    (match v with
+     | Ast.VError { code = Ast.ValueError; _ } ->
+         incr pass_count; Printf.printf "  ✓ write_arrow rejects codecs IPC does not support\n"
+     | _ ->
+         incr fail_count; Printf.printf "  ✗ write_arrow accepted compression = \"snappy\": %s\n" (Ast.Utils.value_to_string v));
+
+    (* A zstd file must actually be compressed, not just readable. *)
+    let plain_path = Filename.temp_file "test_arrow_plain_" ".arrow" in
+    let zstd_path = Filename.temp_file "test_arrow_zstd_" ".arrow" in
+    let (v, _) =
+      eval_string_env
+        (Printf.sprintf
+           {|df_seq = to_dataframe([x: seq(1, 20000)]); write_arrow(df_seq, "%s"); write_arrow(df_seq, "%s", compression = "zstd"); nrow(read_arrow("%s"))|}
+           plain_path zstd_path zstd_path)
+        env_parquet
+    in
+    let plain_size = (Unix.stat plain_path).Unix.st_size in
+    let zstd_size = (Unix.stat zstd_path).Unix.st_size in
+    if Ast.Utils.value_to_string v = "20000" && zstd_size * 2 < plain_size then begin
+      incr pass_count; Printf.printf "  ✓ write_arrow compression = \"zstd\" compresses the file\n"
+    end else begin
+      incr fail_count;
+      Printf.printf "  ✗ write_arrow zstd: nrow %s, %d bytes vs %d uncompressed\n"
+        (Ast.Utils.value_to_string v) zstd_size plain_size
+    end;
+    (try Sys.remove zstd_path with Sys_error _ -> ());
+
+    (* lz4 must be written in the frame format IPC readers accept. *)
+    let lz4_path = Filename.temp_file "test_arrow_lz4_" ".arrow" in
+    let (v, _) =
+      eval_string_env
+        (Printf.sprintf
+           {|df_seq = to_dataframe([x: seq(1, 20000)]); write_arrow(df_seq, "%s", compression = "lz4"); back = read_arrow("%s"); [nrow(back), sum(pull(back, "x"))]|}
+           lz4_path lz4_path)
+        env_parquet
+    in
+    let lz4_size = (Unix.stat lz4_path).Unix.st_size in
+    if Ast.Utils.value_to_string v = "[20000, 200010000]" && lz4_size < plain_size then begin
+      incr pass_count; Printf.printf "  ✓ write_arrow compression = \"lz4\" round-trips\n"
+    end else begin
+      incr fail_count;
+      Printf.printf "  ✗ write_arrow lz4: %s, %d bytes vs %d uncompressed\n"
+        (Ast.Utils.value_to_string v) lz4_size plain_size
+    end;
+    (try Sys.remove plain_path with Sys_error _ -> ());
+    (try Sys.remove lz4_path with Sys_error _ -> ())
 
   end else begin
     Test_arrow_helpers.record_native_requirement_result pass_count fail_count
@@ -2273,7 +2605,13 @@ let run_tests pass_count fail_count _failures _eval_string eval_string_env test
     Test_arrow_helpers.record_native_requirement_result pass_count fail_count
       "write_parquet/read_parquet round-trip preserves nrow";
     Test_arrow_helpers.record_native_requirement_result pass_count fail_count
-      "write_parquet/read_parquet preserves schema/column names"
+      "write_parquet/read_parquet preserves schema/column names";
+    Test_arrow_helpers.record_native_requirement_result pass_count fail_count
+      "write_parquet writer options round-trip";
+    Test_arrow_helpers.record_native_requirement_result pass_count fail_count
+      "write_arrow rejects codecs IPC does not support";
+    Test_arrow_helpers.record_native_requirement_result pass_count fail_count
+      "write_arrow compression = \"zstd\" compresses the file"
 
   end;
 
@@ -2346,6 +2684,44 @@ let run_tests pass_count fail_count _failures _eval_string eval_string_env test
    | None ->
      incr pass_count; Printf.printf "  ✓ lead_column returns None on non-native table (expected)\n");
 
+  (* Test: grouped window kernel over a table concatenated from several chunks *)
+  let chunk_tbl keys vals =
+    Arrow_table.materialize (Arrow_table.create [
+      ("g", Arrow_table.StringColumn (Array.map (fun k -> Some k) keys));
+      ("x", Arrow_table.IntColumn vals);
+    ] (Array.length keys))
+  in
+  let chunked_tbl = Arrow_table.concatenate [
+    chunk_tbl [| "a"; "b" |] [| Some 3; Some 10 |];
+    chunk_tbl [| "a"; "b"; "a" |] [| Some 1; None; Some 2 |];
+    chunk_tbl [| "b"; "a" |] [| Some 5; Some 1 |];
+  ] in
+  if Arrow_table.is_native_backed chunked_tbl then begin
+    let grouped = Arrow_compute.group_by chunked_tbl ["g"] in
+    let run op =
+      match Arrow_compute.grouped_window grouped "x" op "w" with
+      | Some t -> Some (Arrow_table.get_int_column t "w")
+      | None -> None
+    in
+    let lag = run (Arrow_compute.Lag 1) in
+    let cumsum = run Arrow_compute.Cumsum in
+    let ranks = run Arrow_compute.Min_rank in
+    let ungrouped = match Arrow_compute.window_column chunked_tbl "x" Arrow_compute.Cummax "w" with
+      | Some t -> Some (Arrow_table.get_int_column t "w")
+      | None -> None
+    in
+    if lag = Some [| None; None; Some 3; Some 10; Some 1; None; Some 2 |]
+       && cumsum = Some [| Some 3; Some 10; Some 4; None; Some 6; None; Some 7 |]
+       && ranks = Some [| Some 4; Some 2; Some 1; None; Some 3; Some 1; Some 1 |]
+       && ungrouped = Some [| Some 3; Some 10; Some 10; None; None; None; None |] then begin
+      incr pass_count; Printf.printf "  ✓ grouped_window runs lag/cumsum/min_rank per group across chunks\n"
+    end else begin
+      incr fail_count; Printf.printf "  ✗ grouped_window results differ from the per-group semantics\n"
+    end
+  end else
+    Test_arrow_helpers.record_native_requirement_result pass_count fail_count
+      "grouped_window runs lag/cumsum/min_rank per group across chunks";
+
   (* Test: group_by_optimized on pure OCaml tables falls back to standard *)
   let grp_cols = [
     ("key", Arrow_table.StringColumn [| Some "a"; Some "b"; Some "a"; Some "b" |]);
@@ -2375,6 +2751,10 @@ let run_tests pass_count fail_count _failures _eval_string eval_string_env test
      {|lead([10, 20, 30, 40])|}
      "Vector[20, 30, 40, NA(Int)]";
 
+  test "grouped cumsum, lag and min_rank in mutate"
+    {|df = to_dataframe([[g: "a", x: 1], [g: "b", x: 10], [g: "a", x: 2], [g: "b", x: 20], [g: "a", x: 3]]); r = df |> group_by($g) |> mutate($c = cumsum($x), $l = lag($x), $k = min_rank($x)); [r.c, r.l, r.k]|}
+    "[Vector[1, 10, 3, 30, 6], Vector[NA(Int), NA(Int), 1, 10, 2], Vector[1, 1, 2, 2, 3]]";
+
   print_newline ();
 
   (* Cleanup *)
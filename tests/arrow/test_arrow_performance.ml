@@ -83,6 +83,52 @@ let run_tests pass_count fail_count _failures _eval_string _eval_string_env _tes
         (Printf.sprintf "native CSV benchmark smoke failed: %s" msg));
   print_newline ();
 
+  Printf.printf "Arrow Performance — Column Buffer Views:\n";
+  let na_path = Filename.temp_file "tlang_arrow_buffers_" ".csv" in
+  let oc = open_out na_path in
+  output_string oc "x,n\n1.5,1\nNA,2\n3.5,NA\n4.5,4\n";
+  close_out oc;
+  Fun.protect
+    ~finally:(fun () -> try Sys.remove na_path with Sys_error _ -> ())
+    (fun () ->
+      match Arrow_io.read_csv na_path with
+      | Ok tbl ->
+        (match Arrow_column.buffer_view tbl "x", Arrow_column.buffer_view tbl "n" with
+         | Some xb, Some nb ->
+           if Arrow_column.buffer_length xb = 4
+              && Arrow_column.buffer_null_count xb = 1
+              && not (Arrow_column.is_valid xb 1)
+              && Arrow_column.is_valid xb 2
+              && Arrow_column.float_at xb 3 = 4.5 then begin
+             incr pass_count; Printf.printf "  ✓ Float64 buffer view exposes values and validity bitmap\n"
+           end else begin
+             incr fail_count; Printf.printf "  ✗ Float64 buffer view values or validity incorrect\n"
+           end;
+           (match Arrow_column.to_float_array nb, Arrow_column.null_mask nb with
+            | None, [| false; false; true; false |] ->
+              incr pass_count; Printf.printf "  ✓ Int64 buffer view refuses NA copy and reports null mask\n"
+            | _ ->
+              incr fail_count; Printf.printf "  ✗ Int64 buffer view null handling incorrect\n");
+           (match Arrow_column.get_column tbl "x" with
+            | Some view ->
+              let sliced = Arrow_column.get_slice view 1 2 in
+              (match Arrow_column.column_view_to_list sliced with
+               | [Ast.VNA Ast.NAFloat; Ast.VFloat 3.5] ->
+                 incr pass_count; Printf.printf "  ✓ Sliced buffer-backed view keeps validity offset\n"
+               | vs ->
+                 incr fail_count;
+                 Printf.printf "  ✗ Sliced buffer-backed view returned [%s]\n"
+                   (String.concat "; " (List.map Ast.Utils.value_to_string vs)))
+            | None ->
+              incr fail_count; Printf.printf "  ✗ get_column failed on native table\n")
+         | _ ->
+           Test_arrow_helpers.record_native_requirement_result pass_count fail_count
+             "numeric buffer views are unavailable")
+      | Error msg ->
+        Test_arrow_helpers.record_native_requirement_result pass_count fail_count
+          (Printf.sprintf "native CSV read for buffer views failed: %s" msg));
+  print_newline ();
+
   Printf.printf "Arrow Performance — Column View Access:\n";
 
   (* Test 1: Column view creation on 10k rows *)
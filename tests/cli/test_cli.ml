@@ -194,6 +194,78 @@ let run_tests pass_count fail_count _failures _eval_string _eval_string_env test
     (List.exists (fun p -> p = "/tmp/repo/help/docs.json") repo_search_paths);
   print_newline ();
 
+  Printf.printf "CLI — script cache:\n";
+  let cache_dir = Filename.concat (Filename.get_temp_dir_name ())
+      (Printf.sprintf "tlang-script-cache-%d" (Unix.getpid ())) in
+  let original_cache_dir = Sys.getenv_opt "TLANG_CACHE_DIR" in
+  let clear_cache_dir () =
+    if Sys.file_exists cache_dir then begin
+      Array.iter (fun f -> Sys.remove (Filename.concat cache_dir f)) (Sys.readdir cache_dir);
+      Sys.rmdir cache_dir
+    end
+  in
+  clear_cache_dir ();
+  let compiles = ref 0 in
+  let compile source () =
+    incr compiles;
+    let program = Parser.program Lexer.token (Lexing.from_string source) in
+    { Script_cache.program; check = Typecheck.validate_program ~mode:Typecheck.Strict program }
+  in
+  let source = "f = \\(x: Int -> Int) (x + 1)\nf(41)\n" in
+  let cached source = Script_cache.find_or_add ~filename:"main.t" ~mode:Typecheck.Strict source (compile source) in
+  Fun.protect
+    ~finally:(fun () ->
+      (match original_cache_dir with
+       | Some value -> Unix.putenv "TLANG_CACHE_DIR" value
+       | None -> Unix.putenv "TLANG_CACHE_DIR" "");
+      Hashtbl.reset Script_cache.memo;
+      clear_cache_dir ())
+    (fun () ->
+      Unix.putenv "TLANG_CACHE_DIR" cache_dir;
+      let first = cached source in
+      let _ = cached source in
+      test_message "script cache compiles a script once per process" (!compiles = 1);
+      Hashtbl.reset Script_cache.memo;
+      let hits = !Script_cache.hits in
+      let reloaded = cached source in
+      test_message "script cache reloads the program from disk"
+        (!compiles = 1 && !Script_cache.hits = hits + 1
+         && reloaded.Script_cache.program = first.Script_cache.program
+         && reloaded.Script_cache.check = Ok ());
+      let _ = Script_cache.find_or_add ~filename:"main.t" ~mode:Typecheck.Repl source (compile source) in
+      let _ = cached (source ^ "f(1)\n") in
+      test_message "script cache keys on mode and source text" (!compiles = 3);
+      (match Script_cache.entry_path ~filename:"main.t" ~mode:Typecheck.Strict source with
+       | Some path ->
+           let oc = open_out_bin path in
+           output_string oc "TLANG-SCRIPT-CACHE-1\nnot a digest\n";
+           close_out oc;
+           Hashtbl.reset Script_cache.memo;
+           let recompiled = cached source in
+           test_message "script cache recompiles a damaged entry"
+             (!compiles = 4 && recompiled.Script_cache.program = first.Script_cache.program)
+       | None -> test_message "script cache recompiles a damaged entry" false);
+      Hashtbl.reset Script_cache.memo;
+      let bad_source = "f = \\(x) x\n" in
+      let bad = cached bad_source in
+      Hashtbl.reset Script_cache.memo;
+      let bad_again = cached bad_source in
+      test_message "script cache keeps type-check failures"
+        (!compiles = 5 && Result.is_error bad.Script_cache.check
+         && bad_again.Script_cache.check = bad.Script_cache.check);
+      let original_build_top = Sys.getenv_opt "NIX_BUILD_TOP" in
+      Fun.protect
+        ~finally:(fun () ->
+          Unix.putenv "NIX_BUILD_TOP" (Option.value original_build_top ~default:""))
+        (fun () ->
+          Unix.putenv "NIX_BUILD_TOP" (Filename.get_temp_dir_name ());
+          let explicit = Script_cache.entry_path ~mode:Typecheck.Strict source in
+          Unix.putenv "TLANG_CACHE_DIR" "";
+          test_message "script cache skips the build directory inside a Nix build"
+            (Script_cache.entry_path ~mode:Typecheck.Strict source = None
+             && explicit <> None)));
+  print_newline ();
+
   Printf.printf "Phase 7 — Pretty-print builtin:\n";
   test "pretty_print int"
     "pretty_print(42)"
@@ -198,6 +198,21 @@ let run_tests pass_count fail_count _failures _eval_string eval_string_env test
   test "arrange invalid direction"
     (Printf.sprintf {|df = read_csv("%s"); arrange(df, $age, "up")|} csv_p4)
     {|Error(ValueError: "Function `arrange` direction must be "asc" or "desc", got "up".")|};
+  test "arrange by several columns breaks ties with later columns"
+    {|d = to_dataframe([[a: 2, b: "x"], [a: 1, b: "z"], [a: 2, b: "a"], [a: 1, b: "b"]]); arrange(d, $a, $b).b|}
+    {|Vector["b", "z", "a", "x"]|};
+  test "arrange by several columns descending"
+    {|d = to_dataframe([[a: 2, b: "x"], [a: 1, b: "z"], [a: 2, b: "a"], [a: 1, b: "b"]]); arrange(d, $a, $b, "desc").b|}
+    {|Vector["x", "a", "z", "b"]|};
+  test "arrange takes string column names"
+    {|d = to_dataframe([[a: 2, b: "x"], [a: 1, b: "z"], [a: 2, b: "a"], [a: 1, b: "b"]]); arrange(d, "a", "b").b|}
+    {|Vector["b", "z", "a", "x"]|};
+  test "arrange descending keeps NA strings last"
+    {|arrange(to_dataframe([[s: "b"], [s: NA], [s: "c"]]), $s, "desc").s|}
+    {|Vector["c", "b", NA(String)]|};
+  test "arrange keeps integer precision above 2^53"
+    {|arrange(to_dataframe([[x: 9007199254740993], [x: 9007199254740992]]), $x).x|}
+    "Vector[9007199254740992, 9007199254740993]";
 
   print_newline ();
 
@@ -679,6 +694,27 @@ df |> filter($age > 25)
   test "anti_join keeps only left columns"
     {|left = to_dataframe([[id: 1, x: "a"], [id: 2, x: "b"]]); right = to_dataframe([[id: 2, y: "two"], [id: 3, y: "three"]]); anti_join(left, right, by = $id) |> ncol|}
     "2";
+  test "inner_join emits duplicate matches in right order"
+    {|left = to_dataframe([[id: 1, x: "a"], [id: 2, x: "b"]]); right = to_dataframe([[id: 2, y: "p"], [id: 1, y: "q"], [id: 2, y: "r"]]); inner_join(left, right, by = $id).y|}
+    {|Vector["q", "p", "r"]|};
+  test "inner_join on multiple typed keys"
+    {|left = to_dataframe([[k: "a", d: 1.5, x: 1], [k: "a", d: 2.5, x: 2], [k: "b", d: 1.5, x: 3]]); right = to_dataframe([[k: "a", d: 2.5, y: true], [k: "b", d: 1.5, y: false]]); inner_join(left, right, by = ["k", "d"]).x|}
+    "Vector[2, 3]";
+  test "join matches -0.0 with 0.0"
+    {|left = to_dataframe([[d: -0.0, x: 1], [d: 1.5, x: 2]]); right = to_dataframe([[d: 0.0, y: "zero"]]); inner_join(left, right, by = $d).x|}
+    "Vector[1]";
+  test "join matches NA keys"
+    {|left = to_dataframe([[id: NA, x: "a"], [id: 2, x: "b"]]); right = to_dataframe([[id: NA, y: "na"], [id: 3, y: "three"]]); inner_join(left, right, by = $id).y|}
+    {|Vector["na"]|};
+  test "full_join takes unmatched keys from the right"
+    {|left = to_dataframe([[k: "a", x: 1]]); right = to_dataframe([[k: "b", x: 2]]); full_join(left, right, by = $k).k|}
+    {|Vector["a", "b"]|};
+  test "left_join suffixes clashing right columns"
+    {|left = to_dataframe([[id: 1, x: "a"]]); right = to_dataframe([[id: 1, x: "b"]]); left_join(left, right, by = $id).x_y|}
+    {|Vector["b"]|};
+  test "left_join preserves group keys"
+    {|left = to_dataframe([[id: 1, g: "a"], [id: 2, g: "b"]]) |> group_by($g); right = to_dataframe([[id: 2, y: "two"]]); left_join(left, right, by = $id)|}
+    "DataFrame(2 rows x 3 cols: [id, g, y]) grouped by [g]";
   test "bind_rows unions columns"
     {|bind_rows(to_dataframe([[id: 1, x: "a"]]), to_dataframe([[id: 2, y: "b"]])) |> ncol|}
     "3";
@@ -779,6 +815,129 @@ df |> filter($age > 25)
     incr fail_count; Printf.printf "  ✗ vectorized grouped summarize sum\n    Expected: DataFrame(2 rows x 2 cols: [dept, total_score])\n    Got: %s\n" result
   end;
 
+  (* Multi-aggregate: typed keys, NA group last, shared column scan *)
+  let multi_agg = {|d = to_dataframe([[g: "a", v: 1], [g: "b", v: 2], [g: "a", v: 3], [g: NA, v: 4], [g: "a", v: 3]]); r = d |> group_by($g) |> summarize($n = n(), $u = n_distinct($v), $hi = max($v), $lo = min($v));|} in
+  test "multi-aggregate group keys sort with NA last"
+    (multi_agg ^ " r.g") {|Vector["a", "b", NA(String)]|};
+  test "multi-aggregate counts rows per group"
+    (multi_agg ^ " r.n") "Vector[3, 1, 1]";
+  test "multi-aggregate counts distinct values per group"
+    (multi_agg ^ " r.u") "Vector[2, 1, 1]";
+  test "multi-aggregate shares one scan for min and max"
+    (multi_agg ^ " to_integer(sum(r.hi)) * 10 + to_integer(sum(r.lo))") "97";
+  test "multi-aggregate orders NaN keys after numbers and before NA"
+    {|d = to_dataframe([g: [to_float("NaN"), 2.0, to_float("NaN"), 1.0, NA, 2.0], v: [1, 2, 3, 4, 5, 6]]); r = d |> group_by($g) |> summarize($n = n(), $hi = max($v)); r.hi|}
+    "Vector[4, 6, 3, 5]";
+
+  (* Approximate summaries: sketches are exact on small inputs *)
+  test "approx_n_distinct is exact per small group"
+    (multi_agg ^ " (d |> group_by($g) |> summarize($u = approx_n_distinct($v))).u") "Vector[2, 1, 1]";
+  test "approx_n_distinct estimates large inputs within 2%"
+    {|u = approx_n_distinct(seq(1, 50000)); u > 49000 && u < 51000|} "true";
+  test "approx_quantile matches quantile on small inputs"
+    {|approx_quantile([4, 1, 3, 2], 0.5)|} "2.5";
+  test "approx_quantile estimates large inputs within 1% of rank"
+    {|q = approx_quantile(seq(1, 100000), 0.9); q > 89000 && q < 91000|} "true";
+  test "heavy_hitters returns the most frequent values first"
+    {|hh = heavy_hitters(["a", "b", "a", "c", "a", "b"], 2); [hh.value, hh.count]|}
+    {|[Vector["a", "b"], Vector[3, 2]]|};
+
+  (* Merging: sketches of two inputs merged must answer like one sketch of
+     both inputs together, within each sketch's error bound. *)
+  let check_merge label ok detail =
+    if ok then begin
+      incr pass_count; Printf.printf "  ✓ %s\n" label
+    end else begin
+      incr fail_count; Printf.printf "  ✗ %s\n    Got: %s\n" label detail
+    end
+  in
+  let hll values =
+    let sk = Sketch.Hll.create () in
+    Array.iter (Sketch.Hll.add sk) values;
+    sk
+  in
+  let a = Array.init 60000 (fun i -> Ast.VInt i) in
+  let b = Array.init 60000 (fun i -> Ast.VInt (30000 + i)) in
+  let merged = Sketch.Hll.estimate (Sketch.Hll.merge (hll a) (hll b)) in
+  let whole = Sketch.Hll.estimate (hll (Array.append a b)) in
+  check_merge "Hll.merge equals the sketch of both inputs"
+    (merged = whole && abs (merged - 90000) < 2700)
+    (Printf.sprintf "merged %d, whole %d, exact 90000" merged whole);
+
+  let kll values =
+    let sk = Sketch.Kll.create () in
+    Array.iter (Sketch.Kll.add sk) values;
+    sk
+  in
+  let a = Array.init 50000 (fun i -> float_of_int (2 * i + 1)) in
+  let b = Array.init 50000 (fun i -> float_of_int (2 * i + 2)) in
+  let merged = Option.get (Sketch.Kll.quantile (Sketch.Kll.merge (kll a) (kll b)) 0.9) in
+  let whole = Option.get (Sketch.Kll.quantile (kll (Array.append a b)) 0.9) in
+  check_merge "Kll.merge quantiles stay within 1.5% of rank"
+    (Float.abs (merged -. 90000.0) < 1500.0 && Float.abs (whole -. 90000.0) < 1500.0)
+    (Printf.sprintf "merged %g, whole %g, exact 90000" merged whole);
+
+  let count_min values =
+    let sk = Sketch.Count_min.create ~capacity:64 () in
+    Array.iter (Sketch.Count_min.add sk) values;
+    sk
+  in
+  let stream hot n_hot prefix =
+    Array.init (n_hot + 10000) (fun i ->
+      if i mod 4 = 0 && i / 4 < n_hot then Ast.VString hot
+      else Ast.VString (Printf.sprintf "%s%d" prefix i))
+  in
+  let a = stream "x" 2500 "a" and b = stream "x" 2000 "b" in
+  let top sk = List.hd (Sketch.Count_min.top sk 1) in
+  let (mv, mc) = top (Sketch.Count_min.merge (count_min a) (count_min b)) in
+  let (wv, wc) = top (count_min (Array.append a b)) in
+  let bound = 2 * (Array.length a + Array.length b) / 2048 in
+  check_merge "Count_min.merge keeps the heavy hitter and its count"
+    (mv = Ast.VString "x" && wv = mv && mc = wc && mc >= 4500 && mc <= 4500 + bound)
+    (Printf.sprintf "merged %s = %d, whole %s = %d, exact x = 4500"
+       (Ast.Utils.value_to_string mv) mc (Ast.Utils.value_to_string wv) wc);
+
+  test "approx_quantile over sliced input stays within 2% of rank"
+    {|q = approx_quantile(seq(1, 300000), 0.5); q > 144000 && q < 156000|} "true";
+  test "heavy_hitters over sliced input finds the most frequent value"
+    {|hh = heavy_hitters(seq(1, 200000) |> map(\(i) if (i % 3 == 0) 0 else i), 1); c = sum(hh.count); [hh.value, c >= 66666 && c <= 66866]|}
+    {|[Vector[0], true]|};
+
+  (* Spilling: under a 1-byte memory limit native sorts, grouped summaries,
+     counts and pivots go through spill files and must match the in-memory
+     result. *)
+  let spill_df = {|sp = to_dataframe([k: [3, 1, 2, 3, NA, 1, 2, 3, 1, 2, 5, 4], s: ["b", "a", "c", "a", "b", "c", "a", "b", "c", "a", "b", "c"], v: [1.5, 2.0, NA, 4.0, 5.5, 6.0, 7.0, 8.5, 9.0, 10.0, 11.0, 12.5]]);|} in
+  let eval_spill code = Ast.Utils.value_to_string (fst (eval_string_env (spill_df ^ code) env_p4)) in
+  List.iter (fun (label, code) ->
+    let expected = eval_spill code in
+    let before = !Spill.spill_count in
+    let limit = !Spill.memory_limit and min_rows = !Spill.min_run_rows in
+    Spill.memory_limit := Some 1;
+    Spill.min_run_rows := 2;
+    let result =
+      Fun.protect (fun () -> eval_spill code)
+        ~finally:(fun () -> Spill.memory_limit := limit; Spill.min_run_rows := min_rows)
+    in
+    let spilled = !Spill.spill_count > before || not Arrow_ffi.arrow_available in
+    if result = expected && spilled then begin
+      incr pass_count; Printf.printf "  ✓ %s\n" label
+    end else begin
+      incr fail_count;
+      Printf.printf "  ✗ %s\n    Expected: %s (spilled)\n    Got: %s (spilled: %b)\n" label expected result spilled
+    end
+  ) [
+    ("arrange merges spilled sorted runs",
+     {| r = arrange(sp, $k, $s); [r.k, r.s, r.v]|});
+    ("descending arrange merges spilled sorted runs",
+     {| r = arrange(sp, $s, $v, "desc"); [r.s, r.v]|});
+    ("grouped summarize combines spilled partitions in key order",
+     {| r = sp |> group_by($k) |> summarize($n = n(), $t = sum($v, na_rm = true)); [r.k, r.n, r.t]|});
+    ("count combines spilled partitions",
+     {| r = count(sp, $s, $k); [r.s, r.k, r.n]|});
+    ("pivot_wider keeps first-appearance order across spilled partitions",
+     {| r = pivot_wider(sp, names_from = $s, values_from = $v); [r.k, r.a, r.b, r.c]|});
+  ];
+
   (* Vectorized mutate: column-scalar addition *)
   let (v, _) = eval_string_env {|result = mutate(df, $age_plus_5 = $age + 5); result.age_plus_5|} env_p4 in
   let result = Ast.Utils.value_to_string v in
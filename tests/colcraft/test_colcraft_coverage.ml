@@ -215,6 +215,12 @@ select(wide, where(is_logical)) |> ncol|}
   test "slice_min returns rows with smallest values"
     {|df = to_dataframe([[x: 1], [x: 5], [x: 3]]); slice_min(df, $x, n = 2).x|}
     "Vector[1, 3]";
+  test "slice_min skips NA values"
+    {|df = to_dataframe([[x: 3], [x: NA], [x: 1]]); slice_min(df, $x, n = 2).x|}
+    "Vector[1, 3]";
+  test "slice_max puts NA values last"
+    {|df = to_dataframe([[x: NA], [x: 3], [x: 1]]); slice_max(df, $x, n = 3).x|}
+    "Vector[3, 1, NA(Int)]";
   test "distinct removes duplicate rows"
     {|df = to_dataframe([[x: 1], [x: 1], [x: 2]]); distinct(df) |> nrow|}
     "2";
@@ -25,6 +25,15 @@ let run_tests _pass_count _fail_count _failures _eval_string _eval_string_env te
   test "vectorized year works on pulled dates"
     {|df = to_dataframe([[s: "2024-01-01"], [s: "2025-02-03"]]); year(ymd(pull(df, $s)))|}
     "Vector[2024, 2025]";
+  test "vectorized force_tz resolves offsets across a DST change"
+    {|df = to_dataframe([[s: "2024-01-15 09:30:00"], [s: "2024-07-15 09:30:00"]]); format_datetime(with_tz(force_tz(ymd_hms(pull(df, $s)), "Europe/Paris"), "UTC"), "%H:%M")|}
+    {|Vector["08:30", "07:30"]|};
+  test "vectorized format_datetime renders local time per zone"
+    {|df = to_dataframe([[s: "2024-01-15 09:30:00"], [s: "2024-07-15 09:30:00"]]); format_datetime(with_tz(ymd_hms(pull(df, $s)), "America/New_York"), "%H:%M")|}
+    {|Vector["04:30", "05:30"]|};
+  test "vectorized format_datetime returns an error for non-datetime values"
+    {|df = to_dataframe([[s: "2024-01-15"], [s: "2024-07-15"]]); format_datetime(pull(df, $s), "%H:%M")|}
+    {|Error(TypeError: "Function `format_datetime` expects (Date|Datetime, String).")|};
   test "today returns date type" {|type(today())|} {|"Date"|};
   test "now returns datetime type" {|type(now())|} {|"Datetime"|};
   print_newline ();
@@ -1,4 +1,4 @@
-let run_tests _pass_count _fail_count _failures _eval_string _eval_string_env test =
+let run_tests pass_count fail_count _failures eval_string _eval_string_env test =
   Printf.printf "Functions:\n";
   test "lambda definition and call" "f = \\(x) x + 1; f(5)" "6";
   test "function keyword" "f = function(x) x * 2; f(3)" "6";
@@ -20,4 +20,69 @@ let run_tests _pass_count _fail_count _failures _eval_string _eval_string_env te
     "f = \\($col) col; f(1 + 2)"
     {|Error(TypeError: "Auto-quoted parameters expect a bare name, $column, String, or Symbol.")|};
   test "arity error" "f = \\(x) x; f(1, 2)" {|Error(ArityError: "Function expects 1 arguments but received 2.")|};
+  print_newline ();
+
+  Printf.printf "Compiled lambda bodies:\n";
+  test "body reads parameters and closure variables" "k = 10; map([1, 2, 3], \\(x) x * k + 1)" "[11, 21, 31]";
+  test "parameter shadows closure variable" "x = 100; f = \\(x) x + 1; f(1)" "2";
+  test "pipe chain through user functions" "inc = \\(v) v + 1; map([1, 2, 3], \\(x) x |> inc |> inc)" "[3, 4, 5]";
+  test "pipe into builtin with extra arguments"
+    "map([\"a\", \"b\"], \\(s) [s, \"x\"] |> str_join(\"-\"))"
+    {|["a-x", "b-x"]|};
+  test "short-circuit skips right operand" "map([0, 2], \\(x) x == 0 || 1 / x > 0)" "[true, true]";
+  test "if/else on a parameter" "map([1, -1], \\(x) if (x > 0) \"pos\" else \"neg\")" {|["pos", "neg"]|};
+  test "dot access on a parameter" "f = \\(d) d.a * 2; f([a: 3])" "6";
+  test "block body is tree-walked" "f = \\(x) { y = x * 2\ny + 1 }; f(3)" "7";
+  test "closure returned from compiled body" "make = \\(n) \\(x) x + n; map([1, 2], make(10))" "[11, 12]";
+  let compiled = !Eval.lambdas_compiled and hits = !Eval.compiled_lambda_hits in
+  ignore (eval_string "k = 10; map([1, 2, 3, 4], \\(x) x * k + 1)");
+  if !Eval.lambdas_compiled = compiled + 1 && !Eval.compiled_lambda_hits >= hits + 3 then begin
+    incr pass_count; Printf.printf "  ✓ map compiles the body once and reuses it per element\n"
+  end else begin
+    incr fail_count;
+    Printf.printf "  ✗ map compiles the body once and reuses it per element: %d compiled, %d hits\n"
+      (!Eval.lambdas_compiled - compiled) (!Eval.compiled_lambda_hits - hits)
+  end;
+  let compiled = !Eval.lambdas_compiled in
+  Fun.protect ~finally:(fun () -> Eval.compile_lambdas := true) (fun () ->
+    Eval.compile_lambdas := false;
+    test "same result with compilation off" "k = 10; map([1, 2, 3], \\(x) x * k + 1)" "[11, 21, 31]");
+  if !Eval.lambdas_compiled = compiled then begin
+    incr pass_count; Printf.printf "  ✓ nothing is compiled with compilation off\n"
+  end else begin
+    incr fail_count; Printf.printf "  ✗ nothing is compiled with compilation off\n"
+  end;
+
+  (* Compiled bodies must agree with the tree-walker when a free name is
+     rebound or shadowed, and when one lambda expression yields closures
+     over different environments that share its compiled code. *)
+  let run ~compile code =
+    Fun.protect ~finally:(fun () -> Eval.compile_lambdas := true) (fun () ->
+      Eval.compile_lambdas := compile;
+      Ast.Utils.value_to_string (eval_string code))
+  in
+  List.iter (fun (label, code, expected) ->
+    let compiled = !Eval.lambdas_compiled in
+    let c = run ~compile:true code in
+    let ran_compiled = !Eval.lambdas_compiled > compiled in
+    let w = run ~compile:false code in
+    if c = expected && w = expected && ran_compiled then begin
+      incr pass_count; Printf.printf "  ✓ %s\n" label
+    end else begin
+      incr fail_count;
+      Printf.printf "  ✗ %s\n    Expected: %s\n    Compiled: %s (compiled: %b)\n    Walked: %s\n"
+        label expected c ran_compiled w
+    end
+  ) [
+    ("closure keeps its binding after the name is reassigned",
+     "k = 1; f = \\(x) x + k; k := 100; f(1)", "2");
+    ("closure keeps the function it captured after it is reassigned",
+     "h = \\(v) v + 1; g = \\(v) h(v); h := \\(v) v + 100; g(1)", "2");
+    ("parameter shadows a global of the same name",
+     "x = 5; f = \\(x) x * 2; [f(3), x]", "[6, 5]");
+    ("closures from one expression see their own environments",
+     "make = \\(n) \\(x) x + n; a = make(1); b = make(2); [a(10), b(10), a(10)]", "[11, 12, 11]");
+    ("inner closure made per call reads that call's parameter",
+     "map([1, 2, 3], \\(n) map([10], \\(x) x * n))", "[[10], [20], [30]]");
+  ];
   print_newline ()
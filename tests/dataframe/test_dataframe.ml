@@ -297,6 +297,23 @@ let run_tests pass_count fail_count _failures _eval_string eval_string_env test
   end else begin
     incr fail_count; Printf.printf "  ✗ read_csv with skip_header=true generates V1,V2,V3 column names\n    Expected: [\"V1\", \"V2\", \"V3\"]\n    Got: %s\n" result
   end;
+
+  (* Test read_csv with columns / filter scan arguments *)
+  test "read_csv with columns projects the scan"
+    (Printf.sprintf {|read_csv("%s", columns = [$name, $score]) |> colnames|} csv_path)
+    {|["name", "score"]|};
+  test "read_csv with filter keeps matching rows"
+    (Printf.sprintf {|read_csv("%s", filter = $age > 26 && $score < 95) |> nrow|} csv_path)
+    "1";
+  test "read_csv with filter and separator uses the same predicate"
+    (Printf.sprintf {|read_csv("%s", separator = ";", filter = 26 < $age) |> nrow|} csv_path_sep)
+    "1";
+  test "read_csv with filter accepts a negative literal"
+    (Printf.sprintf {|read_csv("%s", filter = $age > -1 && $score < 90) |> nrow|} csv_path)
+    "1";
+  test "read_csv with disjunctive filter is rejected"
+    (Printf.sprintf {|read_csv("%s", filter = $age > 26 || $score < 95)|} csv_path)
+    {|Error(TypeError: "Function `read_csv` `filter` must combine comparisons of a column with a number using `&&` (e.g. `$x > 10 && $y <= 3`).")|};
   print_newline ();
 
   (* Phase 5 — write_csv() with optional arguments *)
@@ -783,6 +800,45 @@ let run_tests pass_count fail_count _failures _eval_string eval_string_env test
 
   print_newline ();
 
+  Printf.printf "Lazy query plans:\n";
+  test "lazy wraps a DataFrame"
+    (Printf.sprintf {|lazy(read_csv("%s")) |> type|} csv_path)
+    {|"LazyFrame"|};
+  test "verbs on a LazyFrame stay lazy"
+    (Printf.sprintf {|lazy(read_csv("%s")) |> filter($age > 26) |> select($name) |> type|} csv_path)
+    {|"LazyFrame"|};
+  test "collect runs the plan"
+    (Printf.sprintf {|lazy(read_csv("%s")) |> filter($age > 26) |> select($name, $score) |> collect() |> colnames|} csv_path)
+    {|["name", "score"]|};
+  test "other builtins materialise a LazyFrame"
+    (Printf.sprintf {|lazy(read_csv("%s")) |> filter($age > 26) |> nrow|} csv_path)
+    "2";
+  test "projection pushdown keeps columns used by mutate"
+    (Printf.sprintf {|lazy(read_csv("%s")) |> mutate($double = $age * 2) |> select($name, $double) |> filter($double > 60) |> nrow|} csv_path)
+    "1";
+  test "explain shows pushed predicates"
+    (Printf.sprintf {|explain(lazy(read_csv("%s")) |> filter($age > 26) |> select($name)).pushed_predicates|} csv_path)
+    {|["$age > 26"]|};
+  test "explain shows the optimised plan"
+    (Printf.sprintf {|explain(lazy(read_csv("%s")) |> filter($age > 26) |> select($name)).plan|} csv_path)
+    {|["scan DataFrame(3 rows x 3 cols) [columns = [name]; filter = $age > 26]", "select($name)"]|};
+  test "errors in a lazy plan surface at collect"
+    (Printf.sprintf {|lazy(read_csv("%s")) |> select($nope) |> nrow|} csv_path)
+    {|Error(KeyError: "Column(s) not found: nope.")|};
+  test "printing a LazyFrame shows its plan without running it"
+    (Printf.sprintf {|lazy(read_csv("%s")) |> select($nope)|} csv_path)
+    "LazyFrame(1 steps)\n  scan DataFrame(3 rows x 3 cols)\n  select($nope)";
+  test "consecutive mutates are merged into one step"
+    (Printf.sprintf {|length(explain(lazy(read_csv("%s")) |> mutate($a = $age * 2) |> mutate($b = $a + 1)).plan)|} csv_path)
+    "2";
+  test "merged mutates see earlier assignments"
+    (Printf.sprintf {|lazy(read_csv("%s")) |> mutate($a = $age * 2) |> mutate($b = $a + 1) |> collect() |> pull("b") |> get(0)|} csv_path)
+    "61";
+  test "lazy rejects non-DataFrames"
+    "lazy(1)"
+    {|Error(TypeError: "Function `lazy` expects a DataFrame.")|};
+  print_newline ();
+
   (* Clean up test CSV files *)
   (try Sys.remove csv_path with _ -> ());
   (try Sys.remove csv_path_types with _ -> ());
@@ -654,6 +654,31 @@ Valid arguments: pipeline_script (positional/named), name, file.")|};
       incr pass_count; Printf.printf "  ✓ golden onnx: batch prediction successful (150 rows)\n"
     end else begin
       incr fail_count; Printf.printf "  ✗ golden onnx: batch prediction failed (got %s)\n" (Ast.Utils.value_to_string v)
+    end;
+
+    (* Test: Small batches score the same rows as a single batch *)
+    let (whole, _) = eval_string_env "predict(df, model)" env_ml in
+    let (batched, _) = eval_string_env "predict(df, model, batch_size = 7)" env_ml in
+    if Ast.Utils.value_to_string batched = Ast.Utils.value_to_string whole then begin
+      incr pass_count; Printf.printf "  ✓ golden onnx: batched prediction matches single batch\n"
+    end else begin
+      incr fail_count; Printf.printf "  ✗ golden onnx: batched prediction differs (got %s)\n" (Ast.Utils.value_to_string batched)
+    end;
+
+    (* Test: Session options and the optimised-model cache *)
+    let cache_dir = Filename.concat (Filename.get_temp_dir_name ()) (Printf.sprintf "tlang_onnx_cache_%d" (Unix.getpid ())) in
+    let (tuned, _) = eval_string_env (Printf.sprintf
+      {|tuned = t_read_onnx("%s", intra_op_threads = 1, graph_optimization = "extended", optimized_model_dir = "%s")
+        predict(df, tuned)|} iris_onnx cache_dir) env_ml in
+    let cached = Sys.file_exists cache_dir && Array.length (Sys.readdir cache_dir) = 1 in
+    if cached && Ast.Utils.value_to_string tuned = Ast.Utils.value_to_string whole then begin
+      incr pass_count; Printf.printf "  ✓ golden onnx: session options and optimised-model cache\n"
+    end else begin
+      incr fail_count; Printf.printf "  ✗ golden onnx: session options (cached=%b, got %s)\n" cached (Ast.Utils.value_to_string tuned)
+    end;
+    if Sys.file_exists cache_dir then begin
+      Array.iter (fun f -> Sys.remove (Filename.concat cache_dir f)) (Sys.readdir cache_dir);
+      Sys.rmdir cache_dir
     end
   end else begin
     Printf.printf "  ! skipping ONNX golden tests: baseline files not found\n"
@@ -343,6 +343,69 @@ let run_tests pass_count fail_count _failures _eval_string eval_string_env test
   end else begin
     incr fail_count; Printf.printf "  ✗ nix verbosity args are derived correctly\n"
   end;
+  let schedule_ok =
+    let args ?max_jobs ?max_cores width =
+      Builder_internal.parallel_build_args ~cpus:8 ~max_jobs ~max_cores ~width ()
+    in
+    args 1 = []
+    && args 3 = ["--max-jobs"; "3"; "--cores"; "2"]
+    && args 20 = ["--max-jobs"; "8"; "--cores"; "1"]
+    && args ~max_cores:(VInt 4) 3 = ["--max-jobs"; "3"; "--cores"; "4"]
+    && args ~max_jobs:(VInt 2) 20 = ["--max-jobs"; "2"]
+  in
+  if schedule_ok then begin
+    incr pass_count; Printf.printf "  ✓ parallel build args follow the DAG width\n"
+  end else begin
+    incr fail_count; Printf.printf "  ✗ parallel build args follow the DAG width\n"
+  end;
+  let (dag_val, _) = eval_string_env
+    "pipeline {\n  a = 1\n  b = 2\n  c = a + b\n  d = a * 2\n  e = c + d\n}" env_p3 in
+  (match dag_val with
+   | VPipeline p ->
+       let levels = Builder_write_dag.dag_levels p in
+       if levels = [("a", 0); ("b", 0); ("c", 1); ("d", 1); ("e", 2)]
+          && Builder_write_dag.dag_width p = 2
+          && Builder_write_dag.dag_width ~targets:["d"] p = 1 then begin
+         incr pass_count; Printf.printf "  ✓ DAG levels and width\n"
+       end else begin
+         incr fail_count; Printf.printf "  ✗ DAG levels and width\n"
+       end
+   | other ->
+       incr fail_count;
+       Printf.printf "  ✗ DAG levels and width\n    Got: %s\n" (Ast.Utils.value_to_string other));
+  let node_cache_ok =
+    let root = Filename.temp_dir "tlang_node_cache" "" in
+    let keys src =
+      match fst (eval_string_env src env_p3) with
+      | VPipeline p -> Builder_node_cache.node_keys ~root p
+      | _ -> []
+    in
+    let k1 = keys "pipeline {\n  a = 1\n  b = 2\n  c = a + b\n}" in
+    let k2 = keys "pipeline {\n  a = 10\n  b = 2\n  c = a + b\n}" in
+    let k3 = keys "pipeline {\n  a = 1\n  b = 2\n  c = a + b\n}" in
+    let differs n = List.assoc n k1 <> List.assoc n k2 in
+    let artifact = Filename.concat root "artifact" in
+    ignore (Builder_utils.write_file artifact "x");
+    Builder_utils.ensure_pipeline_dir ();
+    let had_cache = Sys.file_exists Builder_node_cache.cache_path in
+    Builder_node_cache.record k1 [("a", artifact); ("b", artifact); ("c", artifact)];
+    let hit = Builder_node_cache.unchanged k3 ["a"; "b"; "c"] in
+    let miss = Builder_node_cache.unchanged k2 ["a"; "b"; "c"] in
+    let sibling_hit = Builder_node_cache.unchanged k2 ["b"] in
+    let split = Builder_node_cache.partition k2 ["a"; "b"; "c"] in
+    if not had_cache then Sys.remove Builder_node_cache.cache_path;
+    Sys.remove artifact;
+    Unix.rmdir root;
+    k1 = k3 && differs "a" && not (differs "b") && differs "c"
+    && hit = Some [("a", artifact); ("b", artifact); ("c", artifact)]
+    && miss = None && sibling_hit = Some [("b", artifact)]
+    && split = ([("b", artifact)], ["a"; "c"])
+  in
+  if node_cache_ok then begin
+    incr pass_count; Printf.printf "  ✓ node cache keys follow upstream changes\n"
+  end else begin
+    incr fail_count; Printf.printf "  ✗ node cache keys follow upstream changes\n"
+  end;
   (* Clean up any stale logs from previous runs to avoid picking up mock logs *)
   let _ = try
     if Sys.file_exists "_pipeline" then
@@ -61,6 +61,9 @@ let run_tests pass_count fail_count _failures _eval_string eval_string_env test
        incr fail_count;
        Printf.printf "  ✗ randomForest predict first label\n    Expected: \"setosa\"\n    Got: %s\n" result);
 
+  Test_helpers.check_compiled_scoring pass_count fail_count eval_string_env env ~label:"randomForest"
+    ~predict:T_native_scoring.predict_forest_model ~interpret:T_native_scoring.interpret_forest_model;
+
   let (stats_v, _) = eval_string_env {|fit_stats(m) |> colnames()|} env in
   let stats_cols = Ast.Utils.value_to_string stats_v |> String.trim in
   let has_trees =
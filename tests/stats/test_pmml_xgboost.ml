@@ -72,6 +72,9 @@ let run_tests pass_count fail_count _failures _eval_string eval_string_env test
        incr fail_count;
        Printf.printf "  ✗ xgboost predict first label\n    Expected: 1\n    Got: %s\n" result);
 
+  Test_helpers.check_compiled_scoring pass_count fail_count eval_string_env env ~label:"xgboost"
+    ~predict:T_native_scoring.predict_boosted_model ~interpret:T_native_scoring.interpret_boosted_model;
+
   test "fit_stats xgboost n_trees"
     (Printf.sprintf {|m = t_read_pmml("%s"); fs = fit_stats(m); fs.n_trees|} (String.escaped pmml_path))
     "Vector[10.]";
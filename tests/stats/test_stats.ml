@@ -157,6 +157,29 @@ let run_tests pass_count fail_count failures _eval_string eval_string_env test =
     )
   in
 
+  (* The streamed normal-equation fit agrees with the in-memory QR fit *)
+  let xs = List.map Arrow_owl_bridge.float_buffer_of_array
+      [ [| 1.; 2.; 3.; 4.; 5.; 6. |]; [| 0.5; -1.; 2.; 0.; 1.5; 3. |] ] in
+  let ys = [| 1.1; 2.3; 2.9; 4.2; 5.1; 6.3 |] in
+  let fit () = Arrow_owl_bridge.linreg_multi ~weights:[| 1.; 2.; 1.; 2.; 1.; 2. |] xs ys [ "a"; "b" ] in
+  let qr_fit = fit () in
+  let saved_qr_max_bytes = !Arrow_owl_bridge.qr_max_bytes in
+  Arrow_owl_bridge.qr_max_bytes := 0;
+  let streamed_fit = fit () in
+  Arrow_owl_bridge.qr_max_bytes := saved_qr_max_bytes;
+  let close a b = Array.for_all2 (fun x y -> Float.abs (x -. y) < 1e-9) a b in
+  (match qr_fit, streamed_fit with
+   | Some a, Some b
+     when close a.Arrow_owl_bridge.coefficients b.Arrow_owl_bridge.coefficients
+          && close a.Arrow_owl_bridge.hat_values b.Arrow_owl_bridge.hat_values
+          && close a.Arrow_owl_bridge.std_errors b.Arrow_owl_bridge.std_errors ->
+       incr pass_count; Printf.printf "  ✓ streamed lm matches QR lm\n"
+   | _ ->
+       incr fail_count;
+       let msg = "  ✗ streamed lm matches QR lm\n" in
+       failures := msg :: !failures;
+       Printf.printf "%s" msg);
+
   (* lm() now returns a VDict with _tidy_df and _model_data *)
   let (v, _) = eval_string_env "type(model)" env_lm in
   let result = Ast.Utils.value_to_string v in
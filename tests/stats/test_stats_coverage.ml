@@ -56,6 +56,24 @@ let run_tests _pass_count _fail_count _failures _eval_string _eval_string_env te
   test "qt 0.025 df 10"
     "qt(0.025, 10) < -2.22 && qt(0.025, 10) > -2.23"
     "true";
+  test "qt is exact for small df"
+    "qt(0.975, 3) > 3.18244 && qt(0.975, 3) < 3.18245"
+    "true";
+  test "vectorised qt is symmetric"
+    "sum(qt([0.025, 0.975], 3))"
+    "0.";
+  test "vectorised pnorm returns a vector"
+    "type(pnorm([0, 1.96]))"
+    {|"Vector"|};
+  test "vectorised qnorm rejects out of range probability"
+    "qnorm([0.5, 2])"
+    {|Error(ValueError: "Function `qnorm` expects `p` to be between 0 and 1.")|};
+  test "dnorm at zero"
+    "dnorm(0) > 0.39894 && dnorm(0) < 0.39895"
+    "true";
+  test "dchisq rejects non-positive df"
+    "dchisq(1, 0)"
+    {|Error(ValueError: "Function `dchisq` expects `df` to be positive.")|};
   test "qt rejects non-int df"
     "qt(0.5, 1.5)"
     {|Error(TypeError: "qt expects (numeric, Int).")|};
@@ -21,3 +21,25 @@ let contains s sub =
     else loop (idx + 1)
   in
   sub_len = 0 || loop 0
+
+(* Score the DataFrame bound to [df] in [env] with the model bound to [m]
+   through the compiled path ([predict]) and the per-row interpreter
+   ([interpret]). Passes when the compiled path actually ran and both
+   agree, so a model that silently falls back to the interpreter fails. *)
+let check_compiled_scoring pass_count fail_count eval_string_env env ~label ~predict ~interpret =
+  let name = label ^ " compiled scoring matches interpreter" in
+  match eval_string_env "df" env, eval_string_env "m" env with
+  | (Ast.VDataFrame df, _), (model, _) ->
+      let runs = !T_native_scoring.compiled_runs in
+      let compiled = Ast.Utils.value_to_string (predict df model) in
+      let ran = !T_native_scoring.compiled_runs > runs in
+      let interpreted = Ast.Utils.value_to_string (interpret df model) in
+      if ran && compiled = interpreted then begin
+        incr pass_count; Printf.printf "  ✓ %s\n" name
+      end else begin
+        incr fail_count;
+        if not ran then Printf.printf "  ✗ %s\n    The compiled scorer did not run\n" name
+        else Printf.printf "  ✗ %s\n    Expected: %s\n    Got: %s\n" name interpreted compiled
+      end
+  | _ ->
+      incr fail_count; Printf.printf "  ✗ %s\n    Got: no DataFrame\n" name
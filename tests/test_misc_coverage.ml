@@ -934,4 +934,32 @@ min_version = "0.51.0"
         in
         inspect_ok && invalid_regex_ok && missing_drv_ok && copy_ok && copy_missing_ok && invalid_mode_ok))
   );
+  test_case "pipeline_copy dereferences linked node outputs" (fun () ->
+    with_temp_dir "pipeline_link" (fun dir ->
+      with_cwd dir (fun () ->
+        Unix.mkdir Builder_utils.pipeline_dir 0o755;
+        (* pipeline_output links each node to its store path *)
+        Unix.mkdir (Filename.concat dir "store") 0o755;
+        let store_node = Filename.concat dir "store/node1" in
+        Unix.mkdir store_node 0o755;
+        write_text (Filename.concat store_node "artifact") "payload";
+        Unix.chmod (Filename.concat store_node "artifact") 0o444;
+        Unix.mkdir (Filename.concat dir "out") 0o755;
+        Unix.symlink store_node (Filename.concat dir "out/node1");
+        write_text
+          (Filename.concat Builder_utils.pipeline_dir "build_log_20240101.json")
+          {|{"nodes":[{"node":"node1","runtime":"T","path":"out/node1/artifact","serializer":"json","class":"Artifact","dependencies":[]}]}|};
+        let kind path = try Some (Unix.lstat path).Unix.st_kind with Unix.Unix_error _ -> None in
+        let copied_files =
+          match Builder_copy.pipeline_copy ~target_dir:"pipeline-output" () with
+          | VString _ ->
+              kind "pipeline-output/node1" = Some Unix.S_DIR
+              && kind "pipeline-output/node1/artifact" = Some Unix.S_REG
+              && (Unix.stat "pipeline-output/node1/artifact").Unix.st_perm = 0o644
+          | _ -> false
+        in
+        (* remove_path follows links, so drop the link before cleanup *)
+        Sys.remove (Filename.concat dir "out/node1");
+        copied_files))
+  );
   print_newline ()